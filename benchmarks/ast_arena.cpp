@@ -0,0 +1,67 @@
+// Measures building and tearing down the AST of a large module: parse time, the time to
+// drop the module, and how many heap allocations the parse makes.
+
+#include "ast/ast.h"
+#include "bench_common.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+std::atomic<std::size_t> allocations{0};
+} // namespace
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::size_t functions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const std::string source = bench::generate_module(functions);
+
+    Lexer lexer(source);
+    const std::vector<Token> tokens = lexer.tokenize();
+
+    // Parse from pre-lexed tokens so only AST construction is timed.
+    std::vector<ast::Module> modules(5);
+    std::size_t run = 0;
+    const double parse_seconds = bench::best_of(5, [&] {
+        Parser parser(tokens);
+        modules[run++] = parser.parse_module();
+    });
+
+    run = 0;
+    const double teardown_seconds = bench::best_of(5, [&] { modules[run++] = ast::Module(); });
+
+    const std::size_t before = allocations.load();
+    std::size_t arena_bytes = 0;
+    {
+        Parser parser(tokens);
+        ast::Module module = parser.parse_module();
+        arena_bytes = module.context->bytes_allocated();
+    }
+    const std::size_t parse_allocations = allocations.load() - before;
+
+    bench::report("parse (best of 5)", parse_seconds * 1000.0, "ms");
+    bench::report("drop module (best of 5)", teardown_seconds * 1000.0, "ms");
+    bench::report("heap allocations per parse", static_cast<double>(parse_allocations),
+                  "allocations");
+    bench::report("arena bytes", static_cast<double>(arena_bytes) / (1024.0 * 1024.0), "MiB");
+    return 0;
+}
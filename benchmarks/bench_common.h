@@ -0,0 +1,85 @@
+#ifndef FLUX_BENCH_COMMON_H
+#define FLUX_BENCH_COMMON_H
+
+// Shared helpers for the benchmark executables in benchmarks/. Each benchmark is a
+// standalone program that prints one line per measurement; see docs/PERFORMANCE.md for
+// how the published numbers were produced.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace flux::bench {
+
+// Builds a synthetic but well-formed Flux module of roughly `functions * 10` lines:
+// a struct and an enum every 50 functions, and functions that exercise lets, arithmetic,
+// calls, comparisons, branches and loops. The output is deterministic.
+inline std::string generate_module(std::size_t functions, const std::string& name = "bench") {
+    std::string out;
+    out.reserve(functions * 360);
+    out += "module " + name + ";\n\n";
+    for (std::size_t i = 0; i < functions; ++i) {
+        const std::string n = std::to_string(i);
+        if (i % 50 == 0) {
+            out += "struct Point" + n + " {\n    x: Int32,\n    y: Int32,\n}\n\n";
+            out += "enum Shape" + n + " { Circle, Square, Triangle }\n\n";
+        }
+        out += "// function number " + n + " with a short comment line\n";
+        out += "func compute_value_" + n + "(alpha: Int32, beta: Int32) -> Int32 {\n";
+        out += "    let mut total: Int32 = alpha * 1_000 + beta;\n";
+        out += "    let limit: Int32 = 0x7F + " + n + ";\n";
+        out += "    while total < limit {\n";
+        out += "        total = total + 3;\n";
+        out += "    }\n";
+        out += "    if total >= 100 and beta != 0 {\n";
+        out += "        return total - beta;\n";
+        out += "    }\n";
+        if (i > 0) {
+            out += "    return compute_value_" + std::to_string(i - 1) + "(total, beta);\n";
+        } else {
+            out += "    return total;\n";
+        }
+        out += "}\n\n";
+    }
+    out += "func main() -> Void {\n";
+    out += "    let result: Int32 = compute_value_" + std::to_string(functions ? functions - 1 : 0) +
+           "(1, 2);\n";
+    out += "}\n";
+    return out;
+}
+
+// generate_module() for one module of a program: a whole program shares one namespace, so
+// the function and type names are prefixed with `name`, and main() is left to the entry
+// module.
+inline std::string generate_library_module(std::size_t functions, const std::string& name) {
+    std::string text = generate_module(functions, name);
+    text.erase(text.rfind("func main"));
+    for (const std::string word : {"compute_value_", "Point", "Shape"}) {
+        for (std::size_t at = text.find(word); at != std::string::npos;
+             at = text.find(word, at + name.size() + word.size() + 1))
+            text.insert(at, name + "_");
+    }
+    return text;
+}
+
+// Runs `fn` `iterations` times and returns the fastest wall-clock time in seconds.
+template <typename Fn> double best_of(int iterations, Fn&& fn) {
+    double best = 1e30;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+inline void report(const char* name, double value, const char* unit) {
+    std::printf("%-40s %14.2f %s\n", name, value, unit);
+}
+
+} // namespace flux::bench
+
+#endif // FLUX_BENCH_COMMON_H
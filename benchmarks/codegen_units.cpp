@@ -0,0 +1,85 @@
+// Builds one large generated program (see bench::generate_module()) to an executable with
+// 1, 2, 4 and 8 codegen units, each compiled on its own thread, and reports the build
+// times. Also checks that the objects for a given unit count are byte-for-byte the same
+// whether one thread or several compile them.
+//
+// Usage: codegen_units [FUNCTIONS] [LEVEL]. LEVEL is an -O flag; the default is -O2.
+
+#include "bench_common.h"
+#include "driver/compiler.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), {}};
+}
+} // namespace
+
+int main(int argc, char** argv) {
+#ifdef _WIN32
+    (void)argc;
+    (void)argv;
+    std::cerr << "codegen_units: linking executables is not supported on Windows yet\n";
+    return 1;
+#else
+    using namespace flux;
+    const std::size_t functions = argc > 1 ? std::stoul(argv[1]) : 1000;
+    const std::string level = argc > 2 ? argv[2] : "-O2";
+
+    const auto dir = std::filesystem::temp_directory_path() / "flux_bench_codegen_units";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "bench.fl") << bench::generate_module(functions);
+
+    auto build = [&](unsigned units, unsigned jobs, bool objects) {
+        CompileOptions options;
+        options.input = "bench.fl";
+        options.working_directory = dir;
+        options.build = true;
+        std::vector<std::string> flags{level, "--codegen-units=" + std::to_string(units),
+                                       "-j" + std::to_string(jobs)};
+        if (objects)
+            flags.push_back("--emit=obj");
+        parse_compile_flags(flags, options);
+        std::ostringstream out;
+        std::ostringstream err;
+        if (compile(options, out, err) != 0) {
+            std::cerr << "codegen_units: build failed:\n" << err.str();
+            std::exit(1);
+        }
+    };
+
+    for (unsigned units : {2u, 8u}) {
+        build(units, 1, true);
+        std::vector<std::string> serial;
+        for (unsigned i = 0; i < units; ++i)
+            serial.push_back(read_file(dir / ("bench." + std::to_string(i) + ".o")));
+        build(units, units, true);
+        for (unsigned i = 0; i < units; ++i) {
+            if (read_file(dir / ("bench." + std::to_string(i) + ".o")) != serial[i]) {
+                std::cerr << "codegen_units: object " << i << " of " << units
+                          << " differs between one thread and " << units << '\n';
+                return 1;
+            }
+        }
+    }
+
+    bench::report("functions", static_cast<double>(functions), "functions");
+    for (unsigned units : {1u, 2u, 4u, 8u}) {
+        const double seconds = bench::best_of(3, [&] { build(units, units, false); });
+        const std::string name = "build " + level + ", " + std::to_string(units) + " units";
+        bench::report(name.c_str(), seconds * 1000.0, "ms");
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+#endif
+}
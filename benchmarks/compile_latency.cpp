@@ -0,0 +1,137 @@
+// Compiles a project of many modules with a fresh compiler each time (what every `flux`
+// invocation does), with one CompileSession kept between builds (what `flux serve` does),
+// and through the server's socket. The kept session is measured with nothing edited, with
+// one module edited before every build, and with a module cache whose build record lets
+// an unedited build stop after loading. Object-file builds (`flux build --emit=obj -O0`)
+// are measured fresh and in the kept session, which keeps its target machine. Executables
+// built with a cache are measured with one module edited before every build, which
+// compiles that module alone and links the others' cached objects.
+
+#include "bench_common.h"
+#include "driver/compile_server.h"
+#include "driver/compiler.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::size_t modules = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50;
+    const std::size_t functions = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+
+    const auto dir = std::filesystem::temp_directory_path() / "flux_bench_compile_latency";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::string app = "module app;\n";
+    for (std::size_t i = 0; i < modules; ++i) {
+        const std::string name = "m" + std::to_string(i);
+        std::ofstream(dir / (name + ".fl")) << bench::generate_library_module(functions, name);
+        app += "import " + name + ";\n";
+    }
+    std::ofstream(dir / "app.fl") << app << "func main() -> Void {}\n";
+
+    CompileOptions options;
+    options.input = "app.fl";
+    options.working_directory = dir;
+
+    // The resolver traces declarations to standard output; keep that out of the report.
+    std::ostringstream discarded;
+    std::streambuf* const stdout_buffer = std::cout.rdbuf(discarded.rdbuf());
+    auto check = [&](int exit_code, const std::string& err) {
+        if (exit_code != 0) {
+            std::cout.rdbuf(stdout_buffer);
+            std::cerr << err;
+            std::abort();
+        }
+        discarded.str({});
+    };
+    auto run = [&](auto&& compile_once) {
+        return bench::best_of(5, [&] {
+            std::ostringstream out;
+            std::ostringstream err;
+            const int exit_code = compile_once(out, err);
+            check(exit_code, err.str());
+        });
+    };
+
+    const double cold_seconds =
+        run([&](std::ostream& out, std::ostream& err) { return compile(options, out, err); });
+
+    CompileSession session;
+    session.compile(options, discarded, discarded);
+    const double warm_seconds = run(
+        [&](std::ostream& out, std::ostream& err) { return session.compile(options, out, err); });
+
+    int edits = 0;
+    const auto edited = dir / "m0.fl";
+    const double edited_seconds = run([&](std::ostream& out, std::ostream& err) {
+        const auto before = std::filesystem::last_write_time(edited);
+        std::ofstream(edited) << bench::generate_library_module(functions, "m0") << "// edit "
+                              << ++edits << "\n";
+        std::filesystem::last_write_time(edited, before + std::chrono::seconds(1));
+        return session.compile(options, out, err);
+    });
+
+    CompileOptions cached = options;
+    cached.cache_dir = "cache";
+    session.compile(cached, discarded, discarded);
+    const double recorded_seconds = run(
+        [&](std::ostream& out, std::ostream& err) { return session.compile(cached, out, err); });
+
+    CompileOptions object = options;
+    object.build = true;
+    object.emit = codegen::FileType::Object;
+    object.opt_level = ir::OptLevel::O0;
+    const double object_cold_seconds =
+        run([&](std::ostream& out, std::ostream& err) { return compile(object, out, err); });
+    session.compile(object, discarded, discarded);
+    const double object_warm_seconds = run(
+        [&](std::ostream& out, std::ostream& err) { return session.compile(object, out, err); });
+
+    CompileOptions executable = options;
+    executable.build = true;
+    executable.opt_level = ir::OptLevel::O0;
+    executable.cache_dir = "units";
+    compile(executable, discarded, discarded);
+    const double incremental_seconds = run([&](std::ostream& out, std::ostream& err) {
+        const auto before = std::filesystem::last_write_time(edited);
+        std::ofstream(edited) << bench::generate_library_module(functions, "m0") << "// edit "
+                              << ++edits << "\n";
+        std::filesystem::last_write_time(edited, before + std::chrono::seconds(1));
+        return compile(executable, out, err);
+    });
+    executable.cache_dir.clear();
+    const double executable_seconds =
+        run([&](std::ostream& out, std::ostream& err) { return compile(executable, out, err); });
+
+    const auto socket = dir / "flux.sock";
+    CompileServer server(socket);
+    std::thread serving([&] { server.serve(); });
+    send_compile_request(socket, dir, {"app.fl"});
+    const double server_seconds = bench::best_of(5, [&] {
+        CompileResponse response = send_compile_request(socket, dir, {"app.fl"});
+        check(response.exit_code, response.err);
+    });
+    send_compile_request(socket, dir, {"--stop-server"});
+    serving.join();
+    std::cout.rdbuf(stdout_buffer);
+    std::filesystem::remove_all(dir);
+
+    bench::report("modules", static_cast<double>(modules + 1), "modules");
+    bench::report("fresh compiler (best of 5)", cold_seconds * 1000.0, "ms");
+    bench::report("kept session, no edit (best of 5)", warm_seconds * 1000.0, "ms");
+    bench::report("kept session, one module edited", edited_seconds * 1000.0, "ms");
+    bench::report("kept session + cache, no edit", recorded_seconds * 1000.0, "ms");
+    bench::report("server round trip, no edit", server_seconds * 1000.0, "ms");
+    bench::report("fresh compiler, --emit=obj -O0", object_cold_seconds * 1000.0, "ms");
+    bench::report("kept session, --emit=obj -O0", object_warm_seconds * 1000.0, "ms");
+    bench::report("fresh compiler, executable -O0", executable_seconds * 1000.0, "ms");
+    bench::report("executable -O0 + cache, one module edited", incremental_seconds * 1000.0,
+                  "ms");
+    return 0;
+}
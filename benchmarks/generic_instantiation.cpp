@@ -0,0 +1,80 @@
+// Measures name resolution of heavily generic code: GENERICS generic functions, each called
+// with every one of TYPES struct types, so the resolver records GENERICS * TYPES distinct
+// function instantiations and re-resolves each one while monomorphizing. Every call site is
+// also recorded a second time, from inside the caller, so half the recordings are repeats.
+//
+// Usage: generic_instantiation [TYPES] [GENERICS]
+
+#include "ast/ast.h"
+#include "bench_common.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include "semantic/resolver.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+std::string generate_generic_module(std::size_t types, std::size_t generics) {
+    std::string out = "module generic;\n\n";
+    out += "struct Wrap<T> {\n    value: T,\n}\n\n";
+    for (std::size_t i = 0; i < types; ++i)
+        out += "struct S" + std::to_string(i) + " {\n    x: Int32,\n}\n\n";
+    for (std::size_t j = 0; j < generics; ++j) {
+        const std::string n = std::to_string(j);
+        out += "func g" + n + "<T>(x: Int32) -> Int32 {\n";
+        out += "    return x + " + n + ";\n";
+        out += "}\n\n";
+    }
+    for (std::size_t i = 0; i < types; ++i) {
+        const std::string type = "S" + std::to_string(i);
+        out += "func use_" + type + "(w: Wrap<" + type + ">) -> Int32 {\n";
+        out += "    let mut total: Int32 = 0;\n";
+        for (std::size_t j = 0; j < generics; ++j) {
+            const std::string call = "g" + std::to_string(j) + "<" + type + ">(total)";
+            out += "    total = " + call + ";\n";
+            out += "    total = " + call + ";\n";
+        }
+        out += "    return total;\n";
+        out += "}\n\n";
+    }
+    out += "func main() -> Int32 {\n    return 0;\n}\n";
+    return out;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::size_t types = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+    const std::size_t generics = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100;
+    const std::string source = generate_generic_module(types, generics);
+
+    Lexer lexer(source);
+    Parser parser(lexer.tokenize());
+    const ast::Module module = parser.parse_module();
+
+    std::size_t function_instantiations = 0;
+    std::size_t type_instantiations = 0;
+    const double resolve_seconds = bench::best_of(3, [&] {
+        semantic::Resolver resolver;
+        resolver.resolve(module);
+        function_instantiations = resolver.function_instantiations().size();
+        type_instantiations = resolver.type_instantiations().size();
+    });
+    if (function_instantiations != types * generics) {
+        std::cerr << "generic_instantiation: expected " << types * generics
+                  << " function instantiations, got " << function_instantiations << '\n';
+        return 1;
+    }
+
+    bench::report("function instantiations", static_cast<double>(function_instantiations),
+                  "instantiations");
+    bench::report("type instantiations", static_cast<double>(type_instantiations),
+                  "instantiations");
+    bench::report("resolve (best of 3)", resolve_seconds * 1000.0, "ms");
+    bench::report("resolve per instantiation",
+                  resolve_seconds * 1e6 / static_cast<double>(function_instantiations),
+                  "us/instantiation");
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Measures lexing throughput and the memory held by the token vector for a large
+// generated module. Heap usage is observed by counting bytes passing through the global
+// allocator, so the numbers are comparable across changes to the Token layout.
+
+#include "bench_common.h"
+#include "lexer/lexer.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+std::atomic<std::size_t> g_allocated_bytes{0};
+std::atomic<std::size_t> g_allocations{0};
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_allocated_bytes += size;
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::size_t functions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const std::string source = bench::generate_module(functions);
+
+    std::size_t lines = 0;
+    for (char c : source)
+        lines += c == '\n';
+
+    // One instrumented run for the memory figures.
+    std::size_t token_count = 0;
+    std::size_t vector_bytes = 0;
+    std::size_t heap_bytes = 0;
+    std::size_t allocations = 0;
+    {
+        Lexer lexer(source);
+        const std::size_t bytes_before = g_allocated_bytes;
+        const std::size_t allocs_before = g_allocations;
+        auto tokens = lexer.tokenize();
+        heap_bytes = g_allocated_bytes - bytes_before;
+        allocations = g_allocations - allocs_before;
+        token_count = tokens.size();
+        vector_bytes = tokens.capacity() * sizeof(Token);
+    }
+
+    const double seconds = bench::best_of(10, [&] {
+        Lexer lexer(source);
+        auto tokens = lexer.tokenize();
+        if (tokens.empty())
+            std::abort();
+    });
+
+    // Keyword classification alone, against the hashed-std::string set it replaced.
+    std::vector<std::string_view> words;
+    {
+        Lexer lexer(source);
+        for (const Token& tok : lexer.tokenize()) {
+            if (tok.kind == TokenKind::Identifier || tok.kind == TokenKind::Keyword)
+                words.push_back(tok.lexeme);
+        }
+        std::unordered_set<std::string> keyword_set;
+        for (const auto& entry : keyword_detail::table)
+            keyword_set.insert(std::string(entry.text));
+
+        std::size_t hits = 0;
+        const double set_seconds = bench::best_of(10, [&] {
+            for (std::string_view w : words)
+                hits += keyword_set.contains(std::string(w));
+        });
+        const double hash_seconds = bench::best_of(10, [&] {
+            for (std::string_view w : words)
+                hits += classify_keyword(w) != Keyword::None;
+        });
+        if (hits == 0)
+            std::abort();
+        bench::report("identifier/keyword tokens", static_cast<double>(words.size()), "tokens");
+        bench::report("keyword lookup, unordered_set<string>",
+                      set_seconds * 1e9 / static_cast<double>(words.size()), "ns/ident");
+        bench::report("keyword lookup, perfect hash",
+                      hash_seconds * 1e9 / static_cast<double>(words.size()), "ns/ident");
+    }
+
+    bench::report("source lines", static_cast<double>(lines), "lines");
+    bench::report("source size", static_cast<double>(source.size()) / 1024.0, "KiB");
+    bench::report("tokens", static_cast<double>(token_count), "tokens");
+    bench::report("sizeof(Token)", static_cast<double>(sizeof(Token)), "bytes");
+    bench::report("token vector (capacity)", static_cast<double>(vector_bytes) / 1024.0, "KiB");
+    bench::report("heap allocated by tokenize()", static_cast<double>(heap_bytes) / 1024.0,
+                  "KiB");
+    bench::report("allocations by tokenize()", static_cast<double>(allocations), "allocs");
+    bench::report("lexing time (best of 10)", seconds * 1000.0, "ms");
+    bench::report("lexing throughput",
+                  static_cast<double>(source.size()) / seconds / (1024.0 * 1024.0), "MiB/s");
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Loads a project of many modules serially, with the loader's thread pool, and serially
+// from a warm module cache. The entry module imports every other module, so the whole
+// graph is found after the first parse, and every module also imports one shared `common`
+// module. Then declares every module (the resolver's first pass), and replays the
+// declarations recorded in the cache instead.
+
+#include "bench_common.h"
+#include "driver/module_cache.h"
+#include "driver/module_loader.h"
+#include "semantic/resolver.h"
+#include "support/thread_pool.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::size_t modules = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+    const std::size_t functions = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100;
+
+    const auto dir = std::filesystem::temp_directory_path() / "flux_bench_module_loading";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "common.fl") << bench::generate_library_module(functions, "common");
+    std::string app = "module app;\n";
+    for (std::size_t i = 0; i < modules; ++i) {
+        const std::string name = "m" + std::to_string(i);
+        std::string text = bench::generate_library_module(functions, name);
+        text.insert(text.find('\n') + 1, "import common;\n");
+        std::ofstream(dir / (name + ".fl")) << text;
+        app += "import " + name + ";\n";
+    }
+    std::ofstream(dir / "app.fl") << app << "func main() -> Void {}\n";
+
+    LoaderStats stats;
+    LoaderStats cached_stats;
+    const ModuleCache cache(dir / "cache");
+    auto load = [&](unsigned jobs, const ModuleCache* with_cache) {
+        return bench::best_of(5, [&] {
+            ModuleLoader loader;
+            loader.set_jobs(jobs);
+            loader.set_cache(with_cache);
+            loader.add_search_path(dir);
+            loader.load((dir / "app.fl").string());
+            if (loader.modules().size() != modules + 2)
+                std::abort();
+            (with_cache ? cached_stats : stats) = loader.stats();
+        });
+    };
+    const double serial_seconds = load(1, nullptr);
+    const double parallel_seconds = load(0, nullptr);
+    const double cached_seconds = load(1, &cache); // the first run fills the cache
+
+    ModuleLoader loader;
+    loader.set_cache(&cache);
+    loader.add_search_path(dir);
+    loader.load((dir / "app.fl").string());
+    {
+        semantic::Resolver resolver;
+        resolver.set_record_declarations(true);
+        resolver.initialize_intrinsics();
+        resolver.enter_scope();
+        for (const auto& [name, module] : loader.modules()) {
+            resolver.declare_or_replay(module);
+            cache.store_declarations(*loader.content_hash(name), module,
+                                     *resolver.declarations(module));
+        }
+    }
+    std::size_t replayed = 0;
+    auto declare = [&](bool replay) {
+        return bench::best_of(5, [&] {
+            semantic::Resolver resolver;
+            if (replay) {
+                for (const auto& [name, module] : loader.modules()) {
+                    if (auto record = cache.load_declarations(*loader.content_hash(name), module))
+                        resolver.reuse_declarations(module, std::move(*record));
+                }
+            }
+            resolver.initialize_intrinsics();
+            resolver.enter_scope();
+            for (const auto& [name, module] : loader.modules())
+                resolver.declare_or_replay(module);
+            replayed = resolver.replayed_modules();
+        });
+    };
+    const double declare_seconds = declare(false);
+    const double replay_seconds = declare(true);
+    if (replayed != modules + 2)
+        std::abort();
+    std::filesystem::remove_all(dir);
+
+    bench::report("modules", static_cast<double>(modules), "modules");
+    bench::report("worker threads", static_cast<double>(ThreadPool::default_threads()),
+                  "threads");
+    bench::report("load, serial (best of 5)", serial_seconds * 1000.0, "ms");
+    bench::report("load, thread pool (best of 5)", parallel_seconds * 1000.0, "ms");
+    bench::report("load, warm module cache (best of 5)", cached_seconds * 1000.0, "ms");
+    bench::report("files read per load", static_cast<double>(stats.files_read), "files");
+    bench::report("bytes lexed per load", static_cast<double>(stats.bytes_lexed) / 1048576.0,
+                  "MiB");
+    bench::report("cache hits per load", static_cast<double>(stats.cache_hits), "hits");
+    bench::report("module cache hits per warm load",
+                  static_cast<double>(cached_stats.disk_cache_hits), "files");
+    bench::report("declare every module (best of 5)", declare_seconds * 1000.0, "ms");
+    bench::report("replay cached declarations (best of 5)", replay_seconds * 1000.0, "ms");
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Measures the cost of interning names and of resolving identifiers through a chain of
+// scopes keyed by interned Name versus by std::string, plus parse and resolve time for a
+// large generated module.
+
+#include "bench_common.h"
+#include "lexer/interner.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include "semantic/resolver.h"
+#include "semantic/scope.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::size_t functions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const std::string source = bench::generate_module(functions);
+
+    std::vector<std::string> words;
+    {
+        Lexer lexer(source);
+        for (const Token& tok : lexer.tokenize()) {
+            if (tok.kind == TokenKind::Identifier)
+                words.emplace_back(tok.lexeme);
+        }
+    }
+
+    std::size_t sink = 0;
+    const double intern_seconds = bench::best_of(10, [&] {
+        for (const std::string& w : words)
+            sink += Name(w).id();
+    });
+
+    // Eight nested scopes of eight symbols each, the innermost declaring `total` and
+    // `beta`, queried with identifiers that mostly resolve a few levels up.
+    constexpr int kDepth = 8;
+    const std::vector<std::string> queries = {"total", "beta", "limit", "alpha", "outer_3",
+                                              "outer_0"};
+    std::vector<std::unique_ptr<semantic::Scope>> scopes;
+    std::vector<std::unordered_map<std::string, int>> string_scopes(kDepth);
+    for (int d = 0; d < kDepth; ++d) {
+        scopes.push_back(std::make_unique<semantic::Scope>(d ? scopes.back().get() : nullptr, d));
+        for (int i = 0; i < 8; ++i) {
+            const std::string name = "outer_" + std::to_string(d) + "_" + std::to_string(i);
+            scopes.back()->declare({name, semantic::SymbolKind::Variable});
+            string_scopes[d].emplace(name, i);
+        }
+    }
+    const char* const innermost[] = {"total", "beta"};
+    const char* const middle[] = {"limit", "alpha", "outer_3", "outer_0"};
+    for (const char* n : innermost) {
+        scopes[kDepth - 1]->declare({n, semantic::SymbolKind::Variable});
+        string_scopes[kDepth - 1].emplace(n, 0);
+    }
+    for (int i = 0; i < 4; ++i) {
+        scopes[kDepth - 2 - i]->declare({middle[i], semantic::SymbolKind::Variable});
+        string_scopes[kDepth - 2 - i].emplace(middle[i], 0);
+    }
+
+    std::vector<Name> query_names(queries.begin(), queries.end());
+    constexpr int kRounds = 200000;
+    const double string_seconds = bench::best_of(5, [&] {
+        for (int r = 0; r < kRounds; ++r) {
+            for (const std::string& q : queries) {
+                for (int d = kDepth - 1; d >= 0; --d) {
+                    if (auto it = string_scopes[d].find(q); it != string_scopes[d].end()) {
+                        sink += it->second;
+                        break;
+                    }
+                }
+            }
+        }
+    });
+    const double name_seconds = bench::best_of(5, [&] {
+        for (int r = 0; r < kRounds; ++r) {
+            for (Name q : query_names)
+                sink += scopes[kDepth - 1]->lookup(q)->scope_depth;
+        }
+    });
+    const double lookups = static_cast<double>(kRounds) * static_cast<double>(queries.size());
+
+    ast::Module module;
+    const double parse_seconds = bench::best_of(5, [&] {
+        Lexer lexer(source);
+        Parser parser(lexer.tokenize());
+        module = parser.parse_module();
+    });
+    const double resolve_seconds = bench::best_of(5, [&] {
+        semantic::Resolver resolver;
+        resolver.resolve(module);
+    });
+    if (sink == 0)
+        std::abort();
+
+    bench::report("identifier tokens", static_cast<double>(words.size()), "tokens");
+    bench::report("distinct interned strings", static_cast<double>(Interner::global().size()),
+                  "names");
+    bench::report("intern existing name",
+                  intern_seconds * 1e9 / static_cast<double>(words.size()), "ns/name");
+    bench::report("scope chain lookup, std::string keys", string_seconds * 1e9 / lookups,
+                  "ns/lookup");
+    bench::report("scope chain lookup, Name keys", name_seconds * 1e9 / lookups, "ns/lookup");
+    bench::report("parse (best of 5)", parse_seconds * 1000.0, "ms");
+    bench::report("resolve (best of 5)", resolve_seconds * 1000.0, "ms");
+    return 0;
+}
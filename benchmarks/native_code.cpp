@@ -0,0 +1,139 @@
+// Runs the same integer kernel (a nested loop calling a small function) compiled by
+// `flux build` at every optimization level and by the system C compiler at -O0 and -O2,
+// and checks that all of them compute the same result. Measures how fast the code we
+// generate is; how long each `flux build` took is reported too, for reference.
+
+#include "bench_common.h"
+#include "driver/compiler.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+namespace {
+std::string quoted(const std::filesystem::path& path) {
+    std::string text = "'";
+    text += path.string();
+    text += '\'';
+    return text;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+#ifdef _WIN32
+    (void)argc;
+    (void)argv;
+    std::cerr << "native_code: linking executables is not supported on Windows yet\n";
+    return 1;
+#else
+    using namespace flux;
+    const std::string rows = argc > 1 ? argv[1] : "100000";
+
+    const auto dir = std::filesystem::temp_directory_path() / "flux_bench_native_code";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "kernel.fl") << "module kernel;\n\n"
+                                        "func mix(total: Int32, i: Int32, j: Int32) -> Int32 {\n"
+                                        "    return (total + i * j / (j + 1) + j) / 2;\n"
+                                        "}\n\n"
+                                        "func main() -> Int32 {\n"
+                                        "    let mut total: Int32 = 0;\n"
+                                        "    let mut i: Int32 = 0;\n"
+                                        "    while i < " + rows + " {\n"
+                                        "        let mut j: Int32 = 0;\n"
+                                        "        while j < 1000 {\n"
+                                        "            total = mix(total, i, j);\n"
+                                        "            j = j + 1;\n"
+                                        "        }\n"
+                                        "        i = i + 1;\n"
+                                        "    }\n"
+                                        "    return total / 100;\n"
+                                        "}\n";
+    std::ofstream(dir / "kernel.c") << "static int mix(int total, int i, int j) {\n"
+                                       "    return (total + i * j / (j + 1) + j) / 2;\n"
+                                       "}\n\n"
+                                       "int main(void) {\n"
+                                       "    int total = 0;\n"
+                                       "    for (int i = 0; i < " + rows + "; i = i + 1)\n"
+                                       "        for (int j = 0; j < 1000; j = j + 1)\n"
+                                       "            total = mix(total, i, j);\n"
+                                       "    return total / 100;\n"
+                                       "}\n";
+
+    // The resolver traces declarations to standard output; keep that out of the report.
+    std::ostringstream out;
+    std::ostringstream err;
+    std::streambuf* const stdout_buffer = std::cout.rdbuf(out.rdbuf());
+    const std::pair<const char*, ir::OptLevel> levels[] = {{"O0", ir::OptLevel::O0},
+                                                           {"O1", ir::OptLevel::O1},
+                                                           {"O2", ir::OptLevel::O2},
+                                                           {"O3", ir::OptLevel::O3},
+                                                           {"Os", ir::OptLevel::Os}};
+    double build_seconds[std::size(levels)] = {};
+    for (std::size_t i = 0; i < std::size(levels); ++i) {
+        CompileOptions options;
+        options.input = "kernel.fl";
+        options.working_directory = dir;
+        options.build = true;
+        options.opt_level = levels[i].second;
+        options.output = std::string("kernel-flux-") + levels[i].first;
+        int flux_status = 0;
+        build_seconds[i] = bench::best_of(3, [&] { flux_status = compile(options, out, err); });
+        if (flux_status != 0) {
+            std::cout.rdbuf(stdout_buffer);
+            std::cerr << err.str();
+            return 1;
+        }
+    }
+    std::cout.rdbuf(stdout_buffer);
+
+    const char* cc = std::getenv("CC");
+    const std::string compiler = cc && *cc ? cc : "cc";
+    for (const char* level : {"O0", "O2"}) {
+        const std::string command = compiler + " -" + level + " " + quoted(dir / "kernel.c") +
+                                    " -o " + quoted(dir / (std::string("kernel-c-") + level));
+        if (std::system(command.c_str()) != 0) {
+            std::cerr << "native_code: cannot compile the C kernel with " << compiler << '\n';
+            return 1;
+        }
+    }
+
+    // The kernel's result is its exit status.
+    int expected = -1;
+    auto run = [&](const char* name, const std::string& program) {
+        int status = 0;
+        const std::string command = quoted(dir / program);
+        const double seconds =
+            bench::best_of(3, [&] { status = std::system(command.c_str()); });
+        if (!WIFEXITED(status) || (expected != -1 && WEXITSTATUS(status) != expected)) {
+            std::cerr << "native_code: " << program << " computed a different result\n";
+            std::exit(1);
+        }
+        expected = WEXITSTATUS(status);
+        bench::report(name, seconds * 1000.0, "ms");
+    };
+
+    run("C, cc -O0 (best of 3)", "kernel-c-O0");
+    run("C, cc -O2 (best of 3)", "kernel-c-O2");
+    for (std::size_t i = 0; i < std::size(levels); ++i) {
+        const std::string level = levels[i].first;
+        run(("Flux, flux build -" + level + " (best of 3)").c_str(), "kernel-flux-" + level);
+    }
+    for (std::size_t i = 0; i < std::size(levels); ++i) {
+        const std::string name =
+            std::string("flux build -") + levels[i].first + " (compile + link)";
+        bench::report(name.c_str(), build_seconds[i] * 1000.0, "ms");
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+#endif
+}
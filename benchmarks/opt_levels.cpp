@@ -0,0 +1,98 @@
+// Builds every program in examples/ to an object file at each optimization level, and
+// reports how long the builds took and how large the objects are. Programs that do not
+// build (several examples use features the backend does not support yet) are listed and
+// left out of every level, so the levels compare the same set.
+//
+// Usage: opt_levels [EXAMPLES_DIR]. The directory's parent must hold std/, as the
+// repository's does.
+
+#include "bench_common.h"
+#include "driver/compiler.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::filesystem::path examples = std::filesystem::absolute(
+        argc > 1 ? std::filesystem::path(argv[1])
+                 : std::filesystem::path(FLUX_SOURCE_DIR) / "examples");
+    const auto out_dir = std::filesystem::temp_directory_path() / "flux_bench_opt_levels";
+    std::filesystem::remove_all(out_dir);
+    std::filesystem::create_directories(out_dir);
+
+    std::vector<std::filesystem::path> programs;
+    for (const auto& entry : std::filesystem::directory_iterator(examples)) {
+        if (entry.path().extension() == ".fl")
+            programs.push_back(entry.path());
+    }
+    std::sort(programs.begin(), programs.end());
+
+    const std::pair<const char*, ir::OptLevel> levels[] = {{"-O0", ir::OptLevel::O0},
+                                                           {"-O1", ir::OptLevel::O1},
+                                                           {"-O2", ir::OptLevel::O2},
+                                                           {"-O3", ir::OptLevel::O3},
+                                                           {"-Os", ir::OptLevel::Os}};
+
+    // The resolver traces declarations to standard output; keep that out of the report.
+    std::ostringstream discarded;
+    std::streambuf* const stdout_buffer = std::cout.rdbuf(discarded.rdbuf());
+    auto build = [&](const std::filesystem::path& program, ir::OptLevel level) {
+        CompileOptions options;
+        options.input = program.string();
+        options.working_directory = examples.parent_path();
+        options.build = true;
+        options.emit = codegen::FileType::Object;
+        options.opt_level = level;
+        options.output = out_dir / program.filename().replace_extension(".o");
+        std::ostringstream out;
+        std::ostringstream err;
+        const int status = compile(options, out, err);
+        discarded.str({});
+        return status == 0;
+    };
+
+    std::vector<std::string> skipped;
+    std::erase_if(programs, [&](const std::filesystem::path& program) {
+        for (const auto& [flag, level] : levels) {
+            if (!build(program, level)) {
+                skipped.push_back(program.stem().string());
+                return true;
+            }
+        }
+        return false;
+    });
+
+    std::vector<std::pair<double, std::uintmax_t>> results;
+    for (const auto& [flag, level] : levels) {
+        std::uintmax_t bytes = 0;
+        const double seconds = bench::best_of(5, [&] {
+            bytes = 0;
+            for (const auto& program : programs) {
+                build(program, level);
+                bytes += std::filesystem::file_size(
+                    out_dir / program.filename().replace_extension(".o"));
+            }
+        });
+        results.emplace_back(seconds, bytes);
+    }
+    std::cout.rdbuf(stdout_buffer);
+    std::filesystem::remove_all(out_dir);
+
+    bench::report("programs built", static_cast<double>(programs.size()), "programs");
+    for (const std::string& name : skipped)
+        std::cout << "skipped (does not build): " << name << '\n';
+    for (std::size_t i = 0; i < std::size(levels); ++i) {
+        const std::string flag = levels[i].first;
+        bench::report(("build all " + flag + " (best of 5)").c_str(), results[i].first * 1000.0,
+                      "ms");
+        bench::report(("object bytes " + flag).c_str(), static_cast<double>(results[i].second),
+                      "bytes");
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Compares parsing from a fully materialized token vector with parsing from a pull-based
+// LexerTokenStream: peak heap while parsing, total parse time, and how long it takes to
+// report an error near the top of a large file. Live heap is tracked by prefixing every
+// allocation with its size.
+
+#include "bench_common.h"
+#include "lexer/diagnostic.h"
+#include "lexer/lexer.h"
+#include "lexer/token_stream.h"
+#include "parser/parser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+namespace {
+std::atomic<std::size_t> g_live_bytes{0};
+std::atomic<std::size_t> g_peak_bytes{0};
+
+constexpr std::size_t kHeader = alignof(std::max_align_t);
+} // namespace
+
+void* operator new(std::size_t size) {
+    auto* base = static_cast<unsigned char*>(std::malloc(size + kHeader));
+    if (!base)
+        throw std::bad_alloc();
+    *reinterpret_cast<std::size_t*>(base) = size;
+    const std::size_t live = g_live_bytes += size;
+    std::size_t peak = g_peak_bytes;
+    while (live > peak && !g_peak_bytes.compare_exchange_weak(peak, live)) {
+    }
+    return base + kHeader;
+}
+
+void operator delete(void* p) noexcept {
+    if (!p)
+        return;
+    auto* base = static_cast<unsigned char*>(p) - kHeader;
+    g_live_bytes -= *reinterpret_cast<std::size_t*>(base);
+    std::free(base);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+namespace {
+using namespace flux;
+
+ast::Module parse_vector(const std::string& source) {
+    Lexer lexer(source);
+    Parser parser(lexer.tokenize());
+    return parser.parse_module();
+}
+
+ast::Module parse_streaming(const std::string& source) {
+    Parser parser(std::make_unique<LexerTokenStream>(source));
+    return parser.parse_module();
+}
+
+// Peak heap above what was live on entry, for one parse.
+template <typename Fn> std::size_t peak_heap(Fn&& fn) {
+    const std::size_t before = g_live_bytes;
+    g_peak_bytes = before;
+    fn();
+    return g_peak_bytes - before;
+}
+
+template <typename Fn> double first_error_seconds(const std::string& source, Fn&& fn) {
+    return bench::best_of(10, [&] {
+        try {
+            fn(source);
+            std::abort();
+        } catch (const DiagnosticError&) {
+        }
+    });
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t functions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const std::string source = bench::generate_module(functions);
+
+    // Same module with a syntax error in the first function body.
+    std::string broken = source;
+    broken.insert(broken.find("    let limit"), "    let = ;\n");
+
+    const std::size_t vector_peak = peak_heap([&] { parse_vector(source); });
+    const std::size_t stream_peak = peak_heap([&] { parse_streaming(source); });
+
+    std::size_t buffered = 0;
+    {
+        Parser parser(std::make_unique<LexerTokenStream>(source));
+        parser.parse_module();
+        buffered = parser.max_buffered_tokens();
+    }
+
+    const double vector_seconds = bench::best_of(10, [&] { parse_vector(source); });
+    const double stream_seconds = bench::best_of(10, [&] { parse_streaming(source); });
+
+    bench::report("source size", static_cast<double>(source.size()) / 1024.0, "KiB");
+    bench::report("peak heap, vector parse", static_cast<double>(vector_peak) / 1024.0, "KiB");
+    bench::report("peak heap, streaming parse", static_cast<double>(stream_peak) / 1024.0,
+                  "KiB");
+    bench::report("max buffered tokens, streaming", static_cast<double>(buffered), "tokens");
+    bench::report("lex+parse, vector (best of 10)", vector_seconds * 1000.0, "ms");
+    bench::report("lex+parse, streaming (best of 10)", stream_seconds * 1000.0, "ms");
+    bench::report("first error, vector (best of 10)",
+                  first_error_seconds(broken, parse_vector) * 1e6, "us");
+    bench::report("first error, streaming (best of 10)",
+                  first_error_seconds(broken, parse_streaming) * 1e6, "us");
+    return 0;
+}
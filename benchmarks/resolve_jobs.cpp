@@ -0,0 +1,40 @@
+// Resolves a large module with its function bodies checked serially and on the resolver's
+// thread pool (Resolver::set_jobs()).
+//
+// Usage: resolve_jobs [FUNCTIONS] [JOBS]   (JOBS 0, the default, is one per hardware thread)
+
+#include "ast/ast.h"
+#include "bench_common.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include "semantic/resolver.h"
+
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::size_t functions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const auto jobs = static_cast<unsigned>(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 0);
+    const std::string source = bench::generate_module(functions);
+
+    Lexer lexer(source);
+    Parser parser(lexer.tokenize());
+    const ast::Module module = parser.parse_module();
+
+    auto resolve = [&](unsigned with_jobs) {
+        return bench::best_of(5, [&] {
+            semantic::Resolver resolver;
+            resolver.set_jobs(with_jobs);
+            resolver.resolve(module);
+        });
+    };
+    const double serial_seconds = resolve(1);
+    const double parallel_seconds = resolve(jobs);
+
+    bench::report("resolve, serial (best of 5)", serial_seconds * 1000.0, "ms");
+    const std::string parallel = "resolve, -j" + std::to_string(jobs) + " (best of 5)";
+    bench::report(parallel.c_str(), parallel_seconds * 1000.0, "ms");
+    bench::report("speedup", serial_seconds / parallel_seconds, "x");
+    return 0;
+}
@@ -0,0 +1,30 @@
+// Measures name resolution and type checking of a large module: the pass that dispatches on
+// node kinds most often, once per statement, expression and type query.
+
+#include "ast/ast.h"
+#include "bench_common.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include "semantic/resolver.h"
+
+#include <cstdlib>
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::size_t functions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const std::string source = bench::generate_module(functions);
+
+    Lexer lexer(source);
+    Parser parser(lexer.tokenize());
+    const ast::Module module = parser.parse_module();
+
+    const double resolve_seconds = bench::best_of(5, [&] {
+        semantic::Resolver resolver;
+        resolver.resolve(module);
+    });
+
+    bench::report("resolve (best of 5)", resolve_seconds * 1000.0, "ms");
+    bench::report("resolve per function", resolve_seconds * 1e6 / static_cast<double>(functions),
+                  "us/function");
+    return 0;
+}
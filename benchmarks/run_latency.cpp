@@ -0,0 +1,92 @@
+// How long it takes from source to a finished run of a small program: `flux run`, which
+// compiles it in memory with the JIT and calls main in this process, against `flux build`
+// followed by starting the executable it links. Also runs a longer loop both ways, to show
+// that the JIT's code is as fast as the linked executable's.
+//
+// Usage: run_latency [ITERATIONS]. ITERATIONS is the trip count of the longer loop.
+
+#include "bench_common.h"
+#include "driver/compiler.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+int main(int argc, char** argv) {
+#ifdef _WIN32
+    (void)argc;
+    (void)argv;
+    std::cerr << "run_latency: linking executables is not supported on Windows yet\n";
+    return 1;
+#else
+    using namespace flux;
+    const std::string iterations = argc > 1 ? argv[1] : "200000000";
+
+    const auto dir = std::filesystem::temp_directory_path() / "flux_bench_run_latency";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "startup.fl") << "module startup;\n\n"
+                                         "func main() -> Int32 {\n"
+                                         "    let mut total: Int32 = 0;\n"
+                                         "    let mut i: Int32 = 0;\n"
+                                         "    while i < 10 {\n"
+                                         "        total = total + i;\n"
+                                         "        i = i + 1;\n"
+                                         "    }\n"
+                                         "    return total;\n"
+                                         "}\n";
+    std::ofstream(dir / "hot_loop.fl") << "module hot_loop;\n\n"
+                                          "func main() -> Int32 {\n"
+                                          "    let mut total: Int32 = 0;\n"
+                                          "    let mut i: Int32 = 0;\n"
+                                          "    while i < " + iterations + " {\n"
+                                          "        total = (total + i / 3) / 2;\n"
+                                          "        i = i + 1;\n"
+                                          "    }\n"
+                                          "    return total / 1000000;\n"
+                                          "}\n";
+
+    auto compile_with = [&](const std::string& program, bool build) {
+        CompileOptions options;
+        options.input = program;
+        options.working_directory = dir;
+        options.build = build;
+        options.run = !build;
+        std::ostringstream out;
+        std::ostringstream err;
+        return compile(options, out, err);
+    };
+    auto run_executable = [&](const std::string& program) {
+        const std::string executable = std::filesystem::path(program).stem().string();
+        const int status = std::system(("'" + (dir / executable).string() + "'").c_str());
+        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    };
+
+    int jit_result = 0;
+    int native_result = 0;
+    for (const std::string program : {"startup.fl", "hot_loop.fl"}) {
+        const int repeats = program == "hot_loop.fl" ? 3 : 10;
+        const double jit =
+            bench::best_of(repeats, [&] { jit_result = compile_with(program, false); });
+        const double native = bench::best_of(repeats, [&] {
+            native_result = compile_with(program, true) == 0 ? run_executable(program) : -1;
+        });
+        if (jit_result != native_result) {
+            std::cerr << "run_latency: " << program << " returned " << jit_result
+                      << " under flux run and " << native_result << " when built\n";
+            return 1;
+        }
+        bench::report(("flux run " + program).c_str(), jit * 1000.0, "ms");
+        bench::report(("flux build + execute " + program).c_str(), native * 1000.0, "ms");
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+#endif
+}
@@ -0,0 +1,73 @@
+// Measures the lexer's bulk scanning kernels for every instruction set the CPU supports,
+// on inputs made of 64-byte runs, and newline counting over a generated module.
+
+#include "bench_common.h"
+#include "lexer/scan.h"
+
+#include <cstdlib>
+#include <string>
+
+namespace {
+double gib_per_second(std::size_t bytes, double seconds) {
+    return static_cast<double>(bytes) / seconds / (1024.0 * 1024.0 * 1024.0);
+}
+
+// Repeatedly applies `kernel` from the start of each run until the buffer is consumed.
+template <typename Kernel> double scan_all(const std::string& text, Kernel kernel) {
+    return flux::bench::best_of(20, [&] {
+        const char* p = text.data();
+        const char* end = p + text.size();
+        while (p < end) {
+            const char* stop = kernel(p, end);
+            p = stop == p ? p + 1 : stop;
+        }
+        if (p != end)
+            std::abort();
+    });
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::size_t functions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const std::string module = bench::generate_module(functions);
+
+    // Long runs: 64-byte whitespace/identifier/digit runs separated by one stop byte.
+    std::string spaces, idents, digits, comment;
+    for (std::size_t i = 0; i < module.size() / 64; ++i) {
+        spaces += std::string(63, ' ') + "\n" + ";";
+        idents += std::string(63, 'a') + "_;";
+        digits += std::string(63, '7') + ";";
+        comment += std::string(63, 'c') + "\n";
+    }
+
+    for (scan::Isa isa : {scan::Isa::Scalar, scan::Isa::SSE2, scan::Isa::AVX2}) {
+        if (!scan::is_supported(isa))
+            continue;
+        const scan::Kernels& k = scan::kernels(isa);
+        const std::string prefix = std::string(scan::to_string(isa)) + " ";
+
+        bench::report((prefix + "skip_whitespace (64B runs)").c_str(),
+                      gib_per_second(spaces.size(), scan_all(spaces, k.skip_whitespace)),
+                      "GiB/s");
+        bench::report((prefix + "skip_identifier (64B runs)").c_str(),
+                      gib_per_second(idents.size(), scan_all(idents, k.skip_identifier)),
+                      "GiB/s");
+        bench::report((prefix + "skip_digits (64B runs)").c_str(),
+                      gib_per_second(digits.size(), scan_all(digits, k.skip_digits)), "GiB/s");
+        bench::report((prefix + "find_line_end (64B lines)").c_str(),
+                      gib_per_second(comment.size(), scan_all(comment, k.find_line_end)),
+                      "GiB/s");
+
+        std::size_t newlines = 0;
+        const double count_seconds = bench::best_of(20, [&] {
+            newlines += k.count_newlines(module.data(), module.data() + module.size());
+        });
+        if (newlines == 0)
+            std::abort();
+        bench::report((prefix + "count_newlines (module)").c_str(),
+                      gib_per_second(module.size(), count_seconds), "GiB/s");
+    }
+    std::printf("active kernels: %s\n", scan::to_string(scan::best_isa()));
+    return 0;
+}
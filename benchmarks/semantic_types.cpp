@@ -0,0 +1,69 @@
+// Measures name resolution and type checking of a module whose functions pass nested
+// Option, Result and tuple types around: every let, call argument and return compares and
+// copies composite types, rather than the Int32s of bench::generate_module().
+//
+// Usage: semantic_types [FUNCTIONS]
+
+#include "ast/ast.h"
+#include "bench_common.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include "semantic/resolver.h"
+
+#include <cstdlib>
+#include <string>
+
+namespace {
+const std::string kOption = "Option<(Int32, Option<Int32>)>";
+const std::string kResult = "Result<(Int32, Bool), String>";
+const std::string kTuple = "(Int32, (Int32, Float64), Bool)";
+
+std::string generate_typed_module(std::size_t functions) {
+    std::string out = "module types;\n\n";
+    for (std::size_t i = 0; i < functions; ++i) {
+        const std::string n = std::to_string(i);
+        out += "func pass_" + n + "(a: " + kOption + ", b: " + kResult + ", c: " + kTuple +
+               ") -> " + kTuple + " {\n";
+        out += "    let x: " + kOption + " = a;\n";
+        out += "    let y: " + kResult + " = b;\n";
+        out += "    let z: " + kTuple + " = (1, (2, 3.0), true);\n";
+        if (i > 0) {
+            out += "    let w: " + kTuple + " = pass_" + std::to_string(i - 1) + "(x, y, z);\n";
+            out += "    return w;\n";
+        } else {
+            out += "    return c;\n";
+        }
+        out += "}\n\n";
+    }
+    out += "func main() -> Int32 {\n";
+    out += "    let a: " + kOption + " = Some((1, Some(2)));\n";
+    out += "    let b: " + kResult + " = Ok((1, true));\n";
+    out += "    let r: " + kTuple + " = pass_" + std::to_string(functions ? functions - 1 : 0) +
+           "(a, b, (1, (2, 3.0), true));\n";
+    out += "    return 0;\n";
+    out += "}\n";
+    return out;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::size_t functions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const std::string source = generate_typed_module(functions);
+
+    Lexer lexer(source);
+    Parser parser(lexer.tokenize());
+    const ast::Module module = parser.parse_module();
+
+    const double resolve_seconds = bench::best_of(5, [&] {
+        semantic::Resolver resolver;
+        resolver.resolve(module);
+    });
+
+    bench::report("resolve (best of 5)", resolve_seconds * 1000.0, "ms");
+    bench::report("resolve per function", resolve_seconds * 1e6 / static_cast<double>(functions),
+                  "us/function");
+    bench::report("distinct types", static_cast<double>(semantic::TypeContext::global().size()),
+                  "types");
+    return 0;
+}
@@ -0,0 +1,53 @@
+// Compares reading a large module through std::ifstream/std::stringstream (copying the
+// text into the Lexer) with lexing a memory-mapped SourceFile in place.
+
+#include "bench_common.h"
+#include "lexer/lexer.h"
+#include "lexer/source_file.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::size_t functions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const std::string text = bench::generate_module(functions);
+    const auto path = std::filesystem::temp_directory_path() / "flux_bench_source_loading.fl";
+    std::ofstream(path, std::ios::binary) << text;
+
+    std::size_t tokens = 0;
+    const double stream_seconds = bench::best_of(10, [&] {
+        std::ifstream file(path);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        Lexer lexer(buffer.str());
+        tokens += lexer.tokenize().size();
+    });
+    const double read_only_seconds = bench::best_of(10, [&] {
+        std::ifstream file(path);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        tokens += buffer.str().size();
+    });
+    const double mapped_seconds = bench::best_of(10, [&] {
+        auto file = SourceFile::open(path.string());
+        Lexer lexer(*file);
+        tokens += lexer.tokenize().size();
+    });
+    const double map_only_seconds = bench::best_of(10, [&] {
+        auto file = SourceFile::open(path.string());
+        tokens += file->text().size();
+    });
+    std::filesystem::remove(path);
+    if (tokens == 0)
+        std::abort();
+
+    bench::report("source size", static_cast<double>(text.size()) / 1024.0, "KiB");
+    bench::report("ifstream+stringstream: load only", read_only_seconds * 1e6, "us");
+    bench::report("ifstream+stringstream: load + lex", stream_seconds * 1000.0, "ms");
+    bench::report("SourceFile (mmap): load only", map_only_seconds * 1e6, "us");
+    bench::report("SourceFile (mmap): load + lex", mapped_seconds * 1000.0, "ms");
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Measures what compact source locations cost and save: the size of tokens and AST nodes,
+// the one-off cost of building a file's line table on the first diagnostic, and the cost
+// of each later offset-to-line lookup.
+
+#include "ast/ast.h"
+#include "bench_common.h"
+#include "lexer/lexer.h"
+#include "lexer/source_file.h"
+#include "lexer/source_manager.h"
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+int main(int argc, char** argv) {
+    using namespace flux;
+    const std::size_t functions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const std::string source = bench::generate_module(functions);
+
+    std::vector<SourceLoc> locs;
+    {
+        Lexer lexer(source);
+        for (const Token& tok : lexer.tokenize())
+            locs.push_back(tok.loc);
+    }
+
+    // A fresh file per run, so every run pays for building the table.
+    std::vector<std::unique_ptr<SourceFile>> fresh;
+    for (int i = 0; i < 10; ++i)
+        fresh.push_back(SourceFile::from_string("bench.fl", source));
+    std::size_t run = 0;
+    const double table_seconds = bench::best_of(10, [&] {
+        if (fresh[run++]->presumed(source.size()).line == 0)
+            std::abort();
+    });
+    fresh.clear();
+
+    auto file = SourceFile::from_string("bench.fl", source);
+    std::vector<SourceLoc> file_locs;
+    file_locs.reserve(locs.size());
+    for (SourceLoc loc : locs)
+        file_locs.push_back(file->loc_at(loc.offset - locs.front().offset));
+    SourceManager::global().presumed(file_locs.front());
+
+    std::size_t sink = 0;
+    const double lookup_seconds = bench::best_of(5, [&] {
+        for (SourceLoc loc : file_locs)
+            sink += SourceManager::global().presumed(loc).line;
+    });
+    if (sink == 0)
+        std::abort();
+
+    bench::report("sizeof(Token)", static_cast<double>(sizeof(Token)), "bytes");
+    bench::report("sizeof(ast::IdentifierExpr)",
+                  static_cast<double>(sizeof(ast::IdentifierExpr)), "bytes");
+    bench::report("tokens", static_cast<double>(locs.size()), "tokens");
+    bench::report("line table build (best of 10)", table_seconds * 1000.0, "ms");
+    bench::report("offset to file:line:col",
+                  lookup_seconds * 1e9 / static_cast<double>(file_locs.size()), "ns/lookup");
+    return 0;
+}
@@ -0,0 +1,27 @@
+# Writes ${OUT}, defining FLUX_BUILD_ID as a hash of every compiler source under
+# ${SOURCE_DIR}. Runs at build time, so any edit to the compiler changes the id, and the
+# module cache never hands one compiler's output to another. The file is only rewritten
+# when the id changes, so a build with unchanged sources recompiles nothing.
+#
+#   cmake -DSOURCE_DIR=<src> -DOUT=<build_id.h> -P BuildId.cmake
+
+file(GLOB_RECURSE sources "${SOURCE_DIR}/*.cpp" "${SOURCE_DIR}/*.h")
+list(SORT sources)
+set(digests "")
+foreach(source IN LISTS sources)
+    file(SHA256 "${source}" digest)
+    file(RELATIVE_PATH name "${SOURCE_DIR}" "${source}")
+    string(APPEND digests "${name} ${digest}\n")
+endforeach()
+string(SHA256 id "${digests}")
+string(SUBSTRING "${id}" 0 16 id)
+
+set(text "// Generated by cmake/BuildId.cmake from the compiler's sources; do not edit.\n")
+string(APPEND text "#define FLUX_BUILD_ID \"${id}\"\n")
+set(previous "")
+if(EXISTS "${OUT}")
+    file(READ "${OUT}" previous)
+endif()
+if(NOT previous STREQUAL text)
+    file(WRITE "${OUT}" "${text}")
+endif()
@@ -0,0 +1,59 @@
+#include "ast.h"
+
+namespace flux::ast {
+namespace {
+void spell_list(std::string& out, std::span<TypeExprPtr> types) {
+    for (std::size_t i = 0; i < types.size(); ++i) {
+        if (i > 0)
+            out += ", ";
+        out += spelling(types[i]);
+    }
+}
+} // namespace
+
+std::string spelling(const TypeExpr* type) {
+    if (!type)
+        return "";
+
+    std::string out;
+    switch (type->kind) {
+    case TypeExprKind::Path: {
+        const auto* path = cast<PathType>(type);
+        out = path->name.str();
+        if (!path->generic_args.empty()) {
+            out += '<';
+            spell_list(out, path->generic_args);
+            out += '>';
+        }
+        break;
+    }
+    case TypeExprKind::Ref: {
+        const auto* ref = cast<RefType>(type);
+        out = ref->is_mutable ? "&mut " : "&";
+        out += spelling(ref->pointee);
+        break;
+    }
+    case TypeExprKind::Array: {
+        const auto* array = cast<ArrayType>(type);
+        out = "[" + spelling(array->element);
+        if (!array->is_slice())
+            out += ";" + array->length;
+        out += ']';
+        break;
+    }
+    case TypeExprKind::Tuple:
+        out = "(";
+        spell_list(out, cast<TupleType>(type)->elements);
+        out += ')';
+        break;
+    case TypeExprKind::Function: {
+        const auto* fn = cast<FunctionType>(type);
+        out = "(";
+        spell_list(out, fn->params);
+        out += ") -> " + spelling(fn->return_type);
+        break;
+    }
+    }
+    return out;
+}
+} // namespace flux::ast
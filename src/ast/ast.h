@@ -1,279 +1,426 @@
 #ifndef FLUX_AST_H
 #define FLUX_AST_H
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include "ast_context.h"
+#include "lexer/interner.h"
 #include "lexer/token.h" // ✅ REQUIRED for TokenKind
 
 namespace flux::ast {
 
 enum class Visibility { None, Public, Private };
 
+// Expression, statement and pattern nodes, and their child lists, live in the module's
+// AstContext; the pointers between them do not own anything. clone() deep-copies a subtree
+// into the given context.
 struct Node {
-    uint32_t line = 0;
-    uint32_t column = 0;
-    virtual ~Node() = default;
-    virtual std::unique_ptr<Node> clone() const = 0;
+    SourceLoc loc;
 };
 
+// Deep copy of a possibly null child.
+template <typename T> T* clone_node(const T* node, AstContext& ctx) {
+    return node ? static_cast<T*>(node->clone(ctx)) : nullptr;
+}
+
+// Deep copy of a child list.
+template <typename T> std::span<T*> clone_nodes(std::span<T*> nodes, AstContext& ctx) {
+    std::span<T*> copy = ctx.list<T*>(nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+        copy[i] = clone_node(nodes[i], ctx);
+    return copy;
+}
+
+// Kind-checked casts between a node base (Expr, Stmt, Pattern, TypeExpr) and a concrete node,
+// in the style of LLVM's isa/cast/dyn_cast. They compare the kind tag and never use RTTI.
+template <typename T, typename Base> bool isa(const Base* node) {
+    return node && node->kind == T::Kind;
+}
+
+template <typename T, typename Base> auto dyn_cast(Base* node) {
+    using Result = std::conditional_t<std::is_const_v<Base>, const T*, T*>;
+    return isa<T>(node) ? static_cast<Result>(node) : nullptr;
+}
+
+template <typename T, typename Base> auto cast(Base* node) {
+    assert(isa<T>(node) && "cast to the wrong AST node kind");
+    using Result = std::conditional_t<std::is_const_v<Base>, const T*, T*>;
+    return static_cast<Result>(node);
+}
+
+/* =======================
+          Types
+======================= */
+
+enum class TypeExprKind : std::uint8_t {
+    Path,
+    Ref,
+    Array,
+    Tuple,
+    Function,
+};
+
+// A type as written in the source: `Int32`, `&mut Box<T>`, `[Int32; 4]`, `(Int32) -> Bool`.
+// The parser builds these once; the resolver and IR lowering walk the tree instead of
+// re-reading the text. A missing annotation is a null TypeExprPtr.
+struct TypeExpr : Node {
+    const TypeExprKind kind;
+
+    virtual TypeExpr* clone(AstContext& ctx) const = 0;
+
+  protected:
+    explicit TypeExpr(TypeExprKind k) : kind(k) {}
+    ~TypeExpr() = default;
+};
+
+using TypeExprPtr = TypeExpr*;
+
+// A named type with optional generic arguments: `Int32`, `T::Item`, `Result<T, E>`.
+struct PathType : TypeExpr {
+    static constexpr TypeExprKind Kind = TypeExprKind::Path;
+    Name name; // the whole path, `::`-separated
+    std::span<TypeExprPtr> generic_args;
+
+    explicit PathType(Name name, std::span<TypeExprPtr> args = {})
+        : TypeExpr(Kind), name(name), generic_args(args) {}
+    TypeExpr* clone(AstContext& ctx) const override {
+        return ctx.make<PathType>(name, clone_nodes(generic_args, ctx));
+    }
+};
+
+struct RefType : TypeExpr {
+    static constexpr TypeExprKind Kind = TypeExprKind::Ref;
+    bool is_mutable;
+    TypeExprPtr pointee = nullptr;
+
+    RefType(bool mut, TypeExprPtr pointee) : TypeExpr(Kind), is_mutable(mut), pointee(pointee) {}
+    TypeExpr* clone(AstContext& ctx) const override {
+        return ctx.make<RefType>(is_mutable, pointee->clone(ctx));
+    }
+};
+
+// `[T; N]`, or the slice `[T]` when there is no length.
+struct ArrayType : TypeExpr {
+    static constexpr TypeExprKind Kind = TypeExprKind::Array;
+    TypeExprPtr element = nullptr;
+    std::string length; // digits as written, without separators; empty for a slice
+
+    ArrayType(TypeExprPtr elem, std::string len)
+        : TypeExpr(Kind), element(elem), length(std::move(len)) {}
+    bool is_slice() const {
+        return length.empty();
+    }
+    TypeExpr* clone(AstContext& ctx) const override {
+        return ctx.make<ArrayType>(element->clone(ctx), length);
+    }
+};
+
+struct TupleType : TypeExpr {
+    static constexpr TypeExprKind Kind = TypeExprKind::Tuple;
+    std::span<TypeExprPtr> elements;
+
+    explicit TupleType(std::span<TypeExprPtr> elems) : TypeExpr(Kind), elements(elems) {}
+    TypeExpr* clone(AstContext& ctx) const override {
+        return ctx.make<TupleType>(clone_nodes(elements, ctx));
+    }
+};
+
+// `(A, B) -> R`
+struct FunctionType : TypeExpr {
+    static constexpr TypeExprKind Kind = TypeExprKind::Function;
+    std::span<TypeExprPtr> params;
+    TypeExprPtr return_type = nullptr;
+
+    FunctionType(std::span<TypeExprPtr> params, TypeExprPtr ret)
+        : TypeExpr(Kind), params(params), return_type(ret) {}
+    TypeExpr* clone(AstContext& ctx) const override {
+        return ctx.make<FunctionType>(clone_nodes(params, ctx), return_type->clone(ctx));
+    }
+};
+
+// The canonical spelling of a type: `&mut Box<T>`, `[Int32;4]`, `(Int32, Bool) -> Void`.
+// Symbol tables and diagnostics still key types by this text. Null spells as "".
+std::string spelling(const TypeExpr* type);
+
 /* =======================
         Expressions
 ======================= */
 
+enum class ExprKind : std::uint8_t {
+    Number,
+    Identifier,
+    String,
+    Char,
+    Bool,
+    Call,
+    Binary,
+    Unary,
+    Move,
+    Cast,
+    StructLiteral,
+    Range,
+    MemberAccess,
+    ErrorPropagation,
+    Lambda,
+    Await,
+    Spawn,
+    Tuple,
+    Array,
+    Slice,
+    Index,
+};
+
 struct Expr : Node {
-    ~Expr() override = default;
+    // Which node this is; dispatch on it with ast::visit() or test it with isa/dyn_cast.
+    const ExprKind kind;
+
+    virtual Expr* clone(AstContext& ctx) const = 0;
+
+  protected:
+    explicit Expr(ExprKind k) : kind(k) {}
+    ~Expr() = default;
 };
 
-using ExprPtr = std::unique_ptr<Expr>;
+using ExprPtr = Expr*;
 
 struct NumberExpr : Expr {
+    static constexpr ExprKind Kind = ExprKind::Number;
     std::string value;
 
-    explicit NumberExpr(std::string v) : value(std::move(v)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<NumberExpr>(value);
+    explicit NumberExpr(std::string v) : Expr(Kind), value(std::move(v)) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<NumberExpr>(value);
     }
 };
 
 struct IdentifierExpr : Expr {
-    std::string name;
+    static constexpr ExprKind Kind = ExprKind::Identifier;
+    Name name;
 
-    explicit IdentifierExpr(std::string n) : name(std::move(n)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<IdentifierExpr>(name);
+    explicit IdentifierExpr(Name n) : Expr(Kind), name(n) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<IdentifierExpr>(name);
     }
 };
 
 struct StringExpr : Expr {
+    static constexpr ExprKind Kind = ExprKind::String;
     std::string value;
 
-    explicit StringExpr(std::string v) : value(std::move(v)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<StringExpr>(value);
+    explicit StringExpr(std::string v) : Expr(Kind), value(std::move(v)) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<StringExpr>(value);
     }
 };
 
 struct CharExpr : Expr {
+    static constexpr ExprKind Kind = ExprKind::Char;
     std::string value;
 
-    explicit CharExpr(std::string v) : value(std::move(v)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<CharExpr>(value);
+    explicit CharExpr(std::string v) : Expr(Kind), value(std::move(v)) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<CharExpr>(value);
     }
 };
 
 struct BoolExpr : Expr {
+    static constexpr ExprKind Kind = ExprKind::Bool;
     bool value;
 
-    explicit BoolExpr(bool v) : value(v) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<BoolExpr>(value);
+    explicit BoolExpr(bool v) : Expr(Kind), value(v) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<BoolExpr>(value);
     }
 };
 
 struct CallExpr : Expr {
-    ExprPtr callee;
-    std::vector<ExprPtr> arguments;
-
-    CallExpr(ExprPtr c, std::vector<ExprPtr> args)
-        : callee(std::move(c)), arguments(std::move(args)) {}
-    std::unique_ptr<Node> clone() const override {
-        std::vector<ExprPtr> new_args;
-        new_args.reserve(arguments.size());
-        for (const auto& arg : arguments) {
-            new_args.push_back(std::unique_ptr<Expr>(static_cast<Expr*>(arg->clone().release())));
-        }
-        return std::make_unique<CallExpr>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(callee->clone().release())),
-            std::move(new_args));
+    static constexpr ExprKind Kind = ExprKind::Call;
+    ExprPtr callee = nullptr;
+    std::span<ExprPtr> arguments;
+
+    CallExpr(ExprPtr c, std::span<ExprPtr> args) : Expr(Kind), callee(c), arguments(args) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<CallExpr>(callee->clone(ctx), clone_nodes(arguments, ctx));
     }
 };
 
 struct BinaryExpr : Expr {
+    static constexpr ExprKind Kind = ExprKind::Binary;
     TokenKind op;
-    ExprPtr left;
-    ExprPtr right;
+    ExprPtr left = nullptr;
+    ExprPtr right = nullptr;
 
     BinaryExpr(TokenKind op, ExprPtr lhs, ExprPtr rhs)
-        : op(op), left(std::move(lhs)), right(std::move(rhs)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<BinaryExpr>(
-            op, std::unique_ptr<Expr>(static_cast<Expr*>(left->clone().release())),
-            std::unique_ptr<Expr>(static_cast<Expr*>(right->clone().release())));
+        : Expr(Kind), op(op), left(lhs), right(rhs) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<BinaryExpr>(op, left->clone(ctx), right->clone(ctx));
     }
 };
 
 struct UnaryExpr : Expr {
+    static constexpr ExprKind Kind = ExprKind::Unary;
     TokenKind op;
-    ExprPtr operand;
+    ExprPtr operand = nullptr;
     bool is_mutable;
 
     UnaryExpr(TokenKind op, ExprPtr expr, bool is_mutable = false)
-        : op(op), operand(std::move(expr)), is_mutable(is_mutable) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<UnaryExpr>(
-            op, std::unique_ptr<Expr>(static_cast<Expr*>(operand->clone().release())), is_mutable);
+        : Expr(Kind), op(op), operand(expr), is_mutable(is_mutable) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<UnaryExpr>(op, operand->clone(ctx), is_mutable);
     }
 };
 
 struct MoveExpr : Expr {
-    ExprPtr operand;
-    explicit MoveExpr(ExprPtr expr) : operand(std::move(expr)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<MoveExpr>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(operand->clone().release())));
+    static constexpr ExprKind Kind = ExprKind::Move;
+    ExprPtr operand = nullptr;
+    explicit MoveExpr(ExprPtr expr) : Expr(Kind), operand(expr) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<MoveExpr>(operand->clone(ctx));
     }
 };
 
 struct CastExpr : Expr {
-    ExprPtr expr;
-    std::string target_type;
-    CastExpr(ExprPtr e, std::string type) : expr(std::move(e)), target_type(std::move(type)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<CastExpr>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(expr->clone().release())), target_type);
+    static constexpr ExprKind Kind = ExprKind::Cast;
+    ExprPtr expr = nullptr;
+    TypeExprPtr target_type = nullptr;
+    CastExpr(ExprPtr e, TypeExprPtr type) : Expr(Kind), expr(e), target_type(type) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<CastExpr>(expr->clone(ctx), target_type->clone(ctx));
     }
 };
 
 struct FieldInit {
-    std::string name;
-    ExprPtr value;
+    Name name;
+    ExprPtr value = nullptr;
 };
 
 struct StructLiteralExpr : Expr {
+    static constexpr ExprKind Kind = ExprKind::StructLiteral;
     std::string struct_name;
-    std::vector<FieldInit> fields;
-
-    StructLiteralExpr(std::string name, std::vector<FieldInit> flds)
-        : struct_name(std::move(name)), fields(std::move(flds)) {}
-    std::unique_ptr<Node> clone() const override {
-        std::vector<FieldInit> new_fields;
-        new_fields.reserve(fields.size());
-        for (const auto& f : fields) {
-            new_fields.push_back(
-                {f.name, std::unique_ptr<Expr>(static_cast<Expr*>(f.value->clone().release()))});
-        }
-        return std::make_unique<StructLiteralExpr>(struct_name, std::move(new_fields));
+    std::span<FieldInit> fields;
+
+    StructLiteralExpr(std::string name, std::span<FieldInit> flds)
+        : Expr(Kind), struct_name(std::move(name)), fields(flds) {}
+    Expr* clone(AstContext& ctx) const override {
+        std::span<FieldInit> new_fields = ctx.list<FieldInit>(fields.size());
+        for (std::size_t i = 0; i < fields.size(); ++i)
+            new_fields[i] = {fields[i].name, fields[i].value->clone(ctx)};
+        return ctx.make<StructLiteralExpr>(struct_name, new_fields);
     }
 };
 
 struct RangeExpr : Expr {
-    ExprPtr start;
-    ExprPtr end;
+    static constexpr ExprKind Kind = ExprKind::Range;
+    ExprPtr start = nullptr;
+    ExprPtr end = nullptr;
     bool inclusive; // .. vs ..=
     RangeExpr(ExprPtr s, ExprPtr e, bool incl = false)
-        : start(std::move(s)), end(std::move(e)), inclusive(incl) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<RangeExpr>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(start->clone().release())),
-            std::unique_ptr<Expr>(static_cast<Expr*>(end->clone().release())), inclusive);
+        : Expr(Kind), start(s), end(e), inclusive(incl) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<RangeExpr>(start->clone(ctx), end->clone(ctx), inclusive);
     }
 };
 
 struct MemberAccessExpr : Expr {
-    ExprPtr object;
-    std::string member;
-    MemberAccessExpr(ExprPtr obj, std::string mem)
-        : object(std::move(obj)), member(std::move(mem)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<MemberAccessExpr>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(object->clone().release())), member);
+    static constexpr ExprKind Kind = ExprKind::MemberAccess;
+    ExprPtr object = nullptr;
+    Name member;
+    MemberAccessExpr(ExprPtr obj, Name mem) : Expr(Kind), object(obj), member(mem) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<MemberAccessExpr>(object->clone(ctx), member);
     }
 };
 
 struct ErrorPropagationExpr : Expr {
-    ExprPtr operand;
-    explicit ErrorPropagationExpr(ExprPtr e) : operand(std::move(e)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<ErrorPropagationExpr>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(operand->clone().release())));
+    static constexpr ExprKind Kind = ExprKind::ErrorPropagation;
+    ExprPtr operand = nullptr;
+    explicit ErrorPropagationExpr(ExprPtr e) : Expr(Kind), operand(e) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<ErrorPropagationExpr>(operand->clone(ctx));
     }
 };
 
 struct LambdaExpr : Expr {
+    static constexpr ExprKind Kind = ExprKind::Lambda;
     struct Param {
-        std::string name;
-        std::string type;
-        Param(std::string n, std::string t) : name(std::move(n)), type(std::move(t)) {}
+        Name name;
+        TypeExprPtr type = nullptr;
     };
-    std::vector<Param> params;
-    std::string return_type;
-    ExprPtr body;
-    LambdaExpr(std::vector<Param> p, std::string ret, ExprPtr b)
-        : params(std::move(p)), return_type(std::move(ret)), body(std::move(b)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<LambdaExpr>(
-            params, return_type,
-            std::unique_ptr<Expr>(static_cast<Expr*>(body->clone().release())));
+    std::span<Param> params;
+    TypeExprPtr return_type = nullptr;
+    ExprPtr body = nullptr;
+    LambdaExpr(std::span<Param> p, TypeExprPtr ret, ExprPtr b)
+        : Expr(Kind), params(p), return_type(ret), body(b) {}
+    Expr* clone(AstContext& ctx) const override {
+        std::span<Param> new_params = ctx.list<Param>(params.size());
+        for (std::size_t i = 0; i < params.size(); ++i)
+            new_params[i] = {params[i].name, clone_node(params[i].type, ctx)};
+        return ctx.make<LambdaExpr>(new_params, clone_node(return_type, ctx), body->clone(ctx));
     }
 };
 
 struct AwaitExpr : Expr {
-    ExprPtr operand;
-    explicit AwaitExpr(ExprPtr e) : operand(std::move(e)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<AwaitExpr>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(operand->clone().release())));
+    static constexpr ExprKind Kind = ExprKind::Await;
+    ExprPtr operand = nullptr;
+    explicit AwaitExpr(ExprPtr e) : Expr(Kind), operand(e) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<AwaitExpr>(operand->clone(ctx));
     }
 };
 
 struct SpawnExpr : Expr {
-    ExprPtr operand;
-    explicit SpawnExpr(ExprPtr e) : operand(std::move(e)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<SpawnExpr>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(operand->clone().release())));
+    static constexpr ExprKind Kind = ExprKind::Spawn;
+    ExprPtr operand = nullptr;
+    explicit SpawnExpr(ExprPtr e) : Expr(Kind), operand(e) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<SpawnExpr>(operand->clone(ctx));
     }
 };
 
 struct TupleExpr : Expr {
-    std::vector<ExprPtr> elements;
-    TupleExpr(std::vector<ExprPtr> elems) : elements(std::move(elems)) {}
-    std::unique_ptr<Node> clone() const override {
-        std::vector<ExprPtr> new_elems;
-        new_elems.reserve(elements.size());
-        for (const auto& e : elements)
-            new_elems.push_back(std::unique_ptr<Expr>(static_cast<Expr*>(e->clone().release())));
-        return std::make_unique<TupleExpr>(std::move(new_elems));
+    static constexpr ExprKind Kind = ExprKind::Tuple;
+    std::span<ExprPtr> elements;
+    TupleExpr(std::span<ExprPtr> elems) : Expr(Kind), elements(elems) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<TupleExpr>(clone_nodes(elements, ctx));
     }
 };
 
 struct ArrayExpr : Expr {
-    std::vector<ExprPtr> elements;
-    ArrayExpr(std::vector<ExprPtr> elems) : elements(std::move(elems)) {}
-    std::unique_ptr<Node> clone() const override {
-        std::vector<ExprPtr> new_elems;
-        new_elems.reserve(elements.size());
-        for (const auto& e : elements)
-            new_elems.push_back(std::unique_ptr<Expr>(static_cast<Expr*>(e->clone().release())));
-        return std::make_unique<ArrayExpr>(std::move(new_elems));
+    static constexpr ExprKind Kind = ExprKind::Array;
+    std::span<ExprPtr> elements;
+    ArrayExpr(std::span<ExprPtr> elems) : Expr(Kind), elements(elems) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<ArrayExpr>(clone_nodes(elements, ctx));
     }
 };
 
 struct SliceExpr : Expr {
-    ExprPtr array;
-    ExprPtr start;
-    ExprPtr end;
-    SliceExpr(ExprPtr arr, ExprPtr s, ExprPtr e)
-        : array(std::move(arr)), start(std::move(s)), end(std::move(e)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<SliceExpr>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(array->clone().release())),
-            start ? std::unique_ptr<Expr>(static_cast<Expr*>(start->clone().release())) : nullptr,
-            end ? std::unique_ptr<Expr>(static_cast<Expr*>(end->clone().release())) : nullptr);
+    static constexpr ExprKind Kind = ExprKind::Slice;
+    ExprPtr array = nullptr;
+    ExprPtr start = nullptr;
+    ExprPtr end = nullptr;
+    SliceExpr(ExprPtr arr, ExprPtr s, ExprPtr e) : Expr(Kind), array(arr), start(s), end(e) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<SliceExpr>(array->clone(ctx), clone_node(start, ctx),
+                                   clone_node(end, ctx));
     }
 };
 
 struct IndexExpr : Expr {
-    ExprPtr array;
-    ExprPtr index;
-    IndexExpr(ExprPtr arr, ExprPtr idx) : array(std::move(arr)), index(std::move(idx)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<IndexExpr>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(array->clone().release())),
-            std::unique_ptr<Expr>(static_cast<Expr*>(index->clone().release())));
+    static constexpr ExprKind Kind = ExprKind::Index;
+    ExprPtr array = nullptr;
+    ExprPtr index = nullptr;
+    IndexExpr(ExprPtr arr, ExprPtr idx) : Expr(Kind), array(arr), index(idx) {}
+    Expr* clone(AstContext& ctx) const override {
+        return ctx.make<IndexExpr>(array->clone(ctx), index->clone(ctx));
     }
 };
 
@@ -281,145 +428,161 @@ struct IndexExpr : Expr {
    Statements
    ======================= */
 
+enum class StmtKind : std::uint8_t {
+    Let,
+    Return,
+    Expr,
+    If,
+    While,
+    For,
+    Loop,
+    Break,
+    Continue,
+    Assign,
+    Match,
+    Block,
+};
+
 struct Stmt : Node {
-    ~Stmt() override = default;
+    const StmtKind kind;
+
+    virtual Stmt* clone(AstContext& ctx) const = 0;
+
+  protected:
+    explicit Stmt(StmtKind k) : kind(k) {}
+    ~Stmt() = default;
 };
 
-using StmtPtr = std::unique_ptr<Stmt>;
+using StmtPtr = Stmt*;
 
 struct LetStmt : Stmt {
-    std::string name;
-    std::vector<std::string> tuple_names; // for tuple destructuring
-    std::string type_name;
+    static constexpr StmtKind Kind = StmtKind::Let;
+    Name name;
+    std::span<Name> tuple_names; // for tuple destructuring
+    TypeExprPtr type = nullptr;  // null if not annotated
     bool is_mutable;
     bool is_const;
-    ExprPtr initializer;
+    ExprPtr initializer = nullptr;
 
     // Single variable
-    LetStmt(std::string name, std::string type, bool mut, bool is_const, ExprPtr init)
-        : name(std::move(name)), type_name(std::move(type)), is_mutable(mut), is_const(is_const),
-          initializer(std::move(init)) {}
+    LetStmt(Name name, TypeExprPtr type, bool mut, bool is_const, ExprPtr init)
+        : Stmt(Kind), name(name), type(type), is_mutable(mut), is_const(is_const),
+          initializer(init) {}
 
     // Tuple destructuring
-    LetStmt(std::vector<std::string> tuple_names, std::string type, bool mut, bool is_const,
+    LetStmt(std::span<Name> tuple_names, TypeExprPtr type, bool mut, bool is_const,
             ExprPtr init)
-        : name(""), tuple_names(std::move(tuple_names)), type_name(std::move(type)),
-          is_mutable(mut), is_const(is_const), initializer(std::move(init)) {}
+        : Stmt(Kind), tuple_names(tuple_names), type(type), is_mutable(mut), is_const(is_const),
+          initializer(init) {}
 
-    std::unique_ptr<Node> clone() const override {
+    Stmt* clone(AstContext& ctx) const override {
         if (tuple_names.empty()) {
-            return std::make_unique<LetStmt>(
-                name, type_name, is_mutable, is_const,
-                std::unique_ptr<Expr>(static_cast<Expr*>(initializer->clone().release())));
+            return ctx.make<LetStmt>(name, clone_node(type, ctx), is_mutable, is_const,
+                                     initializer->clone(ctx));
         } else {
-            return std::make_unique<LetStmt>(
-                tuple_names, type_name, is_mutable, is_const,
-                std::unique_ptr<Expr>(static_cast<Expr*>(initializer->clone().release())));
+            std::span<Name> names = ctx.list<Name>(tuple_names.size());
+            std::copy(tuple_names.begin(), tuple_names.end(), names.begin());
+            return ctx.make<LetStmt>(names, clone_node(type, ctx), is_mutable, is_const,
+                                     initializer->clone(ctx));
         }
     }
 };
 
 struct ReturnStmt : Stmt {
-    ExprPtr expression;
+    static constexpr StmtKind Kind = StmtKind::Return;
+    ExprPtr expression = nullptr;
 
-    explicit ReturnStmt(ExprPtr expr) : expression(std::move(expr)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<ReturnStmt>(
-            expression ? std::unique_ptr<Expr>(static_cast<Expr*>(expression->clone().release()))
-                       : nullptr);
+    explicit ReturnStmt(ExprPtr expr) : Stmt(Kind), expression(expr) {}
+    Stmt* clone(AstContext& ctx) const override {
+        return ctx.make<ReturnStmt>(clone_node(expression, ctx));
     }
 };
 
 struct ExprStmt : Stmt {
-    ExprPtr expression;
+    static constexpr StmtKind Kind = StmtKind::Expr;
+    ExprPtr expression = nullptr;
 
-    explicit ExprStmt(ExprPtr expr) : expression(std::move(expr)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<ExprStmt>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(expression->clone().release())));
+    explicit ExprStmt(ExprPtr expr) : Stmt(Kind), expression(expr) {}
+    Stmt* clone(AstContext& ctx) const override {
+        return ctx.make<ExprStmt>(expression->clone(ctx));
     }
 };
 
 struct IfStmt : Stmt {
-    ExprPtr condition;
-    StmtPtr then_branch;
-    StmtPtr else_branch; // can be null
+    static constexpr StmtKind Kind = StmtKind::If;
+    ExprPtr condition = nullptr;
+    StmtPtr then_branch = nullptr;
+    StmtPtr else_branch = nullptr; // can be null
 
     IfStmt(ExprPtr cond, StmtPtr then_b, StmtPtr else_b)
-        : condition(std::move(cond)), then_branch(std::move(then_b)),
-          else_branch(std::move(else_b)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<IfStmt>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(condition->clone().release())),
-            std::unique_ptr<Stmt>(static_cast<Stmt*>(then_branch->clone().release())),
-            else_branch ? std::unique_ptr<Stmt>(static_cast<Stmt*>(else_branch->clone().release()))
-                        : nullptr);
+        : Stmt(Kind), condition(cond), then_branch(then_b), else_branch(else_b) {}
+    Stmt* clone(AstContext& ctx) const override {
+        return ctx.make<IfStmt>(condition->clone(ctx), then_branch->clone(ctx),
+                                clone_node(else_branch, ctx));
     }
 };
 
 struct WhileStmt : Stmt {
-    ExprPtr condition;
-    StmtPtr body;
+    static constexpr StmtKind Kind = StmtKind::While;
+    ExprPtr condition = nullptr;
+    StmtPtr body = nullptr;
 
-    WhileStmt(ExprPtr cond, StmtPtr body) : condition(std::move(cond)), body(std::move(body)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<WhileStmt>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(condition->clone().release())),
-            std::unique_ptr<Stmt>(static_cast<Stmt*>(body->clone().release())));
+    WhileStmt(ExprPtr cond, StmtPtr body) : Stmt(Kind), condition(cond), body(body) {}
+    Stmt* clone(AstContext& ctx) const override {
+        return ctx.make<WhileStmt>(condition->clone(ctx), body->clone(ctx));
     }
 };
 
 struct ForStmt : Stmt {
-    std::string variable;
-    std::string var_type; // optional type annotation (empty if not provided)
-    ExprPtr iterable;
-    StmtPtr body;
-
-    ForStmt(std::string var, std::string type, ExprPtr iter, StmtPtr body)
-        : variable(std::move(var)), var_type(std::move(type)), iterable(std::move(iter)),
-          body(std::move(body)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<ForStmt>(
-            variable, var_type,
-            std::unique_ptr<Expr>(static_cast<Expr*>(iterable->clone().release())),
-            std::unique_ptr<Stmt>(static_cast<Stmt*>(body->clone().release())));
+    static constexpr StmtKind Kind = StmtKind::For;
+    Name variable;
+    TypeExprPtr var_type = nullptr; // optional type annotation (null if not provided)
+    ExprPtr iterable = nullptr;
+    StmtPtr body = nullptr;
+
+    ForStmt(Name var, TypeExprPtr type, ExprPtr iter, StmtPtr body)
+        : Stmt(Kind), variable(var), var_type(type), iterable(iter), body(body) {}
+    Stmt* clone(AstContext& ctx) const override {
+        return ctx.make<ForStmt>(variable, clone_node(var_type, ctx), iterable->clone(ctx),
+                                 body->clone(ctx));
     }
 };
 
 struct LoopStmt : Stmt {
-    StmtPtr body;
-    explicit LoopStmt(StmtPtr b) : body(std::move(b)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<LoopStmt>(
-            std::unique_ptr<Stmt>(static_cast<Stmt*>(body->clone().release())));
+    static constexpr StmtKind Kind = StmtKind::Loop;
+    StmtPtr body = nullptr;
+    explicit LoopStmt(StmtPtr b) : Stmt(Kind), body(b) {}
+    Stmt* clone(AstContext& ctx) const override {
+        return ctx.make<LoopStmt>(body->clone(ctx));
     }
 };
 
 struct BreakStmt : Stmt {
-    ExprPtr value; // optional
-    explicit BreakStmt(ExprPtr v = nullptr) : value(std::move(v)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<BreakStmt>(
-            value ? std::unique_ptr<Expr>(static_cast<Expr*>(value->clone().release())) : nullptr);
+    static constexpr StmtKind Kind = StmtKind::Break;
+    ExprPtr value = nullptr; // optional
+    explicit BreakStmt(ExprPtr v = nullptr) : Stmt(Kind), value(v) {}
+    Stmt* clone(AstContext& ctx) const override {
+        return ctx.make<BreakStmt>(clone_node(value, ctx));
     }
 };
 struct ContinueStmt : Stmt {
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<ContinueStmt>();
+    static constexpr StmtKind Kind = StmtKind::Continue;
+    ContinueStmt() : Stmt(Kind) {}
+    Stmt* clone(AstContext& ctx) const override {
+        return ctx.make<ContinueStmt>();
     }
 };
 
 struct AssignStmt : Stmt {
-    ExprPtr target;
-    ExprPtr value;
+    static constexpr StmtKind Kind = StmtKind::Assign;
+    ExprPtr target = nullptr;
+    ExprPtr value = nullptr;
     TokenKind op; // Assign, PlusAssign, MinusAssign, etc.
 
     AssignStmt(ExprPtr target, ExprPtr value, TokenKind op = TokenKind::Assign)
-        : target(std::move(target)), value(std::move(value)), op(op) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<AssignStmt>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(target->clone().release())),
-            std::unique_ptr<Expr>(static_cast<Expr*>(value->clone().release())), op);
+        : Stmt(Kind), target(target), value(value), op(op) {}
+    Stmt* clone(AstContext& ctx) const override {
+        return ctx.make<AssignStmt>(target->clone(ctx), value->clone(ctx), op);
     }
 };
 
@@ -427,138 +590,139 @@ struct AssignStmt : Stmt {
    Patterns
    ======================= */
 
+enum class PatternKind : std::uint8_t {
+    Literal,
+    Identifier,
+    Wildcard,
+    Variant,
+    Tuple,
+    Struct,
+    Range,
+    Or,
+};
+
 struct Pattern : Node {
-    virtual ~Pattern() override = default;
+    const PatternKind kind;
+
+    virtual Pattern* clone(AstContext& ctx) const = 0;
+
+  protected:
+    explicit Pattern(PatternKind k) : kind(k) {}
+    ~Pattern() = default;
 };
 
-using PatternPtr = std::unique_ptr<Pattern>;
+using PatternPtr = Pattern*;
 
 struct LiteralPattern : Pattern {
-    ExprPtr literal;
-    explicit LiteralPattern(ExprPtr lit) : literal(std::move(lit)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<LiteralPattern>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(literal->clone().release())));
+    static constexpr PatternKind Kind = PatternKind::Literal;
+    ExprPtr literal = nullptr;
+    explicit LiteralPattern(ExprPtr lit) : Pattern(Kind), literal(lit) {}
+    Pattern* clone(AstContext& ctx) const override {
+        return ctx.make<LiteralPattern>(literal->clone(ctx));
     }
 };
 
 struct IdentifierPattern : Pattern {
-    std::string name;
-    explicit IdentifierPattern(std::string n) : name(std::move(n)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<IdentifierPattern>(name);
+    static constexpr PatternKind Kind = PatternKind::Identifier;
+    Name name;
+    explicit IdentifierPattern(Name n) : Pattern(Kind), name(n) {}
+    Pattern* clone(AstContext& ctx) const override {
+        return ctx.make<IdentifierPattern>(name);
     }
 };
 
 struct WildcardPattern : Pattern {
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<WildcardPattern>();
+    static constexpr PatternKind Kind = PatternKind::Wildcard;
+    WildcardPattern() : Pattern(Kind) {}
+    Pattern* clone(AstContext& ctx) const override {
+        return ctx.make<WildcardPattern>();
     }
 };
 
 struct VariantPattern : Pattern {
+    static constexpr PatternKind Kind = PatternKind::Variant;
     std::string variant_name;
-    std::vector<PatternPtr> sub_patterns;
+    std::span<PatternPtr> sub_patterns;
 
-    VariantPattern(std::string name, std::vector<PatternPtr> sub)
-        : variant_name(std::move(name)), sub_patterns(std::move(sub)) {}
-    std::unique_ptr<Node> clone() const override {
-        std::vector<PatternPtr> new_subs;
-        new_subs.reserve(sub_patterns.size());
-        for (const auto& p : sub_patterns)
-            new_subs.push_back(
-                std::unique_ptr<Pattern>(static_cast<Pattern*>(p->clone().release())));
-        return std::make_unique<VariantPattern>(variant_name, std::move(new_subs));
+    VariantPattern(std::string name, std::span<PatternPtr> sub)
+        : Pattern(Kind), variant_name(std::move(name)), sub_patterns(sub) {}
+    Pattern* clone(AstContext& ctx) const override {
+        return ctx.make<VariantPattern>(variant_name, clone_nodes(sub_patterns, ctx));
     }
 };
 
 struct TuplePattern : Pattern {
-    std::vector<PatternPtr> elements;
-    TuplePattern(std::vector<PatternPtr> elems) : elements(std::move(elems)) {}
-    std::unique_ptr<Node> clone() const override {
-        std::vector<PatternPtr> new_elems;
-        new_elems.reserve(elements.size());
-        for (const auto& e : elements)
-            new_elems.push_back(
-                std::unique_ptr<Pattern>(static_cast<Pattern*>(e->clone().release())));
-        return std::make_unique<TuplePattern>(std::move(new_elems));
+    static constexpr PatternKind Kind = PatternKind::Tuple;
+    std::span<PatternPtr> elements;
+    TuplePattern(std::span<PatternPtr> elems) : Pattern(Kind), elements(elems) {}
+    Pattern* clone(AstContext& ctx) const override {
+        return ctx.make<TuplePattern>(clone_nodes(elements, ctx));
     }
 };
 
 struct FieldPattern {
-    std::string field_name;
-    PatternPtr pattern;
+    Name field_name;
+    PatternPtr pattern = nullptr;
 };
 
 struct StructPattern : Pattern {
+    static constexpr PatternKind Kind = PatternKind::Struct;
     std::string struct_name;
-    std::vector<FieldPattern> fields;
-
-    StructPattern(std::string name, std::vector<FieldPattern> fds)
-        : struct_name(std::move(name)), fields(std::move(fds)) {}
-    std::unique_ptr<Node> clone() const override {
-        std::vector<FieldPattern> new_fields;
-        new_fields.reserve(fields.size());
-        for (const auto& f : fields) {
-            new_fields.push_back({f.field_name, std::unique_ptr<Pattern>(static_cast<Pattern*>(
-                                                    f.pattern->clone().release()))});
-        }
-        return std::make_unique<StructPattern>(struct_name, std::move(new_fields));
+    std::span<FieldPattern> fields;
+
+    StructPattern(std::string name, std::span<FieldPattern> fds)
+        : Pattern(Kind), struct_name(std::move(name)), fields(fds) {}
+    Pattern* clone(AstContext& ctx) const override {
+        std::span<FieldPattern> new_fields = ctx.list<FieldPattern>(fields.size());
+        for (std::size_t i = 0; i < fields.size(); ++i)
+            new_fields[i] = {fields[i].field_name, fields[i].pattern->clone(ctx)};
+        return ctx.make<StructPattern>(struct_name, new_fields);
     }
 };
 
 struct RangePattern : Pattern {
-    ExprPtr start;
-    ExprPtr end;
+    static constexpr PatternKind Kind = PatternKind::Range;
+    ExprPtr start = nullptr;
+    ExprPtr end = nullptr;
     bool is_inclusive;
 
     RangePattern(ExprPtr s, ExprPtr e, bool inc)
-        : start(std::move(s)), end(std::move(e)), is_inclusive(inc) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<RangePattern>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(start->clone().release())),
-            std::unique_ptr<Expr>(static_cast<Expr*>(end->clone().release())), is_inclusive);
+        : Pattern(Kind), start(s), end(e), is_inclusive(inc) {}
+    Pattern* clone(AstContext& ctx) const override {
+        return ctx.make<RangePattern>(start->clone(ctx), end->clone(ctx), is_inclusive);
     }
 };
 
 struct OrPattern : Pattern {
-    std::vector<PatternPtr> alternatives;
+    static constexpr PatternKind Kind = PatternKind::Or;
+    std::span<PatternPtr> alternatives;
 
-    OrPattern(std::vector<PatternPtr> alts) : alternatives(std::move(alts)) {}
-    std::unique_ptr<Node> clone() const override {
-        std::vector<PatternPtr> new_alts;
-        new_alts.reserve(alternatives.size());
-        for (const auto& a : alternatives)
-            new_alts.push_back(
-                std::unique_ptr<Pattern>(static_cast<Pattern*>(a->clone().release())));
-        return std::make_unique<OrPattern>(std::move(new_alts));
+    OrPattern(std::span<PatternPtr> alts) : Pattern(Kind), alternatives(alts) {}
+    Pattern* clone(AstContext& ctx) const override {
+        return ctx.make<OrPattern>(clone_nodes(alternatives, ctx));
     }
 };
 
 struct MatchArm {
-    PatternPtr pattern;
-    ExprPtr guard; // optional match guard (if condition)
-    StmtPtr body;
+    PatternPtr pattern = nullptr;
+    ExprPtr guard = nullptr; // optional match guard (if condition)
+    StmtPtr body = nullptr;
 };
 
 struct MatchStmt : Stmt {
-    ExprPtr expression;
-    std::vector<MatchArm> arms;
-
-    MatchStmt(ExprPtr expr, std::vector<MatchArm> match_arms)
-        : expression(std::move(expr)), arms(std::move(match_arms)) {}
-    std::unique_ptr<Node> clone() const override {
-        std::vector<MatchArm> new_arms;
-        for (const auto& arm : arms) {
-            new_arms.push_back(
-                {std::unique_ptr<Pattern>(static_cast<Pattern*>(arm.pattern->clone().release())),
-                 arm.guard ? std::unique_ptr<Expr>(static_cast<Expr*>(arm.guard->clone().release()))
-                           : nullptr,
-                 std::unique_ptr<Stmt>(static_cast<Stmt*>(arm.body->clone().release()))});
+    static constexpr StmtKind Kind = StmtKind::Match;
+    ExprPtr expression = nullptr;
+    std::span<MatchArm> arms;
+
+    MatchStmt(ExprPtr expr, std::span<MatchArm> match_arms)
+        : Stmt(Kind), expression(expr), arms(match_arms) {}
+    Stmt* clone(AstContext& ctx) const override {
+        std::span<MatchArm> new_arms = ctx.list<MatchArm>(arms.size());
+        for (std::size_t i = 0; i < arms.size(); ++i) {
+            new_arms[i] = {arms[i].pattern->clone(ctx), clone_node(arms[i].guard, ctx),
+                           arms[i].body->clone(ctx)};
         }
-        return std::make_unique<MatchStmt>(
-            std::unique_ptr<Expr>(static_cast<Expr*>(expression->clone().release())),
-            std::move(new_arms));
+        return ctx.make<MatchStmt>(expression->clone(ctx), new_arms);
     }
 };
 
@@ -567,26 +731,21 @@ struct MatchStmt : Stmt {
    ======================= */
 
 struct Block : Node {
-    std::vector<StmtPtr> statements;
-    std::unique_ptr<Node> clone() const override {
-        auto new_block = std::make_unique<Block>();
-        for (const auto& stmt : statements) {
-            new_block->statements.push_back(
-                std::unique_ptr<Stmt>(static_cast<Stmt*>(stmt->clone().release())));
-        }
+    std::span<StmtPtr> statements;
+    Block clone(AstContext& ctx) const {
+        Block new_block;
+        new_block.statements = clone_nodes(statements, ctx);
         return new_block;
     }
 };
 
 struct BlockStmt : Stmt {
+    static constexpr StmtKind Kind = StmtKind::Block;
+    BlockStmt() : Stmt(Kind) {}
     Block block; // stored by value
-    std::unique_ptr<Node> clone() const override {
-        auto new_stmt = std::make_unique<BlockStmt>();
-        // Manually clone the block's content since Block is not copyable (contains unique_ptrs)
-        for (const auto& stmt : block.statements) {
-            new_stmt->block.statements.push_back(
-                std::unique_ptr<Stmt>(static_cast<Stmt*>(stmt->clone().release())));
-        }
+    Stmt* clone(AstContext& ctx) const override {
+        auto* new_stmt = ctx.make<BlockStmt>();
+        new_stmt->block = block.clone(ctx);
         return new_stmt;
     }
 };
@@ -596,48 +755,89 @@ struct BlockStmt : Stmt {
    ======================= */
 
 struct Param {
-    std::string name;
-    std::string type;
+    Name name;
+    TypeExprPtr type = nullptr;
+
+    Param clone(AstContext& ctx) const {
+        return {name, clone_node(type, ctx)};
+    }
 };
 
-struct AssociatedType : Node {
-    std::string name;
-    std::string default_type; // Optional for trait declarations
+// One `T: Trait + Other` entry of a where clause.
+struct WherePredicate {
+    Name param;
+    std::vector<TypeExprPtr> bounds;
+
+    WherePredicate clone(AstContext& ctx) const {
+        WherePredicate p{param, {}};
+        for (const TypeExpr* bound : bounds)
+            p.bounds.push_back(bound->clone(ctx));
+        return p;
+    }
+};
+
+using WhereClause = std::vector<WherePredicate>;
+
+// Copies of declaration parts whose types live in an AstContext.
+template <typename T> std::vector<T> clone_all(const std::vector<T>& items, AstContext& ctx) {
+    std::vector<T> copy;
+    copy.reserve(items.size());
+    for (const T& item : items)
+        copy.push_back(item.clone(ctx));
+    return copy;
+}
 
-    AssociatedType(std::string n, std::string d = "")
-        : name(std::move(n)), default_type(std::move(d)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<AssociatedType>(name, default_type);
+struct AssociatedType : Node {
+    Name name;
+    TypeExprPtr default_type = nullptr; // Optional for trait declarations
+
+    explicit AssociatedType(Name n, TypeExprPtr d = nullptr) : name(n), default_type(d) {}
+    AssociatedType clone(AstContext& ctx) const {
+        AssociatedType a(name, clone_node(default_type, ctx));
+        a.loc = loc;
+        return a;
     }
 };
 
 struct FunctionDecl : Node {
-    std::string name;
+    Name name;
     std::vector<std::string> type_params;
     std::vector<Param> params;
-    std::string return_type;
+    TypeExprPtr return_type = nullptr; // null if omitted
     Block body;
     Visibility visibility = Visibility::None;
     bool is_async = false;
     bool is_external = false;
     bool has_body = false;
-    std::string where_clause; // raw string for now
-
-    std::unique_ptr<Node> clone() const override {
-        auto new_fn = std::make_unique<FunctionDecl>();
-        new_fn->name = name;
-        new_fn->type_params = type_params;
-        new_fn->params = params;
-        new_fn->return_type = return_type;
-        for (const auto& stmt : body.statements) {
-            new_fn->body.statements.push_back(
-                std::unique_ptr<Stmt>(static_cast<Stmt*>(stmt->clone().release())));
-        }
-        new_fn->visibility = visibility;
-        new_fn->is_async = is_async;
-        new_fn->is_external = is_external;
-        new_fn->has_body = has_body;
-        new_fn->where_clause = where_clause;
+    WhereClause where_clause;
+
+    // Copies the declaration, deep-copying the types and body into `ctx`.
+    FunctionDecl clone(AstContext& ctx) const {
+        FunctionDecl new_fn;
+        new_fn.name = name;
+        new_fn.type_params = type_params;
+        new_fn.params = clone_all(params, ctx);
+        new_fn.return_type = clone_node(return_type, ctx);
+        new_fn.body = body.clone(ctx);
+        new_fn.visibility = visibility;
+        new_fn.is_async = is_async;
+        new_fn.is_external = is_external;
+        new_fn.has_body = has_body;
+        new_fn.where_clause = clone_all(where_clause, ctx);
+        return new_fn;
+    }
+
+    // clone() without the body: the signature of a function compiled elsewhere.
+    FunctionDecl clone_signature(AstContext& ctx) const {
+        FunctionDecl new_fn;
+        new_fn.name = name;
+        new_fn.type_params = type_params;
+        new_fn.params = clone_all(params, ctx);
+        new_fn.return_type = clone_node(return_type, ctx);
+        new_fn.visibility = visibility;
+        new_fn.is_async = is_async;
+        new_fn.is_external = is_external;
+        new_fn.where_clause = clone_all(where_clause, ctx);
         return new_fn;
     }
 };
@@ -647,70 +847,81 @@ struct FunctionDecl : Node {
    ======================= */
 
 struct Field {
-    std::string name;
-    std::string type;
+    Name name;
+    TypeExprPtr type = nullptr;
     Visibility visibility = Visibility::None;
+
+    Field clone(AstContext& ctx) const {
+        return {name, type->clone(ctx), visibility};
+    }
 };
 
 struct StructDecl : Node {
-    std::string name;
+    Name name;
     std::vector<std::string> type_params;
     std::vector<Field> fields;
     Visibility visibility = Visibility::None;
-    std::string where_clause;
+    WhereClause where_clause;
 
     // Default constructor for vector/etc
     StructDecl() = default;
 
-    StructDecl(std::string name, std::vector<std::string> type_params, std::vector<Field> fields)
-        : name(std::move(name)), type_params(std::move(type_params)), fields(std::move(fields)) {}
+    StructDecl(Name name, std::vector<std::string> type_params, std::vector<Field> fields)
+        : name(name), type_params(std::move(type_params)), fields(std::move(fields)) {}
 
-    std::unique_ptr<Node> clone() const override {
-        auto s = std::make_unique<StructDecl>(name, type_params, fields);
-        s->visibility = visibility;
-        s->where_clause = where_clause;
+    StructDecl clone(AstContext& ctx) const {
+        StructDecl s = *this;
+        s.fields = clone_all(fields, ctx);
+        s.where_clause = clone_all(where_clause, ctx);
         return s;
     }
 };
 
 struct ClassDecl : Node {
-    std::string name;
+    Name name;
     std::vector<std::string> type_params;
     std::vector<Field> fields;
     Visibility visibility = Visibility::None;
-    std::string where_clause;
+    WhereClause where_clause;
 
-    ClassDecl(std::string name, std::vector<std::string> type_params, std::vector<Field> fields)
-        : name(std::move(name)), type_params(std::move(type_params)), fields(std::move(fields)) {}
+    ClassDecl(Name name, std::vector<std::string> type_params, std::vector<Field> fields)
+        : name(name), type_params(std::move(type_params)), fields(std::move(fields)) {}
 
-    std::unique_ptr<Node> clone() const override {
-        auto c = std::make_unique<ClassDecl>(name, type_params, fields);
-        c->visibility = visibility;
-        c->where_clause = where_clause;
+    ClassDecl clone(AstContext& ctx) const {
+        ClassDecl c = *this;
+        c.fields = clone_all(fields, ctx);
+        c.where_clause = clone_all(where_clause, ctx);
         return c;
     }
 };
 
 struct Variant {
-    std::string name;
-    std::vector<std::string> types; // tuple variants for now
+    Name name;
+    std::vector<TypeExprPtr> types; // tuple variants for now
+
+    Variant clone(AstContext& ctx) const {
+        Variant v{name, {}};
+        for (const TypeExpr* type : types)
+            v.types.push_back(type->clone(ctx));
+        return v;
+    }
 };
 
 struct EnumDecl : Node {
-    std::string name;
+    Name name;
     std::vector<std::string> type_params;
     std::vector<Variant> variants;
     Visibility visibility = Visibility::None;
-    std::string where_clause;
+    WhereClause where_clause;
 
-    EnumDecl(std::string name, std::vector<std::string> type_params, std::vector<Variant> variants)
-        : name(std::move(name)), type_params(std::move(type_params)),
+    EnumDecl(Name name, std::vector<std::string> type_params, std::vector<Variant> variants)
+        : name(name), type_params(std::move(type_params)),
           variants(std::move(variants)) {}
 
-    std::unique_ptr<Node> clone() const override {
-        auto e = std::make_unique<EnumDecl>(name, type_params, variants);
-        e->visibility = visibility;
-        e->where_clause = where_clause;
+    EnumDecl clone(AstContext& ctx) const {
+        EnumDecl e = *this;
+        e.variants = clone_all(variants, ctx);
+        e.where_clause = clone_all(where_clause, ctx);
         return e;
     }
 };
@@ -721,71 +932,52 @@ struct ImplBlock : Node {
     std::string trait_name; // empty if not a trait impl
     std::vector<FunctionDecl> methods;
     std::vector<AssociatedType> associated_types;
-    std::string where_clause; // raw string for now
+    WhereClause where_clause;
 
     ImplBlock(std::vector<std::string> type_params, std::string target,
               std::vector<FunctionDecl> methods)
         : type_params(std::move(type_params)), target_name(std::move(target)),
           methods(std::move(methods)) {}
 
-    std::unique_ptr<Node> clone() const override {
-        std::vector<FunctionDecl> new_methods;
-        new_methods.reserve(methods.size());
-        for (const auto& m : methods) {
-            auto ptr = m.clone();
-            new_methods.push_back(std::move(*static_cast<FunctionDecl*>(ptr.get())));
-        }
-        auto i = std::make_unique<ImplBlock>(type_params, target_name, std::move(new_methods));
-        i->trait_name = trait_name;
-        for (const auto& at : associated_types) {
-            i->associated_types.emplace_back(at.name, at.default_type);
-        }
-        i->where_clause = where_clause;
+    ImplBlock clone(AstContext& ctx) const {
+        ImplBlock i(type_params, target_name, clone_all(methods, ctx));
+        i.trait_name = trait_name;
+        i.associated_types = clone_all(associated_types, ctx);
+        i.where_clause = clone_all(where_clause, ctx);
         return i;
     }
 };
 
 struct TraitDecl : Node {
-    std::string name;
+    Name name;
     std::vector<std::string> type_params;
     std::vector<FunctionDecl> methods; // potentially just signatures later
     std::vector<AssociatedType> associated_types;
     Visibility visibility = Visibility::None;
-    std::string where_clause; // raw string for now
+    WhereClause where_clause;
 
-    TraitDecl(std::string name, std::vector<std::string> type_params,
-              std::vector<FunctionDecl> methods)
-        : name(std::move(name)), type_params(std::move(type_params)), methods(std::move(methods)) {}
-
-    std::unique_ptr<Node> clone() const override {
-        std::vector<FunctionDecl> new_methods;
-        new_methods.reserve(methods.size());
-        for (const auto& m : methods) {
-            auto ptr = m.clone();
-            new_methods.push_back(std::move(*static_cast<FunctionDecl*>(ptr.get())));
-        }
-        auto t = std::make_unique<TraitDecl>(name, type_params, std::move(new_methods));
-        t->visibility = visibility;
-        for (const auto& at : associated_types) {
-            t->associated_types.emplace_back(at.name, at.default_type);
-        }
-        t->where_clause = where_clause;
+    TraitDecl(Name name, std::vector<std::string> type_params, std::vector<FunctionDecl> methods)
+        : name(name), type_params(std::move(type_params)), methods(std::move(methods)) {}
+
+    TraitDecl clone(AstContext& ctx) const {
+        TraitDecl t(name, type_params, clone_all(methods, ctx));
+        t.visibility = visibility;
+        t.associated_types = clone_all(associated_types, ctx);
+        t.where_clause = clone_all(where_clause, ctx);
         return t;
     }
 };
 
 struct TypeAlias : Node {
-    std::string name;
-    std::string target_type;
+    Name name;
+    TypeExprPtr target_type = nullptr;
     Visibility visibility = Visibility::None;
 
-    TypeAlias(std::string name, std::string target)
-        : name(std::move(name)), target_type(std::move(target)) {}
-
-    std::unique_ptr<Node> clone() const override {
-        auto ta = std::make_unique<TypeAlias>(name, target_type);
-        ta->visibility = visibility;
-        return ta;
+    TypeAlias(Name name, TypeExprPtr target) : name(name), target_type(target) {}
+    TypeAlias clone(AstContext& ctx) const {
+        TypeAlias a = *this;
+        a.target_type = target_type->clone(ctx);
+        return a;
     }
 };
 
@@ -803,12 +995,9 @@ struct Annotation {
    ======================= */
 
 struct Import : Node {
-    std::string module_path;
+    Name module_path;
 
-    explicit Import(std::string path) : module_path(std::move(path)) {}
-    std::unique_ptr<Node> clone() const override {
-        return std::make_unique<Import>(module_path);
-    }
+    explicit Import(Name path) : module_path(path) {}
 };
 
 /* =======================
@@ -816,7 +1005,7 @@ struct Import : Node {
    ======================= */
 
 struct Module : Node {
-    std::string name;
+    Name name;
     std::vector<Import> imports;
     std::vector<FunctionDecl> functions;
     std::vector<StructDecl> structs;
@@ -826,39 +1015,22 @@ struct Module : Node {
     std::vector<TraitDecl> traits;
     std::vector<TypeAlias> type_aliases;
 
-    std::unique_ptr<Node> clone() const override {
-        auto m = std::make_unique<Module>();
-        m->name = name;
-        for (const auto& imp : imports)
-            m->imports.push_back(Import(imp.module_path));
-        for (const auto& f : functions) {
-            auto ptr = f.clone();
-            m->functions.push_back(std::move(*static_cast<FunctionDecl*>(ptr.get())));
-        }
-        for (const auto& s : structs) {
-            auto ptr = s.clone();
-            m->structs.push_back(std::move(*static_cast<StructDecl*>(ptr.get())));
-        }
-        for (const auto& c : classes) {
-            auto ptr = c.clone();
-            m->classes.push_back(std::move(*static_cast<ClassDecl*>(ptr.get())));
-        }
-        for (const auto& e : enums) {
-            auto ptr = e.clone();
-            m->enums.push_back(std::move(*static_cast<EnumDecl*>(ptr.get())));
-        }
-        for (const auto& i : impls) {
-            auto ptr = i.clone();
-            m->impls.push_back(std::move(*static_cast<ImplBlock*>(ptr.get())));
-        }
-        for (const auto& t : traits) {
-            auto ptr = t.clone();
-            m->traits.push_back(std::move(*static_cast<TraitDecl*>(ptr.get())));
-        }
-        for (const auto& ta : type_aliases) {
-            auto ptr = ta.clone();
-            m->type_aliases.push_back(std::move(*static_cast<TypeAlias*>(ptr.get())));
-        }
+    // Owns the module's expression, statement and pattern nodes. Shared with the Parser
+    // that built them, so expressions it returned stay valid while either is alive.
+    std::shared_ptr<AstContext> context = std::make_shared<AstContext>();
+
+    // A deep copy with its own context.
+    Module clone() const {
+        Module m;
+        m.name = name;
+        m.imports = imports;
+        m.functions = clone_all(functions, *m.context);
+        m.structs = clone_all(structs, *m.context);
+        m.classes = clone_all(classes, *m.context);
+        m.enums = clone_all(enums, *m.context);
+        m.impls = clone_all(impls, *m.context);
+        m.traits = clone_all(traits, *m.context);
+        m.type_aliases = clone_all(type_aliases, *m.context);
         return m;
     }
 };
@@ -0,0 +1,17 @@
+#include "ast_context.h"
+
+#include <algorithm>
+
+namespace flux::ast {
+AstContext::~AstContext() {
+    for (auto it = cleanups_.rbegin(); it != cleanups_.rend(); ++it)
+        it->destroy(it->objects, it->count);
+}
+
+void AstContext::grow(std::size_t min_size) {
+    const std::size_t size = std::max(kChunkSize, min_size);
+    chunks_.push_back(std::make_unique_for_overwrite<std::byte[]>(size));
+    cursor_ = chunks_.back().get();
+    end_ = cursor_ + size;
+}
+} // namespace flux::ast
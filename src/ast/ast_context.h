@@ -0,0 +1,108 @@
+#ifndef FLUX_AST_CONTEXT_H
+#define FLUX_AST_CONTEXT_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace flux::ast {
+// Owns every expression, statement and pattern node of one module, along with their child
+// lists. Nodes are placed by bumping a pointer through large chunks and are never freed
+// one at a time: the whole tree goes away with the context. Nodes that hold strings or
+// other owning members have their destructors run, in reverse order, when the context is
+// destroyed; trivially destructible nodes cost nothing to tear down.
+//
+// Not thread-safe; each module (and each parser) has its own context.
+class AstContext {
+  public:
+    AstContext() = default;
+    ~AstContext();
+    AstContext(const AstContext&) = delete;
+    AstContext& operator=(const AstContext&) = delete;
+
+    template <typename T, typename... Args> T* make(Args&&... args) {
+        T* node = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        ++nodes_;
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            add_cleanup(node, 1, &destroy<T>);
+        return node;
+    }
+
+    // Moves `items` into the arena. An empty list does not allocate.
+    template <typename T> std::span<T> list(std::vector<T>&& items) {
+        if (items.empty())
+            return {};
+        T* data = static_cast<T*>(allocate(sizeof(T) * items.size(), alignof(T)));
+        std::uninitialized_move(items.begin(), items.end(), data);
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            add_cleanup(data, items.size(), &destroy<T>);
+        return {data, items.size()};
+    }
+
+    // A list of `size` value-initialized elements, for filling in place.
+    template <typename T> std::span<T> list(std::size_t size) {
+        if (size == 0)
+            return {};
+        T* data = static_cast<T*>(allocate(sizeof(T) * size, alignof(T)));
+        std::uninitialized_value_construct_n(data, size);
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            add_cleanup(data, size, &destroy<T>);
+        return {data, size};
+    }
+
+    // Bytes handed out so far, including alignment padding.
+    std::size_t bytes_allocated() const {
+        return bytes_allocated_;
+    }
+
+    // Nodes made with make() so far.
+    std::size_t nodes() const {
+        return nodes_;
+    }
+
+  private:
+    static constexpr std::size_t kChunkSize = 64 * 1024;
+
+    struct Cleanup {
+        void (*destroy)(void*, std::size_t);
+        void* objects;
+        std::size_t count;
+    };
+
+    template <typename T> static void destroy(void* objects, std::size_t count) {
+        std::destroy_n(static_cast<T*>(objects), count);
+    }
+
+    void* allocate(std::size_t size, std::size_t align) {
+        std::size_t pad = (align - reinterpret_cast<std::size_t>(cursor_) % align) % align;
+        if (pad + size > static_cast<std::size_t>(end_ - cursor_)) {
+            grow(size + align);
+            pad = (align - reinterpret_cast<std::size_t>(cursor_) % align) % align;
+        }
+        void* p = cursor_ + pad;
+        cursor_ += pad + size;
+        bytes_allocated_ += pad + size;
+        return p;
+    }
+
+    void add_cleanup(void* objects, std::size_t count, void (*fn)(void*, std::size_t)) {
+        cleanups_.push_back({fn, objects, count});
+    }
+
+    // Starts a new chunk of at least `min_size` bytes.
+    void grow(std::size_t min_size);
+
+    std::vector<std::unique_ptr<std::byte[]>> chunks_;
+    std::byte* cursor_ = nullptr;
+    std::byte* end_ = nullptr;
+    std::size_t bytes_allocated_ = 0;
+    std::size_t nodes_ = 0;
+    std::vector<Cleanup> cleanups_;
+};
+} // namespace flux::ast
+
+#endif // FLUX_AST_CONTEXT_H
@@ -1,4 +1,5 @@
 #include "ast_printer.h"
+#include "ast_visitor.h"
 #include <iostream>
 
 namespace flux::ast {
@@ -32,7 +33,7 @@ void ASTPrinter::print_module(const Module& module) {
     }
     for (const auto& ta : module.type_aliases) {
         indent();
-        std::cout << "TypeAlias " << ta.name << " = " << ta.target_type << '\n';
+        std::cout << "TypeAlias " << ta.name << " = " << spelling(ta.target_type) << '\n';
     }
     for (const auto& s : module.structs) {
         print_struct(s);
@@ -43,7 +44,7 @@ void ASTPrinter::print_module(const Module& module) {
         indent_level_++;
         for (const auto& field : c.fields) {
             indent();
-            std::cout << "Field " << field.name << " : " << field.type << '\n';
+            std::cout << "Field " << field.name << " : " << spelling(field.type) << '\n';
         }
         indent_level_--;
     }
@@ -85,7 +86,7 @@ void ASTPrinter::print_function(const FunctionDecl& fn) {
         }
         std::cout << ">";
     }
-    std::cout << " -> " << fn.return_type << '\n';
+    std::cout << " -> " << spelling(fn.return_type) << '\n';
 
     indent_level_++;
     print_block(fn.body);
@@ -106,7 +107,7 @@ void ASTPrinter::print_struct(const StructDecl& s) {
     indent_level_++;
     for (const auto& field : s.fields) {
         indent();
-        std::cout << "Field " << field.name << " : " << field.type << '\n';
+        std::cout << "Field " << field.name << " : " << spelling(field.type) << '\n';
     }
     indent_level_--;
 }
@@ -129,7 +130,7 @@ void ASTPrinter::print_enum(const EnumDecl& e) {
         if (!v.types.empty()) {
             std::cout << "(";
             for (size_t i = 0; i < v.types.size(); ++i) {
-                std::cout << v.types[i] << (i == v.types.size() - 1 ? "" : ", ");
+                std::cout << spelling(v.types[i]) << (i == v.types.size() - 1 ? "" : ", ");
             }
             std::cout << ")";
         }
@@ -152,7 +153,8 @@ void ASTPrinter::print_impl(const ImplBlock& impl) {
     indent_level_++;
     for (const auto& assoc : impl.associated_types) {
         indent();
-        std::cout << "AssociatedType " << assoc.name << " = " << assoc.default_type << '\n';
+        std::cout << "AssociatedType " << assoc.name << " = " << spelling(assoc.default_type)
+                  << '\n';
     }
     for (const auto& m : impl.methods) {
         print_function(m);
@@ -175,8 +177,8 @@ void ASTPrinter::print_trait(const TraitDecl& t) {
     for (const auto& assoc : t.associated_types) {
         indent();
         std::cout << "AssociatedType " << assoc.name;
-        if (!assoc.default_type.empty()) {
-            std::cout << " = " << assoc.default_type;
+        if (assoc.default_type) {
+            std::cout << " = " << spelling(assoc.default_type);
         }
         std::cout << '\n';
     }
@@ -206,132 +208,124 @@ void ASTPrinter::print_block(const Block& block) {
    ======================= */
 
 void ASTPrinter::print_statement(const Stmt& stmt) {
-    if (auto let = dynamic_cast<const LetStmt*>(&stmt)) {
-        indent();
-        if (let->is_const)
-            std::cout << "Const ";
-        else {
-            std::cout << "Let ";
-            if (let->is_mutable)
-                std::cout << "mut ";
-        }
-        std::cout << let->name << " : " << let->type_name << '\n';
+    visit(stmt, [this](const auto& node) { print_node(node); });
+}
 
-        indent_level_++;
-        print_expression(*let->initializer);
-        indent_level_--;
-        return;
+void ASTPrinter::print_node(const LetStmt& let) {
+    indent();
+    if (let.is_const)
+        std::cout << "Const ";
+    else {
+        std::cout << "Let ";
+        if (let.is_mutable)
+            std::cout << "mut ";
     }
+    std::cout << let.name << " : " << spelling(let.type) << '\n';
 
-    if (auto ret = dynamic_cast<const ReturnStmt*>(&stmt)) {
-        indent();
-        std::cout << "Return\n";
-        if (ret->expression) {
-            indent_level_++;
-            print_expression(*ret->expression);
-            indent_level_--;
-        }
-        return;
-    }
+    indent_level_++;
+    print_expression(*let.initializer);
+    indent_level_--;
+}
 
-    if (auto es = dynamic_cast<const ExprStmt*>(&stmt)) {
-        indent();
-        std::cout << "ExprStmt\n";
+void ASTPrinter::print_node(const ReturnStmt& ret) {
+    indent();
+    std::cout << "Return\n";
+    if (ret.expression) {
         indent_level_++;
-        print_expression(*es->expression);
+        print_expression(*ret.expression);
         indent_level_--;
-        return;
     }
+}
 
-    if (auto block = dynamic_cast<const BlockStmt*>(&stmt)) {
-        print_block(block->block);
-        return;
-    }
+void ASTPrinter::print_node(const ExprStmt& es) {
+    indent();
+    std::cout << "ExprStmt\n";
+    indent_level_++;
+    print_expression(*es.expression);
+    indent_level_--;
+}
 
-    if (auto ifs = dynamic_cast<const IfStmt*>(&stmt)) {
-        indent();
-        std::cout << "If\n";
-        indent_level_++;
-        print_expression(*ifs->condition);
-        print_statement(*ifs->then_branch);
-        if (ifs->else_branch) {
-            print_statement(*ifs->else_branch);
-        }
-        indent_level_--;
-        return;
-    }
+void ASTPrinter::print_node(const BlockStmt& block) {
+    print_block(block.block);
+}
 
-    if (auto wh = dynamic_cast<const WhileStmt*>(&stmt)) {
-        indent();
-        std::cout << "While\n";
-        indent_level_++;
-        print_expression(*wh->condition);
-        print_statement(*wh->body);
-        indent_level_--;
-        return;
+void ASTPrinter::print_node(const IfStmt& ifs) {
+    indent();
+    std::cout << "If\n";
+    indent_level_++;
+    print_expression(*ifs.condition);
+    print_statement(*ifs.then_branch);
+    if (ifs.else_branch) {
+        print_statement(*ifs.else_branch);
     }
+    indent_level_--;
+}
 
-    if (auto ms = dynamic_cast<const MatchStmt*>(&stmt)) {
-        indent();
-        std::cout << "Match\n";
-        indent_level_++;
-        print_expression(*ms->expression);
-        for (const auto& arm : ms->arms) {
-            indent();
-            std::cout << "Arm\n";
-            indent_level_++;
-            print_pattern(*arm.pattern);
-            print_statement(*arm.body);
-            indent_level_--;
-        }
-        indent_level_--;
-        return;
-    }
+void ASTPrinter::print_node(const WhileStmt& wh) {
+    indent();
+    std::cout << "While\n";
+    indent_level_++;
+    print_expression(*wh.condition);
+    print_statement(*wh.body);
+    indent_level_--;
+}
 
-    if (auto asg = dynamic_cast<const AssignStmt*>(&stmt)) {
+void ASTPrinter::print_node(const MatchStmt& ms) {
+    indent();
+    std::cout << "Match\n";
+    indent_level_++;
+    print_expression(*ms.expression);
+    for (const auto& arm : ms.arms) {
         indent();
-        std::cout << "Assign\n";
+        std::cout << "Arm\n";
         indent_level_++;
-        print_expression(*asg->target);
-        print_expression(*asg->value);
+        print_pattern(*arm.pattern);
+        print_statement(*arm.body);
         indent_level_--;
-        return;
     }
+    indent_level_--;
+}
 
-    if (auto fl = dynamic_cast<const ForStmt*>(&stmt)) {
-        indent();
-        std::cout << "For " << fl->variable;
-        if (!fl->var_type.empty())
-            std::cout << " : " << fl->var_type;
-        std::cout << " in\n";
-        indent_level_++;
-        print_expression(*fl->iterable);
-        print_statement(*fl->body);
-        indent_level_--;
-        return;
-    }
+void ASTPrinter::print_node(const AssignStmt& asg) {
+    indent();
+    std::cout << "Assign\n";
+    indent_level_++;
+    print_expression(*asg.target);
+    print_expression(*asg.value);
+    indent_level_--;
+}
 
-    if (auto lp = dynamic_cast<const LoopStmt*>(&stmt)) {
-        indent();
-        std::cout << "Loop\n";
-        indent_level_++;
-        print_statement(*lp->body);
-        indent_level_--;
-        return;
-    }
+void ASTPrinter::print_node(const ForStmt& fl) {
+    indent();
+    std::cout << "For " << fl.variable;
+    if (fl.var_type)
+        std::cout << " : " << spelling(fl.var_type);
+    std::cout << " in\n";
+    indent_level_++;
+    print_expression(*fl.iterable);
+    print_statement(*fl.body);
+    indent_level_--;
+}
 
-    if (dynamic_cast<const BreakStmt*>(&stmt)) {
-        indent();
-        std::cout << "Break\n";
-        return;
-    }
+void ASTPrinter::print_node(const LoopStmt& lp) {
+    indent();
+    std::cout << "Loop\n";
+    indent_level_++;
+    print_statement(*lp.body);
+    indent_level_--;
+}
 
-    if (dynamic_cast<const ContinueStmt*>(&stmt)) {
-        indent();
-        std::cout << "Continue\n";
-        return;
-    }
+void ASTPrinter::print_node(const BreakStmt&) {
+    indent();
+    std::cout << "Break\n";
+}
+
+void ASTPrinter::print_node(const ContinueStmt&) {
+    indent();
+    std::cout << "Continue\n";
+}
 
+void ASTPrinter::print_node(const Stmt&) {
     indent();
     std::cout << "<unknown statement>\n";
 }
@@ -341,201 +335,188 @@ void ASTPrinter::print_statement(const Stmt& stmt) {
    ======================= */
 
 void ASTPrinter::print_expression(const Expr& expr) {
-    if (auto num = dynamic_cast<const NumberExpr*>(&expr)) {
-        indent();
-        std::cout << "Number(" << num->value << ")\n";
-        return;
-    }
+    visit(expr, [this](const auto& node) { print_node(node); });
+}
 
-    if (auto id = dynamic_cast<const IdentifierExpr*>(&expr)) {
-        indent();
-        std::cout << "Identifier(" << id->name << ")\n";
-        return;
-    }
+void ASTPrinter::print_node(const NumberExpr& num) {
+    indent();
+    std::cout << "Number(" << num.value << ")\n";
+}
 
-    if (auto str = dynamic_cast<const StringExpr*>(&expr)) {
-        indent();
-        std::cout << "String(\"" << str->value << "\")\n";
-        return;
-    }
+void ASTPrinter::print_node(const IdentifierExpr& id) {
+    indent();
+    std::cout << "Identifier(" << id.name << ")\n";
+}
 
-    if (auto ch = dynamic_cast<const CharExpr*>(&expr)) {
-        indent();
-        std::cout << "Char('" << ch->value << "')\n";
-        return;
-    }
+void ASTPrinter::print_node(const StringExpr& str) {
+    indent();
+    std::cout << "String(\"" << str.value << "\")\n";
+}
 
-    if (auto b = dynamic_cast<const BoolExpr*>(&expr)) {
-        indent();
-        std::cout << "Bool(" << (b->value ? "true" : "false") << ")\n";
-        return;
-    }
+void ASTPrinter::print_node(const CharExpr& ch) {
+    indent();
+    std::cout << "Char('" << ch.value << "')\n";
+}
 
-    if (auto call = dynamic_cast<const CallExpr*>(&expr)) {
-        indent();
-        std::cout << "Call\n";
-        indent_level_++;
-        print_expression(*call->callee);
-        for (const auto& arg : call->arguments) {
-            print_expression(*arg);
-        }
-        indent_level_--;
-        return;
+void ASTPrinter::print_node(const BoolExpr& b) {
+    indent();
+    std::cout << "Bool(" << (b.value ? "true" : "false") << ")\n";
+}
+
+void ASTPrinter::print_node(const CallExpr& call) {
+    indent();
+    std::cout << "Call\n";
+    indent_level_++;
+    print_expression(*call.callee);
+    for (const auto& arg : call.arguments) {
+        print_expression(*arg);
     }
+    indent_level_--;
+}
 
-    if (auto un = dynamic_cast<const UnaryExpr*>(&expr)) {
-        indent();
-        std::cout << "Unary(" << to_string(un->op) << ")\n";
+void ASTPrinter::print_node(const UnaryExpr& un) {
+    indent();
+    std::cout << "Unary(" << to_string(un.op) << ")\n";
 
-        indent_level_++;
-        print_expression(*un->operand);
-        indent_level_--;
-        return;
-    }
+    indent_level_++;
+    print_expression(*un.operand);
+    indent_level_--;
+}
 
-    if (auto mv = dynamic_cast<const MoveExpr*>(&expr)) {
-        indent();
-        std::cout << "Move\n";
-        indent_level_++;
-        print_expression(*mv->operand);
-        indent_level_--;
-        return;
-    }
+void ASTPrinter::print_node(const MoveExpr& mv) {
+    indent();
+    std::cout << "Move\n";
+    indent_level_++;
+    print_expression(*mv.operand);
+    indent_level_--;
+}
 
-    if (auto cast = dynamic_cast<const CastExpr*>(&expr)) {
-        indent();
-        std::cout << "Cast(" << cast->target_type << ")\n";
-        indent_level_++;
-        print_expression(*cast->expr);
-        indent_level_--;
-        return;
-    }
+void ASTPrinter::print_node(const CastExpr& cast) {
+    indent();
+    std::cout << "Cast(" << spelling(cast.target_type) << ")\n";
+    indent_level_++;
+    print_expression(*cast.expr);
+    indent_level_--;
+}
 
-    if (auto bin = dynamic_cast<const BinaryExpr*>(&expr)) {
-        indent();
-        std::cout << "Binary(" << to_string(bin->op) << ")\n";
+void ASTPrinter::print_node(const BinaryExpr& bin) {
+    indent();
+    std::cout << "Binary(" << to_string(bin.op) << ")\n";
 
-        indent_level_++;
-        print_expression(*bin->left);
-        print_expression(*bin->right);
-        indent_level_--;
-        return;
-    }
+    indent_level_++;
+    print_expression(*bin.left);
+    print_expression(*bin.right);
+    indent_level_--;
+}
 
-    if (auto sl = dynamic_cast<const StructLiteralExpr*>(&expr)) {
+void ASTPrinter::print_node(const StructLiteralExpr& sl) {
+    indent();
+    std::cout << "StructLiteral(" << sl.struct_name << ")\n";
+    indent_level_++;
+    for (const auto& field : sl.fields) {
         indent();
-        std::cout << "StructLiteral(" << sl->struct_name << ")\n";
+        std::cout << "FieldInit " << field.name << '\n';
         indent_level_++;
-        for (const auto& field : sl->fields) {
-            indent();
-            std::cout << "FieldInit " << field.name << '\n';
-            indent_level_++;
-            print_expression(*field.value);
-            indent_level_--;
-        }
+        print_expression(*field.value);
         indent_level_--;
-        return;
     }
+    indent_level_--;
+}
 
-    if (auto ep = dynamic_cast<const ErrorPropagationExpr*>(&expr)) {
-        indent();
-        std::cout << "ErrorPropagation(?)\n";
-        indent_level_++;
-        print_expression(*ep->operand);
-        indent_level_--;
-        return;
-    }
+void ASTPrinter::print_node(const ErrorPropagationExpr& ep) {
+    indent();
+    std::cout << "ErrorPropagation(?)\n";
+    indent_level_++;
+    print_expression(*ep.operand);
+    indent_level_--;
+}
 
-    if (auto aw = dynamic_cast<const AwaitExpr*>(&expr)) {
-        indent();
-        std::cout << "Await\n";
-        indent_level_++;
-        print_expression(*aw->operand);
-        indent_level_--;
-        return;
-    }
+void ASTPrinter::print_node(const AwaitExpr& aw) {
+    indent();
+    std::cout << "Await\n";
+    indent_level_++;
+    print_expression(*aw.operand);
+    indent_level_--;
+}
 
-    if (auto sp = dynamic_cast<const SpawnExpr*>(&expr)) {
-        indent();
-        std::cout << "Spawn\n";
-        indent_level_++;
-        print_expression(*sp->operand);
-        indent_level_--;
-        return;
-    }
+void ASTPrinter::print_node(const SpawnExpr& sp) {
+    indent();
+    std::cout << "Spawn\n";
+    indent_level_++;
+    print_expression(*sp.operand);
+    indent_level_--;
+}
 
-    if (auto rng = dynamic_cast<const RangeExpr*>(&expr)) {
-        indent();
-        std::cout << "Range\n";
-        indent_level_++;
-        if (rng->start)
-            print_expression(*rng->start);
-        if (rng->end)
-            print_expression(*rng->end);
-        indent_level_--;
-        return;
-    }
+void ASTPrinter::print_node(const RangeExpr& rng) {
+    indent();
+    std::cout << "Range\n";
+    indent_level_++;
+    if (rng.start)
+        print_expression(*rng.start);
+    if (rng.end)
+        print_expression(*rng.end);
+    indent_level_--;
+}
 
-    if (auto slc = dynamic_cast<const SliceExpr*>(&expr)) {
-        indent();
-        std::cout << "Slice\n";
-        indent_level_++;
-        print_expression(*slc->array);
-        if (slc->start)
-            print_expression(*slc->start);
-        if (slc->end)
-            print_expression(*slc->end);
-        indent_level_--;
-        return;
-    }
+void ASTPrinter::print_node(const SliceExpr& slc) {
+    indent();
+    std::cout << "Slice\n";
+    indent_level_++;
+    print_expression(*slc.array);
+    if (slc.start)
+        print_expression(*slc.start);
+    if (slc.end)
+        print_expression(*slc.end);
+    indent_level_--;
+}
 
-    if (auto idx = dynamic_cast<const IndexExpr*>(&expr)) {
-        indent();
-        std::cout << "Index\n";
-        indent_level_++;
-        print_expression(*idx->array);
-        print_expression(*idx->index);
-        indent_level_--;
-        return;
-    }
+void ASTPrinter::print_node(const IndexExpr& idx) {
+    indent();
+    std::cout << "Index\n";
+    indent_level_++;
+    print_expression(*idx.array);
+    print_expression(*idx.index);
+    indent_level_--;
+}
 
+void ASTPrinter::print_node(const Expr&) {
     indent();
     std::cout << "<unknown expression>\n";
 }
 
 void ASTPrinter::print_pattern(const Pattern& pattern) {
-    if (auto lp = dynamic_cast<const LiteralPattern*>(&pattern)) {
-        indent();
-        std::cout << "LiteralPattern\n";
-        indent_level_++;
-        print_expression(*lp->literal);
-        indent_level_--;
-        return;
-    }
+    visit(pattern, [this](const auto& node) { print_node(node); });
+}
 
-    if (auto ip = dynamic_cast<const IdentifierPattern*>(&pattern)) {
-        indent();
-        std::cout << "IdentifierPattern(" << ip->name << ")\n";
-        return;
-    }
+void ASTPrinter::print_node(const LiteralPattern& lp) {
+    indent();
+    std::cout << "LiteralPattern\n";
+    indent_level_++;
+    print_expression(*lp.literal);
+    indent_level_--;
+}
 
-    if (dynamic_cast<const WildcardPattern*>(&pattern)) {
-        indent();
-        std::cout << "WildcardPattern\n";
-        return;
-    }
+void ASTPrinter::print_node(const IdentifierPattern& ip) {
+    indent();
+    std::cout << "IdentifierPattern(" << ip.name << ")\n";
+}
 
-    if (auto vp = dynamic_cast<const VariantPattern*>(&pattern)) {
-        indent();
-        std::cout << "VariantPattern(" << vp->variant_name << ")\n";
-        indent_level_++;
-        for (const auto& sub : vp->sub_patterns) {
-            print_pattern(*sub);
-        }
-        indent_level_--;
-        return;
+void ASTPrinter::print_node(const WildcardPattern&) {
+    indent();
+    std::cout << "WildcardPattern\n";
+}
+
+void ASTPrinter::print_node(const VariantPattern& vp) {
+    indent();
+    std::cout << "VariantPattern(" << vp.variant_name << ")\n";
+    indent_level_++;
+    for (const auto& sub : vp.sub_patterns) {
+        print_pattern(*sub);
     }
+    indent_level_--;
+}
 
+void ASTPrinter::print_node(const Pattern&) {
     indent();
     std::cout << "<unknown pattern>\n";
 }
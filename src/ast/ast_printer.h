@@ -31,6 +31,47 @@ class ASTPrinter {
 
     void print_pattern(const Pattern& pattern);
 
+    // One overload per node kind, picked by ast::visit(); the base-class overloads catch
+    // kinds the printer does not know.
+    void print_node(const LetStmt& let);
+    void print_node(const ReturnStmt& ret);
+    void print_node(const ExprStmt& es);
+    void print_node(const BlockStmt& block);
+    void print_node(const IfStmt& ifs);
+    void print_node(const WhileStmt& wh);
+    void print_node(const MatchStmt& ms);
+    void print_node(const AssignStmt& asg);
+    void print_node(const ForStmt& fl);
+    void print_node(const LoopStmt& lp);
+    void print_node(const BreakStmt&);
+    void print_node(const ContinueStmt&);
+    void print_node(const Stmt&);
+
+    void print_node(const NumberExpr& num);
+    void print_node(const IdentifierExpr& id);
+    void print_node(const StringExpr& str);
+    void print_node(const CharExpr& ch);
+    void print_node(const BoolExpr& b);
+    void print_node(const CallExpr& call);
+    void print_node(const UnaryExpr& un);
+    void print_node(const MoveExpr& mv);
+    void print_node(const CastExpr& cast);
+    void print_node(const BinaryExpr& bin);
+    void print_node(const StructLiteralExpr& sl);
+    void print_node(const ErrorPropagationExpr& ep);
+    void print_node(const AwaitExpr& aw);
+    void print_node(const SpawnExpr& sp);
+    void print_node(const RangeExpr& rng);
+    void print_node(const SliceExpr& slc);
+    void print_node(const IndexExpr& idx);
+    void print_node(const Expr&);
+
+    void print_node(const LiteralPattern& lp);
+    void print_node(const IdentifierPattern& ip);
+    void print_node(const WildcardPattern&);
+    void print_node(const VariantPattern& vp);
+    void print_node(const Pattern&);
+
   private:
     int indent_level_ = 0;
 };
@@ -0,0 +1,1206 @@
+#include "ast_serializer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace flux::ast {
+namespace {
+// The stored bytes name these enumerators by value. If one of these fires, teach the
+// serializer about the new enumerator and bump kSerializationVersion.
+static_assert(static_cast<int>(ExprKind::Index) == 20, "bump kSerializationVersion");
+static_assert(static_cast<int>(StmtKind::Block) == 11, "bump kSerializationVersion");
+static_assert(static_cast<int>(PatternKind::Or) == 7, "bump kSerializationVersion");
+static_assert(static_cast<int>(TypeExprKind::Function) == 4, "bump kSerializationVersion");
+static_assert(static_cast<int>(TokenKind::EndOfFile) == 56, "bump kSerializationVersion");
+
+constexpr std::string_view kMagic = "FLXA";
+
+void put_uint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void put_str(std::string& out, std::string_view text) {
+    put_uint(out, text.size());
+    out.append(text);
+}
+
+/* =======================
+          Writer
+   ======================= */
+
+class Writer {
+  public:
+    // Without a `source`, no location is written.
+    explicit Writer(const SourceFile* source) : source_(source) {}
+
+    std::string write(const Module& module) {
+        this->module(module);
+        return finish();
+    }
+
+    std::string write(const FunctionDecl& fn) {
+        function(fn);
+        return finish();
+    }
+
+    // The names written so far, and the other spellings of names (which some nodes keep as
+    // plain strings), unsorted and possibly repeated.
+    std::vector<std::string> spellings() const {
+        std::vector<std::string> result = spellings_;
+        for (Name name : names_)
+            result.push_back(name.str());
+        return result;
+    }
+
+  private:
+    std::string finish() const {
+        std::string out;
+        out.reserve(body_.size() + names_.size() * 8 + 16);
+        out.append(kMagic);
+        put_uint(out, kSerializationVersion);
+        put_uint(out, names_.size());
+        for (Name name : names_)
+            put_str(out, name.str());
+        out.append(body_);
+        return out;
+    }
+
+    void u8(std::uint8_t value) {
+        body_.push_back(static_cast<char>(value));
+    }
+    void uint(std::uint64_t value) {
+        put_uint(body_, value);
+    }
+    void str(std::string_view text) {
+        put_str(body_, text);
+    }
+    // A string that spells a name, such as the struct of a struct literal.
+    void spelling(const std::string& text) {
+        str(text);
+        spellings_.push_back(text);
+    }
+
+    void name(Name name) {
+        auto [it, inserted] = name_index_.try_emplace(name.id(), names_.size());
+        if (inserted)
+            names_.push_back(name);
+        uint(it->second);
+    }
+
+    // 0 is "unknown"; anything else is 1 + the byte offset into the source file.
+    void loc(SourceLoc loc) {
+        if (!source_) {
+            uint(0);
+            return;
+        }
+        const std::uint32_t base = source_->base();
+        if (!loc.valid() || loc.offset < base || loc.offset - base > source_->text().size())
+            uint(0);
+        else
+            uint(loc.offset - base + 1);
+    }
+
+    void strings(const std::vector<std::string>& items) {
+        uint(items.size());
+        for (const std::string& item : items)
+            str(item);
+    }
+
+    void type(const TypeExpr* type);
+    void expr(const Expr* expr);
+    void stmt(const Stmt* stmt);
+    void pattern(const Pattern* pattern);
+
+    template <typename Range> void types(const Range& types) {
+        uint(types.size());
+        for (const TypeExpr* t : types)
+            type(t);
+    }
+    void exprs(std::span<ExprPtr> exprs) {
+        uint(exprs.size());
+        for (const Expr* e : exprs)
+            expr(e);
+    }
+    void patterns(std::span<PatternPtr> patterns) {
+        uint(patterns.size());
+        for (const Pattern* p : patterns)
+            pattern(p);
+    }
+    void block(const Block& block) {
+        loc(block.loc);
+        uint(block.statements.size());
+        for (const Stmt* s : block.statements)
+            stmt(s);
+    }
+
+    void where(const WhereClause& where);
+    void fields(const std::vector<Field>& fields);
+    void associated_types(const std::vector<AssociatedType>& types);
+    void function(const FunctionDecl& fn);
+    void functions(const std::vector<FunctionDecl>& fns);
+    void module(const Module& module);
+
+    const SourceFile* source_;
+    std::string body_;
+    std::vector<Name> names_;
+    std::unordered_map<std::uint32_t, std::uint32_t> name_index_; // Name id -> table index
+    std::vector<std::string> spellings_;
+};
+
+void Writer::type(const TypeExpr* type) {
+    if (!type) {
+        u8(0);
+        return;
+    }
+    u8(static_cast<std::uint8_t>(type->kind) + 1);
+    loc(type->loc);
+    switch (type->kind) {
+    case TypeExprKind::Path: {
+        const auto* path = cast<PathType>(type);
+        name(path->name);
+        types(path->generic_args);
+        break;
+    }
+    case TypeExprKind::Ref: {
+        const auto* ref = cast<RefType>(type);
+        u8(ref->is_mutable);
+        this->type(ref->pointee);
+        break;
+    }
+    case TypeExprKind::Array: {
+        const auto* array = cast<ArrayType>(type);
+        this->type(array->element);
+        str(array->length);
+        break;
+    }
+    case TypeExprKind::Tuple:
+        types(cast<TupleType>(type)->elements);
+        break;
+    case TypeExprKind::Function: {
+        const auto* fn = cast<FunctionType>(type);
+        types(fn->params);
+        this->type(fn->return_type);
+        break;
+    }
+    }
+}
+
+void Writer::expr(const Expr* expr) {
+    if (!expr) {
+        u8(0);
+        return;
+    }
+    u8(static_cast<std::uint8_t>(expr->kind) + 1);
+    loc(expr->loc);
+    switch (expr->kind) {
+    case ExprKind::Number:
+        str(cast<NumberExpr>(expr)->value);
+        break;
+    case ExprKind::Identifier:
+        name(cast<IdentifierExpr>(expr)->name);
+        break;
+    case ExprKind::String:
+        str(cast<StringExpr>(expr)->value);
+        break;
+    case ExprKind::Char:
+        str(cast<CharExpr>(expr)->value);
+        break;
+    case ExprKind::Bool:
+        u8(cast<BoolExpr>(expr)->value);
+        break;
+    case ExprKind::Call: {
+        const auto* call = cast<CallExpr>(expr);
+        this->expr(call->callee);
+        exprs(call->arguments);
+        break;
+    }
+    case ExprKind::Binary: {
+        const auto* binary = cast<BinaryExpr>(expr);
+        u8(static_cast<std::uint8_t>(binary->op));
+        this->expr(binary->left);
+        this->expr(binary->right);
+        break;
+    }
+    case ExprKind::Unary: {
+        const auto* unary = cast<UnaryExpr>(expr);
+        u8(static_cast<std::uint8_t>(unary->op));
+        this->expr(unary->operand);
+        u8(unary->is_mutable);
+        break;
+    }
+    case ExprKind::Move:
+        this->expr(cast<MoveExpr>(expr)->operand);
+        break;
+    case ExprKind::Cast: {
+        const auto* c = cast<CastExpr>(expr);
+        this->expr(c->expr);
+        type(c->target_type);
+        break;
+    }
+    case ExprKind::StructLiteral: {
+        const auto* literal = cast<StructLiteralExpr>(expr);
+        spelling(literal->struct_name);
+        uint(literal->fields.size());
+        for (const FieldInit& field : literal->fields) {
+            name(field.name);
+            this->expr(field.value);
+        }
+        break;
+    }
+    case ExprKind::Range: {
+        const auto* range = cast<RangeExpr>(expr);
+        this->expr(range->start);
+        this->expr(range->end);
+        u8(range->inclusive);
+        break;
+    }
+    case ExprKind::MemberAccess: {
+        const auto* access = cast<MemberAccessExpr>(expr);
+        this->expr(access->object);
+        name(access->member);
+        break;
+    }
+    case ExprKind::ErrorPropagation:
+        this->expr(cast<ErrorPropagationExpr>(expr)->operand);
+        break;
+    case ExprKind::Lambda: {
+        const auto* lambda = cast<LambdaExpr>(expr);
+        uint(lambda->params.size());
+        for (const LambdaExpr::Param& param : lambda->params) {
+            name(param.name);
+            type(param.type);
+        }
+        type(lambda->return_type);
+        this->expr(lambda->body);
+        break;
+    }
+    case ExprKind::Await:
+        this->expr(cast<AwaitExpr>(expr)->operand);
+        break;
+    case ExprKind::Spawn:
+        this->expr(cast<SpawnExpr>(expr)->operand);
+        break;
+    case ExprKind::Tuple:
+        exprs(cast<TupleExpr>(expr)->elements);
+        break;
+    case ExprKind::Array:
+        exprs(cast<ArrayExpr>(expr)->elements);
+        break;
+    case ExprKind::Slice: {
+        const auto* slice = cast<SliceExpr>(expr);
+        this->expr(slice->array);
+        this->expr(slice->start);
+        this->expr(slice->end);
+        break;
+    }
+    case ExprKind::Index: {
+        const auto* index = cast<IndexExpr>(expr);
+        this->expr(index->array);
+        this->expr(index->index);
+        break;
+    }
+    }
+}
+
+void Writer::stmt(const Stmt* stmt) {
+    if (!stmt) {
+        u8(0);
+        return;
+    }
+    u8(static_cast<std::uint8_t>(stmt->kind) + 1);
+    loc(stmt->loc);
+    switch (stmt->kind) {
+    case StmtKind::Let: {
+        const auto* let = cast<LetStmt>(stmt);
+        name(let->name);
+        uint(let->tuple_names.size());
+        for (Name n : let->tuple_names)
+            name(n);
+        type(let->type);
+        u8(let->is_mutable);
+        u8(let->is_const);
+        expr(let->initializer);
+        break;
+    }
+    case StmtKind::Return:
+        expr(cast<ReturnStmt>(stmt)->expression);
+        break;
+    case StmtKind::Expr:
+        expr(cast<ExprStmt>(stmt)->expression);
+        break;
+    case StmtKind::If: {
+        const auto* if_stmt = cast<IfStmt>(stmt);
+        expr(if_stmt->condition);
+        this->stmt(if_stmt->then_branch);
+        this->stmt(if_stmt->else_branch);
+        break;
+    }
+    case StmtKind::While: {
+        const auto* while_stmt = cast<WhileStmt>(stmt);
+        expr(while_stmt->condition);
+        this->stmt(while_stmt->body);
+        break;
+    }
+    case StmtKind::For: {
+        const auto* for_stmt = cast<ForStmt>(stmt);
+        name(for_stmt->variable);
+        type(for_stmt->var_type);
+        expr(for_stmt->iterable);
+        this->stmt(for_stmt->body);
+        break;
+    }
+    case StmtKind::Loop:
+        this->stmt(cast<LoopStmt>(stmt)->body);
+        break;
+    case StmtKind::Break:
+        expr(cast<BreakStmt>(stmt)->value);
+        break;
+    case StmtKind::Continue:
+        break;
+    case StmtKind::Assign: {
+        const auto* assign = cast<AssignStmt>(stmt);
+        expr(assign->target);
+        expr(assign->value);
+        u8(static_cast<std::uint8_t>(assign->op));
+        break;
+    }
+    case StmtKind::Match: {
+        const auto* match = cast<MatchStmt>(stmt);
+        expr(match->expression);
+        uint(match->arms.size());
+        for (const MatchArm& arm : match->arms) {
+            pattern(arm.pattern);
+            expr(arm.guard);
+            this->stmt(arm.body);
+        }
+        break;
+    }
+    case StmtKind::Block:
+        block(cast<BlockStmt>(stmt)->block);
+        break;
+    }
+}
+
+void Writer::pattern(const Pattern* pattern) {
+    if (!pattern) {
+        u8(0);
+        return;
+    }
+    u8(static_cast<std::uint8_t>(pattern->kind) + 1);
+    loc(pattern->loc);
+    switch (pattern->kind) {
+    case PatternKind::Literal:
+        expr(cast<LiteralPattern>(pattern)->literal);
+        break;
+    case PatternKind::Identifier:
+        name(cast<IdentifierPattern>(pattern)->name);
+        break;
+    case PatternKind::Wildcard:
+        break;
+    case PatternKind::Variant: {
+        const auto* variant = cast<VariantPattern>(pattern);
+        spelling(variant->variant_name);
+        patterns(variant->sub_patterns);
+        break;
+    }
+    case PatternKind::Tuple:
+        patterns(cast<TuplePattern>(pattern)->elements);
+        break;
+    case PatternKind::Struct: {
+        const auto* s = cast<StructPattern>(pattern);
+        spelling(s->struct_name);
+        uint(s->fields.size());
+        for (const FieldPattern& field : s->fields) {
+            name(field.field_name);
+            this->pattern(field.pattern);
+        }
+        break;
+    }
+    case PatternKind::Range: {
+        const auto* range = cast<RangePattern>(pattern);
+        expr(range->start);
+        expr(range->end);
+        u8(range->is_inclusive);
+        break;
+    }
+    case PatternKind::Or:
+        patterns(cast<OrPattern>(pattern)->alternatives);
+        break;
+    }
+}
+
+void Writer::where(const WhereClause& where) {
+    uint(where.size());
+    for (const WherePredicate& predicate : where) {
+        name(predicate.param);
+        types(predicate.bounds);
+    }
+}
+
+void Writer::fields(const std::vector<Field>& fields) {
+    uint(fields.size());
+    for (const Field& field : fields) {
+        name(field.name);
+        type(field.type);
+        u8(static_cast<std::uint8_t>(field.visibility));
+    }
+}
+
+void Writer::associated_types(const std::vector<AssociatedType>& types) {
+    uint(types.size());
+    for (const AssociatedType& assoc : types) {
+        loc(assoc.loc);
+        name(assoc.name);
+        type(assoc.default_type);
+    }
+}
+
+void Writer::function(const FunctionDecl& fn) {
+    loc(fn.loc);
+    name(fn.name);
+    strings(fn.type_params);
+    uint(fn.params.size());
+    for (const Param& param : fn.params) {
+        name(param.name);
+        type(param.type);
+    }
+    type(fn.return_type);
+    block(fn.body);
+    u8(static_cast<std::uint8_t>(fn.visibility));
+    u8(fn.is_async);
+    u8(fn.is_external);
+    u8(fn.has_body);
+    where(fn.where_clause);
+}
+
+void Writer::functions(const std::vector<FunctionDecl>& fns) {
+    uint(fns.size());
+    for (const FunctionDecl& fn : fns)
+        function(fn);
+}
+
+void Writer::module(const Module& module) {
+    loc(module.loc);
+    name(module.name);
+
+    uint(module.imports.size());
+    for (const Import& import : module.imports) {
+        loc(import.loc);
+        name(import.module_path);
+    }
+
+    functions(module.functions);
+
+    uint(module.structs.size());
+    for (const StructDecl& s : module.structs) {
+        loc(s.loc);
+        name(s.name);
+        strings(s.type_params);
+        fields(s.fields);
+        u8(static_cast<std::uint8_t>(s.visibility));
+        where(s.where_clause);
+    }
+
+    uint(module.classes.size());
+    for (const ClassDecl& c : module.classes) {
+        loc(c.loc);
+        name(c.name);
+        strings(c.type_params);
+        fields(c.fields);
+        u8(static_cast<std::uint8_t>(c.visibility));
+        where(c.where_clause);
+    }
+
+    uint(module.enums.size());
+    for (const EnumDecl& e : module.enums) {
+        loc(e.loc);
+        name(e.name);
+        strings(e.type_params);
+        uint(e.variants.size());
+        for (const Variant& variant : e.variants) {
+            name(variant.name);
+            types(variant.types);
+        }
+        u8(static_cast<std::uint8_t>(e.visibility));
+        where(e.where_clause);
+    }
+
+    uint(module.impls.size());
+    for (const ImplBlock& impl : module.impls) {
+        loc(impl.loc);
+        strings(impl.type_params);
+        spelling(impl.target_name);
+        spelling(impl.trait_name);
+        functions(impl.methods);
+        associated_types(impl.associated_types);
+        where(impl.where_clause);
+    }
+
+    uint(module.traits.size());
+    for (const TraitDecl& trait : module.traits) {
+        loc(trait.loc);
+        name(trait.name);
+        strings(trait.type_params);
+        functions(trait.methods);
+        associated_types(trait.associated_types);
+        u8(static_cast<std::uint8_t>(trait.visibility));
+        where(trait.where_clause);
+    }
+
+    uint(module.type_aliases.size());
+    for (const TypeAlias& alias : module.type_aliases) {
+        loc(alias.loc);
+        name(alias.name);
+        type(alias.target_type);
+        u8(static_cast<std::uint8_t>(alias.visibility));
+    }
+}
+
+/* =======================
+          Reader
+   ======================= */
+
+class Reader {
+  public:
+    Reader(std::string_view bytes, const SourceFile& source, AstContext& ctx)
+        : bytes_(bytes), source_(source), ctx_(ctx) {}
+
+    void read(Module& module) {
+        if (bytes_.substr(0, kMagic.size()) != kMagic)
+            fail("not a serialized module");
+        pos_ = kMagic.size();
+        if (uint() != kSerializationVersion)
+            fail("serialized with another format version");
+        names_.resize(count());
+        for (Name& name : names_)
+            name = Name(str());
+
+        this->module(module);
+        if (pos_ != bytes_.size())
+            fail("trailing bytes");
+    }
+
+  private:
+    [[noreturn]] static void fail(const char* what) {
+        throw std::runtime_error(std::string("flux: corrupt serialized module: ") + what);
+    }
+
+    template <typename T> static T* required(T* node) {
+        if (!node)
+            fail("missing node");
+        return node;
+    }
+
+    std::uint8_t u8() {
+        if (pos_ >= bytes_.size())
+            fail("truncated");
+        return static_cast<std::uint8_t>(bytes_[pos_++]);
+    }
+
+    std::uint64_t uint() {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const std::uint8_t byte = u8();
+            value |= std::uint64_t{byte & 0x7Fu} << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        fail("varint too long");
+    }
+
+    // An element count. Every element takes at least one byte, which bounds the count by
+    // what is left and keeps a corrupt count from allocating without limit.
+    std::size_t count() {
+        const std::uint64_t n = uint();
+        if (n > bytes_.size() - pos_)
+            fail("count past end");
+        return static_cast<std::size_t>(n);
+    }
+
+    std::string str() {
+        const std::size_t n = count();
+        std::string text(bytes_.substr(pos_, n));
+        pos_ += n;
+        return text;
+    }
+
+    bool flag() {
+        const std::uint8_t value = u8();
+        if (value > 1)
+            fail("bad flag");
+        return value != 0;
+    }
+
+    Name name() {
+        const std::uint64_t index = uint();
+        if (index >= names_.size())
+            fail("bad name index");
+        return names_[index];
+    }
+
+    SourceLoc loc() {
+        const std::uint64_t value = uint();
+        if (value == 0)
+            return {};
+        if (value - 1 > source_.text().size())
+            fail("location past end of source");
+        return source_.loc_at(value - 1);
+    }
+
+    TokenKind token() {
+        const std::uint8_t value = u8();
+        if (value > static_cast<std::uint8_t>(TokenKind::EndOfFile))
+            fail("bad token kind");
+        return static_cast<TokenKind>(value);
+    }
+
+    Visibility visibility() {
+        const std::uint8_t value = u8();
+        if (value > static_cast<std::uint8_t>(Visibility::Private))
+            fail("bad visibility");
+        return static_cast<Visibility>(value);
+    }
+
+    std::vector<std::string> strings() {
+        std::vector<std::string> items(count());
+        for (std::string& item : items)
+            item = str();
+        return items;
+    }
+
+    TypeExpr* type();
+    Expr* expr();
+    Stmt* stmt();
+    Pattern* pattern();
+
+    std::span<TypeExprPtr> type_list() {
+        std::span<TypeExprPtr> list = ctx_.list<TypeExprPtr>(count());
+        for (TypeExprPtr& t : list)
+            t = required(type());
+        return list;
+    }
+    std::vector<TypeExprPtr> type_vector() {
+        std::vector<TypeExprPtr> list(count());
+        for (TypeExprPtr& t : list)
+            t = required(type());
+        return list;
+    }
+    std::span<ExprPtr> exprs() {
+        std::span<ExprPtr> list = ctx_.list<ExprPtr>(count());
+        for (ExprPtr& e : list)
+            e = required(expr());
+        return list;
+    }
+    std::span<PatternPtr> patterns() {
+        std::span<PatternPtr> list = ctx_.list<PatternPtr>(count());
+        for (PatternPtr& p : list)
+            p = required(pattern());
+        return list;
+    }
+    Block block() {
+        Block block;
+        block.loc = loc();
+        block.statements = ctx_.list<StmtPtr>(count());
+        for (StmtPtr& s : block.statements)
+            s = required(stmt());
+        return block;
+    }
+
+    WhereClause where();
+    std::vector<Field> fields();
+    std::vector<AssociatedType> associated_types();
+    FunctionDecl function();
+    std::vector<FunctionDecl> functions();
+    void module(Module& module);
+
+    std::string_view bytes_;
+    std::size_t pos_ = 0;
+    const SourceFile& source_;
+    AstContext& ctx_;
+    std::vector<Name> names_;
+};
+
+// Fields are read into locals first: the order in which function arguments are evaluated
+// is unspecified, and the encoding is positional.
+TypeExpr* Reader::type() {
+    const std::uint8_t tag = u8();
+    if (tag == 0)
+        return nullptr;
+    if (tag - 1 > static_cast<int>(TypeExprKind::Function))
+        fail("bad type kind");
+    const SourceLoc at = loc();
+
+    TypeExpr* type = nullptr;
+    switch (static_cast<TypeExprKind>(tag - 1)) {
+    case TypeExprKind::Path: {
+        const Name name = this->name();
+        type = ctx_.make<PathType>(name, type_list());
+        break;
+    }
+    case TypeExprKind::Ref: {
+        const bool is_mutable = flag();
+        type = ctx_.make<RefType>(is_mutable, required(this->type()));
+        break;
+    }
+    case TypeExprKind::Array: {
+        TypeExpr* element = required(this->type());
+        type = ctx_.make<ArrayType>(element, str());
+        break;
+    }
+    case TypeExprKind::Tuple:
+        type = ctx_.make<TupleType>(type_list());
+        break;
+    case TypeExprKind::Function: {
+        std::span<TypeExprPtr> params = type_list();
+        type = ctx_.make<FunctionType>(params, required(this->type()));
+        break;
+    }
+    }
+    type->loc = at;
+    return type;
+}
+
+Expr* Reader::expr() {
+    const std::uint8_t tag = u8();
+    if (tag == 0)
+        return nullptr;
+    if (tag - 1 > static_cast<int>(ExprKind::Index))
+        fail("bad expression kind");
+    const SourceLoc at = loc();
+
+    Expr* expr = nullptr;
+    switch (static_cast<ExprKind>(tag - 1)) {
+    case ExprKind::Number:
+        expr = ctx_.make<NumberExpr>(str());
+        break;
+    case ExprKind::Identifier:
+        expr = ctx_.make<IdentifierExpr>(name());
+        break;
+    case ExprKind::String:
+        expr = ctx_.make<StringExpr>(str());
+        break;
+    case ExprKind::Char:
+        expr = ctx_.make<CharExpr>(str());
+        break;
+    case ExprKind::Bool:
+        expr = ctx_.make<BoolExpr>(flag());
+        break;
+    case ExprKind::Call: {
+        Expr* callee = required(this->expr());
+        expr = ctx_.make<CallExpr>(callee, exprs());
+        break;
+    }
+    case ExprKind::Binary: {
+        const TokenKind op = token();
+        Expr* left = required(this->expr());
+        Expr* right = required(this->expr());
+        expr = ctx_.make<BinaryExpr>(op, left, right);
+        break;
+    }
+    case ExprKind::Unary: {
+        const TokenKind op = token();
+        Expr* operand = required(this->expr());
+        expr = ctx_.make<UnaryExpr>(op, operand, flag());
+        break;
+    }
+    case ExprKind::Move:
+        expr = ctx_.make<MoveExpr>(required(this->expr()));
+        break;
+    case ExprKind::Cast: {
+        Expr* operand = required(this->expr());
+        expr = ctx_.make<CastExpr>(operand, required(type()));
+        break;
+    }
+    case ExprKind::StructLiteral: {
+        std::string struct_name = str();
+        std::span<FieldInit> fields = ctx_.list<FieldInit>(count());
+        for (FieldInit& field : fields) {
+            field.name = name();
+            field.value = required(this->expr());
+        }
+        expr = ctx_.make<StructLiteralExpr>(std::move(struct_name), fields);
+        break;
+    }
+    case ExprKind::Range: {
+        Expr* start = required(this->expr());
+        Expr* end = required(this->expr());
+        expr = ctx_.make<RangeExpr>(start, end, flag());
+        break;
+    }
+    case ExprKind::MemberAccess: {
+        Expr* object = required(this->expr());
+        expr = ctx_.make<MemberAccessExpr>(object, name());
+        break;
+    }
+    case ExprKind::ErrorPropagation:
+        expr = ctx_.make<ErrorPropagationExpr>(required(this->expr()));
+        break;
+    case ExprKind::Lambda: {
+        std::span<LambdaExpr::Param> params = ctx_.list<LambdaExpr::Param>(count());
+        for (LambdaExpr::Param& param : params) {
+            param.name = name();
+            param.type = type();
+        }
+        TypeExpr* return_type = type();
+        expr = ctx_.make<LambdaExpr>(params, return_type, required(this->expr()));
+        break;
+    }
+    case ExprKind::Await:
+        expr = ctx_.make<AwaitExpr>(required(this->expr()));
+        break;
+    case ExprKind::Spawn:
+        expr = ctx_.make<SpawnExpr>(required(this->expr()));
+        break;
+    case ExprKind::Tuple:
+        expr = ctx_.make<TupleExpr>(exprs());
+        break;
+    case ExprKind::Array:
+        expr = ctx_.make<ArrayExpr>(exprs());
+        break;
+    case ExprKind::Slice: {
+        Expr* array = required(this->expr());
+        Expr* start = this->expr();
+        Expr* end = this->expr();
+        expr = ctx_.make<SliceExpr>(array, start, end);
+        break;
+    }
+    case ExprKind::Index: {
+        Expr* array = required(this->expr());
+        expr = ctx_.make<IndexExpr>(array, required(this->expr()));
+        break;
+    }
+    }
+    expr->loc = at;
+    return expr;
+}
+
+Stmt* Reader::stmt() {
+    const std::uint8_t tag = u8();
+    if (tag == 0)
+        return nullptr;
+    if (tag - 1 > static_cast<int>(StmtKind::Block))
+        fail("bad statement kind");
+    const SourceLoc at = loc();
+
+    Stmt* stmt = nullptr;
+    switch (static_cast<StmtKind>(tag - 1)) {
+    case StmtKind::Let: {
+        const Name name = this->name();
+        std::span<Name> tuple_names = ctx_.list<Name>(count());
+        for (Name& n : tuple_names)
+            n = this->name();
+        TypeExpr* type = this->type();
+        const bool is_mutable = flag();
+        const bool is_const = flag();
+        Expr* initializer = expr();
+        if (tuple_names.empty())
+            stmt = ctx_.make<LetStmt>(name, type, is_mutable, is_const, initializer);
+        else
+            stmt = ctx_.make<LetStmt>(tuple_names, type, is_mutable, is_const, initializer);
+        break;
+    }
+    case StmtKind::Return:
+        stmt = ctx_.make<ReturnStmt>(expr());
+        break;
+    case StmtKind::Expr:
+        stmt = ctx_.make<ExprStmt>(required(expr()));
+        break;
+    case StmtKind::If: {
+        Expr* condition = required(expr());
+        Stmt* then_branch = required(this->stmt());
+        stmt = ctx_.make<IfStmt>(condition, then_branch, this->stmt());
+        break;
+    }
+    case StmtKind::While: {
+        Expr* condition = required(expr());
+        stmt = ctx_.make<WhileStmt>(condition, required(this->stmt()));
+        break;
+    }
+    case StmtKind::For: {
+        const Name variable = name();
+        TypeExpr* var_type = type();
+        Expr* iterable = required(expr());
+        stmt = ctx_.make<ForStmt>(variable, var_type, iterable, required(this->stmt()));
+        break;
+    }
+    case StmtKind::Loop:
+        stmt = ctx_.make<LoopStmt>(required(this->stmt()));
+        break;
+    case StmtKind::Break:
+        stmt = ctx_.make<BreakStmt>(expr());
+        break;
+    case StmtKind::Continue:
+        stmt = ctx_.make<ContinueStmt>();
+        break;
+    case StmtKind::Assign: {
+        Expr* target = required(expr());
+        Expr* value = required(expr());
+        stmt = ctx_.make<AssignStmt>(target, value, token());
+        break;
+    }
+    case StmtKind::Match: {
+        Expr* subject = required(expr());
+        std::span<MatchArm> arms = ctx_.list<MatchArm>(count());
+        for (MatchArm& arm : arms) {
+            arm.pattern = required(pattern());
+            arm.guard = expr();
+            arm.body = required(this->stmt());
+        }
+        stmt = ctx_.make<MatchStmt>(subject, arms);
+        break;
+    }
+    case StmtKind::Block: {
+        auto* block_stmt = ctx_.make<BlockStmt>();
+        block_stmt->block = block();
+        stmt = block_stmt;
+        break;
+    }
+    }
+    stmt->loc = at;
+    return stmt;
+}
+
+Pattern* Reader::pattern() {
+    const std::uint8_t tag = u8();
+    if (tag == 0)
+        return nullptr;
+    if (tag - 1 > static_cast<int>(PatternKind::Or))
+        fail("bad pattern kind");
+    const SourceLoc at = loc();
+
+    Pattern* pattern = nullptr;
+    switch (static_cast<PatternKind>(tag - 1)) {
+    case PatternKind::Literal:
+        pattern = ctx_.make<LiteralPattern>(required(expr()));
+        break;
+    case PatternKind::Identifier:
+        pattern = ctx_.make<IdentifierPattern>(name());
+        break;
+    case PatternKind::Wildcard:
+        pattern = ctx_.make<WildcardPattern>();
+        break;
+    case PatternKind::Variant: {
+        std::string variant_name = str();
+        pattern = ctx_.make<VariantPattern>(std::move(variant_name), patterns());
+        break;
+    }
+    case PatternKind::Tuple:
+        pattern = ctx_.make<TuplePattern>(patterns());
+        break;
+    case PatternKind::Struct: {
+        std::string struct_name = str();
+        std::span<FieldPattern> fields = ctx_.list<FieldPattern>(count());
+        for (FieldPattern& field : fields) {
+            field.field_name = name();
+            field.pattern = required(this->pattern());
+        }
+        pattern = ctx_.make<StructPattern>(std::move(struct_name), fields);
+        break;
+    }
+    case PatternKind::Range: {
+        Expr* start = required(expr());
+        Expr* end = required(expr());
+        pattern = ctx_.make<RangePattern>(start, end, flag());
+        break;
+    }
+    case PatternKind::Or:
+        pattern = ctx_.make<OrPattern>(patterns());
+        break;
+    }
+    pattern->loc = at;
+    return pattern;
+}
+
+WhereClause Reader::where() {
+    WhereClause where(count());
+    for (WherePredicate& predicate : where) {
+        predicate.param = name();
+        predicate.bounds = type_vector();
+    }
+    return where;
+}
+
+std::vector<Field> Reader::fields() {
+    std::vector<Field> fields(count());
+    for (Field& field : fields) {
+        field.name = name();
+        field.type = required(type());
+        field.visibility = visibility();
+    }
+    return fields;
+}
+
+std::vector<AssociatedType> Reader::associated_types() {
+    const std::size_t n = count();
+    std::vector<AssociatedType> types;
+    types.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const SourceLoc at = loc();
+        const Name name = this->name();
+        types.emplace_back(name, type());
+        types.back().loc = at;
+    }
+    return types;
+}
+
+FunctionDecl Reader::function() {
+    FunctionDecl fn;
+    fn.loc = loc();
+    fn.name = name();
+    fn.type_params = strings();
+    fn.params.resize(count());
+    for (Param& param : fn.params) {
+        param.name = name();
+        param.type = type();
+    }
+    fn.return_type = type();
+    fn.body = block();
+    fn.visibility = visibility();
+    fn.is_async = flag();
+    fn.is_external = flag();
+    fn.has_body = flag();
+    fn.where_clause = where();
+    return fn;
+}
+
+std::vector<FunctionDecl> Reader::functions() {
+    const std::size_t n = count();
+    std::vector<FunctionDecl> fns;
+    fns.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        fns.push_back(function());
+    return fns;
+}
+
+void Reader::module(Module& module) {
+    module.loc = loc();
+    module.name = name();
+
+    const std::size_t imports = count();
+    for (std::size_t i = 0; i < imports; ++i) {
+        const SourceLoc at = loc();
+        module.imports.emplace_back(name());
+        module.imports.back().loc = at;
+    }
+
+    module.functions = functions();
+
+    const std::size_t structs = count();
+    for (std::size_t i = 0; i < structs; ++i) {
+        StructDecl s;
+        s.loc = loc();
+        s.name = name();
+        s.type_params = strings();
+        s.fields = fields();
+        s.visibility = visibility();
+        s.where_clause = where();
+        module.structs.push_back(std::move(s));
+    }
+
+    const std::size_t classes = count();
+    for (std::size_t i = 0; i < classes; ++i) {
+        const SourceLoc at = loc();
+        const Name name = this->name();
+        std::vector<std::string> type_params = strings();
+        ClassDecl c(name, std::move(type_params), fields());
+        c.loc = at;
+        c.visibility = visibility();
+        c.where_clause = where();
+        module.classes.push_back(std::move(c));
+    }
+
+    const std::size_t enums = count();
+    for (std::size_t i = 0; i < enums; ++i) {
+        const SourceLoc at = loc();
+        const Name name = this->name();
+        std::vector<std::string> type_params = strings();
+        std::vector<Variant> variants(count());
+        for (Variant& variant : variants) {
+            variant.name = this->name();
+            variant.types = type_vector();
+        }
+        EnumDecl e(name, std::move(type_params), std::move(variants));
+        e.loc = at;
+        e.visibility = visibility();
+        e.where_clause = where();
+        module.enums.push_back(std::move(e));
+    }
+
+    const std::size_t impls = count();
+    for (std::size_t i = 0; i < impls; ++i) {
+        const SourceLoc at = loc();
+        std::vector<std::string> type_params = strings();
+        std::string target = str();
+        std::string trait = str();
+        ImplBlock impl(std::move(type_params), std::move(target), functions());
+        impl.loc = at;
+        impl.trait_name = std::move(trait);
+        impl.associated_types = associated_types();
+        impl.where_clause = where();
+        module.impls.push_back(std::move(impl));
+    }
+
+    const std::size_t traits = count();
+    for (std::size_t i = 0; i < traits; ++i) {
+        const SourceLoc at = loc();
+        const Name name = this->name();
+        std::vector<std::string> type_params = strings();
+        TraitDecl trait(name, std::move(type_params), functions());
+        trait.loc = at;
+        trait.associated_types = associated_types();
+        trait.visibility = visibility();
+        trait.where_clause = where();
+        module.traits.push_back(std::move(trait));
+    }
+
+    const std::size_t aliases = count();
+    for (std::size_t i = 0; i < aliases; ++i) {
+        const SourceLoc at = loc();
+        const Name name = this->name();
+        TypeAlias alias(name, required(type()));
+        alias.loc = at;
+        alias.visibility = visibility();
+        module.type_aliases.push_back(std::move(alias));
+    }
+}
+} // namespace
+
+std::string serialize(const Module& module, const SourceFile& source) {
+    return Writer(&source).write(module);
+}
+
+std::string serialize(const FunctionDecl& fn) {
+    return Writer(nullptr).write(fn);
+}
+
+namespace {
+std::vector<std::string> sorted(std::vector<std::string> names) {
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    return names;
+}
+} // namespace
+
+std::vector<std::string> spelled_names(const Module& module) {
+    Writer writer(nullptr);
+    writer.write(module);
+    return sorted(writer.spellings());
+}
+
+std::vector<std::string> spelled_names(const FunctionDecl& fn) {
+    Writer writer(nullptr);
+    writer.write(fn);
+    return sorted(writer.spellings());
+}
+
+Module deserialize(std::string_view bytes, const SourceFile& source) {
+    Module module;
+    Reader(bytes, source, *module.context).read(module);
+    return module;
+}
+} // namespace flux::ast
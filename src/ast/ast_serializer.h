@@ -0,0 +1,40 @@
+#ifndef FLUX_AST_SERIALIZER_H
+#define FLUX_AST_SERIALIZER_H
+
+#include "ast.h"
+#include "lexer/source_file.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace flux::ast {
+// Version of the encoding below. Bump it whenever the encoding changes, and whenever a node
+// gains or loses a field or any enum it stores (node kinds, TokenKind, Visibility) changes:
+// readers reject other versions, which is what invalidates caches written by older builds.
+inline constexpr std::uint32_t kSerializationVersion = 1;
+
+// A compact binary encoding of a whole module. Integers are LEB128 varints, each distinct
+// Name is written once in a table and referenced by index, and every node is a kind byte
+// followed by its fields. Source locations are stored relative to `source`, the file the
+// module was parsed from, so a module read back later can be placed in a reopened copy of
+// the same text.
+std::string serialize(const Module& module, const SourceFile& source);
+
+// The encoding of `fn` alone, with no source locations: it changes with what the function
+// says, not with where it sits in its file.
+std::string serialize(const FunctionDecl& fn);
+
+// Every name `module`, or `fn`, spells (identifiers, paths, types, fields, struct and variant
+// names), sorted and without repeats. Paths such as `std::io` are single names.
+std::vector<std::string> spelled_names(const Module& module);
+std::vector<std::string> spelled_names(const FunctionDecl& fn);
+
+// Rebuilds a module written by serialize() into a fresh AstContext, with its locations in
+// `source`. Throws std::runtime_error if `bytes` is truncated or malformed, or was written
+// with another kSerializationVersion.
+Module deserialize(std::string_view bytes, const SourceFile& source);
+} // namespace flux::ast
+
+#endif // FLUX_AST_SERIALIZER_H
@@ -0,0 +1,158 @@
+#ifndef FLUX_AST_VISITOR_H
+#define FLUX_AST_VISITOR_H
+
+#include "ast.h"
+
+#include <cassert>
+#include <type_traits>
+
+namespace flux::ast {
+// ast::visit(node, visitor) calls `visitor` with `node` cast to its concrete type, chosen by
+// a switch on the node's kind tag, so dispatch is one jump-table branch instead of a chain
+// of dynamic_casts. Constness follows the node. Every call of the visitor must return the
+// same type; a generic lambda, or an overload set ending in a `const auto&` catch-all,
+// handles the node types a pass does not care about:
+//
+//     ast::visit(expr, [&](const auto& node) { return type_of_node(node); });
+//
+// Adding a node kind without a case here is a -Wswitch warning.
+
+template <typename From, typename To>
+using copy_const_t = std::conditional_t<std::is_const_v<From>, const To, To>;
+
+namespace detail {
+[[noreturn]] inline void unknown_kind() {
+    assert(false && "AST node with an unknown kind");
+#if defined(_MSC_VER) && !defined(__clang__)
+    __assume(false);
+#else
+    __builtin_unreachable();
+#endif
+}
+} // namespace detail
+
+template <typename N, typename Visitor>
+    requires std::is_same_v<std::remove_const_t<N>, Expr>
+decltype(auto) visit(N& expr, Visitor&& visitor) {
+    switch (expr.kind) {
+    case ExprKind::Number:
+        return visitor(static_cast<copy_const_t<N, NumberExpr>&>(expr));
+    case ExprKind::Identifier:
+        return visitor(static_cast<copy_const_t<N, IdentifierExpr>&>(expr));
+    case ExprKind::String:
+        return visitor(static_cast<copy_const_t<N, StringExpr>&>(expr));
+    case ExprKind::Char:
+        return visitor(static_cast<copy_const_t<N, CharExpr>&>(expr));
+    case ExprKind::Bool:
+        return visitor(static_cast<copy_const_t<N, BoolExpr>&>(expr));
+    case ExprKind::Call:
+        return visitor(static_cast<copy_const_t<N, CallExpr>&>(expr));
+    case ExprKind::Binary:
+        return visitor(static_cast<copy_const_t<N, BinaryExpr>&>(expr));
+    case ExprKind::Unary:
+        return visitor(static_cast<copy_const_t<N, UnaryExpr>&>(expr));
+    case ExprKind::Move:
+        return visitor(static_cast<copy_const_t<N, MoveExpr>&>(expr));
+    case ExprKind::Cast:
+        return visitor(static_cast<copy_const_t<N, CastExpr>&>(expr));
+    case ExprKind::StructLiteral:
+        return visitor(static_cast<copy_const_t<N, StructLiteralExpr>&>(expr));
+    case ExprKind::Range:
+        return visitor(static_cast<copy_const_t<N, RangeExpr>&>(expr));
+    case ExprKind::MemberAccess:
+        return visitor(static_cast<copy_const_t<N, MemberAccessExpr>&>(expr));
+    case ExprKind::ErrorPropagation:
+        return visitor(static_cast<copy_const_t<N, ErrorPropagationExpr>&>(expr));
+    case ExprKind::Lambda:
+        return visitor(static_cast<copy_const_t<N, LambdaExpr>&>(expr));
+    case ExprKind::Await:
+        return visitor(static_cast<copy_const_t<N, AwaitExpr>&>(expr));
+    case ExprKind::Spawn:
+        return visitor(static_cast<copy_const_t<N, SpawnExpr>&>(expr));
+    case ExprKind::Tuple:
+        return visitor(static_cast<copy_const_t<N, TupleExpr>&>(expr));
+    case ExprKind::Array:
+        return visitor(static_cast<copy_const_t<N, ArrayExpr>&>(expr));
+    case ExprKind::Slice:
+        return visitor(static_cast<copy_const_t<N, SliceExpr>&>(expr));
+    case ExprKind::Index:
+        return visitor(static_cast<copy_const_t<N, IndexExpr>&>(expr));
+    }
+    detail::unknown_kind();
+}
+
+template <typename N, typename Visitor>
+    requires std::is_same_v<std::remove_const_t<N>, Stmt>
+decltype(auto) visit(N& stmt, Visitor&& visitor) {
+    switch (stmt.kind) {
+    case StmtKind::Let:
+        return visitor(static_cast<copy_const_t<N, LetStmt>&>(stmt));
+    case StmtKind::Return:
+        return visitor(static_cast<copy_const_t<N, ReturnStmt>&>(stmt));
+    case StmtKind::Expr:
+        return visitor(static_cast<copy_const_t<N, ExprStmt>&>(stmt));
+    case StmtKind::If:
+        return visitor(static_cast<copy_const_t<N, IfStmt>&>(stmt));
+    case StmtKind::While:
+        return visitor(static_cast<copy_const_t<N, WhileStmt>&>(stmt));
+    case StmtKind::For:
+        return visitor(static_cast<copy_const_t<N, ForStmt>&>(stmt));
+    case StmtKind::Loop:
+        return visitor(static_cast<copy_const_t<N, LoopStmt>&>(stmt));
+    case StmtKind::Break:
+        return visitor(static_cast<copy_const_t<N, BreakStmt>&>(stmt));
+    case StmtKind::Continue:
+        return visitor(static_cast<copy_const_t<N, ContinueStmt>&>(stmt));
+    case StmtKind::Assign:
+        return visitor(static_cast<copy_const_t<N, AssignStmt>&>(stmt));
+    case StmtKind::Match:
+        return visitor(static_cast<copy_const_t<N, MatchStmt>&>(stmt));
+    case StmtKind::Block:
+        return visitor(static_cast<copy_const_t<N, BlockStmt>&>(stmt));
+    }
+    detail::unknown_kind();
+}
+
+template <typename N, typename Visitor>
+    requires std::is_same_v<std::remove_const_t<N>, Pattern>
+decltype(auto) visit(N& pattern, Visitor&& visitor) {
+    switch (pattern.kind) {
+    case PatternKind::Literal:
+        return visitor(static_cast<copy_const_t<N, LiteralPattern>&>(pattern));
+    case PatternKind::Identifier:
+        return visitor(static_cast<copy_const_t<N, IdentifierPattern>&>(pattern));
+    case PatternKind::Wildcard:
+        return visitor(static_cast<copy_const_t<N, WildcardPattern>&>(pattern));
+    case PatternKind::Variant:
+        return visitor(static_cast<copy_const_t<N, VariantPattern>&>(pattern));
+    case PatternKind::Tuple:
+        return visitor(static_cast<copy_const_t<N, TuplePattern>&>(pattern));
+    case PatternKind::Struct:
+        return visitor(static_cast<copy_const_t<N, StructPattern>&>(pattern));
+    case PatternKind::Range:
+        return visitor(static_cast<copy_const_t<N, RangePattern>&>(pattern));
+    case PatternKind::Or:
+        return visitor(static_cast<copy_const_t<N, OrPattern>&>(pattern));
+    }
+    detail::unknown_kind();
+}
+template <typename N, typename Visitor>
+    requires std::is_same_v<std::remove_const_t<N>, TypeExpr>
+decltype(auto) visit(N& type, Visitor&& visitor) {
+    switch (type.kind) {
+    case TypeExprKind::Path:
+        return visitor(static_cast<copy_const_t<N, PathType>&>(type));
+    case TypeExprKind::Ref:
+        return visitor(static_cast<copy_const_t<N, RefType>&>(type));
+    case TypeExprKind::Array:
+        return visitor(static_cast<copy_const_t<N, ArrayType>&>(type));
+    case TypeExprKind::Tuple:
+        return visitor(static_cast<copy_const_t<N, TupleType>&>(type));
+    case TypeExprKind::Function:
+        return visitor(static_cast<copy_const_t<N, FunctionType>&>(type));
+    }
+    detail::unknown_kind();
+}
+} // namespace flux::ast
+
+#endif // FLUX_AST_VISITOR_H
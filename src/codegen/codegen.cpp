@@ -1,15 +1,18 @@
 #include "codegen/codegen.h"
 #include "codegen/type_converter.h"
+#include "support/trace.h"
 #include <cstdlib>
 #include <iostream>
 #include <llvm-c/Core.h>
+#include <stdexcept>
 #include <variant>
 #include <vector>
 
 namespace flux::codegen {
 
-CodeGenerator::CodeGenerator() {
-    context = LLVMContextCreate();
+CodeGenerator::CodeGenerator(LLVMContextRef shared_context)
+    : context(shared_context ? shared_context : LLVMContextCreate()),
+      owns_context(!shared_context) {
     builder = LLVMCreateBuilderInContext(context);
     llvm_module = nullptr;
 }
@@ -19,22 +22,37 @@ CodeGenerator::~CodeGenerator() {
         LLVMDisposeBuilder(builder);
     if (llvm_module)
         LLVMDisposeModule(llvm_module);
-    if (context)
+    if (owns_context)
         LLVMContextDispose(context);
 }
 
 void CodeGenerator::compile(const ir::IRModule& ir_module) {
+    compile(ir_module, {}, 0);
+}
+
+void CodeGenerator::compile(const ir::IRModule& ir_module, const std::vector<unsigned>& partitions,
+                            unsigned partition) {
+    // Whether this module defines the function at `index`, or only declares it. A function
+    // without blocks is defined by another module (see IRLowering::lower_unit()).
+    auto defines = [&](std::size_t index) {
+        return !ir_module.functions[index]->is_external &&
+               !ir_module.functions[index]->blocks.empty() &&
+               (partitions.empty() || partitions[index] == partition);
+    };
+
     if (llvm_module) {
         LLVMDisposeModule(llvm_module);
     }
     llvm_module = LLVMModuleCreateWithNameInContext(ir_module.name.c_str(), context);
 
     TypeConverter type_converter(context);
+    function_map.clear();
     value_map.clear();
     block_map.clear();
 
     // Pass 1: Declare all functions and create their basic blocks
-    for (const auto& ir_func : ir_module.functions) {
+    for (std::size_t index = 0; index < ir_module.functions.size(); ++index) {
+        const auto& ir_func = ir_module.functions[index];
         std::vector<LLVMTypeRef> param_types;
         for (const auto& param : ir_func->params) {
             param_types.push_back(type_converter.convert(*param->type));
@@ -42,14 +60,22 @@ void CodeGenerator::compile(const ir::IRModule& ir_module) {
         LLVMTypeRef ret_type = type_converter.convert(*ir_func->return_type);
         LLVMTypeRef func_type = LLVMFunctionType(ret_type, param_types.data(),
                                                  static_cast<unsigned>(param_types.size()), 0);
-        LLVMValueRef llvm_func = LLVMAddFunction(llvm_module, ir_func->name.c_str(), func_type);
-
-        // Map parameters
-        for (size_t i = 0; i < ir_func->params.size(); ++i) {
-            value_map[ir_func->params[i]->id] = LLVMGetParam(llvm_func, static_cast<unsigned>(i));
+        // `extern func puts` in module std::io is the C library's `puts`; several modules
+        // may declare the same C function.
+        std::string symbol = ir_func->name.str();
+        LLVMValueRef llvm_func = nullptr;
+        if (ir_func->is_external) {
+            if (auto pos = symbol.rfind("::"); pos != std::string::npos)
+                symbol.erase(0, pos + 2);
+            llvm_func = LLVMGetNamedFunction(llvm_module, symbol.c_str());
         }
+        if (!llvm_func)
+            llvm_func = LLVMAddFunction(llvm_module, symbol.c_str(), func_type);
+        function_map[ir_func->name] = llvm_func;
 
-        if (!ir_func->is_external) {
+        if (defines(index)) {
+            if (ir_func->is_internal)
+                LLVMSetLinkage(llvm_func, LLVMInternalLinkage);
             for (const auto& ir_block : ir_func->blocks) {
                 block_map[ir_block.get()] =
                     LLVMAppendBasicBlockInContext(context, llvm_func, ir_block->label.c_str());
@@ -58,10 +84,19 @@ void CodeGenerator::compile(const ir::IRModule& ir_module) {
     }
 
     // Pass 2: Compile function bodies
-    for (const auto& ir_func : ir_module.functions) {
-        if (ir_func->is_external) {
+    for (std::size_t index = 0; index < ir_module.functions.size(); ++index) {
+        const auto& ir_func = ir_module.functions[index];
+        if (!defines(index)) {
             continue;
         }
+        TraceSpan span("codegen", ir_func->name.str());
+
+        // Value ids are numbered per function, so each body starts from its own parameters
+        LLVMValueRef llvm_func = function_map.at(ir_func->name);
+        value_map.clear();
+        for (size_t i = 0; i < ir_func->params.size(); ++i) {
+            value_map[ir_func->params[i]->id] = LLVMGetParam(llvm_func, static_cast<unsigned>(i));
+        }
 
         // 1. Create all instructions (and Phi nodes without incoming edges)
         for (const auto& ir_block : ir_func->blocks) {
@@ -252,23 +287,20 @@ void CodeGenerator::compile_instruction(const ir::Instruction& inst) {
     }
 
     case ir::Opcode::Call: {
-        LLVMValueRef func = LLVMGetNamedFunction(llvm_module, inst.callee_name.c_str());
+        auto callee = function_map.find(inst.callee_name);
+        if (callee == function_map.end())
+            throw std::runtime_error("call to unknown function '" + inst.callee_name.str() + "'");
         std::vector<LLVMValueRef> args;
         for (const auto& op : inst.operands) {
             args.push_back(get_value(op));
         }
 
-        TypeConverter tc(context);
-        LLVMTypeRef ret_type = tc.convert(*inst.type);
-        std::vector<LLVMTypeRef> param_types;
-        for (const auto& op : inst.operands) {
-            param_types.push_back(tc.convert(*op->type));
-        }
-        LLVMTypeRef ft = LLVMFunctionType(ret_type, param_types.data(),
-                                          static_cast<unsigned>(param_types.size()), 0);
-
-        result = LLVMBuildCall2(builder, ft, func, args.data(), static_cast<unsigned>(args.size()),
-                                "calltmp");
+        // Lowering types every call as returning Int32; the callee knows its real type.
+        LLVMTypeRef ft = LLVMGlobalGetValueType(callee->second);
+        const bool returns_void =
+            LLVMGetTypeKind(LLVMGetReturnType(ft)) == LLVMVoidTypeKind;
+        result = LLVMBuildCall2(builder, ft, callee->second, args.data(),
+                                static_cast<unsigned>(args.size()), returns_void ? "" : "calltmp");
         break;
     }
 
@@ -302,6 +334,39 @@ void CodeGenerator::compile_instruction(const ir::Instruction& inst) {
     }
 }
 
+void CodeGenerator::add_entry_point(const std::string& function) {
+    auto callee = function_map.find(Name::if_interned(function));
+    if (!llvm_module || function.empty() || callee == function_map.end())
+        throw std::runtime_error("no function '" + function + "' to use as the entry point");
+    if (LLVMGetNamedFunction(llvm_module, "main"))
+        throw std::runtime_error("the module already defines a function named 'main'");
+    LLVMTypeRef callee_type = LLVMGlobalGetValueType(callee->second);
+    const LLVMTypeKind return_kind = LLVMGetTypeKind(LLVMGetReturnType(callee_type));
+    if (LLVMCountParamTypes(callee_type) != 0)
+        throw std::runtime_error("entry point '" + function + "' must not take parameters");
+    if (return_kind != LLVMVoidTypeKind && return_kind != LLVMIntegerTypeKind)
+        throw std::runtime_error("entry point '" + function + "' must return an integer or Void");
+
+    LLVMTypeRef int_type = LLVMInt32TypeInContext(context);
+    LLVMValueRef entry =
+        LLVMAddFunction(llvm_module, "main", LLVMFunctionType(int_type, nullptr, 0, 0));
+    LLVMPositionBuilderAtEnd(builder, LLVMAppendBasicBlockInContext(context, entry, "entry"));
+    if (return_kind == LLVMVoidTypeKind) {
+        LLVMBuildCall2(builder, callee_type, callee->second, nullptr, 0, "");
+        LLVMBuildRet(builder, LLVMConstInt(int_type, 0, false));
+    } else {
+        LLVMValueRef status =
+            LLVMBuildCall2(builder, callee_type, callee->second, nullptr, 0, "status");
+        LLVMBuildRet(builder, LLVMBuildIntCast2(builder, status, int_type, true, "exitcode"));
+    }
+}
+
+LLVMModuleRef CodeGenerator::release_module() {
+    LLVMModuleRef module = llvm_module;
+    llvm_module = nullptr;
+    return module;
+}
+
 std::string CodeGenerator::to_string() const {
     if (!llvm_module)
         return "";
@@ -7,24 +7,53 @@
 
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 namespace flux::codegen {
 
 class CodeGenerator {
   public:
-    CodeGenerator();
+    // Builds modules in `context` if one is given, which the caller owns and must keep
+    // alive for as long as the generator; otherwise the generator creates its own.
+    explicit CodeGenerator(LLVMContextRef context = nullptr);
     ~CodeGenerator();
 
-    // Compile the Flux IR module into an LLVM Module
+    // Compile the Flux IR module into an LLVM Module. External functions are declared
+    // under their C name (the last component of their qualified name), so they link
+    // against the C library. Throws std::runtime_error for a call to a function the
+    // module does not contain.
     void compile(const ir::IRModule& ir_module);
 
+    // Compile one partition of the module (see partition_functions()): the bodies of the
+    // functions that `partitions` assigns to `partition`. Every other function is only
+    // declared, so calls to it are resolved when the partitions are linked together.
+    void compile(const ir::IRModule& ir_module, const std::vector<unsigned>& partitions,
+                 unsigned partition);
+
+    // Add the C entry point, `int main()`, calling the compiled `function` and returning
+    // its integer result (or 0 if it returns Void). Throws std::runtime_error if the module
+    // has no such function.
+    void add_entry_point(const std::string& function);
+
+    // The compiled module; owned by the generator.
+    LLVMModuleRef module() const {
+        return llvm_module;
+    }
+
+    // Hands the compiled module over to the caller, who must dispose of it (or pass it to
+    // something that will, such as JIT::add_module()). The generator has no module after.
+    LLVMModuleRef release_module();
+
     std::string to_string() const;
 
   private:
     LLVMContextRef context;
+    bool owns_context;
     LLVMModuleRef llvm_module;
     LLVMBuilderRef builder;
 
+    // Map Flux IR function name to LLVM function
+    std::unordered_map<Name, LLVMValueRef> function_map;
     // Map Flux IR Value ID to LLVM Value
     std::unordered_map<uint32_t, LLVMValueRef> value_map;
     // Map Flux IR BasicBlock pointer to LLVM BasicBlock
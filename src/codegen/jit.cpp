@@ -0,0 +1,81 @@
+#include "codegen/jit.h"
+
+#include "codegen/target.h"
+
+#include <llvm-c/Error.h>
+
+#include <stdexcept>
+
+namespace flux::codegen {
+
+namespace {
+// Takes ownership of `error` and returns its message.
+std::string take_message(LLVMErrorRef error) {
+    char* message = LLVMGetErrorMessage(error);
+    std::string result = message;
+    LLVMDisposeErrorMessage(message);
+    return result;
+}
+
+// Throws std::runtime_error with `what` and LLVM's message if `error` is a failure.
+void check(LLVMErrorRef error, const std::string& what) {
+    if (error)
+        throw std::runtime_error(what + ": " + take_message(error));
+}
+} // namespace
+
+JIT::JIT() {
+    initialize_native_target();
+    check(LLVMOrcCreateLLJIT(&jit_, LLVMOrcCreateLLJITBuilder()), "cannot create the JIT");
+    LLVMOrcExecutionSessionSetErrorReporter(LLVMOrcLLJITGetExecutionSession(jit_),
+                                            report_session_error, this);
+
+    LLVMOrcDefinitionGeneratorRef process = nullptr;
+    LLVMErrorRef error = LLVMOrcCreateDynamicLibrarySearchGeneratorForProcess(
+        &process, LLVMOrcLLJITGetGlobalPrefix(jit_), nullptr, nullptr);
+    if (error) {
+        LLVMConsumeError(LLVMOrcDisposeLLJIT(jit_));
+        check(error, "cannot search this process for symbols");
+    }
+    LLVMOrcJITDylibAddGenerator(LLVMOrcLLJITGetMainJITDylib(jit_), process);
+    context_ = LLVMOrcCreateNewThreadSafeContext();
+}
+
+JIT::~JIT() {
+    // The JIT owns modules built in the context, so it goes first.
+    LLVMConsumeError(LLVMOrcDisposeLLJIT(jit_));
+    LLVMOrcDisposeThreadSafeContext(context_);
+}
+
+LLVMContextRef JIT::context() const {
+    return LLVMOrcThreadSafeContextGetContext(context_);
+}
+
+void JIT::add_module(LLVMModuleRef module) {
+    LLVMOrcThreadSafeModuleRef owned = LLVMOrcCreateNewThreadSafeModule(module, context_);
+    check(LLVMOrcLLJITAddLLVMIRModule(jit_, LLVMOrcLLJITGetMainJITDylib(jit_), owned),
+          "cannot add module to the JIT");
+}
+
+LLVMOrcExecutorAddress JIT::lookup(const std::string& name) {
+    LLVMOrcExecutorAddress address = 0;
+    session_error_.clear();
+    if (LLVMErrorRef error = LLVMOrcLLJITLookup(jit_, &address, name.c_str())) {
+        // The lookup only says which of its symbols failed; the session says why.
+        std::string reason = take_message(error);
+        if (!session_error_.empty())
+            reason = session_error_;
+        throw std::runtime_error("cannot JIT-compile '" + name + "': " + reason);
+    }
+    return address;
+}
+
+void JIT::report_session_error(void* jit, LLVMErrorRef error) {
+    std::string& reported = static_cast<JIT*>(jit)->session_error_;
+    if (reported.empty())
+        reported = take_message(error);
+    else
+        LLVMConsumeError(error);
+}
+
+} // namespace flux::codegen
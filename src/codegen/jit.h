@@ -0,0 +1,49 @@
+#ifndef FLUX_JIT_H
+#define FLUX_JIT_H
+
+#include <llvm-c/LLJIT.h>
+#include <llvm-c/Orc.h>
+
+#include <string>
+
+namespace flux::codegen {
+
+// Compiles LLVM modules in memory with ORC's LLJIT and runs them in this process. A
+// symbol the modules do not define, such as the C function behind an `extern func`,
+// resolves against the process itself: the C library and everything else the compiler
+// is linked with. Code is compiled on the first lookup that needs it.
+class JIT {
+  public:
+    // Throws std::runtime_error if LLVM has no JIT for this machine.
+    JIT();
+    ~JIT();
+
+    JIT(const JIT&) = delete;
+    JIT& operator=(const JIT&) = delete;
+
+    // The context that modules passed to add_module() must be built in (see
+    // CodeGenerator's constructor). Owned by the JIT.
+    LLVMContextRef context() const;
+
+    // Takes ownership of `module`. Throws std::runtime_error if the JIT rejects it, for
+    // instance because it redefines a symbol of a module added before.
+    void add_module(LLVMModuleRef module);
+
+    // Compiles what `name` needs and returns its address. Throws std::runtime_error if
+    // `name`, or a symbol its code refers to, is defined neither by a module nor by the
+    // process.
+    LLVMOrcExecutorAddress lookup(const std::string& name);
+
+  private:
+    // Keeps the first error the session reports while materializing code (an unresolved
+    // symbol, say) for lookup() to throw, instead of printing it to stderr.
+    static void report_session_error(void* jit, LLVMErrorRef error);
+
+    LLVMOrcLLJITRef jit_ = nullptr;
+    LLVMOrcThreadSafeContextRef context_ = nullptr;
+    std::string session_error_;
+};
+
+} // namespace flux::codegen
+
+#endif // FLUX_JIT_H
@@ -0,0 +1,114 @@
+#include "codegen/partition.h"
+
+#include "codegen/codegen.h"
+#include "support/thread_pool.h"
+#include "support/trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+
+namespace flux::codegen {
+
+std::vector<unsigned> partition_functions(const ir::IRModule& module, unsigned count) {
+    // External functions have no body to compile; they stay in partition 0.
+    std::vector<unsigned> partitions(module.functions.size(), 0);
+    std::uint64_t total = 0;
+    std::size_t defined = 0;
+    for (const auto& function : module.functions) {
+        if (function->is_external)
+            continue;
+        ++defined;
+        for (const auto& block : function->blocks)
+            total += block->instructions.size();
+        total += 1; // so that an empty function still weighs something
+    }
+    const std::uint64_t parts = std::max<std::uint64_t>(1, std::min<std::uint64_t>(count, defined));
+
+    unsigned partition = 0;
+    std::size_t in_partition = 0;
+    std::size_t remaining = defined;
+    std::uint64_t assigned = 0;
+    for (std::size_t i = 0; i < module.functions.size(); ++i) {
+        const auto& function = module.functions[i];
+        if (function->is_external)
+            continue;
+        // Move on once this partition has its share, or once every function left is
+        // needed to give each later partition one.
+        if (in_partition > 0 && partition + 1 < parts &&
+            (assigned * parts >= (partition + 1) * total || remaining < parts - partition)) {
+            ++partition;
+            in_partition = 0;
+        }
+        partitions[i] = partition;
+        ++in_partition;
+        --remaining;
+        for (const auto& block : function->blocks)
+            assigned += block->instructions.size();
+        assigned += 1;
+    }
+    return partitions;
+}
+
+namespace {
+// Runs `compile(i, generator)` for each output i on up to `options.jobs` threads, then
+// optimizes and emits what it generated to `outputs[i]`.
+template <typename Compile>
+void emit_each(const std::vector<std::filesystem::path>& outputs, const PartitionOptions& options,
+               const char* what, Compile compile) {
+    // The first TargetMachine initializes LLVM's native target; later ones, on the
+    // workers, only look it up.
+    initialize_native_target();
+    std::vector<std::exception_ptr> errors(outputs.size());
+    {
+        ThreadPool pool(std::min<unsigned>(options.jobs ? options.jobs
+                                                        : ThreadPool::default_threads(),
+                                           static_cast<unsigned>(outputs.size())));
+        for (unsigned index = 0; index < outputs.size(); ++index) {
+            pool.submit([&, index] {
+                try {
+                    TraceSpan span("codegen", what + (' ' + std::to_string(index)));
+                    CodeGenerator generator;
+                    compile(index, generator);
+                    const TargetMachine machine(options.reloc, options.level);
+                    machine.optimize(generator.module(), options.level);
+                    machine.emit(generator.module(), options.type, outputs[index]);
+                } catch (...) {
+                    errors[index] = std::current_exception();
+                }
+            });
+        }
+        pool.wait();
+    }
+    for (const std::exception_ptr& error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+} // namespace
+
+void emit_partitions(const ir::IRModule& module, const std::vector<unsigned>& partitions,
+                     const std::vector<std::filesystem::path>& outputs,
+                     const PartitionOptions& options) {
+    emit_each(outputs, options, "partition", [&](unsigned partition, CodeGenerator& generator) {
+        generator.compile(module, partitions, partition);
+        if (partition == 0 && !options.entry_point.empty())
+            generator.add_entry_point(options.entry_point);
+    });
+}
+
+void emit_modules(const std::vector<const ir::IRModule*>& modules,
+                  const std::vector<std::filesystem::path>& outputs,
+                  const PartitionOptions& options) {
+    emit_each(outputs, options, "module", [&](unsigned index, CodeGenerator& generator) {
+        const ir::IRModule& module = *modules[index];
+        generator.compile(module);
+        const ir::IRFunction* entry =
+            options.entry_point.empty() ? nullptr : module.find_function(options.entry_point);
+        if (entry && !entry->blocks.empty())
+            generator.add_entry_point(options.entry_point);
+    });
+}
+
+} // namespace flux::codegen
@@ -0,0 +1,50 @@
+#ifndef FLUX_PARTITION_H
+#define FLUX_PARTITION_H
+
+#include "codegen/target.h"
+#include "ir/ir.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace flux::codegen {
+
+// Splits the functions of `module` into at most `count` partitions for parallel code
+// generation, and returns the partition of each function in `module.functions`. A
+// partition is a run of consecutive functions, so the functions of one source module
+// mostly stay together, and the runs hold about equal numbers of instructions. Only the
+// module and `count` decide the split, never the number of threads compiling it. Every
+// partition from 0 to the largest one returned holds at least one function.
+std::vector<unsigned> partition_functions(const ir::IRModule& module, unsigned count);
+
+// How emit_partitions() compiles each partition.
+struct PartitionOptions {
+    FileType type = FileType::Object;
+    RelocModel reloc = RelocModel::PIC;
+    ir::OptLevel level = ir::OptLevel::O2;
+    // The function that the C entry point, `int main()`, calls (see
+    // CodeGenerator::add_entry_point()); it is added to partition 0. Empty adds none.
+    std::string entry_point;
+    unsigned jobs = 1; // worker threads; 0 uses every hardware thread
+};
+
+// Compiles each partition of `module` in its own LLVM context, on up to `options.jobs`
+// threads: code generation, the LLVM pipeline for `options.level` and emission to
+// `outputs[p]` for partition p. Functions of other partitions are declared, so the
+// outputs link into one program. Each output depends only on the module and `partitions`.
+// Throws the error of the lowest-numbered partition that failed.
+void emit_partitions(const ir::IRModule& module, const std::vector<unsigned>& partitions,
+                     const std::vector<std::filesystem::path>& outputs,
+                     const PartitionOptions& options);
+
+// Compiles each of `modules`, lowered apart (see IRLowering::lower_unit()), to `outputs[i]`
+// as emit_partitions() compiles a partition. The entry point is added to the module that
+// defines the function it calls, if one does.
+void emit_modules(const std::vector<const ir::IRModule*>& modules,
+                  const std::vector<std::filesystem::path>& outputs,
+                  const PartitionOptions& options);
+
+} // namespace flux::codegen
+
+#endif // FLUX_PARTITION_H
@@ -0,0 +1,212 @@
+#include "codegen/target.h"
+
+#include "ir/passes/pipeline.h"
+
+#include <llvm-c/Analysis.h>
+#include <llvm-c/BitWriter.h>
+#include <llvm-c/Core.h>
+#include <llvm-c/Target.h>
+#include <llvm-c/Transforms/PassBuilder.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+namespace flux::codegen {
+
+namespace {
+// Takes ownership of a string that LLVM allocated.
+std::string take_message(char* message) {
+    std::string result = message ? message : "";
+    LLVMDisposeMessage(message);
+    return result;
+}
+
+LLVMRelocMode to_llvm(RelocModel reloc) {
+    switch (reloc) {
+    case RelocModel::Static:
+        return LLVMRelocStatic;
+    case RelocModel::DynamicNoPIC:
+        return LLVMRelocDynamicNoPic;
+    case RelocModel::PIC:
+        break;
+    }
+    return LLVMRelocPIC;
+}
+
+// Runs the LLVM verifier, so a malformed module is reported instead of crashing the
+// optimizer or the code generator.
+void verify(LLVMModuleRef module) {
+    char* error = nullptr;
+    if (LLVMVerifyModule(module, LLVMReturnStatusAction, &error))
+        throw std::runtime_error("generated LLVM module is invalid:\n" + take_message(error));
+    LLVMDisposeMessage(error);
+}
+
+LLVMCodeGenOptLevel codegen_level(ir::OptLevel level) {
+    switch (level) {
+    case ir::OptLevel::O0:
+        return LLVMCodeGenLevelNone;
+    case ir::OptLevel::O1:
+        return LLVMCodeGenLevelLess;
+    case ir::OptLevel::O3:
+        return LLVMCodeGenLevelAggressive;
+    case ir::OptLevel::O2:
+    case ir::OptLevel::Os:
+        break;
+    }
+    return LLVMCodeGenLevelDefault;
+}
+} // namespace
+
+void initialize_native_target() {
+    static std::once_flag initialized;
+    static bool native = false;
+    std::call_once(initialized, [] {
+        native = !LLVMInitializeNativeTarget() && !LLVMInitializeNativeAsmPrinter();
+    });
+    if (!native)
+        throw std::runtime_error("LLVM has no code generator for this machine");
+}
+
+TargetMachine::TargetMachine(RelocModel reloc, ir::OptLevel level) {
+    initialize_native_target();
+    triple_ = take_message(LLVMGetDefaultTargetTriple());
+    LLVMTargetRef target = nullptr;
+    char* error = nullptr;
+    if (LLVMGetTargetFromTriple(triple_.c_str(), &target, &error))
+        throw std::runtime_error("no LLVM target for " + triple_ + ": " + take_message(error));
+
+    const std::string cpu = take_message(LLVMGetHostCPUName());
+    const std::string features = take_message(LLVMGetHostCPUFeatures());
+    machine_ = LLVMCreateTargetMachine(target, triple_.c_str(), cpu.c_str(), features.c_str(),
+                                       codegen_level(level), to_llvm(reloc),
+                                       LLVMCodeModelDefault);
+    if (!machine_)
+        throw std::runtime_error("cannot create an LLVM target machine for " + triple_);
+}
+
+TargetMachine::~TargetMachine() {
+    if (machine_)
+        LLVMDisposeTargetMachine(machine_);
+}
+
+void TargetMachine::configure(LLVMModuleRef module) const {
+    LLVMSetTarget(module, triple_.c_str());
+    LLVMTargetDataRef layout = LLVMCreateTargetDataLayout(machine_);
+    char* layout_string = LLVMCopyStringRepOfTargetData(layout);
+    LLVMSetDataLayout(module, layout_string);
+    LLVMDisposeMessage(layout_string);
+    LLVMDisposeTargetData(layout);
+}
+
+void TargetMachine::optimize(LLVMModuleRef module, ir::OptLevel level) const {
+    configure(module);
+    if (level == ir::OptLevel::O0)
+        return;
+    verify(module);
+    const std::string pipeline = "default<" + std::string(ir::opt_level_name(level)) + ">";
+    LLVMPassBuilderOptionsRef options = LLVMCreatePassBuilderOptions();
+    LLVMErrorRef error = LLVMRunPasses(module, pipeline.c_str(), machine_, options);
+    LLVMDisposePassBuilderOptions(options);
+    if (error) {
+        char* message = LLVMGetErrorMessage(error);
+        const std::string reason = message;
+        LLVMDisposeErrorMessage(message);
+        throw std::runtime_error("LLVM pipeline " + pipeline + " failed: " + reason);
+    }
+}
+
+void TargetMachine::emit(LLVMModuleRef module, FileType type,
+                         const std::filesystem::path& path) const {
+    configure(module);
+    verify(module);
+    char* error = nullptr;
+
+    const std::string file = path.string();
+    bool failed = false;
+    switch (type) {
+    case FileType::Object:
+    case FileType::Assembly:
+        // LLVMTargetMachineEmitToFile takes a mutable file name but does not change it.
+        failed = LLVMTargetMachineEmitToFile(machine_, module, const_cast<char*>(file.c_str()),
+                                             type == FileType::Object ? LLVMObjectFile
+                                                                      : LLVMAssemblyFile,
+                                             &error);
+        break;
+    case FileType::Bitcode:
+        failed = LLVMWriteBitcodeToFile(module, file.c_str()) != 0;
+        break;
+    case FileType::LLVMIR:
+        failed = LLVMPrintModuleToFile(module, file.c_str(), &error);
+        break;
+    }
+    if (failed) {
+        const std::string reason = error ? ": " + take_message(error) : "";
+        throw std::runtime_error("cannot write " + file + reason);
+    }
+}
+
+void link_executable(const std::vector<std::filesystem::path>& objects,
+                     const std::filesystem::path& output, RelocModel reloc) {
+#ifdef _WIN32
+    (void)objects;
+    (void)output;
+    (void)reloc;
+    throw std::runtime_error("linking executables is not supported on Windows yet");
+#else
+    // $CC may carry a launcher or flags ("ccache gcc", "clang -fuse-ld=lld"). As in make, it
+    // is split on whitespace, without quoting.
+    std::vector<std::string> args;
+    if (const char* cc = std::getenv("CC")) {
+        std::istringstream words(cc);
+        for (std::string word; words >> word;)
+            args.push_back(std::move(word));
+    }
+    if (args.empty())
+        args.push_back("cc");
+    const std::string linker = args.front();
+
+    for (const auto& object : objects)
+        args.push_back(object.string());
+    args.push_back("-o");
+    args.push_back(output.string());
+    if (reloc != RelocModel::PIC)
+        args.push_back("-no-pie");
+
+    std::vector<char*> argv;
+    for (std::string& arg : args)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    pid_t pid = 0;
+    if (int error = posix_spawnp(&pid, linker.c_str(), nullptr, nullptr, argv.data(), environ))
+        throw std::runtime_error("cannot run the linker " + linker + ": " + std::strerror(error));
+    int status = 0;
+    pid_t waited = 0;
+    do {
+        waited = waitpid(pid, &status, 0);
+    } while (waited == -1 && errno == EINTR);
+    if (waited != pid)
+        throw std::runtime_error("linking " + output.string() + " failed: waitpid: " +
+                                 std::strerror(errno));
+    if (WIFSIGNALED(status))
+        throw std::runtime_error("linking " + output.string() + " failed: " + linker +
+                                 " killed by signal " + std::to_string(WTERMSIG(status)));
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        throw std::runtime_error("linking " + output.string() + " failed: " + linker +
+                                 " exited with status " + std::to_string(WEXITSTATUS(status)));
+#endif
+}
+
+} // namespace flux::codegen
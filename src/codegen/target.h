@@ -0,0 +1,70 @@
+#ifndef FLUX_TARGET_H
+#define FLUX_TARGET_H
+
+#include "ir/ir_pass.h"
+
+#include <llvm-c/TargetMachine.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace flux::codegen {
+
+// What TargetMachine::emit() writes.
+enum class FileType { Object, Assembly, Bitcode, LLVMIR };
+
+// How generated code addresses globals and functions. PIC is the default: it links into
+// the position-independent executables that most system toolchains produce by default.
+enum class RelocModel { PIC, Static, DynamicNoPIC };
+
+// Registers LLVM's code generator for the host, once per process. Throws
+// std::runtime_error if LLVM was built without one.
+void initialize_native_target();
+
+// The LLVM target machine for the host (triple, CPU and CPU features of the machine the
+// compiler runs on), used to optimize a module and write it out as native code. `level`
+// sets the code generator's optimization level: none at -O0 (fast instruction selection
+// and register allocation), aggressive at -O3.
+class TargetMachine {
+  public:
+    // Throws std::runtime_error if LLVM was built without a backend for the host.
+    explicit TargetMachine(RelocModel reloc = RelocModel::PIC,
+                           ir::OptLevel level = ir::OptLevel::O2);
+    ~TargetMachine();
+
+    TargetMachine(const TargetMachine&) = delete;
+    TargetMachine& operator=(const TargetMachine&) = delete;
+
+    const std::string& triple() const {
+        return triple_;
+    }
+
+    // Sets the module's target triple and data layout to this machine's.
+    void configure(LLVMModuleRef module) const;
+
+    // Configures `module` and runs LLVM's standard pipeline for `level` on it (the new pass
+    // manager's `default<O1>` ... `default<Os>`). Nothing runs at -O0. Throws
+    // std::runtime_error if LLVM rejects the pipeline.
+    void optimize(LLVMModuleRef module, ir::OptLevel level) const;
+
+    // Configures `module`, checks it with the LLVM verifier and writes it to `path`.
+    // Throws std::runtime_error if the module is malformed or the file cannot be written.
+    void emit(LLVMModuleRef module, FileType type, const std::filesystem::path& path) const;
+
+  private:
+    LLVMTargetMachineRef machine_ = nullptr;
+    std::string triple_;
+};
+
+// Links object files into an executable with the system's C compiler driver ($CC, split on
+// whitespace, or `cc`), which adds the C runtime and the C library that `extern func`
+// declarations resolve against. Objects built with RelocModel::Static or DynamicNoPIC are
+// linked with -no-pie. Throws std::runtime_error, with the reason, if the linker cannot be
+// started or fails.
+void link_executable(const std::vector<std::filesystem::path>& objects,
+                     const std::filesystem::path& output, RelocModel reloc);
+
+} // namespace flux::codegen
+
+#endif // FLUX_TARGET_H
@@ -0,0 +1,333 @@
+#include "driver/compile_server.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace flux {
+
+#ifdef _WIN32
+
+CompileServer::CompileServer(std::filesystem::path socket_path)
+    : socket_path_(std::move(socket_path)) {
+    throw std::runtime_error("flux: the compile server needs Unix domain sockets");
+}
+
+CompileServer::~CompileServer() = default;
+
+void CompileServer::serve() {}
+
+bool CompileServer::handle(int) {
+    return false;
+}
+
+CompileResponse send_compile_request(const std::filesystem::path&, const std::filesystem::path&,
+                                     const std::vector<std::string>&) {
+    throw std::runtime_error("flux: the compile server needs Unix domain sockets");
+}
+
+#else
+
+namespace {
+constexpr std::string_view kRequestMagic = "flux-request";
+constexpr std::string_view kResponseMagic = "flux-response";
+constexpr std::string_view kStopArgument = "--stop-server";
+// Past this many interned names, or types, the session starts over
+// (CompileSession::set_name_limit).
+constexpr std::size_t kNameLimit = std::size_t{1} << 22;
+
+[[noreturn]] void fail(const std::string& what) {
+    throw std::runtime_error("flux: " + what + ": " + std::strerror(errno));
+}
+
+sockaddr_un address_of(const std::filesystem::path& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const std::string text = path.string();
+    if (text.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("flux: socket path too long: " + text);
+    std::memcpy(address.sun_path, text.c_str(), text.size() + 1);
+    return address;
+}
+
+// Closes the descriptor when it goes out of scope.
+struct Socket {
+    int fd;
+    explicit Socket(int fd) : fd(fd) {}
+    ~Socket() {
+        if (fd >= 0)
+            ::close(fd);
+    }
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+};
+
+void put_field(std::string& out, std::string_view field) {
+    out += std::to_string(field.size());
+    out += '\n';
+    out += field;
+}
+
+// Reads the fields written by put_field() back, in order.
+class FieldReader {
+  public:
+    explicit FieldReader(std::string_view bytes) : bytes_(bytes) {}
+
+    std::optional<std::string_view> next() {
+        const std::size_t newline = bytes_.find('\n', pos_);
+        if (newline == std::string_view::npos)
+            return std::nullopt;
+        std::size_t size = 0;
+        auto [end, ec] = std::from_chars(bytes_.data() + pos_, bytes_.data() + newline, size);
+        if (ec != std::errc() || end != bytes_.data() + newline ||
+            size > bytes_.size() - newline - 1)
+            return std::nullopt;
+        pos_ = newline + 1 + size;
+        return bytes_.substr(newline + 1, size);
+    }
+
+    std::optional<long long> next_number() {
+        std::optional<std::string_view> field = next();
+        long long value = 0;
+        if (!field)
+            return std::nullopt;
+        auto [end, ec] = std::from_chars(field->data(), field->data() + field->size(), value);
+        if (ec != std::errc() || end != field->data() + field->size())
+            return std::nullopt;
+        return value;
+    }
+
+  private:
+    std::string_view bytes_;
+    std::size_t pos_ = 0;
+};
+
+void write_all(int fd, std::string_view bytes) {
+    while (!bytes.empty()) {
+        const ssize_t written = ::send(fd, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            fail("cannot write to compile server socket");
+        }
+        bytes.remove_prefix(static_cast<std::size_t>(written));
+    }
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Reads until the peer shuts down its end. Returns nullopt if `deadline` passes first.
+std::optional<std::string> read_all(int fd,
+                                    Clock::time_point deadline = Clock::time_point::max()) {
+    std::string bytes;
+    char buffer[1 << 16];
+    for (;;) {
+        int wait = -1;
+        if (deadline != Clock::time_point::max()) {
+            const auto left =
+                std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            wait = static_cast<int>(std::clamp<decltype(left)>(left, 0, INT_MAX));
+        }
+        pollfd ready{fd, POLLIN, 0};
+        const int polled = ::poll(&ready, 1, wait);
+        if (polled < 0) {
+            if (errno == EINTR)
+                continue;
+            fail("cannot read from compile server socket");
+        }
+        if (polled == 0)
+            return std::nullopt;
+        const ssize_t got = ::recv(fd, buffer, sizeof buffer, 0);
+        if (got < 0) {
+            if (errno == EINTR)
+                continue;
+            fail("cannot read from compile server socket");
+        }
+        if (got == 0)
+            return bytes;
+        bytes.append(buffer, static_cast<std::size_t>(got));
+    }
+}
+
+int connect_to(const std::filesystem::path& socket_path) {
+    const sockaddr_un address = address_of(socket_path);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        fail("cannot create socket");
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof address) != 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        fail("no compile server at " + socket_path.string());
+    }
+    return fd;
+}
+} // namespace
+
+CompileServer::CompileServer(std::filesystem::path socket_path)
+    : socket_path_(std::move(socket_path)) {
+    session_.set_name_limit(kNameLimit);
+    const sockaddr_un address = address_of(socket_path_);
+
+    // A socket file nobody accepts on is left over from a server that died; reuse the path.
+    if (std::filesystem::exists(socket_path_)) {
+        try {
+            Socket probe(connect_to(socket_path_));
+        } catch (const std::runtime_error&) {
+            std::filesystem::remove(socket_path_);
+        }
+        if (std::filesystem::exists(socket_path_))
+            throw std::runtime_error("flux: a compile server is already running at " +
+                                     socket_path_.string());
+    }
+
+    listener_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener_ < 0)
+        fail("cannot create socket");
+    if (::bind(listener_, reinterpret_cast<const sockaddr*>(&address), sizeof address) != 0 ||
+        ::listen(listener_, 16) != 0) {
+        const int error = errno;
+        ::close(listener_);
+        errno = error;
+        fail("cannot listen on " + socket_path_.string());
+    }
+}
+
+CompileServer::~CompileServer() {
+    if (listener_ >= 0) {
+        ::close(listener_);
+        std::error_code ec;
+        std::filesystem::remove(socket_path_, ec);
+    }
+}
+
+void CompileServer::serve() {
+    for (;;) {
+        const int fd = ::accept(listener_, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR)
+                continue;
+            fail("cannot accept on " + socket_path_.string());
+        }
+        Socket client(fd);
+        // A client that stops reading the response must not stall the server either.
+        timeval timeout{};
+        timeout.tv_sec = static_cast<time_t>(request_timeout_.count() / 1000);
+        timeout.tv_usec = static_cast<suseconds_t>(request_timeout_.count() % 1000 * 1000);
+        ::setsockopt(client.fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof timeout);
+        bool keep_serving = true;
+        try {
+            keep_serving = handle(client.fd);
+        } catch (const std::runtime_error&) {
+            // A client that went away mid-request costs only its own build.
+        }
+        if (!keep_serving)
+            return;
+    }
+}
+
+// Compiles one request and answers it. Returns false if the client asked the server to
+// stop.
+bool CompileServer::handle(int client) {
+    const std::optional<std::string> request = read_all(client, Clock::now() + request_timeout_);
+    FieldReader reader(request ? std::string_view(*request) : std::string_view());
+
+    CompileResponse response;
+    bool stop = false;
+    std::optional<std::string_view> magic = reader.next();
+    std::optional<std::string_view> directory = reader.next();
+    std::optional<long long> count = reader.next_number();
+    std::vector<std::string> args;
+    for (long long i = 0; count && i < *count; ++i) {
+        std::optional<std::string_view> arg = reader.next();
+        if (!arg) {
+            count.reset();
+            break;
+        }
+        args.emplace_back(*arg);
+    }
+
+    if (!request) {
+        response.exit_code = 1;
+        response.err = "flux: compile request not received within " +
+                       std::to_string(request_timeout_.count()) + " ms\n";
+    } else if (magic != kRequestMagic || !directory || !count || *count < 0) {
+        response.exit_code = 1;
+        response.err = "flux: malformed compile request\n";
+    } else if (!args.empty() && args[0] == kStopArgument) {
+        stop = true;
+        response.out = "Compile server stopped.\n";
+    } else if (args.empty()) {
+        response.exit_code = 1;
+        response.err = "flux: no input file\n";
+    } else {
+        CompileOptions options;
+        options.build = args[0] == "build" && args.size() > 1;
+        options.input = args[options.build ? 1 : 0];
+        options.working_directory = std::string(*directory);
+        std::ostringstream out;
+        std::ostringstream err;
+        const auto flags = args.begin() + (options.build ? 2 : 1);
+        if (auto error = parse_compile_flags({flags, args.end()}, options)) {
+            response.exit_code = 1;
+            err << *error << '\n';
+        } else {
+            response.exit_code = session_.compile(options, out, err);
+        }
+        response.out = out.str();
+        response.err = err.str();
+    }
+
+    std::string bytes;
+    put_field(bytes, kResponseMagic);
+    put_field(bytes, std::to_string(response.exit_code));
+    put_field(bytes, response.out);
+    put_field(bytes, response.err);
+    write_all(client, bytes);
+    ::shutdown(client, SHUT_WR);
+    return !stop;
+}
+
+CompileResponse send_compile_request(const std::filesystem::path& socket_path,
+                                     const std::filesystem::path& working_directory,
+                                     const std::vector<std::string>& args) {
+    Socket server(connect_to(socket_path));
+
+    std::string bytes;
+    put_field(bytes, kRequestMagic);
+    put_field(bytes, working_directory.string());
+    put_field(bytes, std::to_string(args.size()));
+    for (const std::string& arg : args)
+        put_field(bytes, arg);
+    write_all(server.fd, bytes);
+    ::shutdown(server.fd, SHUT_WR);
+
+    const std::optional<std::string> reply = read_all(server.fd);
+    FieldReader reader(*reply);
+    std::optional<std::string_view> magic = reader.next();
+    std::optional<long long> exit_code = reader.next_number();
+    std::optional<std::string_view> out = reader.next();
+    std::optional<std::string_view> err = reader.next();
+    if (magic != kResponseMagic || !exit_code || !out || !err)
+        throw std::runtime_error("flux: malformed response from compile server");
+    return {static_cast<int>(*exit_code), std::string(*out), std::string(*err)};
+}
+
+#endif
+
+} // namespace flux
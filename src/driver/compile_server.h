@@ -0,0 +1,76 @@
+#ifndef FLUX_COMPILE_SERVER_H
+#define FLUX_COMPILE_SERVER_H
+
+#include "driver/compiler.h"
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace flux {
+
+/// What a compile server sent back for one request.
+struct CompileResponse {
+    int exit_code = 0;
+    std::string out; ///< what `flux` would have written to standard output
+    std::string err; ///< and to standard error
+};
+
+/// `flux serve`: a compiler that stays resident and takes build requests over a Unix domain
+/// socket. All requests share one CompileSession, so the standard library and unchanged
+/// modules stay loaded between builds. Requests are handled one at a time, in the order
+/// they connect. The server owns every Name in its process, so its session clears the
+/// Interner once that grows past a few million names.
+///
+/// A request is a working directory plus the arguments of a `flux` command line (input
+/// file first, after `build` for `flux build`). Every field on the wire is its length in
+/// decimal, a newline, and then its bytes. A request is "flux-request", the directory, the
+/// argument count and the arguments. A response is "flux-response", the exit code, the
+/// output and the diagnostics. Each side shuts down its end once it has written everything.
+/// A client that has not done so within the request timeout gets an error response instead,
+/// so a stalled client cannot hold up the ones queued behind it.
+class CompileServer {
+  public:
+    /// Binds and listens on `socket_path`. A stale socket file left by a server that is no
+    /// longer running is replaced. Throws std::runtime_error on failure, or if another
+    /// server is already listening there.
+    explicit CompileServer(std::filesystem::path socket_path);
+
+    /// Closes the socket and removes its file.
+    ~CompileServer();
+
+    CompileServer(const CompileServer&) = delete;
+    CompileServer& operator=(const CompileServer&) = delete;
+
+    /// Handles requests until one asks the server to stop (the argument `--stop-server`).
+    void serve();
+
+    /// How long a client may take to send its whole request, and each write of the
+    /// response may block. Ten seconds by default.
+    void set_request_timeout(std::chrono::milliseconds timeout) {
+        request_timeout_ = timeout;
+    }
+
+    const CompileSession& session() const {
+        return session_;
+    }
+
+  private:
+    bool handle(int client);
+
+    std::filesystem::path socket_path_;
+    int listener_ = -1;
+    std::chrono::milliseconds request_timeout_ = std::chrono::seconds(10);
+    CompileSession session_;
+};
+
+/// Sends one request to the server at `socket_path` and waits for its response. Throws
+/// std::runtime_error if no server answers there.
+CompileResponse send_compile_request(const std::filesystem::path& socket_path,
+                                     const std::filesystem::path& working_directory,
+                                     const std::vector<std::string>& args);
+
+} // namespace flux
+
+#endif // FLUX_COMPILE_SERVER_H
@@ -0,0 +1,849 @@
+#include "driver/compiler.h"
+
+#include "lexer/diagnostic.h"
+#include "lexer/interner.h"
+
+#include "semantic/monomorphizer.h"
+#include "semantic/type.h"
+
+// IR
+#include "ir/ir_lowering.h"
+#include "ir/ir_pass.h"
+#include "ir/ir_printer.h"
+#include "ir/passes/pipeline.h"
+
+// Codegen
+#include "codegen/codegen.h"
+#include "codegen/jit.h"
+#include "codegen/partition.h"
+#include "codegen/target.h"
+
+// Driver
+#include "driver/dependency_graph.h"
+
+#include "support/hash.h"
+#include "support/statistics.h"
+#include "support/trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace flux {
+namespace {
+std::filesystem::path working_directory(const CompileOptions& options) {
+    return options.working_directory.empty() ? std::filesystem::current_path()
+                                              : options.working_directory;
+}
+
+std::string entry_path(const CompileOptions& options) {
+    if (options.input == "-" || options.working_directory.empty())
+        return options.input;
+    return (options.working_directory / options.input).string();
+}
+
+// Searches the working directory and its std/.
+std::unique_ptr<ModuleLoader> make_loader(const CompileOptions& options) {
+    auto loader = std::make_unique<ModuleLoader>(working_directory(options));
+    loader->add_search_path(working_directory(options) / "std");
+    return loader;
+}
+
+// One stage of the pipeline: a row of --time-passes and a span of --trace.
+struct Phase {
+    Phase(Statistics* stats, const char* name) : timer(stats, name), span("phase", name) {}
+
+    Statistics::Timer timer;
+    TraceSpan span;
+};
+
+// Times each IR pass and counts the instructions it leaves behind.
+class PassStatistics final : public ir::PassInstrumentation {
+  public:
+    explicit PassStatistics(Statistics* stats) : stats_(stats) {}
+
+    void before_pass(const ir::IRPass& pass, const ir::IRModule&) override {
+        timer_.emplace(stats_, pass.name());
+    }
+
+    void after_pass(const ir::IRPass& pass, const ir::IRModule& module, bool) override {
+        timer_.reset();
+        stats_->set("IR instructions after pass " + std::to_string(++passes_) + " (" +
+                        pass.name() + ")",
+                    module.instruction_count());
+    }
+
+  private:
+    Statistics* stats_;
+    std::optional<Statistics::Timer> timer_;
+    unsigned passes_ = 0;
+};
+
+// Where `flux build` writes: -o, or the input file's name with the extension of what is
+// emitted.
+std::filesystem::path output_path(const CompileOptions& options) {
+    if (!options.output.empty())
+        return working_directory(options) / options.output;
+    const bool from_stdin = options.input == "-";
+    std::filesystem::path name = from_stdin ? "a" : std::filesystem::path(options.input).filename();
+    if (!options.emit) {
+        name.replace_extension(from_stdin ? ".out" : "");
+    } else {
+        switch (*options.emit) {
+        case codegen::FileType::Object:
+            name.replace_extension(".o");
+            break;
+        case codegen::FileType::Assembly:
+            name.replace_extension(".s");
+            break;
+        case codegen::FileType::Bitcode:
+            name.replace_extension(".bc");
+            break;
+        case codegen::FileType::LLVMIR:
+            name.replace_extension(".ll");
+            break;
+        }
+    }
+    return working_directory(options) / name;
+}
+
+// Writes what `flux build` asked for with `machine`, built for options.reloc and
+// options.opt_level. An executable is linked from an object file written next to it, which
+// is removed afterwards.
+void write_build_output(codegen::CodeGenerator& generator, const codegen::TargetMachine& machine,
+                        const std::string& entry_module, const CompileOptions& options,
+                        Statistics* stats, std::ostream& out) {
+    generator.add_entry_point(entry_module + "::main");
+    {
+        Phase phase(stats, "LLVM passes");
+        machine.optimize(generator.module(), options.opt_level);
+    }
+    const std::filesystem::path output = output_path(options);
+    if (options.emit) {
+        machine.emit(generator.module(), *options.emit, output);
+    } else {
+        std::filesystem::path object = output;
+        object += ".o";
+        machine.emit(generator.module(), codegen::FileType::Object, object);
+        try {
+            codegen::link_executable({object}, output, options.reloc);
+        } catch (...) {
+            std::filesystem::remove(object);
+            throw;
+        }
+        std::filesystem::remove(object);
+    }
+    out << "Wrote " << output.string() << "\n";
+}
+
+// Where codegen unit `partition` of a partitioned build writes `path`: `app.o` becomes
+// `app.0.o`, `app.1.o`, ...
+std::filesystem::path partition_path(std::filesystem::path path, unsigned partition) {
+    const std::filesystem::path extension = path.extension();
+    path.replace_extension(std::to_string(partition));
+    path += extension;
+    return path;
+}
+
+// `flux build --codegen-units=N`: compiles the partitions of `ir_module` in parallel. An
+// executable is linked from one object per partition, which are removed afterwards;
+// `--emit=` writes one file per partition instead.
+void write_partitioned_build_output(const ir::IRModule& ir_module, const std::string& entry_module,
+                                    const CompileOptions& options, Statistics* stats,
+                                    std::ostream& out) {
+    const std::vector<unsigned> partitions =
+        codegen::partition_functions(ir_module, options.codegen_units);
+    unsigned count = 1;
+    for (unsigned partition : partitions)
+        count = std::max(count, partition + 1);
+    if (stats)
+        stats->set("codegen units", count);
+
+    const std::filesystem::path output = output_path(options);
+    std::vector<std::filesystem::path> files;
+    for (unsigned partition = 0; partition < count; ++partition) {
+        std::filesystem::path file = output;
+        if (!options.emit)
+            file += ".o";
+        files.push_back(partition_path(file, partition));
+    }
+
+    codegen::PartitionOptions partition_options;
+    partition_options.type = options.emit.value_or(codegen::FileType::Object);
+    partition_options.reloc = options.reloc;
+    partition_options.level = options.opt_level;
+    partition_options.entry_point = entry_module + "::main";
+    partition_options.jobs = options.jobs;
+    if (options.emit) {
+        codegen::emit_partitions(ir_module, partitions, files, partition_options);
+        for (const auto& file : files)
+            out << "Wrote " << file.string() << "\n";
+        return;
+    }
+    auto remove_objects = [&] {
+        for (const auto& file : files)
+            std::filesystem::remove(file);
+    };
+    try {
+        codegen::emit_partitions(ir_module, partitions, files, partition_options);
+        codegen::link_executable(files, output, options.reloc);
+    } catch (...) {
+        remove_objects();
+        throw;
+    }
+    remove_objects();
+    out << "Wrote " << output.string() << "\n";
+}
+
+// The module that declares each function of `modules`: their own functions, and the methods
+// of their impls and traits.
+std::unordered_map<const ast::FunctionDecl*, const std::string*>
+declaring_modules(const std::map<std::string, ast::Module>& modules) {
+    std::unordered_map<const ast::FunctionDecl*, const std::string*> result;
+    for (const auto& [name, module] : modules) {
+        for (const auto& fn : module.functions)
+            result.emplace(&fn, &name);
+        for (const auto& impl : module.impls) {
+            for (const auto& method : impl.methods)
+                result.emplace(&method, &name);
+        }
+        for (const auto& trait : module.traits) {
+            for (const auto& method : trait.methods)
+                result.emplace(&method, &name);
+        }
+    }
+    return result;
+}
+
+// For an executable built one codegen unit per module (see run_pipeline()): lowers each
+// module of `compiled` on its own, with a copy of each specialization it calls, compiles it
+// to an object and stores that in `cache` under the module's fingerprint. Returns where
+// each object is.
+std::map<std::string, std::filesystem::path>
+compile_units(const std::map<std::string, ast::Module>& modules,
+              const semantic::Resolver& resolver, const ast::Module& main_module,
+              const std::set<std::string>& compiled,
+              const std::map<std::string, std::uint64_t>& fingerprints, const ModuleCache& cache,
+              const CompileOptions& options, Statistics* stats, std::ostream& out) {
+    const auto module_of = declaring_modules(modules);
+    auto compiles = [&](const ast::FunctionDecl& fn) {
+        auto it = module_of.find(&fn);
+        return it == module_of.end() || compiled.contains(*it->second);
+    };
+
+    // The monomorphizer names every function by its key.
+    std::unordered_map<std::string, const std::string*> owner;
+    for (const auto& [name, decl] : resolver.function_decls()) {
+        auto it = module_of.find(decl);
+        if (it != module_of.end() && decl->type_params.empty())
+            owner.emplace(name, it->second);
+    }
+
+    out << "Starting monomorphization...\n";
+    semantic::Monomorphizer monomorphizer(resolver);
+    ast::Module assembly;
+    {
+        Phase phase(stats, "monomorphize");
+        assembly = monomorphizer.monomorphize(main_module, compiles);
+    }
+    // Specializations, and anything else no module owns, are lowered into every unit that
+    // calls them.
+    std::unordered_map<std::string, const ast::FunctionDecl*> program;
+    std::map<std::string, std::vector<const ast::FunctionDecl*>> defined;
+    std::unordered_set<std::string> shared;
+    for (const auto& fn : assembly.functions) {
+        program.emplace(fn.name.str(), &fn);
+        auto it = owner.find(fn.name.str());
+        if (it == owner.end())
+            shared.insert(fn.name.str());
+        else if (compiled.contains(*it->second))
+            defined[*it->second].push_back(&fn);
+    }
+
+    out << "Lowering to IR...\n";
+    std::vector<ir::IRModule> units;
+    {
+        Phase phase(stats, "lower to IR");
+        for (const std::string& name : compiled) {
+            ir::IRLowering lowering;
+            units.push_back(lowering.lower_unit(name, defined[name], program, shared));
+        }
+    }
+    std::size_t functions = 0;
+    for (const ir::IRModule& unit : units) {
+        for (const auto& function : unit.functions)
+            functions += !function->blocks.empty();
+    }
+    out << "IR lowering OK. Functions: " << functions << "\n";
+    if (stats)
+        stats->set("IR functions", functions);
+
+    out << "Running IR passes...\n";
+    {
+        Phase phase(stats, "IR passes");
+        for (ir::IRModule& unit : units) {
+            std::vector<std::unique_ptr<ir::IRPass>> passes =
+                ir::make_pass_pipeline(options.opt_level);
+            ir::run_passes(unit, passes);
+        }
+    }
+
+    std::vector<const ir::IRModule*> unit_pointers;
+    std::vector<std::filesystem::path> files;
+    for (const ir::IRModule& unit : units) {
+        unit_pointers.push_back(&unit);
+        files.push_back(cache.temporary_object_path(fingerprints.at(unit.name)));
+    }
+    codegen::PartitionOptions unit_options;
+    unit_options.reloc = options.reloc;
+    unit_options.level = options.opt_level;
+    unit_options.entry_point = main_module.name + "::main";
+    unit_options.jobs = options.jobs;
+    {
+        Phase phase(stats, "emit native code");
+        try {
+            codegen::emit_modules(unit_pointers, files, unit_options);
+        } catch (...) {
+            std::error_code ec;
+            for (const auto& file : files)
+                std::filesystem::remove(file, ec);
+            throw;
+        }
+    }
+
+    std::map<std::string, std::filesystem::path> objects;
+    for (std::size_t i = 0; i < units.size(); ++i)
+        objects[units[i].name] = cache.store_object(fingerprints.at(units[i].name), files[i]);
+    return objects;
+}
+
+// Links the object of every module of `fingerprints` into the executable: the one in
+// `compiled` if this build compiled it, or else the one `cache` keeps. A compiled object
+// that could not be stored is removed afterwards.
+void link_units(const std::map<std::string, std::uint64_t>& fingerprints,
+                const std::map<std::string, std::filesystem::path>& compiled,
+                const ModuleCache& cache, const CompileOptions& options, Statistics* stats,
+                std::ostream& out) {
+    std::vector<std::filesystem::path> objects;
+    std::vector<std::filesystem::path> unstored;
+    for (const auto& [name, fingerprint] : fingerprints) {
+        auto it = compiled.find(name);
+        objects.push_back(it == compiled.end() ? cache.object_path(fingerprint) : it->second);
+        if (objects.back() != cache.object_path(fingerprint))
+            unstored.push_back(objects.back());
+    }
+    if (stats) {
+        stats->set("modules compiled", compiled.size());
+        stats->set("modules reused", fingerprints.size() - compiled.size());
+    }
+
+    const std::filesystem::path output = output_path(options);
+    auto remove_unstored = [&] {
+        std::error_code ec;
+        for (const auto& file : unstored)
+            std::filesystem::remove(file, ec);
+    };
+    {
+        Phase phase(stats, "link");
+        try {
+            codegen::link_executable(objects, output, options.reloc);
+        } catch (...) {
+            remove_unstored();
+            throw;
+        }
+    }
+    remove_unstored();
+    out << "Wrote " << output.string() << "\n";
+}
+
+// `flux run`: optimizes the module as `flux build` would, with a PIC `machine` for
+// options.opt_level, compiles it with `jit` and calls the entry module's main. Returns what
+// main returns.
+int run_in_jit(codegen::CodeGenerator& generator, const codegen::TargetMachine& machine,
+               codegen::JIT& jit, const std::string& entry_module, const CompileOptions& options,
+               Statistics* stats) {
+    generator.add_entry_point(entry_module + "::main");
+    {
+        Phase phase(stats, "LLVM passes");
+        machine.optimize(generator.module(), options.opt_level);
+    }
+    using EntryPoint = int (*)();
+    EntryPoint entry = nullptr;
+    {
+        Phase phase(stats, "JIT compile");
+        jit.add_module(generator.release_module());
+        entry = reinterpret_cast<EntryPoint>(jit.lookup("main"));
+    }
+    Phase phase(stats, "run");
+    const int status = entry();
+    // The program writes through C stdio; flush it before the compiler writes anything.
+    std::fflush(stdout);
+    return status;
+}
+
+// Everything after the loader is set up. `reload` picks ModuleLoader::reload() over load(),
+// for loaders that are kept between compilations, and `resident` is their session's state,
+// or null. Phases are timed, and counters recorded, into `stats` unless it is null. For
+// `flux run`, the program's exit code goes to `program_status`.
+int run_pipeline(ModuleLoader& loader, bool reload, const CompileOptions& options,
+                 const ModuleCache* cache, CompileSession::Resident* resident, Statistics* stats,
+                 int& program_status, std::ostream& out, std::ostream& err) {
+    const std::string entry = entry_path(options);
+
+    try {
+        out << "Loading modules...\n";
+        ast::Module* main_module = nullptr;
+        const LoaderStats before = loader.stats();
+        {
+            Phase phase(stats, "load modules");
+            main_module = reload ? loader.reload(entry) : loader.load(entry);
+        }
+
+        std::vector<ast::Module*> modules;
+        auto& loaded = const_cast<std::map<std::string, ast::Module>&>(loader.modules());
+        for (auto& [name, mod] : loaded) {
+            modules.push_back(&mod);
+        }
+
+        out << "Loaded " << modules.size() << " modules.\n";
+        if (stats) {
+            std::size_t nodes = 0;
+            for (const ast::Module* module : modules)
+                nodes += module->context ? module->context->nodes() : 0;
+            stats->set("modules", modules.size());
+            stats->set("source files read", loader.stats().files_read - before.files_read);
+            stats->set("bytes lexed", loader.stats().bytes_lexed - before.bytes_lexed);
+            stats->set("tokens lexed", loader.stats().tokens_lexed - before.tokens_lexed);
+            stats->set("AST nodes", nodes);
+        }
+
+        // With a cache, the previous build of the same entry file and flags says what has
+        // changed since. Printed output covers the whole program, so it is made again
+        // unless no module is stale.
+        std::optional<DependencyGraph> graph;
+        if (cache)
+            graph = DependencyGraph::from_loader(loader);
+        std::string build_key;
+        if (graph && entry != "-" && !options.build && !options.run) {
+            build_key = std::filesystem::weakly_canonical(entry).string();
+            if (options.emit_ir)
+                build_key += " --emit-ir";
+            if (options.emit_llvm)
+                build_key += " --emit-llvm";
+            build_key += " -";
+            build_key += ir::opt_level_name(options.opt_level);
+            if (auto previous = cache->load_build(build_key)) {
+                if (graph->up_to_date(previous->graph)) {
+                    out << "No module changed since the last build.\n";
+                    out << previous->outputs["ir"] << previous->outputs["llvm"];
+                    return 0;
+                }
+                out << "Modules changed since the last build: "
+                    << graph->stale_modules(previous->graph).size() << " of " << modules.size()
+                    << "\n";
+            }
+        }
+        ModuleCache::BuildRecord record{graph.value_or(DependencyGraph()), {}};
+
+        // An executable built with a cache is compiled one codegen unit per module, and the
+        // cache keeps each unit's object under a fingerprint of what it was compiled from:
+        // the module's text, the declarations it uses of other modules (ModuleNode::uses)
+        // and the flags. Only the modules without an object are resolved, lowered and
+        // compiled; the others' objects are linked as they are.
+        const bool unit_build = graph && entry != "-" && options.build && !options.emit &&
+                                !options.emit_ir && !options.emit_llvm;
+        std::map<std::string, std::uint64_t> fingerprints;
+        std::set<std::string> compiled;
+        if (unit_build) {
+            std::string key = std::filesystem::weakly_canonical(entry).string() + " -";
+            key += ir::opt_level_name(options.opt_level);
+            key += " --reloc=" + std::to_string(static_cast<int>(options.reloc));
+            for (const auto& [name, node] : graph->modules()) {
+                std::string text = key + '\n' + name + ' ' + std::to_string(node.content_hash);
+                for (const auto& [used, hash] : node.uses)
+                    text += '\n' + used + ' ' + std::to_string(hash);
+                const std::uint64_t fingerprint = hash_bytes(text);
+                fingerprints.emplace(name, fingerprint);
+                if (!std::filesystem::exists(cache->object_path(fingerprint)))
+                    compiled.insert(name);
+            }
+            out << "Modules to compile: " << compiled.size() << " of " << modules.size()
+                << "\n";
+            if (compiled.empty()) {
+                link_units(fingerprints, {}, *cache, options, stats, out);
+                return 0;
+            }
+        }
+
+        semantic::Resolver resolver;
+        resolver.set_jobs(options.jobs);
+        // With a cache or a session, each module whose text is unchanged replays the
+        // declarations recorded for it instead of being declared again. The session keeps
+        // them in memory; the cache on disk.
+        if (cache || resident) {
+            resolver.set_record_declarations(true);
+            for (const auto& [name, module] : loaded) {
+                const std::optional<std::uint64_t> hash = loader.content_hash(name);
+                if (!hash)
+                    continue;
+                std::optional<std::string> declarations;
+                if (resident) {
+                    auto kept = resident->declarations.find(name);
+                    if (kept != resident->declarations.end() && kept->second.first == *hash)
+                        declarations = kept->second.second;
+                }
+                if (!declarations && cache &&
+                    (declarations = cache->load_declarations(*hash, module)) && resident)
+                    resident->declarations[name] = {*hash, *declarations};
+                if (declarations)
+                    resolver.reuse_declarations(module, std::move(*declarations));
+            }
+        }
+        if (unit_build) {
+            std::unordered_set<const ast::Module*> bodies;
+            for (const std::string& name : compiled)
+                bodies.insert(&loaded.at(name));
+            resolver.restrict_bodies(std::move(bodies));
+        }
+        {
+            Phase phase(stats, "resolve");
+            resolver.resolve(modules);
+        }
+        for (const auto& [name, module] : loaded) {
+            const std::optional<std::uint64_t> hash = loader.content_hash(name);
+            const std::string* declarations = resolver.declarations(module);
+            if (!hash || !declarations)
+                continue;
+            if (cache)
+                cache->store_declarations(*hash, module, *declarations);
+            if (resident)
+                resident->declarations[name] = {*hash, *declarations};
+        }
+
+        out << "Semantic analysis OK\n";
+        if (stats) {
+            stats->set("modules declared from cache", resolver.replayed_modules());
+            stats->set("scopes", resolver.scope_count());
+            stats->set("symbols", resolver.symbol_count());
+            stats->set("function instantiations", resolver.function_instantiations().size());
+            stats->set("type instantiations", resolver.type_instantiations().size());
+        }
+        if (unit_build) {
+            link_units(fingerprints,
+                       compile_units(loaded, resolver, *main_module, compiled, fingerprints,
+                                     *cache, options, stats, out),
+                       *cache, options, stats, out);
+            return 0;
+        }
+
+        // Monomorphization
+        out << "Starting monomorphization...\n";
+        semantic::Monomorphizer monomorphizer(resolver);
+        ast::Module monomorphized_module;
+        {
+            Phase phase(stats, "monomorphize");
+            monomorphized_module = monomorphizer.monomorphize(*main_module);
+        }
+
+        out << "Monomorphization OK. Specialized functions generated: "
+            << (monomorphized_module.functions.size() - main_module->functions.size()) << "\n";
+
+        // IR Lowering
+        out << "Lowering to IR...\n";
+        ir::IRLowering lowering;
+        ir::IRModule ir_module;
+        {
+            Phase phase(stats, "lower to IR");
+            ir_module = lowering.lower(monomorphized_module);
+        }
+
+        out << "IR lowering OK. Functions: " << ir_module.functions.size() << "\n";
+        if (stats) {
+            stats->set("IR functions", ir_module.functions.size());
+            stats->set("IR instructions after lowering", ir_module.instruction_count());
+        }
+
+        // IR Optimization Passes
+        out << "Running IR passes...\n";
+        std::vector<std::unique_ptr<ir::IRPass>> passes = ir::make_pass_pipeline(options.opt_level);
+
+        int modified = 0;
+        {
+            Phase phase(stats, "IR passes");
+            std::optional<PassStatistics> instrumentation;
+            if (stats)
+                instrumentation.emplace(stats);
+            modified = ir::run_passes(ir_module, passes,
+                                      instrumentation ? &*instrumentation : nullptr);
+        }
+        out << "IR passes complete. Passes that modified IR: " << modified << "\n";
+
+        // Emit IR if requested
+        if (options.emit_ir) {
+            std::ostringstream text;
+            ir::IRPrinter printer;
+            printer.print(ir_module, text);
+            record.outputs["ir"] = text.str();
+            out << record.outputs["ir"];
+        }
+
+        // Codegen. A partitioned build compiles its codegen units on their own; the whole
+        // module is still generated for --emit-llvm.
+        const bool partitioned = options.build && options.codegen_units > 1;
+        std::optional<codegen::TargetMachine> own_machine;
+        auto machine = [&](codegen::RelocModel reloc) -> const codegen::TargetMachine& {
+            if (resident)
+                return resident->machine(reloc, options.opt_level);
+            return own_machine.emplace(reloc, options.opt_level);
+        };
+        if (options.emit_llvm || (options.build && !partitioned) || options.run) {
+            // The JIT owns the context that the module it runs is built in.
+            std::optional<codegen::JIT> jit;
+            if (options.run)
+                jit.emplace();
+            codegen::CodeGenerator generator(jit ? jit->context() : nullptr);
+            {
+                out << "Generating LLVM IR...\n";
+                Phase phase(stats, "LLVM codegen");
+                generator.compile(ir_module);
+            }
+            if (options.emit_llvm) {
+                record.outputs["llvm"] = generator.to_string() + '\n';
+                out << record.outputs["llvm"] << std::flush;
+            }
+            if (options.build && !partitioned) {
+                Phase phase(stats, "emit native code");
+                write_build_output(generator, machine(options.reloc), main_module->name,
+                                   options, stats, out);
+            }
+            if (options.run)
+                program_status = run_in_jit(generator, machine(codegen::RelocModel::PIC), *jit,
+                                            main_module->name, options, stats);
+        }
+        if (partitioned) {
+            Phase phase(stats, "emit native code");
+            write_partitioned_build_output(ir_module, main_module->name, options, stats, out);
+        }
+
+        if (!build_key.empty())
+            cache->store_build(build_key, record);
+
+    } catch (const DiagnosticError& e) {
+        err << e.what() << '\n';
+        return 1;
+    } catch (const std::exception& e) {
+        err << "Internal error: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
+
+// run_pipeline(), traced into --trace's file and followed by the reports asked for by
+// --time-passes and --stats.
+int run(ModuleLoader& loader, bool reload, const CompileOptions& options,
+        const ModuleCache* cache, CompileSession::Resident* resident, std::ostream& out,
+        std::ostream& err) {
+    std::optional<Tracer> tracer;
+    if (!options.trace_file.empty())
+        tracer.emplace();
+    Statistics stats;
+    const bool report = options.time_passes || options.stats;
+
+    // `flux run` prints the program's output only.
+    std::ostream silent(nullptr);
+    std::ostream& progress = options.run ? silent : out;
+
+    int status = 0;
+    int program_status = 0;
+    {
+        TraceScope tracing(tracer ? &*tracer : nullptr);
+        Phase phase(report ? &stats : nullptr, "total");
+        status = run_pipeline(loader, reload, options, cache, resident,
+                              report ? &stats : nullptr, program_status, progress, err);
+    }
+
+    // A failed build is traced too: the timeline shows how far it got.
+    if (tracer) {
+        const std::filesystem::path path = working_directory(options) / options.trace_file;
+        std::ofstream file(path, std::ios::binary);
+        tracer->write(file);
+        if (!file) {
+            err << "flux: cannot write trace file: " << path.string() << '\n';
+            return 1;
+        }
+    }
+    if (status != 0)
+        return status;
+    if (!report)
+        return program_status;
+
+    stats.set("peak resident memory (bytes)", peak_rss_bytes());
+    if (options.report_json) {
+        stats.print_json(err, options.time_passes, options.stats);
+        return program_status;
+    }
+    if (options.time_passes)
+        stats.print_phases(err);
+    if (options.stats)
+        stats.print_counters(err);
+    return program_status;
+}
+} // namespace
+
+std::optional<std::string> parse_compile_flags(const std::vector<std::string>& flags,
+                                               CompileOptions& options) {
+    for (std::size_t i = 0; i < flags.size(); ++i) {
+        const std::string& arg = flags[i];
+        if (arg == "--emit-ir")
+            options.emit_ir = true;
+        else if (arg == "--emit-llvm")
+            options.emit_llvm = true;
+        else if (arg.starts_with("-j") || arg.starts_with("--jobs=")) {
+            const std::string count = arg.substr(arg[1] == 'j' ? 2 : 7);
+            if (count.empty() || count.size() > 4 ||
+                count.find_first_not_of("0123456789") != std::string::npos) {
+                return "flux: invalid job count: " + arg;
+            }
+            options.jobs = static_cast<unsigned>(std::stoul(count));
+        } else if (arg.starts_with("--codegen-units=")) {
+            const std::string count = arg.substr(16);
+            if (count.empty() || count.size() > 4 ||
+                count.find_first_not_of("0123456789") != std::string::npos ||
+                std::stoul(count) == 0) {
+                return "flux: invalid codegen unit count: " + arg;
+            }
+            options.codegen_units = static_cast<unsigned>(std::stoul(count));
+        } else if (arg.starts_with("-O")) {
+            if (arg == "-O0")
+                options.opt_level = ir::OptLevel::O0;
+            else if (arg == "-O1")
+                options.opt_level = ir::OptLevel::O1;
+            else if (arg == "-O2")
+                options.opt_level = ir::OptLevel::O2;
+            else if (arg == "-O3")
+                options.opt_level = ir::OptLevel::O3;
+            else if (arg == "-Os")
+                options.opt_level = ir::OptLevel::Os;
+            else
+                return "flux: unknown optimization level: " + arg;
+        } else if (arg == "-o") {
+            if (i + 1 == flags.size() || flags[i + 1].empty())
+                return "flux: -o needs a file name";
+            options.output = flags[++i];
+        } else if (arg.starts_with("--emit=")) {
+            const std::string kind = arg.substr(7);
+            if (kind == "obj")
+                options.emit = codegen::FileType::Object;
+            else if (kind == "asm")
+                options.emit = codegen::FileType::Assembly;
+            else if (kind == "bc")
+                options.emit = codegen::FileType::Bitcode;
+            else if (kind == "llvm-ir")
+                options.emit = codegen::FileType::LLVMIR;
+            else
+                return "flux: unknown output kind: " + kind;
+        } else if (arg.starts_with("--reloc=")) {
+            const std::string model = arg.substr(8);
+            if (model == "pic")
+                options.reloc = codegen::RelocModel::PIC;
+            else if (model == "static")
+                options.reloc = codegen::RelocModel::Static;
+            else if (model == "dynamic-no-pic")
+                options.reloc = codegen::RelocModel::DynamicNoPIC;
+            else
+                return "flux: unknown relocation model: " + model;
+        } else if (arg.starts_with("--cache-dir=")) {
+            options.cache_dir = arg.substr(12);
+        } else if (arg.starts_with("--trace=")) {
+            options.trace_file = arg.substr(8);
+            if (options.trace_file.empty())
+                return "flux: --trace needs a file name";
+        } else if (arg == "--time-passes") {
+            options.time_passes = true;
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg.starts_with("--report-format=")) {
+            const std::string format = arg.substr(16);
+            if (format != "text" && format != "json")
+                return "flux: unknown report format: " + format;
+            options.report_json = format == "json";
+        }
+    }
+    return std::nullopt;
+}
+
+int compile(const CompileOptions& options, std::ostream& out, std::ostream& err) {
+    std::unique_ptr<ModuleCache> cache;
+    try {
+        if (!options.cache_dir.empty())
+            cache = std::make_unique<ModuleCache>(working_directory(options) / options.cache_dir);
+    } catch (const std::exception& e) {
+        err << "Internal error: " << e.what() << '\n';
+        return 1;
+    }
+
+    auto loader = make_loader(options);
+    loader->set_jobs(options.jobs);
+    loader->set_cache(cache.get());
+    return run(*loader, false, options, cache.get(), nullptr, out, err);
+}
+
+const codegen::TargetMachine& CompileSession::Resident::machine(codegen::RelocModel reloc,
+                                                                 ir::OptLevel level) {
+    auto& slot = machines[{reloc, level}];
+    if (!slot)
+        slot = std::make_unique<codegen::TargetMachine>(reloc, level);
+    return *slot;
+}
+
+int CompileSession::compile(const CompileOptions& options, std::ostream& out, std::ostream& err) {
+    // Between compilations, the only Names alive are in the ASTs of loaders_. The Resolver,
+    // IR and CodeGenerator that held the rest belonged to a compilation that has finished.
+    // caches_ and resident_ hold none: module caches and declaration records store names as
+    // text, and target machines never see one. Every TypeId but the built-in ones was held
+    // by those finished compilations too. So with the loaders gone, neither is left. The
+    // records are dropped as well, to bound the session's memory.
+    if (name_limit_ && (Interner::global().size() > name_limit_ ||
+                        semantic::TypeContext::global().size() > name_limit_)) {
+        loaders_.clear();
+        resident_.declarations.clear();
+        Interner::global().clear();
+        semantic::TypeContext::global().clear();
+    }
+
+    const std::filesystem::path directory = working_directory(options);
+
+    ModuleCache* cache = nullptr;
+    if (!options.cache_dir.empty()) {
+        const std::string path = (directory / options.cache_dir).lexically_normal().string();
+        auto& slot = caches_[path];
+        try {
+            if (!slot)
+                slot = std::make_unique<ModuleCache>(path);
+        } catch (const std::exception& e) {
+            caches_.erase(path);
+            err << "Internal error: " << e.what() << '\n';
+            return 1;
+        }
+        cache = slot.get();
+    }
+
+    // Standard input is never the same file twice, so it gets a fresh loader.
+    if (options.input == "-")
+        return flux::compile(options, out, err);
+
+    auto& loader = loaders_[directory.string() + '\n' + entry_path(options)];
+    if (!loader)
+        loader = make_loader(options);
+    loader->set_jobs(options.jobs);
+    loader->set_cache(cache);
+    return run(*loader, true, options, cache, &resident_, out, err);
+}
+
+} // namespace flux
@@ -0,0 +1,120 @@
+#ifndef FLUX_COMPILER_H
+#define FLUX_COMPILER_H
+
+#include "codegen/target.h"
+#include "driver/module_cache.h"
+#include "driver/module_loader.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flux {
+
+/// One compilation, as described on the command line.
+struct CompileOptions {
+    std::string input; ///< entry file, or "-" for standard input
+    bool emit_ir = false;
+    bool emit_llvm = false;
+    /// `flux build`: write native code for the program to `output`. By default that is an
+    /// executable linked by the system's C compiler; `--emit=` picks a single file instead.
+    bool build = false;
+    /// `flux run`: compile the program in memory with the JIT and call its main, in this
+    /// process. Nothing but the program's own output and diagnostics is printed, and
+    /// compile() returns what main returns.
+    bool run = false;
+    /// `--emit=obj|asm|bc|llvm-ir`. Empty means an executable.
+    std::optional<codegen::FileType> emit;
+    /// `-o FILE`, relative to `working_directory`. Empty names the output after the input
+    /// file: `app.fl` builds `app`, or `app.o`, `app.s`, `app.bc`, `app.ll`.
+    std::filesystem::path output;
+    codegen::RelocModel reloc = codegen::RelocModel::PIC; ///< `--reloc=pic|static|dynamic-no-pic`
+    /// `-O0` ... `-O3`, `-Os`: the Flux IR passes that run (ir::make_pass_pipeline()) and,
+    /// for `flux build`, the LLVM pipeline and code generator level.
+    ir::OptLevel opt_level = ir::OptLevel::O2;
+    /// `--codegen-units=N`: for `flux build`, split the program into up to N partitions
+    /// (codegen::partition_functions()) that are compiled in parallel and linked together.
+    /// The split, and so the output, does not depend on `jobs`. Executables built with
+    /// `cache_dir` ignore it and compile one unit per module.
+    unsigned codegen_units = 1;
+    /// ModuleLoader::set_jobs(), Resolver::set_jobs(), and the threads compiling codegen
+    /// units; 0 uses every hardware thread.
+    unsigned jobs = 1;
+    std::string cache_dir;
+    bool time_passes = false; ///< report wall and CPU time per phase and per IR pass
+    bool stats = false;       ///< report counters (tokens, AST nodes, ...) and peak memory
+    bool report_json = false; ///< write those reports as one JSON object, not as tables
+    /// Write a Chrome trace of the compilation here (see support/trace.h), relative to
+    /// `working_directory`. Empty means no tracing.
+    std::filesystem::path trace_file;
+    /// Where `input` and the module search paths are resolved. Empty means the current
+    /// directory of the process.
+    std::filesystem::path working_directory;
+};
+
+/// Reads the flags that follow the input file. Returns an error message for a flag that
+/// is malformed; unknown flags are ignored. `-o` takes the next argument as its value.
+std::optional<std::string> parse_compile_flags(const std::vector<std::string>& flags,
+                                               CompileOptions& options);
+
+/// Runs the whole pipeline (load, resolve, monomorphize, lower, IR passes, codegen) once,
+/// writing progress and requested output to `out` and diagnostics to `err`. The reports of
+/// --time-passes and --stats go to `err` as well, after a successful compilation. Returns
+/// the process exit code: for `flux run`, the program's, once it compiled.
+int compile(const CompileOptions& options, std::ostream& out, std::ostream& err);
+
+/// State kept from one compilation to the next by a long-running compiler (`flux serve`).
+/// Each entry file, per working directory, keeps its ModuleLoader: a later compilation
+/// re-reads only the files that changed (ModuleLoader::reload()), so the standard library
+/// and unchanged dependencies are neither read nor parsed again. Module caches are kept
+/// open per directory as well. Not thread-safe; compile one request at a time.
+class CompileSession {
+  public:
+    /// What the stages after loading keep between compilations.
+    struct Resident {
+        /// The declaration record (semantic::Resolver::declarations()) of every module an
+        /// earlier compilation declared, by module name, with the content hash of the text
+        /// it was recorded for. An unchanged module, the standard library's included,
+        /// replays its record rather than being declared again, with or without a cache.
+        std::map<std::string, std::pair<std::uint64_t, std::string>> declarations;
+        /// Host target machines for `flux build` and `flux run`, by relocation model and
+        /// optimization level. Creating one probes the host's CPU and its features.
+        std::map<std::pair<codegen::RelocModel, ir::OptLevel>,
+                 std::unique_ptr<codegen::TargetMachine>>
+            machines;
+
+        const codegen::TargetMachine& machine(codegen::RelocModel reloc, ir::OptLevel level);
+    };
+
+    int compile(const CompileOptions& options, std::ostream& out, std::ostream& err);
+
+    /// The number of loaders kept, one per (working directory, entry file).
+    std::size_t warm_loaders() const {
+        return loaders_.size();
+    }
+
+    /// Once the process-wide Interner holds more than `names` strings, or the TypeContext
+    /// more than `names` types, the next compile drops every loader and declaration record
+    /// and clears both first, so a long-lived session does not grow without bound. Only for
+    /// a session that owns every Name and TypeId in the process, as the compile server's
+    /// does. 0, the default, never clears.
+    void set_name_limit(std::size_t names) {
+        name_limit_ = names;
+    }
+
+  private:
+    std::map<std::string, std::unique_ptr<ModuleLoader>> loaders_;
+    std::map<std::string, std::unique_ptr<ModuleCache>> caches_;
+    Resident resident_;
+    std::size_t name_limit_ = 0;
+};
+
+} // namespace flux
+
+#endif // FLUX_COMPILER_H
@@ -0,0 +1,210 @@
+#include "driver/dependency_graph.h"
+#include "driver/module_loader.h"
+#include "support/hash.h"
+
+#include <charconv>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace flux {
+
+namespace {
+// Where a declaration sits: a module, and the index of its line in that module's summary.
+using DeclarationRef = std::pair<const std::string*, std::size_t>;
+// Every declaration of the program, by each of its keys.
+using DeclarationIndex = std::unordered_map<std::string, std::vector<DeclarationRef>>;
+
+// The declarations of other modules that module `name`, which spells `references`, uses
+// (see DependencyGraph), hashed per module.
+
+std::map<std::string, std::uint64_t> used_declarations(const ModuleLoader& loader,
+                                                       const std::string& name,
+                                                       const std::vector<std::string>& references,
+                                                       const DeclarationIndex& declarations) {
+    std::unordered_set<std::string> seen(references.begin(), references.end());
+    std::vector<std::string> pending(references.begin(), references.end());
+    std::set<DeclarationRef> used;
+    while (!pending.empty()) {
+        const std::string key = std::move(pending.back());
+        pending.pop_back();
+        auto found = declarations.find(key);
+        if (found == declarations.end())
+            continue;
+        for (const DeclarationRef& ref : found->second) {
+            if (*ref.first == name || !used.insert(ref).second)
+                continue;
+            const ModuleSummary& summary = *loader.summary(*ref.first);
+            for (std::string& mention : identifiers(summary.mentions[ref.second])) {
+                if (seen.insert(mention).second)
+                    pending.push_back(std::move(mention));
+            }
+        }
+    }
+
+    // The lines of one module come out of `used` in order.
+    std::map<std::string, std::string> lines;
+    for (const auto& [module, index] : used)
+        lines[*module] += loader.summary(*module)->declarations[index] + '\n';
+    std::map<std::string, std::uint64_t> uses;
+    for (const auto& [module, text] : lines)
+        uses.emplace(module, hash_bytes(text));
+    return uses;
+}
+} // namespace
+
+DependencyGraph DependencyGraph::from_loader(const ModuleLoader& loader) {
+    DeclarationIndex declarations;
+    for (const auto& [name, module] : loader.modules()) {
+        const ModuleSummary* summary = loader.summary(name);
+        for (std::size_t i = 0; summary && i < summary->keys.size(); ++i) {
+            for (std::string& key : identifiers(summary->keys[i]))
+                declarations[std::move(key)].emplace_back(&name, i);
+        }
+    }
+
+    DependencyGraph graph;
+    for (const auto& [name, module] : loader.modules()) {
+        ModuleNode node;
+        node.content_hash = loader.content_hash(name).value_or(0);
+        if (const ModuleSummary* summary = loader.summary(name))
+            node.interface_hash = summary->interface_hash;
+        for (const auto& import_node : module.imports) {
+            const std::string* target = loader.resolve_import(import_node.module_path);
+            node.imports.push_back(target ? *target : import_node.module_path.str());
+        }
+        if (const std::vector<std::string>* references = loader.references(name))
+            node.uses = used_declarations(loader, name, *references, declarations);
+        graph.add(name, std::move(node));
+    }
+    return graph;
+}
+
+void DependencyGraph::add(const std::string& name, ModuleNode node) {
+    modules_[name] = std::move(node);
+}
+
+const ModuleNode* DependencyGraph::find(const std::string& name) const {
+    auto it = modules_.find(name);
+    return it == modules_.end() ? nullptr : &it->second;
+}
+
+std::vector<std::string> DependencyGraph::importers(const std::string& name) const {
+    std::vector<std::string> result;
+    for (const auto& [importer, node] : modules_) {
+        for (const std::string& import_name : node.imports) {
+            if (import_name == name) {
+                result.push_back(importer);
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+std::set<std::string> DependencyGraph::stale_modules(const DependencyGraph& previous) const {
+    std::set<std::string> stale;
+    for (const auto& [name, node] : modules_) {
+        const ModuleNode* before = previous.find(name);
+        if (!before || before->content_hash != node.content_hash) {
+            stale.insert(name);
+            continue;
+        }
+        // The source is unchanged, so is every name it spells; what they reach may not be.
+        if (before->uses != node.uses)
+            stale.insert(name);
+    }
+    return stale;
+}
+
+bool DependencyGraph::up_to_date(const DependencyGraph& previous) const {
+    if (modules_.size() != previous.modules_.size())
+        return false;
+    for (const auto& [name, node] : previous.modules_) {
+        if (!find(name))
+            return false;
+    }
+    return stale_modules(previous).empty();
+}
+
+// One line per module, then one per import and one per module it uses:
+//
+//   module <name> <content hash> <interface hash> <import count> <use count>
+//   import <name>
+//   use <name> <hash>
+std::string DependencyGraph::serialize() const {
+    std::string out;
+    for (const auto& [name, node] : modules_) {
+        out += "module " + name + ' ' + std::to_string(node.content_hash) + ' ' +
+               std::to_string(node.interface_hash) + ' ' + std::to_string(node.imports.size()) +
+               ' ' + std::to_string(node.uses.size()) + '\n';
+        for (const std::string& import_name : node.imports)
+            out += "import " + import_name + '\n';
+        for (const auto& [used, hash] : node.uses)
+            out += "use " + used + ' ' + std::to_string(hash) + '\n';
+    }
+    return out;
+}
+
+std::optional<DependencyGraph> DependencyGraph::parse(std::string_view text) {
+    std::size_t pos = 0;
+    auto next_line = [&]() -> std::optional<std::string_view> {
+        const std::size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos)
+            return std::nullopt;
+        std::string_view line = text.substr(pos, end - pos);
+        pos = end + 1;
+        return line;
+    };
+    // Splits off the next space-separated field of `line`.
+    auto field = [](std::string_view& line) {
+        const std::size_t space = line.find(' ');
+        std::string_view result = line.substr(0, space);
+        line = space == std::string_view::npos ? std::string_view() : line.substr(space + 1);
+        return result;
+    };
+    auto number = [&](std::string_view& line) -> std::optional<std::uint64_t> {
+        std::string_view digits = field(line);
+        std::uint64_t value = 0;
+        auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+        if (digits.empty() || ec != std::errc() || end != digits.data() + digits.size())
+            return std::nullopt;
+        return value;
+    };
+
+    DependencyGraph graph;
+    while (pos < text.size()) {
+        std::optional<std::string_view> line = next_line();
+        if (!line || field(*line) != "module")
+            return std::nullopt;
+        const std::string name(field(*line));
+        std::optional<std::uint64_t> content = number(*line);
+        std::optional<std::uint64_t> interface = number(*line);
+        std::optional<std::uint64_t> imports = number(*line);
+        std::optional<std::uint64_t> uses = number(*line);
+        if (name.empty() || !content || !interface || !imports || !uses || !line->empty())
+            return std::nullopt;
+
+        ModuleNode node{*content, *interface, {}, {}};
+        for (std::uint64_t i = 0; i < *imports; ++i) {
+            std::optional<std::string_view> import_line = next_line();
+            if (!import_line || field(*import_line) != "import" || import_line->empty())
+                return std::nullopt;
+            node.imports.emplace_back(*import_line);
+        }
+        for (std::uint64_t i = 0; i < *uses; ++i) {
+            std::optional<std::string_view> use_line = next_line();
+            if (!use_line || field(*use_line) != "use")
+                return std::nullopt;
+            const std::string used(field(*use_line));
+            std::optional<std::uint64_t> hash = number(*use_line);
+            if (used.empty() || !hash || !use_line->empty())
+                return std::nullopt;
+            node.uses.emplace(used, *hash);
+        }
+        graph.add(name, std::move(node));
+    }
+    return graph;
+}
+
+} // namespace flux
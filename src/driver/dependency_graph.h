@@ -0,0 +1,74 @@
+#ifndef FLUX_DEPENDENCY_GRAPH_H
+#define FLUX_DEPENDENCY_GRAPH_H
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace flux {
+
+class ModuleLoader;
+
+/// One module of a build: the hashes that decide whether it must be compiled again, and the
+/// modules it imports.
+struct ModuleNode {
+    std::uint64_t content_hash = 0;   ///< of the source text
+    std::uint64_t interface_hash = 0; ///< ModuleSummary::interface_hash
+    std::vector<std::string> imports; ///< as keys of the graph, in import order
+    /// For each other module this one uses declarations of, a hash of those declarations'
+    /// summary lines.
+    std::map<std::string, std::uint64_t> uses;
+
+    bool operator==(const ModuleNode&) const = default;
+};
+
+/// Which module uses which exported signatures of which other module, for one build.
+///
+/// A module uses a declaration of another module (a line of its ModuleSummary) if it
+/// spells one of the declaration's keys, or if a declaration it uses mentions one. That
+/// is decided by name alone, so it can only err towards using too much.
+///
+/// Comparing the graph of this build with the one recorded by the previous build tells
+/// which modules need their later stages re-run. A module is stale if its source changed,
+/// if it is new, or if a declaration it uses changed, appeared or went away. An edit that
+/// leaves the declarations others use alone (a function body, a private helper, a new
+/// function) makes that module stale but not the modules using it.
+class DependencyGraph {
+  public:
+    /// The graph of everything `loader` has loaded.
+    static DependencyGraph from_loader(const ModuleLoader& loader);
+
+    void add(const std::string& name, ModuleNode node);
+
+    const std::map<std::string, ModuleNode>& modules() const {
+        return modules_;
+    }
+    const ModuleNode* find(const std::string& name) const;
+
+    /// The modules that import `name`.
+    std::vector<std::string> importers(const std::string& name) const;
+
+    /// The modules of this graph to compile again, given the graph of the last build.
+    std::set<std::string> stale_modules(const DependencyGraph& previous) const;
+
+    /// True if no module is stale and none was removed, so every result of the previous
+    /// build still holds.
+    bool up_to_date(const DependencyGraph& previous) const;
+
+    /// A line-based text form, read back by parse(); nullopt if `text` is malformed.
+    std::string serialize() const;
+    static std::optional<DependencyGraph> parse(std::string_view text);
+
+    bool operator==(const DependencyGraph&) const = default;
+
+  private:
+    std::map<std::string, ModuleNode> modules_;
+};
+
+} // namespace flux
+
+#endif // FLUX_DEPENDENCY_GRAPH_H
@@ -0,0 +1,310 @@
+#include "driver/module_cache.h"
+#include "ast/ast_serializer.h"
+#include "support/hash.h"
+#include "support/version.h"
+
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace flux {
+namespace {
+// An entry is a text header, one field per line, followed by the serialized AST:
+//
+//   flux-module
+//   <kFluxBuildId>
+//   <kSerializationVersion>
+//   <source size in bytes>
+//   <number of summary lines>
+//   per summary line: the line, its keys, its mentions
+//   <the module's references, space-separated>
+//   <serialized AST>
+constexpr std::string_view kEntryMagic = "flux-module";
+constexpr std::string_view kDeclarationsMagic = "flux-declarations";
+constexpr std::string_view kBuildMagic = "flux-build";
+
+std::string hex(std::uint64_t value) {
+    char digits[17];
+    std::snprintf(digits, sizeof digits, "%016llx", static_cast<unsigned long long>(value));
+    return digits;
+}
+
+// The next header line of `bytes` after `pos`, or nullopt if there is none.
+std::optional<std::string_view> next_line(std::string_view bytes, std::size_t& pos) {
+    const std::size_t end = bytes.find('\n', pos);
+    if (end == std::string_view::npos)
+        return std::nullopt;
+    std::string_view line = bytes.substr(pos, end - pos);
+    pos = end + 1;
+    return line;
+}
+
+std::optional<std::uint64_t> parse_number(std::string_view digits) {
+    std::uint64_t value = 0;
+    auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if (digits.empty() || ec != std::errc() || end != digits.data() + digits.size())
+        return std::nullopt;
+    return value;
+}
+
+std::optional<std::uint64_t> next_number(std::string_view bytes, std::size_t& pos) {
+    std::optional<std::string_view> line = next_line(bytes, pos);
+    return line ? parse_number(*line) : std::nullopt;
+}
+
+// The next `size` bytes after `pos`, or nullopt if there are fewer.
+std::optional<std::string_view> next_bytes(std::string_view bytes, std::size_t& pos,
+                                           std::uint64_t size) {
+    if (size > bytes.size() - pos)
+        return std::nullopt;
+    std::string_view result = bytes.substr(pos, size);
+    pos += size;
+    return result;
+}
+
+std::optional<std::string> read_file(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return std::nullopt;
+    return std::string{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+// Writes a temporary file under a name no other writer, in this process or another, will
+// pick, then renames it over `path`. Failures leave `path` as it was.
+void write_atomically(const std::filesystem::path& path, const std::string& bytes) {
+    std::filesystem::path temp = path;
+    temp += ".tmp" + hex(std::random_device{}());
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec)
+        std::filesystem::remove(temp, ec);
+}
+} // namespace
+
+ModuleCache::ModuleCache(std::filesystem::path directory) : directory_(std::move(directory)) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec || !std::filesystem::is_directory(directory_))
+        throw std::runtime_error("flux: cannot use cache directory: " + directory_.string());
+}
+
+std::filesystem::path ModuleCache::entry_path(std::uint64_t content_hash) const {
+    std::string version(kFluxBuildId);
+    version += '/';
+    version += std::to_string(ast::kSerializationVersion);
+    const std::string key = hex(hash_bytes(version)).substr(0, 8);
+    return directory_ / (hex(content_hash) + '-' + key + ".fxm");
+}
+
+std::optional<ModuleCache::Entry> ModuleCache::load(std::uint64_t content_hash,
+                                                    const SourceFile& source) const {
+    const std::optional<std::string> file = read_file(entry_path(content_hash));
+    if (!file)
+        return std::nullopt;
+    const std::string& bytes = *file;
+
+    // Entry names are short hashes; the header settles whether this entry is ours.
+    std::size_t pos = 0;
+    if (next_line(bytes, pos) != kEntryMagic || next_line(bytes, pos) != kFluxBuildId ||
+        next_number(bytes, pos) != ast::kSerializationVersion ||
+        next_number(bytes, pos) != source.text().size())
+        return std::nullopt;
+
+    std::optional<std::uint64_t> lines = next_number(bytes, pos);
+    if (!lines || *lines > bytes.size() - pos)
+        return std::nullopt;
+    Entry entry;
+    ModuleSummary& summary = entry.summary;
+    for (std::uint64_t i = 0; i < *lines; ++i) {
+        std::optional<std::string_view> line = next_line(bytes, pos);
+        std::optional<std::string_view> keys = next_line(bytes, pos);
+        std::optional<std::string_view> mentions = next_line(bytes, pos);
+        if (!line || !keys || !mentions)
+            return std::nullopt;
+        summary.declarations.emplace_back(*line);
+        summary.keys.emplace_back(*keys);
+        summary.mentions.emplace_back(*mentions);
+    }
+    summary.interface_hash = interface_hash(summary.declarations);
+    std::optional<std::string_view> references = next_line(bytes, pos);
+    if (!references)
+        return std::nullopt;
+    entry.references = identifiers(*references);
+
+    try {
+        entry.module = ast::deserialize(std::string_view(bytes).substr(pos), source);
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+    return entry;
+}
+
+void ModuleCache::store(std::uint64_t content_hash, const ast::Module& module,
+                        const ModuleSummary& summary, const std::vector<std::string>& references,
+                        const SourceFile& source) const {
+    std::string bytes(kEntryMagic);
+    bytes += '\n';
+    bytes += kFluxBuildId;
+    bytes += '\n';
+    bytes += std::to_string(ast::kSerializationVersion) + '\n';
+    bytes += std::to_string(source.text().size()) + '\n';
+    bytes += std::to_string(summary.declarations.size()) + '\n';
+    for (std::size_t i = 0; i < summary.declarations.size(); ++i)
+        bytes += summary.declarations[i] + '\n' + summary.keys[i] + '\n' +
+                 summary.mentions[i] + '\n';
+    for (std::size_t i = 0; i < references.size(); ++i) {
+        if (i)
+            bytes += ' ';
+        bytes += references[i];
+    }
+    bytes += '\n';
+    bytes += ast::serialize(module, source);
+    write_atomically(entry_path(content_hash), bytes);
+}
+
+// A declaration record sits next to its module's entry:
+//
+//   flux-declarations
+//   <kFluxBuildId>
+//   <module name>
+//   <semantic::serialize() of the record>
+//
+// Whether the record is intact is for semantic::deserialize_declarations() to say.
+std::filesystem::path ModuleCache::declarations_path(std::uint64_t content_hash) const {
+    return entry_path(content_hash).replace_extension(".fxd");
+}
+
+std::optional<std::string> ModuleCache::load_declarations(std::uint64_t content_hash,
+                                                          const ast::Module& module) const {
+    std::optional<std::string> file = read_file(declarations_path(content_hash));
+    if (!file)
+        return std::nullopt;
+
+    // The record's keys are qualified by the module's name, which its text does not fix.
+    std::size_t pos = 0;
+    if (next_line(*file, pos) != kDeclarationsMagic || next_line(*file, pos) != kFluxBuildId ||
+        next_line(*file, pos) != module.name.str())
+        return std::nullopt;
+    file->erase(0, pos);
+    return file;
+}
+
+void ModuleCache::store_declarations(std::uint64_t content_hash, const ast::Module& module,
+                                     std::string_view declarations) const {
+    std::string bytes(kDeclarationsMagic);
+    bytes += '\n';
+    bytes += kFluxBuildId;
+    bytes += '\n';
+    bytes += module.name.str() + '\n';
+    bytes += declarations;
+    write_atomically(declarations_path(content_hash), bytes);
+}
+
+// A build record is laid out like a module entry:
+//
+//   flux-build
+//   <kFluxBuildId>
+//   <build key>
+//   <size of the graph text>
+//   <DependencyGraph::serialize()>
+//   <number of outputs>
+//   then per output: "<name> <size>" on a line, followed by that many bytes
+std::filesystem::path ModuleCache::build_path(const std::string& build_key) const {
+    return directory_ / ("build-" + hex(hash_bytes(build_key)) + ".fxb");
+}
+
+std::optional<ModuleCache::BuildRecord>
+ModuleCache::load_build(const std::string& build_key) const {
+    const std::optional<std::string> file = read_file(build_path(build_key));
+    if (!file)
+        return std::nullopt;
+    const std::string_view bytes = *file;
+
+    std::size_t pos = 0;
+    if (next_line(bytes, pos) != kBuildMagic || next_line(bytes, pos) != kFluxBuildId ||
+        next_line(bytes, pos) != build_key)
+        return std::nullopt;
+
+    std::optional<std::uint64_t> graph_size = next_number(bytes, pos);
+    std::optional<std::string_view> graph_text;
+    if (!graph_size || !(graph_text = next_bytes(bytes, pos, *graph_size)))
+        return std::nullopt;
+    std::optional<DependencyGraph> graph = DependencyGraph::parse(*graph_text);
+    std::optional<std::uint64_t> outputs = next_number(bytes, pos);
+    if (!graph || !outputs)
+        return std::nullopt;
+
+    BuildRecord record{std::move(*graph), {}};
+    for (std::uint64_t i = 0; i < *outputs; ++i) {
+        std::optional<std::string_view> header = next_line(bytes, pos);
+        if (!header)
+            return std::nullopt;
+        const std::size_t space = header->rfind(' ');
+        std::optional<std::uint64_t> size;
+        if (space != std::string_view::npos)
+            size = parse_number(header->substr(space + 1));
+        std::optional<std::string_view> text;
+        if (!size || !(text = next_bytes(bytes, pos, *size)))
+            return std::nullopt;
+        record.outputs.emplace(header->substr(0, space), *text);
+    }
+    if (pos != bytes.size())
+        return std::nullopt;
+    return record;
+}
+
+void ModuleCache::store_build(const std::string& build_key, const BuildRecord& record) const {
+    const std::string graph = record.graph.serialize();
+    std::string bytes(kBuildMagic);
+    bytes += '\n';
+    bytes += kFluxBuildId;
+    bytes += '\n';
+    bytes += build_key + '\n';
+    bytes += std::to_string(graph.size()) + '\n';
+    bytes += graph;
+    bytes += std::to_string(record.outputs.size()) + '\n';
+    for (const auto& [name, text] : record.outputs) {
+        bytes += name + ' ' + std::to_string(text.size()) + '\n';
+        bytes += text;
+    }
+    write_atomically(build_path(build_key), bytes);
+}
+
+// Objects need no header: the fingerprint covers the module, what it uses and the flags,
+// and the name adds the build id.
+std::filesystem::path ModuleCache::object_path(std::uint64_t fingerprint) const {
+    const std::string key = hex(hash_bytes(kFluxBuildId)).substr(0, 8);
+    return directory_ / ("unit-" + hex(fingerprint) + '-' + key + ".o");
+}
+
+std::filesystem::path ModuleCache::temporary_object_path(std::uint64_t fingerprint) const {
+    std::filesystem::path path = object_path(fingerprint);
+    path += ".tmp" + hex(std::random_device{}());
+    return path;
+}
+
+std::filesystem::path ModuleCache::store_object(std::uint64_t fingerprint,
+                                                const std::filesystem::path& file) const {
+    const std::filesystem::path path = object_path(fingerprint);
+    std::error_code ec;
+    std::filesystem::rename(file, path, ec);
+    return ec ? file : path;
+}
+
+} // namespace flux
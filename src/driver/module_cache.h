@@ -0,0 +1,103 @@
+#ifndef FLUX_MODULE_CACHE_H
+#define FLUX_MODULE_CACHE_H
+
+#include "ast/ast.h"
+#include "driver/dependency_graph.h"
+#include "driver/module_summary.h"
+#include "lexer/source_file.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace flux {
+
+/// A directory of parsed modules, addressed by the hash_bytes() of their source text.
+/// Each entry holds the module's serialized AST and its ModuleSummary, so a module whose
+/// text has not changed since any earlier build is read back instead of lexed and parsed.
+///
+/// Next to each entry, the cache can keep what the resolver declared for the module (a
+/// semantic::ModuleDeclarations), so a module whose text is unchanged need not be declared
+/// again either.
+///
+/// Entry names combine the content hash with kFluxBuildId and kSerializationVersion, so a
+/// different compiler never reads another one's entries. Entries are written to a
+/// temporary file and renamed into place, so concurrent builds sharing a directory see
+/// whole entries or none. load() and store() may be called from several threads.
+///
+/// The directory also keeps one record per build (an entry file plus the flags that change
+/// its output): the build's DependencyGraph and its outputs, so the next build of the same
+/// program can tell what changed since.
+///
+/// And it keeps the object file of each module that an executable was compiled from, one
+/// codegen unit per module, under a fingerprint of everything that went into it, so that
+/// later builds link the module's object instead of compiling it again.
+class ModuleCache {
+  public:
+    struct Entry {
+        ast::Module module;
+        ModuleSummary summary;
+        std::vector<std::string> references; // see flux::references()
+    };
+
+    struct BuildRecord {
+        DependencyGraph graph;
+        std::map<std::string, std::string> outputs; // e.g. "ir" -> the printed IR
+    };
+
+    /// Creates `directory` if needed. Throws std::runtime_error if it cannot.
+    explicit ModuleCache(std::filesystem::path directory);
+
+    /// The module parsed from `source`, whose text hashes to `content_hash`, with its
+    /// locations placed in `source`. A missing, stale or corrupt entry is a miss.
+    std::optional<Entry> load(std::uint64_t content_hash, const SourceFile& source) const;
+
+    /// Records `module`, parsed from `source`. Failing to write is not an error: the
+    /// module is simply parsed again next time.
+    void store(std::uint64_t content_hash, const ast::Module& module,
+               const ModuleSummary& summary, const std::vector<std::string>& references,
+               const SourceFile& source) const;
+
+    const std::filesystem::path& directory() const {
+        return directory_;
+    }
+
+    std::filesystem::path entry_path(std::uint64_t content_hash) const;
+
+    /// The declarations stored for `module`, whose text hashes to `content_hash`, as
+    /// semantic::Resolver::declarations() gave them. A missing or foreign record, or one
+    /// stored for a module of another name, is a miss.
+    std::optional<std::string> load_declarations(std::uint64_t content_hash,
+                                                 const ast::Module& module) const;
+    /// Records the declarations of `module`. Failing to write is not an error.
+    void store_declarations(std::uint64_t content_hash, const ast::Module& module,
+                            std::string_view declarations) const;
+
+    /// The record stored for `build_key` by an earlier build, or nullopt.
+    std::optional<BuildRecord> load_build(const std::string& build_key) const;
+    void store_build(const std::string& build_key, const BuildRecord& record) const;
+
+    /// Where the object file of the codegen unit with `fingerprint` is kept, if it is.
+    std::filesystem::path object_path(std::uint64_t fingerprint) const;
+    /// A path in the cache directory, unique to this call, to compile the codegen unit with
+    /// `fingerprint` to before store_object() moves it into place.
+    std::filesystem::path temporary_object_path(std::uint64_t fingerprint) const;
+    /// Moves the object file `file` to object_path(fingerprint), and returns where it is now:
+    /// there, or still at `file` if it could not be moved.
+    std::filesystem::path store_object(std::uint64_t fingerprint,
+                                       const std::filesystem::path& file) const;
+
+  private:
+    std::filesystem::path declarations_path(std::uint64_t content_hash) const;
+    std::filesystem::path build_path(const std::string& build_key) const;
+
+    std::filesystem::path directory_;
+};
+
+} // namespace flux
+
+#endif // FLUX_MODULE_CACHE_H
@@ -1,18 +1,56 @@
 #include "driver/module_loader.h"
+#include "driver/module_cache.h"
 #include "lexer/diagnostic.h"
-#include "lexer/lexer.h"
+#include "lexer/token_stream.h"
 #include "parser/parser.h"
+#include "support/hash.h"
+#include "support/thread_pool.h"
+#include "support/trace.h"
 
 #include <algorithm>
 #include <fstream>
+#include <functional>
+#include <iterator>
 #include <iostream>
-#include <sstream>
+#include <mutex>
+#include <set>
 
 namespace flux {
+namespace {
+// Keeps `name` on the loading stack for as long as it is in scope, so an error in an
+// import leaves no stale entry for a later load() to mistake for a cycle.
+class StackEntry {
+  public:
+    StackEntry(std::vector<std::string>& stack, const std::string& name) : stack_(stack) {
+        stack_.push_back(name);
+    }
+    ~StackEntry() {
+        stack_.pop_back();
+    }
+    StackEntry(const StackEntry&) = delete;
+    StackEntry& operator=(const StackEntry&) = delete;
+
+  private:
+    std::vector<std::string>& stack_;
+};
+
+// hash_bytes() of the file at `path`, read without registering it as a SourceFile.
+std::optional<std::uint64_t> hash_file(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return std::nullopt;
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (in.bad())
+        return std::nullopt;
+    return hash_bytes(text);
+}
+} // namespace
 
-ModuleLoader::ModuleLoader() {
+ModuleLoader::ModuleLoader() : ModuleLoader(std::filesystem::current_path()) {}
+
+ModuleLoader::ModuleLoader(const std::filesystem::path& working_directory) {
     // Default search paths
-    search_paths_.push_back(std::filesystem::current_path());
+    search_paths_.push_back(working_directory);
 }
 
 void ModuleLoader::add_search_path(const std::filesystem::path& path) {
@@ -20,10 +58,19 @@ void ModuleLoader::add_search_path(const std::filesystem::path& path) {
 }
 
 ast::Module* ModuleLoader::load(const std::string& path_or_name) {
+    // Imports name their module, and any other name or path a module was loaded by is an
+    // alias, so a repeated import is one lookup and no I/O.
+    if (const std::string* loaded = resolve_import(path_or_name)) {
+        ++stats_.cache_hits;
+        return &modules_.find(*loaded)->second;
+    }
+
     std::filesystem::path file_path;
     std::string module_name;
 
-    if (std::filesystem::exists(path_or_name)) {
+    if (path_or_name == "-") {
+        file_path = path_or_name;
+    } else if (std::error_code ec; std::filesystem::exists(path_or_name, ec)) {
         file_path = std::filesystem::absolute(path_or_name);
         // We'll determine the module name after parsing
     } else {
@@ -35,30 +82,33 @@ ast::Module* ModuleLoader::load(const std::string& path_or_name) {
         throw std::runtime_error("flux: could not find module: " + path_or_name);
     }
 
-    // Check if already loaded
-    // (We need to parse first to know the canonical name if we only have a path)
-
-    std::ifstream file(file_path);
-    if (!file) {
-        throw std::runtime_error("flux: could not open file: " + file_path.string());
+    // The same file reached through another name or path is not read again.
+    if (const std::string* loaded = loaded_from(canonical_path(file_path))) {
+        ++stats_.cache_hits;
+        aliases_.emplace(path_or_name, *loaded);
+        return &modules_[*loaded];
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-
-    Lexer lexer(buffer.str());
-    auto tokens = lexer.tokenize();
-    Parser parser(std::move(tokens));
-    ast::Module module = parser.parse_module();
+    // Mapped (or, for stdin and pipes, read) once and lexed in place, interleaved with
+    // parsing so the first error surfaces without tokenizing the rest of the file.
+    ParsedFile file = parse_file(file_path, path_or_name);
+    count_read(file);
+    if (file.error)
+        std::rethrow_exception(file.error);
 
     if (module_name.empty()) {
-        module_name = module.name;
+        module_name = file.module.name;
     }
 
     if (modules_.count(module_name)) {
+        ++stats_.cache_hits;
+        aliases_.emplace(path_or_name, module_name);
         return &modules_[module_name];
     }
 
+    if (jobs_ != 1)
+        return load_parallel(std::move(file), module_name);
+
     // Detect circular dependencies
     if (std::find(loading_stack_.begin(), loading_stack_.end(), module_name) !=
         loading_stack_.end()) {
@@ -66,25 +116,294 @@ ast::Module* ModuleLoader::load(const std::string& path_or_name) {
                                  module_name);
     }
 
-    loading_stack_.push_back(module_name);
+    {
+        StackEntry entry(loading_stack_, module_name);
 
-    // Recursively load imports
-    for (const auto& import_node : module.imports) {
-        load(import_node.module_path);
+        // Recursively load imports
+        for (const auto& import_node : file.module.imports) {
+            load(import_node.module_path);
+        }
+    }
+
+    return install(module_name, file);
+}
+
+ModuleLoader::ParsedFile ModuleLoader::parse_file(const std::filesystem::path& file_path,
+                                                  const std::string& module_name) const {
+    TraceSpan span("load", module_name);
+    ParsedFile file;
+    try {
+        if (file_path.empty()) {
+            throw std::runtime_error("flux: could not find module: " + module_name);
+        }
+        file.canonical_path = canonical_path(file_path);
+        std::error_code ec;
+        if (!file.canonical_path.empty())
+            file.modified = std::filesystem::last_write_time(file_path, ec);
+        file.source = SourceFile::open(file_path.string());
+        file.content_hash = hash_bytes(file.source->text());
+        if (cache_) {
+            if (auto entry = cache_->load(file.content_hash, *file.source)) {
+                file.module = std::move(entry->module);
+                file.summary = std::move(entry->summary);
+                file.references = std::move(entry->references);
+                file.from_cache = true;
+                return file;
+            }
+        }
+        Parser parser(std::make_unique<LexerTokenStream>(*file.source));
+        file.module = parser.parse_module();
+        file.tokens = parser.tokens_read();
+        file.summary = summarize(file.module);
+        file.references = flux::references(file.module);
+        // Only modules that parsed are cached, so errors are always reported from source.
+        if (cache_)
+            cache_->store(file.content_hash, file.module, file.summary, file.references,
+                          *file.source);
+    } catch (...) {
+        file.error = std::current_exception();
+    }
+    return file;
+}
+
+void ModuleLoader::count_read(const ParsedFile& file) {
+    if (!file.source)
+        return;
+    ++stats_.files_read;
+    if (file.from_cache)
+        ++stats_.disk_cache_hits;
+    else
+        stats_.bytes_lexed += file.source->text().size();
+    stats_.tokens_lexed += file.tokens;
+}
+
+// Symlinks and `..` resolved, so one file has one key. Standard input has none.
+std::string ModuleLoader::canonical_path(const std::filesystem::path& file_path) {
+    if (file_path == "-")
+        return {};
+    std::error_code ec;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(file_path, ec);
+    return ec ? file_path.lexically_normal().string() : canonical.string();
+}
+
+// The module already loaded from `canonical`, or nullptr.
+const std::string* ModuleLoader::loaded_from(const std::string& canonical) const {
+    if (canonical.empty())
+        return nullptr;
+    auto it = path_index_.find(canonical);
+    return it == path_index_.end() ? nullptr : &it->second;
+}
+
+// Parses every not-yet-loaded module reachable from `entry` on a thread pool. Each worker
+// schedules the imports of the file it just parsed, so the pool drains once the import
+// graph is exhausted. Nothing enters modules_ until then; commit() does that serially.
+ast::Module* ModuleLoader::load_parallel(ParsedFile entry, const std::string& module_name) {
+    std::map<std::string, ParsedFile> parsed; // keyed by module name, as imported
+    std::mutex mutex;                         // guards `parsed`, `scheduled` and stats_
+    std::set<std::string> scheduled;
+    ThreadPool pool(jobs_);
+
+    // Called with `mutex` held. Workers only read modules_, aliases_ and path_index_, which
+    // nothing writes until the pool has drained.
+    std::function<void(const ast::Module&)> schedule_imports = [&](const ast::Module& module) {
+        for (const auto& import_node : module.imports) {
+            std::string name = import_node.module_path;
+            if (resolve_import(name) || !scheduled.insert(name).second)
+                continue;
+            pool.submit([&, name] {
+                // Tasks must not throw; an error waits in `file` for commit() to rethrow.
+                ParsedFile file;
+                try {
+                    const std::filesystem::path path = find_module_file(name);
+                    if (const std::string* loaded = loaded_from(canonical_path(path)))
+                        file.loaded_as = *loaded;
+                    else
+                        file = parse_file(path, name);
+                } catch (...) {
+                    file.error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                count_read(file);
+                schedule_imports(file.module);
+                parsed[name] = std::move(file);
+            });
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        schedule_imports(entry.module);
+    }
+    pool.wait();
+
+    return commit(module_name, entry, parsed);
+}
+
+// Moves `file`, and depth-first the imports it pulled in, into modules_ with the same
+// checks, in the same order, as the serial path of load().
+ast::Module* ModuleLoader::commit(const std::string& module_name, ParsedFile& file,
+                                  std::map<std::string, ParsedFile>& parsed) {
+    if (file.error)
+        std::rethrow_exception(file.error);
+
+    if (modules_.count(module_name)) {
+        ++stats_.cache_hits;
+        return &modules_[module_name];
+    }
+
+    // Loaded earlier, or in this load under another import name.
+    const std::string* loaded =
+        file.loaded_as.empty() ? loaded_from(file.canonical_path) : &file.loaded_as;
+    if (loaded) {
+        ++stats_.cache_hits;
+        aliases_.emplace(module_name, *loaded);
+        return &modules_[*loaded];
     }
 
-    loading_stack_.pop_back();
+    if (std::find(loading_stack_.begin(), loading_stack_.end(), module_name) !=
+        loading_stack_.end()) {
+        throw std::runtime_error("flux: circular dependency detected involving module: " +
+                                 module_name);
+    }
 
-    modules_[module_name] = std::move(module);
+    {
+        StackEntry entry(loading_stack_, module_name);
+        for (const auto& import_node : file.module.imports) {
+            auto it = parsed.find(import_node.module_path);
+            if (it != parsed.end())
+                commit(it->first, it->second, parsed);
+            else
+                ++stats_.cache_hits; // loaded by an earlier load(), so never scheduled
+        }
+    }
+
+    return install(module_name, file);
+}
+
+ast::Module* ModuleLoader::install(const std::string& module_name, ParsedFile& file) {
+    if (!file.canonical_path.empty())
+        path_index_.emplace(file.canonical_path, module_name);
+    files_[module_name] = {std::move(file.source),         file.content_hash,
+                           std::move(file.summary),        std::move(file.references),
+                           std::move(file.canonical_path), file.modified};
+    modules_[module_name] = std::move(file.module);
     return &modules_[module_name];
 }
 
+ast::Module* ModuleLoader::reload(const std::string& path_or_name) {
+    std::vector<std::string> changed;
+    for (auto& [name, file] : files_) {
+        if (file_changed(file))
+            changed.push_back(name);
+    }
+    for (const std::string& name : changed)
+        drop(name);
+
+    ast::Module* entry = load(path_or_name);
+    std::string entry_name;
+    for (const auto& [name, module] : modules_) {
+        if (&module == entry)
+            entry_name = name;
+    }
+
+    // load() returns an unchanged module without visiting its imports, which may have been
+    // dropped above or may now form a cycle through a changed file.
+    std::map<std::string, bool> visiting; // module -> still on the walk's stack
+    walk_imports(entry_name, visiting);
+
+    std::vector<std::string> unreachable;
+    for (const auto& [name, module] : modules_) {
+        if (!visiting.count(name))
+            unreachable.push_back(name);
+    }
+    for (const std::string& name : unreachable)
+        drop(name);
+    return &modules_.at(entry_name);
+}
+
+// Whether the file behind `file` differs from what was parsed. The modification time is
+// checked first; the text is only read and hashed again when it moved.
+bool ModuleLoader::file_changed(LoadedFile& file) const {
+    if (file.canonical_path.empty())
+        return true; // standard input cannot be read twice
+    std::error_code ec;
+    const auto modified = std::filesystem::last_write_time(file.canonical_path, ec);
+    if (ec)
+        return true;
+    if (modified == file.modified)
+        return false;
+    // Not opened as a SourceFile, which would take a range of source locations.
+    if (hash_file(file.canonical_path) != file.content_hash)
+        return true;
+    file.modified = modified; // touched, but the same text
+    return false;
+}
+
+void ModuleLoader::drop(const std::string& module_name) {
+    auto it = files_.find(module_name);
+    if (it != files_.end()) {
+        path_index_.erase(it->second.canonical_path);
+        files_.erase(it);
+    }
+    modules_.erase(module_name);
+    std::erase_if(aliases_, [&](const auto& alias) { return alias.second == module_name; });
+}
+
+// Depth-first over the imports of `module_name`, loading any that are missing.
+void ModuleLoader::walk_imports(const std::string& module_name,
+                                std::map<std::string, bool>& visiting) {
+    auto [it, inserted] = visiting.emplace(module_name, true);
+    if (!inserted) {
+        if (it->second) {
+            throw std::runtime_error("flux: circular dependency detected involving module: " +
+                                     module_name);
+        }
+        return;
+    }
+    for (const auto& import_node : modules_.at(module_name).imports) {
+        load(import_node.module_path);
+        walk_imports(*resolve_import(import_node.module_path), visiting);
+    }
+    it->second = false;
+}
+
+const SourceFile* ModuleLoader::source(const std::string& module_name) const {
+    auto it = files_.find(module_name);
+    return it == files_.end() ? nullptr : it->second.source.get();
+}
+
+const std::string* ModuleLoader::resolve_import(const std::string& import_name) const {
+    if (auto it = modules_.find(import_name); it != modules_.end())
+        return &it->first;
+    auto it = aliases_.find(import_name);
+    return it == aliases_.end() ? nullptr : &it->second;
+}
+
+const ModuleSummary* ModuleLoader::summary(const std::string& module_name) const {
+    auto it = files_.find(module_name);
+    return it == files_.end() ? nullptr : &it->second.summary;
+}
+
+const std::vector<std::string>* ModuleLoader::references(const std::string& module_name) const {
+    auto it = files_.find(module_name);
+    return it == files_.end() ? nullptr : &it->second.references;
+}
+
+std::optional<std::uint64_t> ModuleLoader::content_hash(const std::string& module_name) const {
+    auto it = files_.find(module_name);
+    if (it == files_.end())
+        return std::nullopt;
+    return it->second.content_hash;
+}
+
 std::filesystem::path ModuleLoader::find_module_file(const std::string& module_name) {
     std::string relative_path = module_name_to_path(module_name);
 
     for (const auto& base : search_paths_) {
+        // A name the file system rejects (too long, say) is a module that is not there.
         auto p = base / relative_path;
-        if (std::filesystem::exists(p))
+        if (std::error_code ec; std::filesystem::exists(p, ec))
             return p;
     }
     return {};
@@ -2,36 +2,149 @@
 #define FLUX_MODULE_LOADER_H
 
 #include "ast/ast.h"
+#include "driver/module_summary.h"
+#include "lexer/source_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <filesystem>
 #include <map>
+#include <memory>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace flux {
 
+class ModuleCache;
+
+/// What a ModuleLoader has done so far, across all load() calls.
+struct LoaderStats {
+    std::size_t files_read = 0;      ///< source files opened
+    std::size_t bytes_lexed = 0;     ///< total size of those that were lexed and parsed
+    std::size_t tokens_lexed = 0;    ///< tokens the parser read from those files
+    std::size_t cache_hits = 0;      ///< loads answered by an already-loaded module, no I/O
+    std::size_t disk_cache_hits = 0; ///< files whose module was read from the ModuleCache
+};
+
 class ModuleLoader {
   public:
     ModuleLoader();
+    /// Searches `working_directory` first instead of the process's current directory.
+    explicit ModuleLoader(const std::filesystem::path& working_directory);
 
     /// Set search paths for modules (e.g., ["std/"])
     void add_search_path(const std::filesystem::path& path);
 
+    /// Parse with up to `jobs` threads; 0 means one per hardware thread. The default, 1,
+    /// parses on the calling thread. With more, load() parses the entry file and then hands
+    /// every newly discovered import to a thread pool. Parsed modules are committed in the
+    /// same depth-first order as a serial load, so errors, circular-dependency detection
+    /// and modules() do not depend on the job count.
+    void set_jobs(unsigned jobs) {
+        jobs_ = jobs;
+    }
+
+    /// Read modules from, and record newly parsed ones in, `cache` (which must outlive the
+    /// loader). A file whose text is in the cache is hashed but not lexed or parsed.
+    void set_cache(const ModuleCache* cache) {
+        cache_ = cache;
+    }
+
     /// Load a module and all its dependencies recursively.
-    /// @param path_or_name Either a file path or a module name (e.g., "std::io")
+    /// @param path_or_name Either a file path, "-" for stdin, or a module name (e.g., "std::io")
+    ///
+    /// A module already loaded under that name is returned before any file system access.
+    /// Otherwise the file is located and its canonical path is looked up, so a file reached
+    /// again by another name or relative path is not read twice.
     ast::Module* load(const std::string& path_or_name);
 
+    /// load() for a loader kept from one build to the next. Every loaded module whose file
+    /// has changed on disk since it was read is dropped first, so only those are parsed
+    /// again; the imports of `path_or_name` are then re-walked (with the same cycle check
+    /// as load()), and modules it no longer reaches are dropped. Afterwards modules() holds
+    /// exactly what a fresh loader's load() would.
+    ast::Module* reload(const std::string& path_or_name);
+
     /// Get all loaded modules
     const std::map<std::string, ast::Module>& modules() const {
         return modules_;
     }
 
+    /// The source text a loaded module was parsed from, or nullptr if not loaded.
+    /// Sources live as long as the loader, so diagnostics can quote them.
+    const SourceFile* source(const std::string& module_name) const;
+
+    /// hash_bytes() of the source text a loaded module was parsed from.
+    std::optional<std::uint64_t> content_hash(const std::string& module_name) const;
+
+    /// The key in modules() of the module an import of `import_name` loaded, which differs
+    /// from `import_name` when the file had already been loaded under another name.
+    /// nullptr if no such import has been loaded.
+    const std::string* resolve_import(const std::string& import_name) const;
+
+    /// The exported interface of a loaded module, or nullptr if not loaded.
+    const ModuleSummary* summary(const std::string& module_name) const;
+    /// The names a loaded module spells (flux::references()), or nullptr if not loaded.
+    const std::vector<std::string>* references(const std::string& module_name) const;
+
+    const LoaderStats& stats() const {
+        return stats_;
+    }
+
   private:
+    // A file parsed but not yet in modules_. Parallel loads keep the first error and
+    // rethrow it when the file is committed, where a serial load would have failed.
+    struct ParsedFile {
+        std::unique_ptr<SourceFile> source;
+        ast::Module module;
+        std::exception_ptr error;
+        std::string canonical_path; // empty for stdin
+        std::uint64_t content_hash = 0;
+        std::string loaded_as; // set instead of parsing when the file was already loaded
+        ModuleSummary summary;
+        std::vector<std::string> references;
+        bool from_cache = false; // read back from cache_ rather than parsed
+        std::size_t tokens = 0;  // read by the parser
+        std::filesystem::file_time_type modified{};
+    };
+
+    // Everything kept per loaded module besides its AST.
+    struct LoadedFile {
+        std::unique_ptr<SourceFile> source;
+        std::uint64_t content_hash = 0;
+        ModuleSummary summary;
+        std::vector<std::string> references;
+        std::string canonical_path;
+        std::filesystem::file_time_type modified{}; // when read; reload() compares it
+    };
+
+    ParsedFile parse_file(const std::filesystem::path& file_path,
+                          const std::string& module_name) const;
+    void count_read(const ParsedFile& file);
+    static std::string canonical_path(const std::filesystem::path& file_path);
+    const std::string* loaded_from(const std::string& canonical) const;
+    ast::Module* load_parallel(ParsedFile entry, const std::string& module_name);
+    ast::Module* commit(const std::string& module_name, ParsedFile& file,
+                        std::map<std::string, ParsedFile>& parsed);
+    ast::Module* install(const std::string& module_name, ParsedFile& file);
+    bool file_changed(LoadedFile& file) const;
+    void drop(const std::string& module_name);
+    void walk_imports(const std::string& module_name, std::map<std::string, bool>& visiting);
+
     std::filesystem::path find_module_file(const std::string& module_name);
     std::string module_name_to_path(const std::string& module_name);
 
     std::vector<std::filesystem::path> search_paths_;
     std::map<std::string, ast::Module> modules_;
+    std::map<std::string, LoadedFile> files_; // one source owner per module
+    std::unordered_map<std::string, std::string> path_index_; // canonical path -> module name
+    std::unordered_map<std::string, std::string> aliases_;    // other import name or path -> module
     std::vector<std::string> loading_stack_; // For circular dependency detection
+    LoaderStats stats_;
+    unsigned jobs_ = 1;
+    const ModuleCache* cache_ = nullptr;
 };
 
 } // namespace flux
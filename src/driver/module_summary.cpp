@@ -0,0 +1,299 @@
+#include "driver/module_summary.h"
+#include "ast/ast_serializer.h"
+#include "support/hash.h"
+
+#include <algorithm>
+#include <optional>
+
+namespace flux {
+namespace {
+const char* visibility_prefix(ast::Visibility visibility) {
+    switch (visibility) {
+    case ast::Visibility::Public:
+        return "pub ";
+    case ast::Visibility::Private:
+        return "priv ";
+    case ast::Visibility::None:
+        break;
+    }
+    return "";
+}
+
+void type_params(std::string& out, const std::vector<std::string>& params) {
+    if (params.empty())
+        return;
+    out += '<';
+    for (std::size_t i = 0; i < params.size(); ++i) {
+        if (i)
+            out += ", ";
+        out += params[i];
+    }
+    out += '>';
+}
+
+void where_clause(std::string& out, const ast::WhereClause& where) {
+    for (std::size_t i = 0; i < where.size(); ++i) {
+        out += i ? ", " : " where ";
+        out += where[i].param.str();
+        out += ':';
+        for (std::size_t j = 0; j < where[i].bounds.size(); ++j) {
+            out += j ? " + " : " ";
+            out += ast::spelling(where[i].bounds[j]);
+        }
+    }
+}
+
+std::string signature(const ast::FunctionDecl& fn) {
+    std::string out = visibility_prefix(fn.visibility);
+    if (fn.is_external)
+        out += "extern ";
+    if (fn.is_async)
+        out += "async ";
+    out += "func ";
+    out += fn.name.str();
+    type_params(out, fn.type_params);
+    out += '(';
+    for (std::size_t i = 0; i < fn.params.size(); ++i) {
+        if (i)
+            out += ", ";
+        out += fn.params[i].name.str();
+        out += ": ";
+        out += ast::spelling(fn.params[i].type);
+    }
+    out += ") -> ";
+    out += fn.return_type ? ast::spelling(fn.return_type) : "Void";
+    where_clause(out, fn.where_clause);
+    return out;
+}
+
+void fields(std::string& out, const std::vector<ast::Field>& fields) {
+    out += " {";
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        out += i ? ", " : " ";
+        out += visibility_prefix(fields[i].visibility);
+        out += fields[i].name.str();
+        out += ": ";
+        out += ast::spelling(fields[i].type);
+    }
+    out += " }";
+}
+
+void members(std::string& out, const std::vector<ast::AssociatedType>& types,
+             const std::vector<ast::FunctionDecl>& methods) {
+    out += " {";
+    for (const ast::AssociatedType& assoc : types) {
+        out += " type ";
+        out += assoc.name.str();
+        if (assoc.default_type) {
+            out += " = ";
+            out += ast::spelling(assoc.default_type);
+        }
+        out += ';';
+    }
+    for (const ast::FunctionDecl& method : methods) {
+        out += ' ';
+        out += signature(method);
+        out += ';';
+    }
+    out += " }";
+}
+
+std::string join(std::vector<std::string> names) {
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    std::string out;
+    for (const std::string& name : names) {
+        if (!out.empty())
+            out += ' ';
+        out += name;
+    }
+    return out;
+}
+
+// The bodies that modules other than their own compile, as one hash, or nullopt if there
+// are none. Their names go to `names`.
+std::optional<std::uint64_t> body_hash(const std::vector<const ast::FunctionDecl*>& bodies,
+                                       std::vector<std::string>& names) {
+    if (bodies.empty())
+        return std::nullopt;
+    std::string text;
+    for (const ast::FunctionDecl* fn : bodies) {
+        text += ast::serialize(*fn);
+        for (const std::string& name : ast::spelled_names(*fn)) {
+            for (std::string& part : identifiers(name))
+                names.push_back(std::move(part));
+        }
+    }
+    return hash_bytes(text);
+}
+
+// Adds `line`, reached by `keys`, with the bodies compiled by the modules that use it.
+void add(ModuleSummary& summary, std::string line, std::vector<std::string> keys,
+         const std::vector<const ast::FunctionDecl*>& bodies = {}) {
+    std::vector<std::string> mentions;
+    if (std::optional<std::uint64_t> hash = body_hash(bodies, mentions))
+        line += " #" + std::to_string(*hash);
+    for (std::string& name : identifiers(line))
+        mentions.push_back(std::move(name));
+    summary.declarations.push_back(std::move(line));
+    summary.keys.push_back(join(std::move(keys)));
+    summary.mentions.push_back(join(std::move(mentions)));
+}
+
+// The base name of an impl's target, `Box` for `Box<T>`.
+std::string base_name(const std::string& type_name) {
+    return type_name.substr(0, type_name.find('<'));
+}
+} // namespace
+
+ModuleSummary summarize(const ast::Module& module) {
+    ModuleSummary summary;
+    auto exported = [](ast::Visibility visibility) {
+        return visibility == ast::Visibility::Public;
+    };
+
+    for (const auto& fn : module.functions) {
+        if (!fn.type_params.empty())
+            add(summary, signature(fn), {fn.name.str()}, {&fn});
+        else if (exported(fn.visibility))
+            add(summary, signature(fn), {fn.name.str()});
+    }
+
+    for (const auto& s : module.structs) {
+        if (!exported(s.visibility))
+            continue;
+        std::string line = "pub struct " + s.name.str();
+        type_params(line, s.type_params);
+        where_clause(line, s.where_clause);
+        fields(line, s.fields);
+        add(summary, std::move(line), {s.name.str()});
+    }
+
+    for (const auto& c : module.classes) {
+        if (!exported(c.visibility))
+            continue;
+        std::string line = "pub class " + c.name.str();
+        type_params(line, c.type_params);
+        where_clause(line, c.where_clause);
+        fields(line, c.fields);
+        add(summary, std::move(line), {c.name.str()});
+    }
+
+    for (const auto& e : module.enums) {
+        if (!exported(e.visibility))
+            continue;
+        std::string line = "pub enum " + e.name.str();
+        type_params(line, e.type_params);
+        where_clause(line, e.where_clause);
+        line += " {";
+        for (std::size_t i = 0; i < e.variants.size(); ++i) {
+            line += i ? ", " : " ";
+            line += e.variants[i].name.str();
+            if (e.variants[i].types.empty())
+                continue;
+            line += '(';
+            for (std::size_t j = 0; j < e.variants[i].types.size(); ++j) {
+                if (j)
+                    line += ", ";
+                line += ast::spelling(e.variants[i].types[j]);
+            }
+            line += ')';
+        }
+        line += " }";
+        std::vector<std::string> keys{e.name.str()};
+        for (const auto& variant : e.variants)
+            keys.push_back(variant.name.str());
+        add(summary, std::move(line), std::move(keys));
+    }
+
+    for (const auto& t : module.traits) {
+        if (!exported(t.visibility))
+            continue;
+        std::string line = "pub trait " + t.name.str();
+        type_params(line, t.type_params);
+        where_clause(line, t.where_clause);
+        members(line, t.associated_types, t.methods);
+        std::vector<std::string> keys{t.name.str()};
+        std::vector<const ast::FunctionDecl*> defaults;
+        for (const auto& method : t.methods) {
+            keys.push_back(method.name.str());
+            if (method.has_body)
+                defaults.push_back(&method);
+        }
+        add(summary, std::move(line), std::move(keys), defaults);
+    }
+
+    for (const auto& alias : module.type_aliases) {
+        if (exported(alias.visibility))
+            add(summary, "pub type " + alias.name.str() + " = " + ast::spelling(alias.target_type),
+                {alias.name.str()});
+    }
+
+    // Impls have no visibility of their own: their methods are reachable wherever the
+    // target type is.
+    for (const auto& impl : module.impls) {
+        std::string line = "impl";
+        type_params(line, impl.type_params);
+        line += ' ';
+        if (!impl.trait_name.empty())
+            line += impl.trait_name + " for ";
+        line += impl.target_name;
+        where_clause(line, impl.where_clause);
+        members(line, impl.associated_types, impl.methods);
+        std::vector<std::string> keys{base_name(impl.target_name)};
+        if (!impl.trait_name.empty())
+            keys.push_back(base_name(impl.trait_name));
+        std::vector<const ast::FunctionDecl*> generic;
+        for (const auto& method : impl.methods) {
+            keys.push_back(method.name.str());
+            if (!impl.type_params.empty() || !method.type_params.empty())
+                generic.push_back(&method);
+        }
+        add(summary, std::move(line), std::move(keys), generic);
+    }
+
+    summary.interface_hash = interface_hash(summary.declarations);
+    return summary;
+}
+
+std::vector<std::string> references(const ast::Module& module) {
+    std::vector<std::string> names;
+    for (const std::string& name : ast::spelled_names(module)) {
+        for (std::string& part : identifiers(name))
+            names.push_back(std::move(part));
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    return names;
+}
+
+std::vector<std::string> identifiers(std::string_view text) {
+    auto word = [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '_';
+    };
+    std::vector<std::string> names;
+    for (std::size_t i = 0; i < text.size();) {
+        if (!word(text[i])) {
+            ++i;
+            continue;
+        }
+        const std::size_t start = i;
+        while (i < text.size() && word(text[i]))
+            ++i;
+        if (text[start] < '0' || text[start] > '9')
+            names.emplace_back(text.substr(start, i - start));
+    }
+    return names;
+}
+
+std::uint64_t interface_hash(const std::vector<std::string>& declarations) {
+    std::string text;
+    for (const std::string& line : declarations) {
+        text += line;
+        text += '\n';
+    }
+    return hash_bytes(text);
+}
+
+} // namespace flux
@@ -0,0 +1,55 @@
+#ifndef FLUX_MODULE_SUMMARY_H
+#define FLUX_MODULE_SUMMARY_H
+
+#include "ast/ast.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace flux {
+
+/// What other modules can see of a module: one canonical line per declaration that the
+/// Resolver's declare_module() makes visible outside it. That is every public function,
+/// struct, class, enum, trait and type alias (structs with all their fields, since the
+/// layout is part of the interface) and every impl block. Bodies, private declarations
+/// and source positions are left out, so editing them leaves the summary unchanged.
+///
+/// The exception is code that other modules compile: a module that calls a generic
+/// function compiles its specializations. So every generic function, public or not, has
+/// a line, and that line, like those of impls with generic methods and traits with default
+/// methods, ends in a hash of those bodies.
+///
+/// Each line also lists the names that reach it and the names it mentions, so that a
+/// module's use of another can be narrowed to the lines it uses (see DependencyGraph).
+struct ModuleSummary {
+    std::vector<std::string> declarations;
+    /// Per declaration, space-separated: the names by which other code reaches it. A
+    /// function's name; a type's, and an enum's variants; a trait's and its methods'; an
+    /// impl's type, trait and methods.
+    std::vector<std::string> keys;
+    /// Per declaration, space-separated: the names its line spells, and those of any body
+    /// hashed into it. Whatever uses the declaration may use what they name too.
+    std::vector<std::string> mentions;
+    std::uint64_t interface_hash = 0; ///< hash_bytes() of the declarations, in order
+
+    bool operator==(const ModuleSummary&) const = default;
+};
+
+ModuleSummary summarize(const ast::Module& module);
+
+/// Every name `module` spells, split at `::`, sorted and without repeats. Whatever the
+/// module uses of another module, it reaches through one of these.
+std::vector<std::string> references(const ast::Module& module);
+
+/// The names spelled in `text`: its runs of letters, digits and underscores that do not
+/// start with a digit, in order.
+std::vector<std::string> identifiers(std::string_view text);
+
+/// Rebuilds interface_hash from declarations.
+std::uint64_t interface_hash(const std::vector<std::string>& declarations);
+
+} // namespace flux
+
+#endif // FLUX_MODULE_SUMMARY_H
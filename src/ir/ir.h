@@ -1,6 +1,8 @@
 #ifndef FLUX_IR_H
 #define FLUX_IR_H
 
+#include "lexer/interner.h"
+#include "lexer/source_location.h"
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -305,8 +307,8 @@ struct Instruction {
     BasicBlock* false_block = nullptr;
     std::vector<std::pair<ValuePtr, BasicBlock*>> switch_cases; // for Switch
 
-    // For Call
-    std::string callee_name;
+    // For Call (and StructInit, where it names the struct)
+    Name callee_name;
 
     // For GetField / InsertValue / ExtractValue
     uint32_t field_index = 0;
@@ -315,8 +317,7 @@ struct Instruction {
     std::vector<std::pair<ValuePtr, BasicBlock*>> phi_incoming;
 
     // Source location for debugging
-    uint32_t line = 0;
-    uint32_t column = 0;
+    SourceLoc loc;
 };
 
 using InstructionPtr = std::unique_ptr<Instruction>;
@@ -349,7 +350,7 @@ using BasicBlockPtr = std::unique_ptr<BasicBlock>;
 // ============================================================
 
 struct IRFunction {
-    std::string name;
+    Name name;
     std::vector<ValuePtr> params;
     std::shared_ptr<IRType> return_type;
     std::vector<BasicBlockPtr> blocks;
@@ -357,10 +358,12 @@ struct IRFunction {
 
     bool is_async = false;
     bool is_external = false;
+    // Local to the object file it is compiled into (internal linkage), so that several
+    // objects of one program can each hold a copy.
+    bool is_internal = false;
 
     // Source location
-    uint32_t line = 0;
-    uint32_t column = 0;
+    SourceLoc loc;
 
     BasicBlock* create_block(const std::string& label) {
         auto bb = std::make_unique<BasicBlock>();
@@ -395,6 +398,14 @@ struct IRModule {
     std::vector<StructLayout> struct_layouts;
     std::unordered_map<std::string, ValuePtr> global_constants;
 
+    std::size_t instruction_count() const {
+        std::size_t count = 0;
+        for (const auto& fn : functions)
+            for (const auto& block : fn->blocks)
+                count += block->instructions.size();
+        return count;
+    }
+
     IRFunction* find_function(const std::string& fname) const {
         for (auto& fn : functions) {
             if (fn->name == fname)
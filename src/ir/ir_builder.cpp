@@ -60,17 +60,15 @@ ValuePtr IRBuilder::create_value(std::shared_ptr<IRType> type, const std::string
 
 // ── Source location ─────────────────────────────────────────
 
-void IRBuilder::set_source_location(uint32_t line, uint32_t column) {
-    current_line_ = line;
-    current_column_ = column;
+void IRBuilder::set_source_location(SourceLoc loc) {
+    current_loc_ = loc;
 }
 
 // ── Helpers ─────────────────────────────────────────────────
 
 void IRBuilder::insert(InstructionPtr inst) {
     assert(insert_point_ && "No insertion point set");
-    inst->line = current_line_;
-    inst->column = current_column_;
+    inst->loc = current_loc_;
     insert_point_->instructions.push_back(std::move(inst));
 }
 
@@ -111,7 +111,7 @@ class IRBuilder {
                               std::shared_ptr<IRType> struct_type);
 
     // ── Source location ─────────────────────────────────────
-    void set_source_location(uint32_t line, uint32_t column);
+    void set_source_location(SourceLoc loc);
 
   private:
     // Helper to emit a binary instruction
@@ -128,8 +128,7 @@ class IRBuilder {
     IRFunction* current_function_ = nullptr;
     BasicBlock* insert_point_ = nullptr;
     ValueID next_value_id_ = 0;
-    uint32_t current_line_ = 0;
-    uint32_t current_column_ = 0;
+    SourceLoc current_loc_;
 };
 
 } // namespace flux::ir
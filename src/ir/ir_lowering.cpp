@@ -2,6 +2,7 @@
 
 #include "ast/ast.h"
 #include "lexer/token.h"
+#include "support/trace.h"
 
 #include <cassert>
 #include <stdexcept>
@@ -71,8 +72,25 @@ std::shared_ptr<IRType> IRLowering::lower_type(const std::string& type_name) {
     return t;
 }
 
-std::shared_ptr<IRType> IRLowering::lower_flux_type(const semantic::FluxType& type) {
-    return lower_type(type.name);
+std::shared_ptr<IRType> IRLowering::lower_type(const ast::TypeExpr* type) {
+    if (!type)
+        return make_void();
+
+    if (const auto* ref = ast::dyn_cast<ast::RefType>(type))
+        return make_ptr(lower_type(ref->pointee));
+    if (const auto* path = ast::dyn_cast<ast::PathType>(type);
+        path && path->generic_args.empty())
+        return lower_type(path->name.str());
+
+    // Generic instances, arrays, tuples and function types are named aggregates.
+    auto t = std::make_shared<IRType>();
+    t->kind = IRTypeKind::Struct;
+    t->name = ast::spelling(type);
+    return t;
+}
+
+std::shared_ptr<IRType> IRLowering::lower_flux_type(semantic::TypeId type) {
+    return lower_type(type->name);
 }
 
 // ── Scope management ────────────────────────────────────────
@@ -132,12 +150,48 @@ IRModule IRLowering::lower(const ast::Module& module) {
     return std::move(builder_.module());
 }
 
+IRModule IRLowering::lower_unit(
+    const std::string& name, const std::vector<const ast::FunctionDecl*>& functions,
+    const std::unordered_map<std::string, const ast::FunctionDecl*>& program,
+    const std::unordered_set<std::string>& shared) {
+    IRModule& ir_module = builder_.module();
+    ir_module.name = name;
+
+    std::unordered_set<std::string> seen;
+    for (const ast::FunctionDecl* fn : functions) {
+        seen.insert(fn->name.str());
+        lower_function(*fn);
+    }
+
+    // What the unit calls of the other functions is lowered into it if shared, and declared
+    // otherwise. Everything lowered besides its own functions (lambdas too) is internal.
+    for (std::size_t next = 0; next < ir_module.functions.size(); ++next) {
+        IRFunction& function = *ir_module.functions[next];
+        if (next >= functions.size() && !function.blocks.empty())
+            function.is_internal = true;
+        for (const auto& block : function.blocks) {
+            for (const auto& inst : block->instructions) {
+                if (inst->opcode != Opcode::Call || !seen.insert(inst->callee_name.str()).second)
+                    continue;
+                auto callee = program.find(inst->callee_name.str());
+                if (callee == program.end())
+                    continue;
+                if (shared.contains(callee->first))
+                    lower_function(*callee->second);
+                else
+                    declare_function(*callee->second);
+            }
+        }
+    }
+
+    return std::move(ir_module);
+}
+
 // ============================================================
 //  Function lowering
 // ============================================================
 
-void IRLowering::lower_function(const ast::FunctionDecl& fn) {
-    // Build parameter values
+std::vector<ValuePtr> IRLowering::lower_params(const ast::FunctionDecl& fn) {
     std::vector<ValuePtr> params;
     for (const auto& p : fn.params) {
         auto param_val = std::make_shared<Value>();
@@ -146,13 +200,28 @@ void IRLowering::lower_function(const ast::FunctionDecl& fn) {
         param_val->name = "%" + p.name;
         params.push_back(param_val);
     }
+    return params;
+}
+
+void IRLowering::declare_function(const ast::FunctionDecl& fn) {
+    // Created as external, which gives it no entry block; whether it is comes after.
+    auto* ir_fn =
+        builder_.create_function(fn.name, lower_params(fn), lower_type(fn.return_type), true);
+    ir_fn->is_async = fn.is_async;
+    ir_fn->is_external = fn.is_external;
+    ir_fn->loc = fn.loc;
+}
+
+void IRLowering::lower_function(const ast::FunctionDecl& fn) {
+    TraceSpan span("lower", fn.name.str());
+    // Build parameter values
+    std::vector<ValuePtr> params = lower_params(fn);
 
     auto ret_type = lower_type(fn.return_type);
     auto* ir_fn = builder_.create_function(fn.name, std::move(params), ret_type, fn.is_external);
     ir_fn->is_async = fn.is_async;
     ir_fn->is_external = fn.is_external;
-    ir_fn->line = fn.line;
-    ir_fn->column = fn.column;
+    ir_fn->loc = fn.loc;
 
     if (fn.is_external) {
         return;
@@ -204,34 +273,45 @@ void IRLowering::lower_block(const ast::Block& block) {
 // ============================================================
 
 void IRLowering::lower_statement(const ast::Stmt& stmt) {
-    builder_.set_source_location(stmt.line, stmt.column);
-
-    if (auto* let_s = dynamic_cast<const ast::LetStmt*>(&stmt)) {
-        lower_let_stmt(*let_s);
-    } else if (auto* ret_s = dynamic_cast<const ast::ReturnStmt*>(&stmt)) {
-        lower_return_stmt(*ret_s);
-    } else if (auto* assign_s = dynamic_cast<const ast::AssignStmt*>(&stmt)) {
-        lower_assign_stmt(*assign_s);
-    } else if (auto* if_s = dynamic_cast<const ast::IfStmt*>(&stmt)) {
-        lower_if_stmt(*if_s);
-    } else if (auto* while_s = dynamic_cast<const ast::WhileStmt*>(&stmt)) {
-        lower_while_stmt(*while_s);
-    } else if (auto* for_s = dynamic_cast<const ast::ForStmt*>(&stmt)) {
-        lower_for_stmt(*for_s);
-    } else if (auto* loop_s = dynamic_cast<const ast::LoopStmt*>(&stmt)) {
-        lower_loop_stmt(*loop_s);
-    } else if (auto* match_s = dynamic_cast<const ast::MatchStmt*>(&stmt)) {
-        lower_match_stmt(*match_s);
-    } else if (auto* break_s = dynamic_cast<const ast::BreakStmt*>(&stmt)) {
-        (void)break_s;
+    builder_.set_source_location(stmt.loc);
+
+    switch (stmt.kind) {
+    case ast::StmtKind::Let:
+        lower_let_stmt(*ast::cast<ast::LetStmt>(&stmt));
+        break;
+    case ast::StmtKind::Return:
+        lower_return_stmt(*ast::cast<ast::ReturnStmt>(&stmt));
+        break;
+    case ast::StmtKind::Assign:
+        lower_assign_stmt(*ast::cast<ast::AssignStmt>(&stmt));
+        break;
+    case ast::StmtKind::If:
+        lower_if_stmt(*ast::cast<ast::IfStmt>(&stmt));
+        break;
+    case ast::StmtKind::While:
+        lower_while_stmt(*ast::cast<ast::WhileStmt>(&stmt));
+        break;
+    case ast::StmtKind::For:
+        lower_for_stmt(*ast::cast<ast::ForStmt>(&stmt));
+        break;
+    case ast::StmtKind::Loop:
+        lower_loop_stmt(*ast::cast<ast::LoopStmt>(&stmt));
+        break;
+    case ast::StmtKind::Match:
+        lower_match_stmt(*ast::cast<ast::MatchStmt>(&stmt));
+        break;
+    case ast::StmtKind::Break:
         lower_break_stmt();
-    } else if (auto* cont_s = dynamic_cast<const ast::ContinueStmt*>(&stmt)) {
-        (void)cont_s;
+        break;
+    case ast::StmtKind::Continue:
         lower_continue_stmt();
-    } else if (auto* expr_s = dynamic_cast<const ast::ExprStmt*>(&stmt)) {
-        lower_expr_stmt(*expr_s);
-    } else if (auto* block_s = dynamic_cast<const ast::BlockStmt*>(&stmt)) {
-        lower_block_stmt(*block_s);
+        break;
+    case ast::StmtKind::Expr:
+        lower_expr_stmt(*ast::cast<ast::ExprStmt>(&stmt));
+        break;
+    case ast::StmtKind::Block:
+        lower_block_stmt(*ast::cast<ast::BlockStmt>(&stmt));
+        break;
     }
     // Other statement types (struct decl, trait decl, etc.) are type-system-only
     // and don't generate IR instructions.
@@ -242,7 +322,7 @@ void IRLowering::lower_statement(const ast::Stmt& stmt) {
 // ============================================================
 
 void IRLowering::lower_let_stmt(const ast::LetStmt& stmt) {
-    auto var_type = lower_type(stmt.type_name);
+    auto var_type = lower_type(stmt.type);
 
     if (!stmt.tuple_names.empty()) {
         // Tuple destructuring
@@ -271,7 +351,7 @@ void IRLowering::lower_assign_stmt(const ast::AssignStmt& stmt) {
     auto rhs = lower_expression(*stmt.value);
 
     // Get the address of the target
-    if (auto* ident = dynamic_cast<const ast::IdentifierExpr*>(stmt.target.get())) {
+    if (auto* ident = ast::dyn_cast<ast::IdentifierExpr>(stmt.target)) {
         auto ptr = lookup_variable(ident->name);
         if (!ptr)
             return; // unresolved, skip
@@ -390,7 +470,7 @@ void IRLowering::lower_for_stmt(const ast::ForStmt& stmt) {
     auto* exit_bb = builder_.create_block(unique_label("for.exit"));
 
     // Allocate loop variable
-    auto var_type = stmt.var_type.empty() ? make_i32() : lower_type(stmt.var_type);
+    auto var_type = stmt.var_type ? lower_type(stmt.var_type) : make_i32();
     auto alloca = builder_.emit_alloca(var_type, stmt.variable);
     declare_variable(stmt.variable, alloca);
 
@@ -455,9 +535,9 @@ void IRLowering::lower_match_stmt(const ast::MatchStmt& stmt) {
                             : merge_bb;
 
         // Check if pattern matches (simplified: wildcard always matches)
-        if (dynamic_cast<const ast::WildcardPattern*>(arm.pattern.get())) {
+        if (ast::isa<ast::WildcardPattern>(arm.pattern)) {
             builder_.emit_br(arm_bb);
-        } else if (auto* lit_pat = dynamic_cast<const ast::LiteralPattern*>(arm.pattern.get())) {
+        } else if (auto* lit_pat = ast::dyn_cast<ast::LiteralPattern>(arm.pattern)) {
             auto pat_val = lower_expression(*lit_pat->literal);
             auto cmp = builder_.emit_eq(subject, pat_val);
             if (arm.guard) {
@@ -471,8 +551,7 @@ void IRLowering::lower_match_stmt(const ast::MatchStmt& stmt) {
             } else {
                 builder_.emit_cond_br(cmp, arm_bb, next_bb);
             }
-        } else if (auto* ident_pat =
-                       dynamic_cast<const ast::IdentifierPattern*>(arm.pattern.get())) {
+        } else if (auto* ident_pat = ast::dyn_cast<ast::IdentifierPattern>(arm.pattern)) {
             // Bind subject to name and always match
             auto alloca = builder_.emit_alloca(subject->type, ident_pat->name);
             builder_.emit_store(subject, alloca);
@@ -526,38 +605,42 @@ void IRLowering::lower_block_stmt(const ast::BlockStmt& stmt) {
 // ============================================================
 
 ValuePtr IRLowering::lower_expression(const ast::Expr& expr) {
-    builder_.set_source_location(expr.line, expr.column);
-
-    if (auto* num = dynamic_cast<const ast::NumberExpr*>(&expr))
-        return lower_number_expr(*num);
-    if (auto* str = dynamic_cast<const ast::StringExpr*>(&expr))
-        return lower_string_expr(*str);
-    if (auto* bl = dynamic_cast<const ast::BoolExpr*>(&expr))
-        return lower_bool_expr(*bl);
-    if (auto* ch = dynamic_cast<const ast::CharExpr*>(&expr))
-        return lower_char_expr(*ch);
-    if (auto* id = dynamic_cast<const ast::IdentifierExpr*>(&expr))
-        return lower_identifier_expr(*id);
-    if (auto* bin = dynamic_cast<const ast::BinaryExpr*>(&expr))
-        return lower_binary_expr(*bin);
-    if (auto* un = dynamic_cast<const ast::UnaryExpr*>(&expr))
-        return lower_unary_expr(*un);
-    if (auto* call = dynamic_cast<const ast::CallExpr*>(&expr))
-        return lower_call_expr(*call);
-    if (auto* mem = dynamic_cast<const ast::MemberAccessExpr*>(&expr))
-        return lower_member_access_expr(*mem);
-    if (auto* idx = dynamic_cast<const ast::IndexExpr*>(&expr))
-        return lower_index_expr(*idx);
-    if (auto* cast = dynamic_cast<const ast::CastExpr*>(&expr))
-        return lower_cast_expr(*cast);
-    if (auto* sl = dynamic_cast<const ast::StructLiteralExpr*>(&expr))
-        return lower_struct_literal_expr(*sl);
-    if (auto* tup = dynamic_cast<const ast::TupleExpr*>(&expr))
-        return lower_tuple_expr(*tup);
-    if (auto* arr = dynamic_cast<const ast::ArrayExpr*>(&expr))
-        return lower_array_expr(*arr);
-    if (auto* lam = dynamic_cast<const ast::LambdaExpr*>(&expr))
-        return lower_lambda_expr(*lam);
+    builder_.set_source_location(expr.loc);
+
+    switch (expr.kind) {
+    case ast::ExprKind::Number:
+        return lower_number_expr(*ast::cast<ast::NumberExpr>(&expr));
+    case ast::ExprKind::String:
+        return lower_string_expr(*ast::cast<ast::StringExpr>(&expr));
+    case ast::ExprKind::Bool:
+        return lower_bool_expr(*ast::cast<ast::BoolExpr>(&expr));
+    case ast::ExprKind::Char:
+        return lower_char_expr(*ast::cast<ast::CharExpr>(&expr));
+    case ast::ExprKind::Identifier:
+        return lower_identifier_expr(*ast::cast<ast::IdentifierExpr>(&expr));
+    case ast::ExprKind::Binary:
+        return lower_binary_expr(*ast::cast<ast::BinaryExpr>(&expr));
+    case ast::ExprKind::Unary:
+        return lower_unary_expr(*ast::cast<ast::UnaryExpr>(&expr));
+    case ast::ExprKind::Call:
+        return lower_call_expr(*ast::cast<ast::CallExpr>(&expr));
+    case ast::ExprKind::MemberAccess:
+        return lower_member_access_expr(*ast::cast<ast::MemberAccessExpr>(&expr));
+    case ast::ExprKind::Index:
+        return lower_index_expr(*ast::cast<ast::IndexExpr>(&expr));
+    case ast::ExprKind::Cast:
+        return lower_cast_expr(*ast::cast<ast::CastExpr>(&expr));
+    case ast::ExprKind::StructLiteral:
+        return lower_struct_literal_expr(*ast::cast<ast::StructLiteralExpr>(&expr));
+    case ast::ExprKind::Tuple:
+        return lower_tuple_expr(*ast::cast<ast::TupleExpr>(&expr));
+    case ast::ExprKind::Array:
+        return lower_array_expr(*ast::cast<ast::ArrayExpr>(&expr));
+    case ast::ExprKind::Lambda:
+        return lower_lambda_expr(*ast::cast<ast::LambdaExpr>(&expr));
+    default:
+        break;
+    }
 
     // Fallback: return a void/unknown value
     return builder_.create_value(make_void(), "unknown");
@@ -668,22 +751,22 @@ ValuePtr IRLowering::lower_unary_expr(const ast::UnaryExpr& expr) {
 ValuePtr IRLowering::lower_call_expr(const ast::CallExpr& expr) {
     // Get callee name
     std::string callee_name = "unknown";
-    if (auto* id = dynamic_cast<const ast::IdentifierExpr*>(expr.callee.get())) {
+    if (auto* id = ast::dyn_cast<ast::IdentifierExpr>(expr.callee)) {
         callee_name = id->name;
-    } else if (auto* bin = dynamic_cast<const ast::BinaryExpr*>(expr.callee.get())) {
+    } else if (auto* bin = ast::dyn_cast<ast::BinaryExpr>(expr.callee)) {
         if (bin->op == TokenKind::ColonColon) {
             // Traverse the BinaryExpr chain to get the full name
             std::vector<std::string> parts;
-            const ast::Expr* current = expr.callee.get();
-            while (auto* b = dynamic_cast<const ast::BinaryExpr*>(current)) {
+            const ast::Expr* current = expr.callee;
+            while (auto* b = ast::dyn_cast<ast::BinaryExpr>(current)) {
                 if (b->op != TokenKind::ColonColon)
                     break;
-                if (auto* rhs_id = dynamic_cast<const ast::IdentifierExpr*>(b->right.get())) {
+                if (auto* rhs_id = ast::dyn_cast<ast::IdentifierExpr>(b->right)) {
                     parts.insert(parts.begin(), rhs_id->name);
                 }
-                current = b->left.get();
+                current = b->left;
             }
-            if (auto* root_id = dynamic_cast<const ast::IdentifierExpr*>(current)) {
+            if (auto* root_id = ast::dyn_cast<ast::IdentifierExpr>(current)) {
                 parts.insert(parts.begin(), root_id->name);
             }
 
@@ -8,6 +8,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace flux::ir {
 
@@ -19,9 +20,20 @@ class IRLowering {
     /// Lower an entire module (main entry point).
     IRModule lower(const ast::Module& module);
 
+    /// Lower `functions` into a module named `name` of their own, which is compiled apart
+    /// from the rest of the program. Each function of `program` (by name) they call that is
+    /// in `shared` is lowered into it as well, as internal, directly called or not; any
+    /// other is only declared, without blocks.
+    IRModule lower_unit(const std::string& name,
+                        const std::vector<const ast::FunctionDecl*>& functions,
+                        const std::unordered_map<std::string, const ast::FunctionDecl*>& program,
+                        const std::unordered_set<std::string>& shared);
+
   private:
     // ── Module / function / block ───────────────────────────
     void lower_function(const ast::FunctionDecl& fn);
+    void declare_function(const ast::FunctionDecl& fn);
+    std::vector<ValuePtr> lower_params(const ast::FunctionDecl& fn);
     void lower_block(const ast::Block& block);
     void lower_statement(const ast::Stmt& stmt);
     ValuePtr lower_expression(const ast::Expr& expr);
@@ -59,7 +71,8 @@ class IRLowering {
 
     // ── Type conversion ─────────────────────────────────────
     std::shared_ptr<IRType> lower_type(const std::string& type_name);
-    std::shared_ptr<IRType> lower_flux_type(const semantic::FluxType& type);
+    std::shared_ptr<IRType> lower_type(const ast::TypeExpr* type);
+    std::shared_ptr<IRType> lower_flux_type(semantic::TypeId type);
 
     // ── Variable management (local allocas) ─────────────────
     ValuePtr lookup_variable(const std::string& name);
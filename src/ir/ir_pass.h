@@ -2,12 +2,18 @@
 #define FLUX_IR_PASS_H
 
 #include "ir/ir.h"
+#include "support/trace.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace flux::ir {
 
+/// Optimization levels, selected with -O0, -O1, -O2, -O3 and -Os. Each picks a Flux IR
+/// pass pipeline (see passes/pipeline.h) and the matching LLVM pipeline.
+enum class OptLevel { O0, O1, O2, O3, Os };
+
 /// Base class for IR transformation passes.
 /// Subclasses implement `run()` which mutates the IR module in-place.
 struct IRPass {
@@ -21,13 +27,28 @@ struct IRPass {
     virtual bool run(IRModule& module) = 0;
 };
 
+/// Hooks called by run_passes() around every pass (timing, statistics).
+struct PassInstrumentation {
+    virtual ~PassInstrumentation() = default;
+
+    virtual void before_pass(const IRPass& pass, const IRModule& module) = 0;
+    virtual void after_pass(const IRPass& pass, const IRModule& module, bool modified) = 0;
+};
+
 /// Run a sequence of passes on a module.
 /// Returns the total number of passes that modified the module.
-inline int run_passes(IRModule& module, std::vector<std::unique_ptr<IRPass>>& passes) {
+inline int run_passes(IRModule& module, std::vector<std::unique_ptr<IRPass>>& passes,
+                      PassInstrumentation* instrumentation = nullptr) {
     int modifications = 0;
     for (auto& pass : passes) {
-        if (pass->run(module))
+        TraceSpan span("ir-pass", [&] { return pass->name(); });
+        if (instrumentation)
+            instrumentation->before_pass(*pass, module);
+        const bool modified = pass->run(module);
+        if (modified)
             ++modifications;
+        if (instrumentation)
+            instrumentation->after_pass(*pass, module, modified);
     }
     return modifications;
 }
@@ -26,12 +26,12 @@ bool InlinerPass::run(IRModule& module) {
 bool InlinerPass::should_inline(const IRFunction& callee) {
     if (callee.blocks.size() != 1)
         return false;
-    if (callee.blocks[0]->instructions.size() > 10)
+    if (callee.blocks[0]->instructions.size() > max_instructions_)
         return false;
     return true;
 }
 
-static const IRFunction* find_function(const IRModule& module, const std::string& name) {
+static const IRFunction* find_function(const IRModule& module, Name name) {
     for (const auto& fn : module.functions) {
         if (fn->name == name)
             return fn.get();
@@ -109,7 +109,7 @@ bool InlinerPass::try_inline(Instruction& call_inst, IRFunction& caller, const I
         if (inst->opcode == Opcode::Ret) {
             if (inst->operands.size() == 1) {
                 auto op = inst->operands[0];
-                if (value_map.count(op->id))
+                if (!op->is_constant && value_map.count(op->id))
                     returned_value = value_map[op->id];
                 else
                     returned_value = op;
@@ -123,11 +123,11 @@ bool InlinerPass::try_inline(Instruction& call_inst, IRFunction& caller, const I
         new_inst->type = inst->type;
         new_inst->callee_name = inst->callee_name;
         new_inst->field_index = inst->field_index;
-        new_inst->line = call_inst.line;
-        new_inst->column = call_inst.column;
+        new_inst->loc = call_inst.loc;
 
+        // Constants all carry id 0, which may also be a parameter's id.
         for (const auto& op : inst->operands) {
-            if (value_map.count(op->id))
+            if (!op->is_constant && value_map.count(op->id))
                 new_inst->operands.push_back(value_map[op->id]);
             else
                 new_inst->operands.push_back(op);
@@ -167,7 +167,7 @@ bool InlinerPass::try_inline(Instruction& call_inst, IRFunction& caller, const I
         for (auto& block : caller.blocks) {
             for (auto& inst : block->instructions) {
                 for (auto& op : inst->operands) {
-                    if (op->id == old_id) {
+                    if (!op->is_constant && op->id == old_id) {
                         op = returned_value;
                     }
                 }
@@ -8,6 +8,9 @@ namespace flux::ir {
 
 class InlinerPass : public IRPass {
   public:
+    /// Inlines calls to single-block functions of at most `max_instructions` instructions.
+    explicit InlinerPass(std::size_t max_instructions = 10) : max_instructions_(max_instructions) {}
+
     std::string name() const override {
         return "Inliner";
     }
@@ -19,6 +22,8 @@ class InlinerPass : public IRPass {
 
     // Simplification: only inline single-block functions for now
     bool try_inline(Instruction& call_inst, IRFunction& caller, const IRFunction& callee);
+
+    std::size_t max_instructions_;
 };
 
 } // namespace flux::ir
@@ -0,0 +1,56 @@
+#include "ir/passes/pipeline.h"
+
+#include "ir/passes/constant_folding.h"
+#include "ir/passes/dead_code_elimination.h"
+#include "ir/passes/inliner.h"
+#include "ir/passes/ir_verifier.h"
+
+namespace flux::ir {
+
+std::vector<std::unique_ptr<IRPass>> make_pass_pipeline(OptLevel level) {
+    std::vector<std::unique_ptr<IRPass>> passes;
+
+    // Validation (Pre-opt)
+    passes.push_back(std::make_unique<IRVerifierPass>());
+    if (level == OptLevel::O0)
+        return passes;
+
+    // Optimizations
+    switch (level) {
+    case OptLevel::O2:
+        passes.push_back(std::make_unique<InlinerPass>(10));
+        break;
+    case OptLevel::O3:
+        passes.push_back(std::make_unique<InlinerPass>(40));
+        break;
+    case OptLevel::Os:
+        passes.push_back(std::make_unique<InlinerPass>(4));
+        break;
+    default:
+        break;
+    }
+    passes.push_back(std::make_unique<ConstantFoldingPass>());
+    passes.push_back(std::make_unique<DeadCodeEliminationPass>());
+
+    // Validation (Post-opt)
+    passes.push_back(std::make_unique<IRVerifierPass>());
+    return passes;
+}
+
+std::string_view opt_level_name(OptLevel level) {
+    switch (level) {
+    case OptLevel::O0:
+        return "O0";
+    case OptLevel::O1:
+        return "O1";
+    case OptLevel::O2:
+        return "O2";
+    case OptLevel::O3:
+        return "O3";
+    case OptLevel::Os:
+        return "Os";
+    }
+    return "O2";
+}
+
+} // namespace flux::ir
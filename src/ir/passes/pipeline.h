@@ -0,0 +1,26 @@
+#ifndef FLUX_IR_PASSES_PIPELINE_H
+#define FLUX_IR_PASSES_PIPELINE_H
+
+#include "ir/ir_pass.h"
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace flux::ir {
+
+/// The Flux IR passes run at `level`, in order. Every level verifies the IR before it is
+/// optimized; the optimizing levels verify it again afterwards.
+///   -O0  the verifier alone: nothing is optimized, for the fastest builds
+///   -O1  constant folding and dead code elimination
+///   -O2  the inliner first (functions of up to 10 instructions), then as -O1
+///   -O3  as -O2, inlining functions of up to 40 instructions
+///   -Os  as -O2, inlining only functions of up to 4 instructions
+std::vector<std::unique_ptr<IRPass>> make_pass_pipeline(OptLevel level);
+
+/// "O0", "O1", "O2", "O3" or "Os".
+std::string_view opt_level_name(OptLevel level);
+
+} // namespace flux::ir
+
+#endif // FLUX_IR_PASSES_PIPELINE_H
@@ -5,17 +5,33 @@
 #ifndef FLUX_DIAGNOSTIC_H
 #define FLUX_DIAGNOSTIC_H
 
+#include "source_manager.h"
+
 #include <cstddef>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace flux {
 
 class DiagnosticError : public std::runtime_error {
   public:
     DiagnosticError(std::string message, std::size_t line, std::size_t column)
-        : std::runtime_error(build_message(message, line, column)), line_(line), column_(column) {}
+        : std::runtime_error(build_message(message, {}, line, column)), line_(line),
+          column_(column) {}
+
+    // Resolves `loc` through the SourceManager, so the message names the file as well.
+    DiagnosticError(std::string message, SourceLoc loc)
+        : DiagnosticError(std::move(message), SourceManager::global().presumed(loc)) {}
 
+    DiagnosticError(std::string message, const PresumedLoc& loc)
+        : std::runtime_error(build_message(message, loc.file, loc.line, loc.column)),
+          file_(loc.file), line_(loc.line), column_(loc.column) {}
+
+    // Empty when the error was raised without a SourceLoc.
+    const std::string& file() const {
+        return file_;
+    }
     std::size_t line() const {
         return line_;
     }
@@ -24,11 +40,14 @@ class DiagnosticError : public std::runtime_error {
     }
 
   private:
-    static std::string build_message(const std::string& message, std::size_t line,
-                                     std::size_t column) {
-        return "error: " + message + " at " + std::to_string(line) + ":" + std::to_string(column);
+    static std::string build_message(const std::string& message, const std::string& file,
+                                     std::size_t line, std::size_t column) {
+        std::string where = file.empty() ? std::string() : file + ":";
+        return "error: " + message + " at " + where + std::to_string(line) + ":" +
+               std::to_string(column);
     }
 
+    std::string file_;
     std::size_t line_;
     std::size_t column_;
 };
@@ -0,0 +1,104 @@
+#include "interner.h"
+
+#include <bit>
+
+namespace flux {
+namespace {
+struct Location {
+    unsigned segment;
+    std::size_t offset;
+};
+
+constexpr std::size_t segment_size(unsigned segment, unsigned first_bits) {
+    return std::size_t{1} << (segment + first_bits);
+}
+
+// Segment k starts at id 2^(k + first_bits) - 2^first_bits.
+constexpr Location locate(std::uint32_t id, unsigned first_bits) {
+    const std::uint64_t biased = std::uint64_t{id} + (std::uint64_t{1} << first_bits);
+    const unsigned segment = static_cast<unsigned>(std::bit_width(biased)) - 1 - first_bits;
+    return {segment, static_cast<std::size_t>(biased - segment_size(segment, first_bits))};
+}
+
+static_assert(locate(0, 10).segment == 0 && locate(0, 10).offset == 0);
+static_assert(locate(1023, 10).segment == 0 && locate(1023, 10).offset == 1023);
+static_assert(locate(1024, 10).segment == 1 && locate(1024, 10).offset == 0);
+static_assert(locate(3071, 10).segment == 1 && locate(3071, 10).offset == 2047);
+static_assert(locate(3072, 10).segment == 2 && locate(3072, 10).offset == 0);
+} // namespace
+
+// Never destroyed, so Names held by other static objects stay readable during exit.
+Interner& Interner::global() {
+    static Interner* interner = new Interner();
+    return *interner;
+}
+
+Interner::Interner() {
+    segments_[0].store(new std::string[segment_size(0, kFirstBits)], std::memory_order_release);
+}
+
+Interner::~Interner() {
+    for (auto& segment : segments_)
+        delete[] segment.load(std::memory_order_relaxed);
+}
+
+std::string& Interner::slot(std::uint32_t id) const {
+    const Location loc = locate(id, kFirstBits);
+    return segments_[loc.segment].load(std::memory_order_acquire)[loc.offset];
+}
+
+std::uint32_t Interner::intern(std::string_view text) {
+    if (text.empty())
+        return 0;
+
+    const std::size_t hash = std::hash<std::string_view>{}(text);
+    Shard& shard = shards_[hash % kShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (auto it = shard.ids.find(text); it != shard.ids.end())
+        return it->second;
+
+    const std::uint32_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    const Location loc = locate(id, kFirstBits);
+    if (!segments_[loc.segment].load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> grow(grow_mutex_);
+        if (!segments_[loc.segment].load(std::memory_order_relaxed)) {
+            segments_[loc.segment].store(new std::string[segment_size(loc.segment, kFirstBits)],
+                                         std::memory_order_release);
+        }
+    }
+
+    // The map key views the stored string, which never moves.
+    std::string& stored = slot(id);
+    stored.assign(text);
+    shard.ids.emplace(stored, id);
+    return id;
+}
+
+void Interner::clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.ids.clear();
+    }
+    std::lock_guard<std::mutex> grow(grow_mutex_);
+    for (unsigned segment = 1; segment < kSegments; ++segment)
+        delete[] segments_[segment].exchange(nullptr, std::memory_order_acq_rel);
+    std::string* first = segments_[0].load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < segment_size(0, kFirstBits); ++i)
+        std::string().swap(first[i]);
+    next_id_.store(1, std::memory_order_relaxed);
+}
+
+std::uint32_t Interner::find(std::string_view text) const {
+    if (text.empty())
+        return 0;
+
+    const Shard& shard = shards_[std::hash<std::string_view>{}(text) % kShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.ids.find(text);
+    return it == shard.ids.end() ? 0 : it->second;
+}
+
+const std::string& Interner::text(std::uint32_t id) const {
+    return slot(id);
+}
+} // namespace flux
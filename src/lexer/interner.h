@@ -0,0 +1,144 @@
+#ifndef FLUX_INTERNER_H
+#define FLUX_INTERNER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace flux {
+// Process-wide table of unique strings. Each distinct string gets a dense 32-bit id that
+// stays valid, along with its text, for the life of the process. Id 0 is the empty string.
+//
+// Thread-safe: interning locks one of several shards chosen by hash, and looking up the
+// text of an id is lock-free, since the storage for an id never moves once it exists.
+class Interner {
+  public:
+    static Interner& global();
+
+    Interner();
+    ~Interner();
+    Interner(const Interner&) = delete;
+    Interner& operator=(const Interner&) = delete;
+
+    // Returns the id of `text`, adding it if it has not been seen before.
+    std::uint32_t intern(std::string_view text);
+
+    // Returns the id of `text` if it has been interned, or 0 otherwise. Never inserts.
+    std::uint32_t find(std::string_view text) const;
+
+    const std::string& text(std::uint32_t id) const;
+
+    // Forgets every string, so ids are handed out from 1 again. This invalidates every Name
+    // in the process: only call it while no Name is alive and no other thread interns.
+    void clear();
+
+    // Number of distinct strings, including the empty string.
+    std::size_t size() const {
+        return next_id_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    // Ids are stored in segments of doubling size: segment k holds 2^(k + kFirstBits) ids.
+    static constexpr unsigned kFirstBits = 10;
+    static constexpr unsigned kSegments = 32 - kFirstBits;
+    static constexpr unsigned kShards = 16;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string_view, std::uint32_t> ids;
+    };
+
+    std::string& slot(std::uint32_t id) const;
+
+    std::array<Shard, kShards> shards_;
+    std::array<std::atomic<std::string*>, kSegments> segments_{};
+    std::mutex grow_mutex_;
+    std::atomic<std::uint32_t> next_id_{1};
+};
+
+// An interned identifier, type name or module path. Names compare and hash by id in O(1);
+// the text is only looked up for printing, diagnostics and string manipulation.
+class Name {
+  public:
+    Name() = default;
+    Name(std::string_view text) : id_(Interner::global().intern(text)) {}
+    Name(const std::string& text) : Name(std::string_view(text)) {}
+    Name(const char* text) : Name(std::string_view(text)) {}
+
+    // The Name for `text` if it was ever interned, or the empty Name. Lookups by strings
+    // that may never have been declared use this so they do not grow the table.
+    static Name if_interned(std::string_view text) {
+        Name name;
+        name.id_ = Interner::global().find(text);
+        return name;
+    }
+
+    std::uint32_t id() const {
+        return id_;
+    }
+
+    bool empty() const {
+        return id_ == 0;
+    }
+
+    const std::string& str() const {
+        return Interner::global().text(id_);
+    }
+
+    operator const std::string&() const {
+        return str();
+    }
+
+    friend bool operator==(Name a, Name b) {
+        return a.id_ == b.id_;
+    }
+    friend bool operator==(Name a, std::string_view b) {
+        return a.str() == b;
+    }
+    friend bool operator==(Name a, const std::string& b) {
+        return a.str() == b;
+    }
+    friend bool operator==(Name a, const char* b) {
+        return a.str() == b;
+    }
+
+    // Concatenation yields plain text, for composing qualified names and diagnostics.
+    friend std::string operator+(const std::string& a, Name b) {
+        return a + b.str();
+    }
+    friend std::string operator+(Name a, const std::string& b) {
+        return a.str() + b;
+    }
+    friend std::string operator+(const char* a, Name b) {
+        return a + b.str();
+    }
+    friend std::string operator+(Name a, const char* b) {
+        return a.str() + b;
+    }
+    friend std::string operator+(Name a, Name b) {
+        return a.str() + b.str();
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, Name name) {
+        return os << name.str();
+    }
+
+  private:
+    std::uint32_t id_ = 0;
+};
+} // namespace flux
+
+template <> struct std::hash<flux::Name> {
+    std::size_t operator()(flux::Name name) const noexcept {
+        return name.id();
+    }
+};
+
+#endif // FLUX_INTERNER_H
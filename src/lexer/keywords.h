@@ -0,0 +1,233 @@
+#ifndef FLUX_KEYWORDS_H
+#define FLUX_KEYWORDS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace flux {
+enum class Keyword : std::uint8_t {
+    None, // not a keyword
+
+    // declarations
+    Module,
+    Import,
+    Func,
+    Let,
+    Const,
+    Return,
+    Mut,
+    Struct,
+    Class,
+    Enum,
+    Trait,
+    Impl,
+    Type,
+    Use,
+    Extern,
+
+    // control flow
+    If,
+    Else,
+    While,
+    For,
+    In,
+    Match,
+    Loop,
+    Break,
+    Continue,
+
+    // ownership & borrowing
+    Move,
+    Ref,
+    Drop,
+
+    // concurrency
+    Async,
+    Await,
+    Spawn,
+
+    // visibility
+    Pub,
+    Public,
+    Private,
+
+    // safety
+    Unsafe,
+
+    // logic & type operations
+    And,
+    Or,
+    Not,
+    As,
+    Is,
+    Where,
+
+    // self/Self
+    SelfValue,
+    SelfType,
+
+    // literals & types
+    True,
+    False,
+    Void,
+    Never,
+
+    // error handling
+    Panic,
+    Assert,
+
+    // built-in type names
+    Int8,
+    Int16,
+    Int32,
+    Int64,
+    Int128,
+    UInt8,
+    UInt16,
+    UInt32,
+    UInt64,
+    UInt128,
+    IntPtr,
+    UIntPtr,
+    Float32,
+    Float64,
+    String,
+    Bool,
+    Char,
+};
+
+namespace keyword_detail {
+struct Entry {
+    std::string_view text;
+    Keyword keyword;
+};
+
+inline constexpr std::array<Entry, 65> table = {{
+    {"module", Keyword::Module},     {"import", Keyword::Import},
+    {"func", Keyword::Func},         {"let", Keyword::Let},
+    {"const", Keyword::Const},       {"return", Keyword::Return},
+    {"mut", Keyword::Mut},           {"struct", Keyword::Struct},
+    {"class", Keyword::Class},       {"enum", Keyword::Enum},
+    {"trait", Keyword::Trait},       {"impl", Keyword::Impl},
+    {"type", Keyword::Type},         {"use", Keyword::Use},
+    {"extern", Keyword::Extern},     {"if", Keyword::If},
+    {"else", Keyword::Else},         {"while", Keyword::While},
+    {"for", Keyword::For},           {"in", Keyword::In},
+    {"match", Keyword::Match},       {"loop", Keyword::Loop},
+    {"break", Keyword::Break},       {"continue", Keyword::Continue},
+    {"move", Keyword::Move},         {"ref", Keyword::Ref},
+    {"drop", Keyword::Drop},         {"async", Keyword::Async},
+    {"await", Keyword::Await},       {"spawn", Keyword::Spawn},
+    {"pub", Keyword::Pub},           {"public", Keyword::Public},
+    {"private", Keyword::Private},   {"unsafe", Keyword::Unsafe},
+    {"and", Keyword::And},           {"or", Keyword::Or},
+    {"not", Keyword::Not},           {"as", Keyword::As},
+    {"is", Keyword::Is},             {"where", Keyword::Where},
+    {"self", Keyword::SelfValue},    {"Self", Keyword::SelfType},
+    {"true", Keyword::True},         {"false", Keyword::False},
+    {"Void", Keyword::Void},         {"Never", Keyword::Never},
+    {"panic", Keyword::Panic},       {"assert", Keyword::Assert},
+    {"Int8", Keyword::Int8},         {"Int16", Keyword::Int16},
+    {"Int32", Keyword::Int32},       {"Int64", Keyword::Int64},
+    {"Int128", Keyword::Int128},     {"UInt8", Keyword::UInt8},
+    {"UInt16", Keyword::UInt16},     {"UInt32", Keyword::UInt32},
+    {"UInt64", Keyword::UInt64},     {"UInt128", Keyword::UInt128},
+    {"IntPtr", Keyword::IntPtr},     {"UIntPtr", Keyword::UIntPtr},
+    {"Float32", Keyword::Float32},   {"Float64", Keyword::Float64},
+    {"String", Keyword::String},     {"Bool", Keyword::Bool},
+    {"Char", Keyword::Char},
+}};
+static_assert(table.size() == static_cast<std::size_t>(Keyword::Char),
+              "every Keyword needs exactly one table entry");
+
+inline constexpr std::size_t slot_count = 512;
+
+constexpr std::size_t min_length() {
+    std::size_t n = table[0].text.size();
+    for (const auto& e : table)
+        n = e.text.size() < n ? e.text.size() : n;
+    return n;
+}
+
+constexpr std::size_t max_length() {
+    std::size_t n = 0;
+    for (const auto& e : table)
+        n = e.text.size() > n ? e.text.size() : n;
+    return n;
+}
+
+// FNV-1a over the (at most max_length()) bytes of a candidate, perturbed by `seed`.
+constexpr std::uint32_t hash(std::string_view text, std::uint32_t seed) {
+    std::uint32_t h = 2166136261u ^ seed;
+    for (char c : text) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    return h & (slot_count - 1);
+}
+
+constexpr bool is_perfect(std::uint32_t seed) {
+    std::array<bool, slot_count> used{};
+    for (const auto& e : table) {
+        const std::uint32_t slot = hash(e.text, seed);
+        if (used[slot])
+            return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+// Searches for the first seed under which every keyword lands in its own slot.
+constexpr std::uint32_t find_seed() {
+    for (std::uint32_t seed = 0; seed < 4096; ++seed) {
+        if (is_perfect(seed))
+            return seed;
+    }
+    return 0;
+}
+
+inline constexpr std::uint32_t seed = find_seed();
+static_assert(is_perfect(seed), "no collision-free seed; grow slot_count");
+
+// slots[h] holds 1 + the table index of the keyword hashing to h, or 0 if empty.
+constexpr std::array<std::uint8_t, slot_count> build_slots() {
+    std::array<std::uint8_t, slot_count> slots{};
+    for (std::size_t i = 0; i < table.size(); ++i)
+        slots[hash(table[i].text, seed)] = static_cast<std::uint8_t>(i + 1);
+    return slots;
+}
+
+inline constexpr std::array<std::uint8_t, slot_count> slots = build_slots();
+} // namespace keyword_detail
+
+// Classifies an identifier with a compile-time perfect hash: a length check, one hash of
+// at most eight bytes and a single string compare.
+constexpr Keyword classify_keyword(std::string_view text) {
+    using namespace keyword_detail;
+    if (text.size() < min_length() || text.size() > max_length())
+        return Keyword::None;
+    const std::uint8_t index = slots[hash(text, seed)];
+    if (index == 0 || table[index - 1].text != text)
+        return Keyword::None;
+    return table[index - 1].keyword;
+}
+
+static_assert(classify_keyword("func") == Keyword::Func);
+static_assert(classify_keyword("where") == Keyword::Where);
+static_assert(classify_keyword("while") == Keyword::While);
+static_assert(classify_keyword("UInt128") == Keyword::UInt128);
+static_assert(classify_keyword("functions") == Keyword::None);
+static_assert(classify_keyword("x") == Keyword::None);
+
+inline const char* to_string(Keyword keyword) {
+    for (const auto& e : keyword_detail::table) {
+        if (e.keyword == keyword)
+            return e.text.data();
+    }
+    return "";
+}
+} // namespace flux
+
+#endif // FLUX_KEYWORDS_H
@@ -1,99 +1,14 @@
-// #include <cctype>
 #include "lexer.h"
 #include "diagnostic.h"
 
-#include <unordered_set>
+#include <string_view>
 
 namespace flux {
-const std::unordered_set<std::string> keywords = {
-    // declarations
-    "module",
-    "import",
-    "func",
-    "let",
-    "const",
-    "return",
-    "mut",
-    "struct",
-    "class",
-    "enum",
-    "trait",
-    "impl",
-    "type",
-    "use",
-
-    // control flow
-    "if",
-    "else",
-    "while",
-    "for",
-    "in",
-    "match",
-    "loop",
-    "break",
-    "continue",
-
-    // ownership & borrowing
-    "move",
-    "ref",
-    "drop",
-
-    // concurrency
-    "async",
-    "await",
-    "spawn",
-
-    // visibility
-    "pub",
-    "public",
-    "private",
-
-    // safety
-    "unsafe",
-
-    // logic & type operations
-    "and",
-    "or",
-    "not",
-    "as",
-    "is",
-    "where",
-
-    // self/Self
-    "self",
-    "Self",
-
-    // literals & types
-    "true",
-    "false",
-    "Void",
-    "Never",
-
-    // error handling
-    "panic",
-    "assert",
-
-    // built-in type names (keywords)
-    "Int8",
-    "Int16",
-    "Int32",
-    "Int64",
-    "Int128",
-    "UInt8",
-    "UInt16",
-    "UInt32",
-    "UInt64",
-    "UInt128",
-    "IntPtr",
-    "UIntPtr",
-    "Float32",
-    "Float64",
-    "String",
-    "Bool",
-    "Char",
-};
-
-Lexer::Lexer(std::string source) : source_(std::move(source)) {}
+Lexer::Lexer(std::string source)
+    : owned_file_(SourceFile::from_string("<input>", std::move(source))),
+      source_(owned_file_->text()), base_(owned_file_->base()) {}
+
+Lexer::Lexer(const SourceFile& file) : source_(file.text()), base_(file.base()) {}
 
 char Lexer::peek() const {
     if (is_at_end())
@@ -110,144 +25,160 @@ char Lexer::peek_next() const {
 char Lexer::advance() {
     if (is_at_end())
         return '\0';
+    return source_[position_++];
+}
 
-    char c = source_[position_++];
-    if (c == '\n') {
-        line_++;
-        column_ = 1;
-    } else {
-        column_++;
-    }
+bool Lexer::is_at_end() const {
+    return position_ >= source_.size();
+}
 
-    return c;
+std::string_view Lexer::slice(std::size_t start) const {
+    return source_.substr(start, position_ - start);
 }
 
-// ⚠️ Note: line handling is not implemented yet (we’ll fix that).
+SourceLoc Lexer::loc(std::size_t offset) const {
+    return {base_ + static_cast<std::uint32_t>(offset)};
+}
 
-bool Lexer::is_at_end() const {
-    return position_ >= source_.size();
+Token Lexer::token(TokenKind kind, std::string_view lexeme, std::size_t start,
+                   Keyword keyword) const {
+    return Token(kind, lexeme, loc(start), keyword);
+}
+
+const char* Lexer::cursor() const {
+    return source_.data() + position_;
+}
+
+const char* Lexer::end() const {
+    return source_.data() + source_.size();
+}
+
+void Lexer::skip_to(const char* stop) {
+    position_ = static_cast<std::size_t>(stop - source_.data());
 }
 
 std::vector<Token> Lexer::tokenize() {
     std::vector<Token> tokens;
+    // Typical Flux source averages 5-6 bytes per token; reserving up front avoids
+    // repeatedly copying a multi-megabyte vector on large inputs.
+    tokens.reserve(source_.size() / 4 + 16);
+
+    do {
+        tokens.push_back(next_token());
+    } while (tokens.back().kind != TokenKind::EndOfFile);
+
+    return tokens;
+}
 
+Token Lexer::next_token() {
     while (!is_at_end()) {
         const char c = peek();
 
-        if (std::isspace(static_cast<unsigned char>(c))) {
-            advance();
+        if (scan::is_space(c)) {
+            // A single separating space or newline is the common case and not worth a
+            // vector scan.
+            if (!scan::is_space(peek_next())) {
+                position_++;
+                continue;
+            }
+            skip_to(scan_->skip_whitespace(cursor(), end()));
             continue;
         }
 
-        // Numbers
-        if (std::isdigit(static_cast<unsigned char>(c))) {
-            const std::size_t start_col = column_;
-            std::string number;
+        // Numbers. The lexeme keeps digit separators ('_'); the parser strips them when it
+        // builds the literal.
+        if (scan::is_digit(c)) {
+            const std::size_t start = position_;
 
             if (c == '0') {
-                number.push_back(advance());
+                advance();
                 char next = peek();
                 if (next == 'x' || next == 'X') {
-                    number.push_back(advance()); // consume x
-                    while (!is_at_end() &&
-                           (std::isxdigit(static_cast<unsigned char>(peek())) || peek() == '_')) {
-                        char n = advance();
-                        if (n != '_')
-                            number.push_back(n);
+                    advance(); // consume x
+                    while (!is_at_end() && (scan::is_hex_digit(peek()) || peek() == '_')) {
+                        advance();
                     }
                 } else if (next == 'b' || next == 'B') {
-                    number.push_back(advance()); // consume b
+                    advance(); // consume b
                     while (!is_at_end() && (peek() == '0' || peek() == '1' || peek() == '_')) {
-                        char n = advance();
-                        if (n != '_')
-                            number.push_back(n);
+                        advance();
                     }
                 } else if (next == 'o' || next == 'O') {
-                    number.push_back(advance()); // consume o
+                    advance(); // consume o
                     while (!is_at_end() && ((peek() >= '0' && peek() <= '7') || peek() == '_')) {
-                        char n = advance();
-                        if (n != '_')
-                            number.push_back(n);
+                        advance();
                     }
                 } else {
                     // Just a zero or decimal starting with zero
-                    while (!is_at_end() &&
-                           (std::isdigit(static_cast<unsigned char>(peek())) || peek() == '_')) {
-                        char n = advance();
-                        if (n != '_')
-                            number.push_back(n);
-                    }
+                    position_ = static_cast<std::size_t>(scan_->skip_digits(cursor(), end()) -
+                                                         source_.data());
                 }
             } else {
-                while (!is_at_end() &&
-                       (std::isdigit(static_cast<unsigned char>(peek())) || peek() == '_')) {
-                    char n = advance();
-                    if (n != '_')
-                        number.push_back(n);
-                }
+                position_ = static_cast<std::size_t>(scan_->skip_digits(cursor(), end()) -
+                                                     source_.data());
             }
 
-            if (peek() == '.' && std::isdigit(static_cast<unsigned char>(peek_next()))) {
-                number.push_back(advance()); // consume '.'
-                while (!is_at_end() &&
-                       (std::isdigit(static_cast<unsigned char>(peek())) || peek() == '_')) {
-                    char n = advance();
-                    if (n != '_')
-                        number.push_back(n);
-                }
+            if (peek() == '.' && scan::is_digit(peek_next())) {
+                advance(); // consume '.'
+                position_ = static_cast<std::size_t>(scan_->skip_digits(cursor(), end()) -
+                                                     source_.data());
             }
 
-            tokens.push_back({TokenKind::Number, number, line_, start_col});
-            continue;
+            return token(TokenKind::Number, slice(start), start);
         }
 
         // Identifiers / keywords
-        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
-            const std::size_t start_col = column_;
-            std::string ident;
-
-            while (!is_at_end() &&
-                   (std::isalnum(static_cast<unsigned char>(peek())) || peek() == '_')) {
-                ident.push_back(advance());
-            }
-
-            TokenKind kind = TokenKind::Identifier;
-            if (ident == "pub")
+        if (scan::is_identifier_start(c)) {
+            const std::size_t start = position_;
+
+            position_ =
+                static_cast<std::size_t>(scan_->skip_identifier(cursor(), end()) - source_.data());
+            const std::string_view ident = slice(start);
+
+            const Keyword keyword = classify_keyword(ident);
+            TokenKind kind;
+            switch (keyword) {
+            case Keyword::None:
+                kind = TokenKind::Identifier;
+                break;
+            case Keyword::Pub:
                 kind = TokenKind::Pub;
-            else if (ident == "public")
+                break;
+            case Keyword::Public:
                 kind = TokenKind::Public;
-            else if (ident == "private")
+                break;
+            case Keyword::Private:
                 kind = TokenKind::Private;
-            else if (ident == "extern")
+                break;
+            case Keyword::Extern:
                 kind = TokenKind::Extern;
-            else if (keywords.contains(ident))
+                break;
+            default:
                 kind = TokenKind::Keyword;
+                break;
+            }
 
-            tokens.push_back({kind, ident, line_, start_col});
-            continue;
+            return token(kind, ident, start, keyword);
         }
 
         // Operators & punctuation (longest match first)
         switch (c) {
         case ';':
             advance();
-            tokens.push_back({TokenKind::Semicolon, ";", line_, column_ - 1});
-            continue;
+            return token(TokenKind::Semicolon, ";", position_ - 1);
 
         case ':':
             advance();
             if (peek() == ':') {
                 advance();
-                tokens.push_back({TokenKind::ColonColon, "::", line_, column_ - 2});
+                return token(TokenKind::ColonColon, "::", position_ - 2);
             } else {
-                tokens.push_back({TokenKind::Colon, ":", line_, column_ - 1});
+                return token(TokenKind::Colon, ":", position_ - 1);
             }
-            continue;
 
         case ',':
             advance();
-            tokens.push_back({TokenKind::Comma, ",", line_, column_ - 1});
-            continue;
+            return token(TokenKind::Comma, ",", position_ - 1);
 
         case '.': {
             advance();
@@ -255,275 +186,244 @@ std::vector<Token> Lexer::tokenize() {
                 advance();
                 if (peek() == '.') {
                     advance();
-                    tokens.push_back({TokenKind::Ellipsis, "...", line_, column_ - 3});
+                    return token(TokenKind::Ellipsis, "...", position_ - 3);
                 } else if (peek() == '=') {
                     advance();
-                    tokens.push_back({TokenKind::DotDotEqual, "..=", line_, column_ - 3});
+                    return token(TokenKind::DotDotEqual, "..=", position_ - 3);
                 } else {
-                    tokens.push_back({TokenKind::DotDot, "..", line_, column_ - 2});
+                    return token(TokenKind::DotDot, "..", position_ - 2);
                 }
             } else {
-                tokens.push_back({TokenKind::Dot, ".", line_, column_ - 1});
+                return token(TokenKind::Dot, ".", position_ - 1);
             }
-            continue;
         }
 
         case '(':
             advance();
-            tokens.push_back({TokenKind::LParen, "(", line_, column_ - 1});
-            continue;
+            return token(TokenKind::LParen, "(", position_ - 1);
 
         case ')':
             advance();
-            tokens.push_back({TokenKind::RParen, ")", line_, column_ - 1});
-            continue;
+            return token(TokenKind::RParen, ")", position_ - 1);
 
         case '[':
             advance();
-            tokens.push_back({TokenKind::LBracket, "[", line_, column_ - 1});
-            continue;
+            return token(TokenKind::LBracket, "[", position_ - 1);
 
         case ']':
             advance();
-            tokens.push_back({TokenKind::RBracket, "]", line_, column_ - 1});
-            continue;
+            return token(TokenKind::RBracket, "]", position_ - 1);
 
         case '{':
             advance();
-            tokens.push_back({TokenKind::LBrace, "{", line_, column_ - 1});
-            continue;
+            return token(TokenKind::LBrace, "{", position_ - 1);
 
         case '}':
             advance();
-            tokens.push_back({TokenKind::RBrace, "}", line_, column_ - 1});
-            continue;
+            return token(TokenKind::RBrace, "}", position_ - 1);
 
         case '-':
             if (peek_next() == '>') {
                 advance();
                 advance();
-                tokens.push_back({TokenKind::Arrow, "->", line_, column_ - 2});
+                return token(TokenKind::Arrow, "->", position_ - 2);
             } else if (peek_next() == '=') {
                 advance();
                 advance();
-                tokens.push_back({TokenKind::MinusAssign, "-=", line_, column_ - 2});
+                return token(TokenKind::MinusAssign, "-=", position_ - 2);
             } else {
                 advance();
-                tokens.push_back({TokenKind::Minus, "-", line_, column_ - 1});
+                return token(TokenKind::Minus, "-", position_ - 1);
             }
-            continue;
 
         case '=':
             if (peek_next() == '=') {
                 advance();
                 advance();
-                tokens.push_back({TokenKind::EqualEqual, "==", line_, column_ - 2});
+                return token(TokenKind::EqualEqual, "==", position_ - 2);
             } else if (peek_next() == '>') {
                 advance();
                 advance();
-                tokens.push_back({TokenKind::FatArrow, "=>", line_, column_ - 2});
+                return token(TokenKind::FatArrow, "=>", position_ - 2);
             } else {
                 advance();
-                tokens.push_back({TokenKind::Assign, "=", line_, column_ - 1});
+                return token(TokenKind::Assign, "=", position_ - 1);
             }
-            continue;
 
         case '&':
             advance();
             if (peek() == '&') {
                 advance();
-                tokens.push_back({TokenKind::AmpAmp, "&&", line_, column_ - 2});
+                return token(TokenKind::AmpAmp, "&&", position_ - 2);
             } else if (peek() == '=') {
                 advance();
-                tokens.push_back({TokenKind::AmpAssign, "&=", line_, column_ - 2});
+                return token(TokenKind::AmpAssign, "&=", position_ - 2);
             } else {
-                tokens.push_back({TokenKind::Amp, "&", line_, column_ - 1});
+                return token(TokenKind::Amp, "&", position_ - 1);
             }
-            continue;
 
         case '|':
             advance();
             if (peek() == '|') {
                 advance();
-                tokens.push_back({TokenKind::PipePipe, "||", line_, column_ - 2});
+                return token(TokenKind::PipePipe, "||", position_ - 2);
             } else if (peek() == '=') {
                 advance();
-                tokens.push_back({TokenKind::PipeAssign, "|=", line_, column_ - 2});
+                return token(TokenKind::PipeAssign, "|=", position_ - 2);
             } else {
-                tokens.push_back({TokenKind::Pipe, "|", line_, column_ - 1});
+                return token(TokenKind::Pipe, "|", position_ - 1);
             }
-            continue;
 
         case '^':
             advance();
             if (peek() == '=') {
                 advance();
-                tokens.push_back({TokenKind::CaretAssign, "^=", line_, column_ - 2});
+                return token(TokenKind::CaretAssign, "^=", position_ - 2);
             } else {
-                tokens.push_back({TokenKind::Caret, "^", line_, column_ - 1});
+                return token(TokenKind::Caret, "^", position_ - 1);
             }
-            continue;
 
         case '~':
             advance();
-            tokens.push_back({TokenKind::Tilde, "~", line_, column_ - 1});
-            continue;
+            return token(TokenKind::Tilde, "~", position_ - 1);
 
         case '?':
             advance();
-            tokens.push_back({TokenKind::Question, "?", line_, column_ - 1});
-            continue;
+            return token(TokenKind::Question, "?", position_ - 1);
 
         case '!':
             if (peek_next() == '=') {
                 advance();
                 advance();
-                tokens.push_back({TokenKind::BangEqual, "!=", line_, column_ - 2});
+                return token(TokenKind::BangEqual, "!=", position_ - 2);
             } else {
                 advance();
-                tokens.push_back({TokenKind::Bang, "!", line_, column_ - 1});
+                return token(TokenKind::Bang, "!", position_ - 1);
             }
-            continue;
 
         case '<':
             if (peek_next() == '=') {
                 advance();
                 advance();
-                tokens.push_back({TokenKind::LessEqual, "<=", line_, column_ - 2});
+                return token(TokenKind::LessEqual, "<=", position_ - 2);
             } else if (peek_next() == '<') {
                 advance();
                 advance();
-                tokens.push_back({TokenKind::ShiftLeft, "<<", line_, column_ - 2});
+                return token(TokenKind::ShiftLeft, "<<", position_ - 2);
             } else {
                 advance();
-                tokens.push_back({TokenKind::Less, "<", line_, column_ - 1});
+                return token(TokenKind::Less, "<", position_ - 1);
             }
-            continue;
 
         case '>':
             if (peek_next() == '=') {
                 advance();
                 advance();
-                tokens.push_back({TokenKind::GreaterEqual, ">=", line_, column_ - 2});
+                return token(TokenKind::GreaterEqual, ">=", position_ - 2);
             } else if (peek_next() == '>') {
                 advance();
                 advance();
-                tokens.push_back({TokenKind::ShiftRight, ">>", line_, column_ - 2});
+                return token(TokenKind::ShiftRight, ">>", position_ - 2);
             } else {
                 advance();
-                tokens.push_back({TokenKind::Greater, ">", line_, column_ - 1});
+                return token(TokenKind::Greater, ">", position_ - 1);
             }
-            continue;
 
         case '+':
             advance();
             if (peek() == '=') {
                 advance();
-                tokens.push_back({TokenKind::PlusAssign, "+=", line_, column_ - 2});
+                return token(TokenKind::PlusAssign, "+=", position_ - 2);
             } else {
-                tokens.push_back({TokenKind::Plus, "+", line_, column_ - 1});
+                return token(TokenKind::Plus, "+", position_ - 1);
             }
-            continue;
 
         case '*':
             advance();
             if (peek() == '=') {
                 advance();
-                tokens.push_back({TokenKind::StarAssign, "*=", line_, column_ - 2});
+                return token(TokenKind::StarAssign, "*=", position_ - 2);
             } else {
-                tokens.push_back({TokenKind::Star, "*", line_, column_ - 1});
+                return token(TokenKind::Star, "*", position_ - 1);
             }
-            continue;
 
         case '/':
             advance();
             if (peek() == '/') {
-                advance();
-                while (!is_at_end() && peek() != '\n') {
-                    advance();
-                }
+                // Line comment: jump to the newline, which the whitespace scan consumes.
+                const char* line_end = scan_->find_line_end(cursor(), end());
+                position_ = static_cast<std::size_t>(line_end - source_.data());
+                continue;
             } else if (peek() == '=') {
                 advance();
-                tokens.push_back({TokenKind::SlashAssign, "/=", line_, column_ - 2});
+                return token(TokenKind::SlashAssign, "/=", position_ - 2);
             } else {
-                tokens.push_back({TokenKind::Slash, "/", line_, column_ - 1});
+                return token(TokenKind::Slash, "/", position_ - 1);
             }
-            continue;
 
         case '%':
             advance();
             if (peek() == '=') {
                 advance();
-                tokens.push_back({TokenKind::PercentAssign, "%=", line_, column_ - 2});
+                return token(TokenKind::PercentAssign, "%=", position_ - 2);
             } else {
-                tokens.push_back({TokenKind::Percent, "%", line_, column_ - 1});
+                return token(TokenKind::Percent, "%", position_ - 1);
             }
-            continue;
 
         case '@': {
+            const std::size_t start = position_;
             advance();
-            std::size_t start_col = column_ - 1;
-            std::string annotation = "@";
-            while (!is_at_end() &&
-                   (std::isalnum(static_cast<unsigned char>(peek())) || peek() == '_')) {
-                annotation.push_back(advance());
-            }
-            tokens.push_back({TokenKind::Annotation, annotation, line_, start_col});
-            continue;
+            position_ =
+                static_cast<std::size_t>(scan_->skip_identifier(cursor(), end()) - source_.data());
+            return token(TokenKind::Annotation, slice(start), start);
         }
 
         case '"': {
             advance();
-            std::size_t start_col = column_ - 1;
-            std::string literal;
-            while (!is_at_end() && peek() != '"') {
-                if (peek() == '\n') {
-                    throw DiagnosticError("Unterminated string literal", line_, column_);
-                }
-                literal.push_back(advance());
+            const std::size_t start = position_;
+            position_ =
+                static_cast<std::size_t>(scan_->find_string_end(cursor(), end()) - source_.data());
+            if (peek() == '\n') {
+                throw DiagnosticError("Unterminated string literal", loc(position_));
             }
+            const std::string_view literal = slice(start);
 
             if (is_at_end()) {
-                throw DiagnosticError("Unterminated string literal", line_, column_);
+                throw DiagnosticError("Unterminated string literal", loc(position_));
             }
 
             advance(); // Consume closing quote
-            tokens.push_back({TokenKind::String, literal, line_, start_col});
-            continue;
+            return token(TokenKind::String, literal, start - 1);
         }
 
         case '\'': {
             advance();
-            std::size_t start_col = column_ - 1;
-            std::string literal;
+            const std::size_t start = position_;
             if (peek() == '\\') {
-                literal.push_back(advance());
+                advance();
                 if (!is_at_end()) {
-                    literal.push_back(advance());
+                    advance();
                 }
             } else if (!is_at_end() && peek() != '\'') {
-                literal.push_back(advance());
+                advance();
             }
+            const std::string_view literal = slice(start);
 
             if (peek() != '\'') {
-                throw DiagnosticError("Unterminated character literal", line_, column_);
+                throw DiagnosticError("Unterminated character literal", loc(position_));
             }
             advance(); // consume '
-            tokens.push_back({TokenKind::Char, literal, line_, start_col});
-            continue;
+            return token(TokenKind::Char, literal, start - 1);
         }
         }
 
         // Unknown character
-        std::size_t err_line = line_;
-        std::size_t err_col = column_;
+        const SourceLoc err_loc = loc(position_);
         char bad = advance();
 
-        throw DiagnosticError(std::string("unexpected character '") + bad + "'", err_line, err_col);
+        throw DiagnosticError(std::string("unexpected character '") + bad + "'", err_loc);
     }
 
-    tokens.push_back({TokenKind::EndOfFile, "", line_, column_});
-
-    return tokens;
+    return token(TokenKind::EndOfFile, "", position_);
 }
 } // namespace flux
@@ -1,17 +1,37 @@
 #ifndef FLUX_LEXER_H
 #define FLUX_LEXER_H
 
+#include "scan.h"
+#include "source_file.h"
 #include "token.h"
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace flux {
 class Lexer {
   public:
+    // Lexes a copy of `source`, registered as the file "<input>"; the tokens view the
+    // Lexer's own buffer.
     explicit Lexer(std::string source);
 
+    // Lexes `file` in place; the tokens view the file's (usually memory-mapped) text.
+    explicit Lexer(const SourceFile& file);
+
+    // Tokens view into source_, so a Lexer must outlive the tokens it returns and must
+    // not be relocated.
+    Lexer(const Lexer&) = delete;
+    Lexer& operator=(const Lexer&) = delete;
+
+    // Lexes the whole input; the last token is always EndOfFile.
     std::vector<Token> tokenize();
 
+    // Lexes one token on demand. Once the input is exhausted every call returns
+    // EndOfFile. Throws DiagnosticError on malformed input.
+    Token next_token();
+
   private:
     char peek() const;
 
@@ -21,10 +41,25 @@ class Lexer {
 
     bool is_at_end() const;
 
-    std::string source_;
+    std::string_view slice(std::size_t start) const;
+
+    // Locations are byte offsets into the file's SourceManager range; lines and columns
+    // are only worked out when a diagnostic is printed.
+    SourceLoc loc(std::size_t offset) const;
+
+    Token token(TokenKind kind, std::string_view lexeme, std::size_t start,
+                Keyword keyword = Keyword::None) const;
+
+    void skip_to(const char* stop);
+
+    const char* cursor() const;
+    const char* end() const;
+
+    std::unique_ptr<SourceFile> owned_file_;
+    std::string_view source_;
+    std::uint32_t base_ = 0;
+    const scan::Kernels* scan_ = &scan::active();
     std::size_t position_ = 0;
-    std::size_t line_ = 1;
-    std::size_t column_ = 1;
 };
 } // namespace flux
 
@@ -0,0 +1,346 @@
+#include "scan.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+// The SSE2 kernels are used without a runtime check, so they are only built where SSE2 is
+// part of the baseline: always on x86-64, and on 32-bit x86 only when compiling for it
+// (-msse2, /arch:SSE2). Other 32-bit x86 builds use the scalar kernels.
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || \
+    (defined(_M_IX86) && defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLUX_SCAN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define FLUX_TARGET_AVX2
+#else
+#define FLUX_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#endif
+#else
+#define FLUX_SCAN_X86 0
+#endif
+
+namespace flux::scan {
+namespace {
+/* =======================
+   Scalar reference kernels
+   ======================= */
+
+const char* skip_whitespace_scalar(const char* p, const char* end) {
+    while (p < end && is_space(*p))
+        ++p;
+    return p;
+}
+
+const char* skip_identifier_scalar(const char* p, const char* end) {
+    while (p < end && is_identifier_char(*p))
+        ++p;
+    return p;
+}
+
+const char* skip_digits_scalar(const char* p, const char* end) {
+    while (p < end && (is_digit(*p) || *p == '_'))
+        ++p;
+    return p;
+}
+
+const char* find_line_end_scalar(const char* p, const char* end) {
+    const void* hit = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+    return hit ? static_cast<const char*>(hit) : end;
+}
+
+const char* find_string_end_scalar(const char* p, const char* end) {
+    while (p < end && *p != '"' && *p != '\n')
+        ++p;
+    return p;
+}
+
+std::size_t count_newlines_scalar(const char* p, const char* end) {
+    std::size_t n = 0;
+    for (; p < end; ++p)
+        n += *p == '\n';
+    return n;
+}
+
+constexpr Kernels scalar_kernels = {
+    skip_whitespace_scalar,  skip_identifier_scalar, skip_digits_scalar,
+    find_line_end_scalar,    find_string_end_scalar, count_newlines_scalar,
+};
+
+#if FLUX_SCAN_X86
+/* =======================
+   SSE2 kernels (16 bytes per step)
+   ======================= */
+
+// Signed byte compares: bytes >= 0x80 are negative and never fall inside an ASCII range.
+inline __m128i in_range_sse2(__m128i v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(hi + 1))));
+}
+
+inline unsigned space_mask_sse2(__m128i v) {
+    __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), in_range_sse2(v, '\t', '\r'));
+    return static_cast<unsigned>(_mm_movemask_epi8(m));
+}
+
+inline unsigned identifier_mask_sse2(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i m = _mm_or_si128(in_range_sse2(lower, 'a', 'z'), in_range_sse2(v, '0', '9'));
+    m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    return static_cast<unsigned>(_mm_movemask_epi8(m));
+}
+
+inline unsigned digit_mask_sse2(__m128i v) {
+    __m128i m = _mm_or_si128(in_range_sse2(v, '0', '9'), _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    return static_cast<unsigned>(_mm_movemask_epi8(m));
+}
+
+inline unsigned byte_mask_sse2(__m128i v, char c) {
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+}
+
+inline __m128i load_sse2(const char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+const char* skip_whitespace_sse2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        if (unsigned stop = ~space_mask_sse2(load_sse2(p)) & 0xFFFFu)
+            return p + std::countr_zero(stop);
+    }
+    return skip_whitespace_scalar(p, end);
+}
+
+const char* skip_identifier_sse2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        if (unsigned stop = ~identifier_mask_sse2(load_sse2(p)) & 0xFFFFu)
+            return p + std::countr_zero(stop);
+    }
+    return skip_identifier_scalar(p, end);
+}
+
+const char* skip_digits_sse2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        if (unsigned stop = ~digit_mask_sse2(load_sse2(p)) & 0xFFFFu)
+            return p + std::countr_zero(stop);
+    }
+    return skip_digits_scalar(p, end);
+}
+
+const char* find_line_end_sse2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        if (unsigned hit = byte_mask_sse2(load_sse2(p), '\n'))
+            return p + std::countr_zero(hit);
+    }
+    return find_line_end_scalar(p, end);
+}
+
+const char* find_string_end_sse2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        __m128i v = load_sse2(p);
+        if (unsigned hit = byte_mask_sse2(v, '"') | byte_mask_sse2(v, '\n'))
+            return p + std::countr_zero(hit);
+    }
+    return find_string_end_scalar(p, end);
+}
+
+// SSE2 does not imply POPCNT, so newline matches (0xFF == -1 per byte) are subtracted into
+// byte counters and folded with SAD before they can overflow.
+std::size_t count_newlines_sse2(const char* p, const char* end) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    std::size_t n = 0;
+    while (end - p >= 16) {
+        __m128i counts = _mm_setzero_si128();
+        for (int i = 0; i < 255 && end - p >= 16; ++i, p += 16)
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(load_sse2(p), newline));
+        const __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+        n += static_cast<std::size_t>(_mm_cvtsi128_si32(sums)) +
+             static_cast<std::size_t>(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+    }
+    return n + count_newlines_scalar(p, end);
+}
+
+constexpr Kernels sse2_kernels = {
+    skip_whitespace_sse2,  skip_identifier_sse2, skip_digits_sse2,
+    find_line_end_sse2,    find_string_end_sse2, count_newlines_sse2,
+};
+
+/* =======================
+   AVX2 kernels (32 bytes per step)
+   ======================= */
+
+FLUX_TARGET_AVX2 inline __m256i in_range_avx2(__m256i v, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), v));
+}
+
+FLUX_TARGET_AVX2 inline std::uint32_t space_mask_avx2(__m256i v) {
+    __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                in_range_avx2(v, '\t', '\r'));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(m));
+}
+
+FLUX_TARGET_AVX2 inline std::uint32_t identifier_mask_avx2(__m256i v) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i m = _mm256_or_si256(in_range_avx2(lower, 'a', 'z'), in_range_avx2(v, '0', '9'));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(m));
+}
+
+FLUX_TARGET_AVX2 inline std::uint32_t digit_mask_avx2(__m256i v) {
+    __m256i m =
+        _mm256_or_si256(in_range_avx2(v, '0', '9'), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(m));
+}
+
+FLUX_TARGET_AVX2 inline std::uint32_t byte_mask_avx2(__m256i v, char c) {
+    return static_cast<std::uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))));
+}
+
+FLUX_TARGET_AVX2 inline __m256i load_avx2(const char* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+FLUX_TARGET_AVX2 const char* skip_whitespace_avx2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        if (std::uint32_t stop = ~space_mask_avx2(load_avx2(p)))
+            return p + std::countr_zero(stop);
+    }
+    return skip_whitespace_sse2(p, end);
+}
+
+FLUX_TARGET_AVX2 const char* skip_identifier_avx2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        if (std::uint32_t stop = ~identifier_mask_avx2(load_avx2(p)))
+            return p + std::countr_zero(stop);
+    }
+    return skip_identifier_sse2(p, end);
+}
+
+FLUX_TARGET_AVX2 const char* skip_digits_avx2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        if (std::uint32_t stop = ~digit_mask_avx2(load_avx2(p)))
+            return p + std::countr_zero(stop);
+    }
+    return skip_digits_sse2(p, end);
+}
+
+FLUX_TARGET_AVX2 const char* find_line_end_avx2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        if (std::uint32_t hit = byte_mask_avx2(load_avx2(p), '\n'))
+            return p + std::countr_zero(hit);
+    }
+    return find_line_end_sse2(p, end);
+}
+
+FLUX_TARGET_AVX2 const char* find_string_end_avx2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        __m256i v = load_avx2(p);
+        if (std::uint32_t hit = byte_mask_avx2(v, '"') | byte_mask_avx2(v, '\n'))
+            return p + std::countr_zero(hit);
+    }
+    return find_string_end_sse2(p, end);
+}
+
+FLUX_TARGET_AVX2 std::size_t count_newlines_avx2(const char* p, const char* end) {
+    std::size_t n = 0;
+    for (; end - p >= 32; p += 32)
+        n += static_cast<std::size_t>(std::popcount(byte_mask_avx2(load_avx2(p), '\n')));
+    return n + count_newlines_sse2(p, end);
+}
+
+constexpr Kernels avx2_kernels = {
+    skip_whitespace_avx2,  skip_identifier_avx2, skip_digits_avx2,
+    find_line_end_avx2,    find_string_end_avx2, count_newlines_avx2,
+};
+
+bool cpu_has_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+    __cpuid(regs, 1);
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // FLUX_SCAN_X86
+} // namespace
+
+bool is_supported(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar:
+        return true;
+#if FLUX_SCAN_X86
+    case Isa::SSE2:
+        return true;
+    case Isa::AVX2: {
+        static const bool has_avx2 = cpu_has_avx2();
+        return has_avx2;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+Isa best_isa() {
+    if (is_supported(Isa::AVX2))
+        return Isa::AVX2;
+    if (is_supported(Isa::SSE2))
+        return Isa::SSE2;
+    return Isa::Scalar;
+}
+
+const Kernels& kernels(Isa isa) {
+    if (!is_supported(isa))
+        return scalar_kernels;
+    switch (isa) {
+#if FLUX_SCAN_X86
+    case Isa::SSE2:
+        return sse2_kernels;
+    case Isa::AVX2:
+        return avx2_kernels;
+#endif
+    default:
+        return scalar_kernels;
+    }
+}
+
+const Kernels& active() {
+    static const Kernels& selected = []() -> const Kernels& {
+        // FLUX_SCAN_ISA=scalar|sse2|avx2 pins the kernels, for benchmarking and debugging.
+        if (const char* forced = std::getenv("FLUX_SCAN_ISA")) {
+            for (Isa isa : {Isa::Scalar, Isa::SSE2, Isa::AVX2}) {
+                if (std::strcmp(forced, to_string(isa)) == 0)
+                    return kernels(isa);
+            }
+        }
+        return kernels(best_isa());
+    }();
+    return selected;
+}
+
+const char* to_string(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar:
+        return "scalar";
+    case Isa::SSE2:
+        return "sse2";
+    case Isa::AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+} // namespace flux::scan
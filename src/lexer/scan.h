@@ -0,0 +1,67 @@
+#ifndef FLUX_SCAN_H
+#define FLUX_SCAN_H
+
+#include <cstddef>
+
+namespace flux::scan {
+// Bulk character-class scanners used by the lexer. Each kernel takes the half-open range
+// [p, end) and returns a pointer to the first byte that ends the run, or `end`.
+// Vector variants process 16 (SSE2) or 32 (AVX2) bytes per step; the scalar variant is
+// always available and is the reference implementation.
+enum class Isa {
+    Scalar,
+    SSE2,
+    AVX2,
+};
+
+struct Kernels {
+    // First byte that is not ASCII whitespace (' ', '\t', '\n', '\v', '\f', '\r').
+    const char* (*skip_whitespace)(const char* p, const char* end);
+    // First byte that is not [A-Za-z0-9_].
+    const char* (*skip_identifier)(const char* p, const char* end);
+    // First byte that is not [0-9_].
+    const char* (*skip_digits)(const char* p, const char* end);
+    // First '\n' (the end of a line comment).
+    const char* (*find_line_end)(const char* p, const char* end);
+    // First '"' or '\n' (the end of a string literal, or where it goes unterminated).
+    const char* (*find_string_end)(const char* p, const char* end);
+    // Number of '\n' bytes in the range.
+    std::size_t (*count_newlines)(const char* p, const char* end);
+};
+
+// The widest instruction set supported by both the build and the running CPU.
+Isa best_isa();
+
+bool is_supported(Isa isa);
+
+// Kernels for a specific instruction set; falls back to scalar if `isa` is unsupported.
+const Kernels& kernels(Isa isa);
+
+// Kernels for best_isa(), selected once on first use. The FLUX_SCAN_ISA environment
+// variable (scalar, sse2 or avx2) overrides the choice.
+const Kernels& active();
+
+const char* to_string(Isa isa);
+
+constexpr bool is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+constexpr bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool is_hex_digit(char c) {
+    return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+constexpr bool is_identifier_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+constexpr bool is_identifier_char(char c) {
+    return is_identifier_start(c) || is_digit(c);
+}
+} // namespace flux::scan
+
+#endif // FLUX_SCAN_H
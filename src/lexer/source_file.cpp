@@ -0,0 +1,176 @@
+#include "source_file.h"
+#include "scan.h"
+#include "source_manager.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <filesystem>
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace flux {
+namespace {
+[[noreturn]] void fail_open(const std::string& path) {
+    throw std::runtime_error("flux: could not open file: " + path);
+}
+
+#ifndef _WIN32
+// Reads a descriptor that cannot be mapped (pipe, character device, empty file).
+std::string read_all(int fd, const std::string& path) {
+    std::string contents;
+    char chunk[64 * 1024];
+    for (;;) {
+        ssize_t n = ::read(fd, chunk, sizeof(chunk));
+        if (n == 0)
+            break;
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            fail_open(path);
+        }
+        contents.append(chunk, static_cast<std::size_t>(n));
+    }
+    return contents;
+}
+#endif
+} // namespace
+
+std::unique_ptr<SourceFile> SourceFile::from_string(std::string path, std::string contents) {
+    std::unique_ptr<SourceFile> file(new SourceFile());
+    file->path_ = std::move(path);
+    file->owned_ = std::move(contents);
+    file->text_ = file->owned_;
+    file->finish();
+    return file;
+}
+
+std::unique_ptr<SourceFile> SourceFile::open(const std::string& path) {
+    if (path == "-") {
+        std::string contents{std::istreambuf_iterator<char>(std::cin),
+                             std::istreambuf_iterator<char>()};
+        return from_string("<stdin>", std::move(contents));
+    }
+
+    std::unique_ptr<SourceFile> file(new SourceFile());
+    file->path_ = path;
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileW(std::filesystem::path(path).c_str(), GENERIC_READ,
+                                FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                                nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        fail_open(path);
+
+    LARGE_INTEGER size{};
+    if (GetFileType(handle) == FILE_TYPE_DISK && GetFileSizeEx(handle, &size) &&
+        size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (view) {
+                CloseHandle(handle);
+                file->mapping_ = view;
+                file->mapping_handle_ = mapping;
+                file->mapped_size_ = static_cast<std::size_t>(size.QuadPart);
+                file->text_ = std::string_view(static_cast<const char*>(view),
+                                               file->mapped_size_);
+                file->finish();
+                return file;
+            }
+            CloseHandle(mapping);
+        }
+    }
+
+    std::string contents;
+    char chunk[64 * 1024];
+    DWORD n = 0;
+    while (ReadFile(handle, chunk, sizeof(chunk), &n, nullptr) && n > 0)
+        contents.append(chunk, n);
+    CloseHandle(handle);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        fail_open(path);
+
+    struct stat st{};
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        const auto size = static_cast<std::size_t>(st.st_size);
+        void* view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            ::close(fd);
+            ::madvise(view, size, MADV_SEQUENTIAL);
+            file->mapping_ = view;
+            file->mapped_size_ = size;
+            file->text_ = std::string_view(static_cast<const char*>(view), size);
+            file->finish();
+            return file;
+        }
+    }
+
+    std::string contents;
+    try {
+        contents = read_all(fd, path);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+#endif
+
+    file->owned_ = std::move(contents);
+    file->text_ = file->owned_;
+    file->finish();
+    return file;
+}
+
+void SourceFile::finish() {
+    base_ = SourceManager::global().add(*this);
+}
+
+PresumedLoc SourceFile::presumed(std::size_t offset) const {
+    std::call_once(lines_once_, [this] {
+        const scan::Kernels& scan = scan::active();
+        const char* begin = text_.data();
+        const char* end = begin + text_.size();
+        line_starts_.reserve(scan.count_newlines(begin, end) + 1);
+        line_starts_.push_back(0);
+        for (const char* p = scan.find_line_end(begin, end); p != end;
+             p = scan.find_line_end(p + 1, end))
+            line_starts_.push_back(static_cast<std::uint32_t>(p + 1 - begin));
+    });
+
+    const auto next = std::upper_bound(line_starts_.begin(), line_starts_.end(), offset);
+    const std::size_t line = static_cast<std::size_t>(next - line_starts_.begin());
+    return {path_, static_cast<std::uint32_t>(line),
+            static_cast<std::uint32_t>(offset - line_starts_[line - 1] + 1)};
+}
+
+SourceFile::~SourceFile() {
+    if (base_)
+        SourceManager::global().remove(base_);
+    if (!mapping_)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(mapping_);
+    CloseHandle(mapping_handle_);
+#else
+    ::munmap(mapping_, mapped_size_);
+#endif
+}
+} // namespace flux
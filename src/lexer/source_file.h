@@ -0,0 +1,79 @@
+#ifndef FLUX_SOURCE_FILE_H
+#define FLUX_SOURCE_FILE_H
+
+#include "source_location.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace flux {
+// The text of one source file. Regular files are memory-mapped read-only and lexed in
+// place; stdin, pipes and other non-regular files are read into an owned buffer. Tokens
+// and anything else holding views into text() must not outlive the SourceFile.
+//
+// Every SourceFile is registered with the SourceManager for as long as it is open, which
+// gives it a range of SourceLoc offsets starting at base().
+class SourceFile {
+  public:
+    // Opens `path`; "-" reads standard input. Throws std::runtime_error on failure.
+    static std::unique_ptr<SourceFile> open(const std::string& path);
+
+    // Wraps in-memory text (tests, tools, the stdin fallback).
+    static std::unique_ptr<SourceFile> from_string(std::string path, std::string contents);
+
+    ~SourceFile();
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+
+    const std::string& path() const {
+        return path_;
+    }
+
+    std::string_view text() const {
+        return text_;
+    }
+
+    bool is_mapped() const {
+        return mapping_ != nullptr;
+    }
+
+    std::uint32_t base() const {
+        return base_;
+    }
+
+    // The location of byte `offset`; `offset` may equal text().size() (end of file).
+    SourceLoc loc_at(std::size_t offset) const {
+        return {base_ + static_cast<std::uint32_t>(offset)};
+    }
+
+    // 1-based line and byte column of `offset`. The table of line starts is built by the
+    // first call, so files that never produce a diagnostic never pay for it.
+    PresumedLoc presumed(std::size_t offset) const;
+
+  private:
+    SourceFile() = default;
+
+    // Registers the file once text_ is final.
+    void finish();
+
+    std::string path_;
+    std::string_view text_;
+    std::string owned_;          // used when the file is not mapped
+    void* mapping_ = nullptr;    // base address of the mapped view
+    std::size_t mapped_size_ = 0;
+#ifdef _WIN32
+    void* mapping_handle_ = nullptr;
+#endif
+    std::uint32_t base_ = 0;
+
+    mutable std::once_flag lines_once_;
+    mutable std::vector<std::uint32_t> line_starts_;
+};
+} // namespace flux
+
+#endif // FLUX_SOURCE_FILE_H
@@ -0,0 +1,34 @@
+#ifndef FLUX_SOURCE_LOCATION_H
+#define FLUX_SOURCE_LOCATION_H
+
+#include <cstdint>
+#include <string>
+
+namespace flux {
+// A position in any loaded source file, as one 32-bit offset into a process-wide space in
+// which every SourceFile owns a disjoint range (see SourceManager). Tokens and AST nodes
+// store only this; the file, line and column are recovered when a diagnostic is printed.
+// Offset 0 never belongs to a file and means "unknown".
+struct SourceLoc {
+    std::uint32_t offset = 0;
+
+    bool valid() const {
+        return offset != 0;
+    }
+
+    friend bool operator==(SourceLoc a, SourceLoc b) {
+        return a.offset == b.offset;
+    }
+};
+
+// A SourceLoc resolved for display. Lines and columns are 1-based; columns count bytes.
+// `file` is empty and line/column are 0 when the location is unknown or its file has
+// been closed.
+struct PresumedLoc {
+    std::string file;
+    std::uint32_t line = 0;
+    std::uint32_t column = 0;
+};
+} // namespace flux
+
+#endif // FLUX_SOURCE_LOCATION_H
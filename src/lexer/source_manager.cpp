@@ -0,0 +1,79 @@
+#include "source_manager.h"
+#include "source_file.h"
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+
+namespace flux {
+// Never destroyed, so SourceFiles owned by static objects can unregister during exit.
+SourceManager& SourceManager::global() {
+    static SourceManager* manager = new SourceManager();
+    return *manager;
+}
+
+std::uint32_t SourceManager::add(const SourceFile& file) {
+    const std::uint64_t span = std::uint64_t{file.text().size()} + 1;
+    std::unique_lock lock(mutex_);
+    std::uint32_t base = 0;
+    if (span <= limit_ - next_base_) {
+        base = next_base_;
+        next_base_ += static_cast<std::uint32_t>(span);
+    } else {
+        // Out of fresh offsets: reuse the first closed range that is large enough.
+        auto it = std::find_if(freed_.begin(), freed_.end(),
+                               [&](const auto& range) { return range.second >= span; });
+        if (it == freed_.end())
+            throw std::runtime_error("flux: source locations exhausted at " + file.path());
+        base = it->first;
+        const std::uint32_t rest = it->second - static_cast<std::uint32_t>(span);
+        freed_.erase(it);
+        if (rest)
+            freed_.emplace(base + static_cast<std::uint32_t>(span), rest);
+    }
+    files_.emplace(base, Range{&file, static_cast<std::uint32_t>(span)});
+    return base;
+}
+
+void SourceManager::remove(std::uint32_t base) {
+    std::unique_lock lock(mutex_);
+    auto file = files_.find(base);
+    if (file == files_.end())
+        return;
+    std::uint32_t span = file->second.span;
+    files_.erase(file);
+
+    // Merge with the closed ranges on either side, so large files fit again later.
+    auto next = freed_.find(base + span);
+    if (next != freed_.end()) {
+        span += next->second;
+        freed_.erase(next);
+    }
+    auto it = freed_.emplace(base, span).first;
+    if (it != freed_.begin()) {
+        auto prev = std::prev(it);
+        if (prev->first + prev->second == base) {
+            prev->second += span;
+            freed_.erase(it);
+        }
+    }
+}
+
+PresumedLoc SourceManager::presumed(SourceLoc loc) const {
+    if (!loc.valid())
+        return {};
+    // Shared lock for the whole lookup: the file cannot be closed while its line table is
+    // being read.
+    std::shared_lock lock(mutex_);
+    auto it = files_.upper_bound(loc.offset);
+    if (it == files_.begin())
+        return {};
+    const auto& [base, range] = *std::prev(it);
+    const SourceFile& file = *range.file;
+    const std::size_t offset = loc.offset - base;
+    if (offset > file.text().size())
+        return {};
+    return file.presumed(offset);
+}
+} // namespace flux
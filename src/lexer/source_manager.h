@@ -0,0 +1,52 @@
+#ifndef FLUX_SOURCE_MANAGER_H
+#define FLUX_SOURCE_MANAGER_H
+
+#include "source_location.h"
+
+#include <cstdint>
+#include <map>
+#include <shared_mutex>
+
+namespace flux {
+class SourceFile;
+
+// Process-wide map from SourceLoc offsets back to the SourceFile they belong to. Each file
+// gets the next unused range of offsets when it is opened and leaves the map when it is
+// closed. Closed ranges are only handed out again once the offset space has run out, so
+// until then a stale location resolves to "unknown" rather than to the wrong file, and a
+// long-running process (`flux serve`) that keeps closing files never runs out.
+//
+// Thread-safe: files may be opened, closed and queried concurrently.
+class SourceManager {
+  public:
+    static SourceManager& global();
+
+    // `limit` is one past the last offset handed out; tests lower it.
+    explicit SourceManager(std::uint32_t limit = UINT32_MAX) : limit_(limit) {}
+
+    // Reserves text().size() + 1 offsets for `file`, so its end-of-file position has a
+    // location too, and returns the first. Throws std::runtime_error if no unused or
+    // closed range is large enough.
+    std::uint32_t add(const SourceFile& file);
+
+    // Closes the range starting at `base`, as returned by add().
+    void remove(std::uint32_t base);
+
+    // File, line and column of `loc`, or an empty PresumedLoc if it is unknown.
+    PresumedLoc presumed(SourceLoc loc) const;
+
+  private:
+    struct Range {
+        const SourceFile* file;
+        std::uint32_t span;
+    };
+
+    mutable std::shared_mutex mutex_;
+    std::map<std::uint32_t, Range> files_;         // keyed by base offset
+    std::map<std::uint32_t, std::uint32_t> freed_; // closed ranges, base -> span, coalesced
+    std::uint32_t next_base_ = 1;
+    std::uint32_t limit_;
+};
+} // namespace flux
+
+#endif // FLUX_SOURCE_MANAGER_H
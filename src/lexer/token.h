@@ -1,11 +1,16 @@
 #ifndef FLUX_TOKEN_H
 #define FLUX_TOKEN_H
 
+#include "keywords.h"
+#include "source_location.h"
+
 #include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace flux {
-enum class TokenKind {
+enum class TokenKind : std::uint8_t {
     Identifier,
     Number,
     String,
@@ -72,11 +77,23 @@ enum class TokenKind {
     EndOfFile,
 };
 
+// A token does not own its text: `lexeme` views either the source buffer held by the
+// Lexer that produced it or a string literal. Consumers that need to keep the text past
+// the lifetime of that buffer (AST nodes, symbol tables) copy it into a std::string.
+//
+// Members are ordered so a token packs into 24 bytes on 64-bit targets.
 struct Token {
-    TokenKind kind;
-    std::string lexeme;
-    std::size_t line;
-    std::size_t column;
+    std::string_view lexeme;
+    SourceLoc loc;
+    TokenKind kind = TokenKind::EndOfFile;
+    // Which keyword an Identifier-shaped token spelled (also set for pub/public/private/
+    // extern, which have their own kinds); Keyword::None otherwise.
+    Keyword keyword = Keyword::None;
+
+    Token() = default;
+    Token(TokenKind kind, std::string_view lexeme, SourceLoc loc = {},
+          Keyword keyword = Keyword::None)
+        : lexeme(lexeme), loc(loc), kind(kind), keyword(keyword) {}
 };
 
 inline const char* to_string(TokenKind kind) {
@@ -0,0 +1,69 @@
+#ifndef FLUX_TOKEN_STREAM_H
+#define FLUX_TOKEN_STREAM_H
+
+#include "lexer.h"
+#include "source_file.h"
+#include "token.h"
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flux {
+// A pull-based source of tokens for the parser. next() hands out tokens in source order;
+// after EndOfFile it keeps returning EndOfFile.
+class TokenStream {
+  public:
+    virtual ~TokenStream() = default;
+
+    virtual Token next() = 0;
+};
+
+// Replays an already lexed token vector (tests, tools that build tokens by hand).
+class VectorTokenStream final : public TokenStream {
+  public:
+    explicit VectorTokenStream(std::vector<Token> tokens) : tokens_(std::move(tokens)) {}
+
+    Token next() override {
+        if (position_ < tokens_.size())
+            return tokens_[position_++];
+        if (!tokens_.empty())
+            return tokens_.back();
+        return {TokenKind::EndOfFile, ""};
+    }
+
+  private:
+    std::vector<Token> tokens_;
+    std::size_t position_ = 0;
+};
+
+// Lexes on demand, so lexing and parsing run interleaved and no full token vector is ever
+// materialized. Lexer errors are sticky: a parser that backtracks over a failed lookahead
+// sees the same diagnostic again instead of lexing past the bad input.
+class LexerTokenStream final : public TokenStream {
+  public:
+    // Lexes `file` in place; the file must outlive the stream and the tokens.
+    explicit LexerTokenStream(const SourceFile& file) : lexer_(file) {}
+
+    // Lexes a private copy of `source`; the tokens must not outlive the stream.
+    explicit LexerTokenStream(std::string source) : lexer_(std::move(source)) {}
+
+    Token next() override {
+        if (error_)
+            std::rethrow_exception(error_);
+        try {
+            return lexer_.next_token();
+        } catch (...) {
+            error_ = std::current_exception();
+            throw;
+        }
+    }
+
+  private:
+    Lexer lexer_;
+    std::exception_ptr error_;
+};
+} // namespace flux
+
+#endif // FLUX_TOKEN_STREAM_H
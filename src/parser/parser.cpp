@@ -59,18 +59,54 @@ static int precedence(TokenKind kind) {
    Core helpers
    ======================= */
 
-Parser::Parser(std::vector<Token> tokens) : tokens_(std::move(tokens)) {}
+// Number tokens keep their '_' digit separators; literals stored in the AST do not.
+static std::string strip_digit_separators(std::string_view text) {
+    std::string digits;
+    digits.reserve(text.size());
+    for (char c : text) {
+        if (c != '_')
+            digits.push_back(c);
+    }
+    return digits;
+}
+
+Parser::Parser(std::vector<Token> tokens)
+    : Parser(std::make_unique<VectorTokenStream>(std::move(tokens))) {}
+
+Parser::Parser(std::unique_ptr<TokenStream> stream) : stream_(std::move(stream)) {}
+
+// Pulls tokens until absolute index `index` is buffered or EndOfFile has been seen.
+void Parser::fill(std::size_t index) const {
+    while (window_start_ + window_.size() <= index) {
+        if (!window_.empty() && window_.back().kind == TokenKind::EndOfFile)
+            return;
+        window_.push_back(stream_->next());
+        if (window_.size() > max_window_)
+            max_window_ = window_.size();
+    }
+}
 
 const Token& Parser::peek(std::size_t offset) const {
-    if (current_ + offset >= tokens_.size())
-        return tokens_.back();
-    return tokens_[current_ + offset];
+    const std::size_t index = current_ + offset;
+    fill(index);
+    if (index >= window_start_ + window_.size())
+        return window_.back();
+    return window_[index - window_start_];
 }
 
 const Token& Parser::advance() {
     if (!is_at_end())
         current_++;
-    return tokens_[current_ - 1];
+    return window_[current_ - 1 - window_start_];
+}
+
+// Called only between statements and declarations, where no Token reference or saved
+// position is live. The token just consumed is kept so advance() can still return it.
+void Parser::release_consumed() {
+    while (window_start_ + 1 < current_) {
+        window_.pop_front();
+        window_start_++;
+    }
 }
 
 bool Parser::is_at_end() const {
@@ -85,8 +121,12 @@ bool Parser::match(TokenKind kind) {
     return false;
 }
 
-bool Parser::match_keyword(const std::string& keyword) {
-    if (peek().kind == TokenKind::Keyword && peek().lexeme == keyword) {
+bool Parser::check_keyword(Keyword keyword) const {
+    return peek().kind == TokenKind::Keyword && peek().keyword == keyword;
+}
+
+bool Parser::match_keyword(Keyword keyword) {
+    if (check_keyword(keyword)) {
         advance();
         return true;
     }
@@ -97,7 +137,7 @@ const Token& Parser::expect(TokenKind kind, const char* message) {
     if (peek().kind == kind)
         return advance();
 
-    throw DiagnosticError(std::string(message), peek().line, peek().column);
+    throw DiagnosticError(std::string(message), peek().loc);
 }
 
 bool Parser::check_visibility() {
@@ -120,7 +160,7 @@ ast::Visibility Parser::parse_visibility() {
 ast::ExprPtr Parser::parse_primary() {
 
     const Token& tok = peek();
-    ast::ExprPtr expr;
+    ast::ExprPtr expr = nullptr;
     // Lambda/closure: |params| -> RetType { body }
     if (tok.kind == TokenKind::Pipe) {
         Token start = tok;
@@ -130,32 +170,31 @@ ast::ExprPtr Parser::parse_primary() {
         if (peek().kind != TokenKind::Pipe) {
             do {
                 const Token& param_tok = expect(TokenKind::Identifier, "expected parameter name");
-                std::string param_type;
+                ast::TypeExprPtr param_type = nullptr;
                 if (match(TokenKind::Colon)) {
                     param_type = parse_type();
                 } else {
-                    param_type = "Unknown";
+                    param_type = context_->make<ast::PathType>("Unknown");
                 }
-                params.emplace_back(param_tok.lexeme, param_type);
+                params.push_back({param_tok.lexeme, param_type});
             } while (match(TokenKind::Comma));
         }
         expect(TokenKind::Pipe, "expected '|' after lambda parameters");
         // Optional return type
-        std::string ret_type;
+        ast::TypeExprPtr ret_type = nullptr;
         if (peek().kind == TokenKind::Arrow) {
             advance(); // consume '->'
             ret_type = parse_type();
         } else {
-            ret_type = "Unknown";
+            ret_type = context_->make<ast::PathType>("Unknown");
         }
         // Body
         expect(TokenKind::LBrace, "expected '{' to start lambda body");
         ast::ExprPtr body = parse_expression(); // For now, parse a single expression as body
         expect(TokenKind::RBrace, "expected '}' after lambda body");
-        auto lambda = std::make_unique<ast::LambdaExpr>(std::move(params), std::move(ret_type),
-                                                        std::move(body));
-        lambda->line = start.line;
-        lambda->column = start.column;
+        auto lambda = context_->make<ast::LambdaExpr>(context_->list(std::move(params)),
+                                                      ret_type, body);
+        lambda->loc = start.loc;
         return lambda;
     }
 
@@ -167,30 +206,27 @@ ast::ExprPtr Parser::parse_primary() {
         advance();
 
         // Handle &mut
-        if (op == TokenKind::Amp && peek().kind == TokenKind::Keyword && peek().lexeme == "mut") {
+        if (op == TokenKind::Amp && check_keyword(Keyword::Mut)) {
             advance(); // consume 'mut'
             ast::ExprPtr operand = this->parse_expression(50);
-            auto unary = std::make_unique<ast::UnaryExpr>(op, std::move(operand), true);
-            unary->line = start.line;
-            unary->column = start.column;
+            auto unary = context_->make<ast::UnaryExpr>(op, std::move(operand), true);
+            unary->loc = start.loc;
             return unary;
         }
 
         ast::ExprPtr operand = this->parse_expression(50); // higher than any binary
-        auto unary = std::make_unique<ast::UnaryExpr>(op, std::move(operand), false);
-        unary->line = start.line;
-        unary->column = start.column;
+        auto unary = context_->make<ast::UnaryExpr>(op, std::move(operand), false);
+        unary->loc = start.loc;
         return unary;
     }
 
     // 'not' keyword as unary
-    if (tok.kind == TokenKind::Keyword && tok.lexeme == "not") {
+    if (tok.keyword == Keyword::Not) {
         Token start = tok;
         advance();
         ast::ExprPtr operand = this->parse_expression(50);
-        auto unary = std::make_unique<ast::UnaryExpr>(TokenKind::Bang, std::move(operand));
-        unary->line = start.line;
-        unary->column = start.column;
+        auto unary = context_->make<ast::UnaryExpr>(TokenKind::Bang, std::move(operand));
+        unary->loc = start.loc;
         return unary;
     }
 
@@ -211,9 +247,8 @@ ast::ExprPtr Parser::parse_primary() {
             // inherit location from inner expr? or set () location?
             // Usually grouping preserves inner expr location.
         } else {
-            auto tuple = std::make_unique<ast::TupleExpr>(std::move(elements));
-            tuple->line = start.line;
-            tuple->column = start.column;
+            auto tuple = context_->make<ast::TupleExpr>(context_->list(std::move(elements)));
+            tuple->loc = start.loc;
             expr = std::move(tuple);
         }
     }
@@ -229,147 +264,132 @@ ast::ExprPtr Parser::parse_primary() {
             }
         }
         expect(TokenKind::RBracket, "expected ']' after array literal");
-        expr = std::make_unique<ast::ArrayExpr>(std::move(elements));
-        expr->line = start.line;
-        expr->column = start.column;
+        expr = context_->make<ast::ArrayExpr>(context_->list(std::move(elements)));
+        expr->loc = start.loc;
     }
     // Literals
     else if (tok.kind == TokenKind::Number) {
         Token start = tok;
         advance();
-        expr = std::make_unique<ast::NumberExpr>(tok.lexeme);
-        expr->line = start.line;
-        expr->column = start.column;
+        expr = context_->make<ast::NumberExpr>(strip_digit_separators(start.lexeme));
+        expr->loc = start.loc;
     } else if (tok.kind == TokenKind::String) {
         Token start = tok;
         advance();
-        expr = std::make_unique<ast::StringExpr>(tok.lexeme);
-        expr->line = start.line;
-        expr->column = start.column;
+        expr = context_->make<ast::StringExpr>(std::string(start.lexeme));
+        expr->loc = start.loc;
     } else if (tok.kind == TokenKind::Char) {
         Token start = tok;
         advance();
-        expr = std::make_unique<ast::CharExpr>(tok.lexeme);
-        expr->line = start.line;
-        expr->column = start.column;
+        expr = context_->make<ast::CharExpr>(std::string(start.lexeme));
+        expr->loc = start.loc;
     }
     // Move
-    else if (tok.kind == TokenKind::Keyword && tok.lexeme == "move") {
+    else if (tok.keyword == Keyword::Move) {
         Token start = tok;
         advance();
-        auto mv = std::make_unique<ast::MoveExpr>(this->parse_expression(50));
-        mv->line = start.line;
-        mv->column = start.column;
+        auto mv = context_->make<ast::MoveExpr>(this->parse_expression(50));
+        mv->loc = start.loc;
         return mv;
     }
     // await
-    else if (tok.kind == TokenKind::Keyword && tok.lexeme == "await") {
+    else if (tok.keyword == Keyword::Await) {
         Token start = tok;
         advance();
-        auto aw = std::make_unique<ast::AwaitExpr>(this->parse_expression(50));
-        aw->line = start.line;
-        aw->column = start.column;
+        auto aw = context_->make<ast::AwaitExpr>(this->parse_expression(50));
+        aw->loc = start.loc;
         return aw;
     }
     // spawn
-    else if (tok.kind == TokenKind::Keyword && tok.lexeme == "spawn") {
+    else if (tok.keyword == Keyword::Spawn) {
         Token start = tok;
         advance();
-        auto sp = std::make_unique<ast::SpawnExpr>(this->parse_expression(50));
-        sp->line = start.line;
-        sp->column = start.column;
+        auto sp = context_->make<ast::SpawnExpr>(this->parse_expression(50));
+        sp->loc = start.loc;
         return sp;
     }
     // drop
-    else if (tok.kind == TokenKind::Keyword && tok.lexeme == "drop") {
+    else if (tok.keyword == Keyword::Drop) {
         advance();
         expect(TokenKind::LParen, "expected '(' after 'drop'");
         auto arg = parse_expression();
         expect(TokenKind::RParen, "expected ')' after drop argument");
-        auto callee = std::make_unique<ast::IdentifierExpr>("drop");
+        auto callee = context_->make<ast::IdentifierExpr>("drop");
         std::vector<ast::ExprPtr> args;
         args.push_back(std::move(arg));
-        expr = std::make_unique<ast::CallExpr>(std::move(callee), std::move(args));
+        expr = context_->make<ast::CallExpr>(std::move(callee), context_->list(std::move(args)));
     }
     // panic
     // panic
-    else if (tok.kind == TokenKind::Keyword && tok.lexeme == "panic") {
+    else if (tok.keyword == Keyword::Panic) {
         Token start = tok;
         advance();
         expect(TokenKind::LParen, "expected '(' after 'panic'");
         auto arg = parse_expression();
         expect(TokenKind::RParen, "expected ')' after panic argument");
-        auto callee = std::make_unique<ast::IdentifierExpr>("panic");
+        auto callee = context_->make<ast::IdentifierExpr>("panic");
         std::vector<ast::ExprPtr> args;
         args.push_back(std::move(arg));
-        auto call = std::make_unique<ast::CallExpr>(std::move(callee), std::move(args));
-        call->line = start.line;
-        call->column = start.column;
+        auto call = context_->make<ast::CallExpr>(callee, context_->list(std::move(args)));
+        call->loc = start.loc;
         expr = std::move(call);
     }
     // assert
-    else if (tok.kind == TokenKind::Keyword && tok.lexeme == "assert") {
+    else if (tok.keyword == Keyword::Assert) {
         Token start = tok;
         advance();
         expect(TokenKind::LParen, "expected '(' after 'assert'");
         auto arg = parse_expression();
         expect(TokenKind::RParen, "expected ')' after assert argument");
-        auto callee = std::make_unique<ast::IdentifierExpr>("assert");
+        auto callee = context_->make<ast::IdentifierExpr>("assert");
         std::vector<ast::ExprPtr> args;
         args.push_back(std::move(arg));
-        auto call = std::make_unique<ast::CallExpr>(std::move(callee), std::move(args));
-        call->line = start.line;
-        call->column = start.column;
+        auto call = context_->make<ast::CallExpr>(callee, context_->list(std::move(args)));
+        call->loc = start.loc;
         expr = std::move(call);
     }
     // Keywords (true/false/self/Self)
     else if (tok.kind == TokenKind::Keyword) {
-        if (tok.lexeme == "true") {
+        if (tok.keyword == Keyword::True) {
             Token start = tok;
             advance();
-            expr = std::make_unique<ast::BoolExpr>(true);
-            expr->line = start.line;
-            expr->column = start.column;
-        } else if (tok.lexeme == "false") {
+            expr = context_->make<ast::BoolExpr>(true);
+            expr->loc = start.loc;
+        } else if (tok.keyword == Keyword::False) {
             Token start = tok;
             advance();
-            expr = std::make_unique<ast::BoolExpr>(false);
-            expr->line = start.line;
-            expr->column = start.column;
-        } else if (tok.lexeme == "self") {
+            expr = context_->make<ast::BoolExpr>(false);
+            expr->loc = start.loc;
+        } else if (tok.keyword == Keyword::SelfValue) {
             Token start = tok;
             advance();
-            expr = std::make_unique<ast::IdentifierExpr>("self");
-            expr->line = start.line;
-            expr->column = start.column;
-        } else if (tok.lexeme == "Self") {
+            expr = context_->make<ast::IdentifierExpr>("self");
+            expr->loc = start.loc;
+        } else if (tok.keyword == Keyword::SelfType) {
             Token start = tok;
             advance();
-            expr = std::make_unique<ast::IdentifierExpr>("Self");
-            expr->line = start.line;
-            expr->column = start.column;
+            expr = context_->make<ast::IdentifierExpr>("Self");
+            expr->loc = start.loc;
         } else {
-            throw DiagnosticError("expected expression", tok.line, tok.column);
+            throw DiagnosticError("expected expression", tok.loc);
         }
     }
     // Identifiers
     else if (tok.kind == TokenKind::Identifier) {
         Token start = tok;
         advance();
-        expr = std::make_unique<ast::IdentifierExpr>(tok.lexeme);
-        expr->line = start.line;
-        expr->column = start.column;
+        expr = context_->make<ast::IdentifierExpr>(tok.lexeme);
+        expr->loc = start.loc;
     } else {
-        throw DiagnosticError("expected expression", tok.line, tok.column);
+        throw DiagnosticError("expected expression", tok.loc);
     }
 
     // Suffixes: ::, ., (, {, ?, as, [, slice
     while (true) {
         if (match(TokenKind::ColonColon)) {
-            uint32_t line = expr->line;
-            uint32_t col = expr->column;
-            std::string member =
-                expect(TokenKind::Identifier, "expected member name after '::'").lexeme;
+            SourceLoc loc = expr->loc;
+            std::string member(
+                expect(TokenKind::Identifier, "expected member name after '::'").lexeme);
             if (peek().kind == TokenKind::Less) {
                 // Peek ahead to see if it's a generic or just a Less operator
                 // Reuse logic from below or just call a helper
@@ -379,7 +399,7 @@ ast::ExprPtr Parser::parse_primary() {
                 bool is_generic = true;
                 try {
                     do {
-                        generic_part += parse_type();
+                        generic_part += ast::spelling(parse_type());
                         if (match(TokenKind::Comma))
                             generic_part += ", ";
                     } while (peek().kind != TokenKind::Greater && !is_at_end());
@@ -396,16 +416,14 @@ ast::ExprPtr Parser::parse_primary() {
                     current_ = saved;
             }
             auto bin =
-                std::make_unique<ast::BinaryExpr>(TokenKind::ColonColon, std::move(expr),
-                                                  std::make_unique<ast::IdentifierExpr>(member));
-            bin->line = line;
-            bin->column = col;
+                context_->make<ast::BinaryExpr>(TokenKind::ColonColon, std::move(expr),
+                                                  context_->make<ast::IdentifierExpr>(member));
+            bin->loc = loc;
             expr = std::move(bin);
         } else if (match(TokenKind::Dot)) {
-            uint32_t line = expr->line;
-            uint32_t col = expr->column;
-            std::string member =
-                expect(TokenKind::Identifier, "expected member name after '.'").lexeme;
+            SourceLoc loc = expr->loc;
+            std::string member(
+                expect(TokenKind::Identifier, "expected member name after '.'").lexeme);
             if (peek().kind == TokenKind::Less) {
                 std::size_t saved = current_;
                 advance(); // <
@@ -413,7 +431,7 @@ ast::ExprPtr Parser::parse_primary() {
                 bool is_generic = true;
                 try {
                     do {
-                        generic_part += parse_type();
+                        generic_part += ast::spelling(parse_type());
                         if (match(TokenKind::Comma))
                             generic_part += ", ";
                     } while (peek().kind != TokenKind::Greater && !is_at_end());
@@ -429,14 +447,12 @@ ast::ExprPtr Parser::parse_primary() {
                 if (!is_generic)
                     current_ = saved;
             }
-            auto bin = std::make_unique<ast::BinaryExpr>(
-                TokenKind::Dot, std::move(expr), std::make_unique<ast::IdentifierExpr>(member));
-            bin->line = line;
-            bin->column = col;
+            auto bin = context_->make<ast::BinaryExpr>(
+                TokenKind::Dot, std::move(expr), context_->make<ast::IdentifierExpr>(member));
+            bin->loc = loc;
             expr = std::move(bin);
         } else if (match(TokenKind::LParen)) {
-            uint32_t line = expr->line;
-            uint32_t col = expr->column;
+            SourceLoc loc = expr->loc;
             std::vector<ast::ExprPtr> args;
             if (peek().kind != TokenKind::RParen) {
                 do {
@@ -444,26 +460,22 @@ ast::ExprPtr Parser::parse_primary() {
                 } while (match(TokenKind::Comma));
             }
             expect(TokenKind::RParen, "expected ')' after arguments");
-            auto call = std::make_unique<ast::CallExpr>(std::move(expr), std::move(args));
-            call->line = line;
-            call->column = col;
+            auto call = context_->make<ast::CallExpr>(expr, context_->list(std::move(args)));
+            call->loc = loc;
             expr = std::move(call);
         } else if (match(TokenKind::Question)) {
             // Error propagation: expr?
-            uint32_t line = expr->line;
-            uint32_t col = expr->column;
-            auto prop = std::make_unique<ast::ErrorPropagationExpr>(std::move(expr));
-            prop->line = line;
-            prop->column = col;
+            SourceLoc loc = expr->loc;
+            auto prop = context_->make<ast::ErrorPropagationExpr>(std::move(expr));
+            prop->loc = loc;
             expr = std::move(prop);
         } else if (peek().kind == TokenKind::Less) {
             // Ambiguity: generic or less-than?
             // If it is generic, we replace expr with a new identifier?
             // Wait, this logic (lines 416-444) replaces expr if it's an IdentifierExpr.
             // If it replaces expr, the new expr should start at same location as old expr.
-            if (auto* id = dynamic_cast<ast::IdentifierExpr*>(expr.get())) {
-                uint32_t line = expr->line;
-                uint32_t col = expr->column;
+            if (auto* id = ast::dyn_cast<ast::IdentifierExpr>(expr)) {
+                SourceLoc loc = expr->loc;
                 std::string type = id->name;
                 std::size_t saved = current_;
                 advance(); // <
@@ -471,7 +483,7 @@ ast::ExprPtr Parser::parse_primary() {
                 bool is_generic = true;
                 try {
                     do {
-                        type += parse_type();
+                        type += ast::spelling(parse_type());
                         if (match(TokenKind::Comma))
                             type += ", ";
                     } while (peek().kind != TokenKind::Greater && !is_at_end());
@@ -485,9 +497,8 @@ ast::ExprPtr Parser::parse_primary() {
                     is_generic = false;
                 }
                 if (is_generic) {
-                    expr = std::make_unique<ast::IdentifierExpr>(type);
-                    expr->line = line;
-                    expr->column = col;
+                    expr = context_->make<ast::IdentifierExpr>(type);
+                    expr->loc = loc;
                 } else {
                     current_ = saved;
                     break;
@@ -503,13 +514,11 @@ ast::ExprPtr Parser::parse_primary() {
             // It uses `struct_name` from expr (identifier) or default.
             // `expr` is consumed.
             // The StructLiteral should start at `expr` location.
-            uint32_t line = expr->line;
-            uint32_t col = expr->column;
+            SourceLoc loc = expr->loc;
             advance(); // consume '{'
             std::vector<ast::FieldInit> fields;
             while (!match(TokenKind::RBrace)) {
-                const std::string field_name =
-                    expect(TokenKind::Identifier, "expected field name").lexeme;
+                const Name field_name = expect(TokenKind::Identifier, "expected field name").lexeme;
                 expect(TokenKind::Colon, "expected ':' after field name");
                 ast::ExprPtr value = parse_expression();
                 fields.push_back({field_name, std::move(value)});
@@ -517,29 +526,26 @@ ast::ExprPtr Parser::parse_primary() {
             }
 
             std::string struct_name;
-            if (auto* id = dynamic_cast<ast::IdentifierExpr*>(expr.get())) {
+            if (auto* id = ast::dyn_cast<ast::IdentifierExpr>(expr)) {
                 struct_name = id->name;
             } else {
                 struct_name = "<qualified-name>";
             }
 
-            auto lit = std::make_unique<ast::StructLiteralExpr>(struct_name, std::move(fields));
-            lit->line = line;
-            lit->column = col;
+            auto lit = context_->make<ast::StructLiteralExpr>(struct_name,
+                                                              context_->list(std::move(fields)));
+            lit->loc = loc;
             expr = std::move(lit);
-        } else if (peek().kind == TokenKind::Keyword && peek().lexeme == "as") {
-            uint32_t line = expr->line;
-            uint32_t col = expr->column;
+        } else if (check_keyword(Keyword::As)) {
+            SourceLoc loc = expr->loc;
             advance(); // consume 'as'
-            std::string target_type = parse_type();
-            auto cast = std::make_unique<ast::CastExpr>(std::move(expr), target_type);
-            cast->line = line;
-            cast->column = col;
+            ast::TypeExprPtr target_type = parse_type();
+            auto cast = context_->make<ast::CastExpr>(expr, target_type);
+            cast->loc = loc;
             expr = std::move(cast);
         } else if (peek().kind == TokenKind::LBracket) {
             // Index or Slice: expr[idx] or expr[start:end]
-            uint32_t line = expr->line;
-            uint32_t col = expr->column;
+            SourceLoc loc = expr->loc;
             advance(); // consume '['
 
             // Check if it's a slice (starts with colon or has colon after expression)
@@ -564,18 +570,16 @@ ast::ExprPtr Parser::parse_primary() {
             expect(TokenKind::RBracket, "expected ']' after index or slice");
 
             if (is_slice) {
-                auto slice = std::make_unique<ast::SliceExpr>(std::move(expr), std::move(start),
+                auto slice = context_->make<ast::SliceExpr>(std::move(expr), std::move(start),
                                                               std::move(end));
-                slice->line = line;
-                slice->column = col;
+                slice->loc = loc;
                 expr = std::move(slice);
             } else {
                 if (!start) {
-                    throw DiagnosticError("expected index expression", peek().line, peek().column);
+                    throw DiagnosticError("expected index expression", peek().loc);
                 }
-                auto index = std::make_unique<ast::IndexExpr>(std::move(expr), std::move(start));
-                index->line = line;
-                index->column = col;
+                auto index = context_->make<ast::IndexExpr>(std::move(expr), std::move(start));
+                index->loc = loc;
                 expr = std::move(index);
             }
         } else {
@@ -595,10 +599,10 @@ ast::ExprPtr Parser::parse_expression(int min_prec) {
 
         // Handle 'and' / 'or' keyword operators
         if (peek().kind == TokenKind::Keyword) {
-            if (peek().lexeme == "and") {
+            if (peek().keyword == Keyword::And) {
                 op = TokenKind::AmpAmp;
                 prec = precedence(TokenKind::AmpAmp);
-            } else if (peek().lexeme == "or") {
+            } else if (peek().keyword == Keyword::Or) {
                 op = TokenKind::PipePipe;
                 prec = precedence(TokenKind::PipePipe);
             }
@@ -611,11 +615,9 @@ ast::ExprPtr Parser::parse_expression(int min_prec) {
 
         ast::ExprPtr right = parse_expression(prec + 1);
 
-        uint32_t line = left->line;
-        uint32_t col = left->column;
-        left = std::make_unique<ast::BinaryExpr>(op, std::move(left), std::move(right));
-        left->line = line;
-        left->column = col;
+        SourceLoc loc = left->loc;
+        left = context_->make<ast::BinaryExpr>(op, std::move(left), std::move(right));
+        left->loc = loc;
     }
 
     return left;
@@ -627,18 +629,21 @@ ast::ExprPtr Parser::parse_expression(int min_prec) {
 
 ast::Module Parser::parse_module() {
     ast::Module module;
+    module.context = context_;
 
-    if (peek().kind == TokenKind::Keyword && peek().lexeme == "module") {
+    if (check_keyword(Keyword::Module)) {
         advance();
         module.name = parse_module_path();
         expect(TokenKind::Semicolon, "expected ';' after module declaration");
     }
 
-    while (peek().kind == TokenKind::Keyword && peek().lexeme == "import") {
+    while (check_keyword(Keyword::Import)) {
         module.imports.push_back(parse_import());
     }
 
     while (!is_at_end()) {
+        release_consumed();
+
         // Skip annotations
         while (peek().kind == TokenKind::Annotation) {
             advance();
@@ -647,55 +652,55 @@ ast::Module Parser::parse_module() {
         ast::Visibility visibility = parse_visibility();
 
         if (peek().kind == TokenKind::Keyword) {
-            if (peek().lexeme == "async") {
+            if (peek().keyword == Keyword::Async) {
                 advance();
-                if (peek().kind == TokenKind::Keyword && peek().lexeme == "func") {
+                if (check_keyword(Keyword::Func)) {
                     module.functions.push_back(parse_function(visibility, true));
                     continue;
                 }
-                throw DiagnosticError("expected 'func' after 'async'", peek().line, peek().column);
+                throw DiagnosticError("expected 'func' after 'async'", peek().loc);
             }
-            if (peek().lexeme == "func") {
+            if (peek().keyword == Keyword::Func) {
                 module.functions.push_back(parse_function(visibility));
                 continue;
             }
-            if (peek().lexeme == "struct") {
+            if (peek().keyword == Keyword::Struct) {
                 module.structs.push_back(parse_struct_declaration(visibility));
                 continue;
             }
-            if (peek().lexeme == "class") {
+            if (peek().keyword == Keyword::Class) {
                 module.classes.push_back(parse_class_declaration(visibility));
                 continue;
             }
-            if (peek().lexeme == "enum") {
+            if (peek().keyword == Keyword::Enum) {
                 module.enums.push_back(parse_enum_declaration(visibility));
                 continue;
             }
-            if (peek().lexeme == "impl") {
+            if (peek().keyword == Keyword::Impl) {
                 module.impls.push_back(parse_impl_block());
                 continue;
             }
-            if (peek().lexeme == "trait") {
+            if (peek().keyword == Keyword::Trait) {
                 module.traits.push_back(parse_trait_declaration(visibility));
                 continue;
             }
-            if (peek().lexeme == "type") {
+            if (peek().keyword == Keyword::Type) {
                 module.type_aliases.push_back(parse_type_alias(visibility));
                 continue;
             }
         }
         if (peek().kind == TokenKind::Extern) {
             advance();
-            if (peek().kind == TokenKind::Keyword && peek().lexeme == "func") {
+            if (check_keyword(Keyword::Func)) {
                 module.functions.push_back(parse_function(visibility, false, true));
                 continue;
             }
-            throw DiagnosticError("expected 'func' after 'extern'", peek().line, peek().column);
+            throw DiagnosticError("expected 'func' after 'extern'", peek().loc);
         }
         throw DiagnosticError(
             "expected top-level declaration, found: " + std::string(to_string(peek().kind)) +
-                " ('" + peek().lexeme + "')",
-            peek().line, peek().column);
+                " ('" + std::string(peek().lexeme) + "')",
+            peek().loc);
     }
 
     return module;
@@ -716,7 +721,7 @@ ast::Import Parser::parse_import() {
 }
 
 std::string Parser::parse_module_path() {
-    std::string path = expect(TokenKind::Identifier, "expected module name").lexeme;
+    std::string path(expect(TokenKind::Identifier, "expected module name").lexeme);
     while (match(TokenKind::ColonColon)) {
         path += "::";
         path += expect(TokenKind::Identifier, "expected name after '::'").lexeme;
@@ -743,15 +748,15 @@ ast::FunctionDecl Parser::parse_function(ast::Visibility visibility, bool is_asy
     expect(TokenKind::LParen, "expected '('");
     if (peek().kind != TokenKind::RParen) {
         do {
-            std::string param_name;
-            if (peek().kind == TokenKind::Keyword && peek().lexeme == "self") {
+            Name param_name;
+            if (check_keyword(Keyword::SelfValue)) {
                 param_name = "self";
                 advance();
                 // self doesn't need a type annotation
                 if (match(TokenKind::Colon)) {
                     fn.params.push_back({param_name, parse_type()});
                 } else {
-                    fn.params.push_back({param_name, "Self"});
+                    fn.params.push_back({param_name, context_->make<ast::PathType>("Self")});
                 }
             } else {
                 param_name = expect(TokenKind::Identifier, "expected parameter name").lexeme;
@@ -765,7 +770,7 @@ ast::FunctionDecl Parser::parse_function(ast::Visibility visibility, bool is_asy
     if (match(TokenKind::Arrow)) {
         fn.return_type = parse_type();
     } else {
-        fn.return_type = "Void";
+        fn.return_type = context_->make<ast::PathType>("Void");
     }
 
     fn.where_clause = parse_where_clause();
@@ -790,10 +795,12 @@ ast::Block Parser::parse_block() {
     ast::Block block;
     expect(TokenKind::LBrace, "expected '{'");
 
+    std::vector<ast::StmtPtr> statements;
     while (!match(TokenKind::RBrace)) {
-        block.statements.push_back(parse_statement());
+        statements.push_back(parse_statement());
     }
 
+    block.statements = context_->list(std::move(statements));
     return block;
 }
 
@@ -802,47 +809,49 @@ ast::Block Parser::parse_block() {
    ======================= */
 
 ast::StmtPtr Parser::parse_statement() {
+    release_consumed();
+
     if (peek().kind == TokenKind::Keyword) {
-        if (peek().lexeme == "let" || peek().lexeme == "const") {
+        if (peek().keyword == Keyword::Let || peek().keyword == Keyword::Const) {
             return parse_let_statement();
         }
-        if (peek().lexeme == "return") {
+        if (peek().keyword == Keyword::Return) {
             advance();
-            ast::ExprPtr expr;
+            ast::ExprPtr expr = nullptr;
             if (peek().kind != TokenKind::Semicolon) {
                 expr = parse_expression();
             }
             expect(TokenKind::Semicolon, "expected ';' after return");
-            return std::make_unique<ast::ReturnStmt>(std::move(expr));
+            return context_->make<ast::ReturnStmt>(std::move(expr));
         }
-        if (peek().lexeme == "if") {
+        if (peek().keyword == Keyword::If) {
             return parse_if_statement();
         }
-        if (peek().lexeme == "while") {
+        if (peek().keyword == Keyword::While) {
             return parse_while_statement();
         }
-        if (peek().lexeme == "for") {
+        if (peek().keyword == Keyword::For) {
             return parse_for_statement();
         }
-        if (peek().lexeme == "loop") {
+        if (peek().keyword == Keyword::Loop) {
             return parse_loop_statement();
         }
-        if (peek().lexeme == "match") {
+        if (peek().keyword == Keyword::Match) {
             return parse_match_statement();
         }
-        if (peek().lexeme == "break") {
+        if (peek().keyword == Keyword::Break) {
             advance();
             ast::ExprPtr value = nullptr;
             if (peek().kind != TokenKind::Semicolon) {
                 value = parse_expression();
             }
             expect(TokenKind::Semicolon, "expected ';' after 'break'");
-            return std::make_unique<ast::BreakStmt>(std::move(value));
+            return context_->make<ast::BreakStmt>(std::move(value));
         }
-        if (peek().lexeme == "continue") {
+        if (peek().keyword == Keyword::Continue) {
             advance();
             expect(TokenKind::Semicolon, "expected ';' after 'continue'");
-            return std::make_unique<ast::ContinueStmt>();
+            return context_->make<ast::ContinueStmt>();
         }
     }
 
@@ -853,9 +862,8 @@ ast::StmtPtr Parser::parse_statement() {
 
     if (peek().kind == TokenKind::LBrace) {
         Token start = peek();
-        auto block_stmt = std::make_unique<ast::BlockStmt>();
-        block_stmt->line = start.line;
-        block_stmt->column = start.column;
+        auto block_stmt = context_->make<ast::BlockStmt>();
+        block_stmt->loc = start.loc;
         block_stmt->block = parse_block();
         return block_stmt;
     }
@@ -879,7 +887,7 @@ ast::StmtPtr Parser::parse_statement() {
             advance(); // consume assignment operator
             ast::ExprPtr value = parse_expression();
             expect(TokenKind::Semicolon, "expected ';' after assignment");
-            return std::make_unique<ast::AssignStmt>(std::move(target), std::move(value), op);
+            return context_->make<ast::AssignStmt>(std::move(target), std::move(value), op);
         }
     }
 
@@ -897,16 +905,14 @@ ast::StmtPtr Parser::parse_statement() {
         ast::ExprPtr value = parse_expression();
         expect(TokenKind::Semicolon, "expected ';' after assignment");
         auto stmt =
-            std::make_unique<ast::AssignStmt>(std::move(expr), std::move(value), op_token.kind);
-        stmt->line = start.line;
-        stmt->column = start.column;
+            context_->make<ast::AssignStmt>(std::move(expr), std::move(value), op_token.kind);
+        stmt->loc = start.loc;
         return stmt;
     }
 
     expect(TokenKind::Semicolon, "expected ';' after expression");
-    auto stmt = std::make_unique<ast::ExprStmt>(std::move(expr));
-    stmt->line = start.line;
-    stmt->column = start.column;
+    auto stmt = context_->make<ast::ExprStmt>(std::move(expr));
+    stmt->loc = start.loc;
     return stmt;
 }
 
@@ -915,19 +921,19 @@ ast::StmtPtr Parser::parse_let_statement() {
     bool is_const = false;
     bool is_mutable = false;
 
-    if (peek().lexeme == "const") {
+    if (peek().keyword == Keyword::Const) {
         advance();
         is_const = true;
     } else {
         expect(TokenKind::Keyword, "expected 'let'");
-        if (peek().kind == TokenKind::Keyword && peek().lexeme == "mut") {
+        if (check_keyword(Keyword::Mut)) {
             advance();
             is_mutable = true;
         }
     }
 
-    std::vector<std::string> tuple_names;
-    std::string name;
+    std::vector<Name> tuple_names;
+    Name name;
     if (match(TokenKind::LParen)) {
         // Tuple destructuring: let (x, y): (T, U) = ...;
         do {
@@ -938,25 +944,24 @@ ast::StmtPtr Parser::parse_let_statement() {
     } else {
         name = expect(TokenKind::Identifier, "expected variable name").lexeme;
     }
-    std::string type_name;
     expect(TokenKind::Colon, "expected ':'");
-    type_name = parse_type();
+    ast::TypeExprPtr type = parse_type();
     ast::ExprPtr initializer = nullptr;
     if (match(TokenKind::Assign)) {
         initializer = parse_expression();
     }
     expect(TokenKind::Semicolon, "expected ';'");
 
-    std::unique_ptr<ast::LetStmt> stmt;
+    ast::LetStmt* stmt = nullptr;
     if (!tuple_names.empty()) {
-        stmt = std::make_unique<ast::LetStmt>(std::move(tuple_names), std::move(type_name),
-                                              is_mutable, is_const, std::move(initializer));
+        stmt = context_->make<ast::LetStmt>(context_->list(std::move(tuple_names)),
+                                            type, is_mutable, is_const,
+                                            initializer);
     } else {
-        stmt = std::make_unique<ast::LetStmt>(std::move(name), std::move(type_name), is_mutable,
-                                              is_const, std::move(initializer));
+        stmt = context_->make<ast::LetStmt>(name, type, is_mutable, is_const,
+                                            initializer);
     }
-    stmt->line = start.line;
-    stmt->column = start.column;
+    stmt->loc = start.loc;
     return stmt;
 }
 
@@ -967,15 +972,14 @@ ast::StmtPtr Parser::parse_if_statement() {
     ast::StmtPtr then_branch = parse_statement();
     ast::StmtPtr else_branch = nullptr;
 
-    if (peek().kind == TokenKind::Keyword && peek().lexeme == "else") {
+    if (check_keyword(Keyword::Else)) {
         advance();
         else_branch = parse_statement();
     }
 
-    auto stmt = std::make_unique<ast::IfStmt>(std::move(condition), std::move(then_branch),
+    auto stmt = context_->make<ast::IfStmt>(std::move(condition), std::move(then_branch),
                                               std::move(else_branch));
-    stmt->line = start.line;
-    stmt->column = start.column;
+    stmt->loc = start.loc;
     return stmt;
 }
 
@@ -984,32 +988,31 @@ ast::StmtPtr Parser::parse_while_statement() {
     ast::ExprPtr condition = parse_expression();
     ast::StmtPtr body = parse_statement();
 
-    return std::make_unique<ast::WhileStmt>(std::move(condition), std::move(body));
+    return context_->make<ast::WhileStmt>(std::move(condition), std::move(body));
 }
 
 ast::StmtPtr Parser::parse_for_statement() {
     Token start = peek();
     expect(TokenKind::Keyword, "expected 'for'");
 
-    std::string var_name = expect(TokenKind::Identifier, "expected loop variable name").lexeme;
+    const Name var_name = expect(TokenKind::Identifier, "expected loop variable name").lexeme;
 
-    std::string var_type;
+    ast::TypeExprPtr var_type = nullptr;
     if (match(TokenKind::Colon)) {
         var_type = parse_type();
     }
 
-    if (!(peek().kind == TokenKind::Keyword && peek().lexeme == "in")) {
-        throw DiagnosticError("expected 'in' after for loop variable", peek().line, peek().column);
+    if (!check_keyword(Keyword::In)) {
+        throw DiagnosticError("expected 'in' after for loop variable", peek().loc);
     }
     advance(); // consume 'in'
 
     ast::ExprPtr iterable = parse_expression();
     ast::StmtPtr body = parse_statement();
 
-    auto stmt = std::make_unique<ast::ForStmt>(std::move(var_name), std::move(var_type),
+    auto stmt = context_->make<ast::ForStmt>(std::move(var_name), var_type,
                                                std::move(iterable), std::move(body));
-    stmt->line = start.line;
-    stmt->column = start.column;
+    stmt->loc = start.loc;
     return stmt;
 }
 
@@ -1017,9 +1020,8 @@ ast::StmtPtr Parser::parse_loop_statement() {
     Token start = peek();
     expect(TokenKind::Keyword, "expected 'loop'");
     ast::StmtPtr body = parse_statement();
-    auto stmt = std::make_unique<ast::LoopStmt>(std::move(body));
-    stmt->line = start.line;
-    stmt->column = start.column;
+    auto stmt = context_->make<ast::LoopStmt>(std::move(body));
+    stmt->loc = start.loc;
     return stmt;
 }
 
@@ -1034,25 +1036,24 @@ ast::StmtPtr Parser::parse_match_statement() {
         ast::PatternPtr pattern = parse_pattern();
 
         // Optional match guard: `if <condition>`
-        ast::ExprPtr guard;
-        if (peek().kind == TokenKind::Keyword && peek().lexeme == "if") {
+        ast::ExprPtr guard = nullptr;
+        if (check_keyword(Keyword::If)) {
             advance(); // consume 'if'
             guard = parse_expression();
         }
 
         expect(TokenKind::FatArrow, "expected '=>' after pattern");
 
-        ast::StmtPtr body;
+        ast::StmtPtr body = nullptr;
         if (peek().kind == TokenKind::LBrace) {
             Token body_start = peek();
-            body = std::make_unique<ast::BlockStmt>();
-            body->line = body_start.line; // Wait, BlockStmt doesn't have line/col? It inherits from
-                                          // Stmt -> Node. Yes.
-            body->column = body_start.column;
-            dynamic_cast<ast::BlockStmt*>(body.get())->block = parse_block();
+            body = context_->make<ast::BlockStmt>();
+            body->loc = body_start.loc; // Wait, BlockStmt doesn't have a loc? It inherits from
+                                        // Stmt -> Node. Yes.
+            ast::cast<ast::BlockStmt>(body)->block = parse_block();
         } else {
             body =
-                std::make_unique<ast::ExprStmt>(parse_expression()); // ExprStmt needs location too?
+                context_->make<ast::ExprStmt>(parse_expression()); // ExprStmt needs location too?
             // Usually ExprStmt takes expression location? No, statement location.
             // But parse_expression() returns expr with location.
             // ExprStmt wraps it. Ideally ExprStmt has same location as Expr?
@@ -1061,8 +1062,8 @@ ast::StmtPtr Parser::parse_match_statement() {
             // But parse_expression() consumes tokens.
             // I can't easily peek start of expression without parse_expression returning location.
             // But `body` here is StmtPtr.
-            // I can set `body->line` to `expression->line`?
-            // `Expr` inherits `Node` so it has `line`.
+            // I can set `body->loc` to `expression->loc`?
+            // `Expr` inherits `Node` so it has `loc`.
             // Yes.
         }
 
@@ -1075,16 +1076,14 @@ ast::StmtPtr Parser::parse_match_statement() {
         /*
         if (peek().kind == TokenKind::LBrace) {
              Token body_start = peek();
-             auto bs = std::make_unique<ast::BlockStmt>();
-             bs->line = body_start.line;
-             bs->column = body_start.column;
+             auto bs = context_->make<ast::BlockStmt>();
+             bs->loc = body_start.loc;
              bs->block = parse_block();
              body = std::move(bs);
         } else {
              Token body_start = peek();
-             auto es = std::make_unique<ast::ExprStmt>(parse_expression());
-             es->line = body_start.line;
-             es->column = body_start.column;
+             auto es = context_->make<ast::ExprStmt>(parse_expression());
+             es->loc = body_start.loc;
              body = std::move(es);
         }
         */
@@ -1093,9 +1092,8 @@ ast::StmtPtr Parser::parse_match_statement() {
         match(TokenKind::Comma); // Optional comma after arm
     }
 
-    auto stmt = std::make_unique<ast::MatchStmt>(std::move(expression), std::move(arms));
-    stmt->line = start.line;
-    stmt->column = start.column;
+    auto stmt = context_->make<ast::MatchStmt>(expression, context_->list(std::move(arms)));
+    stmt->loc = start.loc;
     return stmt;
 }
 
@@ -1107,7 +1105,7 @@ ast::PatternPtr Parser::parse_pattern() {
         while (match(TokenKind::Pipe)) {
             alternatives.push_back(parse_range_pattern());
         }
-        return std::make_unique<ast::OrPattern>(std::move(alternatives));
+        return context_->make<ast::OrPattern>(context_->list(std::move(alternatives)));
     }
     return pat;
 }
@@ -1118,16 +1116,15 @@ ast::PatternPtr Parser::parse_range_pattern() {
         bool inclusive = (advance().kind == TokenKind::DotDotEqual);
         auto end = parse_pattern_atom();
 
-        auto* start_lit = dynamic_cast<ast::LiteralPattern*>(pat.get());
-        auto* end_lit = dynamic_cast<ast::LiteralPattern*>(end.get());
+        auto* start_lit = ast::dyn_cast<ast::LiteralPattern>(pat);
+        auto* end_lit = ast::dyn_cast<ast::LiteralPattern>(end);
 
         if (!start_lit || !end_lit) {
-            throw DiagnosticError("range pattern bounds must be literals", peek().line,
-                                  peek().column);
+            throw DiagnosticError("range pattern bounds must be literals", peek().loc);
         }
 
-        return std::make_unique<ast::RangePattern>(std::move(start_lit->literal),
-                                                   std::move(end_lit->literal), inclusive);
+        return context_->make<ast::RangePattern>(std::move(start_lit->literal),
+                                                 std::move(end_lit->literal), inclusive);
     }
     return pat;
 }
@@ -1144,32 +1141,33 @@ ast::PatternPtr Parser::parse_pattern_atom() {
             } while (match(TokenKind::Comma));
         }
         expect(TokenKind::RParen, "expected ')' after tuple pattern");
-        return std::make_unique<ast::TuplePattern>(std::move(elements));
+        return context_->make<ast::TuplePattern>(context_->list(std::move(elements)));
     }
 
     if (tok.kind == TokenKind::Number || tok.kind == TokenKind::String ||
-        tok.kind == TokenKind::Char ||
-        (tok.kind == TokenKind::Keyword && (tok.lexeme == "true" || tok.lexeme == "false"))) {
-        return std::make_unique<ast::LiteralPattern>(parse_primary());
+        tok.kind == TokenKind::Char || tok.keyword == Keyword::True ||
+        tok.keyword == Keyword::False) {
+        return context_->make<ast::LiteralPattern>(parse_primary());
     }
 
     // Negative number pattern
     if (tok.kind == TokenKind::Minus && peek(1).kind == TokenKind::Number) {
         advance(); // consume '-'
         auto num = parse_primary();
-        auto neg = std::make_unique<ast::UnaryExpr>(TokenKind::Minus, std::move(num));
-        return std::make_unique<ast::LiteralPattern>(std::move(neg));
+        auto neg = context_->make<ast::UnaryExpr>(TokenKind::Minus, std::move(num));
+        return context_->make<ast::LiteralPattern>(std::move(neg));
     }
 
     if (tok.kind == TokenKind::Identifier) {
         if (tok.lexeme == "_") {
             advance();
-            return std::make_unique<ast::WildcardPattern>();
+            return context_->make<ast::WildcardPattern>();
         }
 
-        std::string name = advance().lexeme;
+        std::string name(advance().lexeme);
         if (match(TokenKind::ColonColon)) {
-            name += "::" + expect(TokenKind::Identifier, "expected variant name").lexeme;
+            name += "::";
+            name += expect(TokenKind::Identifier, "expected variant name").lexeme;
             std::vector<ast::PatternPtr> sub_patterns;
             if (match(TokenKind::LParen)) {
                 if (peek().kind != TokenKind::RParen) {
@@ -1179,7 +1177,8 @@ ast::PatternPtr Parser::parse_pattern_atom() {
                 }
                 expect(TokenKind::RParen, "expected ')' after variant patterns");
             }
-            return std::make_unique<ast::VariantPattern>(name, std::move(sub_patterns));
+            return context_->make<ast::VariantPattern>(name,
+                                                       context_->list(std::move(sub_patterns)));
         }
 
         if (peek().kind == TokenKind::LParen) {
@@ -1191,34 +1190,34 @@ ast::PatternPtr Parser::parse_pattern_atom() {
                 } while (match(TokenKind::Comma));
             }
             expect(TokenKind::RParen, "expected ')' after variant patterns");
-            return std::make_unique<ast::VariantPattern>(name, std::move(sub_patterns));
+            return context_->make<ast::VariantPattern>(name,
+                                                       context_->list(std::move(sub_patterns)));
         }
 
         if (peek().kind == TokenKind::LBrace) {
             advance(); // {
             std::vector<ast::FieldPattern> fields;
             while (!match(TokenKind::RBrace)) {
-                const std::string field_name =
-                    expect(TokenKind::Identifier, "expected field name").lexeme;
+                const Name field_name = expect(TokenKind::Identifier, "expected field name").lexeme;
                 expect(TokenKind::Colon, "expected ':' after field name");
                 ast::PatternPtr pat = parse_pattern();
                 fields.push_back({field_name, std::move(pat)});
                 match(TokenKind::Comma);
             }
-            return std::make_unique<ast::StructPattern>(name, std::move(fields));
+            return context_->make<ast::StructPattern>(name, context_->list(std::move(fields)));
         }
 
-        return std::make_unique<ast::IdentifierPattern>(name);
+        return context_->make<ast::IdentifierPattern>(name);
     }
 
-    throw DiagnosticError("expected pattern", tok.line, tok.column);
+    throw DiagnosticError("expected pattern", tok.loc);
 }
 
 ast::StructDecl Parser::parse_struct_declaration(ast::Visibility visibility) {
     expect(TokenKind::Keyword, "expected 'struct'");
-    const std::string name = expect(TokenKind::Identifier, "expected struct name").lexeme;
+    const Name name = expect(TokenKind::Identifier, "expected struct name").lexeme;
     std::vector<std::string> type_params = parse_type_params();
-    std::string where_clause = parse_where_clause();
+    ast::WhereClause where_clause = parse_where_clause();
     expect(TokenKind::LBrace, "expected '{'");
 
     std::vector<ast::Field> fields;
@@ -1228,10 +1227,9 @@ ast::StructDecl Parser::parse_struct_declaration(ast::Visibility visibility) {
             field_visibility = parse_visibility();
         }
 
-        const std::string field_name = expect(TokenKind::Identifier, "expected field name").lexeme;
+        const Name field_name = expect(TokenKind::Identifier, "expected field name").lexeme;
         expect(TokenKind::Colon, "expected ':'");
-        std::string field_type = parse_type();
-        fields.push_back({field_name, std::move(field_type), field_visibility});
+        fields.push_back({field_name, parse_type(), field_visibility});
         match(TokenKind::Comma);
     }
 
@@ -1243,9 +1241,9 @@ ast::StructDecl Parser::parse_struct_declaration(ast::Visibility visibility) {
 
 ast::ClassDecl Parser::parse_class_declaration(ast::Visibility visibility) {
     expect(TokenKind::Keyword, "expected 'class'");
-    const std::string name = expect(TokenKind::Identifier, "expected class name").lexeme;
+    const Name name = expect(TokenKind::Identifier, "expected class name").lexeme;
     std::vector<std::string> type_params = parse_type_params();
-    std::string where_clause = parse_where_clause();
+    ast::WhereClause where_clause = parse_where_clause();
     expect(TokenKind::LBrace, "expected '{'");
 
     std::vector<ast::Field> fields;
@@ -1255,10 +1253,9 @@ ast::ClassDecl Parser::parse_class_declaration(ast::Visibility visibility) {
             field_visibility = parse_visibility();
         }
 
-        const std::string field_name = expect(TokenKind::Identifier, "expected field name").lexeme;
+        const Name field_name = expect(TokenKind::Identifier, "expected field name").lexeme;
         expect(TokenKind::Colon, "expected ':'");
-        std::string field_type = parse_type();
-        fields.push_back({field_name, std::move(field_type), field_visibility});
+        fields.push_back({field_name, parse_type(), field_visibility});
         match(TokenKind::Comma);
     }
 
@@ -1270,16 +1267,15 @@ ast::ClassDecl Parser::parse_class_declaration(ast::Visibility visibility) {
 
 ast::EnumDecl Parser::parse_enum_declaration(ast::Visibility visibility) {
     expect(TokenKind::Keyword, "expected 'enum'");
-    const std::string name = expect(TokenKind::Identifier, "expected enum name").lexeme;
+    const Name name = expect(TokenKind::Identifier, "expected enum name").lexeme;
     std::vector<std::string> type_params = parse_type_params();
-    std::string where_clause = parse_where_clause();
+    ast::WhereClause where_clause = parse_where_clause();
     expect(TokenKind::LBrace, "expected '{'");
 
     std::vector<ast::Variant> variants;
     while (!match(TokenKind::RBrace)) {
-        const std::string variant_name =
-            expect(TokenKind::Identifier, "expected variant name").lexeme;
-        std::vector<std::string> types;
+        const Name variant_name = expect(TokenKind::Identifier, "expected variant name").lexeme;
+        std::vector<ast::TypeExprPtr> types;
         if (match(TokenKind::LParen)) {
             if (peek().kind != TokenKind::RParen) {
                 do {
@@ -1301,22 +1297,23 @@ ast::EnumDecl Parser::parse_enum_declaration(ast::Visibility visibility) {
 ast::ImplBlock Parser::parse_impl_block() {
     expect(TokenKind::Keyword, "expected 'impl'");
     std::vector<std::string> type_params = parse_type_params();
-    const std::string name = parse_type();
+    // The impl header stays textual: trait and target names key the resolver's impl tables.
+    const std::string name = ast::spelling(parse_type());
 
     std::string trait_name;
-    if (peek().kind == TokenKind::Keyword && peek().lexeme == "for") {
+    if (check_keyword(Keyword::For)) {
         trait_name = name;
         advance();
     }
 
     std::string target_name;
     if (!trait_name.empty()) {
-        target_name = parse_type();
+        target_name = ast::spelling(parse_type());
     } else {
         target_name = name;
     }
 
-    std::string where_clause = parse_where_clause();
+    ast::WhereClause where_clause = parse_where_clause();
 
     expect(TokenKind::LBrace, "expected '{'");
 
@@ -1328,18 +1325,18 @@ ast::ImplBlock Parser::parse_impl_block() {
             method_visibility = parse_visibility();
         }
 
-        if (peek().kind == TokenKind::Keyword && peek().lexeme == "type") {
+        if (check_keyword(Keyword::Type)) {
             advance(); // consume 'type'
-            std::string type_name = expect(TokenKind::Identifier, "expected type name").lexeme;
+            const Name type_name = expect(TokenKind::Identifier, "expected type name").lexeme;
             expect(TokenKind::Assign, "expected '='");
-            std::string target_type = parse_type();
+            ast::TypeExprPtr target_type = parse_type();
             expect(TokenKind::Semicolon, "expected ';'");
             associated_types.push_back(ast::AssociatedType(type_name, target_type));
             continue;
         }
 
         bool is_async_method = false;
-        if (peek().kind == TokenKind::Keyword && peek().lexeme == "async") {
+        if (check_keyword(Keyword::Async)) {
             advance();
             is_async_method = true;
         }
@@ -1356,20 +1353,20 @@ ast::ImplBlock Parser::parse_impl_block() {
 
 ast::TraitDecl Parser::parse_trait_declaration(ast::Visibility visibility) {
     expect(TokenKind::Keyword, "expected 'trait'");
-    const std::string name = expect(TokenKind::Identifier, "expected trait name").lexeme;
+    const Name name = expect(TokenKind::Identifier, "expected trait name").lexeme;
     std::vector<std::string> type_params = parse_type_params();
 
-    std::string where_clause = parse_where_clause();
+    ast::WhereClause where_clause = parse_where_clause();
 
     expect(TokenKind::LBrace, "expected '{'");
 
     std::vector<ast::FunctionDecl> methods;
     std::vector<ast::AssociatedType> associated_types;
     while (!match(TokenKind::RBrace)) {
-        if (peek().kind == TokenKind::Keyword && peek().lexeme == "type") {
+        if (check_keyword(Keyword::Type)) {
             advance(); // consume 'type'
-            std::string type_name = expect(TokenKind::Identifier, "expected type name").lexeme;
-            std::string default_type;
+            const Name type_name = expect(TokenKind::Identifier, "expected type name").lexeme;
+            ast::TypeExprPtr default_type = nullptr;
             if (match(TokenKind::Assign)) {
                 default_type = parse_type();
             }
@@ -1389,12 +1386,12 @@ ast::TraitDecl Parser::parse_trait_declaration(ast::Visibility visibility) {
 
 ast::TypeAlias Parser::parse_type_alias(ast::Visibility visibility) {
     expect(TokenKind::Keyword, "expected 'type'");
-    const std::string name = expect(TokenKind::Identifier, "expected type alias name").lexeme;
+    const Name name = expect(TokenKind::Identifier, "expected type alias name").lexeme;
     expect(TokenKind::Assign, "expected '='");
-    std::string target = parse_type();
+    ast::TypeExprPtr target = parse_type();
     expect(TokenKind::Semicolon, "expected ';' after type alias");
 
-    auto alias = ast::TypeAlias{name, std::move(target)};
+    auto alias = ast::TypeAlias{name, target};
     alias.visibility = visibility;
     return alias;
 }
@@ -1403,8 +1400,7 @@ std::vector<std::string> Parser::parse_type_params() {
     std::vector<std::string> params;
     if (match(TokenKind::Less)) {
         do {
-            std::string param =
-                expect(TokenKind::Identifier, "expected type parameter name").lexeme;
+            std::string param(expect(TokenKind::Identifier, "expected type parameter name").lexeme);
             // Optional trait bound: T: Ord + Display
             if (match(TokenKind::Colon)) {
                 param += ": ";
@@ -1421,95 +1417,104 @@ std::vector<std::string> Parser::parse_type_params() {
     return params;
 }
 
-std::string Parser::parse_where_clause() {
-    if (!(peek().kind == TokenKind::Keyword && peek().lexeme == "where"))
-        return "";
+ast::WhereClause Parser::parse_where_clause() {
+    ast::WhereClause clause;
+    if (!check_keyword(Keyword::Where))
+        return clause;
 
     advance(); // consume 'where'
-    std::string clause;
-
-    while (peek().kind != TokenKind::LBrace && peek().kind != TokenKind::Semicolon &&
-           !is_at_end()) {
-        if (!clause.empty())
-            clause += " ";
-        clause += peek().lexeme;
-        advance();
-    }
+    // T: Trait + Other, U: Trait
+    do {
+        const Token& tok = peek();
+        if (tok.kind != TokenKind::Identifier && tok.kind != TokenKind::Keyword)
+            throw DiagnosticError("expected type parameter name in where clause", tok.loc);
+        ast::WherePredicate predicate{Name(advance().lexeme), {}};
+        expect(TokenKind::Colon, "expected ':' after type parameter in where clause");
+        do {
+            predicate.bounds.push_back(parse_type());
+        } while (match(TokenKind::Plus));
+        clause.push_back(std::move(predicate));
+    } while (match(TokenKind::Comma) && peek().kind != TokenKind::LBrace);
     return clause;
 }
 
-std::string Parser::parse_type() {
-    std::string type;
+ast::TypeExprPtr Parser::parse_type() {
+    const SourceLoc loc = peek().loc;
+    ast::TypeExprPtr type = nullptr;
     if (match(TokenKind::Amp)) {
-        type = "&";
-        if (peek().kind == TokenKind::Keyword && peek().lexeme == "mut") {
+        bool is_mut = false;
+        if (check_keyword(Keyword::Mut)) {
             advance();
-            type += "mut ";
+            is_mut = true;
         }
-        type += parse_type();
+        type = context_->make<ast::RefType>(is_mut, parse_type());
+        type->loc = loc;
         return type;
     }
 
     // Array type: [T; N] or Slice type: [T]
     if (peek().kind == TokenKind::LBracket) {
         advance();
-        std::string element_type = parse_type();
+        ast::TypeExprPtr element_type = parse_type();
+        std::string length;
         if (match(TokenKind::Semicolon)) {
             Token size_tok = expect(TokenKind::Number, "expected array size");
             expect(TokenKind::RBracket, "expected ']' after array size");
-            return "[" + element_type + ";" + size_tok.lexeme + "]";
+            length = strip_digit_separators(size_tok.lexeme);
         } else {
             expect(TokenKind::RBracket, "expected ']' after element type");
-            return "[" + element_type + "]";
         }
+        type = context_->make<ast::ArrayType>(element_type, std::move(length));
+        type->loc = loc;
+        return type;
     }
 
-    // Tuple type: (T1, T2, ...)
+    // Tuple type: (T1, T2, ...) or function type: (T1, T2) -> R
     if (peek().kind == TokenKind::LParen) {
         advance();
-        type = "(";
+        std::vector<ast::TypeExprPtr> elements;
         if (peek().kind != TokenKind::RParen) {
             do {
-                type += parse_type();
-                if (peek().kind == TokenKind::Comma) {
-                    type += ", ";
+                elements.push_back(parse_type());
+                if (peek().kind == TokenKind::Comma)
                     advance();
-                }
             } while (peek().kind != TokenKind::RParen && !is_at_end());
         }
         expect(TokenKind::RParen, "expected ')'");
-        type += ")";
 
         if (match(TokenKind::Arrow)) {
-            type += " -> ";
-            type += parse_type();
+            ast::TypeExprPtr ret = parse_type();
+            type = context_->make<ast::FunctionType>(context_->list(std::move(elements)), ret);
+        } else {
+            type = context_->make<ast::TupleType>(context_->list(std::move(elements)));
         }
-
+        type->loc = loc;
         return type;
     }
 
     const Token& tok = peek();
     if (tok.kind == TokenKind::Keyword || tok.kind == TokenKind::Identifier) {
-        type = advance().lexeme;
+        std::string path(advance().lexeme);
         while (match(TokenKind::ColonColon)) {
-            type += "::" + expect(TokenKind::Identifier, "expected name after '::'").lexeme;
+            path += "::";
+            path += expect(TokenKind::Identifier, "expected name after '::'").lexeme;
         }
 
+        std::vector<ast::TypeExprPtr> args;
         if (match(TokenKind::Less)) {
-            type += "<";
             do {
-                type += parse_type();
-                if (peek().kind == TokenKind::Comma) {
-                    type += ", ";
+                args.push_back(parse_type());
+                if (peek().kind == TokenKind::Comma)
                     advance();
-                }
             } while (peek().kind != TokenKind::Greater && !is_at_end());
-            type += expect(TokenKind::Greater, "expected '>'").lexeme;
+            expect(TokenKind::Greater, "expected '>'");
         }
 
+        type = context_->make<ast::PathType>(path, context_->list(std::move(args)));
+        type->loc = loc;
         return type;
     }
 
-    throw DiagnosticError("expected type name", tok.line, tok.column);
+    throw DiagnosticError("expected type name", tok.loc);
 }
 } // namespace flux
@@ -3,15 +3,39 @@
 
 #include "ast/ast.h"
 #include "lexer/token.h"
+#include "lexer/token_stream.h"
+#include <deque>
+#include <memory>
 #include <vector>
 
 namespace flux {
 class Parser {
   public:
     explicit Parser(std::vector<Token> tokens);
+
+    // Parses tokens pulled from `stream` on demand. Only the tokens of the statement or
+    // declaration being parsed, plus any lookahead, are buffered at a time.
+    explicit Parser(std::unique_ptr<TokenStream> stream);
+
     ast::ExprPtr parse_expression(int min_prec = 0);
     ast::Module parse_module();
 
+    // The arena every node is allocated in. parse_module() shares it with the returned
+    // Module; nodes from parse_expression() live as long as the Parser or the context.
+    const std::shared_ptr<ast::AstContext>& context() const {
+        return context_;
+    }
+
+    // Largest number of tokens buffered at once so far.
+    std::size_t max_buffered_tokens() const {
+        return max_window_;
+    }
+
+    // Tokens pulled from the stream so far.
+    std::size_t tokens_read() const {
+        return window_start_ + window_.size();
+    }
+
   private:
     /* =======================
        Core token navigation
@@ -20,11 +44,17 @@ class Parser {
 
     const Token& advance();
 
+    void fill(std::size_t index) const;
+
+    void release_consumed();
+
     bool is_at_end() const;
 
     bool match(TokenKind kind);
 
-    bool match_keyword(const std::string& keyword);
+    bool check_keyword(Keyword keyword) const;
+
+    bool match_keyword(Keyword keyword);
 
     const Token& expect(TokenKind kind, const char* message);
 
@@ -51,8 +81,8 @@ class Parser {
     ast::TypeAlias parse_type_alias(ast::Visibility visibility = ast::Visibility::None);
 
     std::vector<std::string> parse_type_params();
-    std::string parse_type();
-    std::string parse_where_clause();
+    ast::TypeExprPtr parse_type();
+    ast::WhereClause parse_where_clause();
     ast::Block parse_block();
 
     ast::StmtPtr parse_statement();
@@ -75,7 +105,15 @@ class Parser {
     ast::Visibility parse_visibility();
 
   private:
-    std::vector<Token> tokens_;
+    std::shared_ptr<ast::AstContext> context_ = std::make_shared<ast::AstContext>();
+
+    // Tokens are addressed by absolute index so that saving and restoring current_ works
+    // for backtracking. window_ holds indices [window_start_, window_start_ + size());
+    // a deque keeps references to buffered tokens valid while more are pulled in.
+    std::unique_ptr<TokenStream> stream_;
+    mutable std::deque<Token> window_;
+    mutable std::size_t max_window_ = 0;
+    std::size_t window_start_ = 0;
     std::size_t current_ = 0;
 };
 } // namespace flux
@@ -0,0 +1,159 @@
+#ifndef FLUX_FLOW_STATE_H
+#define FLUX_FLOW_STATE_H
+
+#include "symbol.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace flux::semantic {
+
+// The flow-sensitive state of the variables in scope: whether each is definitely
+// initialized, moved from, or mutably borrowed, and how many shared borrows it has.
+// Scope::declare numbers variables densely in declaration order (Symbol::local), and a number
+// is reused once its scope exits, so the flags are one bit per live variable in each of three
+// bit vectors. Saving the state at a branch copies a few words, and merging two branches is a
+// word-wide AND (initialized) or OR (moved, borrowed) rather than a walk of the scope chain.
+//
+// Nothing here writes to a Symbol, so variables in scopes shared between resolvers (the
+// global scopes, during parallel body resolution) are only read.
+class FlowState {
+  public:
+    // The state of every variable at one point in a function, to restore or merge later.
+    struct Snapshot {
+        uint32_t size = 0;
+        std::vector<uint64_t> initialized;
+        std::vector<uint64_t> moved;
+        std::vector<uint64_t> mutably_borrowed;
+        std::vector<uint32_t> borrows;
+    };
+
+    // Numbers a new variable, with the state it is declared in.
+    uint32_t add(bool initialized, bool moved) {
+        const uint32_t local = bits_.size++;
+        if (words(bits_.size) > bits_.initialized.size()) {
+            bits_.initialized.push_back(0);
+            bits_.moved.push_back(0);
+            bits_.mutably_borrowed.push_back(0);
+        }
+        set(bits_.initialized, local, initialized);
+        set(bits_.moved, local, moved);
+        set(bits_.mutably_borrowed, local, false);
+        bits_.borrows.push_back(0);
+        return local;
+    }
+
+    uint32_t size() const {
+        return bits_.size;
+    }
+
+    // Forgets the variables numbered `size` and up, whose scopes have exited.
+    void truncate(uint32_t size) {
+        bits_.size = size;
+        bits_.initialized.resize(words(size));
+        bits_.moved.resize(words(size));
+        bits_.mutably_borrowed.resize(words(size));
+        bits_.borrows.resize(size);
+    }
+
+    Snapshot save() const {
+        return bits_;
+    }
+
+    // Returns the variables in both `state` and the current scopes to their state in
+    // `state`. Variables declared since, in the same scope, keep theirs.
+    void restore(const Snapshot& state) {
+        const uint32_t n = std::min(state.size, bits_.size);
+        copy_prefix(bits_.initialized, state.initialized, n);
+        copy_prefix(bits_.moved, state.moved, n);
+        copy_prefix(bits_.mutably_borrowed, state.mutably_borrowed, n);
+        std::copy_n(state.borrows.begin(), n, bits_.borrows.begin());
+    }
+
+    // Merges in the state at the end of another branch that reaches the same point: a
+    // variable is initialized only if it is on both paths, and moved or borrowed if it is on
+    // either.
+    void meet(const Snapshot& state) {
+        const uint32_t n = std::min(state.size, bits_.size);
+        for (std::size_t w = 0; w < words(n); ++w) {
+            const uint64_t mask = prefix_mask(n, w);
+            bits_.initialized[w] &= state.initialized[w] | ~mask;
+            bits_.moved[w] |= state.moved[w] & mask;
+            bits_.mutably_borrowed[w] |= state.mutably_borrowed[w] & mask;
+        }
+        for (uint32_t i = 0; i < n; ++i)
+            bits_.borrows[i] = std::max(bits_.borrows[i], state.borrows[i]);
+    }
+
+    // Symbols without a number (functions and other non-variables) keep the state they
+    // were declared with; the setters ignore them.
+    bool initialized(const Symbol& sym) const {
+        return sym.local == Symbol::kNoLocal ? sym.is_initialized
+                                             : test(bits_.initialized, sym.local);
+    }
+    void set_initialized(const Symbol& sym, bool value) {
+        if (sym.local != Symbol::kNoLocal)
+            set(bits_.initialized, sym.local, value);
+    }
+
+    bool moved(const Symbol& sym) const {
+        return sym.local == Symbol::kNoLocal ? sym.is_moved : test(bits_.moved, sym.local);
+    }
+    void set_moved(const Symbol& sym, bool value) {
+        if (sym.local != Symbol::kNoLocal)
+            set(bits_.moved, sym.local, value);
+    }
+
+    bool mutably_borrowed(const Symbol& sym) const {
+        return sym.local != Symbol::kNoLocal && test(bits_.mutably_borrowed, sym.local);
+    }
+    void set_mutably_borrowed(const Symbol& sym) {
+        if (sym.local != Symbol::kNoLocal)
+            set(bits_.mutably_borrowed, sym.local, true);
+    }
+
+    // Shared borrows of the variable.
+    uint32_t borrow_count(const Symbol& sym) const {
+        return sym.local == Symbol::kNoLocal ? 0 : bits_.borrows[sym.local];
+    }
+    void add_borrow(const Symbol& sym) {
+        if (sym.local != Symbol::kNoLocal)
+            ++bits_.borrows[sym.local];
+    }
+
+  private:
+    static std::size_t words(uint32_t bits) {
+        return (bits + 63) / 64;
+    }
+
+    // The bits of word `w` that belong to the first `n` variables.
+    static uint64_t prefix_mask(uint32_t n, std::size_t w) {
+        const std::size_t end = std::size_t(n) - w * 64;
+        return end >= 64 ? ~uint64_t(0) : (uint64_t(1) << end) - 1;
+    }
+
+    static bool test(const std::vector<uint64_t>& v, uint32_t i) {
+        return (v[i / 64] >> (i % 64)) & 1;
+    }
+    static void set(std::vector<uint64_t>& v, uint32_t i, bool value) {
+        const uint64_t bit = uint64_t(1) << (i % 64);
+        if (value)
+            v[i / 64] |= bit;
+        else
+            v[i / 64] &= ~bit;
+    }
+
+    static void copy_prefix(std::vector<uint64_t>& dst, const std::vector<uint64_t>& src,
+                            uint32_t n) {
+        for (std::size_t w = 0; w < words(n); ++w) {
+            const uint64_t mask = prefix_mask(n, w);
+            dst[w] = (dst[w] & ~mask) | (src[w] & mask);
+        }
+    }
+
+    Snapshot bits_;
+};
+
+} // namespace flux::semantic
+
+#endif // FLUX_FLOW_STATE_H
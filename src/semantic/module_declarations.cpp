@@ -0,0 +1,472 @@
+#include "module_declarations.h"
+
+#include <stdexcept>
+
+namespace flux::semantic {
+namespace {
+constexpr std::string_view kMagic = "FLXD";
+
+// The nodes of a module that a record can point to, numbered in one fixed walk of its
+// declarations. Both ends of a round trip walk their own copy of the AST the same way.
+class NodeIndex {
+  public:
+    explicit NodeIndex(const ast::Module& module) {
+        for (const auto& fn : module.functions)
+            add(fn);
+        for (const auto& s : module.structs) {
+            for (const auto& field : s.fields)
+                add(field.type);
+        }
+        for (const auto& c : module.classes) {
+            for (const auto& field : c.fields)
+                add(field.type);
+        }
+        for (const auto& alias : module.type_aliases)
+            add(alias.target_type);
+        for (const auto& impl : module.impls) {
+            for (const auto& assoc : impl.associated_types)
+                add(assoc.default_type);
+            for (const auto& method : impl.methods)
+                add(method);
+        }
+    }
+
+    // Node `position` - 1, which must be of the kind asked for: one of the other kind means
+    // the record does not fit this module. Position 0 is null.
+    const ast::TypeExpr* type(std::uint64_t position) const {
+        return static_cast<const ast::TypeExpr*>(node(position, false));
+    }
+    const ast::FunctionDecl* function(std::uint64_t position) const {
+        return static_cast<const ast::FunctionDecl*>(node(position, true));
+    }
+
+    // Every node's position, for writing. A node reached twice keeps the first.
+    std::unordered_map<const void*, std::uint64_t> positions() const {
+        std::unordered_map<const void*, std::uint64_t> positions;
+        positions.reserve(nodes_.size());
+        for (std::size_t i = 0; i < nodes_.size(); ++i)
+            positions.try_emplace(nodes_[i].node, i + 1);
+        return positions;
+    }
+
+  private:
+    struct Node {
+        const void* node;
+        bool function;
+    };
+
+    void add(const ast::FunctionDecl& fn) {
+        nodes_.push_back({&fn, true});
+        add(fn.return_type);
+        for (const auto& param : fn.params)
+            add(param.type);
+    }
+    void add(const ast::TypeExpr* type) {
+        if (type)
+            nodes_.push_back({type, false});
+    }
+
+    const void* node(std::uint64_t position, bool function) const {
+        if (position == 0)
+            return nullptr;
+        if (position > nodes_.size() || nodes_[position - 1].function != function)
+            throw std::runtime_error("node position out of range");
+        return nodes_[position - 1].node;
+    }
+
+    std::vector<Node> nodes_;
+};
+
+// Integers are LEB128 varints, as in the AST encoding.
+class Writer {
+  public:
+    explicit Writer(const ast::Module& module) : positions_(NodeIndex(module).positions()) {}
+
+    std::optional<std::string> write(const ModuleDeclarations& record) {
+        out_.append(kMagic);
+        uint(record.context);
+        log(record.enum_variants, &Writer::strings);
+        log(record.struct_fields, &Writer::fields);
+        log(record.class_fields, &Writer::fields);
+        log(record.type_aliases, &Writer::type);
+        log(record.module_aliases, &Writer::alias);
+        log(record.trait_methods, &Writer::trait_methods);
+        log(record.trait_impls, &Writer::str);
+        log(record.function_type_params, &Writer::strings);
+        log(record.type_type_params, &Writer::strings);
+        log(record.trait_type_params, &Writer::strings);
+        log(record.trait_associated_types, &Writer::strings);
+        uint(record.impl_associated_types.size());
+        for (const auto& [key, types] : record.impl_associated_types) {
+            str(key.first);
+            str(key.second);
+            uint(types.size());
+            for (const auto& [name, type] : types) {
+                str(name);
+                this->type(type);
+            }
+        }
+        log(record.function_decls, &Writer::function);
+        uint(record.symbols.size());
+        for (const auto& declared : record.symbols) {
+            flag(declared.global);
+            symbol(declared.symbol);
+        }
+        uint(record.type_instantiations.size());
+        for (const auto& inst : record.type_instantiations) {
+            str(inst.name.str());
+            uint(inst.args.size());
+            for (TypeId arg : inst.args)
+                type_id(arg);
+        }
+        if (!ok_)
+            return std::nullopt;
+        return std::move(out_);
+    }
+
+  private:
+    void uint(std::uint64_t value) {
+        while (value >= 0x80) {
+            out_.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out_.push_back(static_cast<char>(value));
+    }
+    void flag(bool value) {
+        out_.push_back(value ? 1 : 0);
+    }
+    void str(const std::string& text) {
+        uint(text.size());
+        out_.append(text);
+    }
+    void strings(const std::vector<std::string>& items) {
+        uint(items.size());
+        for (const auto& item : items)
+            str(item);
+    }
+    void visibility(ast::Visibility value) {
+        out_.push_back(static_cast<char>(value));
+    }
+
+    // 0 for null, otherwise the node's position in the NodeIndex.
+    void node(const void* node) {
+        if (!node) {
+            uint(0);
+            return;
+        }
+        auto it = positions_.find(node);
+        ok_ = ok_ && it != positions_.end();
+        uint(it != positions_.end() ? it->second : 0);
+    }
+    void type(const ast::TypeExpr* const& type) {
+        node(type);
+    }
+    void function(const ast::FunctionDecl* const& fn) {
+        node(fn);
+    }
+
+    void fields(const std::vector<FieldInfo>& fields) {
+        uint(fields.size());
+        for (const auto& field : fields) {
+            str(field.name);
+            type(field.type);
+            visibility(field.visibility);
+        }
+    }
+    void alias(const std::pair<std::string, std::string>& alias) {
+        str(alias.first);
+        str(alias.second);
+    }
+    void trait_methods(const std::vector<TraitMethodSig>& sigs) {
+        uint(sigs.size());
+        for (const auto& sig : sigs) {
+            str(sig.name);
+            str(sig.self_type);
+            strings(sig.param_types);
+            str(sig.return_type);
+            flag(sig.has_default);
+            visibility(sig.visibility);
+            str(sig.module_name);
+        }
+    }
+
+    void symbol(const Symbol& sym) {
+        str(sym.name.str());
+        out_.push_back(static_cast<char>(sym.kind));
+        flag(sym.is_mutable);
+        flag(sym.is_const);
+        flag(sym.is_moved);
+        flag(sym.is_initialized);
+        str(sym.borrowed_symbol_name.str());
+        uint(sym.scope_depth);
+        visibility(sym.visibility);
+        flag(sym.is_async);
+        str(sym.module_name);
+        str(sym.type);
+        strings(sym.param_types);
+        type(sym.type_expr);
+        uint(sym.param_type_exprs.size());
+        for (const ast::TypeExpr* param : sym.param_type_exprs)
+            type(param);
+    }
+
+    void type_id(TypeId type) {
+        out_.push_back(static_cast<char>(type->kind));
+        str(type->name);
+        flag(type->is_mut_ref);
+        uint(type->param_types.size());
+        for (TypeId param : type->param_types)
+            type_id(param);
+        type_id_or_unknown(type->return_type);
+        uint(type->generic_args.size());
+        for (TypeId arg : type->generic_args)
+            type_id(arg);
+    }
+    // The unknown type ends the recursion: its own return type is itself.
+    void type_id_or_unknown(TypeId type) {
+        flag(type != TypeId());
+        if (type != TypeId())
+            type_id(type);
+    }
+
+    template <typename Value>
+    void log(const ModuleDeclarations::Log<Value>& entries,
+             void (Writer::*value)(const Value&)) {
+        uint(entries.size());
+        for (const auto& [key, item] : entries) {
+            str(key);
+            (this->*value)(item);
+        }
+    }
+
+    std::unordered_map<const void*, std::uint64_t> positions_;
+    std::string out_;
+    bool ok_ = true;
+};
+
+class Reader {
+  public:
+    Reader(std::string_view bytes, const ast::Module& module) : bytes_(bytes), index_(module) {}
+
+    ModuleDeclarations read() {
+        if (bytes_.substr(0, kMagic.size()) != kMagic)
+            fail("not a declaration record");
+        pos_ = kMagic.size();
+        ModuleDeclarations record;
+        record.context = uint();
+        log(record.enum_variants, &Reader::strings);
+        log(record.struct_fields, &Reader::fields);
+        log(record.class_fields, &Reader::fields);
+        log(record.type_aliases, &Reader::type);
+        log(record.module_aliases, &Reader::alias);
+        log(record.trait_methods, &Reader::trait_methods);
+        log(record.trait_impls, &Reader::str);
+        log(record.function_type_params, &Reader::strings);
+        log(record.type_type_params, &Reader::strings);
+        log(record.trait_type_params, &Reader::strings);
+        log(record.trait_associated_types, &Reader::strings);
+        record.impl_associated_types.resize(count());
+        for (auto& [key, types] : record.impl_associated_types) {
+            key.first = str();
+            key.second = str();
+            for (std::size_t n = count(); n > 0; --n) {
+                std::string name = str();
+                types[std::move(name)] = type();
+            }
+        }
+        log(record.function_decls, &Reader::function);
+        record.symbols.resize(count());
+        for (auto& declared : record.symbols) {
+            declared.global = flag();
+            declared.symbol = symbol();
+        }
+        record.type_instantiations.resize(count());
+        for (auto& inst : record.type_instantiations) {
+            inst.name = Name(view());
+            inst.args.resize(count());
+            for (TypeId& arg : inst.args)
+                arg = type_id();
+        }
+        if (pos_ != bytes_.size())
+            fail("trailing bytes");
+        return record;
+    }
+
+  private:
+    [[noreturn]] static void fail(const char* what) {
+        throw std::runtime_error(what);
+    }
+
+    std::uint8_t u8() {
+        if (pos_ >= bytes_.size())
+            fail("truncated");
+        return static_cast<std::uint8_t>(bytes_[pos_++]);
+    }
+    std::uint64_t uint() {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const std::uint8_t byte = u8();
+            value |= std::uint64_t{byte & 0x7Fu} << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        fail("varint too long");
+    }
+    // Every element takes at least one byte, which bounds a count by what is left.
+    std::size_t count() {
+        const std::uint64_t n = uint();
+        if (n > bytes_.size() - pos_)
+            fail("count past end");
+        return static_cast<std::size_t>(n);
+    }
+    bool flag() {
+        const std::uint8_t value = u8();
+        if (value > 1)
+            fail("bad flag");
+        return value != 0;
+    }
+    std::string str() {
+        const std::size_t n = count();
+        std::string text(bytes_.substr(pos_, n));
+        pos_ += n;
+        return text;
+    }
+    // A string read in place, for one that is interned rather than kept.
+    std::string_view view() {
+        const std::size_t n = count();
+        const std::string_view text = bytes_.substr(pos_, n);
+        pos_ += n;
+        return text;
+    }
+    std::vector<std::string> strings() {
+        std::vector<std::string> items(count());
+        for (auto& item : items)
+            item = str();
+        return items;
+    }
+    ast::Visibility visibility() {
+        const std::uint8_t value = u8();
+        if (value > static_cast<std::uint8_t>(ast::Visibility::Private))
+            fail("bad visibility");
+        return static_cast<ast::Visibility>(value);
+    }
+
+    const ast::TypeExpr* type() {
+        return index_.type(uint());
+    }
+    const ast::FunctionDecl* function() {
+        return index_.function(uint());
+    }
+
+    std::vector<FieldInfo> fields() {
+        std::vector<FieldInfo> fields(count());
+        for (auto& field : fields) {
+            field.name = str();
+            field.type = type();
+            field.visibility = visibility();
+        }
+        return fields;
+    }
+    std::pair<std::string, std::string> alias() {
+        std::string alias = str();
+        return {std::move(alias), str()};
+    }
+    std::vector<TraitMethodSig> trait_methods() {
+        std::vector<TraitMethodSig> sigs(count());
+        for (auto& sig : sigs) {
+            sig.name = str();
+            sig.self_type = str();
+            sig.param_types = strings();
+            sig.return_type = str();
+            sig.has_default = flag();
+            sig.visibility = visibility();
+            sig.module_name = str();
+        }
+        return sigs;
+    }
+
+    Symbol symbol() {
+        Symbol sym;
+        sym.name = Name(view());
+        const std::uint8_t kind = u8();
+        if (kind > static_cast<std::uint8_t>(SymbolKind::Function))
+            fail("bad symbol kind");
+        sym.kind = static_cast<SymbolKind>(kind);
+        sym.is_mutable = flag();
+        sym.is_const = flag();
+        sym.is_moved = flag();
+        sym.is_initialized = flag();
+        sym.borrowed_symbol_name = Name(view());
+        sym.scope_depth = static_cast<uint32_t>(uint());
+        sym.visibility = visibility();
+        sym.is_async = flag();
+        sym.module_name = str();
+        sym.type = str();
+        sym.param_types = strings();
+        sym.type_expr = type();
+        sym.param_type_exprs.resize(count());
+        for (const ast::TypeExpr*& param : sym.param_type_exprs)
+            param = type();
+        return sym;
+    }
+
+    TypeId type_id() {
+        const std::uint8_t kind = u8();
+        if (kind > static_cast<std::uint8_t>(TypeKind::Generic))
+            fail("bad type kind");
+        std::string name = str();
+        const bool is_mut_ref = flag();
+        std::vector<TypeId> params(count());
+        for (TypeId& param : params)
+            param = type_id();
+        const TypeId return_type = flag() ? type_id() : TypeId();
+        std::vector<TypeId> args(count());
+        for (TypeId& arg : args)
+            arg = type_id();
+        return TypeId(static_cast<TypeKind>(kind), std::move(name), is_mut_ref,
+                      std::move(params), return_type, std::move(args));
+    }
+
+    template <typename Value>
+    void log(ModuleDeclarations::Log<Value>& entries, Value (Reader::*value)()) {
+        entries.resize(count());
+        for (auto& [key, item] : entries) {
+            key = str();
+            item = (this->*value)();
+        }
+    }
+
+    std::string_view bytes_;
+    std::size_t pos_ = 0;
+    NodeIndex index_;
+};
+} // namespace
+
+std::optional<std::string> serialize(const ModuleDeclarations& record, const ast::Module& module) {
+    return Writer(module).write(record);
+}
+
+std::optional<std::uint64_t> declarations_context(std::string_view bytes) {
+    if (!bytes.starts_with(kMagic))
+        return std::nullopt;
+    std::uint64_t value = 0;
+    for (std::size_t pos = kMagic.size(), shift = 0; pos < bytes.size() && shift < 64;
+         ++pos, shift += 7) {
+        const auto byte = static_cast<std::uint8_t>(bytes[pos]);
+        value |= std::uint64_t{byte & 0x7Fu} << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+    return std::nullopt;
+}
+
+std::optional<ModuleDeclarations> deserialize_declarations(std::string_view bytes,
+                                                           const ast::Module& module) {
+    try {
+        return Reader(bytes, module).read();
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+}
+
+} // namespace flux::semantic
@@ -0,0 +1,100 @@
+#ifndef FLUX_MODULE_DECLARATIONS_H
+#define FLUX_MODULE_DECLARATIONS_H
+
+#include "ast/ast.h"
+#include "symbol.h"
+#include "type.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace flux::semantic {
+
+struct FieldInfo {
+    std::string name;
+    const ast::TypeExpr* type = nullptr;
+    ast::Visibility visibility;
+};
+
+struct TraitMethodSig {
+    std::string name;
+    std::string self_type;
+    std::vector<std::string> param_types;
+    std::string return_type;
+    bool has_default = false;
+    ast::Visibility visibility = ast::Visibility::None;
+    std::string module_name;
+};
+
+struct TypeInstantiation {
+    Name name;
+    std::vector<::flux::semantic::TypeId> args;
+
+    bool operator==(const TypeInstantiation& other) const = default;
+};
+
+// What Resolver::declare_module() added for one module: every entry it wrote to the
+// declaration tables, every symbol it declared and every type instantiation it recorded,
+// each in the order it did so. Replaying them (Resolver::replay_declarations()) leaves the
+// resolver exactly as declaring the module again would, but for the checks
+// declare_module() makes along the way. Those only pass again if the modules declared
+// before it left the same state, which `context` fingerprints.
+//
+// The pointers are into the module's AST. serialize() writes them as positions in it, so a
+// record read back with deserialize_declarations() points into whichever copy of the same
+// AST it is given, such as one read from the module cache.
+struct ModuleDeclarations {
+    template <typename Value> using Log = std::vector<std::pair<std::string, Value>>;
+
+    // A symbol declared in the global scope (qualified names) rather than the scope the
+    // modules are declared in.
+    struct DeclaredSymbol {
+        bool global = false;
+        Symbol symbol;
+    };
+
+    Log<std::vector<std::string>> enum_variants;
+    Log<std::vector<FieldInfo>> struct_fields;
+    Log<std::vector<FieldInfo>> class_fields;
+    Log<const ast::TypeExpr*> type_aliases;
+    Log<std::pair<std::string, std::string>> module_aliases; // module -> (alias, path)
+    Log<std::vector<TraitMethodSig>> trait_methods;
+    Log<std::string> trait_impls; // type -> trait
+    Log<std::vector<std::string>> function_type_params;
+    Log<std::vector<std::string>> type_type_params;
+    Log<std::vector<std::string>> trait_type_params;
+    Log<std::vector<std::string>> trait_associated_types;
+    std::vector<std::pair<std::pair<std::string, std::string>,
+                          std::unordered_map<std::string, const ast::TypeExpr*>>>
+        impl_associated_types;
+    Log<const ast::FunctionDecl*> function_decls;
+    std::vector<DeclaredSymbol> symbols;
+    std::vector<TypeInstantiation> type_instantiations;
+
+    // A hash of the serialized record of the module declared before this one, which holds
+    // that module's context in turn; 0 for the first module.
+    std::uint64_t context = 0;
+};
+
+// A compact binary encoding of `record`, whose pointers are into `module`. nullopt if one
+// of them points anywhere else.
+std::optional<std::string> serialize(const ModuleDeclarations& record, const ast::Module& module);
+
+// The `context` of the record serialize() wrote into `bytes`, read without decoding the
+// rest. nullopt if `bytes` does not start like a record.
+std::optional<std::uint64_t> declarations_context(std::string_view bytes);
+
+// Reads back what serialize() wrote, pointing into `module`, which must hold the same
+// declarations as the module it was written from. nullopt if `bytes` is truncated or
+// malformed or does not fit `module`.
+std::optional<ModuleDeclarations> deserialize_declarations(std::string_view bytes,
+                                                           const ast::Module& module);
+
+} // namespace flux::semantic
+
+#endif // FLUX_MODULE_DECLARATIONS_H
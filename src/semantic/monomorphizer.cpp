@@ -1,6 +1,7 @@
 #include "monomorphizer.h"
 #include "ast/ast.h"
 #include "resolver.h"
+#include "support/trace.h"
 #include "type.h"
 #include <algorithm>
 #include <iostream>
@@ -11,15 +12,22 @@ namespace flux::semantic {
 Monomorphizer::Monomorphizer(const ::flux::semantic::Resolver& resolver) : resolver_(resolver) {}
 
 ::flux::ast::Module Monomorphizer::monomorphize(const ::flux::ast::Module& main_module) {
+    return monomorphize(main_module, {});
+}
+
+::flux::ast::Module Monomorphizer::monomorphize(
+    const ::flux::ast::Module& main_module,
+    const std::function<bool(const ::flux::ast::FunctionDecl&)>& compiled) {
     ::flux::ast::Module assembly;
     assembly.name = main_module.name;
+    context_ = assembly.context.get();
 
     // 1. Collect all non-generic functions from all modules
     for (const auto& [name, decl_ptr] : resolver_.function_decls()) {
         if (decl_ptr->type_params.empty()) {
-            auto cloned_fn = decl_ptr->clone();
-            ::flux::ast::FunctionDecl fn =
-                std::move(*static_cast<::flux::ast::FunctionDecl*>(cloned_fn.get()));
+            ::flux::ast::FunctionDecl fn = !compiled || compiled(*decl_ptr)
+                                               ? decl_ptr->clone(*context_)
+                                               : decl_ptr->clone_signature(*context_);
             // Ensure non-namespaced functions in main module keep their names,
             // but others use their qualified names.
             if (name.find("::") != std::string::npos) {
@@ -37,6 +45,7 @@ Monomorphizer::Monomorphizer(const ::flux::semantic::Resolver& resolver) : resol
         }
 
         try {
+            TraceSpan span("monomorphize", mangled);
             auto specialized = instantiate_function(inst.name, inst.args);
             assembly.functions.push_back(std::move(specialized));
         } catch (const std::exception& e) {
@@ -44,12 +53,12 @@ Monomorphizer::Monomorphizer(const ::flux::semantic::Resolver& resolver) : resol
         }
     }
 
-    std::unordered_map<std::string, ::flux::semantic::FluxType> empty_map;
+    std::unordered_map<std::string, ::flux::semantic::TypeId> empty_map;
     for (auto& fn : assembly.functions) {
         // Derive the module context from the function's qualified name
         std::string fn_module = assembly.name;
-        if (auto pos = fn.name.rfind("::"); pos != std::string::npos) {
-            fn_module = fn.name.substr(0, pos);
+        if (auto pos = fn.name.str().rfind("::"); pos != std::string::npos) {
+            fn_module = fn.name.str().substr(0, pos);
         }
         substitute_in_function(fn, empty_map, fn_module);
     }
@@ -58,7 +67,7 @@ Monomorphizer::Monomorphizer(const ::flux::semantic::Resolver& resolver) : resol
 }
 
 std::string Monomorphizer::mangle_name(const std::string& name,
-                                       const std::vector<::flux::semantic::FluxType>& type_args) {
+                                       const std::vector<::flux::semantic::TypeId>& type_args) {
     if (type_args.empty())
         return name;
 
@@ -72,8 +81,8 @@ std::string Monomorphizer::mangle_name(const std::string& name,
     return ss.str();
 }
 
-std::string Monomorphizer::mangle_type(const ::flux::semantic::FluxType& type) {
-    std::string n = type.name;
+std::string Monomorphizer::mangle_type(::flux::semantic::TypeId type) {
+    std::string n = type->name;
     if (n == "Int32")
         return "i32";
     if (n == "Float64")
@@ -104,7 +113,7 @@ std::string Monomorphizer::mangle_type(const ::flux::semantic::FluxType& type) {
     }
     mangled = final_mangled;
 
-    for (const auto& arg : type.generic_args) {
+    for (const auto& arg : type->generic_args) {
         mangled += "_" + mangle_type(arg);
     }
 
@@ -113,7 +122,7 @@ std::string Monomorphizer::mangle_type(const ::flux::semantic::FluxType& type) {
 
 ::flux::ast::FunctionDecl
 Monomorphizer::instantiate_function(const std::string& original_name,
-                                    const std::vector<::flux::semantic::FluxType>& type_args) {
+                                    const std::vector<::flux::semantic::TypeId>& type_args) {
     const auto& decls = resolver_.function_decls();
     if (decls.find(original_name) == decls.end()) {
         throw std::runtime_error("Function declaration not found: " + original_name);
@@ -121,14 +130,12 @@ Monomorphizer::instantiate_function(const std::string& original_name,
 
     const ::flux::ast::FunctionDecl* original_decl = decls.at(original_name);
 
-    auto cloned = original_decl->clone();
-    ::flux::ast::FunctionDecl specialized =
-        std::move(*static_cast<::flux::ast::FunctionDecl*>(cloned.get()));
+    ::flux::ast::FunctionDecl specialized = original_decl->clone(*context_);
 
     specialized.name = mangle_name(original_name, type_args);
     specialized.type_params.clear();
 
-    std::unordered_map<std::string, ::flux::semantic::FluxType> mapping;
+    std::unordered_map<std::string, ::flux::semantic::TypeId> mapping;
     auto tp_it = resolver_.function_type_params().find(original_name);
     if (tp_it != resolver_.function_type_params().end()) {
         const auto& params = tp_it->second;
@@ -155,18 +162,18 @@ Monomorphizer::instantiate_function(const std::string& original_name,
 
 void Monomorphizer::substitute_in_function(
     ::flux::ast::FunctionDecl& fn,
-    const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping,
+    const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping,
     const std::string& module_name) {
-    fn.return_type = substitute_type_name(fn.return_type, mapping);
+    fn.return_type = substitute_type_expr(fn.return_type, mapping);
     for (auto& param : fn.params) {
-        param.type = substitute_type_name(param.type, mapping);
+        param.type = substitute_type_expr(param.type, mapping);
     }
     substitute_in_block(fn.body, mapping, module_name);
 }
 
 void Monomorphizer::substitute_in_block(
     ::flux::ast::Block& block,
-    const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping,
+    const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping,
     const std::string& module_name) {
     for (auto& stmt : block.statements) {
         if (stmt)
@@ -176,49 +183,78 @@ void Monomorphizer::substitute_in_block(
 
 void Monomorphizer::substitute_in_stmt(
     ::flux::ast::StmtPtr& stmt,
-    const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping,
+    const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping,
     const std::string& module_name) {
-    if (auto* rs = dynamic_cast<::flux::ast::ReturnStmt*>(stmt.get())) {
+    switch (stmt->kind) {
+    case ::flux::ast::StmtKind::Return: {
+        auto* rs = ::flux::ast::cast<::flux::ast::ReturnStmt>(stmt);
         if (rs->expression)
             substitute_in_expr(rs->expression, mapping, module_name);
-    } else if (auto* ls = dynamic_cast<::flux::ast::LetStmt*>(stmt.get())) {
-        ls->type_name = substitute_type_name(ls->type_name, mapping);
+        break;
+    }
+    case ::flux::ast::StmtKind::Let: {
+        auto* ls = ::flux::ast::cast<::flux::ast::LetStmt>(stmt);
+        ls->type = substitute_type_expr(ls->type, mapping);
         if (ls->initializer)
             substitute_in_expr(ls->initializer, mapping, module_name);
-    } else if (auto* as = dynamic_cast<::flux::ast::AssignStmt*>(stmt.get())) {
+        break;
+    }
+    case ::flux::ast::StmtKind::Assign: {
+        auto* as = ::flux::ast::cast<::flux::ast::AssignStmt>(stmt);
         if (as->target)
             substitute_in_expr(as->target, mapping, module_name);
         if (as->value)
             substitute_in_expr(as->value, mapping, module_name);
-    } else if (auto* bs = dynamic_cast<::flux::ast::BlockStmt*>(stmt.get())) {
+        break;
+    }
+    case ::flux::ast::StmtKind::Block: {
+        auto* bs = ::flux::ast::cast<::flux::ast::BlockStmt>(stmt);
         substitute_in_block(bs->block, mapping, module_name);
-    } else if (auto* is = dynamic_cast<::flux::ast::IfStmt*>(stmt.get())) {
+        break;
+    }
+    case ::flux::ast::StmtKind::If: {
+        auto* is = ::flux::ast::cast<::flux::ast::IfStmt>(stmt);
         if (is->condition)
             substitute_in_expr(is->condition, mapping, module_name);
         if (is->then_branch)
             substitute_in_stmt(is->then_branch, mapping, module_name);
         if (is->else_branch)
             substitute_in_stmt(is->else_branch, mapping, module_name);
-    } else if (auto* ws = dynamic_cast<::flux::ast::WhileStmt*>(stmt.get())) {
+        break;
+    }
+    case ::flux::ast::StmtKind::While: {
+        auto* ws = ::flux::ast::cast<::flux::ast::WhileStmt>(stmt);
         if (ws->condition)
             substitute_in_expr(ws->condition, mapping, module_name);
         if (ws->body)
             substitute_in_stmt(ws->body, mapping, module_name);
-    } else if (auto* es = dynamic_cast<::flux::ast::ExprStmt*>(stmt.get())) {
+        break;
+    }
+    case ::flux::ast::StmtKind::Expr: {
+        auto* es = ::flux::ast::cast<::flux::ast::ExprStmt>(stmt);
         if (es->expression)
             substitute_in_expr(es->expression, mapping, module_name);
+        break;
+    }
+    default:
+        break;
     }
 }
 
 void Monomorphizer::substitute_in_expr(
     ::flux::ast::ExprPtr& expr,
-    const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping,
+    const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping,
     const std::string& module_name) {
-    if (auto* ident_node = dynamic_cast<::flux::ast::IdentifierExpr*>(expr.get())) {
+    switch (expr->kind) {
+    case ::flux::ast::ExprKind::Identifier: {
+        auto* ident_node = ::flux::ast::cast<::flux::ast::IdentifierExpr>(expr);
         if (mapping.find(ident_node->name) != mapping.end()) {
-            ident_node->name = mapping.at(ident_node->name).name;
+            ident_node->name = mapping.at(ident_node->name)->name;
         }
-    } else if (auto* call = dynamic_cast<::flux::ast::CallExpr*>(expr.get())) {
+        break;
+    }
+    case ::flux::ast::ExprKind::Call: {
+        auto* call = ::flux::ast::cast<::flux::ast::CallExpr>(expr);
         if (call->callee)
             substitute_in_expr(call->callee, mapping, module_name);
         for (auto& arg : call->arguments) {
@@ -228,12 +264,13 @@ void Monomorphizer::substitute_in_expr(
 
         if (call->callee) {
             if (auto* callee_node =
-                    dynamic_cast<::flux::ast::IdentifierExpr*>(call->callee.get())) {
-                if (callee_node->name.find('<') != std::string::npos) {
-                    size_t open = callee_node->name.find('<');
-                    std::string base = callee_node->name.substr(0, open);
+                    ::flux::ast::dyn_cast<::flux::ast::IdentifierExpr>(call->callee)) {
+                const std::string& callee_name = callee_node->name.str();
+                if (callee_name.find('<') != std::string::npos) {
+                    size_t open = callee_name.find('<');
+                    std::string base = callee_name.substr(0, open);
                     std::string args_str =
-                        callee_node->name.substr(open + 1, callee_node->name.size() - open - 2);
+                        callee_name.substr(open + 1, callee_name.size() - open - 2);
 
                     std::string substituted_args = args_str;
                     for (const auto& [gen, concrete] : mapping) {
@@ -244,8 +281,8 @@ void Monomorphizer::substitute_in_expr(
                             bool boundary_r = (pos + gen.length() == substituted_args.length() ||
                                                !std::isalnum(substituted_args[pos + gen.length()]));
                             if (boundary_l && boundary_r) {
-                                substituted_args.replace(pos, gen.length(), concrete.name);
-                                pos += concrete.name.length();
+                                substituted_args.replace(pos, gen.length(), concrete->name);
+                                pos += concrete->name.length();
                             } else {
                                 pos += gen.length();
                             }
@@ -264,10 +301,10 @@ void Monomorphizer::substitute_in_expr(
                     callee_node->name = mangled;
                 }
 
-                // Qualify bare function names within namespaced modules
+                // Qualify bare names of functions in the same module
                 // e.g., inside std::io::println, "puts" -> "std::io::puts"
-                if (callee_node->name.find("::") == std::string::npos && !module_name.empty() &&
-                    module_name.find("::") != std::string::npos) {
+                if (callee_node->name.str().find("::") == std::string::npos &&
+                    !module_name.empty()) {
                     std::string qualified = module_name + "::" + callee_node->name;
                     const auto& decls = resolver_.function_decls();
                     if (decls.find(qualified) != decls.end()) {
@@ -276,28 +313,31 @@ void Monomorphizer::substitute_in_expr(
                 }
             }
         }
-    } else if (auto* bin = dynamic_cast<::flux::ast::BinaryExpr*>(expr.get())) {
+        break;
+    }
+    case ::flux::ast::ExprKind::Binary: {
+        auto* bin = ::flux::ast::cast<::flux::ast::BinaryExpr>(expr);
         if (bin->op == ::flux::TokenKind::ColonColon) {
             // Hierarchical name resolution: io::println -> std::io::println
             std::vector<std::string> parts;
-            ::flux::ast::Expr* current = expr.get();
+            ::flux::ast::Expr* current = expr;
             bool valid_chain = true;
-            while (auto* b = dynamic_cast<::flux::ast::BinaryExpr*>(current)) {
+            while (auto* b = ::flux::ast::dyn_cast<::flux::ast::BinaryExpr>(current)) {
                 if (b->op != ::flux::TokenKind::ColonColon) {
                     valid_chain = false;
                     break;
                 }
-                if (auto* rhs_id = dynamic_cast<::flux::ast::IdentifierExpr*>(b->right.get())) {
+                if (auto* rhs_id = ::flux::ast::dyn_cast<::flux::ast::IdentifierExpr>(b->right)) {
                     parts.insert(parts.begin(), rhs_id->name);
                 } else {
                     valid_chain = false;
                     break;
                 }
-                current = b->left.get();
+                current = b->left;
             }
 
             if (valid_chain) {
-                if (auto* root_id = dynamic_cast<::flux::ast::IdentifierExpr*>(current)) {
+                if (auto* root_id = ::flux::ast::dyn_cast<::flux::ast::IdentifierExpr>(current)) {
                     parts.insert(parts.begin(), root_id->name);
                     std::string full_name;
                     for (size_t i = 0; i < parts.size(); ++i) {
@@ -310,10 +350,9 @@ void Monomorphizer::substitute_in_expr(
                     std::string resolved = resolver_.resolve_name(full_name, module_name);
 
                     // Replace BinaryExpr with IdentifierExpr
-                    auto new_id = std::make_unique<::flux::ast::IdentifierExpr>(resolved);
-                    new_id->line = expr->line;
-                    new_id->column = expr->column;
-                    expr = std::move(new_id);
+                    auto new_id = context_->make<::flux::ast::IdentifierExpr>(resolved);
+                    new_id->loc = expr->loc;
+                    expr = new_id;
                     return; // Done with this branch
                 }
             }
@@ -323,25 +362,38 @@ void Monomorphizer::substitute_in_expr(
             substitute_in_expr(bin->left, mapping, module_name);
         if (bin->right)
             substitute_in_expr(bin->right, mapping, module_name);
-    } else if (auto* un = dynamic_cast<::flux::ast::UnaryExpr*>(expr.get())) {
+        break;
+    }
+    case ::flux::ast::ExprKind::Unary: {
+        auto* un = ::flux::ast::cast<::flux::ast::UnaryExpr>(expr);
         if (un->operand)
             substitute_in_expr(un->operand, mapping, module_name);
-    } else if (auto* sl = dynamic_cast<::flux::ast::StructLiteralExpr*>(expr.get())) {
+        break;
+    }
+    case ::flux::ast::ExprKind::StructLiteral: {
+        auto* sl = ::flux::ast::cast<::flux::ast::StructLiteralExpr>(expr);
         sl->struct_name = substitute_type_name(sl->struct_name, mapping);
         for (auto& field : sl->fields) {
             if (field.value)
                 substitute_in_expr(field.value, mapping, module_name);
         }
-    } else if (auto* ma = dynamic_cast<::flux::ast::MemberAccessExpr*>(expr.get())) {
+        break;
+    }
+    case ::flux::ast::ExprKind::MemberAccess: {
+        auto* ma = ::flux::ast::cast<::flux::ast::MemberAccessExpr>(expr);
         if (ma->object)
             substitute_in_expr(ma->object, mapping, module_name);
+        break;
+    }
+    default:
+        break;
     }
 }
 
 void Monomorphizer::substitute_in_pattern(
     ::flux::ast::PatternPtr& pattern,
-    const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping) {
-    if (auto* vp = dynamic_cast<::flux::ast::VariantPattern*>(pattern.get())) {
+    const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping) {
+    if (auto* vp = ::flux::ast::dyn_cast<::flux::ast::VariantPattern>(pattern)) {
         vp->variant_name = substitute_type_name(vp->variant_name, mapping);
         for (auto& sub : vp->sub_patterns) {
             if (sub)
@@ -352,25 +404,87 @@ void Monomorphizer::substitute_in_pattern(
 
 std::string Monomorphizer::substitute_type_name(
     const std::string& name,
-    const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping) {
+    const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping) {
     if (mapping.find(name) != mapping.end()) {
-        return mapping.at(name).name;
+        return mapping.at(name)->name;
     }
     return name;
 }
 
-::flux::semantic::FluxType Monomorphizer::substitute_type(
-    const ::flux::semantic::FluxType& type,
-    const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping) {
-    if (type.kind == ::flux::semantic::TypeKind::Generic &&
-        mapping.find(type.name) != mapping.end()) {
-        return mapping.at(type.name);
+::flux::ast::TypeExprPtr Monomorphizer::substitute_type_expr(
+    ::flux::ast::TypeExprPtr type,
+    const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping) {
+    if (!type || mapping.empty())
+        return type;
+
+    switch (type->kind) {
+    case ::flux::ast::TypeExprKind::Path: {
+        auto* path = ::flux::ast::cast<::flux::ast::PathType>(type);
+        if (path->generic_args.empty()) {
+            auto it = mapping.find(path->name);
+            return it != mapping.end() ? type_expr_for(it->second) : type;
+        }
+        for (auto& arg : path->generic_args)
+            arg = substitute_type_expr(arg, mapping);
+        break;
+    }
+    case ::flux::ast::TypeExprKind::Ref: {
+        auto* ref = ::flux::ast::cast<::flux::ast::RefType>(type);
+        ref->pointee = substitute_type_expr(ref->pointee, mapping);
+        break;
+    }
+    case ::flux::ast::TypeExprKind::Array: {
+        auto* array = ::flux::ast::cast<::flux::ast::ArrayType>(type);
+        array->element = substitute_type_expr(array->element, mapping);
+        break;
+    }
+    case ::flux::ast::TypeExprKind::Tuple:
+        for (auto& element : ::flux::ast::cast<::flux::ast::TupleType>(type)->elements)
+            element = substitute_type_expr(element, mapping);
+        break;
+    case ::flux::ast::TypeExprKind::Function: {
+        auto* fn = ::flux::ast::cast<::flux::ast::FunctionType>(type);
+        for (auto& param : fn->params)
+            param = substitute_type_expr(param, mapping);
+        fn->return_type = substitute_type_expr(fn->return_type, mapping);
+        break;
+    }
+    }
+    return type;
+}
+
+::flux::ast::TypeExprPtr Monomorphizer::type_expr_for(::flux::semantic::TypeId type) {
+    using ::flux::semantic::TypeKind;
+    auto list = [&](const std::vector<::flux::semantic::TypeId>& types) {
+        std::span<::flux::ast::TypeExprPtr> exprs =
+            context_->list<::flux::ast::TypeExprPtr>(types.size());
+        for (std::size_t i = 0; i < types.size(); ++i)
+            exprs[i] = type_expr_for(types[i]);
+        return exprs;
+    };
+
+    switch (type->kind) {
+    case TypeKind::Ref: {
+        // A reference type carries only its spelling, `&T` or `&mut T`.
+        const std::string pointee = type->name.substr(type->is_mut_ref ? 5 : 1);
+        return context_->make<::flux::ast::RefType>(
+            type->is_mut_ref, context_->make<::flux::ast::PathType>(pointee));
+    }
+    case TypeKind::Tuple:
+        return context_->make<::flux::ast::TupleType>(list(type->generic_args));
+    case TypeKind::Function:
+        return context_->make<::flux::ast::FunctionType>(
+            list(type->param_types), type_expr_for(type->return_type));
+    case TypeKind::Option:
+    case TypeKind::Result: {
+        const std::string base = type->kind == TypeKind::Option ? "Option" : "Result";
+        return context_->make<::flux::ast::PathType>(base, list(type->generic_args));
     }
-    ::flux::semantic::FluxType result = type;
-    for (auto& arg : result.generic_args) {
-        arg = substitute_type(arg, mapping);
+    default:
+        // Named types, and arrays and generic instances, which are lowered by their
+        // canonical name.
+        return context_->make<::flux::ast::PathType>(type->name);
     }
-    return result;
 }
 
 } // namespace flux::semantic
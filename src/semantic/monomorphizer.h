@@ -4,6 +4,7 @@
 #include "ast/ast.h"
 #include "semantic/resolver.h"
 #include "semantic/type.h"
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -15,52 +16,61 @@ class Monomorphizer {
   public:
     explicit Monomorphizer(const ::flux::semantic::Resolver& resolver);
     ::flux::ast::Module monomorphize(const ::flux::ast::Module& module);
+    // Like monomorphize(), but only the functions `compiled` accepts keep their bodies; the
+    // rest are compiled elsewhere, and only their signatures are given.
+    ::flux::ast::Module
+    monomorphize(const ::flux::ast::Module& module,
+                 const std::function<bool(const ::flux::ast::FunctionDecl&)>& compiled);
 
   private:
     const ::flux::semantic::Resolver& resolver_;
+    // Arena of the module being assembled; cloned and rewritten nodes are placed here.
+    ::flux::ast::AstContext* context_ = nullptr;
 
     // Mangle name for specialization (e.g. foo<Int32> -> foo__Int32)
     std::string mangle_name(const std::string& name,
-                            const std::vector<::flux::semantic::FluxType>& type_args);
-    std::string mangle_type(const ::flux::semantic::FluxType& type);
+                            const std::vector<::flux::semantic::TypeId>& type_args);
+    std::string mangle_type(::flux::semantic::TypeId type);
 
     // Instantiate a function
     ::flux::ast::FunctionDecl
     instantiate_function(const std::string& original_name,
-                         const std::vector<::flux::semantic::FluxType>& type_args);
+                         const std::vector<::flux::semantic::TypeId>& type_args);
 
     // Substitutions
     void substitute_in_function(
         ::flux::ast::FunctionDecl& fn,
-        const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping,
+        const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping,
         const std::string& module_name = "");
 
     void
     substitute_in_block(::flux::ast::Block& block,
-                        const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping,
+                        const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping,
                         const std::string& module_name = "");
 
     void
     substitute_in_stmt(::flux::ast::StmtPtr& stmt,
-                       const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping,
+                       const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping,
                        const std::string& module_name = "");
 
     void
     substitute_in_expr(::flux::ast::ExprPtr& expr,
-                       const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping,
+                       const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping,
                        const std::string& module_name = "");
 
     void substitute_in_pattern(
         ::flux::ast::PatternPtr& pattern,
-        const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping);
+        const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping);
 
     // Helpers
     std::string substitute_type_name(
         const std::string& name,
-        const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping);
-    ::flux::semantic::FluxType
-    substitute_type(const ::flux::semantic::FluxType& type,
-                    const std::unordered_map<std::string, ::flux::semantic::FluxType>& mapping);
+        const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping);
+    ::flux::ast::TypeExprPtr substitute_type_expr(
+        ::flux::ast::TypeExprPtr type,
+        const std::unordered_map<std::string, ::flux::semantic::TypeId>& mapping);
+    // A type tree in context_ for a concrete type argument.
+    ::flux::ast::TypeExprPtr type_expr_for(::flux::semantic::TypeId type);
 
     // Cache of instantiated functions (mangled names)
     std::unordered_set<std::string> instantiated_functions_;
@@ -1,14 +1,21 @@
 #include "resolver.h"
 
-#include <iostream>
 #include <ranges>
 
 #include "ast/ast.h"
 #include "lexer/diagnostic.h"
+#include "support/hash.h"
+#include "support/thread_pool.h"
+#include "support/trace.h"
 #include "type.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <map>
+#include <memory>
 #include <optional>
+#include <stdexcept>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -50,15 +57,15 @@ struct ScopeGuard {
     }
 };
 
-FluxType Resolver::type_from_name(const std::string& name) {
+TypeId Resolver::type_from_name(const std::string& name) {
     std::unordered_set<std::string> seen;
     return type_from_name_internal(name, seen);
 }
 
-FluxType Resolver::type_from_name_internal(const std::string& name,
-                                           std::unordered_set<std::string>& seen) {
+TypeId Resolver::type_from_name_internal(const std::string& name,
+                                         std::unordered_set<std::string>& seen) {
     if (name.empty()) {
-        return FluxType(TypeKind::Unknown, "");
+        return TypeId(TypeKind::Unknown, "");
     }
     // Check substitution map for generic type parameters
     auto sub_it = substitution_map_.find(name);
@@ -72,10 +79,8 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
         size_t end = name.rfind('>');
         if (start != std::string::npos && end != std::string::npos && end > start + 1) {
             std::string inner = name.substr(start + 1, end - start - 1);
-            FluxType inner_type = type_from_name_internal(inner, seen);
-            FluxType t(TypeKind::Option, name);
-            t.generic_args.push_back(inner_type);
-            return t;
+            TypeId inner_type = type_from_name_internal(inner, seen);
+            return TypeId(TypeKind::Option, name, false, {}, {}, {inner_type});
         }
     }
     if (name.starts_with("Result<")) {
@@ -92,47 +97,44 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
                 t1.erase(t1.find_last_not_of(" \t\n") + 1);
                 t2.erase(0, t2.find_first_not_of(" \t\n"));
                 t2.erase(t2.find_last_not_of(" \t\n") + 1);
-                FluxType type1 = type_from_name_internal(t1, seen);
-                FluxType type2 = type_from_name_internal(t2, seen);
-                FluxType t(TypeKind::Result, name);
-                t.generic_args.push_back(type1);
-                t.generic_args.push_back(type2);
-                return t;
+                TypeId type1 = type_from_name_internal(t1, seen);
+                TypeId type2 = type_from_name_internal(t2, seen);
+                return TypeId(TypeKind::Result, name, false, {}, {}, {type1, type2});
             }
         }
     }
 
     if (name.starts_with("Int") || name.starts_with("UInt") || name == "IntPtr" ||
         name == "UIntPtr") {
-        return FluxType(TypeKind::Int, name);
+        return TypeId(TypeKind::Int, name);
     }
 
     if (name.starts_with("Float")) {
-        return FluxType(TypeKind::Float, name);
+        return TypeId(TypeKind::Float, name);
     }
 
     if (name == "Bool") {
-        return FluxType(TypeKind::Bool, name);
+        return TypeId(TypeKind::Bool, name);
     }
 
     if (name == "String") {
-        return FluxType(TypeKind::String, name);
+        return TypeId(TypeKind::String, name);
     }
 
     if (name == "Char") {
-        return FluxType(TypeKind::Char, name);
+        return TypeId(TypeKind::Char, name);
     }
 
     if (name == "Void") {
-        return FluxType(TypeKind::Void, name);
+        return TypeId(TypeKind::Void, name);
     }
 
     if (name == "Never") {
-        return FluxType(TypeKind::Never, name);
+        return TypeId(TypeKind::Never, name);
     }
 
     if (name == "Module") {
-        return FluxType(TypeKind::Unknown, "Module"); // or TypeKind::Module if we had it
+        return TypeId(TypeKind::Unknown, "Module"); // or TypeKind::Module if we had it
     }
 
     if (name == "Self" && !current_type_name_.empty()) {
@@ -140,22 +142,22 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
     }
 
     // Enum types
-    if (enum_variants_.contains(name)) {
+    if (declarations_->enum_variants.contains(name)) {
         return {TypeKind::Enum, name};
     }
 
     // Struct/class types
-    if (struct_fields_.contains(name)) {
+    if (declarations_->struct_fields.contains(name)) {
         return {TypeKind::Struct, name};
     }
 
-    // FluxType aliases
-    if (type_aliases_.contains(name)) {
+    // Type aliases
+    if (declarations_->type_aliases.contains(name)) {
         if (seen.contains(name)) {
             throw DiagnosticError("circular type alias detected: '" + name + "'", 0, 0);
         }
         seen.insert(name);
-        FluxType resolved = type_from_name_internal(type_aliases_.at(name), seen);
+        TypeId resolved = resolve_type_internal(*declarations_->type_aliases.at(name), seen);
         seen.erase(name);
         return resolved;
     }
@@ -166,17 +168,18 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
         std::string base_name = name.substr(0, pos);
         std::string assoc_name = name.substr(pos + 2);
 
-        FluxType base_type = type_from_name_internal(base_name, seen);
-        if (base_type.kind != TypeKind::Unknown) {
+        TypeId base_type = type_from_name_internal(base_name, seen);
+        if (base_type->kind != TypeKind::Unknown) {
             // 1. Look for concrete impl mapping
-            auto it_range = trait_impls_.find(base_type.name);
-            if (it_range != trait_impls_.end()) {
+            auto it_range = declarations_->trait_impls.find(base_type->name);
+            if (it_range != declarations_->trait_impls.end()) {
                 for (const auto& trait : it_range->second) {
-                    auto it = impl_associated_types_.find(std::make_pair(base_type.name, trait));
-                    if (it != impl_associated_types_.end()) {
+                    auto it = declarations_->impl_associated_types.find(
+                        std::make_pair(base_type->name, trait));
+                    if (it != declarations_->impl_associated_types.end()) {
                         auto assoc_it = it->second.find(assoc_name);
                         if (assoc_it != it->second.end()) {
-                            return type_from_name_internal(assoc_it->second, seen);
+                            return resolve_type_internal(*assoc_it->second, seen);
                         }
                     }
                 }
@@ -185,9 +188,10 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
             // 2. Look in generic bounds if base_type is a generic param
             std::vector<std::string> bounds;
             if (!current_function_name_.empty() &&
-                function_type_params_.contains(current_function_name_)) {
-                for (const auto& p : function_type_params_.at(current_function_name_)) {
-                    if (p.starts_with(base_type.name + ":")) {
+                declarations_->function_type_params.contains(current_function_name_)) {
+                for (const auto& p :
+                     declarations_->function_type_params.at(current_function_name_)) {
+                    if (p.starts_with(base_type->name + ":")) {
                         // Extract traits from "T: Trait1 + Trait2"
                         size_t colon = p.find(':');
                         std::string traits_list = p.substr(colon + 1);
@@ -217,14 +221,14 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
                     trait_base = trait_base.substr(0, b_pos);
                 }
 
-                auto it = trait_associated_types_.find(trait_base);
-                if (it != trait_associated_types_.end()) {
+                auto it = declarations_->trait_associated_types.find(trait_base);
+                if (it != declarations_->trait_associated_types.end()) {
                     for (const auto& candidate : it->second) {
                         if (candidate == assoc_name) {
                             // In a generic context, we might keep it as T::Item
                             // or resolve to a placeholder. For now, return a generic type
                             // representing the associated type itself.
-                            return FluxType(TypeKind::Generic, name);
+                            return TypeId(TypeKind::Generic, name);
                         }
                     }
                 }
@@ -236,7 +240,7 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
     if (current_scope_) {
         if (auto sym = current_scope_->lookup(name)) {
             if (sym->kind == SymbolKind::Variable && sym->type == "FluxType") {
-                return FluxType(TypeKind::Generic, name);
+                return TypeId(TypeKind::Generic, name);
             }
         }
     }
@@ -247,11 +251,13 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
         size_t close = name.rfind('>');
         if (open != std::string::npos && close != std::string::npos && close > open + 1) {
             std::string base = name.substr(0, open);
-            if (enum_variants_.contains(base) || type_type_params_.contains(base) ||
-                trait_type_params_.contains(base) || function_type_params_.contains(base) ||
-                type_aliases_.contains(base) || struct_fields_.contains(base)) {
+            const Declarations& decls = *declarations_;
+            if (decls.enum_variants.contains(base) || decls.type_type_params.contains(base) ||
+                decls.trait_type_params.contains(base) ||
+                decls.function_type_params.contains(base) || decls.type_aliases.contains(base) ||
+                decls.struct_fields.contains(base)) {
                 std::string args_str = name.substr(open + 1, close - open - 1);
-                std::vector<FluxType> args;
+                std::vector<TypeId> args;
 
                 // Split args by comma, respecting nested brackets
                 int depth = 0;
@@ -277,15 +283,12 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
                     }
                 }
 
-                FluxType t(TypeKind::Struct, name);
-                t.generic_args = std::move(args);
-
                 // Record type instantiation
-                if (!t.generic_args.empty()) {
-                    record_type_instantiation(base, t.generic_args);
+                if (!args.empty()) {
+                    record_type_instantiation(base, args);
                 }
 
-                return t;
+                return TypeId(TypeKind::Struct, name, false, {}, {}, std::move(args));
             }
         }
     }
@@ -309,9 +312,9 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
                 inner.erase(0, inner.find_first_not_of(" \t\n"));
                 inner.erase(inner.find_last_not_of(" \t\n") + 1);
 
-                FluxType value_type = type_from_name_internal(inner, seen);
-                if (value_type.kind != TypeKind::Unknown) {
-                    std::string canonical_name = "[" + value_type.name + ";" + size_str + "]";
+                TypeId value_type = type_from_name_internal(inner, seen);
+                if (value_type->kind != TypeKind::Unknown) {
+                    std::string canonical_name = "[" + value_type->name + ";" + size_str + "]";
                     return {TypeKind::Array, canonical_name};
                 }
             } else if (semicolon == std::string::npos) {
@@ -321,9 +324,9 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
                 inner.erase(0, inner.find_first_not_of(" \t\n"));
                 inner.erase(inner.find_last_not_of(" \t\n") + 1);
 
-                FluxType value_type = type_from_name_internal(inner, seen);
-                if (value_type.kind != TypeKind::Unknown) {
-                    std::string canonical_name = "[" + value_type.name + "]";
+                TypeId value_type = type_from_name_internal(inner, seen);
+                if (value_type->kind != TypeKind::Unknown) {
+                    std::string canonical_name = "[" + value_type->name + "]";
                     return {TypeKind::Slice, canonical_name};
                 }
             }
@@ -353,7 +356,7 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
             if (arrow_pos != std::string::npos) {
                 // It IS a function type: (Args) -> Ret
                 std::string args_content = name.substr(1, args_end - 1);
-                std::vector<FluxType> params;
+                std::vector<TypeId> params;
                 if (!args_content.empty()) {
                     int d = 0;
                     size_t start = 0;
@@ -391,14 +394,13 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
                     size_t last = ret_str.find_last_not_of(" \t\n");
                     ret_str = ret_str.substr(first, last - first + 1);
                 }
-                FluxType ret_type = type_from_name_internal(ret_str, seen);
+                TypeId ret_type = type_from_name_internal(ret_str, seen);
 
-                return FluxType(TypeKind::Function, name, false, std::move(params),
-                                std::make_unique<FluxType>(std::move(ret_type)));
+                return TypeId(TypeKind::Function, name, false, std::move(params), ret_type);
             } else {
                 // Pure tuple type: (T1, T2, ...)
                 std::string content = name.substr(1, args_end - 1);
-                std::vector<FluxType> elements;
+                std::vector<TypeId> elements;
                 if (!content.empty()) {
                     int d = 0;
                     size_t s = 0;
@@ -423,9 +425,7 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
                         }
                     }
                 }
-                FluxType res(TypeKind::Tuple, name);
-                res.generic_args = std::move(elements);
-                return res;
+                return TypeId(TypeKind::Tuple, name, false, {}, {}, std::move(elements));
             }
         }
     }
@@ -433,8 +433,100 @@ FluxType Resolver::type_from_name_internal(const std::string& name,
     return unknown();
 }
 
+TypeId Resolver::resolve_type(const ast::TypeExpr* type) {
+    if (!type)
+        return TypeId(TypeKind::Unknown, "");
+    std::unordered_set<std::string> seen;
+    return resolve_type_internal(*type, seen);
+}
+
+// Symbols declared from source carry their types as parsed or already resolved; only the
+// intrinsics and trait default methods still go through their spelled-out names.
+TypeId Resolver::symbol_type(const Symbol& sym) {
+    if (sym.resolved_type)
+        return *sym.resolved_type;
+    if (sym.type_expr)
+        return resolve_type(sym.type_expr);
+    return type_from_name(sym.type);
+}
+
+TypeId Resolver::function_type(const Symbol& sym, size_t skip) {
+    const bool parsed = sym.param_type_exprs.size() == sym.param_types.size();
+    std::vector<TypeId> params;
+    std::string name = "(";
+    for (size_t i = skip; i < sym.param_types.size(); ++i) {
+        params.push_back(parsed ? resolve_type(sym.param_type_exprs[i])
+                                : type_from_name(sym.param_types[i]));
+        if (i > skip)
+            name += ", ";
+        name += params.back()->name;
+    }
+    TypeId ret = symbol_type(sym);
+    name += ") -> " + ret->name;
+    return TypeId(TypeKind::Function, name, false, std::move(params), ret);
+}
+
+// Mirrors type_from_name_internal() on the parsed tree: only leaf names are looked up by
+// text, and the canonical names of composite types are spelled from their parts.
+TypeId Resolver::resolve_type_internal(const ast::TypeExpr& type,
+                                       std::unordered_set<std::string>& seen) {
+    switch (type.kind) {
+    case ast::TypeExprKind::Path: {
+        const auto* path = ast::cast<ast::PathType>(&type);
+        if (path->generic_args.empty())
+            return type_from_name_internal(path->name, seen);
+
+        std::vector<TypeId> args;
+        args.reserve(path->generic_args.size());
+        for (const ast::TypeExpr* arg : path->generic_args)
+            args.push_back(resolve_type_internal(*arg, seen));
+
+        const std::string& base = path->name;
+        if (base == "Option" && args.size() == 1)
+            return TypeId(TypeKind::Option, ast::spelling(&type), false, {}, {}, std::move(args));
+        if (base == "Result" && args.size() == 2)
+            return TypeId(TypeKind::Result, ast::spelling(&type), false, {}, {}, std::move(args));
+
+        const Declarations& decls = *declarations_;
+        if (decls.enum_variants.contains(base) || decls.type_type_params.contains(base) ||
+            decls.trait_type_params.contains(base) || decls.function_type_params.contains(base) ||
+            decls.type_aliases.contains(base) || decls.struct_fields.contains(base)) {
+            record_type_instantiation(base, args);
+            return TypeId(TypeKind::Struct, ast::spelling(&type), false, {}, {}, std::move(args));
+        }
+        return unknown();
+    }
+    case ast::TypeExprKind::Ref:
+        return {TypeKind::Ref, ast::spelling(&type), ast::cast<ast::RefType>(&type)->is_mutable};
+    case ast::TypeExprKind::Array: {
+        const auto* array = ast::cast<ast::ArrayType>(&type);
+        TypeId element = resolve_type_internal(*array->element, seen);
+        if (element->kind == TypeKind::Unknown)
+            return unknown();
+        if (array->is_slice())
+            return {TypeKind::Slice, "[" + element->name + "]"};
+        return {TypeKind::Array, "[" + element->name + ";" + array->length + "]"};
+    }
+    case ast::TypeExprKind::Tuple: {
+        std::vector<TypeId> elements;
+        for (const ast::TypeExpr* element : ast::cast<ast::TupleType>(&type)->elements)
+            elements.push_back(resolve_type_internal(*element, seen));
+        return TypeId(TypeKind::Tuple, ast::spelling(&type), false, {}, {}, std::move(elements));
+    }
+    case ast::TypeExprKind::Function: {
+        const auto* fn = ast::cast<ast::FunctionType>(&type);
+        std::vector<TypeId> params;
+        for (const ast::TypeExpr* param : fn->params)
+            params.push_back(resolve_type_internal(*param, seen));
+        TypeId ret = resolve_type_internal(*fn->return_type, seen);
+        return TypeId(TypeKind::Function, ast::spelling(&type), false, std::move(params), ret);
+    }
+    }
+    return unknown();
+}
+
 bool Resolver::is_enum_variant(const std::string& name) const {
-    for (const auto& variants : enum_variants_ | std::views::values) {
+    for (const auto& variants : declarations_->enum_variants | std::views::values) {
         for (const auto& v : variants) {
             if (v == name) {
                 return true;
@@ -445,7 +537,7 @@ bool Resolver::is_enum_variant(const std::string& name) const {
 }
 
 std::string Resolver::find_enum_for_variant(const std::string& variant_name) const {
-    for (const auto& [enum_name, variants] : enum_variants_) {
+    for (const auto& [enum_name, variants] : declarations_->enum_variants) {
         for (const auto& v : variants) {
             if (v == variant_name) {
                 return enum_name;
@@ -455,58 +547,65 @@ std::string Resolver::find_enum_for_variant(const std::string& variant_name) con
     return "";
 }
 
-FluxType Resolver::type_of(const ast::Expr& expr) {
-    using semantic::FluxType;
+TypeId Resolver::type_of(const ast::Expr& expr) {
+    using semantic::TypeId;
     using semantic::TypeKind;
 
-    if (auto arr = dynamic_cast<const ast::ArrayExpr*>(&expr)) {
+    // Track location for diagnostics
+    last_loc_ = expr.loc;
+
+    switch (expr.kind) {
+    case ast::ExprKind::Array: {
+        const auto* arr = ast::cast<ast::ArrayExpr>(&expr);
         if (arr->elements.empty()) {
             throw DiagnosticError("empty array literal is not allowed", 0, 0);
         }
-        FluxType first_type = type_of(*arr->elements[0]);
-        bool any_never = first_type.kind == TypeKind::Never;
+        TypeId first_type = type_of(*arr->elements[0]);
+        bool any_never = first_type->kind == TypeKind::Never;
 
         for (size_t i = 1; i < arr->elements.size(); ++i) {
-            FluxType t = type_of(*arr->elements[i]);
-            if (t.kind == TypeKind::Never) {
+            TypeId t = type_of(*arr->elements[i]);
+            if (t->kind == TypeKind::Never) {
                 any_never = true;
                 continue;
             }
-            if (first_type.kind == TypeKind::Never) {
+            if (first_type->kind == TypeKind::Never) {
                 first_type = t;
-            } else if (t != first_type && t.kind != TypeKind::Unknown) {
+            } else if (t != first_type && t->kind != TypeKind::Unknown) {
                 throw DiagnosticError("array elements must have the same type", 0, 0);
             }
         }
         if (any_never)
             return never_type();
-        std::string name = "[" + first_type.name + ";" + std::to_string(arr->elements.size()) + "]";
+        std::string name =
+            "[" + first_type->name + ";" + std::to_string(arr->elements.size()) + "]";
         return {TypeKind::Array, name};
     }
 
-    if (auto slice = dynamic_cast<const ast::SliceExpr*>(&expr)) {
-        FluxType arr_type = type_of(*slice->array);
-        if (arr_type.kind != TypeKind::Array && arr_type.kind != TypeKind::Slice) {
+    case ast::ExprKind::Slice: {
+        const auto* slice = ast::cast<ast::SliceExpr>(&expr);
+        TypeId arr_type = type_of(*slice->array);
+        if (arr_type->kind != TypeKind::Array && arr_type->kind != TypeKind::Slice) {
             throw DiagnosticError("slice base must be an array or slice", 0, 0);
         }
 
         // If it's an array [T; N] or slice [T], the result is a slice [T]
         std::string elem_type_name;
-        if (arr_type.kind == TypeKind::Array) {
+        if (arr_type->kind == TypeKind::Array) {
             // [T; N] -> find T
-            auto lbrack = arr_type.name.find('[');
-            auto semi = arr_type.name.find(';');
+            auto lbrack = arr_type->name.find('[');
+            auto semi = arr_type->name.find(';');
             if (lbrack != std::string::npos && semi != std::string::npos && semi > lbrack + 1) {
-                elem_type_name = arr_type.name.substr(lbrack + 1, semi - lbrack - 1);
+                elem_type_name = arr_type->name.substr(lbrack + 1, semi - lbrack - 1);
             } else {
                 elem_type_name = "Unknown";
             }
         } else {
             // [T] -> find T
-            auto lbrack = arr_type.name.find('[');
-            auto rbrack = arr_type.name.find(']');
+            auto lbrack = arr_type->name.find('[');
+            auto rbrack = arr_type->name.find(']');
             if (lbrack != std::string::npos && rbrack != std::string::npos && rbrack > lbrack + 1) {
-                elem_type_name = arr_type.name.substr(lbrack + 1, rbrack - lbrack - 1);
+                elem_type_name = arr_type->name.substr(lbrack + 1, rbrack - lbrack - 1);
             } else {
                 elem_type_name = "Unknown";
             }
@@ -515,33 +614,34 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
         return {TypeKind::Slice, "[" + elem_type_name + "]"};
     }
 
-    if (auto idx = dynamic_cast<const ast::IndexExpr*>(&expr)) {
-        FluxType arr_type = type_of(*idx->array);
-        if (arr_type.kind != TypeKind::Array && arr_type.kind != TypeKind::Slice) {
+    case ast::ExprKind::Index: {
+        const auto* idx = ast::cast<ast::IndexExpr>(&expr);
+        TypeId arr_type = type_of(*idx->array);
+        if (arr_type->kind != TypeKind::Array && arr_type->kind != TypeKind::Slice) {
             throw DiagnosticError("index base must be an array or slice", 0, 0);
         }
 
         // Index type must be integer
-        FluxType index_type = type_of(*idx->index);
-        if (index_type.kind != TypeKind::Int && index_type.kind != TypeKind::Unknown) {
+        TypeId index_type = type_of(*idx->index);
+        if (index_type->kind != TypeKind::Int && index_type->kind != TypeKind::Unknown) {
             throw DiagnosticError("index must be an integer", 0, 0);
         }
 
         // Extract element type
         std::string elem_type_name;
-        if (arr_type.kind == TypeKind::Array) {
-            auto lbrack = arr_type.name.find('[');
-            auto semi = arr_type.name.find(';');
+        if (arr_type->kind == TypeKind::Array) {
+            auto lbrack = arr_type->name.find('[');
+            auto semi = arr_type->name.find(';');
             if (lbrack != std::string::npos && semi != std::string::npos && semi > lbrack + 1) {
-                elem_type_name = arr_type.name.substr(lbrack + 1, semi - lbrack - 1);
+                elem_type_name = arr_type->name.substr(lbrack + 1, semi - lbrack - 1);
             } else {
                 elem_type_name = "Unknown";
             }
         } else {
-            auto lbrack = arr_type.name.find('[');
-            auto rbrack = arr_type.name.find(']');
+            auto lbrack = arr_type->name.find('[');
+            auto rbrack = arr_type->name.find(']');
             if (lbrack != std::string::npos && rbrack != std::string::npos && rbrack > lbrack + 1) {
-                elem_type_name = arr_type.name.substr(lbrack + 1, rbrack - lbrack - 1);
+                elem_type_name = arr_type->name.substr(lbrack + 1, rbrack - lbrack - 1);
             } else {
                 elem_type_name = "Unknown";
             }
@@ -550,7 +650,8 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
         return type_from_name(elem_type_name);
     }
 
-    if (auto num = dynamic_cast<const ast::NumberExpr*>(&expr)) {
+    case ast::ExprKind::Number: {
+        const auto* num = ast::cast<ast::NumberExpr>(&expr);
         const std::string& s = num->value;
         const bool is_float = (s.find('.') != std::string::npos) ||
                               (s.find('e') != std::string::npos) ||
@@ -560,62 +661,63 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
         return {TypeKind::Int, "Int32"};
     }
 
-    if (dynamic_cast<const ast::BoolExpr*>(&expr)) {
+    case ast::ExprKind::Bool: {
         return {TypeKind::Bool, "Bool"};
     }
 
-    if (dynamic_cast<const ast::StringExpr*>(&expr)) {
+    case ast::ExprKind::String: {
         return {TypeKind::String, "String"};
     }
 
-    if (auto tuple = dynamic_cast<const ast::TupleExpr*>(&expr)) {
+    case ast::ExprKind::Tuple: {
+        const auto* tuple = ast::cast<ast::TupleExpr>(&expr);
         std::string name = "(";
         bool first = true;
         bool any_never = false;
-        std::vector<FluxType> elems;
+        std::vector<TypeId> elems;
         for (const auto& elem : tuple->elements) {
-            FluxType t = type_of(*elem);
+            TypeId t = type_of(*elem);
             elems.push_back(t);
-            if (t.kind == TypeKind::Never)
+            if (t->kind == TypeKind::Never)
                 any_never = true;
             if (!first)
                 name += ", ";
-            name += t.name;
+            name += t->name;
             first = false;
         }
         if (any_never)
             return never_type();
         name += ")";
-        return FluxType(TypeKind::Tuple, name, false, {}, nullptr, std::move(elems));
+        return TypeId(TypeKind::Tuple, name, false, {}, {}, std::move(elems));
     }
 
-    if (auto lambda = dynamic_cast<const ast::LambdaExpr*>(&expr)) {
-        std::vector<FluxType> param_types;
+    case ast::ExprKind::Lambda: {
+        const auto* lambda = ast::cast<ast::LambdaExpr>(&expr);
+        std::vector<TypeId> param_types;
         std::string name = "(";
         bool first = true;
         for (const auto& param : lambda->params) {
-            FluxType t = type_from_name(param.type);
+            TypeId t = resolve_type(param.type);
             param_types.push_back(t);
             if (!first)
                 name += ", ";
-            name += t.name;
+            name += t->name;
             first = false;
         }
         name += ")";
 
-        FluxType return_type = type_from_name(lambda->return_type);
-        name += " -> " + return_type.name;
+        TypeId return_type = resolve_type(lambda->return_type);
+        name += " -> " + return_type->name;
 
-        FluxType fn_type(TypeKind::Function, name, false, param_types,
-                         std::make_unique<FluxType>(return_type));
-        return fn_type;
+        return TypeId(TypeKind::Function, name, false, std::move(param_types), return_type);
     }
 
-    if (dynamic_cast<const ast::CharExpr*>(&expr)) {
+    case ast::ExprKind::Char: {
         return {TypeKind::Char, "Char"};
     }
 
-    if (auto id = dynamic_cast<const ast::IdentifierExpr*>(&expr)) {
+    case ast::ExprKind::Identifier: {
+        const auto* id = ast::cast<ast::IdentifierExpr>(&expr);
         // Check if it's an enum variant used standalone
         if (is_enum_variant(id->name)) {
             std::string enum_name = find_enum_for_variant(id->name);
@@ -623,9 +725,7 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
         }
 
         if (id->name == "None") {
-            FluxType t(TypeKind::Option, "Option<Unknown>");
-            t.generic_args.push_back(unknown());
-            return t;
+            return {TypeKind::Option, "Option<Unknown>", false, {}, {}, {unknown()}};
         }
 
         if (id->name == "panic") {
@@ -633,81 +733,57 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                     "(String) -> Never",
                     false,
                     {type_from_name("String")},
-                    std::make_unique<FluxType>(never_type())};
+                    never_type()};
         }
         if (id->name == "drop") {
             return {TypeKind::Function,
                     "(T) -> Void",
                     false,
                     {unknown()},
-                    std::make_unique<FluxType>(void_type())};
+                    void_type()};
         }
         if (id->name == "assert") {
             return {TypeKind::Function,
                     "(Bool, String) -> Void",
                     false,
                     {type_from_name("Bool"), type_from_name("String")},
-                    std::make_unique<FluxType>(void_type())};
+                    void_type()};
         }
         if (id->name == "Some") {
-            FluxType t(TypeKind::Function, "(T) -> Option<T>");
-            t.generic_args.push_back(unknown());
-            return t;
+            return {TypeKind::Function, "(T) -> Option<T>", false, {}, void_type(), {unknown()}};
         }
         if (id->name == "Ok") {
-            FluxType t(TypeKind::Function, "(T) -> Result<T, E>");
-            t.generic_args.push_back(unknown());
-            return t;
+            return {TypeKind::Function, "(T) -> Result<T, E>", false, {}, void_type(), {unknown()}};
         }
         if (id->name == "Err") {
-            FluxType t(TypeKind::Function, "(E) -> Result<T, E>");
-            t.generic_args.push_back(unknown());
-            return t;
+            return {TypeKind::Function, "(E) -> Result<T, E>", false, {}, void_type(), {unknown()}};
         }
 
-        std::string lookup_name = id->name;
-        if (auto pos = lookup_name.find('<'); pos != std::string::npos) {
-            lookup_name = lookup_name.substr(0, pos);
+        const Symbol* sym = nullptr;
+        if (auto pos = id->name.str().find('<'); pos != std::string::npos) {
+            sym = current_scope_->lookup(std::string_view(id->name.str()).substr(0, pos));
+        } else {
+            sym = current_scope_->lookup(id->name);
         }
-
-        const Symbol* sym = current_scope_->lookup(lookup_name);
         if (!sym) {
             throw DiagnosticError("use of undeclared identifier '" + id->name + "'", 0, 0);
         }
 
-        if (sym->kind == SymbolKind::Function) {
-            std::vector<FluxType> params;
-            std::string name = "(";
-            bool first = true;
-            for (const auto& p : sym->param_types) {
-                FluxType t = type_from_name(p);
-                params.push_back(t);
-                if (!first)
-                    name += ", ";
-                name += t.name;
-                first = false;
-            }
-            name += ")";
-
-            FluxType ret = type_from_name(sym->type);
-            name += " -> " + ret.name;
-
-            return FluxType(TypeKind::Function, name, false, std::move(params),
-                            std::make_unique<FluxType>(std::move(ret)));
-        }
-
-        return type_from_name(sym->type);
+        if (sym->kind == SymbolKind::Function)
+            return function_type(*sym);
+        return symbol_type(*sym);
     }
 
-    if (auto bin = dynamic_cast<const ast::BinaryExpr*>(&expr)) {
+    case ast::ExprKind::Binary: {
+        const auto* bin = ast::cast<ast::BinaryExpr>(&expr);
         // Handle enum variant access: Color::Red
         if (bin->op == TokenKind::ColonColon) {
-            auto* lhs_id = dynamic_cast<const ast::IdentifierExpr*>(bin->left.get());
-            auto* rhs_id = dynamic_cast<const ast::IdentifierExpr*>(bin->right.get());
+            auto* lhs_id = ast::dyn_cast<ast::IdentifierExpr>(bin->left);
+            auto* rhs_id = ast::dyn_cast<ast::IdentifierExpr>(bin->right);
             if (lhs_id && rhs_id) {
                 // Check if it's an enum type with that variant
-                if (enum_variants_.contains(lhs_id->name)) {
-                    const auto& variants = enum_variants_.at(lhs_id->name);
+                if (declarations_->enum_variants.contains(lhs_id->name)) {
+                    const auto& variants = declarations_->enum_variants.at(lhs_id->name);
                     bool found = false;
                     for (const auto& v : variants) {
                         if (v == rhs_id->name) {
@@ -735,24 +811,9 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                         }
                     }
 
-                    if (sym->kind == SymbolKind::Function) {
-                        std::vector<FluxType> params;
-                        for (const auto& pt : sym->param_types) {
-                            params.push_back(type_from_name(pt));
-                        }
-                        FluxType ret_type = type_from_name(sym->type);
-                        std::string fn_signature = "(";
-                        for (size_t i = 0; i < params.size(); ++i) {
-                            if (i > 0)
-                                fn_signature += ", ";
-                            fn_signature += params[i].name;
-                        }
-                        fn_signature += ") -> " + ret_type.name;
-
-                        return FluxType(TypeKind::Function, fn_signature, false, std::move(params),
-                                        std::make_unique<FluxType>(std::move(ret_type)));
-                    }
-                    return type_from_name(sym->type);
+                    if (sym->kind == SymbolKind::Function)
+                        return function_type(*sym);
+                    return symbol_type(*sym);
                 }
             }
             return unknown();
@@ -761,24 +822,23 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
         // Handle dot access (field access / method call receiver)
         if (bin->op == TokenKind::Dot) {
             // Try to resolve the type of the left-hand side
-            FluxType lhs = type_of(*bin->left);
-            if (lhs.kind == TypeKind::Never)
+            TypeId lhs = type_of(*bin->left);
+            if (lhs->kind == TypeKind::Never)
                 return never_type();
 
             // Determine the field name (right side must be identifier)
-            if (auto rhs_id = dynamic_cast<const ast::IdentifierExpr*>(bin->right.get())) {
+            if (auto rhs_id = ast::dyn_cast<ast::IdentifierExpr>(bin->right)) {
                 const std::string field_name = rhs_id->name;
 
                 // Helper to lookup a field on a struct by base name
-                auto lookup_field =
-                    [&](const std::string& struct_name) -> std::optional<std::string> {
+                auto lookup_field = [&](const std::string& struct_name) -> const ast::TypeExpr* {
                     std::string base = struct_name;
                     auto pos = base.find('<');
                     if (pos != std::string::npos)
                         base = base.substr(0, pos);
-                    if (!struct_fields_.contains(base))
-                        return std::nullopt;
-                    for (const auto& p : struct_fields_.at(base)) {
+                    if (!declarations_->struct_fields.contains(base))
+                        return nullptr;
+                    for (const auto& p : declarations_->struct_fields.at(base)) {
                         if (p.name == field_name) {
                             // Enforce visibility
                             if (p.visibility == ast::Visibility::Private ||
@@ -799,18 +859,18 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                             return p.type;
                         }
                     }
-                    return std::nullopt;
+                    return nullptr;
                 };
 
                 // If lhs is a struct type, try to find the field
-                if (lhs.kind == TypeKind::Struct) {
-                    if (auto ftype = lookup_field(lhs.name)) {
-                        return type_from_name(*ftype);
+                if (lhs->kind == TypeKind::Struct) {
+                    if (const ast::TypeExpr* ftype = lookup_field(lhs->name)) {
+                        return resolve_type(ftype);
                     }
                 }
 
-                // 3. Try method lookup in scope (qualified name: FluxType::Method)
-                std::string base_type_name = lhs.name;
+                // 3. Try method lookup in scope (qualified name: Type::Method)
+                std::string base_type_name = lhs->name;
                 // Strip references (&Person -> Person)
                 if (base_type_name.starts_with("&mut ")) {
                     base_type_name = base_type_name.substr(5);
@@ -840,32 +900,16 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                                     "method '" + method_lookup_name + "' is private", 0, 0);
                             }
                         }
-                        std::vector<FluxType> params;
                         // Skip the first parameter (implicit 'self')
-                        for (size_t i = 1; i < sym->param_types.size(); ++i) {
-                            params.push_back(type_from_name(sym->param_types[i]));
-                        }
-                        FluxType ret_type = type_from_name(sym->type);
-
-                        // Construct a descriptive signature for the bound method
-                        std::string fn_signature = "(";
-                        for (size_t i = 0; i < params.size(); ++i) {
-                            if (i > 0)
-                                fn_signature += ", ";
-                            fn_signature += params[i].name;
-                        }
-                        fn_signature += ") -> " + ret_type.name;
-
-                        return FluxType(TypeKind::Function, fn_signature, false, std::move(params),
-                                        std::make_unique<FluxType>(std::move(ret_type)));
+                        return function_type(*sym, 1);
                     }
                 }
 
                 // 4. Try trait method lookup for generic parameters
                 // If lhs is Unknown, try to get the declared type name from the symbol
                 std::string type_for_bounds = base_type_name;
-                if (lhs.kind == TypeKind::Unknown || lhs.kind == TypeKind::Generic) {
-                    if (auto lhs_id = dynamic_cast<const ast::IdentifierExpr*>(bin->left.get())) {
+                if (lhs->kind == TypeKind::Unknown || lhs->kind == TypeKind::Generic) {
+                    if (auto lhs_id = ast::dyn_cast<ast::IdentifierExpr>(bin->left)) {
                         if (const Symbol* var_sym = current_scope_->lookup(lhs_id->name)) {
                             std::string declared = var_sym->type;
                             // Strip references
@@ -897,28 +941,13 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                                     continue;
                                 }
                             }
-                            std::vector<FluxType> params;
-                            for (size_t i = 1; i < sym->param_types.size(); ++i) {
-                                params.push_back(type_from_name(sym->param_types[i]));
-                            }
-                            FluxType ret_type = type_from_name(sym->type);
-                            std::string fn_signature = "(";
-                            for (size_t i = 0; i < params.size(); ++i) {
-                                if (i > 0)
-                                    fn_signature += ", ";
-                                fn_signature += params[i].name;
-                            }
-                            fn_signature += ") -> " + ret_type.name;
-
-                            return FluxType(TypeKind::Function, fn_signature, false,
-                                            std::move(params),
-                                            std::make_unique<FluxType>(std::move(ret_type)));
+                            return function_type(*sym, 1);
                         }
                     }
-                    // Fallback: search trait_methods_ directly (for trait declarations
+                    // Fallback: search the trait_methods table directly (for trait declarations
                     // whose methods haven't been registered as symbols in scope)
-                    auto tm_it = trait_methods_.find(tb_name);
-                    if (tm_it != trait_methods_.end()) {
+                    auto tm_it = declarations_->trait_methods.find(tb_name);
+                    if (tm_it != declarations_->trait_methods.end()) {
                         for (const auto& sig : tm_it->second) {
                             if (sig.name == field_name) {
                                 if (sig.visibility == ast::Visibility::Private ||
@@ -928,38 +957,37 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                                         continue;
                                     }
                                 }
-                                std::vector<FluxType> params;
+                                std::vector<TypeId> params;
                                 for (const auto& pt : sig.param_types) {
                                     params.push_back(type_from_name(pt));
                                 }
-                                FluxType ret_type = type_from_name(sig.return_type);
+                                TypeId ret_type = type_from_name(sig.return_type);
                                 std::string fn_signature = "(";
                                 for (size_t i = 0; i < params.size(); ++i) {
                                     if (i > 0)
                                         fn_signature += ", ";
-                                    fn_signature += params[i].name;
+                                    fn_signature += params[i]->name;
                                 }
-                                fn_signature += ") -> " + ret_type.name;
+                                fn_signature += ") -> " + ret_type->name;
 
-                                return FluxType(TypeKind::Function, fn_signature, false,
-                                                std::move(params),
-                                                std::make_unique<FluxType>(std::move(ret_type)));
+                                return TypeId(TypeKind::Function, fn_signature, false,
+                                              std::move(params), ret_type);
                             }
                         }
                     }
                 }
 
                 throw DiagnosticError(
-                    "type '" + lhs.name + "' has no field or method '" + field_name + "'", 0, 0);
+                    "type '" + lhs->name + "' has no field or method '" + field_name + "'", 0, 0);
             }
 
             throw DiagnosticError("right side of '.' must be an identifier", 0, 0);
         }
 
-        FluxType lhs = type_of(*bin->left);
-        FluxType rhs = type_of(*bin->right);
+        TypeId lhs = type_of(*bin->left);
+        TypeId rhs = type_of(*bin->right);
 
-        if (lhs.kind == TypeKind::Never || rhs.kind == TypeKind::Never) {
+        if (lhs->kind == TypeKind::Never || rhs->kind == TypeKind::Never) {
             return never_type();
         }
 
@@ -972,13 +1000,13 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
         if (bin->op == TokenKind::Plus || bin->op == TokenKind::Minus ||
             bin->op == TokenKind::Star || bin->op == TokenKind::Slash ||
             bin->op == TokenKind::Percent) {
-            if (lhs.kind != rhs.kind && lhs.kind != TypeKind::Unknown &&
-                rhs.kind != TypeKind::Unknown) {
+            if (lhs->kind != rhs->kind && lhs->kind != TypeKind::Unknown &&
+                rhs->kind != TypeKind::Unknown) {
                 throw DiagnosticError("type mismatch in binary expression", 0, 0);
             }
 
-            if (lhs.kind != TypeKind::Int && lhs.kind != TypeKind::Float &&
-                lhs.kind != TypeKind::Unknown) {
+            if (lhs->kind != TypeKind::Int && lhs->kind != TypeKind::Float &&
+                lhs->kind != TypeKind::Unknown) {
                 throw DiagnosticError("invalid operands for arithmetic operator", 0, 0);
             }
 
@@ -989,7 +1017,7 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
         if (bin->op == TokenKind::Amp || bin->op == TokenKind::Pipe ||
             bin->op == TokenKind::Caret || bin->op == TokenKind::ShiftLeft ||
             bin->op == TokenKind::ShiftRight) {
-            if (lhs.kind != TypeKind::Int && lhs.kind != TypeKind::Unknown) {
+            if (lhs->kind != TypeKind::Int && lhs->kind != TypeKind::Unknown) {
                 throw DiagnosticError("invalid operands for bitwise operator", 0, 0);
             }
             return lhs;
@@ -999,7 +1027,7 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
         if (bin->op == TokenKind::EqualEqual || bin->op == TokenKind::BangEqual ||
             bin->op == TokenKind::Less || bin->op == TokenKind::LessEqual ||
             bin->op == TokenKind::Greater || bin->op == TokenKind::GreaterEqual) {
-            if (lhs != rhs && lhs.kind != TypeKind::Unknown && rhs.kind != TypeKind::Unknown) {
+            if (lhs != rhs && lhs->kind != TypeKind::Unknown && rhs->kind != TypeKind::Unknown) {
                 throw DiagnosticError("comparison between incompatible types", 0, 0);
             }
 
@@ -1008,28 +1036,30 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
 
         // Logical operators
         if (bin->op == TokenKind::AmpAmp || bin->op == TokenKind::PipePipe) {
-            if ((lhs.kind != TypeKind::Bool && lhs.kind != TypeKind::Unknown) ||
-                (rhs.kind != TypeKind::Bool && rhs.kind != TypeKind::Unknown)) {
+            if ((lhs->kind != TypeKind::Bool && lhs->kind != TypeKind::Unknown) ||
+                (rhs->kind != TypeKind::Bool && rhs->kind != TypeKind::Unknown)) {
                 throw DiagnosticError("logical operators require Bool operands", 0, 0);
             }
             return {TypeKind::Bool, "Bool"};
         }
+        break;
     }
 
-    if (auto un = dynamic_cast<const ast::UnaryExpr*>(&expr)) {
-        FluxType operand = type_of(*un->operand);
-        if (operand.kind == TypeKind::Never)
+    case ast::ExprKind::Unary: {
+        const auto* un = ast::cast<ast::UnaryExpr>(&expr);
+        TypeId operand = type_of(*un->operand);
+        if (operand->kind == TypeKind::Never)
             return never_type();
 
         if (un->op == TokenKind::Minus) {
-            if (operand.kind != TypeKind::Int && operand.kind != TypeKind::Float) {
+            if (operand->kind != TypeKind::Int && operand->kind != TypeKind::Float) {
                 throw DiagnosticError("invalid operand for unary '-'", 0, 0);
             }
             return operand;
         }
 
         if (un->op == TokenKind::Bang) {
-            if (operand.kind != TypeKind::Bool) {
+            if (operand->kind != TypeKind::Bool) {
                 throw DiagnosticError("invalid operand for '!'", 0, 0);
             }
             return {TypeKind::Bool, "Bool"};
@@ -1038,52 +1068,55 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
         if (un->op == TokenKind::Amp) {
             // Handle mutable and immutable references
             if (un->is_mutable) {
-                return {TypeKind::Ref, "&mut " + operand.name, true};
+                return {TypeKind::Ref, "&mut " + operand->name, true};
             } else {
-                return {TypeKind::Ref, "&" + operand.name, false};
+                return {TypeKind::Ref, "&" + operand->name, false};
             }
         }
 
         if (un->op == TokenKind::Tilde) {
-            if (operand.kind != TypeKind::Int) {
+            if (operand->kind != TypeKind::Int) {
                 throw DiagnosticError("invalid operand for '~'", 0, 0);
             }
             return operand;
         }
+        break;
     }
 
-    if (auto cast = dynamic_cast<const ast::CastExpr*>(&expr)) {
+    case ast::ExprKind::Cast: {
+        const auto* cast = ast::cast<ast::CastExpr>(&expr);
         (void)type_of(*cast->expr);
-        FluxType target = type_from_name(cast->target_type);
-        if (target.kind == TypeKind::Unknown) {
+        TypeId target = resolve_type(cast->target_type);
+        if (target->kind == TypeKind::Unknown) {
             return target;
         }
-    } // This closing brace was missing in the original code, but the diff implies it should be
-      // here.
+        break;
+    }
 
-    if (const auto* call = dynamic_cast<const ast::CallExpr*>(&expr)) {
-        FluxType callee_type = unknown();
+    case ast::ExprKind::Call: {
+        const auto* call = ast::cast<ast::CallExpr>(&expr);
+        TypeId callee_type = unknown();
 
         // 1. Resolve callee type
         if (call->callee) {
             callee_type = type_of(*call->callee);
-            if (callee_type.kind == TypeKind::Never)
+            if (callee_type->kind == TypeKind::Never)
                 return never_type();
         }
 
         // Record method call instantiations for dot-access calls.
         // type_of for dot-access returns the method's return type, not TypeKind::Function,
         // so the recording block inside the Function check below is never reached.
-        if (auto bin = dynamic_cast<const ast::BinaryExpr*>(call->callee.get())) {
+        if (auto bin = ast::dyn_cast<ast::BinaryExpr>(call->callee)) {
             if (bin->op == TokenKind::Dot || bin->op == TokenKind::ColonColon) {
 
                 try {
                     std::string lhs_base;
-                    FluxType lhs_type;
+                    TypeId lhs_type;
 
                     if (bin->op == TokenKind::Dot) {
                         lhs_type = type_of(*bin->left);
-                        lhs_base = lhs_type.name;
+                        lhs_base = lhs_type->name;
                         if (lhs_base.starts_with("&mut "))
                             lhs_base = lhs_base.substr(5);
                         else if (lhs_base.starts_with("&"))
@@ -1091,50 +1124,50 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                         if (auto pos = lhs_base.find('<'); pos != std::string::npos)
                             lhs_base = lhs_base.substr(0, pos);
                     } else if (bin->op == TokenKind::ColonColon) {
-                        if (auto lid = dynamic_cast<const ast::IdentifierExpr*>(bin->left.get())) {
+                        if (auto lid = ast::dyn_cast<ast::IdentifierExpr>(bin->left)) {
                             lhs_base = lid->name;
                         } else {
                             lhs_type = type_of(*bin->left);
-                            lhs_base = lhs_type.name;
+                            lhs_base = lhs_type->name;
                         }
                     }
 
-                    if (auto rhs_id = dynamic_cast<const ast::IdentifierExpr*>(bin->right.get())) {
+                    if (auto rhs_id = ast::dyn_cast<ast::IdentifierExpr>(bin->right)) {
                         std::string callee_name = rhs_id->name;
                         std::string method_name = callee_name;
                         if (auto pos = method_name.find('<'); pos != std::string::npos)
                             method_name = method_name.substr(0, pos);
                         std::string qualified = lhs_base + "::" + method_name;
 
-                        auto tp_it = function_type_params_.find(qualified);
-                        if (tp_it != function_type_params_.end()) {
+                        auto tp_it = declarations_->function_type_params.find(qualified);
+                        if (tp_it != declarations_->function_type_params.end()) {
                             auto bounds = parse_type_param_bounds(tp_it->second);
                             std::unordered_map<std::string, std::string> param_mapping;
 
                             // 1. Map struct type params from LHS receiver type
-                            if (!lhs_type.generic_args.empty()) {
-                                auto it = type_type_params_.find(lhs_base);
-                                if (it != type_type_params_.end()) {
+                            if (!lhs_type->generic_args.empty()) {
+                                auto it = declarations_->type_type_params.find(lhs_base);
+                                if (it != declarations_->type_type_params.end()) {
                                     std::vector<std::string> raw;
                                     for (const auto& p : it->second) {
                                         if (p.find(':') == std::string::npos)
                                             raw.push_back(p);
                                     }
                                     for (size_t i = 0;
-                                         i < raw.size() && i < lhs_type.generic_args.size(); ++i) {
-                                        param_mapping[raw[i]] = lhs_type.generic_args[i].name;
+                                         i < raw.size() && i < lhs_type->generic_args.size(); ++i) {
+                                        param_mapping[raw[i]] = lhs_type->generic_args[i]->name;
                                     }
                                 }
                             } else if (!substitution_map_.empty()) {
                                 // During monomorphization, 'self' has bare type (e.g. Wrapper)
                                 // without generic args. Use the current substitution_map_ to
                                 // fill in concrete types for struct type params.
-                                auto it = type_type_params_.find(lhs_base);
-                                if (it != type_type_params_.end()) {
+                                auto it = declarations_->type_type_params.find(lhs_base);
+                                if (it != declarations_->type_type_params.end()) {
                                     for (const auto& p : it->second) {
                                         if (p.find(':') == std::string::npos &&
                                             substitution_map_.contains(p)) {
-                                            param_mapping[p] = substitution_map_[p].name;
+                                            param_mapping[p] = substitution_map_[p]->name;
                                         }
                                     }
                                 }
@@ -1143,7 +1176,7 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                             // 2. Map method's own type params from explicit generic args
                             // Parse generic args from callee_name manually since type_from_name
                             // cannot resolve function names that aren't registered type names.
-                            std::vector<FluxType> explicit_args;
+                            std::vector<TypeId> explicit_args;
                             if (auto angle = callee_name.find('<'); angle != std::string::npos) {
                                 std::string args_str = callee_name.substr(angle + 1);
                                 if (!args_str.empty() && args_str.back() == '>')
@@ -1175,8 +1208,8 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                                 }
                                 // Offset past struct params
                                 size_t struct_count = 0;
-                                auto struct_it = type_type_params_.find(lhs_base);
-                                if (struct_it != type_type_params_.end()) {
+                                auto struct_it = declarations_->type_type_params.find(lhs_base);
+                                if (struct_it != declarations_->type_type_params.end()) {
                                     for (const auto& p : struct_it->second) {
                                         if (p.find(':') == std::string::npos)
                                             struct_count++;
@@ -1186,12 +1219,12 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                                                    (i + struct_count) < all_raw.size();
                                      ++i) {
                                     param_mapping[all_raw[i + struct_count]] =
-                                        explicit_args[i].name;
+                                        explicit_args[i]->name;
                                 }
                             }
 
                             // 3. Record the instantiation
-                            std::vector<FluxType> concrete_args;
+                            std::vector<TypeId> concrete_args;
                             for (const auto& p : tp_it->second) {
                                 std::string param_name = p;
                                 auto colon = param_name.find(':');
@@ -1221,39 +1254,35 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
         }
 
         // Special handling for Option/Result constructors
-        if (auto callee_id = dynamic_cast<const ast::IdentifierExpr*>(call->callee.get())) {
+        if (auto callee_id = ast::dyn_cast<ast::IdentifierExpr>(call->callee)) {
             if (callee_id->name == "Some" && call->arguments.size() == 1) {
-                FluxType val_type = type_of(*call->arguments[0]);
-                if (val_type.kind == TypeKind::Never)
+                TypeId val_type = type_of(*call->arguments[0]);
+                if (val_type->kind == TypeKind::Never)
                     return never_type();
-                FluxType t(TypeKind::Option, "Option<" + val_type.name + ">");
-                t.generic_args.push_back(val_type);
-                return t;
+                return {TypeKind::Option, "Option<" + val_type->name + ">", false, {}, {},
+                        {val_type}};
             }
             if (callee_id->name == "Ok" && call->arguments.size() == 1) {
-                FluxType val_type = type_of(*call->arguments[0]);
-                if (val_type.kind == TypeKind::Never)
+                TypeId val_type = type_of(*call->arguments[0]);
+                if (val_type->kind == TypeKind::Never)
                     return never_type();
-                FluxType t(TypeKind::Result, "Result<" + val_type.name + ", Unknown>");
-                t.generic_args.push_back(val_type);
-                t.generic_args.push_back(unknown());
-                return t;
+                return {TypeKind::Result, "Result<" + val_type->name + ", Unknown>", false, {}, {},
+                        {val_type, unknown()}};
             }
             if (callee_id->name == "Err" && call->arguments.size() == 1) {
-                FluxType err_type = type_of(*call->arguments[0]);
-                if (err_type.kind == TypeKind::Never)
+                TypeId err_type = type_of(*call->arguments[0]);
+                if (err_type->kind == TypeKind::Never)
                     return never_type();
-                FluxType t(TypeKind::Result, "Result<Unknown, " + err_type.name + ">");
-                t.generic_args.push_back(unknown());
-                t.generic_args.push_back(err_type);
-                return t;
+                return {TypeKind::Result, "Result<Unknown, " + err_type->name + ">", false, {}, {},
+                        {unknown(), err_type}};
             }
         }
 
         // 2. Check if it's a function type
-        if (callee_type.kind == TypeKind::Function) {
-            if (call->arguments.size() != callee_type.param_types.size()) {
-                throw DiagnosticError("expected " + std::to_string(callee_type.param_types.size()) +
+        if (callee_type->kind == TypeKind::Function) {
+            if (call->arguments.size() != callee_type->param_types.size()) {
+                throw DiagnosticError("expected " +
+                                          std::to_string(callee_type->param_types.size()) +
                                           " arguments, got " +
                                           std::to_string(call->arguments.size()),
                                       0, 0);
@@ -1261,15 +1290,15 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
 
             bool any_never = false;
             for (size_t i = 0; i < call->arguments.size(); ++i) {
-                FluxType arg_type = type_of(*call->arguments[i]);
-                if (arg_type.kind == TypeKind::Never)
+                TypeId arg_type = type_of(*call->arguments[i]);
+                if (arg_type->kind == TypeKind::Never)
                     any_never = true;
-                FluxType param_type = callee_type.param_types[i];
+                TypeId param_type = callee_type->param_types[i];
 
-                if (arg_type != param_type && param_type.kind != TypeKind::Unknown &&
-                    arg_type.kind != TypeKind::Unknown && arg_type.kind != TypeKind::Never) {
+                if (arg_type != param_type && param_type->kind != TypeKind::Unknown &&
+                    arg_type->kind != TypeKind::Unknown && arg_type->kind != TypeKind::Never) {
                     throw DiagnosticError("argument " + std::to_string(i + 1) + " has type '" +
-                                              arg_type.name + "', expected '" + param_type.name +
+                                              arg_type->name + "', expected '" + param_type->name +
                                               "'",
                                           0, 0);
                 }
@@ -1278,13 +1307,13 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
             // Trait bound enforcement: check type param bounds against concrete arg types
             std::string base;
             std::string callee_full_name;
-            if (auto callee_id = dynamic_cast<const ast::IdentifierExpr*>(call->callee.get())) {
+            if (auto callee_id = ast::dyn_cast<ast::IdentifierExpr>(call->callee)) {
                 base = callee_id->name;
                 callee_full_name = callee_id->name;
-            } else if (auto bin = dynamic_cast<const ast::BinaryExpr*>(call->callee.get())) {
+            } else if (auto bin = ast::dyn_cast<ast::BinaryExpr>(call->callee)) {
                 if (bin->op == TokenKind::Dot || bin->op == TokenKind::ColonColon) {
-                    FluxType lhs_type = type_of(*bin->left);
-                    std::string lhs_name = lhs_type.name;
+                    TypeId lhs_type = type_of(*bin->left);
+                    std::string lhs_name = lhs_type->name;
                     // Strip pointers and references
                     if (lhs_name.starts_with("&mut "))
                         lhs_name = lhs_name.substr(5);
@@ -1296,7 +1325,7 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                         lhs_name = lhs_name.substr(0, pos);
                     }
 
-                    if (auto rhs_id = dynamic_cast<const ast::IdentifierExpr*>(bin->right.get())) {
+                    if (auto rhs_id = ast::dyn_cast<ast::IdentifierExpr>(bin->right)) {
                         callee_full_name = rhs_id->name;
                         base = lhs_name + "::" + rhs_id->name;
                     }
@@ -1308,16 +1337,16 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                     base = base.substr(0, pos);
                 }
 
-                auto tp_it = function_type_params_.find(base);
-                if (tp_it != function_type_params_.end()) {
+                auto tp_it = declarations_->function_type_params.find(base);
+                if (tp_it != declarations_->function_type_params.end()) {
                     auto bounds = parse_type_param_bounds(tp_it->second);
                     auto sym = current_scope_->lookup(base);
                     if (sym && sym->kind == SymbolKind::Function) {
                         std::unordered_map<std::string, std::string> param_mapping;
 
                         // Explicit generic args from callee name (e.g. foo<Int32>)
-                        FluxType explicit_type = type_from_name(callee_full_name);
-                        if (!explicit_type.generic_args.empty()) {
+                        TypeId explicit_type = type_from_name(callee_full_name);
+                        if (!explicit_type->generic_args.empty()) {
                             std::vector<std::string> raw_params;
                             for (const auto& p : tp_it->second) {
                                 if (p.find(':') == std::string::npos) {
@@ -1333,8 +1362,8 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                                 if (auto pos = type_name.find('<'); pos != std::string::npos)
                                     type_name = type_name.substr(0, pos);
 
-                                auto struct_it = type_type_params_.find(type_name);
-                                if (struct_it != type_type_params_.end()) {
+                                auto struct_it = declarations_->type_type_params.find(type_name);
+                                if (struct_it != declarations_->type_type_params.end()) {
                                     for (const auto& p : struct_it->second) {
                                         if (p.find(':') == std::string::npos)
                                             offset++;
@@ -1342,36 +1371,36 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                                 }
                             }
 
-                            for (size_t i = 0; i < explicit_type.generic_args.size() &&
+                            for (size_t i = 0; i < explicit_type->generic_args.size() &&
                                                (i + offset) < raw_params.size();
                                  ++i) {
                                 param_mapping[raw_params[i + offset]] =
-                                    explicit_type.generic_args[i].name;
+                                    explicit_type->generic_args[i]->name;
                             }
                         }
 
                         // Inference from lhs (for methods like p.foo())
-                        if (auto bin = dynamic_cast<const ast::BinaryExpr*>(call->callee.get())) {
+                        if (auto bin = ast::dyn_cast<ast::BinaryExpr>(call->callee)) {
                             if (bin->op == TokenKind::Dot || bin->op == TokenKind::ColonColon) {
-                                FluxType lhs_type = type_of(*bin->left);
-                                if (!lhs_type.generic_args.empty()) {
+                                TypeId lhs_type = type_of(*bin->left);
+                                if (!lhs_type->generic_args.empty()) {
                                     // Extract base type name to get its type params
-                                    std::string lhs_base = lhs_type.name;
+                                    std::string lhs_base = lhs_type->name;
                                     if (auto pos = lhs_base.find('<'); pos != std::string::npos)
                                         lhs_base = lhs_base.substr(0, pos);
 
-                                    auto it = type_type_params_.find(lhs_base);
-                                    if (it != type_type_params_.end()) {
+                                    auto it = declarations_->type_type_params.find(lhs_base);
+                                    if (it != declarations_->type_type_params.end()) {
                                         std::vector<std::string> raw_params;
                                         for (const auto& p : it->second) {
                                             if (p.find(':') == std::string::npos)
                                                 raw_params.push_back(p);
                                         }
                                         for (size_t i = 0; i < raw_params.size() &&
-                                                           i < lhs_type.generic_args.size();
+                                                           i < lhs_type->generic_args.size();
                                              ++i) {
                                             param_mapping[raw_params[i]] =
-                                                lhs_type.generic_args[i].name;
+                                                lhs_type->generic_args[i]->name;
                                         }
                                     }
                                 }
@@ -1382,7 +1411,7 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                         // Note: for methods, sym->param_types[0] is 'self', but call->arguments[0]
                         // is the first REAL arg.
                         size_t sym_offset = 0;
-                        if (auto bin = dynamic_cast<const ast::BinaryExpr*>(call->callee.get())) {
+                        if (auto bin = ast::dyn_cast<ast::BinaryExpr>(call->callee)) {
                             if (bin->op == TokenKind::Dot || bin->op == TokenKind::ColonColon) {
                                 sym_offset = 1;
                             }
@@ -1393,10 +1422,10 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                              ++i) {
                             for (const auto& b : bounds) {
                                 if (sym->param_types[i + sym_offset] == b.param_name) {
-                                    FluxType arg_type = type_of(*call->arguments[i]);
-                                    if (arg_type.kind != TypeKind::Unknown &&
-                                        arg_type.kind != TypeKind::Never) {
-                                        param_mapping[b.param_name] = arg_type.name;
+                                    TypeId arg_type = type_of(*call->arguments[i]);
+                                    if (arg_type->kind != TypeKind::Unknown &&
+                                        arg_type->kind != TypeKind::Never) {
+                                        param_mapping[b.param_name] = arg_type->name;
                                     }
                                 }
                             }
@@ -1418,7 +1447,7 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                         }
 
                         // Record function instantiation
-                        std::vector<FluxType> concrete_args;
+                        std::vector<TypeId> concrete_args;
                         for (const auto& p : tp_it->second) {
                             std::string param_name = p;
                             auto colon = param_name.find(':');
@@ -1446,20 +1475,18 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
             if (any_never)
                 return never_type();
 
-            if (callee_type.return_type)
-                return *callee_type.return_type;
-            return void_type();
+            return callee_type->return_type;
         }
 
         // Special handling for panic built-in if callee resolution is simple
-        if (auto callee_id = dynamic_cast<const ast::IdentifierExpr*>(call->callee.get())) {
+        if (auto callee_id = ast::dyn_cast<ast::IdentifierExpr>(call->callee)) {
             if (callee_id->name == "panic") {
                 return never_type();
             }
         }
 
         // 3. Built-ins (fallback if callee resolution failed or returned non-Function)
-        if (callee_type.kind == TypeKind::Unknown) {
+        if (callee_type->kind == TypeKind::Unknown) {
             for (const auto& arg : call->arguments) {
                 resolve_expression(*arg);
             }
@@ -1469,30 +1496,32 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
         throw DiagnosticError("called object is not a function", 0, 0);
     }
 
-    if (auto mv = dynamic_cast<const ast::MoveExpr*>(&expr)) {
+    case ast::ExprKind::Move: {
+        const auto* mv = ast::cast<ast::MoveExpr>(&expr);
         return type_of(*mv->operand);
     }
 
-    if (auto sl = dynamic_cast<const ast::StructLiteralExpr*>(&expr)) {
+    case ast::ExprKind::StructLiteral: {
+        const auto* sl = ast::cast<ast::StructLiteralExpr>(&expr);
         // Get base struct name (strip generic params)
         std::string base = sl->struct_name;
         if (auto pos = base.find('<'); pos != std::string::npos) {
             base = base.substr(0, pos);
         }
 
-        if (!struct_fields_.contains(base) && !enum_variants_.contains(base) &&
-            !current_scope_->lookup(base)) {
+        if (!declarations_->struct_fields.contains(base) &&
+            !declarations_->enum_variants.contains(base) && !current_scope_->lookup(base)) {
             return {TypeKind::Struct, sl->struct_name};
         }
 
         // Check generic bounds if any
-        auto tp_it = type_type_params_.find(base);
-        if (tp_it != type_type_params_.end()) {
+        auto tp_it = declarations_->type_type_params.find(base);
+        if (tp_it != declarations_->type_type_params.end()) {
             auto bounds = parse_type_param_bounds(tp_it->second);
-            FluxType concrete = type_from_name(sl->struct_name);
+            TypeId concrete = type_from_name(sl->struct_name);
 
             // Map type param names to concrete types
-            if (concrete.generic_args.size() > 0) {
+            if (concrete->generic_args.size() > 0) {
                 std::vector<std::string> raw_params;
                 for (const auto& p : tp_it->second) {
                     if (p.find(':') == std::string::npos) {
@@ -1501,8 +1530,9 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                 }
 
                 std::unordered_map<std::string, std::string> mapping;
-                for (size_t i = 0; i < raw_params.size() && i < concrete.generic_args.size(); ++i) {
-                    mapping[raw_params[i]] = concrete.generic_args[i].name;
+                for (size_t i = 0; i < raw_params.size() && i < concrete->generic_args.size();
+                     ++i) {
+                    mapping[raw_params[i]] = concrete->generic_args[i]->name;
                 }
 
                 // Now check all bounds
@@ -1524,8 +1554,8 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
                 }
 
                 // Record type instantiation
-                if (!concrete.generic_args.empty()) {
-                    record_type_instantiation(base, concrete.generic_args);
+                if (!concrete->generic_args.empty()) {
+                    record_type_instantiation(base, concrete->generic_args);
                 }
             }
         }
@@ -1533,37 +1563,40 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
         return type_from_name(sl->struct_name);
     }
 
-    // Track location for diagnostics
-    last_loc_.line = expr.line;
-    last_loc_.column = expr.column;
-
-    if (auto ep = dynamic_cast<const ast::ErrorPropagationExpr*>(&expr)) {
-        FluxType op_type = type_of(*ep->operand);
-        if (op_type.kind == TypeKind::Option || op_type.kind == TypeKind::Result) {
-            if (!op_type.generic_args.empty()) {
-                return op_type.generic_args[0];
+    case ast::ExprKind::ErrorPropagation: {
+        const auto* ep = ast::cast<ast::ErrorPropagationExpr>(&expr);
+        TypeId op_type = type_of(*ep->operand);
+        if (op_type->kind == TypeKind::Option || op_type->kind == TypeKind::Result) {
+            if (!op_type->generic_args.empty()) {
+                return op_type->generic_args[0];
             }
         }
         return op_type;
     }
 
-    if (auto awt = dynamic_cast<const ast::AwaitExpr*>(&expr)) {
+    case ast::ExprKind::Await: {
+        const auto* awt = ast::cast<ast::AwaitExpr>(&expr);
         if (!is_in_async_context_) {
             throw flux::DiagnosticError("'await' is only allowed inside an 'async' function",
-                                        (std::size_t)expr.line, (std::size_t)expr.column);
+                                        expr.loc);
         }
         return type_of(*awt->operand);
     }
 
-    if (auto spw = dynamic_cast<const ast::SpawnExpr*>(&expr)) {
+    case ast::ExprKind::Spawn: {
+        const auto* spw = ast::cast<ast::SpawnExpr>(&expr);
         return type_of(*spw->operand);
     }
 
-    if (dynamic_cast<const ast::RangeExpr*>(&expr)) {
-        FluxType t(TypeKind::Struct, "Range");
+    case ast::ExprKind::Range: {
+        TypeId t(TypeKind::Struct, "Range");
         return t;
     }
 
+    default:
+        break;
+    }
+
     return unknown();
 
     // literals (NumberExpr, StringExpr, BoolExpr, CharExpr) are fine
@@ -1573,14 +1606,21 @@ FluxType Resolver::type_of(const ast::Expr& expr) {
    Scope management
    ======================= */
 
+Declarations& Resolver::declaring() {
+    if (!declaring_)
+        throw std::logic_error("declaration tables are read-only in a body worker");
+    return *declaring_;
+}
+
 void Resolver::enter_scope() {
-    auto new_scope = std::make_unique<Scope>(current_scope_);
+    auto new_scope = std::make_shared<Scope>(current_scope_, 0, &flow_);
     current_scope_ = new_scope.get();
     all_scopes_.push_back(std::move(new_scope));
 }
 
 void Resolver::exit_scope() {
     if (current_scope_) {
+        flow_.truncate(current_scope_->flow_mark());
         current_scope_ = current_scope_->parent();
     }
 }
@@ -1593,7 +1633,7 @@ void Resolver::initialize_intrinsics() {
     if (!all_scopes_.empty())
         return;
 
-    auto global_scope = std::make_unique<Scope>(nullptr);
+    auto global_scope = std::make_shared<Scope>(nullptr, 0, &flow_);
     current_scope_ = global_scope.get();
     all_scopes_.push_back(std::move(global_scope));
 
@@ -1676,12 +1716,21 @@ void Resolver::resolve(const std::vector<ast::Module*>& modules) {
 
     // Pass 1: Declare all entities in all modules
     for (const auto* module : modules) {
-        declare_module(*module);
+        declare_or_replay(*module);
     }
 
     // Pass 2: Resolve all bodies in all modules
+    declared_flow_ = flow_.save();
+    std::vector<BodyTask> bodies;
     for (const auto* module : modules) {
-        resolve_module_bodies(*module);
+        if (!body_modules_ || body_modules_->contains(module))
+            collect_bodies(*module, bodies);
+    }
+    // One thread gains nothing from a worker resolver.
+    if ((jobs_ == 0 ? ThreadPool::default_threads() : jobs_) == 1) {
+        resolve_bodies(bodies);
+    } else {
+        resolve_bodies_parallel(bodies);
     }
 
     // Pass 3: Monomorphization
@@ -1698,9 +1747,123 @@ void Resolver::resolve(const ast::Module& module) {
    Module
    ======================= */
 
-void Resolver::resolve_module(const ast::Module& module) {
-    declare_module(module);
-    resolve_module_bodies(module);
+namespace {
+constexpr DeclarationTable<std::vector<std::string>> kEnumVariants{
+    &Declarations::enum_variants, &ModuleDeclarations::enum_variants};
+constexpr DeclarationTable<std::vector<FieldInfo>> kStructFields{
+    &Declarations::struct_fields, &ModuleDeclarations::struct_fields};
+constexpr DeclarationTable<std::vector<FieldInfo>> kClassFields{
+    &Declarations::class_fields, &ModuleDeclarations::class_fields};
+constexpr DeclarationTable<const ast::TypeExpr*> kTypeAliases{&Declarations::type_aliases,
+                                                              &ModuleDeclarations::type_aliases};
+constexpr DeclarationTable<std::vector<TraitMethodSig>> kTraitMethods{
+    &Declarations::trait_methods, &ModuleDeclarations::trait_methods};
+constexpr DeclarationTable<std::vector<std::string>> kFunctionTypeParams{
+    &Declarations::function_type_params, &ModuleDeclarations::function_type_params};
+constexpr DeclarationTable<std::vector<std::string>> kTypeTypeParams{
+    &Declarations::type_type_params, &ModuleDeclarations::type_type_params};
+constexpr DeclarationTable<std::vector<std::string>> kTraitTypeParams{
+    &Declarations::trait_type_params, &ModuleDeclarations::trait_type_params};
+constexpr DeclarationTable<std::vector<std::string>> kTraitAssociatedTypes{
+    &Declarations::trait_associated_types, &ModuleDeclarations::trait_associated_types};
+constexpr DeclarationTable<const ast::FunctionDecl*> kFunctionDecls{
+    &Declarations::function_decls, &ModuleDeclarations::function_decls};
+
+template <typename Value>
+void replay_table(Declarations& tables, ModuleDeclarations& record,
+                  const DeclarationTable<Value>& table) {
+    auto& entries = tables.*table.entries;
+    for (auto& [key, value] : record.*table.log)
+        entries.insert_or_assign(std::move(key), std::move(value));
+}
+} // namespace
+
+template <typename Value>
+void Resolver::declare_entry(const DeclarationTable<Value>& table, const std::string& key,
+                             std::type_identity_t<Value> value) {
+    if (recording_)
+        (recording_->*table.log).emplace_back(key, value);
+    (declaring().*table.entries)[key] = std::move(value);
+}
+
+bool Resolver::declare_symbol(Scope& scope, const Symbol& symbol) {
+    if (recording_)
+        recording_->symbols.push_back({&scope == all_scopes_[0].get(), symbol});
+    return scope.declare(symbol);
+}
+
+void Resolver::reuse_declarations(const ast::Module& module, std::string record) {
+    reusable_.insert_or_assign(&module, std::move(record));
+}
+
+const std::string* Resolver::declarations(const ast::Module& module) const {
+    auto it = records_.find(&module);
+    return it == records_.end() ? nullptr : &it->second;
+}
+
+void Resolver::declare_or_replay(const ast::Module& module) {
+    auto reusable = reusable_.extract(&module);
+    // Without records to keep or replay, the contexts are not needed either.
+    if (!record_declarations_ && !reusable && reusable_.empty()) {
+        declare_module(module);
+        return;
+    }
+
+    std::optional<ModuleDeclarations> replay;
+    if (reusable && declared_context_ &&
+        declarations_context(reusable.mapped()) == declared_context_) {
+        replay = deserialize_declarations(reusable.mapped(), module);
+    }
+    std::optional<std::string> record;
+    if (replay) {
+        current_module_name_ = module.name;
+        replay_declarations(std::move(*replay));
+        replayed_.insert(&module);
+        record = std::move(reusable.mapped());
+    } else {
+        ModuleDeclarations declared;
+        declared.context = declared_context_.value_or(0);
+        recording_ = &declared;
+        try {
+            declare_module(module);
+        } catch (...) {
+            recording_ = nullptr;
+            throw;
+        }
+        recording_ = nullptr;
+        if (declared_context_)
+            record = serialize(declared, module);
+        if (record && record_declarations_)
+            records_.insert_or_assign(&module, *record);
+    }
+    declared_context_ = record ? std::optional(hash_bytes(*record)) : std::nullopt;
+}
+
+void Resolver::replay_declarations(ModuleDeclarations record) {
+    Declarations& tables = declaring();
+    replay_table(tables, record, kEnumVariants);
+    replay_table(tables, record, kStructFields);
+    replay_table(tables, record, kClassFields);
+    replay_table(tables, record, kTypeAliases);
+    replay_table(tables, record, kTraitMethods);
+    replay_table(tables, record, kFunctionTypeParams);
+    replay_table(tables, record, kTypeTypeParams);
+    replay_table(tables, record, kTraitTypeParams);
+    replay_table(tables, record, kTraitAssociatedTypes);
+    replay_table(tables, record, kFunctionDecls);
+    for (auto& [module, alias] : record.module_aliases)
+        tables.module_aliases[module][std::move(alias.first)] = std::move(alias.second);
+    for (auto& [type, trait] : record.trait_impls)
+        tables.trait_impls[type].insert(std::move(trait));
+    for (auto& [key, types] : record.impl_associated_types)
+        tables.impl_associated_types[std::move(key)] = std::move(types);
+    // In the order they were declared in, so that variables are numbered the same.
+    for (auto& declared : record.symbols) {
+        Scope& scope = declared.global ? *all_scopes_[0] : *current_scope_;
+        scope.declare(std::move(declared.symbol));
+    }
+    for (auto& inst : record.type_instantiations)
+        type_instantiations_.insert(std::move(inst));
 }
 
 void Resolver::declare_module(const ast::Module& module) {
@@ -1714,39 +1877,39 @@ void Resolver::declare_module(const ast::Module& module) {
         if (auto apos = alias.rfind("::"); apos != std::string::npos) {
             alias = alias.substr(apos + 2);
         }
-        module_aliases_[current_module_name_][alias] = imp.module_path;
+        declaring().module_aliases[current_module_name_][alias] = imp.module_path;
+        if (recording_)
+            recording_->module_aliases.push_back({current_module_name_, {alias, imp.module_path}});
 
         const auto pos = root_path.find("::");
         if (pos != std::string::npos) {
             root_path = root_path.substr(0, pos);
         }
-        current_scope_->declare({root_path,
-                                 SymbolKind::Variable,
-                                 false,
-                                 true,
-                                 false,
-                                 true, // is_initialized
-                                 ast::Visibility::Private,
-                                 "",
-                                 "Module",
-                                 {}});
-        std::cout << "Declared identifier: '" << root_path << "' in scope: " << current_scope_
-                  << std::endl;
+        declare_symbol(*current_scope_, {root_path,
+                                         SymbolKind::Variable,
+                                         false,
+                                         true,
+                                         false,
+                                         true, // is_initialized
+                                         ast::Visibility::Private,
+                                         "",
+                                         "Module",
+                                         {}});
     }
 
     // Declare type aliases
     for (const auto& ta : module.type_aliases) {
-        type_aliases_[ta.name] = ta.target_type;
-        current_scope_->declare({ta.name,
-                                 SymbolKind::Variable,
-                                 false,
-                                 true,
-                                 false,
-                                 true,
-                                 ta.visibility,
-                                 current_module_name_,
-                                 "FluxType",
-                                 {}});
+        declare_entry(kTypeAliases, ta.name, ta.target_type);
+        declare_symbol(*current_scope_, {ta.name,
+                                         SymbolKind::Variable,
+                                         false,
+                                         true,
+                                         false,
+                                         true,
+                                         ta.visibility,
+                                         current_module_name_,
+                                         "FluxType",
+                                         {}});
     }
 
     // Validate type aliases (catch circular definitions early)
@@ -1756,33 +1919,33 @@ void Resolver::declare_module(const ast::Module& module) {
 
     // Declare types (structs, enums, classes, traits)
     for (const auto& s : module.structs) {
-        current_scope_->declare({s.name,
-                                 SymbolKind::Variable,
-                                 false,
-                                 true,
-                                 false,
-                                 true,
-                                 s.visibility,
-                                 current_module_name_,
-                                 "FluxType",
-                                 {}});
+        declare_symbol(*current_scope_, {s.name,
+                                         SymbolKind::Variable,
+                                         false,
+                                         true,
+                                         false,
+                                         true,
+                                         s.visibility,
+                                         current_module_name_,
+                                         "FluxType",
+                                         {}});
         std::vector<FieldInfo> field_infos;
         for (const auto& f : s.fields) {
             field_infos.push_back({f.name, f.type, f.visibility});
         }
-        struct_fields_[s.name] = field_infos;
+        declare_entry(kStructFields, s.name, field_infos);
         if (!current_module_name_.empty()) {
-            struct_fields_[current_module_name_ + "::" + s.name] = field_infos;
-            all_scopes_[0]->declare({current_module_name_ + "::" + s.name,
-                                     SymbolKind::Variable,
-                                     false,
-                                     true,
-                                     false,
-                                     true,
-                                     s.visibility,
-                                     current_module_name_,
-                                     "FluxType",
-                                     {}});
+            declare_entry(kStructFields, current_module_name_ + "::" + s.name, field_infos);
+            declare_symbol(*all_scopes_[0], {current_module_name_ + "::" + s.name,
+                                             SymbolKind::Variable,
+                                             false,
+                                             true,
+                                             false,
+                                             true,
+                                             s.visibility,
+                                             current_module_name_,
+                                             "FluxType",
+                                             {}});
         }
 
         // Store struct fields for type checking
@@ -1790,10 +1953,10 @@ void Resolver::declare_module(const ast::Module& module) {
         for (const auto& f : s.fields) {
             fields.push_back({f.name, f.type, f.visibility});
         }
-        struct_fields_[s.name] = std::move(fields);
+        declare_entry(kStructFields, s.name, std::move(fields));
 
         // Store type params for structs
-        auto bounds = parse_where_clause(s.where_clause);
+        auto bounds = where_clause_bounds(s.where_clause);
         std::vector<std::string> combined = s.type_params;
         for (const auto& b : bounds) {
             std::string str = b.param_name + ": ";
@@ -1804,47 +1967,47 @@ void Resolver::declare_module(const ast::Module& module) {
             }
             combined.push_back(std::move(str));
         }
-        type_type_params_[s.name] = std::move(combined);
+        declare_entry(kTypeTypeParams, s.name, std::move(combined));
     }
 
     for (const auto& c : module.classes) {
-        current_scope_->declare({c.name,
-                                 SymbolKind::Variable,
-                                 false,
-                                 true,
-                                 false,
-                                 true,
-                                 c.visibility,
-                                 current_module_name_,
-                                 "FluxType",
-                                 {}});
+        declare_symbol(*current_scope_, {c.name,
+                                         SymbolKind::Variable,
+                                         false,
+                                         true,
+                                         false,
+                                         true,
+                                         c.visibility,
+                                         current_module_name_,
+                                         "FluxType",
+                                         {}});
         std::vector<FieldInfo> field_infos;
         for (const auto& f : c.fields) {
             field_infos.push_back({f.name, f.type, f.visibility});
         }
-        class_fields_[c.name] = field_infos;
+        declare_entry(kClassFields, c.name, field_infos);
         if (!current_module_name_.empty()) {
-            class_fields_[current_module_name_ + "::" + c.name] = field_infos;
-            all_scopes_[0]->declare({current_module_name_ + "::" + c.name,
-                                     SymbolKind::Variable,
-                                     false,
-                                     true,
-                                     false,
-                                     true,
-                                     c.visibility,
-                                     current_module_name_,
-                                     "FluxType",
-                                     {}});
+            declare_entry(kClassFields, current_module_name_ + "::" + c.name, field_infos);
+            declare_symbol(*all_scopes_[0], {current_module_name_ + "::" + c.name,
+                                             SymbolKind::Variable,
+                                             false,
+                                             true,
+                                             false,
+                                             true,
+                                             c.visibility,
+                                             current_module_name_,
+                                             "FluxType",
+                                             {}});
         }
 
         std::vector<FieldInfo> fields;
         for (const auto& f : c.fields) {
             fields.push_back({f.name, f.type, f.visibility});
         }
-        struct_fields_[c.name] = std::move(fields);
+        declare_entry(kStructFields, c.name, std::move(fields));
 
         // Store type params for classes
-        auto bounds = parse_where_clause(c.where_clause);
+        auto bounds = where_clause_bounds(c.where_clause);
         std::vector<std::string> combined = c.type_params;
         for (const auto& b : bounds) {
             std::string str = b.param_name + ": ";
@@ -1855,31 +2018,31 @@ void Resolver::declare_module(const ast::Module& module) {
             }
             combined.push_back(std::move(str));
         }
-        type_type_params_[c.name] = std::move(combined);
+        declare_entry(kTypeTypeParams, c.name, std::move(combined));
     }
 
     for (const auto& e : module.enums) {
-        current_scope_->declare({e.name,
-                                 SymbolKind::Variable,
-                                 false,
-                                 true,
-                                 false,
-                                 true,
-                                 e.visibility,
-                                 current_module_name_,
-                                 "FluxType",
-                                 {}});
+        declare_symbol(*current_scope_, {e.name,
+                                         SymbolKind::Variable,
+                                         false,
+                                         true,
+                                         false,
+                                         true,
+                                         e.visibility,
+                                         current_module_name_,
+                                         "FluxType",
+                                         {}});
         if (!current_module_name_.empty()) {
-            all_scopes_[0]->declare({current_module_name_ + "::" + e.name,
-                                     SymbolKind::Variable,
-                                     false,
-                                     true,
-                                     false,
-                                     true,
-                                     e.visibility,
-                                     current_module_name_,
-                                     "FluxType",
-                                     {}});
+            declare_symbol(*all_scopes_[0], {current_module_name_ + "::" + e.name,
+                                             SymbolKind::Variable,
+                                             false,
+                                             true,
+                                             false,
+                                             true,
+                                             e.visibility,
+                                             current_module_name_,
+                                             "FluxType",
+                                             {}});
         }
 
         std::vector<std::string> vars;
@@ -1887,10 +2050,10 @@ void Resolver::declare_module(const ast::Module& module) {
         for (const auto& [name, types] : e.variants) {
             vars.push_back(name);
         }
-        enum_variants_[e.name] = std::move(vars);
+        declare_entry(kEnumVariants, e.name, std::move(vars));
 
         // Store type params for enums
-        auto bounds = parse_where_clause(e.where_clause);
+        auto bounds = where_clause_bounds(e.where_clause);
         std::vector<std::string> combined = e.type_params;
         for (const auto& b : bounds) {
             std::string str = b.param_name + ": ";
@@ -1901,34 +2064,34 @@ void Resolver::declare_module(const ast::Module& module) {
             }
             combined.push_back(std::move(str));
         }
-        type_type_params_[e.name] = std::move(combined);
+        declare_entry(kTypeTypeParams, e.name, std::move(combined));
     }
 
     for (const auto& t : module.traits) {
-        current_scope_->declare({t.name,
-                                 SymbolKind::Variable,
-                                 false,
-                                 true,
-                                 false,
-                                 true,
-                                 t.visibility,
-                                 current_module_name_,
-                                 "Trait",
-                                 {}});
+        declare_symbol(*current_scope_, {t.name,
+                                         SymbolKind::Variable,
+                                         false,
+                                         true,
+                                         false,
+                                         true,
+                                         t.visibility,
+                                         current_module_name_,
+                                         "Trait",
+                                         {}});
         if (!current_module_name_.empty()) {
-            all_scopes_[0]->declare({current_module_name_ + "::" + t.name,
-                                     SymbolKind::Variable,
-                                     false,
-                                     true,
-                                     false,
-                                     true,
-                                     t.visibility,
-                                     current_module_name_,
-                                     "Trait",
-                                     {}});
-        }
-
-        auto bounds = parse_where_clause(t.where_clause);
+            declare_symbol(*all_scopes_[0], {current_module_name_ + "::" + t.name,
+                                             SymbolKind::Variable,
+                                             false,
+                                             true,
+                                             false,
+                                             true,
+                                             t.visibility,
+                                             current_module_name_,
+                                             "Trait",
+                                             {}});
+        }
+
+        auto bounds = where_clause_bounds(t.where_clause);
         std::vector<std::string> combined = t.type_params;
         for (const auto& b : bounds) {
             std::string str = b.param_name + ": ";
@@ -1939,26 +2102,26 @@ void Resolver::declare_module(const ast::Module& module) {
             }
             combined.push_back(std::move(str));
         }
-        trait_type_params_[t.name] = std::move(combined);
+        declare_entry(kTraitTypeParams, t.name, std::move(combined));
 
         // Store associated types
         std::vector<std::string> assoc_names;
         for (const auto& assoc : t.associated_types) {
             assoc_names.push_back(assoc.name);
         }
-        trait_associated_types_[t.name] = std::move(assoc_names);
+        declare_entry(kTraitAssociatedTypes, t.name, std::move(assoc_names));
 
         // Register trait method signatures
         std::vector<TraitMethodSig> sigs;
         for (const auto& m : t.methods) {
             TraitMethodSig sig;
             sig.name = m.name;
-            sig.return_type = m.return_type;
+            sig.return_type = ast::spelling(m.return_type);
             for (const auto& p : m.params) {
                 if (p.name == "self") {
-                    sig.self_type = p.type;
+                    sig.self_type = ast::spelling(p.type);
                 } else {
-                    sig.param_types.push_back(p.type);
+                    sig.param_types.push_back(ast::spelling(p.type));
                 }
             }
             sig.has_default = m.has_body;
@@ -1966,13 +2129,13 @@ void Resolver::declare_module(const ast::Module& module) {
             sig.module_name = current_module_name_;
             sigs.push_back(std::move(sig));
         }
-        trait_methods_[t.name] = std::move(sigs);
+        declare_entry(kTraitMethods, t.name, std::move(sigs));
     }
 
     // Declare functions first (forward visibility)
     for (const auto& fn : module.functions) {
         // Parse bounds from where clause and append to type_params
-        auto bounds = parse_where_clause(fn.where_clause);
+        auto bounds = where_clause_bounds(fn.where_clause);
         std::vector<std::string> combined_type_params = fn.type_params;
         for (const auto& b : bounds) {
             std::string s = b.param_name + ": ";
@@ -1983,35 +2146,35 @@ void Resolver::declare_module(const ast::Module& module) {
             }
             combined_type_params.push_back(std::move(s));
         }
-        function_type_params_[fn.name] = combined_type_params;
-
-        std::vector<std::string> params;
-        params.reserve(fn.params.size());
-        for (const auto& p : fn.params)
-            params.push_back(p.type);
+        declare_entry(kFunctionTypeParams, fn.name, combined_type_params);
 
         Symbol sym;
         sym.name = fn.name;
         sym.kind = SymbolKind::Function;
-        sym.type = fn.return_type;
-        sym.param_types = std::move(params);
+        sym.type = ast::spelling(fn.return_type);
+        sym.type_expr = fn.return_type;
+        sym.param_types.reserve(fn.params.size());
+        for (const auto& p : fn.params) {
+            sym.param_types.push_back(ast::spelling(p.type));
+            sym.param_type_exprs.push_back(p.type);
+        }
         sym.is_moved = false;
         sym.visibility = fn.visibility;
         sym.module_name = current_module_name_;
         sym.is_initialized = true;
         sym.is_async = fn.is_async;
 
-        if (!current_scope_->declare(sym)) {
+        if (!declare_symbol(*current_scope_, sym)) {
             throw DiagnosticError("duplicate function '" + fn.name + "'", 0, 0);
         }
 
         if (!current_module_name_.empty()) {
             Symbol qualified = sym;
             qualified.name = current_module_name_ + "::" + fn.name;
-            all_scopes_[0]->declare(qualified);
-            function_decls_[qualified.name] = &fn;
+            declare_symbol(*all_scopes_[0], qualified);
+            declare_entry(kFunctionDecls, qualified.name, &fn);
         } else {
-            function_decls_[fn.name] = &fn;
+            declare_entry(kFunctionDecls, fn.name, &fn);
         }
     }
 
@@ -2042,10 +2205,12 @@ void Resolver::declare_module(const ast::Module& module) {
                     0, 0);
             }
 
-            trait_impls_[impl.target_name].insert(impl.trait_name);
+            declaring().trait_impls[impl.target_name].insert(impl.trait_name);
+            if (recording_)
+                recording_->trait_impls.emplace_back(impl.target_name, impl.trait_name);
 
             // Store associated type mappings
-            std::unordered_map<std::string, std::string> assoc_mapping;
+            std::unordered_map<std::string, const ast::TypeExpr*> assoc_mapping;
             for (const auto& assoc : impl.associated_types) {
                 // For impls, the "default_type" field actually stores the target type
                 assoc_mapping[assoc.name] = assoc.default_type;
@@ -2057,8 +2222,8 @@ void Resolver::declare_module(const ast::Module& module) {
                 trait_base = trait_base.substr(0, pos);
             }
 
-            auto trait_assoc_it = trait_associated_types_.find(trait_base);
-            if (trait_assoc_it != trait_associated_types_.end()) {
+            auto trait_assoc_it = declaring().trait_associated_types.find(trait_base);
+            if (trait_assoc_it != declaring().trait_associated_types.end()) {
                 const auto& required_assocs = trait_assoc_it->second;
                 for (const auto& required : required_assocs) {
                     if (!assoc_mapping.contains(required)) {
@@ -2071,23 +2236,27 @@ void Resolver::declare_module(const ast::Module& module) {
                 }
             }
 
-            impl_associated_types_[std::make_pair(impl.target_name, impl.trait_name)] =
+            if (recording_) {
+                recording_->impl_associated_types.push_back(
+                    {{impl.target_name, impl.trait_name}, assoc_mapping});
+            }
+            declaring().impl_associated_types[std::make_pair(impl.target_name, impl.trait_name)] =
                 std::move(assoc_mapping);
 
             // 3. Perform trait conformance check (methods)
             std::unordered_map<std::string, std::string> generic_mapping;
-            auto it_params = trait_type_params_.find(trait_base);
-            if (it_params != trait_type_params_.end()) {
-                FluxType trait_type = type_from_name(impl.trait_name);
-                if (!trait_type.generic_args.empty()) {
+            auto it_params = declaring().trait_type_params.find(trait_base);
+            if (it_params != declaring().trait_type_params.end()) {
+                TypeId trait_type = type_from_name(impl.trait_name);
+                if (!trait_type->generic_args.empty()) {
                     std::vector<std::string> raw_params;
                     for (const auto& p : it_params->second) {
                         if (p.find(':') == std::string::npos)
                             raw_params.push_back(p);
                     }
-                    for (size_t i = 0; i < raw_params.size() && i < trait_type.generic_args.size();
+                    for (size_t i = 0; i < raw_params.size() && i < trait_type->generic_args.size();
                          ++i) {
-                        generic_mapping[raw_params[i]] = trait_type.generic_args[i].name;
+                        generic_mapping[raw_params[i]] = trait_type->generic_args[i]->name;
                     }
 
                     // Check trait bounds (including where clauses)
@@ -2122,8 +2291,8 @@ void Resolver::declare_module(const ast::Module& module) {
                 }
             }
 
-            auto trait_methods_it = trait_methods_.find(trait_base);
-            if (trait_methods_it != trait_methods_.end()) {
+            auto trait_methods_it = declaring().trait_methods.find(trait_base);
+            if (trait_methods_it != declaring().trait_methods.end()) {
                 const auto& required_methods = trait_methods_it->second;
                 for (const auto& required : required_methods) {
                     bool found = false;
@@ -2193,9 +2362,10 @@ void Resolver::declare_module(const ast::Module& module) {
                             params.push_back(p);
                         }
 
-                        current_scope_->declare({qualified_name, SymbolKind::Function, false, true,
-                                                 false, true, ast::Visibility::Public, "", ret_type,
-                                                 std::move(params)});
+                        declare_symbol(*current_scope_,
+                                       {qualified_name, SymbolKind::Function, false, true, false,
+                                        true, ast::Visibility::Public, "", ret_type,
+                                        std::move(params)});
                     }
                 }
             }
@@ -2213,52 +2383,161 @@ void Resolver::declare_module(const ast::Module& module) {
             std::vector<std::string> combined_params = impl.type_params;
             combined_params.insert(combined_params.end(), method.type_params.begin(),
                                    method.type_params.end());
-            function_type_params_[qualified_name] = combined_params;
-
-            std::vector<std::string> params;
-            for (const auto& p : method.params)
-                params.push_back(p.type);
+            declare_entry(kFunctionTypeParams, qualified_name, combined_params);
 
             Symbol sym;
             sym.name = qualified_name;
             sym.kind = SymbolKind::Function;
-            sym.type = method.return_type;
-            sym.param_types = std::move(params);
+            sym.type = ast::spelling(method.return_type);
+            sym.type_expr = method.return_type;
+            for (const auto& p : method.params) {
+                sym.param_types.push_back(ast::spelling(p.type));
+                sym.param_type_exprs.push_back(p.type);
+            }
             sym.visibility = method.visibility;
             sym.is_moved = false; // Added
 
-            current_scope_->declare(sym);
-            function_decls_[qualified_name] = &method;
+            declare_symbol(*current_scope_, sym);
+            declare_entry(kFunctionDecls, qualified_name, &method);
         }
     }
 }
 
 void Resolver::resolve_module_bodies(const ast::Module& module) {
+    std::vector<BodyTask> bodies;
+    collect_bodies(module, bodies);
+    resolve_bodies(bodies);
+}
+
+void Resolver::collect_bodies(const ast::Module& module, std::vector<BodyTask>& bodies) {
     current_module_name_ = module.name;
     for (const auto& fn : module.functions) {
-        resolve_function(fn);
+        bodies.push_back({&fn, "", module.name, current_type_name_});
     }
 
-    // Resolve impl method bodies
+    // Impl method bodies
     for (const auto& impl : module.impls) {
-        std::string old_type = current_type_name_;
-        current_type_name_ = impl.target_name;
-
         std::string base_target = impl.target_name;
         if (auto pos = base_target.find('<'); pos != std::string::npos) {
             base_target = base_target.substr(0, pos);
         }
 
         for (const auto& method : impl.methods) {
-            resolve_function(method, base_target + "::" + method.name);
+            bodies.push_back(
+                {&method, base_target + "::" + method.name, module.name, impl.target_name});
         }
+    }
+}
 
-        current_type_name_ = old_type;
+void Resolver::resolve_bodies(const std::vector<BodyTask>& bodies) {
+    const std::string old_module = current_module_name_;
+    const std::string old_type = current_type_name_;
+    for (const auto& body : bodies) {
+        resolve_body(body);
     }
+    current_module_name_ = old_module;
+    current_type_name_ = old_type;
+}
+
+// Resolving a body reads the tables declare_module() filled in and writes only its own
+// scopes, FlowState and instantiations. So each thread gets a worker from
+// make_body_worker(), which shares the declarations and the global scopes, read-only; the
+// global scopes are frozen meanwhile, so a declaration that reaches one throws rather than
+// racing. Workers take bodies in order. What each body records, and its error, are kept per
+// body and merged in body order, so the instantiations, and the error thrown, are those of
+// resolve_bodies().
+void Resolver::resolve_bodies_parallel(const std::vector<BodyTask>& bodies) {
+    struct Result {
+        std::vector<FunctionInstantiation> functions;
+        std::vector<TypeInstantiation> types;
+        std::exception_ptr error;
+    };
+    std::vector<Result> results(bodies.size());
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> first_error{bodies.size()};
+
+    ThreadPool pool(jobs_);
+    std::vector<std::unique_ptr<Resolver>> workers;
+    for (unsigned i = 0; i < std::min<std::size_t>(pool.size(), bodies.size()); ++i) {
+        workers.push_back(make_body_worker());
+    }
+    for (auto& scope : all_scopes_)
+        scope->freeze(true);
+
+    for (auto& worker : workers) {
+        pool.submit([&, worker = worker.get()] {
+            for (std::size_t i = next++; i < bodies.size(); i = next++) {
+                // A body after one that failed cannot change what is reported.
+                if (i > first_error.load())
+                    break;
+                Result& result = results[i];
+                const std::size_t functions = worker->function_instantiations_.size();
+                const std::size_t types = worker->type_instantiations_.size();
+                // Tasks must not throw; the error waits in `result` for the merge below.
+                try {
+                    worker->resolve_body(bodies[i]);
+                } catch (...) {
+                    result.error = std::current_exception();
+                    std::size_t failed = first_error.load();
+                    while (i < failed && !first_error.compare_exchange_weak(failed, i)) {
+                    }
+                }
+                // A worker's bodies come in increasing order, so what it records first for
+                // this body is new to every body before it on this worker.
+                const auto& recorded_functions = worker->function_instantiations_.items();
+                result.functions.assign(recorded_functions.begin() + functions,
+                                        recorded_functions.end());
+                const auto& recorded_types = worker->type_instantiations_.items();
+                result.types.assign(recorded_types.begin() + types, recorded_types.end());
+            }
+        });
+    }
+    pool.wait();
+
+    for (auto& scope : all_scopes_)
+        scope->freeze(false);
+    // The workers' scopes are kept, as serial resolution keeps its own, but their FlowStates
+    // go with the workers.
+    for (auto& worker : workers) {
+        for (auto& scope : worker->all_scopes_) {
+            scope->release_flow();
+            all_scopes_.push_back(std::move(scope));
+        }
+    }
+    for (auto& result : results) {
+        if (result.error)
+            std::rethrow_exception(result.error);
+        for (auto& inst : result.functions)
+            function_instantiations_.insert(std::move(inst));
+        for (auto& inst : result.types)
+            type_instantiations_.insert(std::move(inst));
+    }
+}
+
+// Every body starts from the state declaration left, so a global moved or borrowed in one
+// function is not moved or borrowed in the next.
+void Resolver::resolve_body(const BodyTask& body) {
+    current_module_name_ = body.module_name;
+    current_type_name_ = body.type_name;
+    flow_.restore(declared_flow_);
+    resolve_function(*body.fn, body.name);
+}
+
+std::unique_ptr<Resolver> Resolver::make_body_worker() const {
+    auto worker = std::make_unique<Resolver>();
+    worker->declaring_.reset();
+    worker->declarations_ = declarations_;
+    worker->current_scope_ = current_scope_;
+    worker->flow_ = flow_;
+    worker->declared_flow_ = declared_flow_;
+    worker->substitution_map_ = substitution_map_;
+    worker->jobs_ = jobs_;
+    return worker;
 }
 
 void Resolver::resolve_function(const ast::FunctionDecl& fn, const std::string& name) {
-    std::string fn_name = name.empty() ? fn.name : name;
+    std::string fn_name = name.empty() ? fn.name.str() : name;
+    TraceSpan span("resolve", fn_name);
     std::string old_fn = current_function_name_;
     std::string old_type = current_type_name_;
     current_function_name_ = fn_name;
@@ -2276,21 +2555,23 @@ void Resolver::resolve_function(const ast::FunctionDecl& fn, const std::string&
         return;
     }
 
-    current_function_return_type_ = type_from_name(fn.return_type);
+    current_function_return_type_ = resolve_type(fn.return_type);
     in_loop_ = false;
 
     // Declare parameters
     for (const auto& param : fn.params) {
-        if (!current_scope_->declare({param.name,
-                                      SymbolKind::Variable,
-                                      false,
-                                      false,
-                                      false,
-                                      true, // is_initialized
-                                      ast::Visibility::None,
-                                      "",
-                                      param.type,
-                                      {}})) {
+        Symbol sym{param.name,
+                   SymbolKind::Variable,
+                   false,
+                   false,
+                   false,
+                   true, // is_initialized
+                   ast::Visibility::None,
+                   "",
+                   ast::spelling(param.type),
+                   {}};
+        sym.resolved_type = resolve_type(param.type);
+        if (!current_scope_->declare(std::move(sym))) {
             throw DiagnosticError("duplicate parameter '" + param.name + "'", 0, 0);
         }
     }
@@ -2299,11 +2580,11 @@ void Resolver::resolve_function(const ast::FunctionDecl& fn, const std::string&
     bool body_returns = resolve_block(fn.body);
 
     // Enforce return correctness
-    if (current_function_return_type_.kind != TypeKind::Void &&
-        current_function_return_type_.kind != TypeKind::Never &&
-        current_function_return_type_.kind != TypeKind::Unknown && !body_returns) {
+    if (current_function_return_type_->kind != TypeKind::Void &&
+        current_function_return_type_->kind != TypeKind::Never &&
+        current_function_return_type_->kind != TypeKind::Unknown && !body_returns) {
         throw DiagnosticError("missing return in function returning '" +
-                                  current_function_return_type_.name + "'",
+                                  current_function_return_type_->name + "'",
                               0, 0);
     }
 
@@ -2335,38 +2616,45 @@ bool Resolver::resolve_block(const ast::Block& block) {
 
 bool Resolver::resolve_statement(const ast::Stmt& stmt) {
     // return
-    if (const auto* ret = dynamic_cast<const ast::ReturnStmt*>(&stmt)) {
+    switch (stmt.kind) {
+    case ast::StmtKind::Return: {
+        const auto* ret = ast::cast<ast::ReturnStmt>(&stmt);
         if (ret->expression) {
-            FluxType returned = type_of(*ret->expression);
+            TypeId returned = type_of(*ret->expression);
             if (!are_types_compatible(current_function_return_type_, returned)) {
                 throw DiagnosticError("return type mismatch: expected '" +
-                                          current_function_return_type_.name + "', got '" +
-                                          returned.name + "'",
-                                      stmt.line, stmt.column);
+                                          current_function_return_type_->name + "', got '" +
+                                          returned->name + "'",
+                                      stmt.loc);
             }
-        } else if (current_function_return_type_.kind != TypeKind::Void) {
+        } else if (current_function_return_type_->kind != TypeKind::Void) {
             throw DiagnosticError("returning void from non-void function", 0, 0);
         }
         return true;
     }
 
     // let / const
-    if (const auto* let_stmt = dynamic_cast<const ast::LetStmt*>(&stmt)) {
+    case ast::StmtKind::Let: {
+        const auto* let_stmt = ast::cast<ast::LetStmt>(&stmt);
         // 1. Declared type (must be explicit)
-        FluxType declared_type = type_from_name(let_stmt->type_name);
-        if (declared_type.kind == TypeKind::Unknown &&
-            !type_aliases_.contains(let_stmt->type_name)) {
-            bool is_complex = let_stmt->type_name.find('<') != std::string::npos ||
-                              let_stmt->type_name.find('&') != std::string::npos ||
-                              let_stmt->type_name.find('(') != std::string::npos;
-            if (!is_complex && !current_scope_->lookup(let_stmt->type_name)) {
-                throw DiagnosticError("unknown type '" + let_stmt->type_name + "'", stmt.line,
-                                      stmt.column);
+        const std::string type_name = ast::spelling(let_stmt->type);
+        TypeId declared_type = resolve_type(let_stmt->type);
+        if (declared_type->kind == TypeKind::Unknown &&
+            !declarations_->type_aliases.contains(type_name)) {
+            // Only a plain name (or an array of one) is reported; generic, reference, tuple
+            // and function types are left to the compatibility check below.
+            const ast::TypeExpr* named = let_stmt->type;
+            while (const auto* array = ast::dyn_cast<ast::ArrayType>(named))
+                named = array->element;
+            const auto* path = ast::dyn_cast<ast::PathType>(named);
+            bool is_complex = !path || !path->generic_args.empty();
+            if (!is_complex && !current_scope_->lookup(type_name)) {
+                throw DiagnosticError("unknown type '" + type_name + "'", stmt.loc);
             }
         }
 
         // 2. Compute initializer type and enforce compatibility (only if initializer present)
-        FluxType init_type = unknown_type();
+        TypeId init_type = unknown_type();
         if (let_stmt->initializer) {
             resolve_expression(*let_stmt->initializer);
             init_type = type_of(*let_stmt->initializer);
@@ -2375,52 +2663,56 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
             if (!are_types_compatible(declared_type, init_type)) {
                 std::string var_name = let_stmt->name.empty() ? "(tuple)" : let_stmt->name;
                 throw DiagnosticError("cannot initialize variable '" + var_name + "' of type '" +
-                                          declared_type.name + "' with value of type '" +
-                                          init_type.name + "'",
-                                      stmt.line, stmt.column);
+                                          declared_type->name + "' with value of type '" +
+                                          init_type->name + "'",
+                                      stmt.loc);
             }
         }
 
         // 4. Declare symbol(s)
         if (!let_stmt->tuple_names.empty()) {
-            if (init_type.kind != TypeKind::Tuple) {
+            if (init_type->kind != TypeKind::Tuple) {
                 throw DiagnosticError("expected tuple type for destructuring let, found '" +
-                                          init_type.name + "'",
-                                      stmt.line, stmt.column);
+                                          init_type->name + "'",
+                                      stmt.loc);
             }
-            if (let_stmt->tuple_names.size() != init_type.generic_args.size()) {
+            if (let_stmt->tuple_names.size() != init_type->generic_args.size()) {
                 throw DiagnosticError("destructuring pattern arity mismatch: expected " +
-                                          std::to_string(init_type.generic_args.size()) +
+                                          std::to_string(init_type->generic_args.size()) +
                                           " variables, found " +
                                           std::to_string(let_stmt->tuple_names.size()),
-                                      stmt.line, stmt.column);
+                                      stmt.loc);
             }
             for (size_t i = 0; i < let_stmt->tuple_names.size(); ++i) {
-                if (!current_scope_->declare({let_stmt->tuple_names[i],
-                                              SymbolKind::Variable,
-                                              let_stmt->is_mutable,
-                                              let_stmt->is_const,
-                                              false,                            // is_moved
-                                              let_stmt->initializer != nullptr, // is_initialized
-                                              ast::Visibility::None,
-                                              "",
-                                              stringify_type(init_type.generic_args[i]),
-                                              {}})) {
+                Symbol sym{let_stmt->tuple_names[i],
+                           SymbolKind::Variable,
+                           let_stmt->is_mutable,
+                           let_stmt->is_const,
+                           false,                            // is_moved
+                           let_stmt->initializer != nullptr, // is_initialized
+                           ast::Visibility::None,
+                           "",
+                           stringify_type(init_type->generic_args[i]),
+                           {}};
+                sym.resolved_type = init_type->generic_args[i];
+                if (!current_scope_->declare(std::move(sym))) {
                     throw DiagnosticError("duplicate variable '" + let_stmt->tuple_names[i] + "'",
                                           0, 0);
                 }
             }
         } else {
-            if (!current_scope_->declare({let_stmt->name,
-                                          SymbolKind::Variable,
-                                          let_stmt->is_mutable,
-                                          let_stmt->is_const,
-                                          false,                            // is_moved
-                                          let_stmt->initializer != nullptr, // is_initialized
-                                          ast::Visibility::None,
-                                          "",
-                                          let_stmt->type_name,
-                                          {}})) {
+            Symbol sym{let_stmt->name,
+                       SymbolKind::Variable,
+                       let_stmt->is_mutable,
+                       let_stmt->is_const,
+                       false,                            // is_moved
+                       let_stmt->initializer != nullptr, // is_initialized
+                       ast::Visibility::None,
+                       "",
+                       type_name,
+                       {}};
+            sym.resolved_type = std::move(declared_type);
+            if (!current_scope_->declare(std::move(sym))) {
                 throw DiagnosticError("duplicate variable '" + let_stmt->name + "'", 0, 0);
             }
         }
@@ -2429,10 +2721,9 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
         if (let_stmt->initializer) {
             Symbol* target_sym = current_scope_->lookup_mut(let_stmt->name);
             if (target_sym) {
-                if (auto un = dynamic_cast<const ast::UnaryExpr*>(let_stmt->initializer.get())) {
+                if (auto un = ast::dyn_cast<ast::UnaryExpr>(let_stmt->initializer)) {
                     if (un->op == TokenKind::Amp) {
-                        if (auto id_inner =
-                                dynamic_cast<const ast::IdentifierExpr*>(un->operand.get())) {
+                        if (auto id_inner = ast::dyn_cast<ast::IdentifierExpr>(un->operand)) {
                             Symbol* source_sym = current_scope_->lookup_mut(id_inner->name);
                             if (source_sym) {
                                 if (target_sym->scope_depth < source_sym->scope_depth) {
@@ -2445,8 +2736,8 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
                             }
                         }
                     }
-                } else if (auto id_init = dynamic_cast<const ast::IdentifierExpr*>(
-                               let_stmt->initializer.get())) {
+                } else if (auto id_init = ast::dyn_cast<ast::IdentifierExpr>(
+                               let_stmt->initializer)) {
                     Symbol* source_sym = current_scope_->lookup_mut(id_init->name);
                     if (source_sym) {
                         if (!source_sym->borrowed_symbol_name.empty()) {
@@ -2455,14 +2746,14 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
                                 current_scope_->lookup_mut(source_sym->borrowed_symbol_name);
                             if (root_sym) {
                                 if (!target_sym->type.starts_with("&mut")) {
-                                    root_sym->borrow_count++;
+                                    flow_.add_borrow(*root_sym);
                                 }
                             }
                         }
 
                         // Implicit move for non-Copy types
                         if (!is_copy_type(source_sym->type)) {
-                            source_sym->is_moved = true;
+                            flow_.set_moved(*source_sym, true);
                         }
                     }
                 }
@@ -2473,60 +2764,58 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
     }
 
     // assignment
-    if (const auto* asg = dynamic_cast<const ast::AssignStmt*>(&stmt)) {
-        const auto* id = dynamic_cast<const ast::IdentifierExpr*>(asg->target.get());
+    case ast::StmtKind::Assign: {
+        const auto* asg = ast::cast<ast::AssignStmt>(&stmt);
+        const auto* id = ast::dyn_cast<ast::IdentifierExpr>(asg->target);
 
         if (id) {
             Symbol* sym = current_scope_->lookup_mut(id->name);
             if (!sym) {
                 throw DiagnosticError("assignment to undeclared variable '" + id->name + "'",
-                                      stmt.line, stmt.column);
+                                      stmt.loc);
             }
 
-            if (sym->is_const && sym->is_initialized) {
-                throw DiagnosticError("cannot reassign to constant '" + id->name + "'", stmt.line,
-                                      stmt.column);
+            if (sym->is_const && flow_.initialized(*sym)) {
+                throw DiagnosticError("cannot reassign to constant '" + id->name + "'", stmt.loc);
             }
 
-            if (!sym->is_mutable && sym->is_initialized) {
+            if (!sym->is_mutable && flow_.initialized(*sym)) {
                 throw DiagnosticError("cannot reassign to immutable variable '" + id->name + "'",
-                                      stmt.line, stmt.column);
+                                      stmt.loc);
             }
 
-            const FluxType lhs = type_from_name(sym->type);
+            const TypeId lhs = symbol_type(*sym);
             resolve_expression(*asg->value);
-            FluxType val_type = type_of(*asg->value);
+            TypeId val_type = type_of(*asg->value);
 
             if (asg->op == TokenKind::Assign) {
                 if (!are_types_compatible(lhs, val_type)) {
-                    throw DiagnosticError("cannot assign type '" + val_type.name +
+                    throw DiagnosticError("cannot assign type '" + val_type->name +
                                               "' to variable of type '" + sym->type + "'",
-                                          stmt.line, stmt.column);
+                                          stmt.loc);
                 }
-                sym->is_initialized = true;
-                sym->is_moved = false;
+                flow_.set_initialized(*sym, true);
+                flow_.set_moved(*sym, false);
             } else {
                 // Compound assignment (+=, -=, etc.)
-                if (lhs.kind != TypeKind::Int && lhs.kind != TypeKind::Float) {
+                if (lhs->kind != TypeKind::Int && lhs->kind != TypeKind::Float) {
                     throw DiagnosticError("compound assignment only allowed for numeric types",
-                                          stmt.line, stmt.column);
+                                          stmt.loc);
                 }
                 if (!are_types_compatible(lhs, val_type)) {
-                    throw DiagnosticError("type mismatch in compound assignment", stmt.line,
-                                          stmt.column);
+                    throw DiagnosticError("type mismatch in compound assignment", stmt.loc);
                 }
-                if (sym->is_moved) {
-                    throw DiagnosticError("use of moved value '" + id->name + "'", stmt.line,
-                                          stmt.column);
+                if (flow_.moved(*sym)) {
+                    throw DiagnosticError("use of moved value '" + id->name + "'", stmt.loc);
                 }
             }
 
             // Implicit move for non-Copy types (source)
-            if (auto val_id = dynamic_cast<const ast::IdentifierExpr*>(asg->value.get())) {
+            if (auto val_id = ast::dyn_cast<ast::IdentifierExpr>(asg->value)) {
                 Symbol* source_sym = current_scope_->lookup_mut(val_id->name);
                 if (source_sym && source_sym->kind == SymbolKind::Variable) {
                     if (!is_copy_type(source_sym->type)) {
-                        source_sym->is_moved = true;
+                        flow_.set_moved(*source_sym, true);
                     }
                 }
             }
@@ -2539,12 +2828,14 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
     }
 
     // block statement
-    if (const auto* block = dynamic_cast<const ast::BlockStmt*>(&stmt)) {
+    case ast::StmtKind::Block: {
+        const auto* block = ast::cast<ast::BlockStmt>(&stmt);
         return resolve_block(block->block);
     }
 
     // if statement
-    if (const auto* ifs = dynamic_cast<const ast::IfStmt*>(&stmt)) {
+    case ast::StmtKind::If: {
+        const auto* ifs = ast::cast<ast::IfStmt>(&stmt);
         resolve_expression(*ifs->condition);
 
         auto base_state = save_initialization_state();
@@ -2566,18 +2857,18 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
         } else if (else_diverges) {
             restore_initialization_state(after_then);
             return false;
-        } else if (!ifs->else_branch) {
-            restore_initialization_state(base_state);
-            return false;
         } else {
+            // Without an else branch, after_else is the state the condition left.
             restore_initialization_state(after_then);
             intersect_initialization_state(after_else);
             return false;
         }
+        break;
     }
 
     // while
-    if (const auto* wh = dynamic_cast<const ast::WhileStmt*>(&stmt)) {
+    case ast::StmtKind::While: {
+        const auto* wh = ast::cast<ast::WhileStmt>(&stmt);
         resolve_expression(*wh->condition);
         bool prev_in_loop = in_loop_;
         in_loop_ = true;
@@ -2587,32 +2878,35 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
     }
 
     // for loop
-    if (const auto* fl = dynamic_cast<const ast::ForStmt*>(&stmt)) {
-        FluxType iterable_type = type_of(*fl->iterable);
+    case ast::StmtKind::For: {
+        const auto* fl = ast::cast<ast::ForStmt>(&stmt);
+        TypeId iterable_type = type_of(*fl->iterable);
 
         enter_scope();
 
         std::string elem_type = "Unknown";
-        if (iterable_type.kind == TypeKind::Array || iterable_type.kind == TypeKind::Slice) {
-            if (!iterable_type.generic_args.empty()) {
-                elem_type = stringify_type(iterable_type.generic_args[0]);
+        if (iterable_type->kind == TypeKind::Array || iterable_type->kind == TypeKind::Slice) {
+            if (!iterable_type->generic_args.empty()) {
+                elem_type = stringify_type(iterable_type->generic_args[0]);
             }
-        } else if (iterable_type.name == "Range") {
+        } else if (iterable_type->name == "Range") {
             elem_type = "Int32";
         }
 
         // Declare loop variable
-        std::string var_type = fl->var_type.empty() ? elem_type : fl->var_type;
-        current_scope_->declare({fl->variable,
-                                 SymbolKind::Variable,
-                                 false,
-                                 false,
-                                 false, // is_moved
-                                 true,  // is_initialized
-                                 ast::Visibility::None,
-                                 "",
-                                 var_type,
-                                 {}});
+        std::string var_type = fl->var_type ? ast::spelling(fl->var_type) : elem_type;
+        Symbol var{fl->variable,
+                   SymbolKind::Variable,
+                   false,
+                   false,
+                   false, // is_moved
+                   true,  // is_initialized
+                   ast::Visibility::None,
+                   "",
+                   var_type,
+                   {}};
+        var.resolved_type = fl->var_type ? resolve_type(fl->var_type) : type_from_name(elem_type);
+        current_scope_->declare(std::move(var));
 
         bool prev_in_loop = in_loop_;
         in_loop_ = true;
@@ -2624,7 +2918,8 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
     }
 
     // loop
-    if (const auto* lp = dynamic_cast<const ast::LoopStmt*>(&stmt)) {
+    case ast::StmtKind::Loop: {
+        const auto* lp = ast::cast<ast::LoopStmt>(&stmt);
         bool prev_in_loop = in_loop_;
         bool prev_break_found = break_found_;
         in_loop_ = true;
@@ -2639,7 +2934,8 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
     }
 
     // break
-    if (const auto* brk = dynamic_cast<const ast::BreakStmt*>(&stmt)) {
+    case ast::StmtKind::Break: {
+        const auto* brk = ast::cast<ast::BreakStmt>(&stmt);
         if (!in_loop_) {
             throw DiagnosticError("'break' used outside of loop", 0, 0);
         }
@@ -2651,7 +2947,7 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
     }
 
     // continue
-    if (dynamic_cast<const ast::ContinueStmt*>(&stmt)) {
+    case ast::StmtKind::Continue: {
         if (!in_loop_) {
             throw DiagnosticError("'continue' used outside of loop", 0, 0);
         }
@@ -2659,35 +2955,38 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
     }
 
     // expression statement
-    if (const auto* es = dynamic_cast<const ast::ExprStmt*>(&stmt)) {
+    case ast::StmtKind::Expr: {
+        const auto* es = ast::cast<ast::ExprStmt>(&stmt);
         resolve_expression(*es->expression);
-        return type_of(*es->expression).kind == TypeKind::Never;
+        return type_of(*es->expression)->kind == TypeKind::Never;
     }
 
     // match statement
-    if (const auto* ms = dynamic_cast<const ast::MatchStmt*>(&stmt)) {
-        FluxType subject_type = type_of(*ms->expression);
+    case ast::StmtKind::Match: {
+        const auto* ms = ast::cast<ast::MatchStmt>(&stmt);
+        TypeId subject_type = type_of(*ms->expression);
         resolve_expression(*ms->expression);
 
-        if (subject_type.kind == TypeKind::Enum && !enum_variants_.contains(subject_type.name)) {
-            throw DiagnosticError("unknown enum type '" + subject_type.name + "' in match", 0, 0);
+        if (subject_type->kind == TypeKind::Enum &&
+            !declarations_->enum_variants.contains(subject_type->name)) {
+            throw DiagnosticError("unknown enum type '" + subject_type->name + "' in match", 0, 0);
         }
 
         std::vector<const ast::Pattern*> patterns_to_check;
         for (const auto& arm : ms->arms) {
             if (!arm.guard) {
-                patterns_to_check.push_back(arm.pattern.get());
+                patterns_to_check.push_back(arm.pattern);
             }
         }
 
         if (!is_pattern_exhaustive(subject_type, patterns_to_check)) {
-            throw DiagnosticError("non-exhaustive match on '" + subject_type.name +
+            throw DiagnosticError("non-exhaustive match on '" + subject_type->name +
                                       "' (missing cases or add '_' wildcard)",
                                   0, 0);
         }
 
         auto base_state = save_initialization_state();
-        std::vector<std::unordered_map<Symbol*, bool>> arm_states;
+        std::vector<FlowState::Snapshot> arm_states;
         std::vector<bool> arm_diverges;
 
         for (const auto& arm : ms->arms) {
@@ -2723,6 +3022,7 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
 
         return false;
     }
+    }
 
     throw DiagnosticError("unsupported statement", 0, 0);
 }
@@ -2732,7 +3032,9 @@ bool Resolver::resolve_statement(const ast::Stmt& stmt) {
    ======================= */
 
 void Resolver::resolve_expression(const ast::Expr& expr) {
-    if (const auto* id = dynamic_cast<const ast::IdentifierExpr*>(&expr)) {
+    switch (expr.kind) {
+    case ast::ExprKind::Identifier: {
+        const auto* id = ast::cast<ast::IdentifierExpr>(&expr);
         // Enum variants are NOT variables and do not require lookup
         if (is_enum_variant(id->name)) {
             return;
@@ -2761,24 +3063,25 @@ void Resolver::resolve_expression(const ast::Expr& expr) {
         }
 
         if (sym->kind == SymbolKind::Variable) {
-            if (!sym->is_initialized) {
+            if (!flow_.initialized(*sym)) {
                 throw DiagnosticError("use of uninitialized variable '" + id->name + "'", 0, 0);
             }
-            if (sym->is_moved) {
+            if (flow_.moved(*sym)) {
                 throw DiagnosticError("use of moved value '" + id->name + "'", 0, 0);
             }
         }
         return;
     }
 
-    if (const auto* call = dynamic_cast<const ast::CallExpr*>(&expr)) {
+    case ast::ExprKind::Call: {
+        const auto* call = ast::cast<ast::CallExpr>(&expr);
         (void)type_of(expr);
 
         // Determine parameter types for implicit move check
-        std::vector<FluxType> param_types;
+        std::vector<TypeId> param_types;
         bool is_inferred_ctor = false; // For Ok, Err, Some
 
-        if (auto callee_id = dynamic_cast<const ast::IdentifierExpr*>(call->callee.get())) {
+        if (auto callee_id = ast::dyn_cast<ast::IdentifierExpr>(call->callee)) {
             if (callee_id->name == "Ok" || callee_id->name == "Err" || callee_id->name == "Some") {
                 is_inferred_ctor = true;
             }
@@ -2786,9 +3089,9 @@ void Resolver::resolve_expression(const ast::Expr& expr) {
 
         try {
             // Re-fetch type to get signature (safe since type_of(expr) succeeded)
-            FluxType callee_type = type_of(*call->callee);
-            if (callee_type.kind == TypeKind::Function) {
-                param_types = callee_type.param_types;
+            TypeId callee_type = type_of(*call->callee);
+            if (callee_type->kind == TypeKind::Function) {
+                param_types = callee_type->param_types;
             }
         } catch (...) {
         }
@@ -2797,13 +3100,13 @@ void Resolver::resolve_expression(const ast::Expr& expr) {
             resolve_expression(*call->arguments[i]);
 
             // Implicit move for non-Copy arguments
-            if (auto id_expr = dynamic_cast<const ast::IdentifierExpr*>(call->arguments[i].get())) {
+            if (auto id_expr = ast::dyn_cast<ast::IdentifierExpr>(call->arguments[i])) {
                 bool should_move = false;
                 if (is_inferred_ctor) {
                     should_move = true;
                 } else if (i < param_types.size()) {
                     // If parameter is NOT a reference, it consumes the value
-                    if (!param_types[i].name.starts_with("&")) {
+                    if (!param_types[i]->name.starts_with("&")) {
                         should_move = true;
                     }
                 }
@@ -2812,9 +3115,7 @@ void Resolver::resolve_expression(const ast::Expr& expr) {
                     Symbol* sym = current_scope_->lookup_mut(id_expr->name);
                     if (sym && sym->kind == SymbolKind::Variable) {
                         if (!is_copy_type(sym->type)) {
-                            std::cout << "DEBUG: Marking " << id_expr->name
-                                      << " as moved (CallExpr)" << std::endl;
-                            sym->is_moved = true;
+                            flow_.set_moved(*sym, true);
                         }
                     }
                 }
@@ -2823,7 +3124,8 @@ void Resolver::resolve_expression(const ast::Expr& expr) {
         return;
     }
 
-    if (const auto* bin = dynamic_cast<const ast::BinaryExpr*>(&expr)) {
+    case ast::ExprKind::Binary: {
+        const auto* bin = ast::cast<ast::BinaryExpr>(&expr);
         if (bin->op == TokenKind::ColonColon) {
             // Use type_of to validate and enforce visibility for qualified names
             (void)type_of(expr);
@@ -2843,39 +3145,40 @@ void Resolver::resolve_expression(const ast::Expr& expr) {
         return;
     }
 
-    if (const auto* un = dynamic_cast<const ast::UnaryExpr*>(&expr)) {
+    case ast::ExprKind::Unary: {
+        const auto* un = ast::cast<ast::UnaryExpr>(&expr);
         resolve_expression(*un->operand);
 
         if (un->op == TokenKind::Amp) {
             // It's a reference & or &mut
-            if (auto id = dynamic_cast<const ast::IdentifierExpr*>(un->operand.get())) {
+            if (auto id = ast::dyn_cast<ast::IdentifierExpr>(un->operand)) {
                 Symbol* sym = current_scope_->lookup_mut(id->name);
                 if (sym && sym->kind == SymbolKind::Variable) {
-                    if (sym->is_moved) {
+                    if (flow_.moved(*sym)) {
                         throw DiagnosticError("cannot borrow moved value '" + id->name + "'", 0, 0);
                     }
 
                     if (un->is_mutable) {
                         // &mut
-                        if (sym->is_mutably_borrowed) {
+                        if (flow_.mutably_borrowed(*sym)) {
                             throw DiagnosticError("cannot mutably borrow '" + id->name +
                                                       "' more than once at a time",
                                                   0, 0);
                         }
-                        if (sym->borrow_count > 0) {
+                        if (flow_.borrow_count(*sym) > 0) {
                             throw DiagnosticError("cannot mutably borrow '" + id->name +
                                                       "' while it is immutably borrowed",
                                                   0, 0);
                         }
-                        sym->is_mutably_borrowed = true;
+                        flow_.set_mutably_borrowed(*sym);
                     } else {
                         // &
-                        if (sym->is_mutably_borrowed) {
+                        if (flow_.mutably_borrowed(*sym)) {
                             throw DiagnosticError("cannot immutably borrow '" + id->name +
                                                       "' while it is mutably borrowed",
                                                   0, 0);
                         }
-                        sym->borrow_count++;
+                        flow_.add_borrow(*sym);
                     }
                 }
             }
@@ -2883,18 +3186,19 @@ void Resolver::resolve_expression(const ast::Expr& expr) {
         return;
     }
 
-    if (const auto* mv = dynamic_cast<const ast::MoveExpr*>(&expr)) {
-        if (auto id = dynamic_cast<const ast::IdentifierExpr*>(mv->operand.get())) {
+    case ast::ExprKind::Move: {
+        const auto* mv = ast::cast<ast::MoveExpr>(&expr);
+        if (auto id = ast::dyn_cast<ast::IdentifierExpr>(mv->operand)) {
             // Check if it's a variable
             Symbol* sym = current_scope_->lookup_mut(id->name);
             if (!sym) {
                 throw DiagnosticError("use of undeclared identifier '" + id->name + "'", 0, 0);
             }
             if (sym->kind == SymbolKind::Variable) {
-                if (sym->is_moved) {
+                if (flow_.moved(*sym)) {
                     throw DiagnosticError("use of moved value '" + id->name + "'", 0, 0);
                 }
-                sym->is_moved = true;
+                flow_.set_moved(*sym, true);
             }
             return;
         }
@@ -2902,7 +3206,8 @@ void Resolver::resolve_expression(const ast::Expr& expr) {
         return;
     }
 
-    if (const auto* sl = dynamic_cast<const ast::StructLiteralExpr*>(&expr)) {
+    case ast::ExprKind::StructLiteral: {
+        const auto* sl = ast::cast<ast::StructLiteralExpr>(&expr);
         // Check that the struct type exists
         std::string base = sl->struct_name;
         if (auto pos = base.find('<'); pos != std::string::npos) {
@@ -2915,11 +3220,11 @@ void Resolver::resolve_expression(const ast::Expr& expr) {
             resolve_expression(*field.value);
 
             // Implicit move for struct fields
-            if (auto id_expr = dynamic_cast<const ast::IdentifierExpr*>(field.value.get())) {
+            if (auto id_expr = ast::dyn_cast<ast::IdentifierExpr>(field.value)) {
                 Symbol* sym = current_scope_->lookup_mut(id_expr->name);
                 if (sym && sym->kind == SymbolKind::Variable) {
                     if (!is_copy_type(sym->type)) {
-                        sym->is_moved = true;
+                        flow_.set_moved(*sym, true);
                     }
                 }
             }
@@ -2927,40 +3232,43 @@ void Resolver::resolve_expression(const ast::Expr& expr) {
         return;
     }
 
-    if (const auto* cast = dynamic_cast<const ast::CastExpr*>(&expr)) {
+    case ast::ExprKind::Cast: {
+        const auto* cast = ast::cast<ast::CastExpr>(&expr);
         resolve_expression(*cast->expr);
         return;
     }
 
-    if (const auto* ep = dynamic_cast<const ast::ErrorPropagationExpr*>(&expr)) {
+    case ast::ExprKind::ErrorPropagation: {
+        const auto* ep = ast::cast<ast::ErrorPropagationExpr>(&expr);
         resolve_expression(*ep->operand);
-        FluxType op_type = type_of(*ep->operand);
+        TypeId op_type = type_of(*ep->operand);
 
-        if (op_type.kind != TypeKind::Option && op_type.kind != TypeKind::Result) {
+        if (op_type->kind != TypeKind::Option && op_type->kind != TypeKind::Result) {
             throw DiagnosticError(
                 "the '?' operator can only be used on Option or Result types, found '" +
-                    op_type.name + "'",
+                    op_type->name + "'",
                 0, 0);
         }
 
         // Validate compatibility with function return type
-        if (current_function_return_type_.kind == TypeKind::Option) {
-            if (op_type.kind != TypeKind::Option) {
+        if (current_function_return_type_->kind == TypeKind::Option) {
+            if (op_type->kind != TypeKind::Option) {
                 throw DiagnosticError("cannot propagate Result error in function returning Option",
                                       0, 0);
             }
-        } else if (current_function_return_type_.kind == TypeKind::Result) {
-            if (op_type.kind != TypeKind::Result) {
+        } else if (current_function_return_type_->kind == TypeKind::Result) {
+            if (op_type->kind != TypeKind::Result) {
                 throw DiagnosticError("cannot propagate Option None in function returning Result",
                                       0, 0);
             }
             // Check error type compatibility
-            if (current_function_return_type_.generic_args.size() >= 2 &&
-                op_type.generic_args.size() >= 2) {
-                if (current_function_return_type_.generic_args[1] != op_type.generic_args[1]) {
-                    throw DiagnosticError("propagated error type '" + op_type.generic_args[1].name +
+            if (current_function_return_type_->generic_args.size() >= 2 &&
+                op_type->generic_args.size() >= 2) {
+                if (current_function_return_type_->generic_args[1] != op_type->generic_args[1]) {
+                    throw DiagnosticError("propagated error type '" +
+                                              op_type->generic_args[1]->name +
                                               "' does not match function return error type '" +
-                                              current_function_return_type_.generic_args[1].name +
+                                              current_function_return_type_->generic_args[1]->name +
                                               "'",
                                           0, 0);
                 }
@@ -2972,17 +3280,20 @@ void Resolver::resolve_expression(const ast::Expr& expr) {
         return;
     }
 
-    if (const auto* aw = dynamic_cast<const ast::AwaitExpr*>(&expr)) {
+    case ast::ExprKind::Await: {
+        const auto* aw = ast::cast<ast::AwaitExpr>(&expr);
         resolve_expression(*aw->operand);
         return;
     }
 
-    if (const auto* sp = dynamic_cast<const ast::SpawnExpr*>(&expr)) {
+    case ast::ExprKind::Spawn: {
+        const auto* sp = ast::cast<ast::SpawnExpr>(&expr);
         resolve_expression(*sp->operand);
         return;
     }
 
-    if (const auto* rng = dynamic_cast<const ast::RangeExpr*>(&expr)) {
+    case ast::ExprKind::Range: {
+        const auto* rng = ast::cast<ast::RangeExpr>(&expr);
         if (rng->start)
             resolve_expression(*rng->start);
         if (rng->end)
@@ -2990,11 +3301,17 @@ void Resolver::resolve_expression(const ast::Expr& expr) {
         return;
     }
 
+    default:
+        break;
+    }
+
     // literals (NumberExpr, StringExpr, BoolExpr, CharExpr) are fine
 }
 
-void Resolver::resolve_pattern(const ast::Pattern& pattern, const FluxType& subject_type) {
-    if (const auto* id_pat = dynamic_cast<const ast::IdentifierPattern*>(&pattern)) {
+void Resolver::resolve_pattern(const ast::Pattern& pattern, TypeId subject_type) {
+    switch (pattern.kind) {
+    case ast::PatternKind::Identifier: {
+        const auto* id_pat = ast::cast<ast::IdentifierPattern>(&pattern);
         // Is this identifier an enum variant?
         if (is_enum_variant(id_pat->name)) {
             return;
@@ -3007,34 +3324,37 @@ void Resolver::resolve_pattern(const ast::Pattern& pattern, const FluxType& subj
         }
 
         // Otherwise: normal variable binding
-        if (!current_scope_->declare({id_pat->name,
-                                      SymbolKind::Variable,
-                                      false,
-                                      true,
-                                      false, // is_moved
-                                      true,  // is_initialized
-                                      ast::Visibility::None,
-                                      "",
-                                      stringify_type(subject_type),
-                                      {}})) {
+        Symbol sym{id_pat->name,
+                   SymbolKind::Variable,
+                   false,
+                   true,
+                   false, // is_moved
+                   true,  // is_initialized
+                   ast::Visibility::None,
+                   "",
+                   stringify_type(subject_type),
+                   {}};
+        sym.resolved_type = subject_type;
+        if (!current_scope_->declare(std::move(sym))) {
             throw DiagnosticError("duplicate variable '" + id_pat->name + "' in pattern", 0, 0);
         }
         return;
     }
 
-    if (const auto* var_pat = dynamic_cast<const ast::VariantPattern*>(&pattern)) {
+    case ast::PatternKind::Variant: {
+        const auto* var_pat = ast::cast<ast::VariantPattern>(&pattern);
         // Resolve nested patterns for enums/Option/Result
-        if (subject_type.kind == TypeKind::Option) {
+        if (subject_type->kind == TypeKind::Option) {
             if (var_pat->variant_name == "Some" && !var_pat->sub_patterns.empty()) {
-                resolve_pattern(*var_pat->sub_patterns[0], subject_type.generic_args[0]);
+                resolve_pattern(*var_pat->sub_patterns[0], subject_type->generic_args[0]);
             }
-        } else if (subject_type.kind == TypeKind::Result) {
+        } else if (subject_type->kind == TypeKind::Result) {
             if (var_pat->variant_name == "Ok" && !var_pat->sub_patterns.empty()) {
-                resolve_pattern(*var_pat->sub_patterns[0], subject_type.generic_args[0]);
+                resolve_pattern(*var_pat->sub_patterns[0], subject_type->generic_args[0]);
             } else if (var_pat->variant_name == "Err" && !var_pat->sub_patterns.empty()) {
-                resolve_pattern(*var_pat->sub_patterns[0], subject_type.generic_args[1]);
+                resolve_pattern(*var_pat->sub_patterns[0], subject_type->generic_args[1]);
             }
-        } else if (subject_type.kind == TypeKind::Enum) {
+        } else if (subject_type->kind == TypeKind::Enum) {
             // For general enums, we should verify it's a valid variant
             // For now, assume variants have no members or use Unknown
             for (const auto& sub : var_pat->sub_patterns) {
@@ -3044,44 +3364,47 @@ void Resolver::resolve_pattern(const ast::Pattern& pattern, const FluxType& subj
         return;
     }
 
-    if (const auto* tup_pat = dynamic_cast<const ast::TuplePattern*>(&pattern)) {
-        if (subject_type.kind != TypeKind::Tuple) {
+    case ast::PatternKind::Tuple: {
+        const auto* tup_pat = ast::cast<ast::TuplePattern>(&pattern);
+        if (subject_type->kind != TypeKind::Tuple) {
             throw DiagnosticError(
-                "expected tuple type for tuple pattern, found '" + subject_type.name + "'", 0, 0);
+                "expected tuple type for tuple pattern, found '" + subject_type->name + "'", 0, 0);
         }
-        if (tup_pat->elements.size() != subject_type.generic_args.size()) {
+        if (tup_pat->elements.size() != subject_type->generic_args.size()) {
             throw DiagnosticError("tuple pattern arity mismatch: expected " +
-                                      std::to_string(subject_type.generic_args.size()) +
+                                      std::to_string(subject_type->generic_args.size()) +
                                       ", found " + std::to_string(tup_pat->elements.size()),
                                   0, 0);
         }
         for (size_t i = 0; i < tup_pat->elements.size(); ++i) {
-            resolve_pattern(*tup_pat->elements[i], subject_type.generic_args[i]);
+            resolve_pattern(*tup_pat->elements[i], subject_type->generic_args[i]);
         }
         return;
     }
 
-    if (const auto* struct_pat = dynamic_cast<const ast::StructPattern*>(&pattern)) {
-        if (subject_type.kind != TypeKind::Struct) {
-            throw DiagnosticError(
-                "expected struct type for struct pattern, found '" + subject_type.name + "'", 0, 0);
+    case ast::PatternKind::Struct: {
+        const auto* struct_pat = ast::cast<ast::StructPattern>(&pattern);
+        if (subject_type->kind != TypeKind::Struct) {
+            throw DiagnosticError("expected struct type for struct pattern, found '" +
+                                      subject_type->name + "'",
+                                  0, 0);
         }
-        if (!struct_fields_.contains(subject_type.name)) {
-            throw DiagnosticError("unknown struct '" + subject_type.name + "' in struct pattern", 0,
-                                  0);
+        if (!declarations_->struct_fields.contains(subject_type->name)) {
+            throw DiagnosticError("unknown struct '" + subject_type->name + "' in struct pattern",
+                                  0, 0);
         }
-        const auto& fields = struct_fields_.at(subject_type.name);
+        const auto& fields = declarations_->struct_fields.at(subject_type->name);
         for (const auto& fp : struct_pat->fields) {
             bool found = false;
             for (const auto& info : fields) {
                 if (fp.field_name == info.name) {
-                    resolve_pattern(*fp.pattern, type_from_name(info.type));
+                    resolve_pattern(*fp.pattern, resolve_type(info.type));
                     found = true;
                     break;
                 }
             }
             if (!found) {
-                throw DiagnosticError("struct '" + subject_type.name + "' has no field named '" +
+                throw DiagnosticError("struct '" + subject_type->name + "' has no field named '" +
                                           fp.field_name + "'",
                                       0, 0);
             }
@@ -3089,33 +3412,35 @@ void Resolver::resolve_pattern(const ast::Pattern& pattern, const FluxType& subj
         return;
     }
 
-    if (const auto* lit_pat = dynamic_cast<const ast::LiteralPattern*>(&pattern)) {
+    case ast::PatternKind::Literal: {
+        const auto* lit_pat = ast::cast<ast::LiteralPattern>(&pattern);
         resolve_expression(*lit_pat->literal);
-        FluxType lit_type = type_of(*lit_pat->literal);
+        TypeId lit_type = type_of(*lit_pat->literal);
         if (!are_types_compatible(subject_type, lit_type)) {
-            throw DiagnosticError("literal pattern type '" + lit_type.name +
-                                      "' is incompatible with subject type '" + subject_type.name +
+            throw DiagnosticError("literal pattern type '" + lit_type->name +
+                                      "' is incompatible with subject type '" + subject_type->name +
                                       "'",
                                   0, 0);
         }
         return;
     }
 
-    if (const auto* or_pat = dynamic_cast<const ast::OrPattern*>(&pattern)) {
+    case ast::PatternKind::Or: {
+        const auto* or_pat = ast::cast<ast::OrPattern>(&pattern);
         if (or_pat->alternatives.size() < 2) {
             throw DiagnosticError("or-pattern must have at least two alternatives", 0, 0);
         }
 
-        std::map<std::string, FluxType> expected_bindings;
+        std::map<std::string, TypeId> expected_bindings;
         bool first = true;
 
         for (const auto& alt : or_pat->alternatives) {
             enter_scope();
             resolve_pattern(*alt, subject_type);
 
-            std::map<std::string, FluxType> current_bindings;
+            std::map<std::string, TypeId> current_bindings;
             for (const auto& [name, sym] : current_scope_->get_symbols()) {
-                current_bindings[name] = type_from_name(sym.type);
+                current_bindings[name] = symbol_type(sym);
             }
             exit_scope();
 
@@ -3145,38 +3470,41 @@ void Resolver::resolve_pattern(const ast::Pattern& pattern, const FluxType& subj
         }
 
         for (const auto& [name, type] : expected_bindings) {
-            current_scope_->declare({name,
-                                     SymbolKind::Variable,
-                                     false,
-                                     true,
-                                     false,
-                                     true, // is_initialized
-                                     ast::Visibility::None,
-                                     "",
-                                     stringify_type(type),
-                                     {}});
+            Symbol sym{name,
+                       SymbolKind::Variable,
+                       false,
+                       true,
+                       false,
+                       true, // is_initialized
+                       ast::Visibility::None,
+                       "",
+                       stringify_type(type),
+                       {}};
+            sym.resolved_type = type;
+            current_scope_->declare(std::move(sym));
         }
         return;
     }
 
-    if (const auto* range_pat = dynamic_cast<const ast::RangePattern*>(&pattern)) {
+    case ast::PatternKind::Range: {
+        const auto* range_pat = ast::cast<ast::RangePattern>(&pattern);
         resolve_expression(*range_pat->start);
         resolve_expression(*range_pat->end);
-        FluxType start_type = type_of(*range_pat->start);
-        FluxType end_type = type_of(*range_pat->end);
+        TypeId start_type = type_of(*range_pat->start);
+        TypeId end_type = type_of(*range_pat->end);
 
         if (!this->are_types_compatible(start_type, end_type)) {
             throw DiagnosticError("range pattern bounds must have compatible types", 0, 0);
         }
 
         if (!this->are_types_compatible(subject_type, start_type)) {
-            throw DiagnosticError("range pattern type mismatch: expected '" + subject_type.name +
-                                      "', found '" + start_type.name + "'",
+            throw DiagnosticError("range pattern type mismatch: expected '" + subject_type->name +
+                                      "', found '" + start_type->name + "'",
                                   0, 0);
         }
 
-        if (start_type.kind != TypeKind::Int && start_type.kind != TypeKind::Float &&
-            start_type.kind != TypeKind::Char) {
+        if (start_type->kind != TypeKind::Int && start_type->kind != TypeKind::Float &&
+            start_type->kind != TypeKind::Char) {
             throw DiagnosticError("range patterns are only supported for numeric and char types", 0,
                                   0);
         }
@@ -3184,58 +3512,62 @@ void Resolver::resolve_pattern(const ast::Pattern& pattern, const FluxType& subj
         return;
     }
 
+    default:
+        break;
+    }
+
     // WildcardPattern is fine
 }
 
-std::string Resolver::stringify_type(const FluxType& type) const {
-    if (type.kind == TypeKind::Ref) {
-        return (type.is_mut_ref ? "&mut " : "&") +
-               (type.generic_args.empty() ? type.name : stringify_type(type.generic_args[0]));
+std::string Resolver::stringify_type(TypeId type) const {
+    if (type->kind == TypeKind::Ref) {
+        return (type->is_mut_ref ? "&mut " : "&") +
+               (type->generic_args.empty() ? type->name : stringify_type(type->generic_args[0]));
     }
-    if (type.kind == TypeKind::Tuple) {
+    if (type->kind == TypeKind::Tuple) {
         std::string res = "(";
-        for (size_t i = 0; i < type.generic_args.size(); ++i) {
+        for (size_t i = 0; i < type->generic_args.size(); ++i) {
             if (i > 0)
                 res += ", ";
-            res += stringify_type(type.generic_args[i]);
+            res += stringify_type(type->generic_args[i]);
         }
         res += ")";
         return res;
     }
-    if (type.kind == TypeKind::Function) {
+    if (type->kind == TypeKind::Function) {
         std::string res = "(";
-        for (size_t i = 0; i < type.param_types.size(); ++i) {
+        for (size_t i = 0; i < type->param_types.size(); ++i) {
             if (i > 0)
                 res += ", ";
-            res += stringify_type(type.param_types[i]);
+            res += stringify_type(type->param_types[i]);
         }
-        res += ") -> " + (type.return_type ? stringify_type(*type.return_type) : "Void");
+        res += ") -> " + stringify_type(type->return_type);
         return res;
     }
 
-    std::string base = type.name;
-    if (!type.generic_args.empty()) {
+    std::string base = type->name;
+    if (!type->generic_args.empty()) {
         base += "<";
-        for (size_t i = 0; i < type.generic_args.size(); ++i) {
+        for (size_t i = 0; i < type->generic_args.size(); ++i) {
             if (i > 0)
                 base += ", ";
-            base += stringify_type(type.generic_args[i]);
+            base += stringify_type(type->generic_args[i]);
         }
         base += ">";
     }
     return base;
 }
 
-bool Resolver::is_pattern_exhaustive(const FluxType& type,
+bool Resolver::is_pattern_exhaustive(TypeId type,
                                      const std::vector<const ast::Pattern*>& patterns) const {
     if (patterns.empty())
         return false;
 
     // 1. Check for catch-all patterns
     for (const auto* pat : patterns) {
-        if (dynamic_cast<const ast::WildcardPattern*>(pat))
+        if (ast::isa<ast::WildcardPattern>(pat))
             return true;
-        if (const auto* id_pat = dynamic_cast<const ast::IdentifierPattern*>(pat)) {
+        if (const auto* id_pat = ast::dyn_cast<ast::IdentifierPattern>(pat)) {
             if (!is_enum_variant(id_pat->name) && id_pat->name != "None" &&
                 id_pat->name != "Some" && id_pat->name != "Ok" && id_pat->name != "Err") {
                 return true;
@@ -3244,21 +3576,21 @@ bool Resolver::is_pattern_exhaustive(const FluxType& type,
     }
 
     // 2. Handle specific types
-    if (type.kind == TypeKind::Bool) {
+    if (type->kind == TypeKind::Bool) {
         bool true_covered = false;
         bool false_covered = false;
         for (const auto* pat : patterns) {
-            if (const auto* lit = dynamic_cast<const ast::LiteralPattern*>(pat)) {
-                if (const auto* b = dynamic_cast<const ast::BoolExpr*>(lit->literal.get())) {
+            if (const auto* lit = ast::dyn_cast<ast::LiteralPattern>(pat)) {
+                if (const auto* b = ast::dyn_cast<ast::BoolExpr>(lit->literal)) {
                     if (b->value)
                         true_covered = true;
                     else
                         false_covered = true;
                 }
-            } else if (const auto* or_pat = dynamic_cast<const ast::OrPattern*>(pat)) {
+            } else if (const auto* or_pat = ast::dyn_cast<ast::OrPattern>(pat)) {
                 std::vector<const ast::Pattern*> alts;
                 for (const auto& a : or_pat->alternatives)
-                    alts.push_back(a.get());
+                    alts.push_back(a);
                 if (is_pattern_exhaustive(type, alts))
                     return true;
             }
@@ -3266,62 +3598,61 @@ bool Resolver::is_pattern_exhaustive(const FluxType& type,
         return true_covered && false_covered;
     }
 
-    if (type.kind == TypeKind::Enum || type.kind == TypeKind::Option ||
-        type.kind == TypeKind::Result) {
+    if (type->kind == TypeKind::Enum || type->kind == TypeKind::Option ||
+        type->kind == TypeKind::Result) {
         std::vector<std::string> variants;
-        if (type.kind == TypeKind::Option) {
+        if (type->kind == TypeKind::Option) {
             variants = {"Some", "None"};
-        } else if (type.kind == TypeKind::Result) {
+        } else if (type->kind == TypeKind::Result) {
             variants = {"Ok", "Err"};
         } else {
-            if (enum_variants_.find(type.name) == enum_variants_.end())
+            if (declarations_->enum_variants.find(type->name) == declarations_->enum_variants.end())
                 return false;
-            variants = enum_variants_.at(type.name);
+            variants = declarations_->enum_variants.at(type->name);
         }
 
         for (const auto& variant : variants) {
             std::vector<const ast::Pattern*> sub_patterns;
-            FluxType member_type = unknown_type();
+            TypeId member_type = unknown_type();
 
-            if (type.kind == TypeKind::Option && variant == "Some") {
-                member_type = type.generic_args[0];
-            } else if (type.kind == TypeKind::Result) {
+            if (type->kind == TypeKind::Option && variant == "Some") {
+                member_type = type->generic_args[0];
+            } else if (type->kind == TypeKind::Result) {
                 if (variant == "Ok")
-                    member_type = type.generic_args[0];
+                    member_type = type->generic_args[0];
                 else if (variant == "Err")
-                    member_type = type.generic_args[1];
+                    member_type = type->generic_args[1];
             }
 
             bool variant_fully_covered = false;
             for (const auto* pat : patterns) {
-                if (const auto* var_pat = dynamic_cast<const ast::VariantPattern*>(pat)) {
+                if (const auto* var_pat = ast::dyn_cast<ast::VariantPattern>(pat)) {
                     if (var_pat->variant_name == variant ||
-                        var_pat->variant_name == type.name + "::" + variant) {
+                        var_pat->variant_name == type->name + "::" + variant) {
                         if (var_pat->sub_patterns.empty()) {
                             variant_fully_covered = true;
                             break;
                         }
                         for (const auto& sp : var_pat->sub_patterns)
-                            sub_patterns.push_back(sp.get());
+                            sub_patterns.push_back(sp);
                     }
-                } else if (const auto* id_pat = dynamic_cast<const ast::IdentifierPattern*>(pat)) {
-                    if (id_pat->name == variant || id_pat->name == type.name + "::" + variant) {
+                } else if (const auto* id_pat = ast::dyn_cast<ast::IdentifierPattern>(pat)) {
+                    if (id_pat->name == variant || id_pat->name == type->name + "::" + variant) {
                         variant_fully_covered = true;
                         break;
                     }
-                } else if (const auto* or_pat = dynamic_cast<const ast::OrPattern*>(pat)) {
+                } else if (const auto* or_pat = ast::dyn_cast<ast::OrPattern>(pat)) {
                     // This is a bit simplified, but handle top-level Or in enums
                     for (const auto& alt : or_pat->alternatives) {
-                        if (const auto* sub_var =
-                                dynamic_cast<const ast::VariantPattern*>(alt.get())) {
+                        if (const auto* sub_var = ast::dyn_cast<ast::VariantPattern>(alt)) {
                             if (sub_var->variant_name == variant ||
-                                sub_var->variant_name == type.name + "::" + variant) {
+                                sub_var->variant_name == type->name + "::" + variant) {
                                 if (sub_var->sub_patterns.empty()) {
                                     variant_fully_covered = true;
                                     break;
                                 }
                                 for (const auto& sp : sub_var->sub_patterns)
-                                    sub_patterns.push_back(sp.get());
+                                    sub_patterns.push_back(sp);
                             }
                         }
                     }
@@ -3334,7 +3665,7 @@ bool Resolver::is_pattern_exhaustive(const FluxType& type,
             if (sub_patterns.empty())
                 return false;
 
-            if (member_type.kind != TypeKind::Unknown) {
+            if (member_type->kind != TypeKind::Unknown) {
                 if (!is_pattern_exhaustive(member_type, sub_patterns))
                     return false;
             }
@@ -3388,12 +3719,12 @@ std::string Resolver::promote_integer_name(const std::string& a, const std::stri
     }
 }
 
-bool Resolver::are_types_compatible(const FluxType& target, const FluxType& source) const {
-    if (target.kind == TypeKind::Unknown || source.kind == TypeKind::Unknown) {
+bool Resolver::are_types_compatible(TypeId target, TypeId source) const {
+    if (target->kind == TypeKind::Unknown || source->kind == TypeKind::Unknown) {
         return true;
     }
 
-    if (source.kind == TypeKind::Never) {
+    if (source->kind == TypeKind::Never) {
         return true;
     }
 
@@ -3402,39 +3733,39 @@ bool Resolver::are_types_compatible(const FluxType& target, const FluxType& sour
     }
 
     // Special handling for Option<T>
-    if (target.kind == TypeKind::Option && source.kind == TypeKind::Option) {
+    if (target->kind == TypeKind::Option && source->kind == TypeKind::Option) {
         // Option<Unknown> (from None) is compatible with any Option<T>
-        if (source.generic_args.empty() || source.generic_args[0].kind == TypeKind::Unknown) {
+        if (source->generic_args.empty() || source->generic_args[0]->kind == TypeKind::Unknown) {
             return true;
         }
         // Check inner types
-        if (!target.generic_args.empty() && !source.generic_args.empty()) {
-            return are_types_compatible(target.generic_args[0], source.generic_args[0]);
+        if (!target->generic_args.empty() && !source->generic_args.empty()) {
+            return are_types_compatible(target->generic_args[0], source->generic_args[0]);
         }
     }
 
     // Special handling for Result<T, E>
-    if (target.kind == TypeKind::Result && source.kind == TypeKind::Result) {
+    if (target->kind == TypeKind::Result && source->kind == TypeKind::Result) {
         // Result<T, Unknown> (from Ok(T)) -> compatible if T matches
         // Result<Unknown, E> (from Err(E)) -> compatible if E matches
         bool t_ok = true;
         bool e_ok = true;
 
         // Check T
-        if (!target.generic_args.empty() && !source.generic_args.empty()) {
+        if (!target->generic_args.empty() && !source->generic_args.empty()) {
             // If source T is unknown, it means it's an Err variant, so it
             // matches any T target
-            if (source.generic_args[0].kind != TypeKind::Unknown) {
-                t_ok = are_types_compatible(target.generic_args[0], source.generic_args[0]);
+            if (source->generic_args[0]->kind != TypeKind::Unknown) {
+                t_ok = are_types_compatible(target->generic_args[0], source->generic_args[0]);
             }
         }
 
         // Check E
-        if (target.generic_args.size() > 1 && source.generic_args.size() > 1) {
+        if (target->generic_args.size() > 1 && source->generic_args.size() > 1) {
             // If source E is unknown, it means it's an Ok variant, so it
             // matches any E target
-            if (source.generic_args[1].kind != TypeKind::Unknown) {
-                e_ok = are_types_compatible(target.generic_args[1], source.generic_args[1]);
+            if (source->generic_args[1]->kind != TypeKind::Unknown) {
+                e_ok = are_types_compatible(target->generic_args[1], source->generic_args[1]);
             }
         }
 
@@ -3492,89 +3823,43 @@ Resolver::parse_type_param_bounds(const std::vector<std::string>& type_params) {
 
 bool Resolver::type_implements_trait(const std::string& type_name,
                                      const std::string& trait_name) const {
-    auto it = trait_impls_.find(type_name);
-    if (it != trait_impls_.end()) {
+    auto it = declarations_->trait_impls.find(type_name);
+    if (it != declarations_->trait_impls.end()) {
         return it->second.count(trait_name) > 0;
     }
     return false;
 }
 
-std::vector<TypeParamBound> Resolver::parse_where_clause(const std::string& where_clause) {
+std::vector<TypeParamBound> Resolver::where_clause_bounds(const ast::WhereClause& where_clause) {
     std::vector<TypeParamBound> result;
-    if (where_clause.empty())
-        return result;
-
-    // "T: Trait + Other, U: Trait"
-    size_t start = 0;
-    while (start < where_clause.size()) {
-        auto comma_pos = where_clause.find(',', start);
-        std::string part;
-        if (comma_pos == std::string::npos) {
-            part = where_clause.substr(start);
-            start = where_clause.size();
-        } else {
-            part = where_clause.substr(start, comma_pos - start);
-            start = comma_pos + 1;
-        }
-
-        // Parse "T: Bounds"
-        auto colon_pos = part.find(':');
-        if (colon_pos != std::string::npos) {
-            TypeParamBound bound;
-            bound.param_name = part.substr(0, colon_pos);
-            // Trim param name
-            size_t p_first = bound.param_name.find_first_not_of(" \t\n");
-            if (p_first != std::string::npos) {
-                size_t p_last = bound.param_name.find_last_not_of(" \t\n");
-                bound.param_name = bound.param_name.substr(p_first, p_last - p_first + 1);
-            }
-
-            std::string bounds_str = part.substr(colon_pos + 1);
-            // Split bounds by '+'
-            size_t b_start = 0;
-            while (b_start < bounds_str.size()) {
-                auto plus_pos = bounds_str.find('+', b_start);
-                std::string trait_name;
-                if (plus_pos == std::string::npos) {
-                    trait_name = bounds_str.substr(b_start);
-                    b_start = bounds_str.size();
-                } else {
-                    trait_name = bounds_str.substr(b_start, plus_pos - b_start);
-                    b_start = plus_pos + 1;
-                }
-                // Trim trait name
-                size_t t_first = trait_name.find_first_not_of(" \t\n");
-                if (t_first != std::string::npos) {
-                    size_t t_last = trait_name.find_last_not_of(" \t\n");
-                    bound.bounds.push_back(trait_name.substr(t_first, t_last - t_first + 1));
-                }
-            }
-            if (!bound.bounds.empty()) {
-                result.push_back(std::move(bound));
-            }
-        }
+    for (const auto& predicate : where_clause) {
+        TypeParamBound bound;
+        bound.param_name = predicate.param;
+        for (const ast::TypeExpr* trait : predicate.bounds)
+            bound.bounds.push_back(ast::spelling(trait));
+        if (!bound.bounds.empty())
+            result.push_back(std::move(bound));
     }
     return result;
 }
 
+std::size_t hash_instantiation(Name name, const std::vector<TypeId>& args) {
+    std::size_t seed = std::hash<Name>{}(name);
+    for (TypeId arg : args)
+        seed ^= std::hash<TypeId>{}(arg) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
 void Resolver::record_function_instantiation(const std::string& name,
-                                             const std::vector<FluxType>& args) {
-    FunctionInstantiation inst{name, args};
-    for (const auto& existing : function_instantiations_) {
-        if (existing == inst)
-            return;
-    }
-    function_instantiations_.push_back(std::move(inst));
+                                             const std::vector<TypeId>& args) {
+    function_instantiations_.insert({name, args});
 }
 
 void Resolver::record_type_instantiation(const std::string& name,
-                                         const std::vector<FluxType>& args) {
-    TypeInstantiation inst{name, args};
-    for (const auto& existing : type_instantiations_) {
-        if (existing == inst)
-            return;
-    }
-    type_instantiations_.push_back(std::move(inst));
+                                         const std::vector<TypeId>& args) {
+    if (recording_)
+        recording_->type_instantiations.push_back({name, args});
+    type_instantiations_.insert({name, args});
 }
 
 std::vector<std::string> Resolver::get_bounds_for_type(const std::string& type_name) {
@@ -3586,8 +3871,9 @@ std::vector<std::string> Resolver::get_bounds_for_type(const std::string& type_n
     else if (base.starts_with("&"))
         base = base.substr(1);
 
-    if (!current_function_name_.empty() && function_type_params_.contains(current_function_name_)) {
-        for (const auto& p : function_type_params_.at(current_function_name_)) {
+    if (!current_function_name_.empty() &&
+        declarations_->function_type_params.contains(current_function_name_)) {
+        for (const auto& p : declarations_->function_type_params.at(current_function_name_)) {
             if (p.starts_with(base + ":")) {
                 size_t colon = p.find(':');
                 std::string traits_list = p.substr(colon + 1);
@@ -3611,8 +3897,8 @@ std::vector<std::string> Resolver::get_bounds_for_type(const std::string& type_n
         }
     }
     if (bounds.empty() && !current_type_name_.empty() &&
-        type_type_params_.contains(current_type_name_)) {
-        for (const auto& p : type_type_params_.at(current_type_name_)) {
+        declarations_->type_type_params.contains(current_type_name_)) {
+        for (const auto& p : declarations_->type_type_params.at(current_type_name_)) {
             if (p.starts_with(base + ":")) {
                 size_t colon = p.find(':');
                 std::string traits_list = p.substr(colon + 1);
@@ -3651,7 +3937,7 @@ bool Resolver::compare_signatures(
             trait_ret = concrete;
     }
 
-    std::string impl_ret = impl_fn.return_type;
+    std::string impl_ret = ast::spelling(impl_fn.return_type);
     if (impl_ret == "Self")
         impl_ret = target_type;
 
@@ -3663,9 +3949,9 @@ bool Resolver::compare_signatures(
     std::vector<std::string> impl_param_types;
     for (const auto& p : impl_fn.params) {
         if (p.name == "self")
-            impl_self_type = p.type;
+            impl_self_type = ast::spelling(p.type);
         else
-            impl_param_types.push_back(p.type);
+            impl_param_types.push_back(ast::spelling(p.type));
     }
 
     std::string trait_self = trait_sig.self_type;
@@ -3732,8 +4018,8 @@ void Resolver::monomorphize_recursive() {
         auto inst = function_instantiations_[processed++];
 
         const ast::FunctionDecl* fn = nullptr;
-        if (function_decls_.contains(inst.name)) {
-            fn = function_decls_.at(inst.name);
+        if (declarations_->function_decls.contains(inst.name)) {
+            fn = declarations_->function_decls.at(inst.name);
         }
 
         if (!fn)
@@ -3741,8 +4027,8 @@ void Resolver::monomorphize_recursive() {
 
         // Setup substitution map for this specific instantiation
         substitution_map_.clear();
-        auto it = function_type_params_.find(inst.name);
-        if (it != function_type_params_.end()) {
+        auto it = declarations_->function_type_params.find(inst.name);
+        if (it != declarations_->function_type_params.end()) {
             std::vector<std::string> raw_params;
             for (const auto& p : it->second) {
                 if (p.find(':') == std::string::npos) {
@@ -3756,6 +4042,7 @@ void Resolver::monomorphize_recursive() {
 
         // Re-resolve function body with concrete types
         // This will trigger additional record_function_instantiation calls for transitive calls
+        flow_.restore(declared_flow_);
         try {
             resolve_function(*fn, inst.name);
         } catch (const DiagnosticError&) {
@@ -3765,41 +4052,24 @@ void Resolver::monomorphize_recursive() {
     }
 }
 
-std::unordered_map<Symbol*, bool> Resolver::save_initialization_state() {
-    std::unordered_map<Symbol*, bool> state;
-    Scope* s = current_scope_;
-    while (s) {
-        for (auto& [name, sym] : s->get_symbols_mut()) {
-            if (sym.kind == SymbolKind::Variable) {
-                state[&sym] = sym.is_initialized;
-            }
-        }
-        s = s->parent();
-    }
-    return state;
+FlowState::Snapshot Resolver::save_initialization_state() const {
+    return flow_.save();
 }
 
-void Resolver::restore_initialization_state(const std::unordered_map<Symbol*, bool>& state) {
-    for (auto& [sym, init] : state) {
-        sym->is_initialized = init;
-    }
+void Resolver::restore_initialization_state(const FlowState::Snapshot& state) {
+    flow_.restore(state);
 }
 
-void Resolver::intersect_initialization_state(
-    const std::unordered_map<Symbol*, bool>& other_state) {
-    for (auto& [sym, init] : other_state) {
-        if (!init) {
-            sym->is_initialized = false;
-        }
-    }
+void Resolver::intersect_initialization_state(const FlowState::Snapshot& other_state) {
+    flow_.meet(other_state);
 }
 
 std::string Resolver::resolve_name(const std::string& name, const std::string& module_name) const {
     const std::string& search_module = module_name.empty() ? current_module_name_ : module_name;
 
     // Check module aliases
-    if (module_aliases_.count(search_module)) {
-        const auto& aliases = module_aliases_.at(search_module);
+    if (declarations_->module_aliases.count(search_module)) {
+        const auto& aliases = declarations_->module_aliases.at(search_module);
         size_t pos = name.find("::");
         if (pos != std::string::npos) {
             std::string prefix = name.substr(0, pos);
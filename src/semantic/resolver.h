@@ -2,11 +2,17 @@
 #define FLUX_RESOLVER_H
 
 #include "ast/ast.h"
+#include "module_declarations.h"
 #include "scope.h"
 #include "type.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <optional>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -15,33 +21,48 @@
 namespace flux::semantic {
 
 struct FunctionInstantiation {
-    std::string name;
-    std::vector<::flux::semantic::FluxType> args;
-
-    bool operator==(const FunctionInstantiation& other) const {
-        if (name != other.name || args.size() != other.args.size())
-            return false;
-        for (size_t i = 0; i < args.size(); ++i) {
-            if (args[i] != other.args[i])
-                return false;
-        }
-        return true;
-    }
+    Name name;
+    std::vector<::flux::semantic::TypeId> args;
+
+    bool operator==(const FunctionInstantiation& other) const = default;
 };
 
-struct TypeInstantiation {
-    std::string name;
-    std::vector<::flux::semantic::FluxType> args;
+// Hash of an instantiation's name and type arguments. Both are interned, so this reads ids
+// and addresses and never compares text.
+std::size_t hash_instantiation(Name name, const std::vector<TypeId>& args);
 
-    bool operator==(const TypeInstantiation& other) const {
-        if (name != other.name || args.size() != other.args.size())
-            return false;
-        for (size_t i = 0; i < args.size(); ++i) {
-            if (args[i] != other.args[i])
+// Distinct instantiations in the order they were first recorded. The order is the
+// monomorphization worklist; the hash index makes recording a repeat O(1) rather than a
+// scan of every earlier instantiation.
+template <typename Instantiation> class InstantiationSet {
+  public:
+    // Adds `inst` unless an equal one is already present. Returns whether it was added.
+    bool insert(Instantiation inst) {
+        const std::size_t hash = hash_instantiation(inst.name, inst.args);
+        auto [begin, end] = index_.equal_range(hash);
+        for (auto it = begin; it != end; ++it) {
+            if (items_[it->second] == inst)
                 return false;
         }
+        index_.emplace(hash, items_.size());
+        items_.push_back(std::move(inst));
         return true;
     }
+
+    const std::vector<Instantiation>& items() const {
+        return items_;
+    }
+    std::size_t size() const {
+        return items_.size();
+    }
+    const Instantiation& operator[](std::size_t i) const {
+        return items_[i];
+    }
+
+  private:
+    std::vector<Instantiation> items_;
+    // Hash of each instantiation to its position in items_.
+    std::unordered_multimap<std::size_t, std::size_t> index_;
 };
 
 struct TypeParamBound {
@@ -49,10 +70,68 @@ struct TypeParamBound {
     std::vector<std::string> bounds;
 };
 
+// What declare_module() collects from every module, keyed by (qualified) name. Function
+// bodies only read it.
+struct Declarations {
+    std::unordered_map<std::string, std::vector<std::string>> enum_variants;
+    std::unordered_map<std::string, std::vector<FieldInfo>> struct_fields;
+    std::unordered_map<std::string, std::vector<FieldInfo>> class_fields;
+    std::unordered_map<std::string, const ast::TypeExpr*> type_aliases;
+    // module_name -> (alias -> full_path)
+    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> module_aliases;
+    std::unordered_map<std::string, std::vector<TraitMethodSig>> trait_methods;
+    std::unordered_map<std::string, std::unordered_set<std::string>> trait_impls;
+    std::unordered_map<std::string, std::vector<std::string>> function_type_params;
+    std::unordered_map<std::string, std::vector<std::string>> type_type_params;
+    std::unordered_map<std::string, std::vector<std::string>> trait_type_params;
+    std::unordered_map<std::string, std::vector<std::string>> trait_associated_types;
+    std::map<std::pair<std::string, std::string>,
+             std::unordered_map<std::string, const ast::TypeExpr*>>
+        impl_associated_types;
+    std::unordered_map<std::string, const ast::FunctionDecl*> function_decls;
+};
+
+// One of the tables of Declarations keyed by name, and the log of it in a record.
+template <typename Value> struct DeclarationTable {
+    std::unordered_map<std::string, Value> Declarations::*entries;
+    ModuleDeclarations::Log<Value> ModuleDeclarations::*log;
+};
+
 struct Resolver {
   public:
     Resolver() = default;
     void resolve(const std::vector<ast::Module*>& modules);
+    // Resolves function bodies on this many threads once every module is declared; 0 uses
+    // one per hardware thread. The result, and the first error reported, do not depend on it.
+    void set_jobs(unsigned jobs) {
+        jobs_ = jobs;
+    }
+    // Keeps a record of what declaring each module adds (see declarations()), which a later
+    // Resolver can replay with reuse_declarations().
+    void set_record_declarations(bool record) {
+        record_declarations_ = record;
+    }
+    // Has resolve() declare `module` by replaying `record`, kept from an earlier resolver's
+    // declarations() of the same module, instead of walking it. That skips the checks
+    // declare_module() makes, so it is only done if the modules declared before it left
+    // the state they did then (ModuleDeclarations::context); otherwise, or if `record` is
+    // damaged, `module` is declared as usual.
+    void reuse_declarations(const ast::Module& module, std::string record);
+    // The record (as serialize() writes it) of what declaring `module` added, or nullptr
+    // unless resolve() declared it while recording. One it replayed has a record already.
+    const std::string* declarations(const ast::Module& module) const;
+    // Whether resolve() replayed `module` rather than declared it, and how many it replayed.
+    bool replayed(const ast::Module& module) const {
+        return replayed_.contains(&module);
+    }
+    std::size_t replayed_modules() const {
+        return replayed_.size();
+    }
+    // Has resolve() declare every module but resolve the bodies of `modules` only, for a
+    // build that reuses what it compiled from the others last time.
+    void restrict_bodies(std::unordered_set<const ast::Module*> modules) {
+        body_modules_ = std::move(modules);
+    }
     void resolve(const ast::Module& module);
     void initialize_intrinsics();
 
@@ -63,57 +142,68 @@ struct Resolver {
 
     // Structure
     void declare_module(const ast::Module& module);
+    // declare_module(), or a replay of the record reuse_declarations() gave for `module`.
+    void declare_or_replay(const ast::Module& module);
+    void replay_declarations(ModuleDeclarations record);
     void resolve_module_bodies(const ast::Module& module);
     void resolve_module(const ast::Module& module);
     void resolve_function(const ast::FunctionDecl& fn, const std::string& name = "");
     bool resolve_block(const ast::Block& block);
     bool resolve_statement(const ast::Stmt& stmt);
-    void resolve_pattern(const ast::Pattern& pattern, const FluxType& subject_type);
+    void resolve_pattern(const ast::Pattern& pattern, TypeId subject_type);
     void resolve_expression(const ast::Expr& expr);
-    bool is_pattern_exhaustive(const FluxType& type,
+    bool is_pattern_exhaustive(TypeId type,
                                const std::vector<const ast::Pattern*>& patterns) const;
 
-    // Initialization state management
-    std::unordered_map<Symbol*, bool> save_initialization_state();
-    void restore_initialization_state(const std::unordered_map<Symbol*, bool>& state);
-    void intersect_initialization_state(const std::unordered_map<Symbol*, bool>& other_state);
+    // Initialization, move and borrow state of the variables in scope, at branches
+    FlowState::Snapshot save_initialization_state() const;
+    void restore_initialization_state(const FlowState::Snapshot& state);
+    void intersect_initialization_state(const FlowState::Snapshot& other_state);
 
     // Monomorphization accessors
     const std::vector<FunctionInstantiation>& function_instantiations() const {
-        return function_instantiations_;
+        return function_instantiations_.items();
     }
     const std::vector<TypeInstantiation>& type_instantiations() const {
-        return type_instantiations_;
+        return type_instantiations_.items();
     }
     const std::unordered_map<std::string, const ast::FunctionDecl*>& function_decls() const {
-        return function_decls_;
+        return declarations_->function_decls;
+    }
+
+    // Scopes entered so far (every scope is kept until the Resolver goes away), and the
+    // symbols declared in them.
+    std::size_t scope_count() const {
+        return all_scopes_.size();
+    }
+    std::size_t symbol_count() const {
+        std::size_t symbols = 0;
+        for (const auto& scope : all_scopes_)
+            symbols += scope->get_symbols().size();
+        return symbols;
     }
     const std::unordered_map<std::string, std::vector<std::string>>& function_type_params() const {
-        return function_type_params_;
+        return declarations_->function_type_params;
     }
 
     bool is_enum_variant(const std::string& name) const;
     std::string find_enum_for_variant(const std::string& variant_name) const;
 
     // expressions
-    ::flux::semantic::FluxType type_of(const ast::Expr& expr);
-    ::flux::semantic::FluxType type_from_name(const std::string& name);
+    ::flux::semantic::TypeId type_of(const ast::Expr& expr);
+    ::flux::semantic::TypeId type_from_name(const std::string& name);
+    // The semantic type of a parsed type; a null (omitted) type is Unknown.
+    ::flux::semantic::TypeId resolve_type(const ast::TypeExpr* type);
+    // A variable's type, or a function's return type.
+    ::flux::semantic::TypeId symbol_type(const Symbol& sym);
+    // A function symbol's type, leaving out its first `skip` parameters (a method's self).
+    ::flux::semantic::TypeId function_type(const Symbol& sym, size_t skip = 0);
     std::string resolve_name(const std::string& name, const std::string& module_name = "") const;
 
   public:
-    struct TraitMethodSig {
-        std::string name;
-        std::string self_type;
-        std::vector<std::string> param_types;
-        std::string return_type;
-        bool has_default = false;
-        ast::Visibility visibility = ast::Visibility::None;
-        std::string module_name;
-    };
-
     static std::vector<TypeParamBound>
     parse_type_param_bounds(const std::vector<std::string>& type_params);
-    static std::vector<TypeParamBound> parse_where_clause(const std::string& where_clause);
+    static std::vector<TypeParamBound> where_clause_bounds(const ast::WhereClause& where_clause);
     bool type_implements_trait(const std::string& type_name, const std::string& trait_name) const;
 
     bool
@@ -127,30 +217,57 @@ struct Resolver {
     bool is_float_name(const std::string& name) const;
     int numeric_width(const std::string& name) const;
     std::string promote_integer_name(const std::string& a, const std::string& b) const;
-    bool are_types_compatible(const ::flux::semantic::FluxType& target,
-                              const ::flux::semantic::FluxType& source) const;
+    bool are_types_compatible(::flux::semantic::TypeId target,
+                              ::flux::semantic::TypeId source) const;
 
   public:
-    static ::flux::semantic::FluxType unknown_type() {
-        return {TypeKind::Unknown, "Unknown"};
+    static ::flux::semantic::TypeId unknown_type() {
+        static const ::flux::semantic::TypeId type(TypeKind::Unknown, "Unknown");
+        return type;
     }
 
-    ::flux::semantic::FluxType type_from_name_internal(const std::string& name,
-                                                       std::unordered_set<std::string>& seen);
+    ::flux::semantic::TypeId type_from_name_internal(const std::string& name,
+                                                     std::unordered_set<std::string>& seen);
+    ::flux::semantic::TypeId resolve_type_internal(const ast::TypeExpr& type,
+                                                   std::unordered_set<std::string>& seen);
     void record_function_instantiation(const std::string& name,
-                                       const std::vector<::flux::semantic::FluxType>& args);
+                                       const std::vector<::flux::semantic::TypeId>& args);
     void record_type_instantiation(const std::string& name,
-                                   const std::vector<::flux::semantic::FluxType>& args);
+                                   const std::vector<::flux::semantic::TypeId>& args);
     std::vector<std::string> get_bounds_for_type(const std::string& type_name);
 
+    // A function or method body to resolve, with the context resolve_module_bodies() would
+    // have set for it.
+    struct BodyTask {
+        const ast::FunctionDecl* fn;
+        std::string name;
+        std::string module_name;
+        std::string type_name;
+    };
+    void collect_bodies(const ast::Module& module, std::vector<BodyTask>& bodies);
+    void resolve_bodies(const std::vector<BodyTask>& bodies);
+    void resolve_bodies_parallel(const std::vector<BodyTask>& bodies);
+    void resolve_body(const BodyTask& body);
+    // A resolver for one resolve_bodies_parallel() thread: it reads this one's declaration
+    // tables and global scopes, and has its own scopes, FlowState and instantiations.
+    std::unique_ptr<Resolver> make_body_worker() const;
+
+    unsigned jobs_ = 1;
+
   public:
-    std::vector<std::unique_ptr<Scope>> all_scopes_;
+    // Shared, so that the scopes of a body worker (see make_body_worker()) can be kept once
+    // the worker is gone.
+    std::vector<std::shared_ptr<Scope>> all_scopes_;
     Scope* current_scope_ = nullptr;
+    FlowState flow_;
+    // The state declaration left: every function body, and every instantiation of one,
+    // starts from it.
+    FlowState::Snapshot declared_flow_;
     const Scope& current_scope() const {
         return *current_scope_;
     }
 
-    ::flux::semantic::FluxType current_function_return_type_{};
+    ::flux::semantic::TypeId current_function_return_type_{};
     std::string current_function_name_;
     std::string current_type_name_;
     std::string current_module_name_;
@@ -160,40 +277,39 @@ struct Resolver {
     bool is_in_async_context_ = false;
 
     // For diagnostics
-    struct SourceLoc {
-        uint32_t line = 0;
-        uint32_t column = 0;
-    } last_loc_;
+    SourceLoc last_loc_;
 
-    std::unordered_map<std::string, std::vector<std::string>> enum_variants_;
+    // The declaration tables. declare_module() fills them in through declaring(); everything
+    // else reads them through declarations_, which is const. A body worker shares the
+    // tables of the resolver it was made from and cannot write to them.
+    std::shared_ptr<Declarations> declaring_ = std::make_shared<Declarations>();
+    std::shared_ptr<const Declarations> declarations_ = declaring_;
+    Declarations& declaring();
 
-    struct FieldInfo {
-        std::string name;
-        std::string type;
-        ast::Visibility visibility;
-    };
+    // Sets `key` in one of declaring()'s tables, and logs it to the record being made, if any.
+    template <typename Value>
+    void declare_entry(const DeclarationTable<Value>& table, const std::string& key,
+                       std::type_identity_t<Value> value);
+    // scope.declare(symbol), logged like declare_entry().
+    bool declare_symbol(Scope& scope, const Symbol& symbol);
 
-    std::unordered_map<std::string, std::vector<FieldInfo>> struct_fields_;
-    std::unordered_map<std::string, std::vector<FieldInfo>> class_fields_;
-    std::unordered_map<std::string, std::string> type_aliases_;
-    // module_name -> (alias -> full_path)
-    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> module_aliases_;
-    std::unordered_map<std::string, std::vector<TraitMethodSig>> trait_methods_;
-    std::unordered_map<std::string, std::unordered_set<std::string>> trait_impls_;
-    std::unordered_map<std::string, std::vector<std::string>> function_type_params_;
-    std::unordered_map<std::string, std::vector<std::string>> type_type_params_;
-    std::unordered_map<std::string, std::vector<std::string>> trait_type_params_;
-    std::unordered_map<std::string, std::vector<std::string>> trait_associated_types_;
-    std::map<std::pair<std::string, std::string>, std::unordered_map<std::string, std::string>>
-        impl_associated_types_;
-
-    std::vector<FunctionInstantiation> function_instantiations_;
-    std::vector<TypeInstantiation> type_instantiations_;
-    std::unordered_map<std::string, const ast::FunctionDecl*> function_decls_;
-    std::unordered_map<std::string, ::flux::semantic::FluxType> substitution_map_;
+    bool record_declarations_ = false;
+    // The record declare_module() is adding to, while it runs for a recorded module.
+    ModuleDeclarations* recording_ = nullptr;
+    std::unordered_map<const ast::Module*, std::string> records_;
+    std::unordered_map<const ast::Module*, std::string> reusable_;
+    // The context of the next module to declare (ModuleDeclarations::context), or nullopt
+    // once a record could not be serialized.
+    std::optional<std::uint64_t> declared_context_ = 0;
+    std::unordered_set<const ast::Module*> replayed_;
+    std::optional<std::unordered_set<const ast::Module*>> body_modules_;
+
+    InstantiationSet<FunctionInstantiation> function_instantiations_;
+    InstantiationSet<TypeInstantiation> type_instantiations_;
+    std::unordered_map<std::string, ::flux::semantic::TypeId> substitution_map_;
 
     static bool is_copy_type(const std::string& type_name);
-    std::string stringify_type(const ::flux::semantic::FluxType& type) const;
+    std::string stringify_type(::flux::semantic::TypeId type) const;
     void monomorphize_recursive();
 };
 } // namespace flux::semantic
@@ -1,62 +1,117 @@
 #ifndef FLUX_SCOPE_H
 #define FLUX_SCOPE_H
 
+#include "flow_state.h"
 #include "symbol.h"
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace flux::semantic {
 
 class Scope {
   public:
-    explicit Scope(Scope* parent = nullptr, uint32_t depth = 0) : parent_(parent), depth_(depth) {}
+    explicit Scope(Scope* parent = nullptr, uint32_t depth = 0, FlowState* flow = nullptr)
+        : parent_(parent), depth_(depth), flow_(flow), flow_mark_(flow ? flow->size() : 0) {}
     uint32_t depth() const {
         return depth_;
     }
 
+    // Variables are numbered in `flow`, which then holds their initialized and moved state.
     bool declare(Symbol symbol) {
+        if (frozen_)
+            throw std::logic_error("declaration of '" + symbol.name.str() +
+                                   "' in a scope shared between threads");
         symbol.scope_depth = depth_;
-        auto [_, inserted] = symbols_.emplace(symbol.name, symbol);
+        auto [it, inserted] = symbols_.emplace(symbol.name, std::move(symbol));
+        Symbol& declared = it->second;
+        if (inserted && flow_ && declared.kind == SymbolKind::Variable)
+            declared.local = flow_->add(declared.is_initialized, declared.is_moved);
         return inserted;
     }
 
-    const Symbol* lookup(const std::string& name) const {
-        auto it = symbols_.find(name);
-        if (it != symbols_.end())
-            return &it->second;
-
-        if (parent_)
-            return parent_->lookup(name);
-
+    // Symbols are keyed by interned Name, so each level of the scope chain costs one
+    // integer hash rather than a string hash and compare.
+    const Symbol* lookup(Name name) const {
+        for (const Scope* scope = this; scope; scope = scope->parent_) {
+            auto it = scope->symbols_.find(name);
+            if (it != scope->symbols_.end())
+                return &it->second;
+        }
         return nullptr;
     }
 
-    Symbol* lookup_mut(const std::string& name) {
-        auto it = symbols_.find(name);
-        if (it != symbols_.end())
-            return &it->second;
+    Symbol* lookup_mut(Name name) {
+        for (Scope* scope = this; scope; scope = scope->parent_) {
+            auto it = scope->symbols_.find(name);
+            if (it != scope->symbols_.end())
+                return &it->second;
+        }
+        return nullptr;
+    }
 
-        if (parent_)
-            return parent_->lookup_mut(name);
+    // Lookups by composed text (qualified names, stripped generics) go through these so
+    // that strings which were never declared are not added to the interner.
+    const Symbol* lookup(std::string_view name) const {
+        const Name interned = Name::if_interned(name);
+        return interned.empty() ? nullptr : lookup(interned);
+    }
+    const Symbol* lookup(const std::string& name) const {
+        return lookup(std::string_view(name));
+    }
+    const Symbol* lookup(const char* name) const {
+        return lookup(std::string_view(name));
+    }
 
-        return nullptr;
+    Symbol* lookup_mut(std::string_view name) {
+        const Name interned = Name::if_interned(name);
+        return interned.empty() ? nullptr : lookup_mut(interned);
+    }
+    Symbol* lookup_mut(const std::string& name) {
+        return lookup_mut(std::string_view(name));
+    }
+    Symbol* lookup_mut(const char* name) {
+        return lookup_mut(std::string_view(name));
     }
 
     Scope* parent() const {
         return parent_;
     }
 
-    const std::unordered_map<std::string, Symbol>& get_symbols() const {
+    // The number of variables in the FlowState when this scope was entered; those declared
+    // in it are numbered from here.
+    uint32_t flow_mark() const {
+        return flow_mark_;
+    }
+
+    // A frozen scope is read by several resolvers at once (the global scopes, during
+    // parallel body resolution), so declare() throws instead of inserting.
+    void freeze(bool frozen) {
+        frozen_ = frozen;
+    }
+
+    // Forgets the FlowState, for a scope that outlives the resolver that owns it. No more
+    // variables can be declared in it.
+    void release_flow() {
+        flow_ = nullptr;
+        frozen_ = true;
+    }
+
+    const std::unordered_map<Name, Symbol>& get_symbols() const {
         return symbols_;
     }
-    std::unordered_map<std::string, Symbol>& get_symbols_mut() {
+    std::unordered_map<Name, Symbol>& get_symbols_mut() {
         return symbols_;
     }
 
   private:
     Scope* parent_;
     uint32_t depth_;
-    std::unordered_map<std::string, Symbol> symbols_;
+    FlowState* flow_;
+    uint32_t flow_mark_;
+    bool frozen_ = false;
+    std::unordered_map<Name, Symbol> symbols_;
 };
 
 } // namespace flux::semantic
@@ -2,6 +2,9 @@
 #define FLUX_SYMBOL_H
 
 #include "ast/ast.h"
+#include "type.h"
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -12,15 +15,16 @@ enum class SymbolKind {
 };
 
 struct Symbol {
-    std::string name;
+    Name name;
     SymbolKind kind;
     bool is_mutable = false;
     bool is_const = false;
+    // For a variable, only the state it is declared in: from then on the resolver's
+    // FlowState tracks it, under `local`, along with its borrows. Other symbols keep the
+    // state they are declared with.
     bool is_moved = false;
     bool is_initialized = false;
-    uint32_t borrow_count = 0;
-    bool is_mutably_borrowed = false;
-    std::string borrowed_symbol_name;
+    Name borrowed_symbol_name;
     uint32_t scope_depth = 0;
     ast::Visibility visibility = ast::Visibility::None;
     bool is_async = false;
@@ -33,14 +37,25 @@ struct Symbol {
     // Only meaningful for functions:
     std::vector<std::string> param_types;
 
+    // The same types as parsed, for functions declared in source. They are resolved where
+    // the function is referenced, without spelling them out and parsing them again.
+    const ast::TypeExpr* type_expr = nullptr;
+    std::vector<const ast::TypeExpr*> param_type_exprs;
+
+    // For local variables: the type resolved when the variable was declared.
+    std::optional<TypeId> resolved_type;
+
+    // For variables: the number Scope::declare gave it in the FlowState.
+    static constexpr uint32_t kNoLocal = UINT32_MAX;
+    uint32_t local = kNoLocal;
+
     Symbol() = default;
-    Symbol(std::string name, SymbolKind kind, bool mut = false, bool is_const = false,
+    Symbol(Name name, SymbolKind kind, bool mut = false, bool is_const = false,
            bool moved = false, bool initialized = false,
            ast::Visibility vis = ast::Visibility::None, std::string mod = "", std::string t = "",
            std::vector<std::string> params = {}, bool async_fn = false)
-        : name(std::move(name)), kind(kind), is_mutable(mut), is_const(is_const), is_moved(moved),
-          is_initialized(initialized), borrow_count(0), is_mutably_borrowed(false),
-          borrowed_symbol_name(""), scope_depth(0), visibility(vis), is_async(async_fn),
+        : name(name), kind(kind), is_mutable(mut), is_const(is_const), is_moved(moved),
+          is_initialized(initialized), scope_depth(0), visibility(vis), is_async(async_fn),
           module_name(std::move(mod)), type(std::move(t)), param_types(std::move(params)) {}
 };
 } // namespace flux::semantic
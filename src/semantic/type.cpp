@@ -0,0 +1,120 @@
+#include "type.h"
+
+namespace flux::semantic {
+
+const FluxType detail::unknown_node{};
+
+namespace {
+void combine(std::size_t& seed, std::size_t value) {
+    seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
+void combine(std::size_t& seed, const std::vector<TypeId>& types) {
+    combine(seed, types.size());
+    for (TypeId type : types)
+        combine(seed, std::hash<TypeId>{}(type));
+}
+
+// Children are interned, so they hash by address.
+std::size_t hash_of(const FluxType& type) {
+    std::size_t seed = std::hash<std::string>{}(type.name);
+    combine(seed, static_cast<std::size_t>(type.kind));
+    combine(seed, type.is_mut_ref);
+    combine(seed, type.param_types);
+    combine(seed, std::hash<TypeId>{}(type.return_type));
+    combine(seed, type.generic_args);
+    return seed;
+}
+
+bool same_parts(const FluxType& a, const FluxType& b) {
+    return a.kind == b.kind && a.is_mut_ref == b.is_mut_ref && a.return_type == b.return_type &&
+           a.param_types == b.param_types && a.generic_args == b.generic_args &&
+           a.name == b.name;
+}
+} // namespace
+
+// Never destroyed, so TypeIds held by other static objects stay readable during exit.
+TypeContext& TypeContext::global() {
+    static TypeContext* context = new TypeContext();
+    return *context;
+}
+
+TypeContext::TypeContext() {
+    resident_.push_back({TypeKind::Void, "Void", false, {}, TypeId(), {}});
+    resident_.push_back({TypeKind::Never, "Never", false, {}, TypeId(), {}});
+    resident_.push_back({TypeKind::Unknown, "Unknown", false, {}, TypeId(), {}});
+    index_resident();
+}
+
+void TypeContext::index_resident() {
+    const std::size_t unknown_hash = hash_of(detail::unknown_node);
+    shards_[unknown_hash % kShards].index.emplace(unknown_hash, &detail::unknown_node);
+    for (const FluxType& type : resident_) {
+        const std::size_t hash = hash_of(type);
+        shards_[hash % kShards].index.emplace(hash, &type);
+    }
+}
+
+void TypeContext::clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.index.clear();
+        shard.nodes.clear();
+    }
+    index_resident();
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+const FluxType* TypeContext::find(const Index& index, std::size_t hash, const FluxType& type) {
+    auto [begin, end] = index.equal_range(hash);
+    for (auto it = begin; it != end; ++it) {
+        if (same_parts(*it->second, type))
+            return it->second;
+    }
+    return nullptr;
+}
+
+TypeId TypeContext::get(TypeKind kind, std::string name, bool is_mut_ref,
+                        std::vector<TypeId> param_types, TypeId return_type,
+                        std::vector<TypeId> generic_args) {
+    FluxType key{kind, std::move(name), is_mut_ref, std::move(param_types), return_type,
+                 std::move(generic_args)};
+    const std::size_t hash = hash_of(key);
+
+    // The types a thread has already built, found without taking a shard lock. There is one
+    // TypeContext, and its nodes outlive every thread until clear(), which bumps the
+    // generation so that every thread starts over.
+    thread_local Index seen;
+    thread_local std::uint64_t seen_generation = 0;
+    const std::uint64_t generation = generation_.load(std::memory_order_acquire);
+    if (seen_generation != generation) {
+        seen.clear();
+        seen_generation = generation;
+    }
+    if (const FluxType* node = find(seen, hash, key))
+        return TypeId(node);
+
+    Shard& shard = shards_[hash % kShards];
+    const FluxType* node = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        node = find(shard.index, hash, key);
+        if (!node) {
+            node = &shard.nodes.emplace_back(std::move(key));
+            shard.index.emplace(hash, node);
+        }
+    }
+    seen.emplace(hash, node);
+    return TypeId(node);
+}
+
+std::size_t TypeContext::size() const {
+    std::size_t count = 0;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        count += shard.index.size();
+    }
+    return count;
+}
+
+} // namespace flux::semantic
@@ -2,8 +2,15 @@
 #ifndef FLUX_TYPE_H
 #define FLUX_TYPE_H
 
-#include <memory>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace flux::semantic {
@@ -29,83 +36,141 @@ enum class TypeKind {
     Generic,
 };
 
-struct FluxType {
-    // For Option/Result generics
-    std::vector<FluxType> generic_args;
-
-    FluxType(TypeKind k = TypeKind::Unknown, std::string n = "<unknown>", bool is_mut = false,
-             std::vector<FluxType> params = {}, std::unique_ptr<FluxType> ret = nullptr,
-             std::vector<FluxType> generics = {})
-        : generic_args(std::move(generics)), kind(k), name(std::move(n)), is_mut_ref(is_mut),
-          param_types(std::move(params)), return_type(std::move(ret)) {}
-    FluxType(const FluxType& other)
-        : generic_args(other.generic_args), kind(other.kind), name(other.name),
-          is_mut_ref(other.is_mut_ref), param_types(other.param_types),
-          return_type(other.return_type ? std::make_unique<FluxType>(*other.return_type)
-                                        : nullptr) {}
-
-    FluxType& operator=(const FluxType& other) {
-        if (this != &other) {
-            kind = other.kind;
-            name = other.name;
-            is_mut_ref = other.is_mut_ref;
-            param_types = other.param_types;
-            return_type =
-                other.return_type ? std::make_unique<FluxType>(*other.return_type) : nullptr;
-            generic_args = other.generic_args;
-        }
-        return *this;
+struct FluxType;
+
+// A handle to an interned type (see TypeContext). Two TypeIds are equal exactly when they
+// denote the same type, so comparing, hashing and copying them are O(1). The default
+// TypeId is the unknown type, `<unknown>`.
+class TypeId {
+  public:
+    TypeId();
+    // Interns the type with these parts, like Name interns its text.
+    TypeId(TypeKind kind, std::string name, bool is_mut_ref = false,
+           std::vector<TypeId> param_types = {}, TypeId return_type = TypeId(),
+           std::vector<TypeId> generic_args = {});
+
+    const FluxType* get() const {
+        return type_;
+    }
+    const FluxType* operator->() const {
+        return type_;
+    }
+    const FluxType& operator*() const {
+        return *type_;
+    }
+
+    friend bool operator==(TypeId a, TypeId b) {
+        return a.type_ == b.type_;
     }
 
-    ~FluxType() = default;
+  private:
+    friend class TypeContext;
+    explicit TypeId(const FluxType* type) : type_(type) {}
 
-    TypeKind kind;
-    std::string name; // e.g. "Int32", "Float64", "Bool", "Color", etc.
+    const FluxType* type_;
+};
+
+// One distinct type. Only TypeContext creates them, and each exists once, so its parts are
+// never copied: its children are TypeIds as well.
+struct FluxType {
+    TypeKind kind = TypeKind::Unknown;
+    std::string name = "<unknown>"; // e.g. "Int32", "Float64", "Bool", "Color", etc.
     // For TypeKind::Ref, indicates if this is a mutable reference (&mut T)
     bool is_mut_ref = false;
 
     // For TypeKind::Function
-    std::vector<FluxType> param_types;
-    std::unique_ptr<FluxType> return_type;
-
-    bool operator==(const FluxType& other) const {
-        if (kind != other.kind || name != other.name || is_mut_ref != other.is_mut_ref)
-            return false;
-        if (generic_args.size() != other.generic_args.size())
-            return false;
-        for (size_t i = 0; i < generic_args.size(); ++i) {
-            if (generic_args[i] != other.generic_args[i])
-                return false;
-        }
-        if (kind == TypeKind::Function) {
-            if (param_types.size() != other.param_types.size())
-                return false;
-            for (size_t i = 0; i < param_types.size(); ++i) {
-                if (param_types[i] != other.param_types[i])
-                    return false;
-            }
-            if (return_type && other.return_type)
-                return *return_type == *other.return_type;
-            return !return_type && !other.return_type;
-        }
-        return true;
-    }
+    std::vector<TypeId> param_types;
+    TypeId return_type;
 
-    bool operator!=(const FluxType& other) const {
-        return !(*this == other);
-    }
+    // For Option/Result generics, tuple elements and generic instances
+    std::vector<TypeId> generic_args;
+};
+
+// Process-wide table of the distinct semantic types. A type is hashed and stored the first
+// time it is built; later builds of an equal type return the same node, which stays valid
+// until clear(). Since every child is interned first, equality of nodes only compares the
+// children's pointers, never whole subtrees.
+//
+// Thread-safe: interning locks one of several shards chosen by hash, unless the calling
+// thread has built the same type before, and reading a node needs no lock, since nodes
+// never change or move once they exist.
+class TypeContext {
+  public:
+    static TypeContext& global();
+
+    TypeContext(const TypeContext&) = delete;
+    TypeContext& operator=(const TypeContext&) = delete;
+
+    TypeId get(TypeKind kind, std::string name, bool is_mut_ref = false,
+               std::vector<TypeId> param_types = {}, TypeId return_type = TypeId(),
+               std::vector<TypeId> generic_args = {});
+
+    // Number of distinct types, including the unknown type.
+    std::size_t size() const;
+
+    // Forgets every type but the built-in ones (see resident_), along with what each thread
+    // remembers of them. This invalidates every other TypeId in the process: like
+    // Interner::clear(), only call it while no such TypeId is alive and no other thread
+    // builds types.
+    void clear();
+
+  private:
+    static constexpr unsigned kShards = 16;
+
+    // Nodes by hash. Equal hashes are rare, so a lookup compares about one node.
+    using Index = std::unordered_multimap<std::size_t, const FluxType*>;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::deque<FluxType> nodes;
+        Index index;
+    };
+
+    TypeContext();
+
+    static const FluxType* find(const Index& index, std::size_t hash, const FluxType& type);
+    void index_resident();
+
+    std::array<Shard, kShards> shards_;
+    // Types that survive clear(): the unknown type, and those the accessors below (and
+    // Resolver::unknown_type()) keep in function statics.
+    std::deque<FluxType> resident_;
+    // Bumped by clear(), so that each thread drops the nodes it remembers in get().
+    std::atomic<std::uint64_t> generation_{0};
 };
 
-inline FluxType unknown() {
-    return FluxType(TypeKind::Unknown, "<unknown>");
+namespace detail {
+// The node of the default TypeId; TypeContext::global() hands it out for `<unknown>`.
+extern const FluxType unknown_node;
+} // namespace detail
+
+inline TypeId::TypeId() : type_(&detail::unknown_node) {}
+
+inline TypeId::TypeId(TypeKind kind, std::string name, bool is_mut_ref,
+                      std::vector<TypeId> param_types, TypeId return_type,
+                      std::vector<TypeId> generic_args)
+    : TypeId(TypeContext::global().get(kind, std::move(name), is_mut_ref,
+                                       std::move(param_types), return_type,
+                                       std::move(generic_args))) {}
+
+inline TypeId unknown() {
+    return TypeId();
 }
-inline FluxType void_type() {
-    return FluxType(TypeKind::Void, "Void");
+inline TypeId void_type() {
+    static const TypeId type(TypeKind::Void, "Void");
+    return type;
 }
-inline FluxType never_type() {
-    return FluxType(TypeKind::Never, "Never");
+inline TypeId never_type() {
+    static const TypeId type(TypeKind::Never, "Never");
+    return type;
 }
 
 } // namespace flux::semantic
 
+template <> struct std::hash<flux::semantic::TypeId> {
+    std::size_t operator()(flux::semantic::TypeId type) const noexcept {
+        return std::hash<const void*>{}(type.get());
+    }
+};
+
 #endif // FLUX_TYPE_H
@@ -0,0 +1,38 @@
+#ifndef FLUX_HASH_H
+#define FLUX_HASH_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace flux {
+// A fast, non-cryptographic 64-bit hash of `bytes`, for content fingerprints. It reads
+// eight bytes per step, so a source file hashes in a small fraction of the time it takes
+// to lex. The result does not depend on the process or the build, only on the bytes (and
+// on the host's byte order), so it can be stored alongside cached artifacts.
+inline std::uint64_t hash_bytes(std::string_view bytes) {
+    constexpr std::uint64_t kMultiplier = 0x9E3779B97F4A7C15ULL;
+    auto mix = [](std::uint64_t h) {
+        h ^= h >> 32;
+        h *= 0xD6E8FEB86659FD93ULL;
+        return h ^ (h >> 32);
+    };
+
+    std::uint64_t h = 0x243F6A8885A308D3ULL ^ (bytes.size() * kMultiplier);
+    const char* p = bytes.data();
+    std::size_t n = bytes.size();
+    for (; n >= 8; p += 8, n -= 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = std::rotl((h ^ mix(word)) * kMultiplier, 31);
+    }
+    std::uint64_t tail = 0;
+    if (n != 0)
+        std::memcpy(&tail, p, n);
+    return mix((h ^ mix(tail)) * kMultiplier);
+}
+} // namespace flux
+
+#endif // FLUX_HASH_H
@@ -0,0 +1,41 @@
+#ifndef FLUX_JSON_H
+#define FLUX_JSON_H
+
+#include <cstdio>
+#include <ostream>
+#include <string_view>
+
+namespace flux {
+// Writes `text` as a quoted JSON string. Bytes outside ASCII are passed through, so UTF-8
+// input stays valid UTF-8.
+inline void write_json_string(std::ostream& out, std::string_view text) {
+    out << '"';
+    for (char c : text) {
+        switch (c) {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        case '\t':
+            out << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escape[8];
+                std::snprintf(escape, sizeof escape, "\\u%04x", c);
+                out << escape;
+            } else {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+}
+} // namespace flux
+
+#endif // FLUX_JSON_H
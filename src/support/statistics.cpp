@@ -0,0 +1,132 @@
+#include "support/statistics.h"
+
+#include "support/json.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+namespace flux {
+Statistics::Timer::Timer(Statistics* stats, std::string name) : stats_(stats) {
+    if (!stats_)
+        return;
+    index_ = stats_->phases_.size();
+    stats_->phases_.push_back({std::move(name), stats_->depth_});
+    ++stats_->depth_;
+    wall_start_ = std::chrono::steady_clock::now();
+    cpu_start_ = process_cpu_seconds();
+}
+
+Statistics::Timer::~Timer() {
+    if (!stats_)
+        return;
+    const double cpu_end = process_cpu_seconds();
+    const auto wall_end = std::chrono::steady_clock::now();
+    Phase& phase = stats_->phases_[index_];
+    phase.wall_seconds = std::chrono::duration<double>(wall_end - wall_start_).count();
+    phase.cpu_seconds = cpu_end - cpu_start_;
+    --stats_->depth_;
+}
+
+void Statistics::set(const std::string& name, std::uint64_t value) {
+    auto it = std::find_if(counters_.begin(), counters_.end(),
+                           [&](const auto& counter) { return counter.first == name; });
+    if (it != counters_.end())
+        it->second = value;
+    else
+        counters_.emplace_back(name, value);
+}
+
+void Statistics::print_phases(std::ostream& out) const {
+    out << "===== Time per phase =====\n";
+    out << "  Wall (ms)    CPU (ms)  Phase\n";
+    char line[64];
+    for (const Phase& phase : phases_) {
+        std::snprintf(line, sizeof line, "%11.3f %11.3f  ", phase.wall_seconds * 1e3,
+                      phase.cpu_seconds * 1e3);
+        out << line << std::string(2 * phase.depth, ' ') << phase.name << '\n';
+    }
+}
+
+void Statistics::print_counters(std::ostream& out) const {
+    out << "===== Statistics =====\n";
+    char line[32];
+    for (const auto& [name, value] : counters_) {
+        std::snprintf(line, sizeof line, "%14llu  ", static_cast<unsigned long long>(value));
+        out << line << name << '\n';
+    }
+}
+
+void Statistics::print_json(std::ostream& out, bool phases, bool counters) const {
+    out << '{';
+    if (phases) {
+        out << "\"phases\":[";
+        char times[96];
+        for (std::size_t i = 0; i < phases_.size(); ++i) {
+            const Phase& phase = phases_[i];
+            out << (i ? ",{\"name\":" : "{\"name\":");
+            write_json_string(out, phase.name);
+            std::snprintf(times, sizeof times, ",\"depth\":%u,\"wall_ms\":%.3f,\"cpu_ms\":%.3f}",
+                          phase.depth, phase.wall_seconds * 1e3, phase.cpu_seconds * 1e3);
+            out << times;
+        }
+        out << ']';
+    }
+    if (counters) {
+        out << (phases ? ",\"counters\":{" : "\"counters\":{");
+        for (std::size_t i = 0; i < counters_.size(); ++i) {
+            if (i)
+                out << ',';
+            write_json_string(out, counters_[i].first);
+            out << ':' << counters_[i].second;
+        }
+        out << '}';
+    }
+    out << "}\n";
+}
+
+double process_cpu_seconds() {
+#ifdef _WIN32
+    // std::clock() is wall time on Windows.
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0;
+    auto ticks = [](const FILETIME& time) { // 100 ns units
+        return (static_cast<std::uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return static_cast<double>(ticks(kernel) + ticks(user)) * 1e-7;
+#else
+    timespec time{};
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0)
+        return 0;
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+#endif
+}
+
+std::uint64_t peak_rss_bytes() {
+#ifdef _WIN32
+    return 0;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss); // bytes
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#endif
+}
+} // namespace flux
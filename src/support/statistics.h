@@ -0,0 +1,75 @@
+#ifndef FLUX_STATISTICS_H
+#define FLUX_STATISTICS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flux {
+// Phase timings and counters collected over one compilation, for `--time-passes` and
+// `--stats`. Phases are kept in the order they started; a phase started while another is
+// still open is nested under it.
+//
+// Not thread-safe; time phases from the thread that drives the pipeline.
+class Statistics {
+  public:
+    struct Phase {
+        std::string name;
+        unsigned depth = 0; // number of enclosing phases
+        double wall_seconds = 0;
+        double cpu_seconds = 0; // process CPU time, so it includes every thread
+    };
+
+    // Times a phase from construction to destruction. With a null Statistics it does
+    // nothing, so call sites need no check of their own.
+    class Timer {
+      public:
+        Timer(Statistics* stats, std::string name);
+        ~Timer();
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+      private:
+        Statistics* stats_;
+        std::size_t index_ = 0;
+        std::chrono::steady_clock::time_point wall_start_;
+        double cpu_start_ = 0;
+    };
+
+    // Sets a counter. Counters are reported in the order they were first set.
+    void set(const std::string& name, std::uint64_t value);
+
+    const std::vector<Phase>& phases() const {
+        return phases_;
+    }
+    const std::vector<std::pair<std::string, std::uint64_t>>& counters() const {
+        return counters_;
+    }
+
+    // Human-readable tables, one row per phase or counter.
+    void print_phases(std::ostream& out) const;
+    void print_counters(std::ostream& out) const;
+
+    // One JSON object with a "phases" array and/or a "counters" object.
+    void print_json(std::ostream& out, bool phases, bool counters) const;
+
+  private:
+    std::vector<Phase> phases_;
+    std::vector<std::pair<std::string, std::uint64_t>> counters_;
+    unsigned depth_ = 0;
+};
+
+// CPU time, user and system, used so far by every thread of the process, in seconds.
+double process_cpu_seconds();
+
+// The largest resident set the process has had so far, in bytes, or 0 where the platform
+// does not say.
+std::uint64_t peak_rss_bytes();
+} // namespace flux
+
+#endif // FLUX_STATISTICS_H
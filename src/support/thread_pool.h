@@ -0,0 +1,53 @@
+#ifndef FLUX_THREAD_POOL_H
+#define FLUX_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flux {
+// A fixed set of worker threads running tasks in submission order. Tasks may submit more
+// tasks; wait() returns once every task, including those, has finished.
+//
+// Tasks must not throw: catch inside the task and hand the error back to the submitter
+// (for example as a std::exception_ptr).
+class ThreadPool {
+  public:
+    // `threads` == 0 uses one thread per hardware thread.
+    explicit ThreadPool(unsigned threads = 0);
+
+    // Runs the tasks still queued, then joins the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    void wait();
+
+    unsigned size() const {
+        return static_cast<unsigned>(workers_.size());
+    }
+
+    // What `threads` == 0 resolves to: the hardware thread count, at least 1.
+    static unsigned default_threads();
+
+  private:
+    void run();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::condition_variable idle_;
+    std::size_t pending_ = 0; // queued plus running
+    bool stopping_ = false;
+};
+} // namespace flux
+
+#endif // FLUX_THREAD_POOL_H
@@ -0,0 +1,75 @@
+#include "support/trace.h"
+
+#include "support/json.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace flux {
+std::atomic<Tracer*> Tracer::active_{nullptr};
+
+Tracer::Tracer() : origin_(Clock::now()) {
+    threads_.emplace(std::this_thread::get_id(), 0);
+}
+
+std::size_t Tracer::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_.size();
+}
+
+void Tracer::record(std::string_view category, std::string name, Clock::time_point start,
+                    Clock::time_point end) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto thread =
+        threads_.emplace(std::this_thread::get_id(), static_cast<unsigned>(threads_.size())).first;
+    events_.push_back({category, std::move(name), start, end, thread->second});
+}
+
+void Tracer::write(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<const Event*> events;
+    events.reserve(events_.size());
+    for (const Event& event : events_)
+        events.push_back(&event);
+    // Enclosing spans end last but start first, and sort before what they contain.
+    std::stable_sort(events.begin(), events.end(), [](const Event* a, const Event* b) {
+        return a->start != b->start ? a->start < b->start : a->end > b->end;
+    });
+
+    auto microseconds = [&](Clock::time_point time) {
+        return std::chrono::duration<double, std::micro>(time - origin_).count();
+    };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    char fields[128];
+    for (unsigned thread = 0; thread < threads_.size(); ++thread) {
+        if (thread == 0)
+            std::snprintf(fields, sizeof fields, "\"main\"");
+        else
+            std::snprintf(fields, sizeof fields, "\"worker %u\"", thread);
+        out << (thread ? ",\n" : "") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,";
+        out << "\"tid\":" << thread << ",\"args\":{\"name\":" << fields << "}}";
+    }
+    for (const Event* event : events) {
+        out << ",\n{\"ph\":\"X\",\"cat\":";
+        write_json_string(out, event->category);
+        out << ",\"name\":";
+        write_json_string(out, event->name);
+        const double start = microseconds(event->start);
+        std::snprintf(fields, sizeof fields, ",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                      start, microseconds(event->end) - start, event->thread);
+        out << fields;
+    }
+    out << "]}\n";
+}
+
+TraceScope::TraceScope(Tracer* tracer) : tracer_(tracer) {
+    if (tracer_)
+        Tracer::active_.store(tracer_, std::memory_order_relaxed);
+}
+
+TraceScope::~TraceScope() {
+    if (tracer_)
+        Tracer::active_.store(nullptr, std::memory_order_relaxed);
+}
+} // namespace flux
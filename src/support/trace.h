@@ -0,0 +1,120 @@
+#ifndef FLUX_TRACE_H
+#define FLUX_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace flux {
+// Collects a timeline of the compiler's work for `--trace=FILE`, written as Chrome trace
+// events (open the file in chrome://tracing or https://ui.perfetto.dev). Each TraceSpan
+// becomes one "complete" event on the thread that ran it; spans on one thread nest by
+// time. Threads are numbered in the order they first record, starting with the one that
+// created the tracer.
+//
+// Spans record only into the tracer installed with a TraceScope. With none installed a
+// span costs one relaxed atomic load, and its name is never built.
+class Tracer {
+  public:
+    Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    // The installed tracer, or nullptr.
+    static Tracer* active() {
+        return active_.load(std::memory_order_relaxed);
+    }
+
+    // Events recorded so far.
+    std::size_t size() const;
+
+    // The whole trace as a JSON object, events in start order.
+    void write(std::ostream& out) const;
+
+  private:
+    friend class TraceScope;
+    friend class TraceSpan;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        std::string_view category;
+        std::string name;
+        Clock::time_point start;
+        Clock::time_point end;
+        unsigned thread;
+    };
+
+    void record(std::string_view category, std::string name, Clock::time_point start,
+                Clock::time_point end);
+
+    static std::atomic<Tracer*> active_;
+
+    Clock::time_point origin_;
+    mutable std::mutex mutex_;
+    std::vector<Event> events_;
+    std::unordered_map<std::thread::id, unsigned> threads_;
+};
+
+// Installs `tracer` (which may be null, installing nothing) for this object's lifetime.
+// Only one tracer is installed at a time.
+class TraceScope {
+  public:
+    explicit TraceScope(Tracer* tracer);
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+  private:
+    Tracer* tracer_;
+};
+
+// Records one event, from construction to destruction, into the installed tracer.
+// `category` must be a string literal.
+class TraceSpan {
+  public:
+    TraceSpan(std::string_view category, std::string_view name) : tracer_(Tracer::active()) {
+        if (tracer_)
+            begin(category, std::string(name));
+    }
+
+    // For names that cost something to build: `name()` is called only while tracing.
+    template <std::invocable NameFn>
+    TraceSpan(std::string_view category, NameFn&& name) : tracer_(Tracer::active()) {
+        if (tracer_)
+            begin(category, std::string(name()));
+    }
+
+    ~TraceSpan() {
+        if (tracer_)
+            tracer_->record(category_, std::move(name_), start_, Tracer::Clock::now());
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+  private:
+    void begin(std::string_view category, std::string name) {
+        category_ = category;
+        name_ = std::move(name);
+        start_ = Tracer::Clock::now();
+    }
+
+    Tracer* tracer_;
+    std::string_view category_;
+    std::string name_;
+    Tracer::Clock::time_point start_;
+};
+} // namespace flux
+
+#endif // FLUX_TRACE_H
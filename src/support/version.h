@@ -0,0 +1,18 @@
+#ifndef FLUX_VERSION_H
+#define FLUX_VERSION_H
+
+#include "support/build_id.h" // generated by cmake/BuildId.cmake
+
+#include <string_view>
+
+namespace flux {
+// The compiler's release version, for humans.
+inline constexpr std::string_view kFluxVersion = "0.1.0";
+
+// A hash of every compiler source file, generated at build time. Artifacts written to disk
+// (module cache entries and build records) are keyed by it, so output cached by one build
+// of the compiler is never handed back by another, released or not.
+inline constexpr std::string_view kFluxBuildId = FLUX_BUILD_ID;
+} // namespace flux
+
+#endif // FLUX_VERSION_H
@@ -8,23 +8,25 @@ using namespace flux::semantic;
 
 void test_array_type_resolution() {
     // [1, 2, 3] should resolve to [Int32;3]
+    AstContext ctx;
     std::vector<ExprPtr> elems;
-    elems.push_back(std::make_unique<NumberExpr>("1"));
-    elems.push_back(std::make_unique<NumberExpr>("2"));
-    elems.push_back(std::make_unique<NumberExpr>("3"));
-    ArrayExpr arr(std::move(elems));
+    elems.push_back(ctx.make<NumberExpr>("1"));
+    elems.push_back(ctx.make<NumberExpr>("2"));
+    elems.push_back(ctx.make<NumberExpr>("3"));
+    ArrayExpr arr(ctx.list(std::move(elems)));
     Resolver resolver;
-    FluxType t = resolver.type_of(arr);
-    assert(t.kind == TypeKind::Array);
-    assert(t.name == "[Int32;3]");
+    TypeId t = resolver.type_of(arr);
+    assert(t->kind == TypeKind::Array);
+    assert(t->name == "[Int32;3]");
 }
 
 void test_array_type_error() {
     // [1, 2.0] should error (mixed types)
+    AstContext ctx;
     std::vector<ExprPtr> elems;
-    elems.push_back(std::make_unique<NumberExpr>("1"));
-    elems.push_back(std::make_unique<NumberExpr>("2.0"));
-    ArrayExpr arr(std::move(elems));
+    elems.push_back(ctx.make<NumberExpr>("1"));
+    elems.push_back(ctx.make<NumberExpr>("2.0"));
+    ArrayExpr arr(ctx.list(std::move(elems)));
     Resolver resolver;
     try {
         resolver.type_of(arr);
@@ -36,24 +38,24 @@ void test_array_type_error() {
 
 void test_slice_type_resolution() {
     // [1,2,3][0:2] should resolve to [Int32]
+    AstContext ctx;
     std::vector<ExprPtr> elems;
-    elems.push_back(std::make_unique<NumberExpr>("1"));
-    elems.push_back(std::make_unique<NumberExpr>("2"));
-    elems.push_back(std::make_unique<NumberExpr>("3"));
-    auto arr_ptr = std::make_unique<ArrayExpr>(std::move(elems));
-    SliceExpr slice(std::move(arr_ptr), std::make_unique<NumberExpr>("0"),
-                    std::make_unique<NumberExpr>("2"));
+    elems.push_back(ctx.make<NumberExpr>("1"));
+    elems.push_back(ctx.make<NumberExpr>("2"));
+    elems.push_back(ctx.make<NumberExpr>("3"));
+    auto arr_ptr = ctx.make<ArrayExpr>(ctx.list(std::move(elems)));
+    SliceExpr slice(arr_ptr, ctx.make<NumberExpr>("0"), ctx.make<NumberExpr>("2"));
     Resolver resolver;
-    FluxType t = resolver.type_of(slice);
-    assert(t.kind == TypeKind::Slice);
-    assert(t.name == "[Int32]");
+    TypeId t = resolver.type_of(slice);
+    assert(t->kind == TypeKind::Slice);
+    assert(t->name == "[Int32]");
 }
 
 void test_slice_type_error() {
     // Slicing non-array should error
-    NumberExpr num("1");
-    SliceExpr slice(std::make_unique<NumberExpr>("1"), std::make_unique<NumberExpr>("0"),
-                    std::make_unique<NumberExpr>("2"));
+    AstContext ctx;
+    SliceExpr slice(ctx.make<NumberExpr>("1"), ctx.make<NumberExpr>("0"),
+                    ctx.make<NumberExpr>("2"));
     Resolver resolver;
     try {
         resolver.type_of(slice);
@@ -36,7 +36,7 @@ void test_parsing_associated_types() {
     assert(module.impls.size() == 1);
     assert(module.impls[0].associated_types.size() == 1);
     assert(module.impls[0].associated_types[0].name == "Item");
-    assert(module.impls[0].associated_types[0].default_type == "Int32");
+    assert(spelling(module.impls[0].associated_types[0].default_type) == "Int32");
 
     std::cout << "PASSED: test_parsing_associated_types" << std::endl;
 }
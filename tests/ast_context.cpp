@@ -0,0 +1,122 @@
+#include "ast/ast.h"
+#include "ast/ast_context.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace flux;
+using namespace flux::ast;
+
+namespace {
+int destroyed = 0;
+
+struct Counted {
+    std::string text;
+    explicit Counted(std::string t = "") : text(std::move(t)) {}
+    ~Counted() {
+        ++destroyed;
+    }
+};
+
+struct alignas(64) Wide {
+    char byte = 0;
+};
+} // namespace
+
+// Nodes come out of shared chunks, aligned, and every non-trivial one is destroyed with
+// the context.
+void test_bump_allocation() {
+    destroyed = 0;
+    {
+        AstContext ctx;
+        auto* a = ctx.make<NumberExpr>("1");
+        auto* b = ctx.make<NumberExpr>("2");
+        assert(a != b && a->value == "1" && b->value == "2");
+        assert(ctx.bytes_allocated() >= 2 * sizeof(NumberExpr));
+
+        auto* wide = ctx.make<Wide>();
+        assert(reinterpret_cast<std::uintptr_t>(wide) % 64 == 0);
+
+        // More than one chunk's worth, plus one allocation larger than a chunk.
+        for (int i = 0; i < 10000; ++i)
+            ctx.make<Counted>(std::to_string(i));
+        auto big = ctx.list<char>(256 * 1024);
+        assert(big.size() == 256 * 1024 && big[0] == 0 && big.back() == 0);
+        assert(destroyed == 0);
+    }
+    assert(destroyed == 10000);
+}
+
+// Lists are moved into the arena; empty lists take no space.
+void test_lists() {
+    destroyed = 0;
+    {
+        AstContext ctx;
+        const std::size_t before = ctx.bytes_allocated();
+        assert(ctx.list(std::vector<ExprPtr>{}).empty());
+        assert(ctx.bytes_allocated() == before);
+
+        std::vector<Counted> items;
+        items.emplace_back("a");
+        items.emplace_back("b");
+        std::span<Counted> list = ctx.list(std::move(items));
+        assert(list.size() == 2 && list[0].text == "a" && list[1].text == "b");
+        items.clear();
+        destroyed = 0;
+    }
+    assert(destroyed == 2);
+}
+
+// Cloning copies a subtree into another context, which can outlive the original.
+void test_clone_into_other_context() {
+    AstContext target;
+    ExprPtr copy = nullptr;
+    {
+        AstContext source;
+        std::vector<ExprPtr> args;
+        args.push_back(source.make<NumberExpr>("1"));
+        args.push_back(source.make<StringExpr>("two"));
+        ExprPtr call =
+            source.make<CallExpr>(source.make<IdentifierExpr>("f"), source.list(std::move(args)));
+        copy = call->clone(target);
+        assert(copy != call);
+    }
+    auto* call = dynamic_cast<CallExpr*>(copy);
+    assert(call && call->arguments.size() == 2);
+    assert(dynamic_cast<IdentifierExpr*>(call->callee)->name == "f");
+    assert(dynamic_cast<StringExpr*>(call->arguments[1])->value == "two");
+}
+
+// A parsed module keeps its parser's arena alive; so does a Module clone its own.
+void test_module_owns_its_nodes() {
+    Module module;
+    {
+        Lexer lexer("func main() -> Void {\n    let x: Int32 = 1 + 2;\n    log(x);\n}");
+        Parser parser(lexer.tokenize());
+        module = parser.parse_module();
+        assert(module.context == parser.context());
+    }
+    assert(module.context->bytes_allocated() > 0);
+    assert(module.functions[0].body.statements.size() == 2);
+
+    Module copy = module.clone();
+    assert(copy.context != module.context);
+    module = Module();
+    const auto* let = dynamic_cast<const LetStmt*>(copy.functions[0].body.statements[0]);
+    assert(let && let->name == "x");
+    assert(dynamic_cast<const BinaryExpr*>(let->initializer));
+}
+
+int main() {
+    test_bump_allocation();
+    test_lists();
+    test_clone_into_other_context();
+    test_module_owns_its_nodes();
+    std::cout << "AST context tests passed.\n";
+    return 0;
+}
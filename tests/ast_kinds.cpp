@@ -0,0 +1,92 @@
+#include "ast/ast.h"
+#include "ast/ast_context.h"
+#include "ast/ast_visitor.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace flux;
+using namespace flux::ast;
+
+// Every node carries the kind of its concrete class, cloned nodes included.
+void test_nodes_carry_their_kind() {
+    AstContext ctx;
+    Expr* num = ctx.make<NumberExpr>("1");
+    Expr* bin = ctx.make<BinaryExpr>(TokenKind::Plus, num, ctx.make<IdentifierExpr>("x"));
+    assert(num->kind == ExprKind::Number);
+    assert(bin->kind == ExprKind::Binary);
+    assert(bin->clone(ctx)->kind == ExprKind::Binary);
+
+    Stmt* cont = ctx.make<ContinueStmt>();
+    assert(cont->kind == StmtKind::Continue);
+    Pattern* wild = ctx.make<WildcardPattern>();
+    assert(wild->kind == PatternKind::Wildcard);
+}
+
+// isa/dyn_cast/cast test the tag, keep constness and treat null as "not a".
+void test_casts() {
+    AstContext ctx;
+    Expr* expr = ctx.make<StringExpr>("hi");
+    assert(isa<StringExpr>(expr));
+    assert(!isa<NumberExpr>(expr));
+    assert(dyn_cast<NumberExpr>(expr) == nullptr);
+    assert(cast<StringExpr>(expr)->value == "hi");
+
+    const Expr* const_expr = expr;
+    auto* str = dyn_cast<StringExpr>(const_expr);
+    static_assert(std::is_same_v<decltype(str), const StringExpr*>);
+    static_assert(std::is_same_v<decltype(dyn_cast<StringExpr>(expr)), StringExpr*>);
+    assert(str == expr);
+
+    const Expr* null = nullptr;
+    assert(!isa<StringExpr>(null));
+    assert(dyn_cast<StringExpr>(null) == nullptr);
+}
+
+// visit() hands the visitor the concrete node; overload sets pick per kind.
+void test_visit() {
+    Lexer lexer("func main() -> Void {\n"
+                "    let x: Int32 = 1 + 2;\n"
+                "    while x < 3 { x = x + 1; }\n"
+                "    return;\n"
+                "}");
+    Parser parser(lexer.tokenize());
+    Module module = parser.parse_module();
+
+    struct Namer {
+        std::string operator()(const LetStmt& let) const {
+            return "let " + let.name.str();
+        }
+        std::string operator()(const WhileStmt&) const {
+            return "while";
+        }
+        std::string operator()(const Stmt&) const {
+            return "other";
+        }
+    };
+    std::vector<std::string> names;
+    for (const Stmt* stmt : module.functions[0].body.statements)
+        names.push_back(visit(*stmt, Namer{}));
+    assert((names == std::vector<std::string>{"let x", "while", "other"}));
+
+    // A mutable node is visited as mutable.
+    Expr* init = cast<LetStmt>(module.functions[0].body.statements[0])->initializer;
+    visit(*init, [](auto& node) {
+        static_assert(!std::is_const_v<std::remove_reference_t<decltype(node)>>);
+        if constexpr (std::is_same_v<std::remove_cvref_t<decltype(node)>, BinaryExpr>)
+            node.op = TokenKind::Minus;
+    });
+    assert(cast<BinaryExpr>(init)->op == TokenKind::Minus);
+}
+
+int main() {
+    test_nodes_carry_their_kind();
+    test_casts();
+    test_visit();
+    std::cout << "AST kind tests passed.\n";
+    return 0;
+}
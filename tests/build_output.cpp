@@ -0,0 +1,276 @@
+#include "codegen/partition.h"
+#include "driver/compiler.h"
+#include "ir/passes/pipeline.h"
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+using namespace flux;
+
+namespace {
+std::filesystem::path make_project(const std::string& name) {
+    const auto dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "std");
+    std::ofstream(dir / "app.fl") << "module app;\nimport math;\nimport std::io;\n"
+                                     "func main() -> Int32 {\n"
+                                     "    io::println(\"built by flux\");\n"
+                                     "    let mut total: Int32 = 0;\n"
+                                     "    let mut i: Int32 = 0;\n"
+                                     "    while i < 10 {\n"
+                                     "        total = total + i;\n"
+                                     "        i = i + 1;\n"
+                                     "    }\n"
+                                     "    return total - math::twice(1);\n"
+                                     "}\n";
+    std::ofstream(dir / "std" / "math.fl")
+        << "module math;\npub func twice(x: Int32) -> Int32 { return x * 2; }\n";
+    std::ofstream(dir / "std" / "io.fl")
+        << "module std::io;\nextern func puts(s: String) -> Int32;\n"
+           "pub func println(s: String) { puts(s); }\n";
+    return dir;
+}
+
+int build(const std::filesystem::path& dir, const std::vector<std::string>& flags,
+          std::string& err) {
+    CompileOptions options;
+    options.input = "app.fl";
+    options.working_directory = dir;
+    options.build = true;
+    assert(!parse_compile_flags(flags, options));
+    std::ostringstream out;
+    std::ostringstream err_stream;
+    const int exit_code = compile(options, out, err_stream);
+    err = err_stream.str();
+    return exit_code;
+}
+
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), {}};
+}
+} // namespace
+
+// `flux build` links an executable named after the input; it runs, and calls into the C
+// library through std::io's extern declarations.
+void test_build_executable() {
+#ifndef _WIN32
+    const auto dir = make_project("flux_build_executable");
+    std::string err;
+    assert(build(dir, {}, err) == 0);
+    assert(err.empty());
+    assert(std::filesystem::exists(dir / "app"));
+    assert(!std::filesystem::exists(dir / "app.o"));
+
+    auto run = [&](const std::string& program) {
+        const std::string command =
+            "'" + (dir / program).string() + "' > '" + (dir / "out.txt").string() + "'";
+        const int status = std::system(command.c_str());
+        assert(WIFEXITED(status));
+        return WEXITSTATUS(status);
+    };
+    assert(run("app") == 43);
+    assert(read_file(dir / "out.txt") == "built by flux\n");
+
+    assert(build(dir, {"-o", "static-app", "--reloc=static"}, err) == 0);
+    assert(run("static-app") == 43);
+
+    // $CC is split into words, like make does, so a launcher in front of the driver works.
+    const char* old_cc = std::getenv("CC");
+    const std::string saved_cc = old_cc ? old_cc : "";
+    setenv("CC", " env  cc ", 1);
+    assert(build(dir, {"-o", "launched-app"}, err) == 0);
+    assert(run("launched-app") == 43);
+    setenv("CC", "flux-no-such-linker", 1);
+    assert(build(dir, {"-o", "unlinked-app"}, err) == 1);
+    assert(err.find("cannot run the linker flux-no-such-linker: ") != std::string::npos);
+    if (old_cc)
+        setenv("CC", saved_cc.c_str(), 1);
+    else
+        unsetenv("CC");
+    std::filesystem::remove_all(dir);
+#endif
+}
+
+// --emit= writes a single file instead, named after the input unless -o says otherwise.
+void test_build_emit_kinds() {
+    const auto dir = make_project("flux_build_emit");
+    std::string err;
+    assert(build(dir, {"--emit=obj"}, err) == 0);
+    assert(std::filesystem::file_size(dir / "app.o") > 0);
+    assert(build(dir, {"--emit=asm"}, err) == 0);
+    assert(read_file(dir / "app.s").find("main:") != std::string::npos);
+    assert(build(dir, {"--emit=bc", "-o", "out/app.bc"}, err) == 1);
+    std::filesystem::create_directories(dir / "out");
+    assert(build(dir, {"--emit=bc", "-o", "out/app.bc"}, err) == 0);
+    assert(read_file(dir / "out" / "app.bc").starts_with("BC"));
+    assert(build(dir, {"--emit=llvm-ir"}, err) == 0);
+    const std::string ir = read_file(dir / "app.ll");
+    assert(ir.find("define i32 @main()") != std::string::npos);
+    assert(ir.find(" @puts(") != std::string::npos);
+    assert(ir.find("target triple") != std::string::npos);
+    std::filesystem::remove_all(dir);
+}
+
+// Every level builds a program that computes the same thing; from -O1 up LLVM's pipeline
+// promotes locals to registers.
+void test_optimization_levels() {
+    assert(ir::make_pass_pipeline(ir::OptLevel::O0).size() == 1);
+    assert(ir::make_pass_pipeline(ir::OptLevel::O1).size() == 4);
+    assert(ir::make_pass_pipeline(ir::OptLevel::O2)[1]->name() == "Inliner");
+
+    const auto dir = make_project("flux_build_levels");
+    std::string err;
+    for (const char* level : {"-O0", "-O1", "-O2", "-O3", "-Os"}) {
+        assert(build(dir, {level, "--emit=llvm-ir"}, err) == 0);
+        const std::string ir = read_file(dir / "app.ll");
+        assert((ir.find("alloca") != std::string::npos) == (std::string(level) == "-O0"));
+#ifndef _WIN32
+        assert(build(dir, {level}, err) == 0);
+        const int status = std::system(("'" + (dir / "app").string() + "' >/dev/null").c_str());
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 43);
+#endif
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// Partitions are runs of consecutive functions of about equal size, never empty.
+void test_partition_functions() {
+    ir::IRModule module;
+    auto add_function = [&](std::size_t instructions, bool external) {
+        auto function = std::make_unique<ir::IRFunction>();
+        function->is_external = external;
+        auto block = function->create_block("entry");
+        for (std::size_t i = 0; i < instructions; ++i)
+            block->instructions.push_back(std::make_unique<ir::Instruction>());
+        module.functions.push_back(std::move(function));
+    };
+    for (std::size_t size : {10, 10, 10, 10})
+        add_function(size, false);
+    add_function(0, true);
+    add_function(39, false);
+
+    using Partitions = std::vector<unsigned>;
+    assert(codegen::partition_functions(module, 1) == Partitions(6, 0));
+    assert(codegen::partition_functions(module, 2) == (Partitions{0, 0, 0, 0, 0, 1}));
+    assert(codegen::partition_functions(module, 3) == (Partitions{0, 0, 0, 1, 0, 2}));
+    // More partitions than functions: one function each.
+    assert(codegen::partition_functions(module, 8) == (Partitions{0, 1, 2, 3, 0, 4}));
+}
+
+// --codegen-units splits the program into objects compiled in parallel and linked
+// together. The thread count does not change what is written.
+void test_codegen_units() {
+    const auto dir = make_project("flux_build_units");
+    std::string err;
+#ifndef _WIN32
+    for (const char* units : {"--codegen-units=2", "--codegen-units=16"}) {
+        assert(build(dir, {units, "-j4"}, err) == 0);
+        const int status = std::system(("'" + (dir / "app").string() + "' >/dev/null").c_str());
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 43);
+        assert(!std::filesystem::exists(dir / "app.0.o"));
+    }
+#endif
+    assert(build(dir, {"--codegen-units=3", "-j1", "--emit=llvm-ir"}, err) == 0);
+    std::vector<std::string> serial;
+    for (const char* file : {"app.0.ll", "app.1.ll", "app.2.ll"})
+        serial.push_back(read_file(dir / file));
+    assert(!std::filesystem::exists(dir / "app.3.ll"));
+    assert(serial[0].find("define i32 @main()") != std::string::npos);
+    assert(serial[1].find("define i32 @main()") == std::string::npos);
+
+    assert(build(dir, {"--codegen-units=3", "-j3", "--emit=llvm-ir"}, err) == 0);
+    for (unsigned partition = 0; partition < 3; ++partition) {
+        const std::string file = "app." + std::to_string(partition) + ".ll";
+        assert(read_file(dir / file) == serial[partition]);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// With a cache, an executable is compiled one unit per module, and the cache keeps each
+// module's object. A module is compiled again only if its text, or a declaration it uses,
+// changed: a body edit of the leaf module math lowers math alone, and links the objects
+// of app and std::io as the first build left them.
+void test_incremental_build() {
+#ifndef _WIN32
+    const auto dir = make_project("flux_build_incremental");
+    std::string err;
+    auto stat = [&](const std::string& name) {
+        const std::size_t at = err.find("  " + name + "\n");
+        assert(at != std::string::npos);
+        return std::stoul(err.substr(err.rfind('\n', at) + 1, at));
+    };
+    auto build_and_run = [&] {
+        assert(build(dir, {"--cache-dir=cache", "--stats"}, err) == 0);
+        const int status = std::system(("'" + (dir / "app").string() + "' >/dev/null").c_str());
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 43);
+    };
+    auto edit_math = [&](const std::string& functions) {
+        std::ofstream(dir / "std" / "math.fl") << "module math;\n" << functions;
+    };
+
+    build_and_run();
+    assert(stat("modules compiled") == 3 && stat("modules reused") == 0);
+    build_and_run();
+    assert(stat("modules compiled") == 0 && stat("modules reused") == 3);
+
+    // A body edit: math's one function is the only one lowered.
+    edit_math("pub func twice(x: Int32) -> Int32 { return x + x; }\n");
+    build_and_run();
+    assert(stat("modules compiled") == 1 && stat("modules reused") == 2);
+    assert(stat("IR functions") == 1);
+
+    // So is a new function that app does not use...
+    edit_math("pub func twice(x: Int32) -> Int32 { return x + x; }\n"
+              "pub func thrice(x: Int32) -> Int32 { return x * 3; }\n");
+    build_and_run();
+    assert(stat("modules compiled") == 1 && stat("IR functions") == 2);
+
+    // ...but not a change to the signature app calls.
+    edit_math("pub func twice(n: Int32) -> Int32 { return n + n; }\n");
+    build_and_run();
+    assert(stat("modules compiled") == 2 && stat("modules reused") == 1);
+
+    // Undoing every edit finds the objects of the first build.
+    edit_math("pub func twice(x: Int32) -> Int32 { return x * 2; }\n");
+    build_and_run();
+    assert(stat("modules compiled") == 0);
+    std::filesystem::remove_all(dir);
+#endif
+}
+
+void test_build_flags() {
+    CompileOptions options;
+    assert(!parse_compile_flags({"-o", "bin/app", "--emit=obj"}, options));
+    assert(options.output == "bin/app" && options.emit == codegen::FileType::Object);
+    assert(parse_compile_flags({"-o"}, options) == "flux: -o needs a file name");
+    assert(parse_compile_flags({"--emit=exe"}, options) == "flux: unknown output kind: exe");
+    assert(parse_compile_flags({"--reloc=ropi"}, options) ==
+           "flux: unknown relocation model: ropi");
+    assert(!parse_compile_flags({"-O3"}, options) && options.opt_level == ir::OptLevel::O3);
+    assert(parse_compile_flags({"-O4"}, options) == "flux: unknown optimization level: -O4");
+    assert(!parse_compile_flags({"--codegen-units=8"}, options) && options.codegen_units == 8);
+    assert(parse_compile_flags({"--codegen-units=0"}, options) ==
+           "flux: invalid codegen unit count: --codegen-units=0");
+}
+
+int main() {
+    test_build_executable();
+    test_build_emit_kinds();
+    test_optimization_levels();
+    test_partition_functions();
+    test_codegen_units();
+    test_incremental_build();
+    test_build_flags();
+    std::cout << "build_output tests passed\n";
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include "driver/compiler.h"
+#include "support/statistics.h"
+#include "support/trace.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace flux;
+
+namespace {
+std::filesystem::path make_project(const std::string& name) {
+    const auto dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "std");
+    std::ofstream(dir / "app.fl") << "module app;\nimport math;\n"
+                                     "func main() -> Int32 { return twice(21); }\n";
+    std::ofstream(dir / "std" / "math.fl")
+        << "module math;\npub func twice(x: Int32) -> Int32 { return x * 2; }\n";
+    return dir;
+}
+
+int compile_with(const std::filesystem::path& dir, const std::vector<std::string>& flags,
+                 std::string& out, std::string& err) {
+    CompileOptions options;
+    options.input = "app.fl";
+    options.working_directory = dir;
+    assert(!parse_compile_flags(flags, options));
+    std::ostringstream out_stream;
+    std::ostringstream err_stream;
+    const int exit_code = compile(options, out_stream, err_stream);
+    out = out_stream.str();
+    err = err_stream.str();
+    return exit_code;
+}
+} // namespace
+
+// Phases nest in the order they start; counters keep the order they were first set.
+void test_statistics() {
+    Statistics stats;
+    {
+        Statistics::Timer outer(&stats, "outer");
+        { Statistics::Timer inner(&stats, "inner"); }
+        stats.set("b", 1);
+        stats.set("a", 2);
+        stats.set("b", 3);
+    }
+    { Statistics::Timer ignored(nullptr, "not recorded"); }
+
+    assert(stats.phases().size() == 2);
+    assert(stats.phases()[0].name == "outer" && stats.phases()[0].depth == 0);
+    assert(stats.phases()[1].name == "inner" && stats.phases()[1].depth == 1);
+    assert(stats.phases()[0].wall_seconds >= stats.phases()[1].wall_seconds);
+    assert(stats.counters().size() == 2);
+    assert(stats.counters()[0].first == "b" && stats.counters()[0].second == 3);
+
+    std::ostringstream json;
+    stats.print_json(json, false, true);
+    assert(json.str() == "{\"counters\":{\"b\":3,\"a\":2}}\n");
+}
+
+// --time-passes and --stats report on standard error, after the build's own output.
+void test_compile_reports() {
+    const auto dir = make_project("flux_compile_reports");
+    std::string plain_out, plain_err;
+    assert(compile_with(dir, {}, plain_out, plain_err) == 0);
+    assert(plain_err.empty());
+
+    std::string out, err;
+    assert(compile_with(dir, {"--time-passes", "--stats"}, out, err) == 0);
+    assert(out == plain_out);
+    assert(err.find("===== Time per phase =====") != std::string::npos);
+    assert(err.find("  resolve\n") != std::string::npos);
+    assert(err.find("    Inliner\n") != std::string::npos);
+    assert(err.find("tokens lexed\n") != std::string::npos);
+    assert(err.find("IR instructions after pass 5 (IR Verifier)\n") != std::string::npos);
+    assert(err.find("peak resident memory (bytes)\n") != std::string::npos);
+
+    assert(compile_with(dir, {"--stats", "--report-format=json"}, out, err) == 0);
+    assert(err.starts_with("{\"counters\":{\"modules\":2,"));
+    assert(err.find("\"phases\"") == std::string::npos);
+    assert(err.ends_with("}\n"));
+
+    assert(compile_with(dir, {"--time-passes", "--report-format=json"}, out, err) == 0);
+    assert(err.starts_with("{\"phases\":[{\"name\":\"total\",\"depth\":0,"));
+
+    CompileOptions options;
+    assert(parse_compile_flags({"--report-format=xml"}, options) ==
+           "flux: unknown report format: xml");
+    std::filesystem::remove_all(dir);
+}
+
+// Spans record only while a tracer is installed, each on its own thread's row.
+void test_tracer() {
+    Tracer tracer;
+    { TraceSpan ignored("test", "before install"); }
+    {
+        TraceScope tracing(&tracer);
+        TraceSpan outer("test", "outer");
+        { TraceSpan inner("test", [] { return std::string("inner"); }); }
+        std::thread([] { TraceSpan worker("test", "on a worker"); }).join();
+    }
+    bool built = false;
+    {
+        TraceSpan ignored("test", [&] {
+            built = true;
+            return std::string("after uninstall");
+        });
+    }
+    assert(!built);
+    assert(tracer.size() == 3);
+
+    std::ostringstream json;
+    tracer.write(json);
+    const std::string text = json.str();
+    assert(text.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    assert(text.ends_with("]}\n"));
+    assert(text.find("\"args\":{\"name\":\"worker 1\"}") != std::string::npos);
+    // Enclosing spans come first.
+    assert(text.find("\"name\":\"outer\"") < text.find("\"name\":\"inner\""));
+    assert(text.find("\"name\":\"on a worker\",\"ts\"") != std::string::npos);
+    assert(text.find("before install") == std::string::npos);
+}
+
+// --trace writes one span per loaded module, resolved function, lowered function, IR pass
+// and generated function, even for a build that fails.
+void test_compile_trace() {
+    const auto dir = make_project("flux_compile_trace");
+    std::ofstream(dir / "app.fl") << "module app;\nimport math;\n"
+                                     "func main() -> Int32 { return math::twice(21); }\n";
+    std::string out, err;
+    assert(compile_with(dir, {"--trace=trace.json", "--emit-llvm", "-j2"}, out, err) == 0);
+    std::ifstream file(dir / "trace.json");
+    const std::string trace{std::istreambuf_iterator<char>(file), {}};
+    for (const char* event :
+         {"\"cat\":\"phase\",\"name\":\"total\"", "\"cat\":\"phase\",\"name\":\"resolve\"",
+          "\"cat\":\"load\",\"name\":\"math\"", "\"cat\":\"resolve\",\"name\":\"main\"",
+          "\"cat\":\"lower\",\"name\":\"app::main\"", "\"cat\":\"ir-pass\",\"name\":\"Inliner\"",
+          "\"cat\":\"codegen\",\"name\":\"app::main\""}) {
+        assert(trace.find(event) != std::string::npos);
+    }
+    // Imports are parsed on the loader's pool, and show up on a worker's row.
+    assert(trace.find("\"args\":{\"name\":\"worker 1\"}") != std::string::npos);
+    assert(err.empty());
+
+    std::ofstream(dir / "app.fl") << "module app;\nfunc main() -> Int32 { return missing; }\n";
+    std::filesystem::remove(dir / "trace.json");
+    assert(compile_with(dir, {"--trace=trace.json"}, out, err) == 1);
+    assert(std::filesystem::exists(dir / "trace.json"));
+
+    CompileOptions options;
+    assert(parse_compile_flags({"--trace="}, options) == "flux: --trace needs a file name");
+    std::filesystem::remove_all(dir);
+}
+
+int main() {
+    test_statistics();
+    test_compile_reports();
+    test_tracer();
+    test_compile_trace();
+    std::cout << "compile_reports tests passed\n";
+    return 0;
+}
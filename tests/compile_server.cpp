@@ -0,0 +1,253 @@
+#include "driver/compile_server.h"
+#include "driver/compiler.h"
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace flux;
+
+namespace {
+void write(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream(path) << text;
+}
+
+std::filesystem::path make_project(const std::string& name) {
+    const auto dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "std");
+    write(dir / "app.fl", "module app;\nimport math;\n"
+                          "func main() -> Int32 { return twice(21); }\n");
+    write(dir / "std" / "math.fl", "module math;\n"
+                                   "pub func twice(x: Int32) -> Int32 { return x * 2; }\n");
+    return dir;
+}
+
+struct Result {
+    int exit_code;
+    std::string out;
+    std::string err;
+};
+
+Result compile_in(CompileSession& session, const std::filesystem::path& dir,
+                  const std::string& input = "app.fl") {
+    CompileOptions options;
+    options.input = input;
+    options.working_directory = dir;
+    options.emit_ir = true;
+    std::ostringstream out;
+    std::ostringstream err;
+    const int exit_code = session.compile(options, out, err);
+    return {exit_code, out.str(), err.str()};
+}
+} // namespace
+
+// A session compiles like a one-shot compile, keeps one loader per entry file, and picks
+// up edits.
+void test_session() {
+    const auto dir = make_project("flux_session");
+    CompileOptions options;
+    options.input = "app.fl";
+    options.working_directory = dir;
+    options.emit_ir = true;
+    std::ostringstream cold;
+    std::ostringstream cold_err;
+    assert(compile(options, cold, cold_err) == 0);
+
+    CompileSession session;
+    const Result first = compile_in(session, dir);
+    assert(first.exit_code == 0 && first.out == cold.str());
+    assert(compile_in(session, dir).out == cold.str());
+    assert(session.warm_loaders() == 1);
+
+    // A broken edit is reported; fixing it compiles again in the same session.
+    const auto app = dir / "app.fl";
+    auto edit = [&](const std::string& text) {
+        const auto before = std::filesystem::last_write_time(app);
+        write(app, text);
+        std::filesystem::last_write_time(app, before + std::chrono::seconds(1));
+    };
+    edit("module app;\nimport math;\nfunc main() -> Int32 { return twice(; }\n");
+    const Result broken = compile_in(session, dir);
+    assert(broken.exit_code == 1 && broken.err.find("app.fl") != std::string::npos);
+    edit("module app;\nimport math;\nfunc main() -> Int32 { return twice(4); }\n");
+    const Result fixed = compile_in(session, dir);
+    assert(fixed.exit_code == 0 && fixed.out != first.out);
+
+    const Result missing = compile_in(session, dir, "nowhere.fl");
+    assert(missing.exit_code == 1);
+    std::filesystem::remove_all(dir);
+}
+
+// An error inside an imported module leaves the kept loader usable once it is fixed, and a
+// session that clears the Interner between builds still compiles the same program.
+void test_session_recovers() {
+    const auto dir = make_project("flux_session_import");
+    const auto math = dir / "std" / "math.fl";
+    auto edit = [&](const std::string& text) {
+        const auto before = std::filesystem::last_write_time(math);
+        write(math, text);
+        std::filesystem::last_write_time(math, before + std::chrono::seconds(1));
+    };
+
+    CompileSession session;
+    const Result first = compile_in(session, dir);
+    assert(first.exit_code == 0);
+    edit("module math;\npub func twice(x: Int32) -> Int32 { return x * ; }\n");
+    const Result broken = compile_in(session, dir);
+    assert(broken.exit_code == 1 && broken.err.find("math.fl") != std::string::npos);
+    edit("module math;\npub func twice(x: Int32) -> Int32 { return x * 2; }\n");
+    for (int i = 0; i < 2; ++i) {
+        const Result fixed = compile_in(session, dir);
+        assert(fixed.exit_code == 0 && fixed.err.empty() && fixed.out == first.out);
+    }
+
+    session.set_name_limit(1);
+    assert(compile_in(session, dir).out == first.out);
+    assert(compile_in(session, dir).out == first.out);
+    std::filesystem::remove_all(dir);
+}
+
+// A session replays the declarations of the modules it declared before, as long as their
+// text is unchanged, and builds with the target machine it kept.
+void test_session_keeps_declarations() {
+    const auto dir = make_project("flux_session_declarations");
+    CompileOptions options;
+    options.input = "app.fl";
+    options.working_directory = dir;
+    options.emit_ir = true;
+    std::ostringstream cold;
+    std::ostringstream cold_err;
+    assert(compile(options, cold, cold_err) == 0);
+
+    CompileSession session;
+    options.stats = true;
+    auto replayed = [&](const std::string& expected_out) {
+        std::ostringstream out;
+        std::ostringstream err;
+        assert(session.compile(options, out, err) == 0 && out.str() == expected_out);
+        const std::string report = err.str();
+        const std::size_t at = report.find("  modules declared from cache\n");
+        assert(at != std::string::npos);
+        return std::stoul(report.substr(report.rfind('\n', at) + 1, at));
+    };
+    assert(replayed(cold.str()) == 0);
+    assert(replayed(cold.str()) == 2);
+
+    // A body edit declares its own module again; math, declared after it, still replays.
+    const auto app = dir / "app.fl";
+    const auto before = std::filesystem::last_write_time(app);
+    write(app, "module app;\nimport math;\nfunc main() -> Int32 { return twice(4); }\n");
+    std::filesystem::last_write_time(app, before + std::chrono::seconds(1));
+    std::ostringstream edited;
+    std::ostringstream edited_err;
+    options.stats = false;
+    assert(compile(options, edited, edited_err) == 0);
+    options.stats = true;
+    assert(replayed(edited.str()) == 1);
+
+    write(dir / "solo.fl", "module solo;\nfunc main() -> Int32 { return 42; }\n");
+    CompileOptions build;
+    build.input = "solo.fl";
+    build.working_directory = dir;
+    build.build = true;
+    build.emit = codegen::FileType::Object;
+    for (int i = 0; i < 2; ++i) {
+        std::ostringstream out;
+        std::ostringstream err;
+        assert(session.compile(build, out, err) == 0);
+        assert(std::filesystem::file_size(dir / "solo.o") > 0);
+        std::filesystem::remove(dir / "solo.o");
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// The same request through `flux serve`'s socket gets the same answer.
+void test_server() {
+    const auto dir = make_project("flux_server");
+    const auto socket = dir / "flux.sock";
+    CompileServer server(socket);
+    std::thread thread([&] { server.serve(); });
+
+    CompileSession local;
+    const Result expected = compile_in(local, dir);
+    CompileResponse response = send_compile_request(socket, dir, {"app.fl", "--emit-ir"});
+    assert(response.exit_code == 0 && response.out == expected.out);
+    response = send_compile_request(socket, dir, {"app.fl", "-jx"});
+    assert(response.exit_code == 1 && response.err == "flux: invalid job count: -jx\n");
+    assert(server.session().warm_loaders() == 1);
+
+    bool threw = false;
+    try {
+        CompileServer second(socket);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    response = send_compile_request(socket, dir, {"--stop-server"});
+    assert(response.exit_code == 0);
+    thread.join();
+    std::filesystem::remove_all(dir);
+}
+
+// Clients that connect and then never finish their request get an error once the request
+// timeout passes, and the request queued behind them is answered.
+void test_server_drops_stalled_clients() {
+    const auto dir = make_project("flux_server_stalled");
+    const auto socket = dir / "flux.sock";
+    CompileServer server(socket);
+    server.set_request_timeout(std::chrono::milliseconds(200));
+    std::thread thread([&] { server.serve(); });
+
+    auto connect_raw = [&] {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        const std::string path = socket.string();
+        path.copy(address.sun_path, sizeof address.sun_path - 1);
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        assert(fd >= 0);
+        assert(::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof address) == 0);
+        return fd;
+    };
+    // One sends nothing; the other half a request, and never shuts down its end.
+    const int silent = connect_raw();
+    const int partial = connect_raw();
+    const std::string half = "12\nflux-request";
+    assert(::send(partial, half.data(), half.size(), 0) == static_cast<ssize_t>(half.size()));
+
+    CompileResponse response = send_compile_request(socket, dir, {"app.fl", "--emit-ir"});
+    assert(response.exit_code == 0 && !response.out.empty());
+
+    for (const int fd : {silent, partial}) {
+        std::string reply;
+        char buffer[256];
+        for (ssize_t got; (got = ::recv(fd, buffer, sizeof buffer, 0)) > 0;)
+            reply.append(buffer, static_cast<std::size_t>(got));
+        assert(reply.find("flux: compile request not received within 200 ms\n") !=
+               std::string::npos);
+        ::close(fd);
+    }
+
+    send_compile_request(socket, dir, {"--stop-server"});
+    thread.join();
+    std::filesystem::remove_all(dir);
+}
+
+int main() {
+    test_session();
+    test_session_recovers();
+    test_session_keeps_declarations();
+    test_server();
+    test_server_drops_stalled_clients();
+    std::cout << "Compile server tests passed.\n";
+    return 0;
+}
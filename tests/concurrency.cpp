@@ -16,27 +16,29 @@ void test_async_await_valid() {
     mod.functions.emplace_back();
     auto& fetch_fn = mod.functions.back();
     fetch_fn.name = "fetch";
-    fetch_fn.return_type = "Int32";
+    fetch_fn.return_type = mod.context->make<PathType>("Int32");
     fetch_fn.is_async = true;
     fetch_fn.has_body = true;
-    fetch_fn.body.statements.push_back(
-        std::make_unique<ReturnStmt>(std::make_unique<NumberExpr>("42")));
+    AstContext& ctx = *mod.context;
+    std::vector<StmtPtr> fetch_body;
+    fetch_body.push_back(ctx.make<ReturnStmt>(ctx.make<NumberExpr>("42")));
+    fetch_fn.body.statements = ctx.list(std::move(fetch_body));
 
     mod.functions.emplace_back();
     auto& main_fn = mod.functions.back();
     main_fn.name = "main";
-    main_fn.return_type = "Void";
+    main_fn.return_type = mod.context->make<PathType>("Void");
     main_fn.is_async = true;
     main_fn.has_body = true;
 
     // await fetch()
-    std::vector<ExprPtr> args;
-    auto call =
-        std::make_unique<CallExpr>(std::make_unique<IdentifierExpr>("fetch"), std::move(args));
-    ExprPtr await_expr = std::make_unique<AwaitExpr>(std::move(call));
+    auto call = ctx.make<CallExpr>(ctx.make<IdentifierExpr>("fetch"), std::span<ExprPtr>{});
+    ExprPtr await_expr = ctx.make<AwaitExpr>(call);
 
-    main_fn.body.statements.push_back(
-        std::make_unique<LetStmt>("x", "Int32", false, false, std::move(await_expr)));
+    std::vector<StmtPtr> main_body;
+    main_body.push_back(
+        ctx.make<LetStmt>("x", ctx.make<PathType>("Int32"), false, false, await_expr));
+    main_fn.body.statements = ctx.list(std::move(main_body));
 
     Resolver resolver;
     try {
@@ -55,21 +57,23 @@ void test_await_invalid_context() {
     mod.functions.emplace_back();
     auto& some_async_fn = mod.functions.back();
     some_async_fn.name = "some_async_fn";
-    some_async_fn.return_type = "Void";
+    some_async_fn.return_type = mod.context->make<PathType>("Void");
     some_async_fn.is_async = true;
 
     mod.functions.emplace_back();
     auto& sync_fn = mod.functions.back();
     sync_fn.name = "sync_fn";
-    sync_fn.return_type = "Void";
+    sync_fn.return_type = mod.context->make<PathType>("Void");
     sync_fn.is_async = false;
     sync_fn.has_body = true;
 
-    std::vector<ExprPtr> args;
-    auto call = std::make_unique<CallExpr>(std::make_unique<IdentifierExpr>("some_async_fn"),
-                                           std::move(args));
-    ExprPtr await_expr = std::make_unique<AwaitExpr>(std::move(call));
-    sync_fn.body.statements.push_back(std::make_unique<ExprStmt>(std::move(await_expr)));
+    AstContext& ctx = *mod.context;
+    auto call =
+        ctx.make<CallExpr>(ctx.make<IdentifierExpr>("some_async_fn"), std::span<ExprPtr>{});
+    ExprPtr await_expr = ctx.make<AwaitExpr>(call);
+    std::vector<StmtPtr> body;
+    body.push_back(ctx.make<ExprStmt>(await_expr));
+    sync_fn.body.statements = ctx.list(std::move(body));
 
     Resolver resolver;
     bool caught = false;
@@ -95,20 +99,21 @@ void test_spawn_valid() {
     mod.functions.emplace_back();
     auto& task_fn = mod.functions.back();
     task_fn.name = "task";
-    task_fn.return_type = "Void";
+    task_fn.return_type = mod.context->make<PathType>("Void");
     task_fn.is_async = true;
 
     mod.functions.emplace_back();
     auto& main_fn = mod.functions.back();
     main_fn.name = "main";
-    main_fn.return_type = "Void";
+    main_fn.return_type = mod.context->make<PathType>("Void");
     main_fn.has_body = true;
 
-    std::vector<ExprPtr> args;
-    auto call =
-        std::make_unique<CallExpr>(std::make_unique<IdentifierExpr>("task"), std::move(args));
-    ExprPtr spawn_expr = std::make_unique<SpawnExpr>(std::move(call));
-    main_fn.body.statements.push_back(std::make_unique<ExprStmt>(std::move(spawn_expr)));
+    AstContext& ctx = *mod.context;
+    auto call = ctx.make<CallExpr>(ctx.make<IdentifierExpr>("task"), std::span<ExprPtr>{});
+    ExprPtr spawn_expr = ctx.make<SpawnExpr>(call);
+    std::vector<StmtPtr> body;
+    body.push_back(ctx.make<ExprStmt>(spawn_expr));
+    main_fn.body.statements = ctx.list(std::move(body));
 
     Resolver resolver;
     resolver.resolve(mod);
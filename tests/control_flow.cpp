@@ -132,6 +132,54 @@ void test_match_exhaustive_init() {
     run_test(code, "test_match_exhaustive_init");
 }
 
+void test_move_in_one_branch() {
+    std::string code = R"(
+        func take(s: String) { }
+        func test(cond: Bool, s: String) {
+            if cond {
+                take(s);
+            } else {
+                take(s);
+            }
+        }
+    )";
+    run_test(code, "test_move_in_one_branch");
+}
+
+void test_use_after_branch_move() {
+    std::string code = R"(
+        func take(s: String) { }
+        func test(cond: Bool, s: String) {
+            if cond {
+                take(s);
+            }
+            take(s);
+        }
+    )";
+    expect_error(code, "test_use_after_branch_move", "moved");
+}
+
+// More locals than fit in one word of the flow state.
+void test_if_init_after_many_locals() {
+    std::string code = "func test(cond: Bool) {\n";
+    for (int i = 0; i < 70; ++i)
+        code += "    let v" + std::to_string(i) + ": Int32 = " + std::to_string(i) + ";\n";
+    code += R"(
+            let x: Int32;
+            let y: Int32;
+            if cond {
+                x = 1;
+                y = 1;
+            } else {
+                x = 2;
+            }
+            let a: Int32 = x;
+            let b: Int32 = y;
+        }
+    )";
+    expect_error(code, "test_if_init_after_many_locals", "uninitialized variable 'y'");
+}
+
 void test_unreachable_code_return() {
     std::string code = R"(
         func test() {
@@ -190,6 +238,9 @@ int main() {
     test_if_exhaustive_init();
     test_if_non_exhaustive_init();
     test_match_exhaustive_init();
+    test_move_in_one_branch();
+    test_use_after_branch_move();
+    test_if_init_after_many_locals();
     test_unreachable_code_return();
     test_unreachable_code_panic();
     test_for_loop_iterator();
@@ -0,0 +1,175 @@
+#include "driver/dependency_graph.h"
+#include "driver/module_cache.h"
+#include "driver/module_loader.h"
+#include "support/version.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+
+using namespace flux;
+
+namespace {
+void write(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream(path) << text;
+}
+
+// app -> mid -> base, and app -> base. app uses nothing of base.
+std::filesystem::path make_project(const std::string& name) {
+    const auto dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "lib");
+    write(dir / "app.fl", "module app;\nimport mid;\nimport lib::base;\n"
+                          "func main() -> Void { twice(1); }\n");
+    write(dir / "mid.fl", "module mid;\nimport lib::base;\n"
+                          "pub func twice(x: Int32) -> Int32 { return x * 2 * one(); }\n");
+    write(dir / "lib" / "base.fl", "module lib::base;\n"
+                                   "pub func one() -> Int32 { return 1; }\n");
+    return dir;
+}
+
+DependencyGraph load_graph(const std::filesystem::path& dir) {
+    ModuleLoader loader;
+    loader.add_search_path(dir);
+    loader.load((dir / "app.fl").string());
+    return DependencyGraph::from_loader(loader);
+}
+
+using Names = std::set<std::string>;
+} // namespace
+
+// Body edits stay in their module; signature edits reach the modules that use them.
+void test_stale_modules() {
+    const auto dir = make_project("flux_dependency_graph");
+    const DependencyGraph first = load_graph(dir);
+    assert(first.modules().size() == 3);
+    assert((first.find("app")->imports == std::vector<std::string>{"mid", "lib::base"}));
+    assert((first.importers("lib::base") == std::vector<std::string>{"app", "mid"}));
+    assert(first.find("app")->uses.size() == 1 && first.find("app")->uses.contains("mid"));
+    assert(first.find("mid")->uses.size() == 1 && first.find("mid")->uses.contains("lib::base"));
+    assert(first.find("lib::base")->uses.empty());
+    assert(load_graph(dir).up_to_date(first));
+
+    write(dir / "lib" / "base.fl", "module lib::base;\n"
+                                   "pub func one() -> Int32 { return 2 - 1; }\n");
+    DependencyGraph edited = load_graph(dir);
+    assert(edited.stale_modules(first) == Names{"lib::base"});
+    assert(!edited.up_to_date(first));
+
+    write(dir / "lib" / "base.fl", "module lib::base;\n"
+                                   "pub func one() -> Int64 { return 1; }\n");
+    edited = load_graph(dir);
+    assert((edited.stale_modules(first) == Names{"mid", "lib::base"}));
+
+    // mid's interface is unchanged by a body edit, so app is not stale through mid.
+    const DependencyGraph second = edited;
+    write(dir / "mid.fl", "module mid;\nimport lib::base;\n"
+                          "pub func twice(x: Int32) -> Int32 { return (x + x) * one(); }\n");
+    assert(load_graph(dir).stale_modules(second) == Names{"mid"});
+
+    // A new module is stale; dropping one is a change even if nothing else is stale.
+    DependencyGraph grown = second;
+    grown.add("extra", {});
+    assert(grown.stale_modules(second) == Names{"extra"});
+    assert(!second.up_to_date(grown));
+    std::filesystem::remove_all(dir);
+}
+
+// Only the declarations a module uses count: new exports do not, the bodies of generic
+// functions do, and so does what a used signature names.
+void test_used_declarations() {
+    const auto dir = make_project("flux_dependency_uses");
+    write(dir / "lib" / "base.fl", "module lib::base;\n"
+                                   "pub struct Pair { a: Int32, b: Int32 }\n"
+                                   "pub func one() -> Int32 { return 1; }\n"
+                                   "pub func first<T>(x: T, y: T) -> T { return x; }\n");
+    write(dir / "mid.fl", "module mid;\nimport lib::base;\n"
+                          "pub func twice(x: Int32) -> Int32 { return first(x, x) * 2; }\n"
+                          "pub func pair() -> Pair { return Pair { a: 1, b: 2 }; }\n");
+    write(dir / "app.fl", "module app;\nimport mid;\n"
+                          "func main() -> Void { pair(); }\n");
+    const DependencyGraph first = load_graph(dir);
+    // app reaches base's Pair through the signature of mid's pair().
+    assert(first.find("app")->uses.contains("lib::base"));
+
+    write(dir / "lib" / "base.fl", "module lib::base;\n"
+                                   "pub struct Pair { a: Int32, b: Int32 }\n"
+                                   "pub func one() -> Int32 { return 1; }\n"
+                                   "pub func two() -> Int32 { return 2; }\n"
+                                   "pub func first<T>(x: T, y: T) -> T { return x; }\n");
+    assert(load_graph(dir).stale_modules(first) == Names{"lib::base"});
+
+    write(dir / "lib" / "base.fl", "module lib::base;\n"
+                                   "pub struct Pair { a: Int32, b: Int32 }\n"
+                                   "pub func one() -> Int32 { return 1; }\n"
+                                   "pub func first<T>(x: T, y: T) -> T { return y; }\n");
+    assert((load_graph(dir).stale_modules(first) == Names{"mid", "lib::base"}));
+
+    write(dir / "lib" / "base.fl", "module lib::base;\n"
+                                   "pub struct Pair { a: Int64, b: Int32 }\n"
+                                   "pub func one() -> Int32 { return 1; }\n"
+                                   "pub func first<T>(x: T, y: T) -> T { return x; }\n");
+    assert((load_graph(dir).stale_modules(first) == Names{"app", "mid", "lib::base"}));
+    std::filesystem::remove_all(dir);
+}
+
+// An import satisfied by a file already loaded under another name points at that module.
+void test_aliased_import() {
+    const auto dir = make_project("flux_dependency_alias");
+    write(dir / "app.fl", "module app;\nimport lib::base;\nimport base;\n");
+    ModuleLoader loader;
+    loader.add_search_path(dir);
+    loader.add_search_path(dir / "lib");
+    loader.load((dir / "app.fl").string());
+    assert(*loader.resolve_import("base") == "lib::base");
+    assert(!loader.resolve_import("nowhere"));
+
+    const DependencyGraph graph = DependencyGraph::from_loader(loader);
+    assert((graph.find("app")->imports == std::vector<std::string>{"lib::base", "lib::base"}));
+    std::filesystem::remove_all(dir);
+}
+
+// The graph and the outputs of a build survive a trip through the cache directory.
+void test_build_record() {
+    const auto dir = make_project("flux_dependency_record");
+    const DependencyGraph graph = load_graph(dir);
+    assert(DependencyGraph::parse(graph.serialize()) == graph);
+    assert(!DependencyGraph::parse("module app 1 2\n"));
+    assert(!DependencyGraph::parse("module app 1 2 0\n"));
+    assert(!DependencyGraph::parse("module app 1 2 1 0\n"));
+    assert(!DependencyGraph::parse("module app 1 2 0 1\nuse mid\n"));
+    assert(!DependencyGraph::parse("module app 1 2 0 0"));
+
+    const ModuleCache cache(dir / "cache");
+    assert(!cache.load_build("app.fl"));
+    ModuleCache::BuildRecord record{graph, {{"ir", "func main\n"}, {"llvm", "; empty\n\n"}}};
+    cache.store_build("app.fl", record);
+    auto loaded = cache.load_build("app.fl");
+    assert(loaded && loaded->graph == graph && loaded->outputs == record.outputs);
+    assert(!cache.load_build("app.fl --emit-ir"));
+
+    // A record written by a compiler built from other sources is not replayed.
+    for (const auto& file : std::filesystem::directory_iterator(dir / "cache")) {
+        std::ifstream in(file.path(), std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        const std::size_t id = bytes.find(kFluxBuildId);
+        assert(id != std::string::npos);
+        bytes[id] = bytes[id] == '0' ? '1' : '0';
+        std::ofstream(file.path(), std::ios::binary) << bytes;
+    }
+    assert(!cache.load_build("app.fl"));
+    std::filesystem::remove_all(dir);
+}
+
+int main() {
+    test_stale_modules();
+    test_used_declarations();
+    test_aliased_import();
+    test_build_record();
+    std::cout << "Dependency graph tests passed.\n";
+    return 0;
+}
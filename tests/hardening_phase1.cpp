@@ -1,8 +1,10 @@
 #include "ast/ast.h"
 #include "lexer/diagnostic.h"
+#include "lexer/source_file.h"
 #include "semantic/resolver.h"
 #include <cassert>
 #include <iostream>
+#include <string>
 
 using namespace flux::ast;
 using namespace flux::semantic;
@@ -14,16 +16,16 @@ void test_compound_assignment() {
     Module mod;
     FunctionDecl main_fn;
     main_fn.name = "main";
-    main_fn.return_type = "Void";
+    main_fn.return_type = mod.context->make<PathType>("Void");
     main_fn.has_body = true;
 
-    main_fn.body.statements.push_back(
-        std::make_unique<LetStmt>("x", "Int32", true, false, std::make_unique<NumberExpr>("10")));
-
-    auto assign = std::make_unique<AssignStmt>(std::make_unique<IdentifierExpr>("x"),
-                                               std::make_unique<NumberExpr>("5"),
-                                               flux::TokenKind::PlusAssign);
-    main_fn.body.statements.push_back(std::move(assign));
+    AstContext& ctx = *mod.context;
+    std::vector<StmtPtr> body;
+    body.push_back(ctx.make<LetStmt>("x", ctx.make<PathType>("Int32"), true, false,
+                                     ctx.make<NumberExpr>("10")));
+    body.push_back(ctx.make<AssignStmt>(ctx.make<IdentifierExpr>("x"), ctx.make<NumberExpr>("5"),
+                                        flux::TokenKind::PlusAssign));
+    main_fn.body.statements = ctx.list(std::move(body));
     mod.functions.push_back(std::move(main_fn));
 
     Resolver resolver;
@@ -38,16 +40,16 @@ void test_compound_assignment_invalid_type() {
     mod.functions.emplace_back();
     auto& main_fn = mod.functions.back();
     main_fn.name = "main";
-    main_fn.return_type = "Void";
+    main_fn.return_type = mod.context->make<PathType>("Void");
     main_fn.has_body = true;
 
-    main_fn.body.statements.push_back(
-        std::make_unique<LetStmt>("s", "String", true, false, std::make_unique<StringExpr>("hi")));
-
-    auto assign = std::make_unique<AssignStmt>(std::make_unique<IdentifierExpr>("s"),
-                                               std::make_unique<NumberExpr>("5"),
-                                               flux::TokenKind::PlusAssign);
-    main_fn.body.statements.push_back(std::move(assign));
+    AstContext& ctx = *mod.context;
+    std::vector<StmtPtr> body;
+    body.push_back(ctx.make<LetStmt>("s", ctx.make<PathType>("String"), true, false,
+                                     ctx.make<StringExpr>("hi")));
+    body.push_back(ctx.make<AssignStmt>(ctx.make<IdentifierExpr>("s"), ctx.make<NumberExpr>("5"),
+                                        flux::TokenKind::PlusAssign));
+    main_fn.body.statements = ctx.list(std::move(body));
 
     Resolver resolver;
     bool caught = false;
@@ -69,22 +71,23 @@ void test_error_location() {
     mod.functions.emplace_back();
     auto& main_fn = mod.functions.back();
     main_fn.name = "main";
-    main_fn.return_type = "Void";
+    main_fn.return_type = mod.context->make<PathType>("Void");
     main_fn.has_body = true;
 
-    auto let =
-        std::make_unique<LetStmt>("x", "Int32", false, false, std::make_unique<StringExpr>("hi"));
-    let->line = 10;
-    let->column = 5;
+    AstContext& ctx = *mod.context;
+    auto let = ctx.make<LetStmt>("x", ctx.make<PathType>("Int32"), false, false,
+                                 ctx.make<StringExpr>("hi"));
+    auto file = flux::SourceFile::from_string("hardening.fl", std::string(9, '\n') + "    let");
+    let->loc = file->loc_at(13);
 
-    main_fn.body.statements.push_back(std::move(let));
+    main_fn.body.statements = ctx.list(std::vector<StmtPtr>{let});
 
     Resolver resolver;
     try {
         resolver.resolve(mod);
         assert(false);
     } catch (const flux::DiagnosticError& e) {
-        if (e.line() != 10 || e.column() != 5) {
+        if (e.file() != "hardening.fl" || e.line() != 10 || e.column() != 5) {
             std::cerr << "Expected error at 10:5, but got " << e.line() << ":" << e.column()
                       << "\n";
             assert(false);
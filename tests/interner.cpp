@@ -0,0 +1,101 @@
+#include "ast/ast.h"
+#include "lexer/interner.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include "semantic/scope.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace flux;
+
+// Equal text gives equal ids; the text round-trips; the empty string is id 0.
+void test_names_compare_by_id() {
+    Name a("counter");
+    Name b(std::string("count") + "er");
+    Name c("counters");
+    assert(a == b && a.id() == b.id());
+    assert(!(a == c));
+    assert(a == "counter" && a.str() == "counter");
+    assert(Name().empty() && Name("").id() == 0);
+    assert(("module::" + a) == "module::counter");
+
+    std::unordered_set<Name> set{a, b, c};
+    assert(set.size() == 2);
+}
+
+// if_interned() never adds strings, so probing with composed text does not grow the table.
+void test_if_interned_does_not_insert() {
+    const std::size_t before = Interner::global().size();
+    assert(Name::if_interned("never_declared_anywhere_4711").empty());
+    assert(Interner::global().size() == before);
+    assert(Name::if_interned("counter") == Name("counter"));
+}
+
+// Threads interning overlapping sets agree on every id, including across segment growth.
+void test_concurrent_interning() {
+    constexpr int kThreads = 4;
+    constexpr int kNames = 5000;
+    std::vector<std::vector<std::uint32_t>> ids(kThreads, std::vector<std::uint32_t>(kNames));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t, &ids] {
+            for (int i = 0; i < kNames; ++i) {
+                const int n = (i + t * kNames / kThreads) % kNames;
+                ids[t][n] = Name("concurrent_" + std::to_string(n)).id();
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    for (int i = 0; i < kNames; ++i) {
+        for (int t = 1; t < kThreads; ++t)
+            assert(ids[t][i] == ids[0][i]);
+        assert(Name("concurrent_" + std::to_string(i)).str() == "concurrent_" + std::to_string(i));
+    }
+}
+
+// A cleared interner forgets every string and hands out ids from 1 again.
+void test_clear() {
+    Interner interner;
+    for (int i = 0; i < 3000; ++i)
+        interner.intern("name_" + std::to_string(i));
+    assert(interner.size() == 3001);
+    interner.clear();
+    assert(interner.size() == 1 && interner.find("name_7") == 0);
+    assert(interner.intern("fresh") == 1 && interner.text(1) == "fresh");
+    assert(interner.intern("name_2999") == 2);
+}
+
+// Parsed identifiers are interned, and scopes resolve them by Name or by text.
+void test_ast_and_scope_use_names() {
+    Lexer lexer("func area(width: Int32) -> Int32 { let w2: Int32 = width * 2; return w2; }");
+    Parser parser(lexer.tokenize());
+    ast::Module module = parser.parse_module();
+    const ast::FunctionDecl& fn = module.functions[0];
+    assert(fn.name == Name("area"));
+    assert(fn.params[0].name == "width");
+
+    semantic::Scope global;
+    semantic::Scope inner(&global, 1);
+    global.declare({fn.name, semantic::SymbolKind::Function});
+    inner.declare({fn.params[0].name, semantic::SymbolKind::Variable});
+    assert(inner.lookup(Name("area")) && inner.lookup("width"));
+    assert(inner.lookup(std::string("area"))->kind == semantic::SymbolKind::Function);
+    assert(!global.lookup("width"));
+    assert(!inner.lookup("never_declared_anywhere_4712"));
+}
+
+int main() {
+    test_names_compare_by_id();
+    test_if_interned_does_not_insert();
+    test_concurrent_interning();
+    test_clear();
+    test_ast_and_scope_use_names();
+    std::cout << "Interner tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "driver/compiler.h"
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace flux;
+
+namespace {
+std::filesystem::path make_project(const std::string& name, const std::string& app) {
+    const auto dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "std");
+    std::ofstream(dir / "app.fl") << app;
+    std::ofstream(dir / "std" / "io.fl")
+        << "module std::io;\nextern func puts(s: String) -> Int32;\n"
+           "pub func println(s: String) { puts(s); }\n";
+    return dir;
+}
+
+struct RunResult {
+    int exit_code;
+    std::string out;    ///< what the compiler wrote to its output stream
+    std::string err;    ///< diagnostics and reports
+    std::string program_output; ///< what the program wrote to file descriptor 1
+};
+
+// Runs `flux run app.fl` in `dir`, capturing the program's standard output in a file.
+RunResult run(const std::filesystem::path& dir, const std::vector<std::string>& flags = {}) {
+    CompileOptions options;
+    options.input = "app.fl";
+    options.working_directory = dir;
+    options.run = true;
+    assert(!parse_compile_flags(flags, options));
+    std::ostringstream out;
+    std::ostringstream err;
+    RunResult result{};
+#ifndef _WIN32
+    const std::filesystem::path captured = dir / "stdout.txt";
+    std::fflush(stdout);
+    const int saved = dup(1);
+    const int file = open(captured.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    dup2(file, 1);
+    close(file);
+    result.exit_code = compile(options, out, err);
+    std::fflush(stdout);
+    dup2(saved, 1);
+    close(saved);
+    std::ifstream in(captured, std::ios::binary);
+    result.program_output.assign(std::istreambuf_iterator<char>(in), {});
+#else
+    result.exit_code = compile(options, out, err);
+#endif
+    result.out = out.str();
+    result.err = err.str();
+    return result;
+}
+} // namespace
+
+// `flux run` returns main's result and prints nothing but the program's own output, which
+// reaches the C library through std::io's extern declaration of puts.
+void test_run_program() {
+    const auto dir = make_project("flux_jit_run", "module app;\nimport std::io;\n"
+                                                  "func main() -> Int32 {\n"
+                                                  "    io::println(\"run by flux\");\n"
+                                                  "    let mut total: Int32 = 0;\n"
+                                                  "    let mut i: Int32 = 0;\n"
+                                                  "    while i < 10 {\n"
+                                                  "        total = total + i;\n"
+                                                  "        i = i + 1;\n"
+                                                  "    }\n"
+                                                  "    return total - 2;\n"
+                                                  "}\n");
+    for (const char* level : {"-O0", "-O2", "-O3"}) {
+        const RunResult result = run(dir, {level});
+        assert(result.exit_code == 43);
+        assert(result.out.empty());
+        assert(result.err.empty());
+#ifndef _WIN32
+        assert(result.program_output == "run by flux\n");
+#endif
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// A Void main exits with 0. --time-passes reports JIT compilation and the run separately.
+void test_run_void_main() {
+    const auto dir = make_project("flux_jit_void", "module app;\n"
+                                                   "func main() -> Void {\n"
+                                                   "    let x: Int32 = 1;\n"
+                                                   "}\n");
+    const RunResult result = run(dir, {"--time-passes"});
+    assert(result.exit_code == 0);
+    assert(result.err.find("JIT compile") != std::string::npos);
+    assert(result.err.find("run") != std::string::npos);
+    std::filesystem::remove_all(dir);
+}
+
+// An extern function that the process does not define is reported, not called.
+void test_run_unresolved_extern() {
+    const auto dir = make_project("flux_jit_unresolved",
+                                  "module app;\n"
+                                  "extern func flux_no_such_function() -> Int32;\n"
+                                  "func main() -> Int32 {\n"
+                                  "    return flux_no_such_function();\n"
+                                  "}\n");
+    const RunResult result = run(dir);
+    assert(result.exit_code == 1);
+    assert(result.err.find("flux_no_such_function") != std::string::npos);
+    std::filesystem::remove_all(dir);
+}
+
+// A program that does not compile is not run.
+void test_run_compile_error() {
+    const auto dir = make_project("flux_jit_error", "module app;\n"
+                                                    "func main() -> Int32 {\n"
+                                                    "    return missing;\n"
+                                                    "}\n");
+    const RunResult result = run(dir);
+    assert(result.exit_code == 1);
+    assert(!result.err.empty());
+    std::filesystem::remove_all(dir);
+}
+
+int main() {
+    test_run_program();
+    test_run_void_main();
+    test_run_unresolved_extern();
+    test_run_compile_error();
+    std::cout << "jit_run tests passed\n";
+    return 0;
+}
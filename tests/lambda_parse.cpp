@@ -11,15 +11,15 @@ using namespace flux::ast;
 void test_parse_lambda() {
     // Tokens for: |x, y| -> Int32 { x }
     std::vector<Token> tokens = {
-        {TokenKind::Pipe, "|", 1, 1},           {TokenKind::Identifier, "x", 1, 2},
-        {TokenKind::Comma, ",", 1, 3},          {TokenKind::Identifier, "y", 1, 4},
-        {TokenKind::Pipe, "|", 1, 5},           {TokenKind::Arrow, "->", 1, 6},
-        {TokenKind::Identifier, "Int32", 1, 7}, {TokenKind::LBrace, "{", 1, 8},
-        {TokenKind::Identifier, "x", 1, 9},     {TokenKind::RBrace, "}", 1, 10},
-        {TokenKind::EndOfFile, "", 1, 11}};
+        {TokenKind::Pipe, "|"},           {TokenKind::Identifier, "x"},
+        {TokenKind::Comma, ","},          {TokenKind::Identifier, "y"},
+        {TokenKind::Pipe, "|"},           {TokenKind::Arrow, "->"},
+        {TokenKind::Identifier, "Int32"}, {TokenKind::LBrace, "{"},
+        {TokenKind::Identifier, "x"},     {TokenKind::RBrace, "}"},
+        {TokenKind::EndOfFile, ""}};
     Parser parser(tokens);
     ExprPtr expr = parser.parse_expression();
-    auto* lambda = dynamic_cast<LambdaExpr*>(expr.get());
+    auto* lambda = dynamic_cast<LambdaExpr*>(expr);
     (void)lambda;
     assert(lambda && "Should parse a LambdaExpr");
     assert(lambda->params.size() == 2);
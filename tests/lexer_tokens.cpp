@@ -0,0 +1,144 @@
+#include "ast/ast.h"
+#include "lexer/diagnostic.h"
+#include "lexer/lexer.h"
+#include "lexer/scan.h"
+#include "parser/parser.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+using namespace flux;
+
+// Lexemes are views into the lexer's source buffer rather than owned copies.
+void test_lexemes_view_source() {
+    const std::string source = "let value_name: Int32 = 1_000; // trailing\n\"hello\" 'c' @test";
+    Lexer lexer(source);
+    auto tokens = lexer.tokenize();
+
+    assert(tokens.size() == 11);
+    assert(tokens[0].kind == TokenKind::Keyword && tokens[0].lexeme == "let");
+    assert(tokens[1].kind == TokenKind::Identifier && tokens[1].lexeme == "value_name");
+    assert(tokens[5].kind == TokenKind::Number && tokens[5].lexeme == "1_000");
+    assert(tokens[7].kind == TokenKind::String && tokens[7].lexeme == "hello");
+    assert(SourceManager::global().presumed(tokens[7].loc).line == 2);
+    assert(tokens[8].kind == TokenKind::Char && tokens[8].lexeme == "c");
+    assert(tokens[9].kind == TokenKind::Annotation && tokens[9].lexeme == "@test");
+    assert(tokens[10].kind == TokenKind::EndOfFile && tokens[10].lexeme.empty());
+
+    // Identifiers, numbers and literals all alias the same buffer: no per-token copies.
+    const std::string_view first = tokens[0].lexeme;
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        const Token& tok = tokens[i];
+        if (tok.kind == TokenKind::Identifier || tok.kind == TokenKind::Number ||
+            tok.kind == TokenKind::String || tok.kind == TokenKind::Keyword) {
+            assert(tok.lexeme.data() >= first.data());
+            assert(tok.lexeme.data() + tok.lexeme.size() <= first.data() + source.size());
+        }
+    }
+}
+
+// The parser copies text into the AST and drops digit separators from number literals.
+void test_parser_owns_ast_text() {
+    std::shared_ptr<ast::AstContext> context;
+    ast::ExprPtr expr = nullptr;
+    {
+        Lexer lexer("0x7F_FF + 1_000.5_0");
+        Parser parser(lexer.tokenize());
+        expr = parser.parse_expression();
+        context = parser.context();
+    }
+    auto* bin = dynamic_cast<ast::BinaryExpr*>(expr);
+    assert(bin);
+    auto* lhs = dynamic_cast<ast::NumberExpr*>(bin->left);
+    auto* rhs = dynamic_cast<ast::NumberExpr*>(bin->right);
+    assert(lhs && lhs->value == "0x7FFF");
+    assert(rhs && rhs->value == "1000.50");
+}
+
+// Keywords are classified by the compile-time perfect hash, including near misses.
+void test_keyword_classification() {
+    assert(classify_keyword("func") == Keyword::Func);
+    assert(classify_keyword("Self") == Keyword::SelfType);
+    assert(classify_keyword("self") == Keyword::SelfValue);
+    assert(classify_keyword("UIntPtr") == Keyword::UIntPtr);
+    assert(classify_keyword("continue") == Keyword::Continue);
+    assert(classify_keyword("fun") == Keyword::None);
+    assert(classify_keyword("funcs") == Keyword::None);
+    assert(classify_keyword("Int256") == Keyword::None);
+    assert(classify_keyword("") == Keyword::None);
+    for (const auto& entry : keyword_detail::table) {
+        assert(classify_keyword(entry.text) == entry.keyword);
+        assert(std::string_view(to_string(entry.keyword)) == entry.text);
+    }
+
+    Lexer lexer("pub extern func where_ Where while");
+    auto tokens = lexer.tokenize();
+    assert(tokens[0].kind == TokenKind::Pub && tokens[0].keyword == Keyword::Pub);
+    assert(tokens[1].kind == TokenKind::Extern && tokens[1].keyword == Keyword::Extern);
+    assert(tokens[2].kind == TokenKind::Keyword && tokens[2].keyword == Keyword::Func);
+    assert(tokens[3].kind == TokenKind::Identifier && tokens[3].keyword == Keyword::None);
+    assert(tokens[4].kind == TokenKind::Identifier && tokens[4].keyword == Keyword::None);
+    assert(tokens[5].kind == TokenKind::Keyword && tokens[5].keyword == Keyword::While);
+}
+
+// Every vector kernel the CPU supports agrees with the scalar reference at every offset,
+// including runs that straddle 16/32-byte block boundaries and bytes >= 0x80.
+void test_scan_kernels_agree() {
+    std::string text;
+    const char* pieces[] = {"   \t\n  ", "identifier_42", "1_000_000", "// comment\n",
+                            "\"str\"", "\xC3\xA9", "@{}[]", "\r\n\v\f", "Z9_"};
+    for (int i = 0; i < 40; ++i)
+        text += pieces[(i * 7) % 9];
+
+    const scan::Kernels& ref = scan::kernels(scan::Isa::Scalar);
+    const char* base = text.data();
+    const char* stop = base + text.size();
+    for (scan::Isa isa : {scan::Isa::SSE2, scan::Isa::AVX2}) {
+        if (!scan::is_supported(isa))
+            continue;
+        const scan::Kernels& k = scan::kernels(isa);
+        for (const char* p = base; p <= stop; ++p) {
+            assert(k.skip_whitespace(p, stop) == ref.skip_whitespace(p, stop));
+            assert(k.skip_identifier(p, stop) == ref.skip_identifier(p, stop));
+            assert(k.skip_digits(p, stop) == ref.skip_digits(p, stop));
+            assert(k.find_line_end(p, stop) == ref.find_line_end(p, stop));
+            assert(k.find_string_end(p, stop) == ref.find_string_end(p, stop));
+            assert(k.count_newlines(p, stop) == ref.count_newlines(p, stop));
+        }
+    }
+}
+
+// Lines and columns resolved from token offsets stay exact when whitespace and comments
+// are skipped in bulk.
+void test_line_and_column_tracking() {
+    Lexer lexer("a\n\n    // comment\n\t  bb  cc\r\n   \n                                      dd");
+    auto tokens = lexer.tokenize();
+    const auto at = [&](std::size_t i, std::uint32_t line, std::uint32_t column) {
+        const PresumedLoc loc = SourceManager::global().presumed(tokens[i].loc);
+        return loc.line == line && loc.column == column;
+    };
+    assert(at(0, 1, 1));
+    assert(at(1, 4, 4));
+    assert(at(2, 4, 8));
+    assert(at(3, 6, 39));
+    assert(tokens[4].kind == TokenKind::EndOfFile && at(4, 6, 41));
+
+    bool threw = false;
+    try {
+        Lexer bad("let s = \"open\nx");
+        bad.tokenize();
+    } catch (const DiagnosticError&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+int main() {
+    test_lexemes_view_source();
+    test_keyword_classification();
+    test_scan_kernels_agree();
+    test_line_and_column_tracking();
+    test_parser_owns_ast_text();
+    std::cout << "Lexer token tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,365 @@
+#include "ast/ast.h"
+#include "ast/ast_serializer.h"
+#include "driver/module_cache.h"
+#include "driver/module_loader.h"
+#include "driver/module_summary.h"
+#include "lexer/diagnostic.h"
+#include "lexer/source_file.h"
+#include "lexer/token_stream.h"
+#include "parser/parser.h"
+#include "semantic/module_declarations.h"
+#include "semantic/resolver.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace flux;
+using namespace flux::ast;
+
+namespace {
+// Most node kinds, declaration kinds and flags the parser produces.
+const char* const kProgram = R"(module sample;
+import std::io;
+
+type Meters = Float64;
+
+pub struct Pair<T> {
+    first: T,
+    second: [T; 2]
+}
+
+class Counter {
+    count: Int32
+}
+
+pub enum Shape<T> where T: Area {
+    Circle(Float64),
+    Rect(T, T),
+    Empty
+}
+
+pub trait Area {
+    type Unit;
+    func area(self) -> Float64;
+}
+
+impl Area for Pair<Int32> {
+    type Unit = Meters;
+    func area(self) -> Float64 { return 0.0; }
+}
+
+extern func puts(s: &String) -> Int32;
+
+pub async func work<T>(a: &mut Pair<T>, f: (Int32) -> Bool) -> Result<Int32, String>
+    where T: Area {
+    let mut x: Int32 = 1 + 2 * 3;
+    const LIMIT: Int32 = 10;
+    let (p, q): (Int32, Bool) = (1, true);
+    let arr: [Int32; 3] = [1, 2, 3];
+    let s: [Int32] = arr[0:2];
+    let y: Float64 = arr[1] as Float64;
+    let c: Char = 'c';
+    let pair: Pair<Int32> = Pair { first: 1, second: [2, 3] };
+    let g: (Int32) -> Int32 = |v: Int32| -> Int32 { v };
+    x += pair.first;
+    if x > LIMIT && !q { x = -x; } else { x = 0; }
+    while x < 5 { x = x + 1; }
+    for i in range(0, 10) { continue; }
+    let r: Int32 = await spawn f(1);
+    loop { break; }
+    match x {
+        0 => {},
+        1 | 2 => {},
+        3..=5 if q => {},
+        n => {},
+        _ => {}
+    }
+    match pair {
+        Pair { first: a, second: _ } => {}
+    }
+    match p {
+        Some((a, _)) => {}
+    }
+    { let moved: Int32 = move x; }
+    return Ok(g(x)?);
+}
+)";
+
+std::unique_ptr<SourceFile> open_sample() {
+    return SourceFile::from_string("sample.fl", kProgram);
+}
+
+Module parse(const SourceFile& source) {
+    Parser parser(std::make_unique<LexerTokenStream>(source));
+    return parser.parse_module();
+}
+
+void write(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream(path) << text;
+}
+} // namespace
+
+// A module read back serializes to the same bytes, so no field is lost or reordered, and
+// its locations point into whichever copy of the text it is read against.
+void test_round_trip() {
+    auto source = open_sample();
+    Module module = parse(*source);
+    const std::string bytes = serialize(module, *source);
+
+    auto reopened = open_sample();
+    assert(reopened->base() != source->base());
+    Module copy = deserialize(bytes, *reopened);
+    assert(serialize(copy, *reopened) == bytes);
+
+    const FunctionDecl& work = copy.functions.back();
+    assert(work.name == "work" && work.is_async && work.visibility == Visibility::Public);
+    assert(spelling(work.return_type) == "Result<Int32, String>");
+    assert(work.where_clause.size() == 1 && work.where_clause[0].param == "T");
+    assert(copy.functions[0].is_external && !copy.functions[0].has_body);
+    assert(copy.classes.size() == 1 && copy.impls[0].trait_name == "Area");
+
+    const SourceLoc original = module.functions.back().body.statements[0]->loc;
+    const SourceLoc loc = work.body.statements[0]->loc;
+    assert(loc.offset - reopened->base() == original.offset - source->base());
+    const PresumedLoc presumed = SourceManager::global().presumed(loc);
+    assert(presumed.file == "sample.fl" && presumed.line == 35);
+
+    // Diagnostics on a read-back module still name the file and line.
+    const std::string bad_text = "func f() -> Void {\n    let x: Nope = 1;\n}\n";
+    auto bad = SourceFile::from_string("bad.fl", bad_text);
+    auto bad_again = SourceFile::from_string("bad.fl", bad_text);
+    Module bad_copy = deserialize(serialize(parse(*bad), *bad), *bad_again);
+    std::string message;
+    try {
+        semantic::Resolver().resolve(bad_copy);
+    } catch (const DiagnosticError& e) {
+        message = e.what();
+    }
+    assert(message.find("bad.fl:2:") != std::string::npos);
+}
+
+// Truncated, altered and foreign input is rejected rather than misread.
+void test_corrupt_input() {
+    auto source = open_sample();
+    const std::string bytes = serialize(parse(*source), *source);
+    for (std::size_t size = 0; size < bytes.size(); ++size) {
+        bool threw = false;
+        try {
+            deserialize(std::string_view(bytes).substr(0, size), *source);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    std::string other_version = bytes;
+    other_version[4] = static_cast<char>(kSerializationVersion + 1);
+    bool threw = false;
+    try {
+        deserialize(other_version, *source);
+    } catch (const std::runtime_error& e) {
+        threw = std::string(e.what()).find("version") != std::string::npos;
+    }
+    assert(threw);
+}
+
+// The summary changes with the interface and only with it.
+void test_summary() {
+    auto summary_of = [](const std::string& text) {
+        auto source = SourceFile::from_string("m.fl", text);
+        return summarize(parse(*source));
+    };
+    const ModuleSummary base = summary_of("pub func f(a: Int32) -> Int32 { return a; }\n"
+                                          "func g() -> Void {}\n"
+                                          "pub struct S { x: Int32 }\n");
+    assert(base.declarations.size() == 2);
+    assert(base.declarations[0] == "pub func f(a: Int32) -> Int32");
+    assert(base.declarations[1] == "pub struct S { x: Int32 }");
+
+    // Bodies, private declarations and layout of the text do not matter...
+    assert(summary_of("pub func f(a: Int32) -> Int32 { return a + 1; }\n"
+                      "func g() -> Int32 { return 0; }\n\n"
+                      "pub struct S {\n    x: Int32\n}\n") == base);
+    // ...signatures and fields do.
+    assert(summary_of("pub func f(a: Int64) -> Int32 { return 0; }\n"
+                      "pub struct S { x: Int32 }\n")
+               .interface_hash != base.interface_hash);
+    assert(summary_of("pub func f(a: Int32) -> Int32 { return a; }\n"
+                      "pub struct S { x: Int32, y: Int32 }\n")
+               .interface_hash != base.interface_hash);
+}
+
+// A second loader with the same cache reads every module back instead of parsing it, and
+// ends up with the same modules; an edited file is parsed again.
+void test_warm_load() {
+    const auto dir = std::filesystem::temp_directory_path() / "flux_module_cache";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "src" / "std");
+    write(dir / "src" / "app.fl", "module app;\nimport lib;\npub func main() -> Void {}\n");
+    write(dir / "src" / "lib.fl", "module lib;\npub func answer() -> Int32 { return 42; }\n");
+    write(dir / "src" / "sample.fl", kProgram);
+    write(dir / "src" / "std" / "io.fl",
+          "module std::io;\npub func println(s: String) -> Void {}\n");
+    const ModuleCache cache(dir / "cache");
+
+    auto load = [&](unsigned jobs) {
+        auto loader = std::make_unique<ModuleLoader>();
+        loader->set_jobs(jobs);
+        loader->set_cache(&cache);
+        loader->add_search_path(dir / "src");
+        loader->load((dir / "src" / "app.fl").string());
+        loader->load("sample");
+        return loader;
+    };
+
+    auto cold = load(1);
+    assert(cold->stats().files_read == 4 && cold->stats().disk_cache_hits == 0);
+
+    for (unsigned jobs : {1u, 4u}) {
+        auto warm = load(jobs);
+        assert(warm->stats().files_read == 4 && warm->stats().disk_cache_hits == 4);
+        assert(warm->stats().bytes_lexed == 0);
+        for (const auto& [name, module] : cold->modules()) {
+            const Module& other = warm->modules().at(name);
+            assert(serialize(other, *warm->source(name)) ==
+                   serialize(module, *cold->source(name)));
+            assert(*warm->summary(name) == *cold->summary(name));
+        }
+    }
+
+    write(dir / "src" / "lib.fl", "module lib;\npub func answer() -> Int64 { return 42; }\n");
+    auto edited = load(1);
+    assert(edited->stats().disk_cache_hits == 3);
+    assert(edited->summary("lib")->interface_hash != cold->summary("lib")->interface_hash);
+
+    // A damaged entry is a miss, and is replaced.
+    const auto entry = cache.entry_path(*edited->content_hash("lib"));
+    assert(std::filesystem::exists(entry));
+    write(entry, "flux-module\ngarbage");
+    assert(load(1)->stats().disk_cache_hits == 3);
+    assert(load(1)->stats().disk_cache_hits == 4);
+
+    std::filesystem::remove_all(dir);
+}
+
+// The declarations of a module, read back from the cache against a fresh copy of its AST
+// and replayed, leave the resolver as declaring it does.
+void test_declarations() {
+    const auto dir = std::filesystem::temp_directory_path() / "flux_module_declarations";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "src");
+    write(dir / "src" / "app.fl", "module app;\nimport shapes;\n"
+                                  "pub func main() -> Int32 {\n"
+                                  "    return shapes::pick(shapes::size(), 1);\n"
+                                  "}\n");
+    write(dir / "src" / "shapes.fl",
+          "module shapes;\n"
+          "type Meters = Int32;\n"
+          "pub struct Point { x: Int32, y: Int32 }\n"
+          "pub enum Shape { Dot(Int32), Empty }\n"
+          "pub trait Area { func area(self) -> Int32; }\n"
+          "impl Area for Point {\n"
+          "    pub func area(self) -> Int32 { return self.x * self.y; }\n"
+          "}\n"
+          "pub trait Convert<T> { func convert(self) -> T; }\n"
+          "impl Convert<Int32> for Point {\n"
+          "    pub func convert(self) -> Int32 { return self.x; }\n"
+          "}\n"
+          "pub func pick<T>(a: T, b: T) -> T { return a; }\n"
+          "pub func wrap(m: Meters) -> Option<Int32> { return Some(m); }\n"
+          "pub func size() -> Int32 {\n"
+          "    let p: Point = Point { x: 2, y: 3 };\n"
+          "    return p.area();\n"
+          "}\n");
+    const ModuleCache cache(dir / "cache");
+
+    auto load = [&] {
+        auto loader = std::make_unique<ModuleLoader>();
+        loader->set_cache(&cache);
+        loader->add_search_path(dir / "src");
+        loader->load((dir / "src" / "app.fl").string());
+        return loader;
+    };
+    auto modules_of = [](ModuleLoader& loader) {
+        std::vector<Module*> modules;
+        for (auto& [name, module] : const_cast<std::map<std::string, Module>&>(loader.modules()))
+            modules.push_back(&module);
+        return modules;
+    };
+
+    auto cold = load();
+    semantic::Resolver declared;
+    declared.set_record_declarations(true);
+    declared.resolve(modules_of(*cold));
+    assert(declared.replayed_modules() == 0);
+    for (const auto& [name, module] : cold->modules())
+        cache.store_declarations(*cold->content_hash(name), module, *declared.declarations(module));
+    const Module& cold_shapes = cold->modules().at("shapes");
+    const std::string& bytes = *declared.declarations(cold_shapes);
+    const semantic::ModuleDeclarations shapes =
+        *semantic::deserialize_declarations(bytes, cold_shapes);
+    assert(semantic::serialize(shapes, cold_shapes) == bytes);
+    assert(shapes.struct_fields.size() == 3 && shapes.trait_methods.size() == 2);
+    assert(shapes.trait_impls.size() == 2 && shapes.type_aliases.size() == 1);
+    assert(shapes.function_decls.size() == 5 && !shapes.type_instantiations.empty());
+    assert(shapes.function_decls[0].second == &cold_shapes.functions[0]);
+
+    // The second loader reads the ASTs back from the cache, so the records are read back
+    // against other nodes than they were made from.
+    auto warm = load();
+    assert(warm->stats().disk_cache_hits == 2);
+    semantic::Resolver replayed;
+    replayed.set_record_declarations(true);
+    for (const auto& [name, module] : warm->modules()) {
+        std::optional<std::string> record = cache.load_declarations(*warm->content_hash(name),
+                                                                    module);
+        assert(record && *record == *declared.declarations(cold->modules().at(name)));
+        replayed.reuse_declarations(module, std::move(*record));
+    }
+    replayed.resolve(modules_of(*warm));
+    assert(replayed.replayed_modules() == 2 && !replayed.declarations(warm->modules().at("app")));
+    assert(replayed.symbol_count() == declared.symbol_count());
+    assert(replayed.scope_count() == declared.scope_count());
+    assert(replayed.type_instantiations() == declared.type_instantiations());
+    assert(replayed.function_instantiations() == declared.function_instantiations());
+    assert(replayed.function_decls().size() == declared.function_decls().size());
+    for (const auto& [name, fn] : replayed.function_decls())
+        assert(fn->name == declared.function_decls().at(name)->name);
+
+    // A record made after other declarations than the resolver has made is not replayed,
+    // nor is a damaged one: both modules are declared instead.
+    const Module& app = warm->modules().at("app");
+    const Module& warm_shapes = warm->modules().at("shapes");
+    semantic::ModuleDeclarations stale =
+        *semantic::deserialize_declarations(*declared.declarations(cold->modules().at("app")),
+                                            app);
+    ++stale.context;
+    semantic::Resolver other;
+    other.set_record_declarations(true);
+    other.reuse_declarations(app, *semantic::serialize(stale, app));
+    other.reuse_declarations(warm_shapes, bytes.substr(0, bytes.size() - 1));
+    other.resolve(modules_of(*warm));
+    assert(other.replayed_modules() == 0 && *other.declarations(warm_shapes) == bytes);
+
+    // Records are stored per module name, and truncated ones do not read back.
+    assert(!cache.load_declarations(*warm->content_hash("shapes"), app));
+    for (std::size_t size = 0; size < bytes.size(); ++size) {
+        const std::string_view truncated = std::string_view(bytes).substr(0, size);
+        assert(!semantic::deserialize_declarations(truncated, warm_shapes));
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+int main() {
+    test_round_trip();
+    test_corrupt_input();
+    test_summary();
+    test_warm_load();
+    test_declarations();
+    std::cout << "Module cache tests passed.\n";
+    return 0;
+}
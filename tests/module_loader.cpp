@@ -0,0 +1,276 @@
+#include "ast/ast.h"
+#include "driver/module_loader.h"
+#include "lexer/diagnostic.h"
+#include "support/hash.h"
+#include "support/thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace flux;
+
+namespace {
+std::filesystem::path make_project(const std::string& name) {
+    const auto dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "lib");
+    return dir;
+}
+
+void write(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream(path) << text;
+}
+
+// app imports a diamond (left, right -> lib::base) plus a chain of `chain` modules.
+std::filesystem::path make_graph(const std::string& name, int chain) {
+    const auto dir = make_project(name);
+    std::string app = "module app;\nimport left;\nimport right;\n";
+    for (int i = 0; i < chain; ++i)
+        app += "import c" + std::to_string(i) + ";\n";
+    write(dir / "app.fl", app + "func main() -> Void {}\n");
+    write(dir / "left.fl", "module left;\nimport lib::base;\nfunc l() -> Void {}\n");
+    write(dir / "right.fl", "module right;\nimport lib::base;\nfunc r() -> Void {}\n");
+    write(dir / "lib" / "base.fl", "module lib::base;\nfunc b() -> Void {}\n");
+    for (int i = 0; i < chain; ++i) {
+        std::string text = "module c" + std::to_string(i) + ";\n";
+        if (i + 1 < chain)
+            text += "import c" + std::to_string(i + 1) + ";\n";
+        write(dir / ("c" + std::to_string(i) + ".fl"), text + "func f() -> Void {}\n");
+    }
+    return dir;
+}
+
+std::string load_error(const std::filesystem::path& dir, unsigned jobs) {
+    ModuleLoader loader;
+    loader.set_jobs(jobs);
+    loader.add_search_path(dir);
+    try {
+        loader.load((dir / "app.fl").string());
+    } catch (const std::exception& e) {
+        return e.what();
+    }
+    return "";
+}
+} // namespace
+
+// Every submitted task runs, including tasks submitted by other tasks, before wait()
+// returns.
+void test_thread_pool() {
+    std::atomic<int> ran{0};
+    ThreadPool pool(4);
+    assert(pool.size() == 4);
+    for (int i = 0; i < 100; ++i) {
+        pool.submit([&] {
+            ++ran;
+            pool.submit([&] { ++ran; });
+        });
+    }
+    pool.wait();
+    assert(ran == 200);
+    assert(ThreadPool::default_threads() >= 1);
+}
+
+// A parallel load finds the same modules, each parsed once, as a serial one.
+void test_parallel_matches_serial() {
+    const auto dir = make_graph("flux_loader_graph", 20);
+    std::vector<std::string> serial_names;
+    {
+        ModuleLoader loader;
+        loader.add_search_path(dir);
+        loader.load((dir / "app.fl").string());
+        for (const auto& [name, module] : loader.modules())
+            serial_names.push_back(name);
+    }
+    assert(serial_names.size() == 24);
+
+    for (unsigned jobs : {0u, 2u, 8u}) {
+        ModuleLoader loader;
+        loader.set_jobs(jobs);
+        loader.add_search_path(dir);
+        ast::Module* app = loader.load((dir / "app.fl").string());
+        assert(app && app->name == "app");
+
+        std::vector<std::string> names;
+        for (const auto& [name, module] : loader.modules())
+            names.push_back(name);
+        assert(names == serial_names);
+        assert(loader.modules().at("lib::base").functions[0].name == "b");
+        assert(loader.source("c19") != nullptr);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// Cycles, missing modules and parse errors are reported as a serial load reports them.
+void test_parallel_errors() {
+    auto dir = make_project("flux_loader_cycle");
+    write(dir / "app.fl", "module app;\nimport a;\nfunc main() -> Void {}\n");
+    write(dir / "a.fl", "module a;\nimport b;\n");
+    write(dir / "b.fl", "module b;\nimport a;\n");
+    std::string serial = load_error(dir, 1);
+    assert(serial.find("circular dependency") != std::string::npos);
+    assert(load_error(dir, 4) == serial);
+    std::filesystem::remove_all(dir);
+
+    dir = make_project("flux_loader_missing");
+    write(dir / "app.fl", "module app;\nimport a;\nfunc main() -> Void {}\n");
+    write(dir / "a.fl", "module a;\nimport nowhere;\n");
+    serial = load_error(dir, 1);
+    assert(serial == "flux: could not find module: nowhere");
+    assert(load_error(dir, 4) == serial);
+
+    // A name too long for the file system is missing too, and must not escape a worker.
+    const std::string long_name(300, 'x');
+    write(dir / "a.fl", "module a;\nimport " + long_name + ";\n");
+    serial = load_error(dir, 1);
+    assert(serial == "flux: could not find module: " + long_name);
+    assert(load_error(dir, 4) == serial);
+    std::filesystem::remove_all(dir);
+
+    // Both imports fail to parse; the first in import order is the one reported.
+    dir = make_project("flux_loader_parse_error");
+    write(dir / "app.fl", "module app;\nimport a;\nimport b;\nfunc main() -> Void {}\n");
+    write(dir / "a.fl", "module a;\nfunc f() -> Void { let = 1; }\n");
+    write(dir / "b.fl", "module b;\nfunc g( -> Void {}\n");
+    serial = load_error(dir, 1);
+    assert(serial.find("a.fl") != std::string::npos);
+    assert(load_error(dir, 4) == serial);
+    std::filesystem::remove_all(dir);
+}
+
+// Each file is read once per loader, however many modules import it and whether it is
+// reached by name, by path, or through a second search path. Repeats of any of those
+// names touch no file.
+void test_repeated_imports_are_cached() {
+    const auto dir = make_graph("flux_loader_cache", 1);
+    write(dir / "extra.fl", "module extra;\nimport base;\nimport lib::base;\n");
+
+    std::uintmax_t graph_bytes = 0;
+    for (const char* file : {"app.fl", "left.fl", "right.fl", "lib/base.fl", "c0.fl"})
+        graph_bytes += std::filesystem::file_size(dir / file);
+
+    for (unsigned jobs : {1u, 4u}) {
+        ModuleLoader loader;
+        loader.set_jobs(jobs);
+        loader.add_search_path(dir);
+        loader.add_search_path(dir / "lib");
+        loader.load((dir / "app.fl").string());
+
+        // lib::base is imported twice but read once.
+        assert(loader.stats().files_read == 5);
+        assert(loader.stats().bytes_lexed == graph_bytes);
+        assert(loader.stats().cache_hits == 1);
+
+        // By name and by (another spelling of the) path: no file is touched.
+        assert(loader.load("lib::base") == &loader.modules().at("lib::base"));
+        assert(loader.load((dir / "lib" / ".." / "app.fl").string()) ==
+               &loader.modules().at("app"));
+        assert(loader.stats().files_read == 5 && loader.stats().cache_hits == 3);
+
+        // `base` resolves to lib/base.fl through the second search path.
+        loader.load("extra");
+        assert(loader.stats().files_read == 6);
+        assert(!loader.modules().count("base"));
+
+        // Repeats of an alias are answered from the index: with lib/ gone, neither the
+        // path through it nor `base` could be found again.
+        const std::size_t hits = loader.stats().cache_hits;
+        std::filesystem::rename(dir / "lib", dir / "lib.moved");
+        assert(loader.load((dir / "lib" / ".." / "app.fl").string()) ==
+               &loader.modules().at("app"));
+        assert(loader.load("base") == &loader.modules().at("lib::base"));
+        std::filesystem::rename(dir / "lib.moved", dir / "lib");
+        assert(loader.stats().files_read == 6 && loader.stats().cache_hits == hits + 2);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// Content hashes follow the text, not the file name.
+void test_content_hash() {
+    const auto dir = make_project("flux_loader_hash");
+    const std::string text = "module same;\nfunc f() -> Void {}\n";
+    write(dir / "app.fl", "module app;\nimport same;\nimport other;\n");
+    write(dir / "same.fl", text);
+    write(dir / "other.fl", "module other;\nfunc f() -> Void {}\n");
+
+    ModuleLoader loader;
+    loader.add_search_path(dir);
+    loader.load((dir / "app.fl").string());
+    assert(loader.content_hash("same") == hash_bytes(text));
+    assert(loader.content_hash("other") != loader.content_hash("same"));
+    assert(!loader.content_hash("missing"));
+    std::filesystem::remove_all(dir);
+
+    assert(hash_bytes("") != hash_bytes(std::string(1, '\0')));
+    assert(hash_bytes("abcdefgh1") != hash_bytes("abcdefgh2"));
+}
+
+// A kept loader re-parses only edited files, follows changed imports, and forgets modules
+// that are no longer reached.
+void test_reload() {
+    const auto dir = make_graph("flux_loader_reload", 2);
+    // Rewrites happen within one clock tick of the first read; move the time on so the
+    // edit is seen without relying on timestamp resolution.
+    auto edit = [&](const std::string& file, const std::string& text) {
+        const auto before = std::filesystem::last_write_time(dir / file);
+        write(dir / file, text);
+        std::filesystem::last_write_time(dir / file, before + std::chrono::seconds(1));
+    };
+
+    ModuleLoader loader;
+    loader.add_search_path(dir);
+    const std::string entry = (dir / "app.fl").string();
+    loader.load(entry);
+    assert(loader.modules().size() == 6 && loader.stats().files_read == 6);
+
+    // Nothing changed, or only the timestamp did: nothing is parsed again.
+    loader.reload(entry);
+    std::filesystem::last_write_time(dir / "left.fl",
+                                     std::filesystem::last_write_time(dir / "left.fl") +
+                                         std::chrono::seconds(1));
+    loader.reload(entry);
+    assert(loader.stats().files_read == 6);
+
+    // A body edit re-reads that file only.
+    edit("lib/base.fl", "module lib::base;\nfunc b() -> Void { return; }\n");
+    loader.reload(entry);
+    assert(loader.stats().files_read == 7);
+    assert(loader.modules().size() == 6);
+
+    // Dropping an import prunes the chain behind it; adding one back loads it again.
+    edit("app.fl", "module app;\nimport left;\nimport right;\nfunc main() -> Void {}\n");
+    ast::Module* app = loader.reload(entry);
+    assert(app == &loader.modules().at("app"));
+    assert(loader.modules().size() == 4 && !loader.modules().count("c0"));
+    edit("app.fl", "module app;\nimport c1;\n");
+    loader.reload(entry);
+    assert(loader.modules().size() == 2 && loader.modules().count("c1"));
+
+    // An edit that closes a cycle through unchanged modules is still reported.
+    edit("app.fl", "module app;\nimport left;\n");
+    edit("lib/base.fl", "module lib::base;\nimport app;\n");
+    bool threw = false;
+    try {
+        loader.reload(entry);
+    } catch (const std::runtime_error& e) {
+        threw = std::string(e.what()).find("circular dependency") != std::string::npos;
+    }
+    assert(threw);
+    std::filesystem::remove_all(dir);
+}
+
+int main() {
+    test_thread_pool();
+    test_parallel_matches_serial();
+    test_parallel_errors();
+    test_repeated_imports_are_cached();
+    test_content_hash();
+    test_reload();
+    std::cout << "Module loader tests passed.\n";
+    return 0;
+}
@@ -26,9 +26,9 @@ void test_transitive_monomorphization() {
     bool found_foo = false;
     bool found_bar = false;
     for (const auto& inst : insts) {
-        if (inst.name == "foo" && inst.args.size() == 1 && inst.args[0].name == "Int32")
+        if (inst.name == "foo" && inst.args.size() == 1 && inst.args[0]->name == "Int32")
             found_foo = true;
-        if (inst.name == "bar" && inst.args.size() == 1 && inst.args[0].name == "Int32")
+        if (inst.name == "bar" && inst.args.size() == 1 && inst.args[0]->name == "Int32")
             found_bar = true;
     }
 
@@ -66,13 +66,13 @@ void test_method_monomorphization() {
 
         if (inst.name == "Wrapper::call_other") {
             // Expecting T=Float32, U=Int32
-            if (inst.args.size() == 2 && inst.args[0].name == "Float32" &&
-                inst.args[1].name == "Int32")
+            if (inst.args.size() == 2 && inst.args[0]->name == "Float32" &&
+                inst.args[1]->name == "Int32")
                 found_call_other = true;
         }
         if (inst.name == "Wrapper::get") {
             // Expecting T=Float32
-            if (inst.args.size() == 1 && inst.args[0].name == "Float32")
+            if (inst.args.size() == 1 && inst.args[0]->name == "Float32")
                 found_get = true;
         }
     }
@@ -82,10 +82,38 @@ void test_method_monomorphization() {
     std::cout << "  Passed!" << std::endl;
 }
 
+void test_repeated_instantiation_recorded_once() {
+    std::cout << "Testing repeated instantiations are recorded once..." << std::endl;
+    std::string code = R"(
+        func id<T>(x: T) -> T { return x; }
+        func main() {
+            let a: Int32 = id<Int32>(1);
+            let b: Bool = id<Bool>(true);
+            let c: Int32 = id<Int32>(2);
+            let d: Bool = id<Bool>(false);
+        }
+    )";
+
+    flux::Lexer lexer(code);
+    flux::Parser parser(lexer.tokenize());
+    auto module = parser.parse_module();
+
+    Resolver resolver;
+    resolver.resolve(module);
+
+    const auto& insts = resolver.function_instantiations();
+    assert(insts.size() == 2 && "id<Int32> and id<Bool> should each be recorded once");
+    // Recorded in order of first use.
+    assert(insts[0].name == "id" && insts[0].args[0]->name == "Int32");
+    assert(insts[1].name == "id" && insts[1].args[0]->name == "Bool");
+    std::cout << "  Passed!" << std::endl;
+}
+
 int main() {
     try {
         test_transitive_monomorphization();
         test_method_monomorphization();
+        test_repeated_instantiation_recorded_once();
         std::cout << "All monomorphization tests passed!" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Test failed: " << e.what() << std::endl;
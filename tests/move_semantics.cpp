@@ -10,6 +10,7 @@ using namespace flux::ast;
 using namespace flux::semantic;
 
 void test_explicit_move() {
+    AstContext ctx;
     Resolver resolver;
     resolver.enter_scope();
 
@@ -18,13 +19,13 @@ void test_explicit_move() {
         {"a", SymbolKind::Variable, false, false, false, true, Visibility::None, "", "String"});
 
     // move a
-    auto a_expr = std::make_unique<IdentifierExpr>("a");
-    auto move_expr = std::make_unique<MoveExpr>(std::move(a_expr));
+    auto a_expr = ctx.make<IdentifierExpr>("a");
+    auto move_expr = ctx.make<MoveExpr>(a_expr);
 
     resolver.resolve_expression(*move_expr);
 
     // use a -> Error
-    auto use_a = std::make_unique<IdentifierExpr>("a");
+    auto use_a = ctx.make<IdentifierExpr>("a");
     try {
         resolver.resolve_expression(*use_a);
         assert(false && "Should have thrown use-after-move error");
@@ -38,6 +39,7 @@ void test_explicit_move() {
 }
 
 void test_implicit_move_assignment() {
+    AstContext ctx;
     Resolver resolver;
     resolver.enter_scope();
 
@@ -46,8 +48,8 @@ void test_implicit_move_assignment() {
         {"a", SymbolKind::Variable, false, false, false, true, Visibility::None, "", "String"});
 
     // let b: String = a
-    auto let = std::make_unique<LetStmt>("b", "String", false, false,
-                                         std::make_unique<IdentifierExpr>("a"));
+    auto let = ctx.make<LetStmt>("b", ctx.make<PathType>("String"), false, false,
+                                 ctx.make<IdentifierExpr>("a"));
 
     // resolve_statement checks compatibility and marks 'a' as moved
     // Mock type_of("a") returning String
@@ -61,7 +63,7 @@ void test_implicit_move_assignment() {
     resolver.resolve_statement(*let);
 
     // use a -> Error
-    auto use_a = std::make_unique<IdentifierExpr>("a");
+    auto use_a = ctx.make<IdentifierExpr>("a");
     try {
         resolver.resolve_expression(*use_a);
         assert(false && "Should have thrown use-after-move error");
@@ -75,6 +77,7 @@ void test_implicit_move_assignment() {
 }
 
 void test_copy_semantics() {
+    AstContext ctx;
     Resolver resolver;
     resolver.enter_scope();
 
@@ -83,21 +86,22 @@ void test_copy_semantics() {
         {"i", SymbolKind::Variable, false, false, false, true, Visibility::None, "", "Int32"});
 
     // let j: Int32 = i
-    auto let = std::make_unique<LetStmt>("j", "Int32", false, false,
-                                         std::make_unique<IdentifierExpr>("i"));
+    auto let = ctx.make<LetStmt>("j", ctx.make<PathType>("Int32"), false, false,
+                                 ctx.make<IdentifierExpr>("i"));
 
     resolver.resolve_statement(*let);
 
     // use i -> OK
-    auto use_i = std::make_unique<IdentifierExpr>("i");
-    FluxType t = resolver.type_of(*use_i);
-    assert(t.name == "Int32");
+    auto use_i = ctx.make<IdentifierExpr>("i");
+    TypeId t = resolver.type_of(*use_i);
+    assert(t->name == "Int32");
 
     resolver.exit_scope();
     std::cout << "test_copy_semantics passed\n";
 }
 
 void test_revival() {
+    AstContext ctx;
     Resolver resolver;
     resolver.enter_scope();
 
@@ -106,13 +110,13 @@ void test_revival() {
         {"a", SymbolKind::Variable, true, false, false, true, Visibility::None, "", "String"});
 
     // move a (manually)
-    auto a_expr = std::make_unique<IdentifierExpr>("a");
-    auto move_expr = std::make_unique<MoveExpr>(std::move(a_expr));
+    auto a_expr = ctx.make<IdentifierExpr>("a");
+    auto move_expr = ctx.make<MoveExpr>(a_expr);
     resolver.resolve_expression(*move_expr);
 
     // check it is moved
     try {
-        auto use_a = std::make_unique<IdentifierExpr>("a");
+        auto use_a = ctx.make<IdentifierExpr>("a");
         resolver.resolve_expression(*use_a);
         assert(false && "Should be moved");
     } catch (...) {
@@ -124,21 +128,22 @@ void test_revival() {
     // 2. Revival
 
     auto assign =
-        std::make_unique<AssignStmt>(std::make_unique<IdentifierExpr>("a"),
-                                     std::make_unique<StringExpr>("val"), TokenKind::Assign);
+        ctx.make<AssignStmt>(ctx.make<IdentifierExpr>("a"), ctx.make<StringExpr>("val"),
+                             TokenKind::Assign);
 
     resolver.resolve_statement(*assign);
 
     // use a -> OK
-    auto use_a_again = std::make_unique<IdentifierExpr>("a");
-    FluxType t = resolver.type_of(*use_a_again);
-    assert(t.name == "String");
+    auto use_a_again = ctx.make<IdentifierExpr>("a");
+    TypeId t = resolver.type_of(*use_a_again);
+    assert(t->name == "String");
 
     resolver.exit_scope();
     std::cout << "test_revival passed\n";
 }
 
 void test_implicit_move_call() {
+    AstContext ctx;
     Resolver resolver;
     resolver.enter_scope(); // main scope
 
@@ -160,14 +165,13 @@ void test_implicit_move_call() {
 
     // take(a)
     std::vector<ExprPtr> args;
-    args.push_back(std::make_unique<IdentifierExpr>("a"));
-    auto call =
-        std::make_unique<CallExpr>(std::make_unique<IdentifierExpr>("take"), std::move(args));
+    args.push_back(ctx.make<IdentifierExpr>("a"));
+    auto call = ctx.make<CallExpr>(ctx.make<IdentifierExpr>("take"), ctx.list(std::move(args)));
 
     resolver.resolve_expression(*call);
 
     // use a -> Error
-    auto use_a = std::make_unique<IdentifierExpr>("a");
+    auto use_a = ctx.make<IdentifierExpr>("a");
     try {
         resolver.resolve_expression(*use_a);
         assert(false && "Should have thrown use-after-move error");
@@ -181,6 +185,7 @@ void test_implicit_move_call() {
 }
 
 void test_implicit_move_struct() {
+    AstContext ctx;
     Resolver resolver;
     resolver.enter_scope();
 
@@ -193,7 +198,8 @@ void test_implicit_move_struct() {
     // However, Resolver::resolve(Module) populates them.
 
     Module mod;
-    mod.structs.push_back(StructDecl("Wrapper", {}, {{"val", "String", Visibility::Public}}));
+    mod.structs.push_back(StructDecl(
+        "Wrapper", {}, {{"val", mod.context->make<PathType>("String"), Visibility::Public}}));
 
     resolver.resolve(mod); // This clears scopes and sets up builtins
 
@@ -207,13 +213,13 @@ void test_implicit_move_struct() {
 
     // Wrapper { val: a }
     std::vector<FieldInit> fields;
-    fields.push_back({"val", std::make_unique<IdentifierExpr>("a")});
-    auto lit = std::make_unique<StructLiteralExpr>("Wrapper", std::move(fields));
+    fields.push_back({"val", ctx.make<IdentifierExpr>("a")});
+    auto lit = ctx.make<StructLiteralExpr>("Wrapper", ctx.list(std::move(fields)));
 
     resolver.resolve_expression(*lit);
 
     // use a -> Error
-    auto use_a = std::make_unique<IdentifierExpr>("a");
+    auto use_a = ctx.make<IdentifierExpr>("a");
     try {
         resolver.resolve_expression(*use_a);
         assert(false && "Should have thrown use-after-move error");
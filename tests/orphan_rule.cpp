@@ -54,27 +54,29 @@ void test_external_trait_local_type_pass() {
     // struct S {}
     // impl Display for S { func to_string(&self) -> String { ... } }
 
+    Module mod;
+    mod.name = "test";
     StructDecl s_decl("S", {}, {});
 
     // Implement to_string for Display
     FunctionDecl to_string_fn;
     to_string_fn.name = "to_string";
-    to_string_fn.params.push_back({"self", "&self"});
-    to_string_fn.return_type = "String";
+    to_string_fn.params.push_back(
+        {"self", mod.context->make<RefType>(false, mod.context->make<PathType>("Self"))});
+    to_string_fn.return_type = mod.context->make<PathType>("String");
     to_string_fn.visibility = Visibility::Public;
 
     // Dummy body
-    Block body;
-    body.statements.push_back(std::make_unique<ReturnStmt>(std::make_unique<StringExpr>("S")));
-    to_string_fn.body = std::move(body);
+    AstContext& ctx = *mod.context;
+    std::vector<StmtPtr> body;
+    body.push_back(ctx.make<ReturnStmt>(ctx.make<StringExpr>("S")));
+    to_string_fn.body.statements = ctx.list(std::move(body));
     to_string_fn.has_body = true;
 
     ImplBlock impl({}, "S", {});
     impl.trait_name = "Display";
     impl.methods.push_back(std::move(to_string_fn));
 
-    Module mod;
-    mod.name = "test";
     mod.structs.push_back(std::move(s_decl));
     mod.impls.push_back(std::move(impl));
 
@@ -0,0 +1,168 @@
+#include "lexer/diagnostic.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include "semantic/resolver.h"
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace flux::semantic;
+
+namespace {
+flux::ast::Module parse(const std::string& code) {
+    flux::Lexer lexer(code);
+    flux::Parser parser(lexer.tokenize());
+    return parser.parse_module();
+}
+
+std::string resolve_error(const flux::ast::Module& module, unsigned jobs) {
+    Resolver resolver;
+    resolver.set_jobs(jobs);
+    try {
+        resolver.resolve(module);
+    } catch (const flux::DiagnosticError& e) {
+        return e.what();
+    }
+    return "";
+}
+
+std::string generic_module(int functions) {
+    std::string code = "struct Box<T> { value: T }\n";
+    code += "func id<T>(x: T) -> T { return x; }\n";
+    for (int i = 0; i < functions; ++i) {
+        const std::string n = std::to_string(i);
+        code += "func f" + n + "(b: Box<Int32>) -> Int32 {\n";
+        code += "    let x: Int32 = id<Int32>(" + n + ");\n";
+        if (i % 3 == 0)
+            code += "    let y: Bool = id<Bool>(true);\n";
+        if (i % 5 == 0)
+            code += "    let z: Float64 = id<Float64>(1.0);\n";
+        code += "    if x > 1 {\n        return x;\n    }\n";
+        code += "    return 0;\n}\n";
+    }
+    code += "func main() -> Int32 {\n    return 0;\n}\n";
+    return code;
+}
+} // namespace
+
+// Parallel resolution records the same instantiations, in the same order, and creates the
+// same scopes as serial resolution.
+void test_parallel_matches_serial() {
+    std::cout << "Testing parallel resolution matches serial..." << std::endl;
+    auto module = parse(generic_module(40));
+
+    Resolver serial;
+    serial.resolve(module);
+
+    for (unsigned jobs : {0u, 2u, 8u}) {
+        Resolver parallel;
+        parallel.set_jobs(jobs);
+        parallel.resolve(module);
+        assert(parallel.function_instantiations() == serial.function_instantiations());
+        assert(parallel.type_instantiations() == serial.type_instantiations());
+        assert(parallel.scope_count() == serial.scope_count());
+        assert(parallel.symbol_count() == serial.symbol_count());
+    }
+    assert(serial.function_instantiations().size() == 3);
+    std::cout << "  Passed!" << std::endl;
+}
+
+// The error reported is the one in the first function, as in serial resolution, wherever
+// the workers happen to be.
+void test_parallel_first_error() {
+    std::cout << "Testing parallel resolution reports the first error..." << std::endl;
+    std::string code;
+    for (int i = 0; i < 30; ++i)
+        code += "func ok" + std::to_string(i) + "() -> Int32 { return 1; }\n";
+    code += "func bad_first() -> Int32 { let x: Int32; let y: Int32 = x; return y; }\n";
+    for (int i = 0; i < 30; ++i)
+        code += "func more" + std::to_string(i) + "() -> Int32 { return 1; }\n";
+    code += "func bad_second() -> Int32 { return true; }\n";
+    auto module = parse(code);
+
+    const std::string serial = resolve_error(module, 1);
+    assert(serial.find("uninitialized variable 'x'") != std::string::npos);
+    for (unsigned jobs : {2u, 4u})
+        assert(resolve_error(module, jobs) == serial);
+    std::cout << "  Passed!" << std::endl;
+}
+
+// A body worker reads the declaration tables and global scopes of the resolver it was made
+// from and cannot add to them; the global scopes are frozen while workers run.
+void test_worker_cannot_declare_globals() {
+    std::cout << "Testing body workers cannot declare into shared state..." << std::endl;
+    auto module = parse(generic_module(2));
+    Resolver resolver;
+    resolver.resolve(module);
+
+    auto worker = resolver.make_body_worker();
+    assert(worker->function_decls().size() == resolver.function_decls().size());
+    bool threw = false;
+    try {
+        worker->declaring();
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    Scope global;
+    global.freeze(true);
+    threw = false;
+    try {
+        global.declare({"x", SymbolKind::Variable});
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw && global.get_symbols().empty());
+    global.freeze(false);
+    assert(global.declare({"x", SymbolKind::Variable}));
+    std::cout << "  Passed!" << std::endl;
+}
+
+// Each instantiation is re-resolved from the state declaration left, not the state the
+// last body ended in: with the global Pt left moved, wrap<Int32> still resolves and the
+// id<Int32> it calls is recorded.
+void test_monomorphize_restores_declared_state() {
+    std::cout << "Testing monomorphization starts from the declared state..." << std::endl;
+    auto module = parse("struct Pt { x: Int32 }\n"
+                        "func id<T>(x: T) -> T { return x; }\n"
+                        "func wrap<T>(x: T) -> T {\n"
+                        "    drop(Pt);\n"
+                        "    return id<T>(x);\n"
+                        "}\n"
+                        "func main() -> Int32 {\n"
+                        "    return wrap<Int32>(1);\n"
+                        "}\n");
+    Resolver resolver;
+    resolver.initialize_intrinsics();
+    resolver.enter_scope();
+    resolver.declare_module(module);
+    resolver.declared_flow_ = resolver.flow_.save();
+    std::vector<Resolver::BodyTask> bodies;
+    resolver.collect_bodies(module, bodies);
+    resolver.resolve_bodies(bodies);
+    resolver.flow_.set_moved(*resolver.current_scope().lookup("Pt"), true);
+
+    resolver.monomorphize_recursive();
+    bool recorded = false;
+    for (const auto& inst : resolver.function_instantiations())
+        recorded |= inst.name == "id" && inst.args.size() == 1 && inst.args[0]->name == "Int32";
+    assert(recorded);
+    std::cout << "  Passed!" << std::endl;
+}
+
+int main() {
+    try {
+        test_parallel_matches_serial();
+        test_parallel_first_error();
+        test_worker_cannot_declare_globals();
+        test_monomorphize_restores_declared_state();
+        std::cout << "All parallel resolve tests passed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
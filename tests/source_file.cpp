@@ -0,0 +1,80 @@
+#include "driver/module_loader.h"
+#include "lexer/lexer.h"
+#include "lexer/source_file.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+using namespace flux;
+
+static std::filesystem::path write_temp(const std::string& name, const std::string& text) {
+    auto path = std::filesystem::temp_directory_path() / name;
+    std::ofstream(path, std::ios::binary) << text;
+    return path;
+}
+
+// Regular files are mapped and lexed in place: token lexemes point into the mapping.
+void test_mapped_file() {
+    const std::string text = "module mapped;\nfunc main() -> Void {}\n";
+    auto path = write_temp("flux_source_file_mapped.fl", text);
+    {
+        auto file = SourceFile::open(path.string());
+        assert(file->text() == text);
+        assert(file->path() == path.string());
+#ifndef _WIN32
+        assert(file->is_mapped());
+#endif
+        Lexer lexer(*file);
+        auto tokens = lexer.tokenize();
+        assert(tokens[1].lexeme == "mapped");
+        assert(tokens[1].lexeme.data() == file->text().data() + 7);
+    }
+    std::filesystem::remove(path);
+}
+
+// Empty files, in-memory text and missing files take the non-mapped paths.
+void test_fallbacks() {
+    auto empty = write_temp("flux_source_file_empty.fl", "");
+    {
+        auto file = SourceFile::open(empty.string());
+        assert(!file->is_mapped());
+        assert(file->text().empty());
+        Lexer lexer(*file);
+        assert(lexer.tokenize().size() == 1);
+    }
+    std::filesystem::remove(empty);
+
+    auto text = SourceFile::from_string("<memory>", "let x = 1;");
+    assert(!text->is_mapped());
+    assert(text->text() == "let x = 1;");
+
+    bool threw = false;
+    try {
+        SourceFile::open("/nonexistent/flux/source_file.fl");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+// The loader keeps each module's source alive for as long as the loader itself.
+void test_loader_owns_sources() {
+    auto path = write_temp("flux_source_file_loader.fl", "module owned;\nfunc main() -> Void {}\n");
+    ModuleLoader loader;
+    loader.load(path.string());
+    const SourceFile* source = loader.source("owned");
+    assert(source);
+    assert(source->text().starts_with("module owned;"));
+    assert(loader.source("missing") == nullptr);
+    std::filesystem::remove(path);
+}
+
+int main() {
+    test_mapped_file();
+    test_fallbacks();
+    test_loader_owns_sources();
+    std::cout << "Source file tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "ast/ast.h"
+#include "driver/module_loader.h"
+#include "lexer/diagnostic.h"
+#include "lexer/lexer.h"
+#include "lexer/source_file.h"
+#include "lexer/source_manager.h"
+#include "parser/parser.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace flux;
+
+static_assert(sizeof(SourceLoc) == 4);
+static_assert(sizeof(void*) != 8 || sizeof(Token) == 24);
+
+// Files get disjoint offset ranges; a location resolves to its own file, line and column.
+void test_locations_resolve_per_file() {
+    auto a = SourceFile::from_string("a.fl", "let x = 1;\nlet y = 2;\n");
+    auto b = SourceFile::from_string("b.fl", "\n\n  z");
+    assert(a->base() != 0 && b->base() > a->base() + a->text().size());
+
+    PresumedLoc loc = SourceManager::global().presumed(a->loc_at(15));
+    assert(loc.file == "a.fl" && loc.line == 2 && loc.column == 5);
+    loc = SourceManager::global().presumed(b->loc_at(4));
+    assert(loc.file == "b.fl" && loc.line == 3 && loc.column == 3);
+
+    // End of file has a location; an empty file still has line 1.
+    loc = SourceManager::global().presumed(a->loc_at(a->text().size()));
+    assert(loc.file == "a.fl" && loc.line == 3 && loc.column == 1);
+    auto empty = SourceFile::from_string("empty.fl", "");
+    loc = SourceManager::global().presumed(empty->loc_at(0));
+    assert(loc.line == 1 && loc.column == 1);
+
+    assert(SourceManager::global().presumed(SourceLoc{}).file.empty());
+}
+
+// Once a file is closed its locations resolve to "unknown", never to another file.
+void test_closed_file_is_unknown() {
+    SourceLoc stale;
+    {
+        auto file = SourceFile::from_string("closed.fl", "func f() {}");
+        stale = file->loc_at(5);
+        assert(SourceManager::global().presumed(stale).file == "closed.fl");
+    }
+    auto reopened = SourceFile::from_string("other.fl", "func f() {}");
+    const PresumedLoc loc = SourceManager::global().presumed(stale);
+    assert(loc.file.empty() && loc.line == 0);
+
+    const DiagnosticError error("lost", stale);
+    assert(std::string(error.what()) == "error: lost at 0:0");
+}
+
+// Closed ranges are handed out again only once fresh offsets run out, merged with their
+// closed neighbours.
+void test_ranges_are_recycled_when_exhausted() {
+    SourceManager manager(31); // offsets 1 to 30
+    auto a = SourceFile::from_string("a.fl", "123456789");
+    auto b = SourceFile::from_string("b.fl", "123456789");
+    auto c = SourceFile::from_string("c.fl", "123456789");
+    const std::uint32_t base_a = manager.add(*a);
+    const std::uint32_t base_b = manager.add(*b);
+    assert(base_a == 1 && base_b == 11 && manager.add(*c) == 21);
+
+    bool threw = false;
+    try {
+        manager.add(*a);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    manager.remove(base_b);
+    manager.remove(base_a);
+    auto d = SourceFile::from_string("d.fl", std::string(15, 'x'));
+    auto e = SourceFile::from_string("e.fl", "abc");
+    assert(manager.add(*d) == 1 && manager.add(*e) == 17);
+    const PresumedLoc loc = manager.presumed(SourceLoc{18});
+    assert(loc.file == "e.fl" && loc.column == 2);
+    assert(manager.presumed(SourceLoc{21}).file == "c.fl");
+}
+
+// Diagnostics name the module file the error is in, not just the line and column.
+void test_diagnostics_name_the_file() {
+    const auto dir = std::filesystem::temp_directory_path() / "flux_source_location";
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "app.fl") << "module app;\nimport util;\nfunc main() -> Void {}\n";
+    std::ofstream(dir / "util.fl") << "module util;\n\nfunc helper() -> Void {\n    let = 1;\n}\n";
+
+    std::string message;
+    std::string file;
+    std::size_t line = 0;
+    try {
+        ModuleLoader loader;
+        loader.add_search_path(dir);
+        loader.load((dir / "app.fl").string());
+    } catch (const DiagnosticError& e) {
+        message = e.what();
+        file = e.file();
+        line = e.line();
+    }
+    std::filesystem::remove_all(dir);
+
+    assert(file == (dir / "util.fl").string());
+    assert(line == 4);
+    assert(message.find("util.fl:4:9") != std::string::npos);
+}
+
+// Parsed nodes carry the location of their first token.
+void test_nodes_carry_locations() {
+    Lexer lexer("func main() -> Void {\n    log(42);\n}");
+    Parser parser(lexer.tokenize());
+    ast::Module module = parser.parse_module();
+    const ast::Stmt& call = *module.functions[0].body.statements[0];
+    const PresumedLoc loc = SourceManager::global().presumed(call.loc);
+    assert(loc.file == "<input>" && loc.line == 2 && loc.column == 5);
+}
+
+int main() {
+    test_locations_resolve_per_file();
+    test_closed_file_is_unknown();
+    test_ranges_are_recycled_when_exhausted();
+    test_diagnostics_name_the_file();
+    test_nodes_carry_locations();
+    std::cout << "Source location tests passed.\n";
+    return 0;
+}
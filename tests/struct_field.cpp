@@ -10,30 +10,32 @@ using namespace flux::semantic;
 void test_struct_field_access() {
     // Define struct: struct Point { x: Int32, y: Int32 }
 
+    Module mod;
+    AstContext& ctx = *mod.context;
     StructDecl point_decl("Point", {},
-                          {{"x", "Int32", Visibility::Public}, {"y", "Int32", Visibility::Public}});
+                          {{"x", ctx.make<PathType>("Int32"), Visibility::Public},
+                           {"y", ctx.make<PathType>("Int32"), Visibility::Public}});
 
-    // Create module and add struct
+    // Add struct to the module
 
-    Module mod;
     mod.structs.push_back(point_decl);
 
     // Create a struct literal: Point { x: 1, y: 2 }
 
     std::vector<FieldInit> field_inits;
-    field_inits.push_back({"x", std::make_unique<NumberExpr>("1")});
-    field_inits.push_back({"y", std::make_unique<NumberExpr>("2")});
-    auto point_lit_ptr = std::make_unique<StructLiteralExpr>("Point", std::move(field_inits));
+    field_inits.push_back({"x", ctx.make<NumberExpr>("1")});
+    field_inits.push_back({"y", ctx.make<NumberExpr>("2")});
+    auto point_lit_ptr = ctx.make<StructLiteralExpr>("Point", ctx.list(std::move(field_inits)));
 
     // Field access: (Point { x: 1, y: 2 }).x
-    auto field_access = std::make_unique<BinaryExpr>(flux::TokenKind::Dot, std::move(point_lit_ptr),
-                                                     std::make_unique<IdentifierExpr>("x"));
+    auto field_access = ctx.make<BinaryExpr>(flux::TokenKind::Dot, point_lit_ptr,
+                                             ctx.make<IdentifierExpr>("x"));
 
     Resolver resolver;
     resolver.resolve(mod);
-    FluxType t = resolver.type_of(*field_access);
-    assert(t.kind == TypeKind::Int);
-    assert(t.name == "Int32");
+    TypeId t = resolver.type_of(*field_access);
+    assert(t->kind == TypeKind::Int);
+    assert(t->name == "Int32");
 }
 
 int main() {
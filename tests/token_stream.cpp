@@ -0,0 +1,113 @@
+#include "ast/ast.h"
+#include "lexer/diagnostic.h"
+#include "lexer/lexer.h"
+#include "lexer/token_stream.h"
+#include "parser/parser.h"
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace flux;
+
+static std::string many_functions(int count) {
+    std::string source = "module stream;\n";
+    for (int i = 0; i < count; ++i) {
+        const std::string n = std::to_string(i);
+        source += "func f" + n + "(a: Int32, b: Int32) -> Int32 {\n";
+        source += "    let mut total: Int32 = a + b * " + n + ";\n";
+        source += "    while total < 100 { total = total + 1; }\n";
+        source += "    let v: Int32 = make<Int32>(total);\n";
+        source += "    return total;\n";
+        source += "}\n";
+    }
+    return source;
+}
+
+// next_token() yields the same tokens as tokenize() and keeps returning EndOfFile.
+void test_next_token_matches_tokenize() {
+    const std::string source = "func main() -> Int32 { return 0x1F + 2; } // done";
+    Lexer whole(source);
+    auto tokens = whole.tokenize();
+
+    Lexer pulled(source);
+    for (const Token& expected : tokens) {
+        Token tok = pulled.next_token();
+        assert(tok.kind == expected.kind && tok.lexeme == expected.lexeme);
+        // Each Lexer registers its own copy of the text, so compare resolved positions.
+        const PresumedLoc a = SourceManager::global().presumed(tok.loc);
+        const PresumedLoc b = SourceManager::global().presumed(expected.loc);
+        assert(a.line == b.line && a.column == b.column);
+    }
+    assert(pulled.next_token().kind == TokenKind::EndOfFile);
+    assert(pulled.next_token().kind == TokenKind::EndOfFile);
+}
+
+// A streamed parse builds the same module as the vector API while buffering only about
+// one statement's worth of tokens.
+void test_streaming_parse_is_bounded() {
+    const std::string source = many_functions(200);
+
+    Lexer lexer(source);
+    auto tokens = lexer.tokenize();
+    const std::size_t token_count = tokens.size();
+    ast::Module from_vector = Parser(std::move(tokens)).parse_module();
+
+    Parser streaming(std::make_unique<LexerTokenStream>(source));
+    ast::Module streamed = streaming.parse_module();
+
+    assert(streamed.name == "stream");
+    assert(streamed.functions.size() == 200);
+    assert(streamed.functions.size() == from_vector.functions.size());
+    for (std::size_t i = 0; i < streamed.functions.size(); ++i) {
+        assert(streamed.functions[i].name == from_vector.functions[i].name);
+        assert(streamed.functions[i].body.statements.size() ==
+               from_vector.functions[i].body.statements.size());
+    }
+    assert(streaming.max_buffered_tokens() < 32);
+    assert(streaming.max_buffered_tokens() * 100 < token_count);
+}
+
+// Backtracking over a generic-argument lookahead still works once tokens are streamed.
+void test_streaming_backtracking() {
+    Parser generic(std::make_unique<LexerTokenStream>(std::string("make<Int32>(1) + a < b")));
+    auto expr = generic.parse_expression();
+    auto* cmp = dynamic_cast<ast::BinaryExpr*>(expr);
+    assert(cmp && cmp->op == TokenKind::Less);
+    auto* sum = dynamic_cast<ast::BinaryExpr*>(cmp->left);
+    assert(sum && sum->op == TokenKind::Plus);
+    auto* call = dynamic_cast<ast::CallExpr*>(sum->left);
+    assert(call);
+    auto* callee = dynamic_cast<ast::IdentifierExpr*>(call->callee);
+    assert(callee && callee->name == "make<Int32>");
+}
+
+// The first error in source order wins: a parse error is reported without lexing the rest
+// of the file, and a lexer error hit during a failed lookahead is reported, not skipped.
+void test_streaming_errors() {
+    const std::string source = "func main() { let = 1; }\nfunc later() { $ }";
+    std::size_t line = 0;
+    try {
+        Parser(std::make_unique<LexerTokenStream>(source)).parse_module();
+    } catch (const DiagnosticError& e) {
+        line = e.line();
+    }
+    assert(line == 1);
+
+    std::string message;
+    try {
+        Parser(std::make_unique<LexerTokenStream>(std::string("a < $"))).parse_expression();
+    } catch (const DiagnosticError& e) {
+        message = e.what();
+    }
+    assert(message.find("unexpected character '$'") != std::string::npos);
+}
+
+int main() {
+    test_next_token_matches_tokenize();
+    test_streaming_parse_is_bounded();
+    test_streaming_backtracking();
+    test_streaming_errors();
+    std::cout << "Token stream tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include "ast/ast.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include "semantic/resolver.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace flux;
+using namespace flux::ast;
+using namespace flux::semantic;
+
+namespace {
+Module parse(const std::string& source) {
+    Lexer lexer(source);
+    Parser parser(lexer.tokenize());
+    return parser.parse_module();
+}
+} // namespace
+
+// Parameter and return types come out of the parser as trees, not text.
+void test_parse_structure() {
+    Module module = parse("func f(a: &mut Box<Int32>, b: [Int32; 4], c: (Int32, Bool),\n"
+                          "       d: (Int32) -> Bool, e: [String]) -> Result<Int32, String> {}");
+    const FunctionDecl& fn = module.functions[0];
+    assert(fn.params.size() == 5);
+
+    const auto* a = dyn_cast<RefType>(fn.params[0].type);
+    assert(a && a->is_mutable);
+    const auto* box = dyn_cast<PathType>(a->pointee);
+    assert(box && box->name == "Box" && box->generic_args.size() == 1);
+    assert(cast<PathType>(box->generic_args[0])->name == "Int32");
+
+    const auto* b = dyn_cast<ArrayType>(fn.params[1].type);
+    assert(b && !b->is_slice() && b->length == "4");
+    assert(isa<PathType>(b->element));
+
+    const auto* c = dyn_cast<TupleType>(fn.params[2].type);
+    assert(c && c->elements.size() == 2);
+
+    const auto* d = dyn_cast<FunctionType>(fn.params[3].type);
+    assert(d && d->params.size() == 1 && isa<PathType>(d->return_type));
+
+    const auto* e = dyn_cast<ArrayType>(fn.params[4].type);
+    assert(e && e->is_slice());
+
+    const auto* ret = dyn_cast<PathType>(fn.return_type);
+    assert(ret && ret->name == "Result" && ret->generic_args.size() == 2);
+    assert(fn.return_type->loc.valid());
+}
+
+// spelling() reproduces the canonical text the symbol tables key on.
+void test_spelling() {
+    Module module = parse("func f(a: &mut Box<Int32>, b: [Int32; 1_000], c: (Int32, Bool),\n"
+                          "       d: (Int32, Bool) -> Void, e: &[String]) -> Void {}");
+    const FunctionDecl& fn = module.functions[0];
+    assert(spelling(fn.params[0].type) == "&mut Box<Int32>");
+    assert(spelling(fn.params[1].type) == "[Int32;1000]");
+    assert(spelling(fn.params[2].type) == "(Int32, Bool)");
+    assert(spelling(fn.params[3].type) == "(Int32, Bool) -> Void");
+    assert(spelling(fn.params[4].type) == "&[String]");
+    assert(spelling(nullptr).empty());
+}
+
+// Bounds are parsed per type parameter, and each bound is a type of its own.
+void test_where_clause() {
+    Module module = parse("func f<T, U>(x: T, y: U) -> Void where T: Display + Clone, U: Eq {}");
+    const WhereClause& where = module.functions[0].where_clause;
+    assert(where.size() == 2);
+    assert(where[0].param == "T" && where[0].bounds.size() == 2);
+    assert(spelling(where[0].bounds[1]) == "Clone");
+    assert(where[1].param == "U" && where[1].bounds.size() == 1);
+}
+
+// The resolver maps each kind of tree to its semantic type without reparsing.
+void test_resolve_type() {
+    Module module = parse("func f(a: &Int32, b: [Int32; 3], c: [Bool], d: Option<Int64>,\n"
+                          "       e: (Int32, Bool)) -> Void {}");
+    const FunctionDecl& fn = module.functions[0];
+    Resolver resolver;
+
+    TypeId a = resolver.resolve_type(fn.params[0].type);
+    assert(a->kind == TypeKind::Ref && a->name == "&Int32" && !a->is_mut_ref);
+
+    TypeId b = resolver.resolve_type(fn.params[1].type);
+    assert(b->kind == TypeKind::Array && b->name == "[Int32;3]");
+
+    TypeId c = resolver.resolve_type(fn.params[2].type);
+    assert(c->kind == TypeKind::Slice && c->name == "[Bool]");
+
+    TypeId d = resolver.resolve_type(fn.params[3].type);
+    assert(d->kind == TypeKind::Option && d->generic_args.size() == 1);
+    assert(d->generic_args[0]->name == "Int64");
+
+    TypeId e = resolver.resolve_type(fn.params[4].type);
+    assert(e->kind == TypeKind::Tuple && e->generic_args.size() == 2);
+
+    assert(resolver.resolve_type(nullptr)->kind == TypeKind::Unknown);
+}
+
+// Equal types, however they are reached, are one interned node.
+void test_type_interning() {
+    Module module = parse("func f(a: Option<Int64>, b: (Int32, Bool), c: (Int32) -> Bool) {}");
+    const FunctionDecl& fn = module.functions[0];
+    Resolver resolver;
+
+    const TypeId option = resolver.resolve_type(fn.params[0].type);
+    assert(option == resolver.type_from_name("Option<Int64>"));
+    assert(option->generic_args[0] == TypeId(TypeKind::Int, "Int64"));
+    assert(option != resolver.type_from_name("Option<Int32>"));
+
+    const TypeId tuple = resolver.resolve_type(fn.params[1].type);
+    assert(tuple == resolver.type_from_name("(Int32, Bool)"));
+    assert(tuple->generic_args[1] == resolver.type_from_name("Bool"));
+
+    const TypeId function = resolver.resolve_type(fn.params[2].type);
+    assert(function == resolver.type_from_name("(Int32) -> Bool"));
+    assert(function->return_type == resolver.type_from_name("Bool"));
+
+    // Types from separate resolvers are interned in the same table.
+    Resolver other;
+    assert(other.resolve_type(fn.params[0].type) == option);
+
+    const std::size_t count = TypeContext::global().size();
+    (void)resolver.type_from_name("Option<Int64>");
+    assert(TypeContext::global().size() == count);
+    assert(TypeId() == unknown() && unknown()->name == "<unknown>");
+}
+
+// Cloning a declaration deep-copies its types into the target context.
+void test_clone() {
+    Module module = parse("func f(a: &[Int32; 2]) -> Option<Int32> {}");
+    Module copy = module.clone();
+    const FunctionDecl& fn = copy.functions[0];
+    assert(fn.params[0].type != module.functions[0].params[0].type);
+    assert(spelling(fn.params[0].type) == "&[Int32;2]");
+    module = Module();
+    assert(spelling(fn.return_type) == "Option<Int32>");
+}
+
+// Clearing the table keeps only the built-in types, and no thread hands out a node it built
+// before the clear.
+void test_type_context_clear() {
+    TypeContext& context = TypeContext::global();
+    const TypeId before = TypeId(TypeKind::Option, "Option<Int64>", false, {}, {},
+                                 {TypeId(TypeKind::Int, "Int64")});
+    std::thread([] { (void)TypeId(TypeKind::Int, "Int64"); }).join();
+    const TypeId void_before = void_type();
+    (void)before;
+
+    context.clear();
+    const std::size_t builtins = context.size();
+    assert(builtins == 4);
+    assert(void_type() == void_before && void_type()->name == "Void");
+    assert(never_type() == TypeId(TypeKind::Never, "Never"));
+    assert(TypeId() == unknown() && Resolver::unknown_type()->name == "Unknown");
+    assert(context.size() == builtins);
+
+    const TypeId int64 = TypeId(TypeKind::Int, "Int64");
+    assert(context.size() == builtins + 1 && int64->name == "Int64");
+    std::thread([&] { assert(TypeId(TypeKind::Int, "Int64") == int64); }).join();
+    assert(context.size() == builtins + 1);
+}
+
+int main() {
+    test_parse_structure();
+    test_spelling();
+    test_where_clause();
+    test_resolve_type();
+    test_type_interning();
+    test_clone();
+    test_type_context_clear();
+    std::cout << "Type expression tests passed.\n";
+    return 0;
+}